@@ -4,115 +4,103 @@ Convert CAN binary logs (.bin) to CSV.
 """
 
 import argparse
-import datetime as dt
 import os
 import struct
 import sys
 
-HEADER_FMT = "<8sHHQQII28s"
-HEADER_SIZE = 64
-RECORD_FMT = "<QIBB8sH"
-RECORD_SIZE = 24
-MAGIC_PREFIX = b"CANBIN\x00"
-VERSION = 1
+import numpy as np
 
-CSV_HEADER = "datetime,timestamp_us,can_id,dlc,b0,b1,b2,b3,b4,b5,b6,b7\n"
-
-
-def parse_header(data):
-    if len(data) < HEADER_SIZE:
-        raise ValueError("File too small for header")
-
-    magic, version, header_size, log_start_unix_us, log_start_mono_us, record_size, flags, _ = \
-        struct.unpack(HEADER_FMT, data[:HEADER_SIZE])
-
-    if not magic.startswith(MAGIC_PREFIX):
-        raise ValueError(f"Bad magic: {magic!r}")
-    if version != VERSION:
-        raise ValueError(f"Unsupported version: {version}")
-    if header_size != HEADER_SIZE:
-        raise ValueError(f"Unexpected header size: {header_size}")
-    if record_size != RECORD_SIZE:
-        raise ValueError(f"Unexpected record size: {record_size}")
-
-    return {
-        "log_start_unix_us": log_start_unix_us,
-        "log_start_monotonic_us": log_start_mono_us,
-        "flags": flags,
-    }
+from canbin import (HEADER_FLAG_TIMEBASE, HEADER_SIZE, HEX, META_EVENT, META_SYNC, META_TRAILER,
+                    RECORD_FLAG_META, RECORD_SIZE, format_datetimes, map_bin, wall_clock)
 
+EVENT_KINDS = {1: "raised", 2: "cleared"}
+EVENT_BUS_STATE = 3
+BUS_STATES = ["stopped", "active", "warning", "passive", "bus_off", "recovering"]
 
-def format_datetime(log_start_unix_us, log_start_mono_us, timestamp_us, cache):
-    if log_start_unix_us == 0:
-        return ""
-
-    if timestamp_us < log_start_mono_us:
-        unix_us = log_start_unix_us
-    else:
-        unix_us = log_start_unix_us + (timestamp_us - log_start_mono_us)
-
-    seconds_int = int(unix_us // 1_000_000)
-    cached = cache.get(seconds_int)
-    if cached is not None:
-        return cached
-
-    formatted = dt.datetime.fromtimestamp(seconds_int).strftime("%Y-%m-%d %H:%M:%S")
-    cache[seconds_int] = formatted
-    return formatted
+CSV_HEADER = "datetime,timestamp_us,can_id,dlc,b0,b1,b2,b3,b4,b5,b6,b7\n"
+CHUNK_RECORDS = 1 << 18
+
+
+def bus_state_name(state):
+    return BUS_STATES[state] if state < len(BUS_STATES) else str(state)
+
+
+def print_meta(record):
+    timestamp_us = int(record["timestamp_us"])
+    can_id = int(record["can_id"])
+    payload = record["data"].tobytes()
+    if can_id == META_EVENT:
+        source, kind, severity, value = struct.unpack("<HBBf", payload)
+        if kind == EVENT_BUS_STATE:
+            print(
+                f"Event: t={timestamp_us}us bus {bus_state_name(severity)} "
+                f"-> {bus_state_name(source)} (errors={value:g})",
+                file=sys.stderr,
+            )
+        else:
+            print(
+                f"Event: t={timestamp_us}us alert {source} "
+                f"{EVENT_KINDS.get(kind, kind)} (severity={severity}, "
+                f"value={value:g})",
+                file=sys.stderr,
+            )
+    elif can_id == META_TRAILER:
+        logged, abandoned, reason, stages = struct.unpack("<IHBB", payload)
+        print(
+            f"Trailer: {logged} records logged, {abandoned} abandoned "
+            f"(reason={reason}, stages=0x{stages:02X})",
+            file=sys.stderr,
+        )
+
+
+def format_rows(records, unix_us):
+    """CSV lines of a chunk of frame records."""
+    ids, id_index = np.unique(records["can_id"], return_inverse=True)
+    hex_bytes = HEX.astype(object)
+    columns = [
+        format_datetimes(unix_us),
+        list(map(str, records["timestamp_us"].tolist())),
+        np.array([f"{can_id:03X}" for can_id in ids], dtype=object)[id_index.reshape(-1)],
+        list(map(str, records["dlc"].tolist())),
+    ]
+    data = records["data"]
+    columns += [hex_bytes[data[:, i]] for i in range(8)]
+    return "".join(",".join(row) + "\n" for row in zip(*columns))
 
 
 def convert_file(input_path, output_path):
-    with open(input_path, "rb") as src:
-        header_data = src.read(HEADER_SIZE)
-        header = parse_header(header_data)
-
-        with open(output_path, "w", encoding="utf-8") as dst:
-            dst.write(CSV_HEADER)
-
-            leftover = b""
-            records_written = 0
-            datetime_cache = {}
-
-            while True:
-                chunk = src.read(RECORD_SIZE * 1024)
-                if not chunk:
-                    break
-
-                data = leftover + chunk
-                record_count = len(data) // RECORD_SIZE
-                end = record_count * RECORD_SIZE
-                leftover = data[end:]
-
-                for i in range(record_count):
-                    offset = i * RECORD_SIZE
-                    rec = data[offset:offset + RECORD_SIZE]
-                    timestamp_us, can_id, dlc, flags, payload, _ = struct.unpack(RECORD_FMT, rec)
-
-                    datetime_str = format_datetime(
-                        header["log_start_unix_us"],
-                        header["log_start_monotonic_us"],
-                        timestamp_us,
-                        datetime_cache,
-                    )
-
-                    can_id_str = f"{can_id:03X}"
-                    bytes_hex = [f"{b:02X}" for b in payload]
-
-                    line = ",".join([
-                        datetime_str,
-                        str(timestamp_us),
-                        can_id_str,
-                        str(dlc),
-                        *bytes_hex,
-                    ])
-                    dst.write(line + "\n")
-                    records_written += 1
-
-            if leftover:
-                print(
-                    f"Warning: ignoring {len(leftover)} trailing bytes (truncated file)",
-                    file=sys.stderr,
-                )
+    log = map_bin(input_path)
+    header = log.header
+    records = log.records
+    trailing = (os.path.getsize(input_path) - HEADER_SIZE) % RECORD_SIZE
+
+    with open(output_path, "w", encoding="utf-8") as dst:
+        dst.write(CSV_HEADER)
+
+        # The anchor starts as the header's log start and moves to each sync
+        # record, so esp_timer drift never accumulates past one sync interval
+        anchor_unix_us = header["log_start_unix_us"]
+        anchor_mono_us = header["log_start_monotonic_us"]
+        if anchor_unix_us and not header["flags"] & HEADER_FLAG_TIMEBASE:
+            print("Note: log start time has 1 s resolution (timebase not locked)",
+                  file=sys.stderr)
+
+        records_written = 0
+        for start in range(0, len(records), CHUNK_RECORDS):
+            chunk = np.asarray(records[start:start + CHUNK_RECORDS])
+            unix_us, anchor_unix_us, anchor_mono_us = wall_clock(chunk, anchor_unix_us,
+                                                                 anchor_mono_us)
+            meta = (chunk["flags"] & RECORD_FLAG_META) != 0
+            for index in np.flatnonzero(meta & (chunk["can_id"] != META_SYNC)):
+                print_meta(chunk[index])
+            dst.write(format_rows(chunk[~meta], unix_us[~meta]))
+            records_written += int((~meta).sum())
+
+    if trailing:
+        print(
+            f"Warning: ignoring {trailing} trailing bytes (truncated file)",
+            file=sys.stderr,
+        )
 
     return records_written
 
@@ -6,13 +6,18 @@ Tools for analyzing Toyota 4Runner CAN bus logs to identify broadcast messages
 and correlate them with diagnostic data.
 """
 
-import pandas as pd
-import numpy as np
-from collections import defaultdict, Counter
-import json
 import sys
 from pathlib import Path
 
+import numpy as np
+import pandas as pd
+
+import canbin
+
+
+def _hex_id(can_id):
+    return f"{can_id:03X}"
+
 
 class CANLogAnalyzer:
     """Analyzes CAN bus logs to identify patterns and broadcast messages."""
@@ -20,31 +25,37 @@ class CANLogAnalyzer:
     def __init__(self, log_file):
         """Initialize analyzer with a log file path."""
         self.log_file = Path(log_file)
-        self.df = None
+        self.log = None
         self.message_stats = None
         self.unique_ids = None
 
     def load_log(self):
-        """Load CSV log file into pandas DataFrame."""
+        """Load a CAN log (CSV, .bin or text capture) through canbin."""
         print(f"Loading {self.log_file}...")
-        self.df = pd.read_csv(self.log_file, dtype={
-            'timestamp_us': 'int64',
-            'can_id': 'str',
-            'dlc': 'int',
-            'b0': 'str', 'b1': 'str', 'b2': 'str', 'b3': 'str',
-            'b4': 'str', 'b5': 'str', 'b6': 'str', 'b7': 'str'
-        })
-        print(f"Loaded {len(self.df)} messages")
-        return self.df
+        self.log = canbin.open_log(self.log_file)
+        ids, _ = self.log.ids()
+        self.unique_ids = set(ids.tolist())
+        print(f"Loaded {len(self.log)} messages")
+        return self.log
+
+    def _duration_sec(self):
+        return self.log.duration_s()
+
+    def _frequency(self):
+        """(can_id, count) pairs, most frequent first, ties by first appearance."""
+        ids, counts = self.log.ids()
+        first_seen = [self.log.index_of(can_id)[0] for can_id in ids]
+        order = np.lexsort((first_seen, -counts))
+        return [(int(ids[i]), int(counts[i])) for i in order]
 
     def analyze_message_frequency(self, top_n=50):
         """Analyze frequency of CAN IDs."""
-        if self.df is None:
+        if self.log is None:
             self.load_log()
 
         print("\n=== Message Frequency Analysis ===")
-        msg_counts = self.df['can_id'].value_counts()
-        total_msgs = len(self.df)
+        msg_counts = self._frequency()
+        total_msgs = len(self.log)
 
         print(f"\nTotal unique CAN IDs: {len(msg_counts)}")
         print(f"Total messages: {total_msgs}")
@@ -53,42 +64,35 @@ class CANLogAnalyzer:
         print(f"{'CAN ID':<10} {'Count':>12} {'% of Total':>12} {'Msgs/Sec':>12}")
         print("-" * 50)
 
-        # Calculate duration in seconds
-        duration_sec = (self.df['timestamp_us'].max() - self.df['timestamp_us'].min()) / 1_000_000
+        duration_sec = self._duration_sec()
 
-        for can_id, count in msg_counts.head(top_n).items():
+        for can_id, count in msg_counts[:top_n]:
             percentage = (count / total_msgs) * 100
             msgs_per_sec = count / duration_sec
-            print(f"{can_id:<10} {count:>12,} {percentage:>11.2f}% {msgs_per_sec:>12.2f}")
+            print(f"{_hex_id(can_id):<10} {count:>12,} {percentage:>11.2f}% {msgs_per_sec:>12.2f}")
 
         self.message_stats = msg_counts
-        self.unique_ids = set(msg_counts.index)
         return msg_counts
 
     def analyze_data_patterns(self, can_id, sample_size=100):
         """Analyze data patterns for a specific CAN ID."""
-        if self.df is None:
+        if self.log is None:
             self.load_log()
 
-        msgs = self.df[self.df['can_id'] == can_id].head(sample_size)
+        msgs = self.log.frames_of(can_id)[:sample_size]
 
         if len(msgs) == 0:
-            print(f"No messages found for CAN ID {can_id}")
+            print(f"No messages found for CAN ID {_hex_id(can_id)}")
             return
 
-        print(f"\n=== Data Pattern Analysis for CAN ID {can_id} ===")
+        print(f"\n=== Data Pattern Analysis for CAN ID {_hex_id(can_id)} ===")
         print(f"Showing first {len(msgs)} messages")
 
-        # Convert hex bytes to integers for analysis
-        byte_cols = [f'b{i}' for i in range(8)]
-        for col in byte_cols:
-            msgs[f'{col}_int'] = msgs[col].apply(lambda x: int(x, 16) if pd.notna(x) and x != '' else 0)
-
         print(f"\nTimestamp, Hex Data (bytes 0-7)")
         print("-" * 80)
-        for _, row in msgs.iterrows():
-            hex_data = ' '.join([row[col] for col in byte_cols])
-            print(f"{row['timestamp_us']:12} {hex_data}")
+        for timestamp_us, hex_data in zip(msgs['timestamp_us'].tolist(),
+                                          canbin.hex_bytes(msgs['data'])):
+            print(f"{timestamp_us:12} {hex_data}")
 
         # Analyze byte value ranges
         print(f"\nByte Value Statistics (integers):")
@@ -96,24 +100,26 @@ class CANLogAnalyzer:
         print("-" * 50)
         for i in range(8):
             col = f'b{i}_int'
-            print(f"{col:<6} {msgs[col].min():>6} {msgs[col].max():>6} "
-                  f"{msgs[col].mean():>8.2f} {msgs[col].std():>8.2f} {msgs[col].nunique():>8}")
+            values = msgs['data'][:, i].astype(np.int64)
+            std = values.std(ddof=1) if len(values) > 1 else float('nan')
+            print(f"{col:<6} {values.min():>6} {values.max():>6} "
+                  f"{values.mean():>8.2f} {std:>8.2f} {len(np.unique(values)):>8}")
 
     def find_high_frequency_messages(self, min_msgs_per_sec=10):
         """Find messages with high frequency (potential broadcasts)."""
         if self.message_stats is None:
             self.analyze_message_frequency()
 
-        duration_sec = (self.df['timestamp_us'].max() - self.df['timestamp_us'].min()) / 1_000_000
+        duration_sec = self._duration_sec()
 
         high_freq = {}
-        for can_id, count in self.message_stats.items():
+        for can_id, count in self.message_stats:
             msgs_per_sec = count / duration_sec
             if msgs_per_sec >= min_msgs_per_sec:
                 high_freq[can_id] = {
                     'count': count,
                     'msgs_per_sec': msgs_per_sec,
-                    'percentage': (count / len(self.df)) * 100
+                    'percentage': (count / len(self.log)) * 100
                 }
 
         print(f"\n=== High Frequency Messages (>= {min_msgs_per_sec} msgs/sec) ===")
@@ -121,65 +127,65 @@ class CANLogAnalyzer:
         print("-" * 50)
         for can_id in sorted(high_freq.keys(), key=lambda x: high_freq[x]['msgs_per_sec'], reverse=True):
             stats = high_freq[can_id]
-            print(f"{can_id:<10} {stats['msgs_per_sec']:>12.2f} {stats['percentage']:>11.2f}% "
+            print(f"{_hex_id(can_id):<10} {stats['msgs_per_sec']:>12.2f} {stats['percentage']:>11.2f}% "
                   f"{stats['count']:>12,}")
 
         return high_freq
 
     def analyze_temporal_patterns(self, can_id, window_ms=1000):
         """Analyze temporal patterns for a specific CAN ID."""
-        if self.df is None:
+        if self.log is None:
             self.load_log()
 
-        msgs = self.df[self.df['can_id'] == can_id].copy()
+        msgs = self.log.frames_of(can_id)
         if len(msgs) < 2:
-            print(f"Not enough messages for temporal analysis of {can_id}")
+            print(f"Not enough messages for temporal analysis of {_hex_id(can_id)}")
             return
 
-        msgs['timestamp_ms'] = msgs['timestamp_us'] // 1000
-        msgs['time_diff_ms'] = msgs['timestamp_ms'].diff()
+        timestamp_ms = msgs['timestamp_us'].astype(np.int64) // 1000
+        time_diff_ms = np.diff(timestamp_ms).astype(np.float64)
+        diff_std = time_diff_ms.std(ddof=1) if len(time_diff_ms) > 1 else float('nan')
 
-        print(f"\n=== Temporal Pattern Analysis for CAN ID {can_id} ===")
+        print(f"\n=== Temporal Pattern Analysis for CAN ID {_hex_id(can_id)} ===")
         print(f"Total messages: {len(msgs)}")
-        print(f"Duration: {(msgs['timestamp_ms'].max() - msgs['timestamp_ms'].min()) / 1000:.2f} seconds")
+        print(f"Duration: {(timestamp_ms.max() - timestamp_ms.min()) / 1000:.2f} seconds")
         print(f"\nTime between messages (ms):")
         print(f"{'Min':>10} {'Max':>10} {'Mean':>10} {'Median':>10} {'Std':>10}")
         print("-" * 52)
-        print(f"{msgs['time_diff_ms'].min():>10.2f} {msgs['time_diff_ms'].max():>10.2f} "
-              f"{msgs['time_diff_ms'].mean():>10.2f} {msgs['time_diff_ms'].median():>10.2f} "
-              f"{msgs['time_diff_ms'].std():>10.2f}")
+        print(f"{time_diff_ms.min():>10.2f} {time_diff_ms.max():>10.2f} "
+              f"{time_diff_ms.mean():>10.2f} {np.median(time_diff_ms):>10.2f} "
+              f"{diff_std:>10.2f}")
 
         # Calculate messages per window
-        msgs['window'] = (msgs['timestamp_ms'] // window_ms) * window_ms
-        msgs_per_window = msgs.groupby('window').size()
+        _, msgs_per_window = np.unique((timestamp_ms // window_ms) * window_ms,
+                                       return_counts=True)
 
         print(f"\nMessages per {window_ms}ms window:")
         print(f"{'Min':>6} {'Max':>6} {'Mean':>8} {'Median':>8}")
         print("-" * 32)
         print(f"{msgs_per_window.min():>6} {msgs_per_window.max():>6} "
-              f"{msgs_per_window.mean():>8.2f} {msgs_per_window.median():>8.2f}")
+              f"{msgs_per_window.mean():>8.2f} {np.median(msgs_per_window):>8.2f}")
+
+    def _payload_stats(self):
+        """(ids, counts, distinct payloads) per CAN ID."""
+        ids, counts = self.log.ids()
+        return ids.tolist(), counts.tolist(), self.log.distinct_payloads().tolist()
 
     def find_constant_messages(self, min_count=10):
         """Find messages with constant data (potential static status)."""
-        if self.df is None:
+        if self.log is None:
             self.load_log()
 
         print("\n=== Constant Data Messages ===")
         constant_msgs = {}
 
-        for can_id in self.unique_ids:
-            msgs = self.df[self.df['can_id'] == can_id]
-            if len(msgs) < min_count:
-                continue
-
+        for can_id, count, distinct in zip(*self._payload_stats()):
             # Check if all messages have identical data
-            byte_cols = [f'b{i}' for i in range(8)]
-            unique_combinations = msgs[byte_cols].drop_duplicates()
-
-            if len(unique_combinations) == 1:
+            if count >= min_count and distinct == 1:
+                first = self.log.frames[self.log.index_of(can_id)[0]]
                 constant_msgs[can_id] = {
-                    'count': len(msgs),
-                    'data': unique_combinations.iloc[0].tolist()
+                    'count': count,
+                    'data': canbin.HEX[first['data']].tolist()
                 }
 
         print(f"Found {len(constant_msgs)} CAN IDs with constant data:")
@@ -188,31 +194,24 @@ class CANLogAnalyzer:
         for can_id in sorted(constant_msgs.keys()):
             msg = constant_msgs[can_id]
             data_str = ' '.join(msg['data'])
-            print(f"{can_id:<10} {msg['count']:>12,} {data_str}")
+            print(f"{_hex_id(can_id):<10} {msg['count']:>12,} {data_str}")
 
         return constant_msgs
 
     def find_changing_messages(self, min_changes=5):
         """Find messages with frequently changing data."""
-        if self.df is None:
+        if self.log is None:
             self.load_log()
 
         print("\n=== Frequently Changing Messages ===")
         changing_msgs = {}
 
-        for can_id in self.unique_ids:
-            msgs = self.df[self.df['can_id'] == can_id]
-            if len(msgs) < 10:
-                continue
-
-            byte_cols = [f'b{i}' for i in range(8)]
-            unique_combinations = msgs[byte_cols].drop_duplicates()
-
-            if len(unique_combinations) >= min_changes:
+        for can_id, count, distinct in zip(*self._payload_stats()):
+            if count >= 10 and distinct >= min_changes:
                 changing_msgs[can_id] = {
-                    'count': len(msgs),
-                    'unique_data': len(unique_combinations),
-                    'change_rate': len(unique_combinations) / len(msgs)
+                    'count': count,
+                    'unique_data': distinct,
+                    'change_rate': distinct / count
                 }
 
         print(f"Found {len(changing_msgs)} CAN IDs with >= {min_changes} unique data combinations:")
@@ -220,36 +219,31 @@ class CANLogAnalyzer:
         print("-" * 42)
         for can_id in sorted(changing_msgs.keys(), key=lambda x: changing_msgs[x]['unique_data'], reverse=True):
             msg = changing_msgs[can_id]
-            print(f"{can_id:<10} {msg['count']:>10,} {msg['unique_data']:>10} "
+            print(f"{_hex_id(can_id):<10} {msg['count']:>10,} {msg['unique_data']:>10} "
                   f"{msg['change_rate']*100:>9.2f}%")
 
         return changing_msgs
 
     def export_message_summary(self, output_file):
         """Export summary of all CAN IDs to a file."""
-        if self.df is None:
+        if self.log is None:
             self.load_log()
 
-        duration_sec = (self.df['timestamp_us'].max() - self.df['timestamp_us'].min()) / 1_000_000
+        duration_sec = self._duration_sec()
 
         summary = []
-        for can_id in sorted(self.unique_ids):
-            msgs = self.df[self.df['can_id'] == can_id]
-            byte_cols = [f'b{i}' for i in range(8)]
-            unique_combinations = msgs[byte_cols].drop_duplicates()
-
+        for can_id, count, distinct in zip(*self._payload_stats()):
             # Get sample data
-            sample = msgs.iloc[0]
-            data_bytes = [sample[col] for col in byte_cols]
+            sample = self.log.frames[self.log.index_of(can_id)[0]]
 
             summary.append({
-                'can_id': can_id,
-                'count': len(msgs),
-                'msgs_per_sec': len(msgs) / duration_sec,
-                'percentage': (len(msgs) / len(self.df)) * 100,
-                'unique_data': len(unique_combinations),
-                'dlc': sample['dlc'],
-                'sample_data': ' '.join(data_bytes)
+                'can_id': _hex_id(can_id),
+                'count': count,
+                'msgs_per_sec': count / duration_sec,
+                'percentage': (count / len(self.log)) * 100,
+                'unique_data': distinct,
+                'dlc': int(sample['dlc']),
+                'sample_data': ' '.join(canbin.HEX[sample['data']])
             })
 
         summary_df = pd.DataFrame(summary)
@@ -263,7 +257,7 @@ class CANLogAnalyzer:
 def main():
     """Main entry point for command-line usage."""
     if len(sys.argv) < 2:
-        print("Usage: python can_analyzer.py <log_file.csv> [options]")
+        print("Usage: python can_analyzer.py <log_file> [options]  (CSV, .bin or text)")
         print("\nOptions:")
         print("  --freq N         Show top N most frequent messages (default: 50)")
         print("  --analyze ID     Analyze data patterns for specific CAN ID")
@@ -289,7 +283,7 @@ def main():
             i += 2
 
         elif arg == '--analyze':
-            can_id = sys.argv[i+1]
+            can_id = int(sys.argv[i+1], 16)
             analyzer.analyze_data_patterns(can_id)
             i += 2
 
@@ -299,7 +293,7 @@ def main():
             i += 2
 
         elif arg == '--temporal':
-            can_id = sys.argv[i+1]
+            can_id = int(sys.argv[i+1], 16)
             analyzer.analyze_temporal_patterns(can_id)
             i += 2
 
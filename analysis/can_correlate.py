@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+ctypes binding for the native correlation engine (analysis/native).
+
+Build the library once:
+
+    cmake -S analysis/native -B analysis/native/build
+    cmake --build analysis/native/build
+
+or point CAN_CORRELATE_LIB at a build elsewhere. available() tells
+whether it could be loaded; callers fall back to pandas otherwise.
+"""
+
+import ctypes
+import os
+import sys
+from pathlib import Path
+
+import numpy as np
+
+LIB_ENV = "CAN_CORRELATE_LIB"
+FEATURES = 44
+
+_ERRORS = {
+    -1: "bad argument",
+    -2: "frames not in timestamp order",
+    -3: "out of memory",
+}
+
+
+class _Frames(ctypes.Structure):
+    _fields_ = [
+        ("timestamp_us", ctypes.POINTER(ctypes.c_int64)),
+        ("can_id", ctypes.POINTER(ctypes.c_uint32)),
+        ("data", ctypes.POINTER(ctypes.c_uint8)),
+        ("count", ctypes.c_size_t),
+    ]
+
+
+class _Signals(ctypes.Structure):
+    _fields_ = [
+        ("window", ctypes.POINTER(ctypes.c_int64)),
+        ("value", ctypes.POINTER(ctypes.c_double)),
+        ("offsets", ctypes.POINTER(ctypes.c_size_t)),
+        ("count", ctypes.c_size_t),
+    ]
+
+
+def library_paths(env_var, name):
+    """Where to look for native library `name`: $env_var, else analysis/native/build."""
+    env = os.environ.get(env_var)
+    if env:
+        yield Path(env)
+        return
+    build = Path(__file__).resolve().parent / "native" / "build"
+    names = {"win32": [f"{name}.dll", f"Release/{name}.dll"],
+             "darwin": [f"lib{name}.dylib"]}.get(sys.platform, [f"lib{name}.so"])
+    for lib_name in names:
+        yield build / lib_name
+
+
+_lib = None
+
+
+def _load():
+    global _lib
+    if _lib is not None:
+        return _lib or None
+    _lib = False
+    for path in library_paths(LIB_ENV, "can_correlate"):
+        if not path.exists():
+            continue
+        lib = ctypes.CDLL(str(path))
+        lib.can_corr_run.argtypes = [
+            ctypes.POINTER(_Frames), ctypes.POINTER(ctypes.c_uint32), ctypes.c_size_t,
+            ctypes.POINTER(_Signals), ctypes.c_int64, ctypes.c_uint32, ctypes.c_uint,
+            ctypes.POINTER(ctypes.c_double), ctypes.POINTER(ctypes.c_uint32),
+        ]
+        lib.can_corr_run.restype = ctypes.c_int
+        lib.can_corr_feature_name.argtypes = [ctypes.c_uint]
+        lib.can_corr_feature_name.restype = ctypes.c_char_p
+        _lib = lib
+        break
+    return _lib or None
+
+
+def available():
+    return _load() is not None
+
+
+def feature_names():
+    lib = _load()
+    return [lib.can_corr_feature_name(i).decode() for i in range(FEATURES)]
+
+
+def _ptr(array, ctype):
+    return array.ctypes.data_as(ctypes.POINTER(ctype))
+
+
+def correlate(timestamps_us, can_ids, data, ids, signals, window_us, min_windows, threads=0):
+    """
+    Correlate every candidate ID's window features with every signal.
+
+    timestamps_us, can_ids: per-frame arrays in timestamp order
+    data: (frames, 8) uint8 array
+    ids: candidate CAN IDs (ints)
+    signals: list of (window_index, mean_value) array pairs, windows ascending
+    Returns (corr[signal, id, feature], windows[signal, id]); corr is NaN
+    where there is no result.
+    """
+    lib = _load()
+    if lib is None:
+        raise RuntimeError(f"native correlation engine not built (see {__name__} docstring)")
+
+    ts = np.ascontiguousarray(timestamps_us, dtype=np.int64)
+    cid = np.ascontiguousarray(can_ids, dtype=np.uint32)
+    payload = np.ascontiguousarray(data, dtype=np.uint8).reshape(-1, 8)
+    cand = np.ascontiguousarray(ids, dtype=np.uint32)
+
+    lengths = [len(w) for w, _ in signals]
+    offsets = np.zeros(len(signals) + 1, dtype=np.uintp)
+    offsets[1:] = np.cumsum(lengths)
+    windows = np.ascontiguousarray(
+        np.concatenate([np.asarray(w, dtype=np.int64) for w, _ in signals])
+        if signals else np.zeros(0, dtype=np.int64))
+    values = np.ascontiguousarray(
+        np.concatenate([np.asarray(v, dtype=np.float64) for _, v in signals])
+        if signals else np.zeros(0, dtype=np.float64))
+
+    corr = np.empty((len(signals), len(cand), FEATURES), dtype=np.float64)
+    counts = np.zeros((len(signals), len(cand)), dtype=np.uint32)
+
+    frames = _Frames(_ptr(ts, ctypes.c_int64), _ptr(cid, ctypes.c_uint32),
+                     _ptr(payload, ctypes.c_uint8), len(ts))
+    sigs = _Signals(_ptr(windows, ctypes.c_int64), _ptr(values, ctypes.c_double),
+                    _ptr(offsets, ctypes.c_size_t), len(signals))
+    err = lib.can_corr_run(ctypes.byref(frames), _ptr(cand, ctypes.c_uint32), len(cand),
+                           ctypes.byref(sigs), int(window_us), int(min_windows), int(threads),
+                           _ptr(corr, ctypes.c_double), _ptr(counts, ctypes.c_uint32))
+    if err != 0:
+        raise RuntimeError(f"can_corr_run failed: {_ERRORS.get(err, err)}")
+    return corr, counts
@@ -0,0 +1,296 @@
+#!/usr/bin/env python3
+"""
+Receive the device's live CAN stream (components/can_stream).
+
+Reads COBS-framed packets from a serial port (USB-CDC or UART bridge),
+a pty, or a capture file, checks CRCs and sequence numbers, and can
+
+- republish the frames as SLCAN on a new pty (--pty), which SavvyCAN and
+  other LAWICEL tools open as a serial CAN adapter,
+- write them to CSV in the bin_to_csv.py column layout (--csv),
+- print them as they arrive (--print).
+
+Link statistics (frames/s, frames lost by sequence gaps, bad packets and
+the drop counters from the device's status packets) go to stderr once a
+second.
+"""
+
+import argparse
+import os
+import select
+import struct
+import sys
+import time
+
+try:
+    import termios
+    import tty
+except ImportError:  # Windows: files only
+    termios = None
+    tty = None
+
+PKT_FRAME = 0x01
+PKT_STATUS = 0x02
+ID_EXTENDED = 1 << 31
+ID_RTR = 1 << 30
+ID_MASK = 0x1FFFFFFF
+
+CSV_HEADER = "datetime,timestamp_us,can_id,dlc,b0,b1,b2,b3,b4,b5,b6,b7\n"
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as can_stream_crc16()."""
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_decode(block):
+    out = bytearray()
+    i = 0
+    while i < len(block):
+        code = block[i]
+        i += 1
+        if code == 0 or i + code - 1 > len(block):
+            raise ValueError("bad COBS code")
+        chunk = block[i:i + code - 1]
+        if 0 in chunk:
+            raise ValueError("zero inside COBS block")
+        out += chunk
+        i += code - 1
+        if code != 0xFF and i < len(block):
+            out.append(0)
+    return bytes(out)
+
+
+def decode_packet(block):
+    """Decode one COBS block (without delimiter) into a dict, or raise ValueError."""
+    raw = cobs_decode(block)
+    if len(raw) < 5:
+        raise ValueError("short packet")
+    body, crc = raw[:-2], struct.unpack("<H", raw[-2:])[0]
+    if crc16(body) != crc:
+        raise ValueError("CRC mismatch")
+
+    kind = body[0]
+    if kind == PKT_FRAME:
+        if len(body) < 12 or body[11] > 8 or len(body) != 12 + body[11]:
+            raise ValueError("bad frame length")
+        seq, ts, can_id, dlc = struct.unpack("<HIIB", body[1:12])
+        return {"type": kind, "seq": seq, "timestamp_us": ts, "id": can_id,
+                "dlc": dlc, "data": body[12:12 + dlc]}
+    if kind == PKT_STATUS:
+        if len(body) != 11:
+            raise ValueError("bad status length")
+        seq, dropped, link_errors = struct.unpack("<HII", body[1:11])
+        return {"type": kind, "seq": seq, "dropped": dropped, "link_errors": link_errors}
+    raise ValueError(f"unknown packet type {kind}")
+
+
+def open_source(path, baud):
+    if path == "-":
+        return sys.stdin.buffer.fileno()
+
+    fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+    if termios and os.isatty(fd):
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        speed = getattr(termios, f"B{baud}", None)
+        if speed is None:
+            print(f"Note: baud {baud} not supported by termios, leaving port speed as is",
+                  file=sys.stderr)
+        else:
+            attrs[4] = attrs[5] = speed
+            termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+class SlcanPty:
+    """SLCAN (LAWICEL) adapter emulation on a pty."""
+
+    def __init__(self):
+        self.master, slave = os.openpty()
+        tty.setraw(slave)
+        self.name = os.ttyname(slave)
+        self._slave = slave  # Kept open so the pty survives client reconnects
+        self.timestamps = False
+        self.cmd = b""
+
+    def frame(self, can_id, dlc, data, timestamp_us):
+        ext = bool(can_id & ID_EXTENDED)
+        rtr = bool(can_id & ID_RTR)
+        cid = can_id & ID_MASK
+        prefix = ("R" if rtr else "T") if ext else ("r" if rtr else "t")
+        line = f"{prefix}{cid:08X}" if ext else f"{prefix}{cid:03X}"
+        line += f"{dlc:d}"
+        if not rtr:
+            line += data.hex().upper()
+        if self.timestamps:
+            line += f"{(timestamp_us // 1000) % 60000:04X}"
+        self._write((line + "\r").encode())
+
+    def service(self):
+        """Answer commands from the client (open, bitrate, version, ...)."""
+        while select.select([self.master], [], [], 0)[0]:
+            try:
+                self.cmd += os.read(self.master, 256)
+            except OSError:
+                return
+            while b"\r" in self.cmd:
+                line, self.cmd = self.cmd.split(b"\r", 1)
+                self._write(self._reply(line.decode(errors="replace")))
+
+    def _reply(self, line):
+        if line.startswith("V"):
+            return b"V1013\r"
+        if line.startswith("v"):
+            return b"v1013\r"
+        if line.startswith("N"):
+            return b"NCS01\r"
+        if line.startswith("Z"):
+            self.timestamps = line[1:2] == "1"
+        # Bitrate, open and close are accepted but fixed by the device
+        return b"\r"
+
+    def _write(self, data):
+        try:
+            os.write(self.master, data)
+        except OSError:
+            pass  # Nobody attached, or the client is slow: drop like an adapter would
+
+
+class Stats:
+    def __init__(self):
+        self.frames = 0
+        self.lost = 0
+        self.bad = 0
+        self.dev_dropped = 0
+        self.dev_link_errors = 0
+        self.next_seq = None
+        self.window_frames = 0
+        self.window_start = time.monotonic()
+
+    def seq(self, seq):
+        if self.next_seq is not None and seq != self.next_seq:
+            self.lost += (seq - self.next_seq) & 0xFFFF
+        self.next_seq = (seq + 1) & 0xFFFF
+
+    def report(self, force=False):
+        now = time.monotonic()
+        elapsed = now - self.window_start
+        if elapsed < 1.0 and not force:
+            return
+        rate = self.window_frames / elapsed if elapsed > 0 else 0.0
+        print(f"{rate:7.0f} fr/s  frames={self.frames} lost={self.lost} bad={self.bad} "
+              f"dev_drop={self.dev_dropped} dev_link_err={self.dev_link_errors}",
+              file=sys.stderr)
+        self.window_frames = 0
+        self.window_start = now
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Receive the live CAN stream from the device")
+    parser.add_argument("port", help="Serial port, pty or capture file ('-' for stdin)")
+    parser.add_argument("--baud", type=int, default=2000000,
+                        help="UART baud rate (ignored for USB-CDC; default 2000000)")
+    parser.add_argument("--pty", action="store_true",
+                        help="Republish frames as SLCAN on a new pty (for SavvyCAN)")
+    parser.add_argument("--csv", help="Write frames to this CSV file")
+    parser.add_argument("--print", action="store_true", dest="print_frames",
+                        help="Print each frame to stdout")
+    args = parser.parse_args()
+
+    if args.pty and not tty:
+        print("--pty needs a POSIX system", file=sys.stderr)
+        return 1
+
+    try:
+        fd = open_source(args.port, args.baud)
+    except OSError as exc:
+        print(f"Cannot open {args.port}: {exc}", file=sys.stderr)
+        return 1
+
+    slcan = SlcanPty() if args.pty else None
+    if slcan:
+        print(f"SLCAN pty: {slcan.name}", file=sys.stderr)
+
+    csv_out = open(args.csv, "w", encoding="utf-8") if args.csv else None
+    if csv_out:
+        csv_out.write(CSV_HEADER)
+
+    stats = Stats()
+    pending = b""
+    first = True    # Joining mid-stream, the first block may be a partial packet
+    ts_high = 0     # Upper bits of the 32-bit device timestamp
+    ts_last = None
+
+    try:
+        while True:
+            readable = select.select([fd], [], [], 0.2)[0]
+            if slcan:
+                slcan.service()
+            stats.report()
+            if not readable:
+                continue
+
+            chunk = os.read(fd, 65536)
+            if not chunk:
+                break
+
+            pending += chunk
+            *blocks, pending = pending.split(b"\x00")
+            for block in blocks:
+                if not block:
+                    continue
+                try:
+                    pkt = decode_packet(block)
+                except ValueError:
+                    if not first:
+                        stats.bad += 1
+                    first = False
+                    continue
+                first = False
+
+                if pkt["type"] == PKT_STATUS:
+                    stats.dev_dropped = pkt["dropped"]
+                    stats.dev_link_errors = pkt["link_errors"]
+                    continue
+
+                stats.seq(pkt["seq"])
+                stats.frames += 1
+                stats.window_frames += 1
+
+                ts = pkt["timestamp_us"]
+                if ts_last is not None and ts < ts_last:
+                    ts_high += 1 << 32
+                ts_last = ts
+                timestamp_us = ts_high + ts
+
+                can_id, dlc, data = pkt["id"], pkt["dlc"], pkt["data"]
+                if slcan:
+                    slcan.frame(can_id, dlc, data, timestamp_us)
+                if csv_out or args.print_frames:
+                    cid = can_id & ID_MASK
+                    id_str = f"{cid:08X}" if can_id & ID_EXTENDED else f"{cid:03X}"
+                    padded = bytes(data) + bytes(8 - dlc)
+                    if csv_out:
+                        csv_out.write(",".join(["", str(timestamp_us), id_str, str(dlc),
+                                                *(f"{b:02X}" for b in padded)]) + "\n")
+                    if args.print_frames:
+                        print(f"{timestamp_us / 1e6:14.6f} {id_str:>8} [{dlc}] "
+                              f"{' '.join(f'{b:02X}' for b in data)}")
+    except KeyboardInterrupt:
+        pass
+    finally:
+        stats.report(force=True)
+        if csv_out:
+            csv_out.close()
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,482 @@
+#!/usr/bin/env python3
+"""
+Shared CAN log loader: CANBIN files, CSV exports and text captures as numpy.
+
+    import canbin
+
+    log = canbin.open_log("CAN_20250101_120000_000000.bin")
+    ids, counts = log.ids()
+    rpm = log.frames_of(0x1D0)
+    rpm_value = canbin.field(rpm["data"], 7, 16, big_endian=True) / 4
+
+.bin files in the logger's CANBIN v1 format (docs/BINARY_LOGGING.md) are
+memory-mapped through RECORD_DTYPE, which mirrors can_bin_record_v1_t:
+opening a file reads nothing, and the columns (log.timestamp_us,
+log.can_id, log.dlc, log.data) are views of the mapping. Per-ID access
+goes through one stable argsort of the IDs, built on first use.
+
+Any other input is parsed once and cached as CANBIN next to the source
+(drive.csv -> drive.csv.bin); the cache is rebuilt when the source is
+newer. Understood inputs:
+
+  - CSV from bin_to_csv.py (b0..b7 columns) or the older exporter
+    (byte0..byte7 columns); a missing dlc column means 8
+  - text captures with "ID: 0x123 DLC: 8 Data: 00 11 ..." lines; the
+    ESP log "(ms)" prefix gives the timestamp
+  - headerless 19-byte records from the old convert_csv_to_bin.py
+
+Bit fields follow the DBC convention of field_search.py: bit b is bit
+(b % 8) of byte (b / 8); a little-endian field starts at its LSB, a
+big-endian (Motorola) field at its MSB.
+"""
+
+import datetime as dt
+import os
+import re
+import struct
+from pathlib import Path
+
+import numpy as np
+
+HEADER_FMT = "<8sHHQQII28s"
+HEADER_SIZE = 64
+RECORD_SIZE = 24
+MAGIC_PREFIX = b"CANBIN\x00"
+VERSION = 1
+HEADER_FLAG_TIMEBASE = 0x01
+RECORD_FLAG_META = 0x01
+META_TRAILER = 0x01
+META_SYNC = 0x02
+META_EVENT = 0x03
+
+# can_bin_record_v1_t
+RECORD_DTYPE = np.dtype([
+    ("timestamp_us", "<u8"),
+    ("can_id", "<u4"),
+    ("dlc", "u1"),
+    ("flags", "u1"),
+    ("data", "u1", 8),
+    ("reserved", "<u2"),
+])
+
+# Headerless records of the old convert_csv_to_bin.py
+LEGACY_DTYPE = np.dtype([
+    ("timestamp_us", "<u8"),
+    ("can_id", "<u2"),
+    ("dlc", "u1"),
+    ("data", "u1", 8),
+])
+
+TEXT_FRAME = re.compile(r"ID:\s*0x([0-9A-Fa-f]+)\s+DLC:\s*(\d+)\s+Data:\s*([0-9A-Fa-f \t]*)")
+TEXT_TIME = re.compile(r"^\s*[EWIDV] \((\d+)\)")
+
+HEX = np.array([f"{b:02X}" for b in range(256)])
+
+
+def parse_header(data):
+    if len(data) < HEADER_SIZE:
+        raise ValueError("File too small for header")
+
+    magic, version, header_size, log_start_unix_us, log_start_mono_us, record_size, flags, _ = \
+        struct.unpack(HEADER_FMT, data[:HEADER_SIZE])
+
+    if not magic.startswith(MAGIC_PREFIX):
+        raise ValueError(f"Bad magic: {magic!r}")
+    if version != VERSION:
+        raise ValueError(f"Unsupported version: {version}")
+    if header_size != HEADER_SIZE:
+        raise ValueError(f"Unexpected header size: {header_size}")
+    if record_size != RECORD_SIZE:
+        raise ValueError(f"Unexpected record size: {record_size}")
+
+    return {
+        "log_start_unix_us": log_start_unix_us,
+        "log_start_monotonic_us": log_start_mono_us,
+        "flags": flags,
+    }
+
+
+def make_header(start_unix_us=0, start_mono_us=0, flags=0):
+    return struct.pack(HEADER_FMT, MAGIC_PREFIX, VERSION, HEADER_SIZE, start_unix_us,
+                       start_mono_us, RECORD_SIZE, flags, b"")
+
+
+def make_records(timestamp_us, can_id, dlc, data):
+    """CAN frame records from columns (data: N x 8 bytes)."""
+    records = np.zeros(len(can_id), dtype=RECORD_DTYPE)
+    records["timestamp_us"] = timestamp_us
+    records["can_id"] = can_id
+    records["dlc"] = dlc
+    records["data"] = data
+    return records
+
+
+def write_bin(path, records, start_unix_us=0, start_mono_us=0, flags=0):
+    """Write a CANBIN file; replaces path only once it is complete."""
+    tmp = Path(str(path) + ".tmp")
+    with open(tmp, "wb") as f:
+        f.write(make_header(start_unix_us, start_mono_us, flags))
+        f.write(np.ascontiguousarray(records, dtype=RECORD_DTYPE).tobytes())
+    os.replace(tmp, path)
+
+
+def wall_clock(records, anchor_unix_us, anchor_mono_us):
+    """Unix time of each record, anchored on the header start then each sync.
+
+    Returns (unix_us, anchor_unix_us, anchor_mono_us) with the anchor after
+    the last record, so a file can be mapped chunk by chunk. unix_us is 0
+    where no wall clock is known (RTC not set and no sync yet).
+    """
+    ts = records["timestamp_us"].astype(np.int64)
+    sync = ((records["flags"] & RECORD_FLAG_META) != 0) & (records["can_id"] == META_SYNC)
+
+    latest = np.maximum.accumulate(np.where(sync, np.arange(len(records)), -1))
+    sync_unix = np.ascontiguousarray(records["data"]).view("<i8").reshape(-1)
+    anchor_unix = np.where(latest >= 0, sync_unix[latest], anchor_unix_us)
+    anchor_mono = np.where(latest >= 0, ts[latest], anchor_mono_us)
+    if sync.any():
+        anchor_unix_us = int(sync_unix[latest[-1]])
+        anchor_mono_us = int(ts[latest[-1]])
+
+    unix_us = np.where(anchor_unix != 0, anchor_unix + (ts - anchor_mono), 0)
+    return unix_us, anchor_unix_us, anchor_mono_us
+
+
+def format_datetimes(unix_us):
+    """Local "YYYY-MM-DD HH:MM:SS.mmm" strings; "" where unix_us is 0."""
+    unix_us = np.asarray(unix_us, dtype=np.int64)
+    seconds, inverse = np.unique(unix_us // 1_000_000, return_inverse=True)
+    texts = np.array([dt.datetime.fromtimestamp(int(s)).strftime("%Y-%m-%d %H:%M:%S.")
+                      for s in seconds], dtype=object)[inverse]
+    millis = np.array([f"{m:03d}" for m in range(1000)], dtype=object)
+    texts = texts + millis[(unix_us % 1_000_000) // 1000]
+    texts[unix_us == 0] = ""
+    return texts
+
+
+def _payload(data):
+    """uint64 per frame, byte 0 in the low bits."""
+    return np.ascontiguousarray(data, dtype=np.uint8).reshape(-1, 8).view("<u8").reshape(-1)
+
+
+def _field_shift(start, length, big_endian):
+    if not 1 <= length <= 64 or not 0 <= start < 64:
+        raise ValueError(f"bad field {start}|{length}")
+    if big_endian:
+        shift = (7 - start // 8) * 8 + start % 8 - length + 1
+    else:
+        shift = start if start + length <= 64 else -1
+    if shift < 0:
+        raise ValueError(f"field {start}|{length}@{0 if big_endian else 1} runs past byte 7")
+    return shift
+
+
+def field_bytes(start, length, big_endian=False):
+    """Bytes a frame needs (DLC) to carry the whole field."""
+    shift = _field_shift(start, length, big_endian)
+    if big_endian:
+        return 8 - shift // 8
+    return (start + length - 1) // 8 + 1
+
+
+def field(data, start, length, big_endian=False, signed=False):
+    """Raw value of a bit field for every frame (data: N x 8 bytes).
+
+    Returns int64 (uint64 for unsigned 64-bit fields).
+    """
+    shift = _field_shift(start, length, big_endian)
+    payload = _payload(data)
+    if big_endian:
+        payload = payload.byteswap()
+    raw = payload >> np.uint64(shift)
+    if length == 64:
+        return raw.view(np.int64) if signed else raw
+    raw = (raw & np.uint64((1 << length) - 1)).astype(np.int64)
+    if signed:
+        raw -= ((raw >> (length - 1)) & 1) << length
+    return raw
+
+
+def hex_bytes(data, dlc=None):
+    """"00 11 22" strings of the first dlc bytes of each frame."""
+    data = np.ascontiguousarray(data, dtype=np.uint8).reshape(-1, 8)
+    rows = np.empty((len(data), 9), dtype=np.uint8)
+    rows[:, :8] = data
+    rows[:, 8] = 8 if dlc is None else np.minimum(dlc, 8)
+    unique, inverse = np.unique(rows.view("V9").reshape(-1), return_inverse=True)
+    unique = np.frombuffer(unique.tobytes(), dtype=np.uint8).reshape(-1, 9)
+    texts = np.array([" ".join(HEX[row[:row[8]]]) for row in unique], dtype=object)
+    return texts[inverse.reshape(-1)]
+
+
+def patterns(frames):
+    """Distinct payloads (first dlc bytes) of frames, most frequent first.
+
+    Returns (data, dlc, counts, inverse): one row per pattern, with ties in
+    order of first appearance, and the pattern index of every frame.
+    """
+    dlc = np.minimum(frames["dlc"], 8)
+    rows = np.zeros((len(frames), 9), dtype=np.uint8)
+    rows[:, :8] = frames["data"]
+    rows[:, :8][np.arange(8) >= dlc[:, None]] = 0
+    rows[:, 8] = dlc
+    _, first, inverse, counts = np.unique(rows.view("V9").reshape(-1), return_index=True,
+                                          return_inverse=True, return_counts=True)
+    order = np.lexsort((first, -counts))
+    rank = np.empty(len(order), dtype=np.intp)
+    rank[order] = np.arange(len(order))
+    unique = rows[first[order]]
+    return unique[:, :8], unique[:, 8], counts[order], rank[inverse.reshape(-1)]
+
+
+class Log:
+    """A CAN log as numpy arrays: all records in file order, plus the frames."""
+
+    def __init__(self, records, header=None, path=None):
+        self.path = path
+        self.header = header or {"log_start_unix_us": 0, "log_start_monotonic_us": 0, "flags": 0}
+        self.records = records
+        meta = (records["flags"] & RECORD_FLAG_META) != 0
+        self.frames = records[~meta] if meta.any() else records
+        self._group = None
+        self._payload = None
+
+    def __len__(self):
+        return len(self.frames)
+
+    @property
+    def timestamp_us(self):
+        return self.frames["timestamp_us"]
+
+    @property
+    def can_id(self):
+        return self.frames["can_id"]
+
+    @property
+    def dlc(self):
+        return self.frames["dlc"]
+
+    @property
+    def data(self):
+        return self.frames["data"]
+
+    def payload(self):
+        """uint64 payload of every frame, byte 0 in the low bits."""
+        if self._payload is None:
+            self._payload = _payload(self.data)
+        return self._payload
+
+    def duration_s(self):
+        if len(self) < 2:
+            return 0.0
+        ts = self.timestamp_us
+        return (int(ts.max()) - int(ts.min())) / 1e6
+
+    def meta(self, kind=None):
+        """Meta records (sync, trailer, event), optionally of one kind."""
+        meta = self.records[(self.records["flags"] & RECORD_FLAG_META) != 0]
+        return meta if kind is None else meta[meta["can_id"] == kind]
+
+    def unix_us(self):
+        """Wall-clock time of every frame (0 where unknown)."""
+        unix_us, _, _ = wall_clock(self.records, self.header["log_start_unix_us"],
+                                   self.header["log_start_monotonic_us"])
+        if self.frames is self.records:
+            return unix_us
+        return unix_us[(self.records["flags"] & RECORD_FLAG_META) == 0]
+
+    def _grouping(self):
+        if self._group is None:
+            can_id = np.ascontiguousarray(self.can_id)
+            if not len(can_id) or can_id.max() < 0x10000:
+                # 16-bit keys take numpy's radix sort
+                keys = can_id.astype(np.uint16)
+                counts = np.bincount(keys, minlength=1)
+                ids = np.flatnonzero(counts).astype(np.uint32)
+                counts = counts[ids]
+            else:
+                ids, keys, counts = np.unique(can_id, return_inverse=True, return_counts=True)
+                keys = keys.reshape(-1)
+            order = np.argsort(keys, kind="stable")
+            starts = np.concatenate(([0], np.cumsum(counts)[:-1])).astype(np.intp)
+            self._group = (order, ids, starts, counts)
+        return self._group
+
+    def ids(self):
+        """(IDs ascending, frame count of each)."""
+        _, ids, _, counts = self._grouping()
+        return ids, counts
+
+    def index_of(self, can_id):
+        """Frame positions of one ID, in file order."""
+        order, ids, starts, counts = self._grouping()
+        i = int(np.searchsorted(ids, can_id))
+        if i == len(ids) or ids[i] != can_id:
+            return np.zeros(0, dtype=np.intp)
+        return order[starts[i]:starts[i] + counts[i]]
+
+    def frames_of(self, can_id):
+        """Frames of one ID, in file order."""
+        return self.frames[self.index_of(can_id)]
+
+    def distinct_payloads(self):
+        """Number of distinct 8-byte payloads of each ID, aligned with ids()."""
+        order, ids, starts, counts = self._grouping()
+        if not len(order):
+            return np.zeros(0, dtype=np.int64)
+        group = np.empty(len(order), dtype=np.intp)
+        group[order] = np.repeat(np.arange(len(ids)), counts)
+        # Sort by payload, then (stable) by ID: payloads ascend within each ID
+        by_payload = np.argsort(self.payload())
+        sorted_ = by_payload[np.argsort(group[by_payload], kind="stable")]
+        payload, group = self.payload()[sorted_], group[sorted_]
+        new = np.ones(len(payload), dtype=bool)
+        new[1:] = (payload[1:] != payload[:-1]) | (group[1:] != group[:-1])
+        return np.add.reduceat(new.astype(np.int64), starts)
+
+
+def map_bin(path):
+    """Log of a CANBIN v1 file, memory-mapped; ValueError if it isn't one."""
+    path = Path(path)
+    with open(path, "rb") as f:
+        header = parse_header(f.read(HEADER_SIZE))
+    count = (path.stat().st_size - HEADER_SIZE) // RECORD_SIZE
+    if count:
+        records = np.memmap(path, dtype=RECORD_DTYPE, mode="r", offset=HEADER_SIZE,
+                            shape=(count,))
+    else:
+        records = np.zeros(0, dtype=RECORD_DTYPE)
+    return Log(records, header, path)
+
+
+def read_legacy_bin(path):
+    """Records of a headerless 19-byte .bin from the old convert_csv_to_bin.py."""
+    size = Path(path).stat().st_size
+    if size % LEGACY_DTYPE.itemsize:
+        raise ValueError("Not a CANBIN file (bad magic) nor 19-byte legacy records")
+    old = np.fromfile(path, dtype=LEGACY_DTYPE)
+    return make_records(old["timestamp_us"], old["can_id"], old["dlc"], old["data"])
+
+
+def _parse_ints(column, base, default=-1):
+    """int(x, base) of a string column, once per distinct value; default where it fails."""
+    import pandas as pd
+
+    codes, uniques = pd.factorize(column)
+    values = np.empty(len(uniques) + 1, dtype=np.int64)
+    values[-1] = default
+    for i, text in enumerate(uniques):
+        try:
+            values[i] = int(text, base) if text.strip() else default
+        except ValueError:
+            values[i] = default
+    return values[codes]
+
+
+def read_csv(path, errors=None):
+    """Records of a CSV log; rejected rows go to errors as (line, reason, row)."""
+    import pandas as pd
+
+    df = pd.read_csv(path, dtype=str, keep_default_na=False, skipinitialspace=True)
+    df.columns = [c.strip() for c in df.columns]
+    if "can_id" not in df:
+        raise ValueError("CSV has no can_id column")
+    prefix = "b" if "b0" in df else "byte"
+    n = len(df)
+
+    timestamp_us = (_parse_ints(df["timestamp_us"], 10) if "timestamp_us" in df
+                    else np.zeros(n, dtype=np.int64))
+    can_id = _parse_ints(df["can_id"], 16)
+    dlc = _parse_ints(df["dlc"], 10) if "dlc" in df else np.full(n, 8)
+    data = np.zeros((n, 8), dtype=np.uint8)
+    for i in range(8):
+        if f"{prefix}{i}" in df:
+            data[:, i] = _parse_ints(df[f"{prefix}{i}"], 16, 0) & 0xFF
+
+    bad_dlc = dlc > 8
+    good = (timestamp_us >= 0) & (can_id >= 0) & (dlc >= 0) & ~bad_dlc
+    if errors is not None and not good.all():
+        for row in np.flatnonzero(~good):
+            reason = f"Invalid DLC: {dlc[row]}" if bad_dlc[row] else "CSV parse error"
+            errors.append((int(row) + 2, reason, ",".join(df.iloc[row])))
+    return make_records(timestamp_us[good], can_id[good], dlc[good], data[good])
+
+
+def read_text(path, errors=None):
+    """Records of a text capture; rejected lines go to errors as (line, reason, text)."""
+    timestamps, ids, dlcs = [], [], []
+    data = bytearray()
+    timestamp_us = 0
+    with open(path, "r", encoding="utf-8", errors="ignore") as f:
+        for line_num, line in enumerate(f, 1):
+            if "ID:" not in line:
+                continue
+            match = TEXT_FRAME.search(line)
+            if not match:
+                if errors is not None and "DLC:" in line:
+                    errors.append((line_num, "No CAN pattern match", line.strip()))
+                continue
+            dlc = int(match.group(2))
+            payload = bytes(int(b, 16) & 0xFF for b in match.group(3).split()[:8])
+            if dlc > 8 or len(payload) < dlc:
+                if errors is not None:
+                    reason = (f"Invalid DLC: {dlc}" if dlc > 8 else
+                              f"Data length mismatch: DLC={dlc}, got {len(payload)} bytes")
+                    errors.append((line_num, reason, line.strip()))
+                continue
+            esp_time = TEXT_TIME.match(line)
+            if esp_time:
+                timestamp_us = int(esp_time.group(1)) * 1000
+            timestamps.append(timestamp_us)
+            ids.append(int(match.group(1), 16))
+            dlcs.append(dlc)
+            data += payload[:dlc].ljust(8, b"\0")
+    return make_records(np.array(timestamps, dtype=np.uint64), np.array(ids, dtype=np.uint32),
+                        np.array(dlcs, dtype=np.uint8),
+                        np.frombuffer(bytes(data), dtype=np.uint8).reshape(-1, 8))
+
+
+def is_csv(path):
+    with open(path, "r", encoding="utf-8", errors="ignore") as f:
+        first = f.readline()
+    return "can_id" in first and "," in first
+
+
+def cache_path(path):
+    path = Path(path)
+    return path.with_name(path.name + ".bin")
+
+
+def open_log(path, cache=True, errors=None):
+    """Log of any supported CAN log file.
+
+    CANBIN files are mapped in place. CSV and text logs are parsed, or read
+    from their cached CANBIN copy when it is newer than the source; with
+    cache=False nothing is read from or written to the cache. Passing an
+    errors list collects the rejected rows (and always parses the source).
+    """
+    path = Path(path)
+    with open(path, "rb") as f:
+        head = f.read(HEADER_SIZE)
+    if head.startswith(MAGIC_PREFIX):
+        return map_bin(path)
+    if path.suffix.lower() == ".bin":
+        return Log(read_legacy_bin(path), path=path)
+
+    cached = cache_path(path)
+    if cache and errors is None:
+        try:
+            if cached.stat().st_mtime_ns >= path.stat().st_mtime_ns:
+                log = map_bin(cached)
+                log.path = path
+                return log
+        except (OSError, ValueError):
+            pass
+
+    records = read_csv(path, errors) if is_csv(path) else read_text(path, errors)
+    if cache:
+        try:
+            write_bin(cached, records)
+        except OSError:
+            pass  # Read-only log directory: parse again next time
+    return Log(records, path=path)
@@ -0,0 +1,329 @@
+#!/usr/bin/env python3
+"""
+Merge a CANBIN archive onto one timeline and split it into drive cycles.
+
+The logger starts a new CAN_<timestamp>.bin whenever logging restarts, so
+one drive can span several files and one file several drives. This tool
+reads any number of .bin files (or directories of them), places every
+record on the wall-clock timeline (header log_start_unix_us, then the sync
+records, as in docs/BINARY_LOGGING.md), merges the files in time order and
+writes one CANBIN file per drive cycle:
+
+    OUT/DRIVE_YYYYMMDD_HHMMSS_NNNNNN.bin
+
+A drive ends after --gap-s seconds without CAN frames, or when the
+--ignition bit turns on again after being off. With --shard-ids each
+drive's frames are also written per ID (OUT/DRIVE_..._NNNNNN/<ID>.bin), so
+one signal's history is a single small file.
+
+Output files have header log_start_unix_us = drive start and
+log_start_monotonic_us = 0, so record timestamps are microseconds since the
+drive started. Sync and trailer records are consumed; event records are
+kept with remapped timestamps. Files without a valid start time (RTC not
+set) cannot be placed and are skipped.
+
+Files are read in fixed-size chunks and only while they overlap the merge
+point, so memory stays constant however large the archive is.
+"""
+
+import argparse
+import datetime as dt
+import sys
+from pathlib import Path
+
+import numpy as np
+
+from canbin import (HEADER_FLAG_TIMEBASE, HEADER_SIZE, META_SYNC, META_TRAILER, RECORD_DTYPE,
+                    RECORD_FLAG_META, RECORD_SIZE, make_header, parse_header, wall_clock)
+
+CHUNK_RECORDS = 65536
+# A file's first records may precede its header start by the sync jitter
+ACTIVATE_MARGIN_US = 1_000_000
+
+
+class Source:
+    """One input file, read a chunk at a time with records in unix time."""
+
+    def __init__(self, index, path, header):
+        self.index = index
+        self.path = path
+        self.start_us = header["log_start_unix_us"]
+        self.timebase = bool(header["flags"] & HEADER_FLAG_TIMEBASE)
+        self.anchor_unix_us = header["log_start_unix_us"]
+        self.anchor_mono_us = header["log_start_monotonic_us"]
+        self.last_us = None
+        self.file = None
+        self.eof = False
+        self.records = np.zeros(0, dtype=RECORD_DTYPE)
+        self.unix_us = np.zeros(0, dtype=np.int64)
+
+    def open(self):
+        self.file = open(self.path, "rb")
+        self.file.seek(HEADER_SIZE)
+
+    def close(self):
+        if self.file:
+            self.file.close()
+            self.file = None
+
+    def fill(self):
+        """Read the next chunk once the buffer is empty; False at end of file."""
+        while not len(self.records) and not self.eof:
+            raw = self.file.read(CHUNK_RECORDS * RECORD_SIZE)
+            count = len(raw) // RECORD_SIZE
+            if count < CHUNK_RECORDS:
+                self.eof = True
+                if len(raw) % RECORD_SIZE:
+                    print(f"Warning: {self.path}: ignoring {len(raw) % RECORD_SIZE} trailing "
+                          "bytes (truncated file)", file=sys.stderr)
+            self._map(np.frombuffer(raw, dtype=RECORD_DTYPE, count=count))
+        if self.eof and not len(self.records):
+            self.close()
+            return False
+        return True
+
+    def _map(self, records):
+        meta = (records["flags"] & RECORD_FLAG_META) != 0
+        sync = meta & (records["can_id"] == META_SYNC)
+        unix_us, self.anchor_unix_us, self.anchor_mono_us = wall_clock(
+            records, self.anchor_unix_us, self.anchor_mono_us)
+
+        # A sync may step time back by the drift it corrects; keep file order
+        unix_us = np.maximum.accumulate(unix_us)
+        if self.last_us is not None:
+            unix_us = np.maximum(unix_us, self.last_us)
+        if len(unix_us):
+            self.last_us = int(unix_us[-1])
+
+        keep = ~sync & ~(meta & (records["can_id"] == META_TRAILER))
+        self.records = records[keep]
+        self.unix_us = unix_us[keep]
+
+    def take(self, bound_us):
+        """Buffered records up to bound_us (inclusive)."""
+        n = int(np.searchsorted(self.unix_us, bound_us, side="right"))
+        out = (self.records[:n], self.unix_us[:n])
+        self.records = self.records[n:]
+        self.unix_us = self.unix_us[n:]
+        return out
+
+
+def merge(sources):
+    """Yield (records, unix_us, source_index) batches in time order."""
+    pending = sorted(sources, key=lambda s: (s.start_us, s.index))
+    active = []
+
+    def activate(source):
+        source.open()
+        if source.fill():
+            active.append(source)
+
+    while active or pending:
+        if not active:
+            activate(pending.pop(0))
+            continue
+        bound = min(int(s.unix_us[-1]) for s in active)
+        while pending and pending[0].start_us - ACTIVATE_MARGIN_US <= bound:
+            activate(pending.pop(0))
+            bound = min(int(s.unix_us[-1]) for s in active)
+
+        parts = [(s.index,) + s.take(bound) for s in active]
+        parts = [p for p in parts if len(p[1])]
+        if len(parts) == 1:
+            index, records, unix_us = parts[0]
+            yield records, unix_us, np.full(len(records), index, dtype=np.int32)
+        elif parts:
+            records = np.concatenate([p[1] for p in parts])
+            unix_us = np.concatenate([p[2] for p in parts])
+            index = np.concatenate([np.full(len(p[1]), p[0], dtype=np.int32) for p in parts])
+            order = np.argsort(unix_us, kind="stable")
+            yield records[order], unix_us[order], index[order]
+        active = [s for s in active if s.fill()]
+
+
+def _header(start_us, timebase):
+    return make_header(start_us, 0, HEADER_FLAG_TIMEBASE if timebase else 0)
+
+
+class Drive:
+    """Output of one drive cycle: the merged file and optional per-ID shards."""
+
+    def __init__(self, out_dir, seq, start_us, shard, write):
+        stamp = dt.datetime.fromtimestamp(start_us // 1_000_000).strftime("%Y%m%d_%H%M%S")
+        self.name = f"DRIVE_{stamp}_{seq:06d}"
+        self.start_us = start_us
+        self.end_us = start_us
+        self.records = 0
+        self.sources = set()
+        self.timebase = True
+        self.out_dir = out_dir
+        self.shard = shard
+        self.write_enabled = write
+        self.shards = {}
+        self.file = None
+        if write:
+            self.file = open(out_dir / f"{self.name}.bin", "wb")
+            self.file.write(_header(start_us, False))
+            if shard:
+                (out_dir / self.name).mkdir(exist_ok=True)
+
+    def write(self, records, unix_us, sources, timebase):
+        self.records += len(records)
+        self.end_us = int(unix_us[-1])
+        self.sources.update(int(i) for i in np.unique(sources))
+        self.timebase = self.timebase and timebase
+        if not self.write_enabled:
+            return
+
+        out = records.copy()
+        out["timestamp_us"] = (unix_us - self.start_us).astype(np.uint64)
+        self.file.write(out.tobytes())
+        if not self.shard:
+            return
+
+        frames = out[(out["flags"] & RECORD_FLAG_META) == 0]
+        ids = frames["can_id"]
+        order = np.argsort(ids, kind="stable")
+        frames, ids = frames[order], ids[order]
+        starts = np.flatnonzero(np.r_[True, ids[1:] != ids[:-1]]) if len(ids) else []
+        bounds = list(starts) + [len(ids)]
+        for a, b in zip(bounds[:-1], bounds[1:]):
+            can_id = int(ids[a])
+            f = self.shards.get(can_id)
+            if f is None:
+                f = open(self.out_dir / self.name / f"{can_id:03X}.bin", "wb")
+                f.write(_header(self.start_us, False))
+                self.shards[can_id] = f
+            f.write(frames[a:b].tobytes())
+
+    def close(self):
+        header = _header(self.start_us, self.timebase)
+        for f in [self.file] + list(self.shards.values()):
+            if f:
+                f.seek(0)
+                f.write(header)
+                f.close()
+
+
+def split_points(records, unix_us, state, gap_us, ignition):
+    """Batch indices where a new drive starts; updates state across batches."""
+    frames = np.flatnonzero((records["flags"] & RECORD_FLAG_META) == 0)
+    if not len(frames):
+        return np.zeros(0, dtype=np.int64)
+
+    t = unix_us[frames]
+    prev = state["last_frame_us"]
+    gaps = np.diff(np.r_[t[0] if prev is None else prev, t]) > gap_us
+    starts = frames[gaps]
+    state["last_frame_us"] = int(t[-1])
+
+    if ignition:
+        can_id, byte, mask = ignition
+        sel = frames[records["can_id"][frames] == can_id]
+        if len(sel):
+            on = (records["data"][sel, byte] & mask) != 0
+            first = on[0] if state["ignition_on"] is None else state["ignition_on"]
+            was = np.r_[first, on[:-1]]
+            starts = np.union1d(starts, sel[on & ~was])
+            state["ignition_on"] = bool(on[-1])
+    return starts
+
+
+def find_sources(paths, out_dir):
+    files = []
+    for p in paths:
+        p = Path(p)
+        if p.is_dir():
+            files += sorted(f for f in p.rglob("*") if f.suffix.lower() == ".bin")
+        else:
+            files.append(p)
+
+    out_dir = out_dir.resolve()
+    sources = []
+    for path in files:
+        if out_dir in path.resolve().parents:
+            continue
+        try:
+            with open(path, "rb") as f:
+                header = parse_header(f.read(HEADER_SIZE))
+        except (OSError, ValueError) as exc:
+            print(f"Skipping {path}: {exc}", file=sys.stderr)
+            continue
+        if header["log_start_unix_us"] == 0:
+            print(f"Skipping {path}: no wall-clock start (RTC not set)", file=sys.stderr)
+            continue
+        sources.append(Source(len(sources), path, header))
+    return sources
+
+
+def _ignition(text):
+    try:
+        can_id, byte, mask = text.split(":")
+        value = (int(can_id, 16), int(byte), int(mask, 0))
+    except ValueError:
+        raise SystemExit(f"Bad --ignition value: {text} (expected ID:BYTE:MASK)")
+    if not 0 <= value[1] <= 7 or not 0 < value[2] <= 0xFF:
+        raise SystemExit("--ignition BYTE must be 0-7 and MASK 1-0xFF")
+    return value
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Merge CANBIN logs and split them into drives.")
+    parser.add_argument("inputs", nargs="+", help=".bin files or directories of them")
+    parser.add_argument("-o", "--output", default="drives", help="Output directory (default: drives)")
+    parser.add_argument("--gap-s", type=float, default=60.0,
+                        help="Bus silence that ends a drive (default: 60)")
+    parser.add_argument("--ignition", help="Ignition bit ID:BYTE:MASK (e.g. 3B3:0:0x20); "
+                        "a drive also starts when it turns on")
+    parser.add_argument("--shard-ids", action="store_true",
+                        help="Also write each drive's frames per CAN ID")
+    parser.add_argument("--dry-run", action="store_true", help="List drives without writing")
+    args = parser.parse_args()
+
+    if args.gap_s <= 0:
+        raise SystemExit("--gap-s must be positive")
+    ignition = _ignition(args.ignition) if args.ignition else None
+    out_dir = Path(args.output)
+
+    sources = find_sources(args.inputs, out_dir)
+    if not sources:
+        print("No usable .bin files found.")
+        return 1
+    if not args.dry_run:
+        out_dir.mkdir(parents=True, exist_ok=True)
+
+    gap_us = int(args.gap_s * 1_000_000)
+    state = {"last_frame_us": None, "ignition_on": None}
+    drive = None
+    drives = []
+
+    def finish():
+        if drive is not None:
+            drive.close()
+            drives.append(drive)
+
+    for records, unix_us, index in merge(sources):
+        timebase = all(sources[i].timebase for i in np.unique(index))
+        cuts = [int(c) for c in split_points(records, unix_us, state, gap_us, ignition)]
+        if drive is None and (not cuts or cuts[0] != 0):
+            cuts = [0] + cuts
+        bounds = sorted(set([0] + cuts + [len(records)]))
+        for a, b in zip(bounds[:-1], bounds[1:]):
+            if a in cuts:
+                finish()
+                drive = Drive(out_dir, len(drives) + 1, int(unix_us[a]), args.shard_ids,
+                              not args.dry_run)
+            drive.write(records[a:b], unix_us[a:b], index[a:b], timebase)
+    finish()
+
+    print(f"{len(sources)} files -> {len(drives)} drives")
+    for d in drives:
+        start = dt.datetime.fromtimestamp(d.start_us / 1e6).strftime("%Y-%m-%d %H:%M:%S")
+        minutes = (d.end_us - d.start_us) / 60e6
+        print(f"  {d.name}: {start}, {minutes:.1f} min, {d.records} records, "
+              f"{len(d.sources)} files{'' if d.timebase else ' (1 s start resolution)'}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
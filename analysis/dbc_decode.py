@@ -1,54 +1,27 @@
 #!/usr/bin/env python3
 """
-Decode CAN logs using DBC files (cantools).
+Decode CAN logs using DBC files.
 
 Outputs one CSV per decoded message ID with timestamp + decoded signals.
+Signals are decoded into the log's signal store (signal_store.py), so only
+new logs and changed DBC definitions are decoded; repeat runs just read it.
 """
 
 import argparse
 from pathlib import Path
 
-import cantools
 import numpy as np
 import pandas as pd
 
-DBC_HEADER = """VERSION \"\"
-
-
-NS_ :
-    NS_DESC_
-    CM_
-    BA_DEF_
-    BA_
-    VAL_
-    CAT_DEF_
-    CAT_
-    FILTER
-    BA_DEF_DEF_
-    EV_DATA_
-    ENVVAR_DATA_
-    SGTYPE_
-    SGTYPE_VAL_
-    BA_DEF_SGTYPE_
-    BA_SGTYPE_
-    SIG_TYPE_REF_
-    VAL_TABLE_
-    SIG_GROUP_
-    SIG_VALTYPE_
-    SIGTYPE_VALTYPE_
-    BO_TX_BU_
-    BA_DEF_REL_
-    BA_REL_
-    BA_DEF_DEF_REL_
-    BU_SG_REL_
-    BU_EV_REL_
-    BU_BO_REL_
-    SG_MUL_VAL_
-
-BS_:
-
-BU_: XXX
-"""
+from signal_store import Signal, build, load_dbc
+
+# ABS reply to OBD mode 0x21 PID 0x47 on 0x7B8 (bytes 1-2 = 61 47)
+ABS_PID_47 = (15, 16, True, 0x6147)
+DIAG_SIGNALS = [
+    Signal(0x7B8, "lateral_g", 31, 8, True, True, 0.02, 0.0, ABS_PID_47),
+    Signal(0x7B8, "yaw_rate_deg_sec", 47, 8, True, False, 1.0, -128.0, ABS_PID_47),
+    Signal(0x7B8, "steering_angle_deg", 55, 16, True, False, 0.1, -3276.8, ABS_PID_47),
+]
 
 
 def parse_can_id(value):
@@ -58,77 +31,34 @@ def parse_can_id(value):
     return int(value, 16)
 
 
-def load_databases(paths):
-    databases = []
-    for path in paths:
-        content = Path(path).read_text(errors="ignore")
-        lines = []
-        for line in content.splitlines():
-            stripped = line.strip()
-            if stripped.startswith("CM_ \"") and not stripped.endswith(";"):
-                continue
-            if stripped.startswith("CM BO_"):
-                line = line.replace("CM BO_", "CM_ BO_", 1)
-                stripped = line.strip()
-            if stripped.startswith("CM_ BO_"):
-                continue
-            lines.append(line)
-        content = "\n".join(lines)
-        if "VERSION" not in content.splitlines()[:5]:
-            content = f"{DBC_HEADER}\n{content}"
-            databases.append(cantools.database.load_string(content, strict=False))
-        else:
-            databases.append(cantools.database.load_file(str(path), strict=False))
-    return databases
-
-
-def build_message_map(databases):
-    msg_map = {}
-    for db in databases:
-        for msg in db.messages:
-            if msg.frame_id not in msg_map:
-                msg_map[msg.frame_id] = msg
-    return msg_map
-
-
-def decode_message_rows(msg, rows, verbose=False):
-    decoded_rows = []
-    errors = 0
-
-    for row in rows.itertuples(index=False):
-        data = bytes([
-            int(row.b0, 16),
-            int(row.b1, 16),
-            int(row.b2, 16),
-            int(row.b3, 16),
-            int(row.b4, 16),
-            int(row.b5, 16),
-            int(row.b6, 16),
-            int(row.b7, 16),
-        ])
-        try:
-            decoded = msg.decode(data, decode_choices=False)
-        except Exception as e:
-            if verbose:
-                print(f"  Decode error at ts={row.timestamp_us}: {e}")
-            errors += 1
-            continue
-
-        decoded["timestamp_us"] = row.timestamp_us
-        if "ACCEL_Y" in decoded:
-            decoded["ACCEL_Y_G_EST"] = (decoded["ACCEL_Y"] * -0.002121) + -0.0126
-        decoded_rows.append(decoded)
+def decode_message(store, msg, verbose=False):
+    """Decoded rows of one DBC message; frames lacking a signal count as errors."""
+    names = [sig.name for sig in msg.signals]
+    df = store.frame(msg.can_id, names, dropna=False)
 
-    df_out = pd.DataFrame(decoded_rows)
-    if not df_out.empty:
-        df_out = df_out.sort_values("timestamp_us")
+    plain = [sig.name for sig in msg.signals if sig.mux is None]
+    muxed = [sig.name for sig in msg.signals if sig.mux is not None]
+    ok = df[plain].notna().all(axis=1)
+    if muxed:
+        ok &= df[muxed].notna().any(axis=1)
+    errors = int((~ok).sum())
+    if verbose:
+        for ts in df.loc[~ok, "timestamp_us"]:
+            print(f"  Decode error at ts={ts}: frame too short or unknown multiplexer value")
 
-    return df_out, errors
+    df = df[ok].reset_index(drop=True)
+    for sig in msg.signals:
+        if float(sig.scale).is_integer() and float(sig.offset).is_integer() and df[sig.name].notna().all():
+            df[sig.name] = df[sig.name].astype("int64")
+    df = df[names + ["timestamp_us"]]
+    if "ACCEL_Y" in df:
+        df["ACCEL_Y_G_EST"] = (df["ACCEL_Y"] * -0.002121) + -0.0126
+    return df, errors
 
 
 def main():
-    parser = argparse.ArgumentParser(description="Decode CAN log CSV using DBC files")
-    parser.add_argument("log_file", help="Path to CAN log CSV")
+    parser = argparse.ArgumentParser(description="Decode CAN logs using DBC files")
+    parser.add_argument("log_file", help="Path to CAN log (CANBIN, CSV or text)")
     parser.add_argument("--dbc", action="append", required=True, help="DBC file path")
     parser.add_argument("--ids", nargs="*", default=None, help="CAN IDs to decode (hex)")
     parser.add_argument("--out-dir", default="analysis/decoded", help="Output directory")
@@ -147,52 +77,29 @@ def main():
         if not path.exists():
             raise SystemExit(f"DBC file not found: {path}")
 
-    databases = load_databases(dbcs)
-    msg_map = build_message_map(databases)
+    msg_map = load_dbc(dbcs)
 
     if args.ids:
         target_ids = [parse_can_id(cid) for cid in args.ids]
     else:
         target_ids = sorted(msg_map.keys())
 
-    cols = [
-        "timestamp_us",
-        "can_id",
-        "b0",
-        "b1",
-        "b2",
-        "b3",
-        "b4",
-        "b5",
-        "b6",
-        "b7",
-    ]
-
-    df = pd.read_csv(log_path, usecols=cols, dtype=str)
-    df["timestamp_us"] = df["timestamp_us"].astype("int64")
-    df["can_id"] = df["can_id"].str.upper()
-    for col in ["b0", "b1", "b2", "b3", "b4", "b5", "b6", "b7"]:
-        df[col] = df[col].fillna("00").str.upper()
+    signals = []
+    for frame_id in target_ids:
+        if frame_id in msg_map:
+            signals += msg_map[frame_id].signals
+    if args.compare_obd:
+        signals += DIAG_SIGNALS
+    store = build(log_path, signals, verbose=True)
 
     out_dir = Path(args.out_dir)
     out_dir.mkdir(parents=True, exist_ok=True)
 
     diag_df = None
     if args.compare_obd:
-        abs_mask = (df["can_id"] == "7B8") & (df["b1"] == "61") & (df["b2"] == "47")
-        abs_df = df.loc[abs_mask, ["timestamp_us", "b3", "b4", "b5", "b6", "b7"]].copy()
-        if not abs_df.empty:
-            for col in ["b3", "b4", "b5", "b6", "b7"]:
-                abs_df[col] = abs_df[col].apply(lambda x: int(x, 16))
-            lat_g = abs_df["b3"].where(abs_df["b3"] <= 127, abs_df["b3"] - 256) / 50.0
-            yaw_rate = abs_df["b5"].astype(float) - 128.0
-            steering_angle = (((abs_df["b6"] * 256) + abs_df["b7"]).astype(float) / 10.0) - 3276.8
-            diag_df = pd.DataFrame({
-                "timestamp_us": abs_df["timestamp_us"].astype("int64"),
-                "lateral_g": lat_g,
-                "yaw_rate_deg_sec": yaw_rate,
-                "steering_angle_deg": steering_angle,
-            }).sort_values("timestamp_us")
+        diag_df = store.frame(0x7B8, [sig.name for sig in DIAG_SIGNALS])
+        if diag_df.empty:
+            diag_df = None
 
     def compare_with_obd(decoded_df, message_name):
         if diag_df is None or decoded_df.empty:
@@ -226,11 +133,10 @@ def main():
             continue
 
         hex_id = f"{frame_id:03X}"
-        subset = df[df["can_id"] == hex_id]
-        if subset.empty:
+        if not store.count(frame_id):
             continue
 
-        decoded_df, errors = decode_message_rows(msg, subset, verbose=args.verbose)
+        decoded_df, errors = decode_message(store, msg, verbose=args.verbose)
         if decoded_df.empty:
             print(f"{hex_id}: no decodable rows")
             continue
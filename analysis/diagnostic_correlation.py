@@ -3,6 +3,9 @@
 Diagnostic Correlation Analyzer
 
 Correlate broadcast CAN IDs with diagnostic PID values from OBD responses.
+
+Uses the native engine (can_correlate.py, built from analysis/native) when
+it is available and pandas otherwise; both print the same results.
 """
 
 import argparse
@@ -11,6 +14,8 @@ from pathlib import Path
 import numpy as np
 import pandas as pd
 
+import can_correlate
+
 
 DEFAULT_CANDIDATE_IDS = [
     "024",
@@ -178,7 +183,83 @@ def compute_feature_windows(msgs, window_ms):
     return _window_features(timestamps_us, features, window_ms)
 
 
-def correlate_signals(df, candidate_ids, window_ms, min_windows, top_n, signal_filter=None):
+def _frame_arrays(df):
+    """Numeric per-frame arrays for the native engine, in timestamp order."""
+    codes, uniques = pd.factorize(df["can_id"])
+    can_ids = np.array([int(x, 16) for x in uniques], dtype=np.uint32)[codes]
+    data = np.empty((len(df), 8), dtype=np.uint8)
+    for i in range(8):
+        codes, uniques = pd.factorize(df[f"b{i}"])
+        data[:, i] = np.array([int(x, 16) for x in uniques], dtype=np.uint8)[codes]
+    timestamps_us = df["timestamp_us"].to_numpy(dtype=np.int64)
+    if len(timestamps_us) > 1 and (np.diff(timestamps_us) < 0).any():
+        order = np.argsort(timestamps_us, kind="stable")
+        timestamps_us, can_ids, data = timestamps_us[order], can_ids[order], data[order]
+    return timestamps_us, can_ids, data
+
+
+def _native_results(df, diag_series, candidate_ids, window_ms, min_windows, threads):
+    """Results per signal name, in the same order as _python_results()."""
+    names = list(diag_series)
+    timestamps_us, can_ids, data = _frame_arrays(df)
+    signals = [(diag_series[name].index.to_numpy(dtype=np.int64) // window_ms,
+                diag_series[name].to_numpy(dtype=np.float64)) for name in names]
+    corr, windows = can_correlate.correlate(
+        timestamps_us, can_ids, data, [int(cid, 16) for cid in candidate_ids], signals,
+        window_ms * 1000, min_windows, threads)
+
+    feature_names = can_correlate.feature_names()
+    results = {}
+    for s, name in enumerate(names):
+        entries = []
+        for i, can_id in enumerate(candidate_ids):
+            for f, feature_name in enumerate(feature_names):
+                if not np.isnan(corr[s, i, f]):
+                    entries.append({
+                        "can_id": can_id,
+                        "feature": feature_name,
+                        "corr": float(corr[s, i, f]),
+                        "windows": int(windows[s, i]),
+                    })
+        results[name] = entries
+    return results
+
+
+def _python_results(df, diag_series, candidate_ids, window_ms, min_windows):
+    results = []
+    for can_id in candidate_ids:
+        msgs = df[df["can_id"] == can_id].copy()
+        if msgs.empty:
+            continue
+
+        features = compute_feature_windows(msgs, window_ms)
+        aligned = features.join(diag_series, how="inner")
+        if len(aligned) < min_windows:
+            continue
+
+        diag_values = aligned["value"]
+        if diag_values.std() == 0:
+            continue
+
+        feature_cols = [col for col in aligned.columns if col != "value"]
+        feature_std = aligned[feature_cols].std()
+        feature_cols = feature_std[feature_std > 0].index.tolist()
+        if not feature_cols:
+            continue
+
+        corr = aligned[feature_cols].corrwith(diag_values)
+        for feature_name, corr_value in corr.dropna().items():
+            results.append({
+                "can_id": can_id,
+                "feature": feature_name,
+                "corr": float(corr_value),
+                "windows": len(aligned),
+            })
+    return results
+
+
+def correlate_signals(df, candidate_ids, window_ms, min_windows, top_n, signal_filter=None,
+                      engine="auto", threads=0):
     signals = extract_diag_signals(df)
     if not signals:
         print("No diagnostic signals found.")
@@ -197,42 +278,28 @@ def correlate_signals(df, candidate_ids, window_ms, min_windows, top_n, signal_f
     for name, signal_df in sorted(signals.items()):
         print(f"- {name}: {len(signal_df)} samples")
 
+    diag_series = {}
     for signal_name, signal_df in sorted(signals.items()):
-        diag_series = _window_series(signal_df["timestamp_us"], signal_df["value"], window_ms)
-        if diag_series.std() == 0 or len(diag_series) < min_windows:
-            print(f"\n=== {signal_name} ===\nSkipped (insufficient variation or samples)")
+        series = _window_series(signal_df["timestamp_us"], signal_df["value"], window_ms)
+        if series.std() == 0 or len(series) < min_windows:
             continue
+        diag_series[signal_name] = series
 
-        results = []
-        for can_id in candidate_ids:
-            msgs = df[df["can_id"] == can_id].copy()
-            if msgs.empty:
-                continue
-
-            features = compute_feature_windows(msgs, window_ms)
-            aligned = features.join(diag_series, how="inner")
-            if len(aligned) < min_windows:
-                continue
-
-            diag_values = aligned["value"]
-            if diag_values.std() == 0:
-                continue
-
-            feature_cols = [col for col in aligned.columns if col != "value"]
-            feature_std = aligned[feature_cols].std()
-            feature_cols = feature_std[feature_std > 0].index.tolist()
-            if not feature_cols:
-                continue
-
-            corr = aligned[feature_cols].corrwith(diag_values)
-            for feature_name, corr_value in corr.dropna().items():
-                results.append({
-                    "can_id": can_id,
-                    "feature": feature_name,
-                    "corr": float(corr_value),
-                    "windows": len(aligned),
-                })
+    native = engine == "native" or (engine == "auto" and can_correlate.available())
+    if native:
+        native_results = _native_results(df, diag_series, candidate_ids, window_ms, min_windows,
+                                         threads)
 
+    for signal_name in sorted(signals):
+        if signal_name not in diag_series:
+            print(f"\n=== {signal_name} ===\nSkipped (insufficient variation or samples)")
+            continue
+
+        if native:
+            results = native_results[signal_name]
+        else:
+            results = _python_results(df, diag_series[signal_name], candidate_ids, window_ms,
+                                      min_windows)
         results.sort(key=lambda x: abs(x["corr"]), reverse=True)
 
         print(f"\n=== {signal_name} ===")
@@ -255,8 +322,15 @@ def main():
     parser.add_argument("--min-windows", type=int, default=20, help="Minimum aligned windows")
     parser.add_argument("--top", type=int, default=10, help="Top correlations to display per signal")
     parser.add_argument("--signals", nargs="*", default=None, help="Diagnostic signals to analyze")
+    parser.add_argument("--all-ids", action="store_true", help="Use every CAN ID in the log as a candidate")
+    parser.add_argument("--engine", choices=["auto", "native", "python"], default="auto",
+                        help="Correlation back end (auto: native if built)")
+    parser.add_argument("--threads", type=int, default=0, help="Native engine threads (0 = all cores)")
     args = parser.parse_args()
 
+    if args.engine == "native" and not can_correlate.available():
+        raise SystemExit("Native engine not built; see analysis/can_correlate.py")
+
     log_path = Path(args.log_file)
     if not log_path.exists():
         raise SystemExit(f"Log file not found: {log_path}")
@@ -268,7 +342,10 @@ def main():
             normalized = normalized[2:]
         candidate_ids.append(normalized)
     df = load_log(log_path)
-    correlate_signals(df, candidate_ids, args.window_ms, args.min_windows, args.top, args.signals)
+    if args.all_ids:
+        candidate_ids = sorted(df["can_id"].unique())
+    correlate_signals(df, candidate_ids, args.window_ms, args.min_windows, args.top, args.signals,
+                      args.engine, args.threads)
 
 
 if __name__ == "__main__":
@@ -0,0 +1,305 @@
+#!/usr/bin/env python3
+"""
+Field hypothesis search: find the bit field that carries a known quantity.
+
+Tests every (ID, start bit, length, byte order, signedness, scale, offset)
+hypothesis of a CAN log (any format canbin.py reads) against constraints
+on the decoded value
+
+    value = raw * scale + offset
+
+and prints the hypotheses that satisfy them, best first. Constraints:
+
+  --range MIN:MAX      values stay in this range (e.g. a tire pressure)
+  --target V[:TOL]     values stay within TOL of a known value
+  --max-step STEP      the value drifts slowly: at most STEP per frame
+  --trend DIRECTION    the value rises/falls over the log (Kendall tau)
+
+Only --min-fraction of the frames (and steps) need to comply, so dropouts
+and glitches don't hide a field. Fields are written DBC style, e.g.
+32|8@1+ is 8 bits from bit 32, little endian (@1) or big endian (@0),
+unsigned (+) or signed (-).
+
+The search runs in the native library (analysis/native/field_search.cpp);
+build it once with:
+
+    cmake -S analysis/native -B analysis/native/build
+    cmake --build analysis/native/build
+
+or point CAN_FIELD_SEARCH_LIB at a build elsewhere.
+
+Example, the missing rear tire pressure (~38 PSI, 0.23 PSI/bit):
+
+    python3 field_search.py drive.bin --target 38:4 --scales 0.23,0.25 --max-step 0.5
+"""
+
+import argparse
+import ctypes
+import math
+import sys
+import time
+from pathlib import Path
+
+import numpy as np
+
+import canbin
+from can_correlate import library_paths
+
+LIB_ENV = "CAN_FIELD_SEARCH_LIB"
+MAX_LEN = 32
+
+LAYOUT_LE_UNSIGNED = 0x01
+LAYOUT_LE_SIGNED = 0x02
+LAYOUT_BE_UNSIGNED = 0x04
+LAYOUT_BE_SIGNED = 0x08
+
+TRENDS = {"any": 0, "rising": 1, "falling": 2, "either": 3}
+
+_ERRORS = {
+    -1: "bad argument",
+    -2: "out of memory",
+}
+
+class _Frames(ctypes.Structure):
+    _fields_ = [
+        ("can_id", ctypes.POINTER(ctypes.c_uint32)),
+        ("dlc", ctypes.POINTER(ctypes.c_uint8)),
+        ("data", ctypes.POINTER(ctypes.c_uint8)),
+        ("count", ctypes.c_size_t),
+    ]
+
+
+class _Query(ctypes.Structure):
+    _fields_ = [
+        ("scales", ctypes.POINTER(ctypes.c_double)),
+        ("scale_count", ctypes.c_size_t),
+        ("offsets", ctypes.POINTER(ctypes.c_double)),
+        ("offset_count", ctypes.c_size_t),
+        ("min_value", ctypes.c_double),
+        ("max_value", ctypes.c_double),
+        ("target", ctypes.c_double),
+        ("target_tol", ctypes.c_double),
+        ("max_step", ctypes.c_double),
+        ("trend", ctypes.c_int),
+        ("min_trend", ctypes.c_double),
+        ("min_fraction", ctypes.c_double),
+        ("min_frames", ctypes.c_uint32),
+        ("min_len", ctypes.c_uint8),
+        ("max_len", ctypes.c_uint8),
+        ("layouts", ctypes.c_uint8),
+    ]
+
+
+class _Hit(ctypes.Structure):
+    _fields_ = [
+        ("can_id", ctypes.c_uint32),
+        ("start_bit", ctypes.c_uint8),
+        ("length", ctypes.c_uint8),
+        ("big_endian", ctypes.c_uint8),
+        ("is_signed", ctypes.c_uint8),
+        ("scale", ctypes.c_double),
+        ("offset", ctypes.c_double),
+        ("score", ctypes.c_double),
+        ("fraction", ctypes.c_double),
+        ("step_fraction", ctypes.c_double),
+        ("trend", ctypes.c_double),
+        ("min", ctypes.c_double),
+        ("mean", ctypes.c_double),
+        ("max", ctypes.c_double),
+        ("frames", ctypes.c_uint32),
+        ("changes", ctypes.c_uint32),
+    ]
+
+
+_lib = None
+
+
+def _load():
+    global _lib
+    if _lib is not None:
+        return _lib or None
+    _lib = False
+    for path in library_paths(LIB_ENV, "can_field_search"):
+        if not path.exists():
+            continue
+        lib = ctypes.CDLL(str(path))
+        lib.can_fs_search.argtypes = [
+            ctypes.POINTER(_Frames), ctypes.POINTER(ctypes.c_uint32), ctypes.c_size_t,
+            ctypes.POINTER(_Query), ctypes.c_uint, ctypes.POINTER(_Hit), ctypes.c_size_t,
+            ctypes.POINTER(ctypes.c_uint64),
+        ]
+        lib.can_fs_search.restype = ctypes.c_int
+        _lib = lib
+        break
+    return _lib or None
+
+
+def _ptr(array, ctype):
+    return array.ctypes.data_as(ctypes.POINTER(ctype))
+
+
+def load_frames(path):
+    """(can_ids, dlc, data) of the CAN frames of any log canbin reads, in time order."""
+    log = canbin.open_log(path)
+    order = np.argsort(log.timestamp_us, kind="stable")
+    frames = log.frames[order]
+    return (frames["can_id"].astype(np.uint32), frames["dlc"].astype(np.uint8),
+            np.ascontiguousarray(frames["data"]))
+
+
+def search(can_ids, dlc, data, ids, scales, offsets, value_range=(-math.inf, math.inf),
+           target=None, target_tol=None, max_step=0.0, trend="any", min_trend=0.5,
+           min_fraction=0.98, min_frames=20, lengths=(1, 16), layouts=0x0F, top=20,
+           threads=0):
+    """Run the native search; returns (hits as dicts, hypotheses tested)."""
+    lib = _load()
+    if lib is None:
+        raise RuntimeError(f"native field search not built (see {__name__} docstring)")
+
+    cid = np.ascontiguousarray(can_ids, dtype=np.uint32)
+    dl = np.ascontiguousarray(dlc, dtype=np.uint8)
+    payload = np.ascontiguousarray(data, dtype=np.uint8).reshape(-1, 8)
+    cand = np.ascontiguousarray(ids, dtype=np.uint32)
+    sc = np.ascontiguousarray(scales, dtype=np.float64)
+    off = np.ascontiguousarray(offsets, dtype=np.float64)
+
+    frames = _Frames(_ptr(cid, ctypes.c_uint32), _ptr(dl, ctypes.c_uint8),
+                     _ptr(payload, ctypes.c_uint8), len(cid))
+    query = _Query(_ptr(sc, ctypes.c_double), len(sc), _ptr(off, ctypes.c_double), len(off),
+                   value_range[0], value_range[1],
+                   math.nan if target is None else target, target_tol or 0.0,
+                   max_step, TRENDS[trend], min_trend, min_fraction, min_frames,
+                   lengths[0], lengths[1], layouts)
+    hits = (_Hit * top)()
+    tested = ctypes.c_uint64(0)
+    n = lib.can_fs_search(ctypes.byref(frames), _ptr(cand, ctypes.c_uint32), len(cand),
+                          ctypes.byref(query), int(threads), hits, top, ctypes.byref(tested))
+    if n < 0:
+        raise RuntimeError(f"can_fs_search failed: {_ERRORS.get(n, n)}")
+    results = [{name: getattr(h, name) for name, _ in _Hit._fields_} for h in hits[:n]]
+    return results, tested.value
+
+
+def field_name(hit):
+    order = 0 if hit["big_endian"] else 1
+    sign = "-" if hit["is_signed"] else "+"
+    return f"{hit['start_bit']}|{hit['length']}@{order}{sign}"
+
+
+def _pair(text, option, default_second=None):
+    parts = text.split(":")
+    try:
+        if len(parts) == 1 and default_second is not None:
+            return float(parts[0]), default_second(float(parts[0]))
+        if len(parts) == 2:
+            return float(parts[0]), float(parts[1])
+    except ValueError:
+        pass
+    raise SystemExit(f"Bad {option} value: {text}")
+
+
+def _floats(text, option):
+    try:
+        return [float(x) for x in text.split(",") if x.strip()]
+    except ValueError:
+        raise SystemExit(f"Bad {option} value: {text}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Search bit-field hypotheses in a CAN log.")
+    parser.add_argument("log_file", help="CAN log (.bin, CSV or text capture)")
+    parser.add_argument("--ids", nargs="*", default=None,
+                        help="CAN IDs to search (default: every ID but 0x700-0x7FF)")
+    parser.add_argument("--range", help="Physical range MIN:MAX")
+    parser.add_argument("--target", help="Known value VALUE[:TOL] (default TOL: 10%%)")
+    parser.add_argument("--max-step", type=float, default=0.0,
+                        help="Largest change between consecutive frames")
+    parser.add_argument("--trend", choices=sorted(TRENDS), default="any",
+                        help="Required trend over the log")
+    parser.add_argument("--min-trend", type=float, default=0.5,
+                        help="Kendall tau a --trend needs (default: 0.5)")
+    parser.add_argument("--scales", default="1", help="Comma-separated scales (default: 1)")
+    parser.add_argument("--offsets", default="0", help="Comma-separated offsets (default: 0)")
+    parser.add_argument("--len", default="1:16", help="Field lengths MIN:MAX (default: 1:16)")
+    parser.add_argument("--byte-order", choices=["le", "be", "both"], default="both",
+                        help="Byte orders to try (default: both)")
+    parser.add_argument("--unsigned-only", action="store_true", help="Skip signed fields")
+    parser.add_argument("--min-fraction", type=float, default=0.98,
+                        help="Share of frames/steps that must comply (default: 0.98)")
+    parser.add_argument("--min-frames", type=int, default=20,
+                        help="Skip IDs with fewer frames (default: 20)")
+    parser.add_argument("--top", type=int, default=20, help="Hypotheses to show")
+    parser.add_argument("--threads", type=int, default=0, help="Worker threads (default: all cores)")
+    parser.add_argument("--csv", help="Write the hits to this CSV")
+    args = parser.parse_args()
+
+    log_path = Path(args.log_file)
+    if not log_path.exists():
+        raise SystemExit(f"Log file not found: {log_path}")
+    if _load() is None:
+        raise SystemExit("Native field search not built; see analysis/field_search.py")
+
+    value_range = _pair(args.range, "--range") if args.range else (-math.inf, math.inf)
+    target, tol = (_pair(args.target, "--target", lambda v: abs(v) * 0.1 or 1.0)
+                   if args.target else (None, None))
+    lengths = tuple(int(x) for x in _pair(args.len, "--len"))
+    if not 1 <= lengths[0] <= lengths[1] <= MAX_LEN:
+        raise SystemExit(f"--len must be within 1:{MAX_LEN}")
+    scales = _floats(args.scales, "--scales")
+    offsets = _floats(args.offsets, "--offsets")
+    if not scales or 0.0 in scales or not offsets:
+        raise SystemExit("--scales must be non-zero and --offsets not empty")
+    if args.range is None and args.target is None and args.max_step <= 0 and args.trend == "any":
+        raise SystemExit("Give at least one of --range, --target, --max-step or --trend")
+
+    layouts = 0
+    if args.byte_order in ("le", "both"):
+        layouts |= LAYOUT_LE_UNSIGNED | (0 if args.unsigned_only else LAYOUT_LE_SIGNED)
+    if args.byte_order in ("be", "both"):
+        layouts |= LAYOUT_BE_UNSIGNED | (0 if args.unsigned_only else LAYOUT_BE_SIGNED)
+
+    start = time.time()
+    can_ids, dlc, data = load_frames(log_path)
+
+    if args.ids:
+        ids = [int(c[2:] if c.upper().startswith("0X") else c, 16) for c in args.ids]
+    else:
+        # Diagnostic requests/replies are not broadcast fields
+        ids = [int(c) for c in np.unique(can_ids) if not 0x700 <= c <= 0x7FF]
+    loaded = time.time()
+
+    hits, tested = search(can_ids, dlc, data, ids, scales, offsets, value_range, target, tol,
+                          args.max_step, args.trend, args.min_trend, args.min_fraction,
+                          args.min_frames, lengths, layouts, args.top, args.threads)
+    print(f"{len(can_ids)} frames, {len(ids)} IDs: {tested} hypotheses tested in "
+          f"{time.time() - loaded:.2f} s (load {loaded - start:.2f} s)")
+
+    if not hits:
+        print("No field satisfies the constraints.")
+        return 0
+
+    print(f"\n{'CAN ID':<8} {'Field':<10} {'Scale':>9} {'Offset':>8} {'Score':>6} "
+          f"{'In %':>6} {'Step %':>6} {'Trend':>6} {'Min':>9} {'Mean':>9} {'Max':>9} "
+          f"{'Changes':>8}")
+    print("-" * 104)
+    for h in hits:
+        print(f"{h['can_id']:<8X} {field_name(h):<10} {h['scale']:>9.5g} {h['offset']:>8.5g} "
+              f"{h['score']:>6.3f} {100 * h['fraction']:>6.1f} {100 * h['step_fraction']:>6.1f} "
+              f"{h['trend']:>6.2f} {h['min']:>9.4g} {h['mean']:>9.4g} {h['max']:>9.4g} "
+              f"{h['changes']:>8}")
+
+    if args.csv:
+        with open(args.csv, "w", encoding="utf-8") as out:
+            out.write("can_id,field,scale,offset,score,fraction,step_fraction,trend,"
+                      "min,mean,max,frames,changes\n")
+            for h in hits:
+                out.write(f"{h['can_id']:03X},{field_name(h)},{h['scale']:.9g},"
+                          f"{h['offset']:.9g},{h['score']:.6f},{h['fraction']:.6f},"
+                          f"{h['step_fraction']:.6f},{h['trend']:.6f},{h['min']:.9g},"
+                          f"{h['mean']:.9g},{h['max']:.9g},{h['frames']},{h['changes']}\n")
+        print(f"\nWrote {len(hits)} hits to {args.csv}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,333 @@
+#!/usr/bin/env python3
+"""
+Lag-aware correlation of broadcast fields against polled diagnostic values.
+
+diagnostic_correlation.py compares window means at zero lag, so the delay
+between a broadcast frame and the OBD reply describing the same quantity
+smears the result. This tool puts both on a uniform time grid (--step-ms)
+and, for every candidate field (each byte as u8/s8, each byte pair as
+u16/s16 BE/LE), computes the Pearson correlation with each diagnostic
+signal at every lag up to --max-lag-ms. It reports the best lag with the
+linear fit at that lag:
+
+    diag(t) ~= scale * field(t - lag) + offset
+
+A positive lag means the diagnostic value matches the broadcast from that
+long before its reply arrived, i.e. how stale the polled value is.
+
+Broadcast fields are held at their last value on the grid; diagnostic
+samples only count in the grid bins they arrived in. The lag-dependent
+sums of the Pearson formula are cross-correlations of those masked series,
+computed with FFTs over blocks of the grid, so every lag costs the same
+and memory stays bounded on multi-hour logs. The best lag is then fitted
+exactly on the samples.
+"""
+
+import argparse
+import sys
+from pathlib import Path
+
+import numpy as np
+
+from diagnostic_correlation import (DEFAULT_CANDIDATE_IDS, _frame_arrays, extract_diag_signals,
+                                    load_log)
+
+CHUNK_BLOCKS = 32  # Blocks per batched product; bounds memory
+
+
+def byte_fields(data):
+    """Field names and (frames, 44) values, ordered as diagnostic_correlation."""
+    data = data.astype(np.int64)
+    names, cols = [], []
+    for i in range(8):
+        u8 = data[:, i]
+        names += [f"b{i}_u8", f"b{i}_s8"]
+        cols += [u8, np.where(u8 > 127, u8 - 256, u8)]
+    for i in range(7):
+        be = data[:, i] * 256 + data[:, i + 1]
+        le = data[:, i + 1] * 256 + data[:, i]
+        names += [f"b{i}{i+1}_u16_be", f"b{i}{i+1}_s16_be",
+                  f"b{i}{i+1}_u16_le", f"b{i}{i+1}_s16_le"]
+        cols += [be, np.where(be > 32767, be - 65536, be),
+                 le, np.where(le > 32767, le - 65536, le)]
+    return names, np.stack(cols, axis=1).astype(np.float64)
+
+
+def _fft_size(max_lag):
+    """FFT length and grid bins per block for a lag range of +-max_lag bins."""
+    n = 1024
+    while n < 8 * max_lag:
+        n *= 2
+    return n, n - 2 * max_lag
+
+
+def _held(ts, values, times_us):
+    """Last value before each time (rows), and whether there was one."""
+    idx = np.searchsorted(ts, times_us, side="left") - 1
+    held = values[np.maximum(idx, 0)]
+    held[idx < 0] = 0.0
+    return held, idx >= 0
+
+
+class Reference:
+    """A diagnostic signal binned onto the grid, centered on its mean."""
+
+    def __init__(self, name, timestamps_us, values, t0_us, step_us, bins):
+        idx = (np.asarray(timestamps_us, dtype=np.int64) - t0_us) // step_us
+        keep = (idx >= 0) & (idx < bins)
+        idx = idx[keep]
+        values = np.asarray(values, dtype=np.float64)[keep]
+        counts = np.bincount(idx, minlength=bins)
+        sums = np.bincount(idx, weights=values, minlength=bins)
+
+        self.name = name
+        self.bins = np.flatnonzero(counts)
+        self.values = sums[self.bins] / counts[self.bins]
+        self.mean = self.values.mean() if len(self.values) else 0.0
+        self.samples = len(self.bins)
+        self.syy = float(((self.values - self.mean) ** 2).sum())
+        # Zero where there is no sample, so only sample bins contribute
+        self.masked = np.zeros(bins)
+        self.masked[self.bins] = self.values - self.mean
+        self.mask = np.zeros(bins)
+        self.mask[self.bins] = 1.0
+
+
+class Grid:
+    def __init__(self, t0_us, step_us, bins, max_lag):
+        self.t0_us = t0_us
+        self.step_us = step_us
+        self.bins = bins
+        self.max_lag = max_lag
+        self.n, self.block = _fft_size(max_lag)
+
+    def bin_end_us(self, bins):
+        return self.t0_us + (np.asarray(bins) + 1) * self.step_us
+
+
+class ReferenceSpectra:
+    """
+    Conjugate block spectra of the centered signals and of their sample
+    masks. Signals decoded from the same reply share a mask, so masks are
+    kept once per distinct sample pattern (mask_of maps signal -> mask).
+    """
+
+    def __init__(self, references, grid):
+        masks = {}
+        self.mask_of = [masks.setdefault(r.bins.tobytes(), len(masks)) for r in references]
+        mask_refs = {m: r for r, m in zip(references, self.mask_of)}
+        self.signals = len(references)
+        self.masks = len(masks)
+
+        # Blocks holding samples, in chunks of (bin ranges, spectra (freqs, rows, blocks))
+        blocks = []
+        for start in range(0, grid.bins, grid.block):
+            end = min(start + grid.block, grid.bins)
+            rows = [r.masked[start:end] for r in references]
+            rows += [mask_refs[m].mask[start:end] for m in range(self.masks)]
+            rows = np.stack(rows)
+            if rows.any():
+                blocks.append((start, end, np.conj(np.fft.rfft(rows, grid.n)).T))
+        self.chunks = []
+        for c in range(0, len(blocks), CHUNK_BLOCKS):
+            chunk = blocks[c:c + CHUNK_BLOCKS]
+            self.chunks.append(([(start, end) for start, end, _ in chunk],
+                                np.stack([spec for _, _, spec in chunk], axis=2)))
+
+
+def lag_pearson(ts, values, spectra, grid):
+    """
+    Pearson r of every signal against every field at every lag.
+
+    The running sums sum(y * x(t - lag)), sum(x(t - lag)) and
+    sum(x(t - lag)^2) over each signal's samples are cross-correlations of
+    the masked signal (or its mask) with the held field. Per block they
+    are FFT products; summing them over blocks per frequency is a batched
+    matrix product (rows x blocks) @ (blocks x fields), and one inverse FFT
+    at the end gives all lags. Signal values are centered, so sum(y) = 0.
+    Returns (lags, signals, fields); index k is a lag of max_lag - k bins.
+    """
+    m = grid.max_lag
+    fields = values.shape[1]
+    acc_x = acc_xx = None
+    for ranges, a in spectra.chunks:
+        seg = np.zeros((len(ranges), fields, grid.n))
+        for b, (start, end) in enumerate(ranges):
+            held, _ = _held(ts, values, grid.bin_end_us(np.arange(start - m, end + m)))
+            seg[b, :, :len(held)] = held.T
+        x = np.fft.rfft(seg).transpose(2, 0, 1)                 # (freqs, blocks, fields)
+        xx = np.fft.rfft(seg * seg).transpose(2, 0, 1)
+        prod_x = a @ x
+        prod_xx = a[:, spectra.signals:] @ xx
+        acc_x = prod_x if acc_x is None else acc_x + prod_x
+        acc_xx = prod_xx if acc_xx is None else acc_xx + prod_xx
+
+    sums_x = np.fft.irfft(acc_x, grid.n, axis=0)[:2 * m + 1]
+    sxx_all = np.fft.irfft(acc_xx, grid.n, axis=0)[:2 * m + 1]
+    sxy = sums_x[:, :spectra.signals]
+    sx = sums_x[:, spectra.signals:][:, spectra.mask_of]
+    sxx = sxx_all[:, spectra.mask_of]
+    return sxy, sx, sxx
+
+
+def fit_at_lags(ref, ts, values, lags, grid, min_samples):
+    """
+    Least-squares diag = scale * field(t - lag) + offset per field, each at
+    its own lag (bins), over the samples where the field has a value.
+    Returns (scale, offset, r2, samples); r2 is NaN where there are too few
+    samples or no variance.
+    """
+    times = grid.bin_end_us(ref.bins[:, None] - lags[None, :])
+    idx = np.searchsorted(ts, times, side="left") - 1
+    valid = idx >= 0
+    x = values[np.maximum(idx, 0), np.arange(len(lags))[None, :]]
+    y = ref.values[:, None]
+
+    w = valid.astype(np.float64)
+    n = w.sum(axis=0)
+    with np.errstate(invalid="ignore", divide="ignore"):
+        mx = (w * x).sum(axis=0) / n
+        my = (w * y).sum(axis=0) / n
+        dx = (x - mx) * w
+        dy = (y - my) * w
+        sxx = (dx * dx).sum(axis=0)
+        syy = (dy * dy).sum(axis=0)
+        sxy = (dx * dy).sum(axis=0)
+        scale = sxy / sxx
+        offset = my - scale * mx
+        r2 = sxy * sxy / (sxx * syy)
+    r2[(n < max(min_samples, 2)) | ~(sxx > 0) | ~(syy > 0)] = np.nan
+    return scale, offset, np.minimum(r2, 1.0), n.astype(int)
+
+
+def scan_id(cid, ts, data, references, spectra, grid, min_samples):
+    """Best lag and fit of every varying field of one ID against every signal."""
+    names, values = byte_fields(data)
+    varying = values.std(axis=0) > 0
+    if not varying.any():
+        return []
+    names = [n for n, v in zip(names, varying) if v]
+    # Centered fields keep the one-pass variances below well conditioned
+    means = values[:, varying].mean(axis=0)
+    values = values[:, varying] - means
+
+    sxy, sx, sxx = lag_pearson(ts, values, spectra, grid)
+    label = f"{cid:03X}" if cid <= 0x7FF else f"{cid:08X}"
+    results = []
+    for s, ref in enumerate(references):
+        if ref.samples < 2:
+            continue
+        var_x = sxx[:, s] - sx[:, s] ** 2 / ref.samples
+        # FFT round-off leaves tiny residues where the true variance is zero
+        ok = var_x > 1e-9 * sxx[:, s]
+        r2 = np.where(ok, sxy[:, s] ** 2 / np.where(ok, var_x, 1.0) / max(ref.syy, 1e-300), -1.0)
+        lags = grid.max_lag - np.argmax(r2, axis=0)
+
+        scale, offset, r2, n = fit_at_lags(ref, ts, values, lags, grid, min_samples)
+        _, _, r2_zero, _ = fit_at_lags(ref, ts, values, np.zeros_like(lags), grid, min_samples)
+        for f, name in enumerate(names):
+            if np.isnan(r2[f]):
+                continue
+            results.append({
+                "signal": ref.name,
+                "can_id": label,
+                "feature": name,
+                "lag_ms": int(lags[f]) * grid.step_us // 1000,
+                "scale": float(scale[f]),
+                "offset": float(offset[f] - scale[f] * means[f]),
+                "r2": float(r2[f]),
+                "r2_zero": 0.0 if np.isnan(r2_zero[f]) else float(r2_zero[f]),
+                "samples": int(n[f]),
+            })
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Find broadcast-vs-diagnostic time offsets.")
+    parser.add_argument("log_file", help="Path to CAN log CSV")
+    parser.add_argument("--ids", nargs="*", default=None, help="CAN IDs to analyze")
+    parser.add_argument("--all-ids", action="store_true",
+                        help="Use every broadcast CAN ID in the log (not 0x700-0x7FF)")
+    parser.add_argument("--signals", nargs="*", default=None, help="Diagnostic signals to analyze")
+    parser.add_argument("--step-ms", type=int, default=10, help="Grid step (default: 10)")
+    parser.add_argument("--max-lag-ms", type=int, default=2000,
+                        help="Largest lag either way (default: 2000)")
+    parser.add_argument("--min-samples", type=int, default=20,
+                        help="Minimum diagnostic samples at a lag (default: 20)")
+    parser.add_argument("--top", type=int, default=10, help="Fields to show per signal")
+    parser.add_argument("--csv", help="Write every field's best fit to this CSV")
+    args = parser.parse_args()
+
+    log_path = Path(args.log_file)
+    if not log_path.exists():
+        raise SystemExit(f"Log file not found: {log_path}")
+    if args.step_ms <= 0 or args.max_lag_ms < 0:
+        raise SystemExit("--step-ms must be positive and --max-lag-ms not negative")
+
+    df = load_log(log_path)
+    signals = extract_diag_signals(df)
+    if args.signals:
+        missing = [s for s in args.signals if s not in signals]
+        for name in missing:
+            print(f"Warning: diagnostic signal not found: {name}", file=sys.stderr)
+        signals = {k: v for k, v in signals.items() if k in args.signals}
+    if not signals:
+        print("No diagnostic signals found.")
+        return 0
+
+    if args.all_ids:
+        # Diagnostic replies (0x7xx) would only find the signals they carry
+        id_strings = [c for c in sorted(df["can_id"].unique()) if not 0x700 <= int(c, 16) <= 0x7FF]
+    else:
+        id_strings = [c.strip().upper() for c in args.ids or DEFAULT_CANDIDATE_IDS]
+        id_strings = [c[2:] if c.startswith("0X") else c for c in id_strings]
+    ids = [int(c, 16) for c in id_strings]
+
+    timestamps_us, can_ids, data = _frame_arrays(df)
+    step_us = args.step_ms * 1000
+    t0_us = int(timestamps_us[0])
+    bins = int((timestamps_us[-1] - t0_us) // step_us) + 1
+    grid = Grid(t0_us, step_us, bins, args.max_lag_ms // args.step_ms)
+
+    references = [Reference(name, s["timestamp_us"], s["value"], t0_us, step_us, bins)
+                  for name, s in sorted(signals.items())]
+    spectra = ReferenceSpectra(references, grid)
+
+    by_signal = {ref.name: [] for ref in references}
+    for cid in ids:
+        sel = can_ids == cid
+        if not sel.any() or not spectra.chunks:
+            continue
+        for r in scan_id(cid, timestamps_us[sel], data[sel], references, spectra, grid,
+                         args.min_samples):
+            by_signal[r["signal"]].append(r)
+
+    rows = []
+    for ref in references:
+        results = sorted(by_signal[ref.name], key=lambda r: r["r2"], reverse=True)
+        rows += results
+
+        print(f"\n=== {ref.name} ({ref.samples} samples) ===")
+        if not results:
+            print("No correlations found.")
+            continue
+        print(f"Best lags (step={args.step_ms}ms, max_lag={args.max_lag_ms}ms):")
+        print(f"{'CAN ID':<8} {'Feature':<14} {'Lag ms':>7} {'Scale':>11} {'Offset':>11} "
+              f"{'R2':>6} {'R2@0':>6} {'Samples':>8}")
+        print("-" * 78)
+        for r in results[:args.top]:
+            print(f"{r['can_id']:<8} {r['feature']:<14} {r['lag_ms']:>7} {r['scale']:>11.5g} "
+                  f"{r['offset']:>11.5g} {r['r2']:>6.3f} {r['r2_zero']:>6.3f} {r['samples']:>8}")
+
+    if args.csv:
+        with open(args.csv, "w", encoding="utf-8") as out:
+            out.write("signal,can_id,feature,lag_ms,scale,offset,r2,r2_zero,samples\n")
+            for r in rows:
+                out.write(f"{r['signal']},{r['can_id']},{r['feature']},{r['lag_ms']},"
+                          f"{r['scale']:.9g},{r['offset']:.9g},{r['r2']:.6f},"
+                          f"{r['r2_zero']:.6f},{r['samples']}\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,336 @@
+/*
+ * CAN Correlation Engine Implementation
+ *
+ * Frames are bucketed by candidate ID (two serial passes over the IDs),
+ * then each worker takes whole IDs and walks their frames once: byte
+ * features are summed per window, and when a window closes its means are
+ * folded into running Pearson sums for every signal that has the same
+ * window. The per-feature sums are contiguous arrays, so the inner loops
+ * are plain element-wise updates the compiler vectorizes.
+ *
+ * Values are shifted by the first window's mean (per ID and feature, and
+ * per signal) before summing. That keeps the one-pass variance from
+ * cancelling and makes a constant series sum to exactly zero variance,
+ * which is what the pandas std() > 0 checks see.
+ */
+
+#include "can_correlate.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#define F CAN_CORR_FEATURES
+
+static const char *const k_feature_names[F] = {
+    "b0_u8", "b0_s8", "b1_u8", "b1_s8", "b2_u8", "b2_s8", "b3_u8", "b3_s8",
+    "b4_u8", "b4_s8", "b5_u8", "b5_s8", "b6_u8", "b6_s8", "b7_u8", "b7_s8",
+    "b01_u16_be", "b01_s16_be", "b01_u16_le", "b01_s16_le",
+    "b12_u16_be", "b12_s16_be", "b12_u16_le", "b12_s16_le",
+    "b23_u16_be", "b23_s16_be", "b23_u16_le", "b23_s16_le",
+    "b34_u16_be", "b34_s16_be", "b34_u16_le", "b34_s16_le",
+    "b45_u16_be", "b45_s16_be", "b45_u16_le", "b45_s16_le",
+    "b56_u16_be", "b56_s16_be", "b56_u16_le", "b56_s16_le",
+    "b67_u16_be", "b67_s16_be", "b67_u16_le", "b67_s16_le",
+};
+
+// Running sums of one (ID, signal) pair
+struct pair_sums_t {
+    uint32_t n;
+    double sy;
+    double syy;
+    double sx[F];
+    double sxx[F];
+    double sxy[F];
+};
+
+struct job_t {
+    const can_corr_frames_t *frames;
+    const can_corr_signals_t *signals;
+    const std::vector<uint32_t> *order;     // Frame indices grouped by ID
+    const std::vector<size_t> *starts;      // id_count + 1 bucket starts
+    int64_t window_us;
+    uint32_t min_windows;
+    size_t id_count;
+    double *corr_out;
+    uint32_t *windows_out;
+    std::atomic<size_t> next_id;
+};
+
+static int64_t floor_div(int64_t a, int64_t b)
+{
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+static void add_frame(const uint8_t *d, int64_t *sums)
+{
+    for (int i = 0; i < 8; i++) {
+        sums[2 * i] += d[i];
+        sums[2 * i + 1] += (int8_t)d[i];
+    }
+    for (int i = 0; i < 7; i++) {
+        uint16_t be = (uint16_t)((d[i] << 8) | d[i + 1]);
+        uint16_t le = (uint16_t)((d[i + 1] << 8) | d[i]);
+        int64_t *s = &sums[16 + 4 * i];
+        s[0] += be;
+        s[1] += (int16_t)be;
+        s[2] += le;
+        s[3] += (int16_t)le;
+    }
+}
+
+// Per-worker scratch, reused across IDs
+struct worker_t {
+    std::vector<pair_sums_t> pairs;
+    std::vector<size_t> cursor;
+    std::vector<double> y0;
+    double x0[F];
+    bool have_x0;
+};
+
+static void close_window(const job_t &job, worker_t &w, int64_t window, const int64_t *sums,
+                         uint32_t count)
+{
+    double x[F];
+    for (int f = 0; f < F; f++) {
+        x[f] = (double)sums[f] / count;
+    }
+    if (!w.have_x0) {
+        std::copy(x, x + F, w.x0);
+        w.have_x0 = true;
+    }
+    for (int f = 0; f < F; f++) {
+        x[f] -= w.x0[f];
+    }
+
+    const can_corr_signals_t *sig = job.signals;
+    for (size_t s = 0; s < sig->count; s++) {
+        size_t end = sig->offsets[s + 1];
+        size_t &c = w.cursor[s];
+        while (c < end && sig->window[c] < window) {
+            c++;
+        }
+        if (c == end || sig->window[c] != window) {
+            continue;
+        }
+
+        double y = sig->value[c] - w.y0[s];
+        pair_sums_t &p = w.pairs[s];
+        p.n++;
+        p.sy += y;
+        p.syy += y * y;
+        for (int f = 0; f < F; f++) {
+            p.sx[f] += x[f];
+            p.sxx[f] += x[f] * x[f];
+            p.sxy[f] += x[f] * y;
+        }
+    }
+}
+
+static void finish_id(const job_t &job, const worker_t &w, size_t id)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (size_t s = 0; s < job.signals->count; s++) {
+        const pair_sums_t &p = w.pairs[s];
+        double *out = &job.corr_out[(s * job.id_count + id) * F];
+        job.windows_out[s * job.id_count + id] = p.n;
+
+        double syy = p.n ? p.syy - p.sy * p.sy / p.n : 0.0;
+        if (p.n < job.min_windows || p.n < 2 || !(syy > 0.0)) {
+            std::fill(out, out + F, nan);
+            continue;
+        }
+        for (int f = 0; f < F; f++) {
+            double sxx = p.sxx[f] - p.sx[f] * p.sx[f] / p.n;
+            double sxy = p.sxy[f] - p.sx[f] * p.sy / p.n;
+            if (!(sxx > 0.0)) {
+                out[f] = nan;
+                continue;
+            }
+            out[f] = std::max(-1.0, std::min(1.0, sxy / std::sqrt(sxx * syy)));
+        }
+    }
+}
+
+static void process_id(const job_t &job, worker_t &w, size_t id)
+{
+    const can_corr_frames_t *fr = job.frames;
+    const can_corr_signals_t *sig = job.signals;
+
+    std::fill(w.pairs.begin(), w.pairs.end(), pair_sums_t{});
+    for (size_t s = 0; s < sig->count; s++) {
+        w.cursor[s] = sig->offsets[s];
+    }
+    w.have_x0 = false;
+
+    int64_t sums[F] = {0};
+    uint32_t count = 0;
+    int64_t window = 0;
+    size_t begin = (*job.starts)[id];
+    size_t end = (*job.starts)[id + 1];
+    for (size_t k = begin; k < end; k++) {
+        uint32_t i = (*job.order)[k];
+        int64_t win = floor_div(fr->timestamp_us[i], job.window_us);
+        if (count && win != window) {
+            close_window(job, w, window, sums, count);
+            std::fill(sums, sums + F, 0);
+            count = 0;
+        }
+        window = win;
+        add_frame(&fr->data[(size_t)i * 8], sums);
+        count++;
+    }
+    if (count) {
+        close_window(job, w, window, sums, count);
+    }
+
+    finish_id(job, w, id);
+}
+
+static void worker_main(job_t *job)
+{
+    worker_t w;
+    size_t signal_count = job->signals->count;
+    w.pairs.resize(signal_count);
+    w.cursor.resize(signal_count);
+    w.y0.resize(signal_count);
+    for (size_t s = 0; s < signal_count; s++) {
+        size_t first = job->signals->offsets[s];
+        w.y0[s] = first < job->signals->offsets[s + 1] ? job->signals->value[first] : 0.0;
+    }
+
+    while (1) {
+        size_t id = job->next_id.fetch_add(1, std::memory_order_relaxed);
+        if (id >= job->id_count) {
+            break;
+        }
+        process_id(*job, w, id);
+    }
+}
+
+static bool signals_valid(const can_corr_signals_t *sig)
+{
+    if (sig->count && (!sig->offsets || !sig->window || !sig->value)) {
+        return false;
+    }
+    for (size_t s = 0; s < sig->count; s++) {
+        if (sig->offsets[s + 1] < sig->offsets[s]) {
+            return false;
+        }
+        for (size_t i = sig->offsets[s] + 1; i < sig->offsets[s + 1]; i++) {
+            if (sig->window[i] <= sig->window[i - 1]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static int run(const can_corr_frames_t *frames, const uint32_t *ids, size_t id_count,
+               const can_corr_signals_t *signals, int64_t window_us, uint32_t min_windows,
+               unsigned threads, double *corr_out, uint32_t *windows_out)
+{
+    std::unordered_map<uint32_t, uint32_t> slot_of;
+    slot_of.reserve(id_count * 2);
+    for (size_t i = 0; i < id_count; i++) {
+        if (!slot_of.emplace(ids[i], (uint32_t)i).second) {
+            return CAN_CORR_ERR_ARG;
+        }
+    }
+
+    // Bucket frame indices by candidate, keeping time order within each
+    std::vector<uint32_t> slot(frames->count);
+    std::vector<size_t> starts(id_count + 1, 0);
+    uint32_t last_id = 0;
+    uint32_t last_slot = UINT32_MAX;
+    for (size_t i = 0; i < frames->count; i++) {
+        if (i && frames->timestamp_us[i] < frames->timestamp_us[i - 1]) {
+            return CAN_CORR_ERR_UNSORTED;
+        }
+        uint32_t id = frames->can_id[i];
+        if (i == 0 || id != last_id) {
+            auto it = slot_of.find(id);
+            last_slot = it == slot_of.end() ? UINT32_MAX : it->second;
+            last_id = id;
+        }
+        slot[i] = last_slot;
+        if (last_slot != UINT32_MAX) {
+            starts[last_slot + 1]++;
+        }
+    }
+    for (size_t i = 0; i < id_count; i++) {
+        starts[i + 1] += starts[i];
+    }
+    std::vector<uint32_t> order(starts[id_count]);
+    std::vector<size_t> fill(starts.begin(), starts.end() - 1);
+    for (size_t i = 0; i < frames->count; i++) {
+        if (slot[i] != UINT32_MAX) {
+            order[fill[slot[i]]++] = (uint32_t)i;
+        }
+    }
+    std::vector<uint32_t>().swap(slot);
+
+    job_t job;
+    job.frames = frames;
+    job.signals = signals;
+    job.order = &order;
+    job.starts = &starts;
+    job.window_us = window_us;
+    job.min_windows = min_windows;
+    job.id_count = id_count;
+    job.corr_out = corr_out;
+    job.windows_out = windows_out;
+    job.next_id.store(0);
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = (unsigned)std::min<size_t>(threads, std::max<size_t>(id_count, 1));
+
+    // The calling thread is one of the workers
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++) {
+        try {
+            pool.emplace_back(worker_main, &job);
+        } catch (const std::system_error &) {
+            break;  // Fewer workers, same result
+        }
+    }
+    worker_main(&job);
+    for (std::thread &t : pool) {
+        t.join();
+    }
+    return CAN_CORR_OK;
+}
+
+extern "C" int can_corr_run(const can_corr_frames_t *frames, const uint32_t *ids,
+                            size_t id_count, const can_corr_signals_t *signals,
+                            int64_t window_us, uint32_t min_windows, unsigned threads,
+                            double *corr_out, uint32_t *windows_out)
+{
+    if (!frames || !signals || window_us <= 0 || (id_count && !ids) ||
+        (signals->count && id_count && (!corr_out || !windows_out)) ||
+        (frames->count && (!frames->timestamp_us || !frames->can_id || !frames->data)) ||
+        frames->count > UINT32_MAX || !signals_valid(signals)) {
+        return CAN_CORR_ERR_ARG;
+    }
+
+    try {
+        return run(frames, ids, id_count, signals, window_us, min_windows, threads, corr_out,
+                   windows_out);
+    } catch (const std::bad_alloc &) {
+        return CAN_CORR_ERR_NO_MEM;
+    }
+}
+
+extern "C" const char *can_corr_feature_name(unsigned index)
+{
+    return index < F ? k_feature_names[index] : nullptr;
+}
@@ -0,0 +1,79 @@
+/*
+ * CAN Correlation Engine
+ *
+ * Native back end for diagnostic_correlation.py. For every candidate ID it
+ * averages 44 byte-field features (each byte as u8/s8, each byte pair as
+ * u16/s16 big and little endian) over fixed time windows, in one pass over
+ * that ID's frames, and correlates the window means with every diagnostic
+ * signal (already windowed by the caller) on the windows both have:
+ *
+ *   corr = Pearson(feature mean, signal mean) over aligned windows
+ *
+ * A result is reported only with at least min_windows aligned windows and
+ * non-zero variance on both sides (NaN otherwise), matching the pandas
+ * implementation. IDs are spread over worker threads.
+ *
+ * Frames must be in timestamp order. Window index = timestamp_us / window_us.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_CORR_FEATURES 44
+
+typedef enum {
+    CAN_CORR_OK = 0,
+    CAN_CORR_ERR_ARG = -1,          // Bad argument or unsorted signal windows
+    CAN_CORR_ERR_UNSORTED = -2,     // Frames not in timestamp order
+    CAN_CORR_ERR_NO_MEM = -3
+} can_corr_err_t;
+
+typedef struct {
+    const int64_t *timestamp_us;
+    const uint32_t *can_id;
+    const uint8_t *data;            // 8 bytes per frame, unused bytes zero
+    size_t count;
+} can_corr_frames_t;
+
+typedef struct {
+    const int64_t *window;          // Ascending window indices, all signals back to back
+    const double *value;            // Window mean per entry
+    const size_t *offsets;          // count + 1 entries; signal s is [offsets[s], offsets[s+1])
+    size_t count;
+} can_corr_signals_t;
+
+/**
+ * @brief Correlate every candidate ID's features with every signal
+ *
+ * @param frames Frames in timestamp order
+ * @param ids Candidate CAN IDs
+ * @param id_count Number of candidate IDs
+ * @param signals Windowed diagnostic signals
+ * @param window_us Window length
+ * @param min_windows Minimum aligned windows for a result
+ * @param threads Worker threads (0 = one per core)
+ * @param corr_out [signal][id][feature] correlations, NaN where there is no result
+ * @param windows_out [signal][id] aligned window counts
+ * @return CAN_CORR_OK or a negative can_corr_err_t
+ */
+int can_corr_run(const can_corr_frames_t *frames, const uint32_t *ids, size_t id_count,
+                 const can_corr_signals_t *signals, int64_t window_us, uint32_t min_windows,
+                 unsigned threads, double *corr_out, uint32_t *windows_out);
+
+/**
+ * @brief Feature name as used by diagnostic_correlation.py
+ *
+ * @param index Feature index
+ * @return Name (e.g. "b01_u16_be"), or NULL if out of range
+ */
+const char *can_corr_feature_name(unsigned index);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,680 @@
+/*
+ * CAN Field Hypothesis Search Implementation
+ *
+ * Two passes per field (ID, start bit, length, layout):
+ *
+ * 1. Bitsliced range test on a sample of the ID's frames: up to 64 runs
+ *    of 64 consecutive frames spread over the log. The sample is stored
+ *    as 64 bit planes (plane b holds payload bit b of one run per word),
+ *    so testing lo <= raw <= hi for a field is one MSB-first walk over its
+ *    planes with a handful of word operations per bit, covering 64 frames
+ *    at a time. Every scale/offset pair maps to its own raw bounds and is
+ *    counted this way. Signed fields are compared with their sign plane
+ *    inverted, which orders two's complement values like biased unsigned
+ *    ones. With a step limit, the steps within each run are checked too.
+ *    Pairs failing on the sample are dropped.
+ *
+ * 2. Exact scoring of the remaining pairs over all frames: the field is
+ *    decoded once (shift and mask of the little- or big-endian payload
+ *    word), then range, step and trend are checked per pair.
+ *
+ * Work items are (ID, start bit) and spread over worker threads; each
+ * worker keeps its own best hits, merged and de-duplicated at the end.
+ */
+
+#include "field_search.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#define SAMPLE_RUNS 64      // Of 64 frames, one plane word each
+#define TREND_POINTS 256
+#define SAMPLE_SLACK 0.05   // Sampled share may fall this far below min_fraction
+
+// Per candidate ID: payloads in time order and the bit planes of a sample
+struct id_data_t {
+    uint32_t can_id;
+    unsigned bits;                      // Bits present in every frame (8 * min DLC)
+    std::vector<uint64_t> payload;      // Little-endian payload words
+    std::vector<uint64_t> sample;       // Runs of 64 consecutive payloads
+    std::vector<uint64_t> planes;       // 64 planes of `words` words
+    size_t words;
+};
+
+// One field layout of an ID
+struct field_t {
+    uint8_t start;
+    uint8_t len;
+    bool big_endian;
+    bool is_signed;
+    unsigned shift;                     // Of the LE (or BE) payload word
+    const uint64_t *plane[CAN_FS_MAX_LEN];   // MSB first
+};
+
+struct hit_t {
+    can_fs_hit_t hit;
+    uint64_t hash;                      // Of the decoded value sequence
+};
+
+struct job_t {
+    const can_fs_query_t *query;
+    const std::vector<id_data_t> *ids;
+    size_t item_count;                  // ids * 64
+    size_t max_hits;
+    double lo;                          // Physical bounds after the target window
+    double hi;
+    std::atomic<size_t> next_item;
+    std::atomic<uint64_t> tested;
+};
+
+static unsigned popcount64(uint64_t x)
+{
+    return (unsigned)std::bitset<64>(x).count();
+}
+
+static uint64_t bswap64(uint64_t x)
+{
+    uint64_t r = 0;
+    for (int i = 0; i < 8; i++) {
+        r = (r << 8) | (x & 0xFF);
+        x >>= 8;
+    }
+    return r;
+}
+
+static uint64_t load_le(const uint8_t *d)
+{
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | d[i];
+    }
+    return v;
+}
+
+// Big-endian word bit index -> DBC bit number
+static unsigned be_to_bit(unsigned i)
+{
+    return (7 - i / 8) * 8 + i % 8;
+}
+
+static int64_t decode(const field_t &f, uint64_t le)
+{
+    uint64_t word = f.big_endian ? bswap64(le) : le;
+    uint64_t raw = (word >> f.shift) & ((1ULL << f.len) - 1);
+    if (f.is_signed && (raw >> (f.len - 1))) {
+        return (int64_t)raw - (int64_t)(1ULL << f.len);
+    }
+    return (int64_t)raw;
+}
+
+static bool make_field(const id_data_t &d, uint8_t start, uint8_t len, bool be, bool sgn,
+                       field_t &f)
+{
+    f.start = start;
+    f.len = len;
+    f.big_endian = be;
+    f.is_signed = sgn;
+    if (!be) {
+        if (start + len > d.bits) {
+            return false;
+        }
+        f.shift = start;
+        for (unsigned j = 0; j < len; j++) {
+            f.plane[j] = &d.planes[(size_t)(start + len - 1 - j) * d.words];
+        }
+        return true;
+    }
+
+    unsigned msb = (7 - start / 8) * 8 + start % 8;
+    if (msb + 1 < len || msb + 1 - len < 64 - d.bits) {
+        return false;
+    }
+    f.shift = msb + 1 - len;
+    for (unsigned j = 0; j < len; j++) {
+        f.plane[j] = &d.planes[(size_t)be_to_bit(msb - j) * d.words];
+    }
+    return true;
+}
+
+/*
+ * Raw bounds [lo, hi] of a scale/offset pair, as biased unsigned values
+ * (signed fields + 2^(len-1)). Returns false if no raw value fits.
+ */
+static bool raw_bounds(const job_t &job, const field_t &f, double scale, double offset,
+                       int64_t &lo, int64_t &hi)
+{
+    double a = (job.lo - offset) / scale;
+    double b = (job.hi - offset) / scale;
+    if (scale < 0) {
+        std::swap(a, b);
+    }
+    int64_t dmin = f.is_signed ? -(int64_t)(1ULL << (f.len - 1)) : 0;
+    int64_t dmax = f.is_signed ? (int64_t)(1ULL << (f.len - 1)) - 1
+                               : (int64_t)((1ULL << f.len) - 1);
+    double rlo = std::ceil(a - 1e-9);
+    double rhi = std::floor(b + 1e-9);
+    if (!(rlo <= rhi) || rlo > (double)dmax || rhi < (double)dmin) {
+        return false;
+    }
+    lo = rlo > (double)dmin ? (int64_t)rlo : dmin;
+    hi = rhi < (double)dmax ? (int64_t)rhi : dmax;
+    return true;
+}
+
+// Sampled frames with lo <= biased raw <= hi, 64 frames per word
+static size_t count_in_range(const id_data_t &d, const field_t &f, uint64_t lo, uint64_t hi)
+{
+    const uint64_t flip = f.is_signed ? ~0ULL : 0;
+    const uint64_t top = (1ULL << f.len) - 1;
+    const bool check_lo = lo > 0;
+    const bool check_hi = hi < top;
+    size_t count = 0;
+    for (size_t w = 0; w < d.words; w++) {
+        uint64_t gt = 0, eq_lo = ~0ULL;
+        uint64_t lt = 0, eq_hi = ~0ULL;
+        for (unsigned j = 0; j < f.len; j++) {
+            unsigned bit = f.len - 1 - j;
+            uint64_t x = f.plane[j][w] ^ (j == 0 ? flip : 0);
+            if (check_lo) {
+                if ((lo >> bit) & 1) {
+                    eq_lo &= x;
+                } else {
+                    gt |= eq_lo & x;
+                    eq_lo &= ~x;
+                }
+            }
+            if (check_hi) {
+                if ((hi >> bit) & 1) {
+                    lt |= eq_hi & ~x;
+                    eq_hi &= x;
+                } else {
+                    eq_hi &= ~x;
+                }
+            }
+        }
+        uint64_t in = (gt | eq_lo) & (lt | eq_hi);
+        if (w == d.words - 1 && d.sample.size() % 64) {
+            in &= (1ULL << (d.sample.size() % 64)) - 1;
+        }
+        count += popcount64(in);
+    }
+    return count;
+}
+
+// Largest raw step allowed with this scale
+static double step_limit(const can_fs_query_t *q, double scale)
+{
+    return std::floor(q->max_step / std::fabs(scale) + 1e-9);
+}
+
+// Share of steps within limit inside the sample's runs
+static double sample_steps_ok(const id_data_t &d, const std::vector<int64_t> &v, double limit)
+{
+    const bool runs = d.sample.size() != d.payload.size();
+    size_t steps = 0, ok = 0;
+    for (size_t i = 1; i < v.size(); i++) {
+        if (runs && i % 64 == 0) {
+            continue;
+        }
+        steps++;
+        ok += (double)std::llabs(v[i] - v[i - 1]) <= limit;
+    }
+    return steps ? (double)ok / steps : 1.0;
+}
+
+// Kendall tau-b of up to TREND_POINTS evenly spaced values against time
+static double kendall(const std::vector<int64_t> &v)
+{
+    size_t n = std::min<size_t>(v.size(), TREND_POINTS);
+    if (n < 2) {
+        return 0.0;
+    }
+    int64_t p[TREND_POINTS];
+    for (size_t k = 0; k < n; k++) {
+        p[k] = v[k * v.size() / n];
+    }
+    int64_t score = 0;
+    uint64_t ties = 0;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 1; j < n; j++) {
+            score += (p[j] > p[i]) - (p[j] < p[i]);
+            ties += p[j] == p[i];
+        }
+    }
+    double pairs = (double)n * (n - 1) / 2;
+    double denom = std::sqrt(pairs * (pairs - (double)ties));
+    return denom > 0 ? score / denom : 0.0;
+}
+
+static bool hit_before(const hit_t &a, const hit_t &b)
+{
+    const can_fs_hit_t &x = a.hit;
+    const can_fs_hit_t &y = b.hit;
+    if (x.score != y.score) {
+        return x.score > y.score;
+    }
+    // Equal scores: the finer field (e.g. a counter over its high bits)
+    if (x.changes != y.changes) {
+        return x.changes > y.changes;
+    }
+    if (x.length != y.length) {
+        return x.length < y.length;
+    }
+    if (x.can_id != y.can_id) {
+        return x.can_id < y.can_id;
+    }
+    if (x.is_signed != y.is_signed) {
+        return x.is_signed < y.is_signed;
+    }
+    if (x.big_endian != y.big_endian) {
+        return x.big_endian < y.big_endian;
+    }
+    if (x.start_bit != y.start_bit) {
+        return x.start_bit < y.start_bit;
+    }
+    if (x.scale != y.scale) {
+        return x.scale < y.scale;
+    }
+    return x.offset < y.offset;
+}
+
+// Sort best first, drop duplicate value sequences, keep the best `keep`
+static void prune(std::vector<hit_t> &hits, size_t keep)
+{
+    struct key_hash_t {
+        size_t operator()(const hit_t &h) const
+        {
+            return (size_t)(h.hash ^ ((uint64_t)h.hit.can_id << 32) ^
+                            std::hash<double>()(h.hit.scale) ^
+                            (std::hash<double>()(h.hit.offset) << 1));
+        }
+    };
+    struct key_eq_t {
+        bool operator()(const hit_t &a, const hit_t &b) const
+        {
+            return a.hash == b.hash && a.hit.can_id == b.hit.can_id &&
+                   a.hit.scale == b.hit.scale && a.hit.offset == b.hit.offset;
+        }
+    };
+
+    std::sort(hits.begin(), hits.end(), hit_before);
+    std::unordered_set<hit_t, key_hash_t, key_eq_t> seen;
+    std::vector<hit_t> kept;
+    for (const hit_t &h : hits) {
+        if (kept.size() == keep) {
+            break;
+        }
+        if (seen.insert(h).second) {
+            kept.push_back(h);
+        }
+    }
+    hits.swap(kept);
+}
+
+// Exact checks over all frames for the pairs that passed the sample
+static void score_field(const job_t &job, const id_data_t &d, const field_t &f,
+                        const std::vector<size_t> &pairs, const std::vector<int64_t> &lo,
+                        const std::vector<int64_t> &hi, std::vector<int64_t> &values,
+                        std::vector<hit_t> &out)
+{
+    const can_fs_query_t *q = job.query;
+    const size_t n = d.payload.size();
+    const int64_t bias = f.is_signed ? (int64_t)(1ULL << (f.len - 1)) : 0;
+
+    values.resize(n);
+    uint64_t hash = 1469598103934665603ULL;
+    uint32_t changes = 0;
+    int64_t vmin = INT64_MAX, vmax = INT64_MIN;
+    double sum = 0;
+    double travel = 0;
+    for (size_t i = 0; i < n; i++) {
+        int64_t v = decode(f, d.payload[i]);
+        values[i] = v;
+        hash = (hash ^ (uint64_t)v) * 1099511628211ULL;
+        if (i && v != values[i - 1]) {
+            changes++;
+            travel += (double)std::llabs(v - values[i - 1]);
+        }
+        vmin = std::min(vmin, v);
+        vmax = std::max(vmax, v);
+        sum += (double)v;
+    }
+    double tau = kendall(values);
+
+    // A slow drift moves a small part of its range per frame; noise and
+    // toggling bits keep within a step limit only by having a tiny range
+    double smoothness = 1.0;
+    if (q->max_step > 0 && n > 1 && vmax > vmin) {
+        smoothness = 1.0 - travel / (n - 1) / (double)(vmax - vmin);
+    }
+
+    for (size_t k = 0; k < pairs.size(); k++) {
+        double scale = q->scales[pairs[k] / q->offset_count];
+        double offset = q->offsets[pairs[k] % q->offset_count];
+        int64_t rlo = lo[k] - bias;
+        int64_t rhi = hi[k] - bias;
+
+        size_t in = 0;
+        for (size_t i = 0; i < n; i++) {
+            in += values[i] >= rlo && values[i] <= rhi;
+        }
+        double fraction = (double)in / n;
+        if (fraction < q->min_fraction) {
+            continue;
+        }
+
+        double step_fraction = 1.0;
+        if (q->max_step > 0 && n > 1) {
+            double limit = step_limit(q, scale);
+            size_t ok = 0;
+            for (size_t i = 1; i < n; i++) {
+                ok += (double)std::llabs(values[i] - values[i - 1]) <= limit;
+            }
+            step_fraction = (double)ok / (n - 1);
+            if (step_fraction < q->min_fraction) {
+                continue;
+            }
+        }
+
+        double trend = scale < 0 ? -tau : tau;
+        double trend_weight = 1.0;
+        if (q->trend != CAN_FS_TREND_ANY) {
+            double t = q->trend == CAN_FS_TREND_RISING    ? trend
+                       : q->trend == CAN_FS_TREND_FALLING ? -trend
+                                                          : std::fabs(trend);
+            if (t < q->min_trend || t <= 0) {
+                continue;
+            }
+            trend_weight = t;
+        }
+
+        hit_t h;
+        can_fs_hit_t &r = h.hit;
+        r.can_id = d.can_id;
+        r.start_bit = f.start;
+        r.length = f.len;
+        r.big_endian = f.big_endian;
+        r.is_signed = f.is_signed;
+        r.scale = scale;
+        r.offset = offset;
+        r.fraction = fraction;
+        r.step_fraction = step_fraction;
+        r.trend = trend;
+        double a = vmin * scale + offset;
+        double b = vmax * scale + offset;
+        r.min = std::min(a, b);
+        r.max = std::max(a, b);
+        r.mean = sum / n * scale + offset;
+        r.frames = (uint32_t)n;
+        r.changes = changes;
+
+        double closeness = 1.0;
+        if (!std::isnan(q->target)) {
+            closeness = std::max(0.0, 1.0 - std::fabs(r.mean - q->target) / q->target_tol);
+        }
+        r.score = fraction * step_fraction * smoothness * trend_weight * closeness *
+                  (changes ? 1.0 : 0.5);
+        h.hash = hash;
+        out.push_back(h);
+    }
+}
+
+static void process_item(job_t &job, size_t item, std::vector<int64_t> &values,
+                         std::vector<hit_t> &out)
+{
+    const can_fs_query_t *q = job.query;
+    const id_data_t &d = (*job.ids)[item / 64];
+    const uint8_t start = (uint8_t)(item % 64);
+    if (start >= d.bits) {
+        return;
+    }
+
+    const size_t pair_count = q->scale_count * q->offset_count;
+    const size_t sampled = d.sample.size();
+    const bool exact_sample = sampled == d.payload.size();
+    const double need = q->min_fraction - (exact_sample ? 0.0 : SAMPLE_SLACK);
+    std::vector<size_t> pairs;
+    std::vector<int64_t> lo, hi;
+    std::vector<int64_t> sample_values(sampled);
+    uint64_t tested = 0;
+
+    for (unsigned layout = 0; layout < 4; layout++) {
+        if (!(q->layouts & (1u << layout))) {
+            continue;
+        }
+        const bool sgn = layout & 1;
+        const bool be = layout & 2;
+        for (unsigned len = q->min_len; len <= q->max_len; len++) {
+            field_t f;
+            if ((sgn && len < 2) || !make_field(d, start, (uint8_t)len, be, sgn, f)) {
+                continue;
+            }
+            // One-byte-or-less big-endian fields repeat a little-endian one
+            if (be && len <= 8 && start % 8 + 1u >= len &&
+                (q->layouts & (sgn ? CAN_FS_LAYOUT_LE_SIGNED : CAN_FS_LAYOUT_LE_UNSIGNED))) {
+                continue;
+            }
+            tested += pair_count;
+
+            pairs.clear();
+            lo.clear();
+            hi.clear();
+            const int64_t bias = sgn ? (int64_t)(1ULL << (len - 1)) : 0;
+            for (size_t p = 0; p < pair_count; p++) {
+                int64_t rlo, rhi;
+                if (!raw_bounds(job, f, q->scales[p / q->offset_count],
+                                q->offsets[p % q->offset_count], rlo, rhi)) {
+                    continue;
+                }
+                size_t in = count_in_range(d, f, (uint64_t)(rlo + bias),
+                                           (uint64_t)(rhi + bias));
+                if ((double)in >= need * sampled) {
+                    pairs.push_back(p);
+                    lo.push_back(rlo + bias);
+                    hi.push_back(rhi + bias);
+                }
+            }
+            if (!pairs.empty() && q->max_step > 0 && sampled > 1) {
+                for (size_t i = 0; i < sampled; i++) {
+                    sample_values[i] = decode(f, d.sample[i]);
+                }
+                size_t keep = 0;
+                for (size_t k = 0; k < pairs.size(); k++) {
+                    double scale = q->scales[pairs[k] / q->offset_count];
+                    if (sample_steps_ok(d, sample_values, step_limit(q, scale)) >= need) {
+                        pairs[keep] = pairs[k];
+                        lo[keep] = lo[k];
+                        hi[keep] = hi[k];
+                        keep++;
+                    }
+                }
+                pairs.resize(keep);
+                lo.resize(keep);
+                hi.resize(keep);
+            }
+            if (!pairs.empty()) {
+                score_field(job, d, f, pairs, lo, hi, values, out);
+            }
+        }
+    }
+
+    job.tested.fetch_add(tested, std::memory_order_relaxed);
+    if (out.size() > 4 * job.max_hits + 1024) {
+        prune(out, job.max_hits);
+    }
+}
+
+static void worker_main(job_t *job, std::vector<hit_t> *out)
+{
+    std::vector<int64_t> values;
+    while (1) {
+        size_t item = job->next_item.fetch_add(1, std::memory_order_relaxed);
+        if (item >= job->item_count) {
+            break;
+        }
+        process_item(*job, item, values, *out);
+    }
+    prune(*out, job->max_hits);
+}
+
+static void build_planes(id_data_t &d)
+{
+    const size_t n = d.payload.size();
+    if (n <= SAMPLE_RUNS * 64) {
+        d.sample = d.payload;
+    } else {
+        d.sample.reserve(SAMPLE_RUNS * 64);
+        for (size_t r = 0; r < SAMPLE_RUNS; r++) {
+            size_t first = r * (n - 64) / (SAMPLE_RUNS - 1);
+            d.sample.insert(d.sample.end(), d.payload.begin() + first,
+                            d.payload.begin() + first + 64);
+        }
+    }
+    d.words = (d.sample.size() + 63) / 64;
+    d.planes.assign(64 * d.words, 0);
+    for (size_t k = 0; k < d.sample.size(); k++) {
+        uint64_t p = d.sample[k];
+        uint64_t mask = 1ULL << (k % 64);
+        size_t w = k / 64;
+        while (p) {
+            unsigned b = 0;
+            while (!((p >> b) & 1)) {
+                b++;
+            }
+            d.planes[(size_t)b * d.words + w] |= mask;
+            p &= p - 1;
+        }
+    }
+}
+
+static int run(const can_fs_frames_t *frames, const uint32_t *ids, size_t id_count,
+               const can_fs_query_t *query, unsigned threads, can_fs_hit_t *hits,
+               size_t max_hits, uint64_t *tested)
+{
+    std::unordered_map<uint32_t, uint32_t> slot_of;
+    slot_of.reserve(id_count * 2);
+    std::vector<id_data_t> all(id_count);
+    for (size_t i = 0; i < id_count; i++) {
+        if (!slot_of.emplace(ids[i], (uint32_t)i).second) {
+            return CAN_FS_ERR_ARG;
+        }
+        all[i].can_id = ids[i];
+        all[i].bits = 64;
+    }
+
+    for (size_t i = 0; i < frames->count; i++) {
+        auto it = slot_of.find(frames->can_id[i]);
+        if (it == slot_of.end()) {
+            continue;
+        }
+        id_data_t &d = all[it->second];
+        d.bits = std::min<unsigned>(d.bits, 8u * std::min<unsigned>(frames->dlc[i], 8));
+        d.payload.push_back(load_le(&frames->data[i * 8]));
+    }
+
+    std::vector<id_data_t> data;
+    for (id_data_t &d : all) {
+        if (d.payload.size() >= std::max<uint32_t>(query->min_frames, 1) && d.bits > 0) {
+            build_planes(d);
+            data.push_back(std::move(d));
+        }
+    }
+
+    job_t job;
+    job.query = query;
+    job.ids = &data;
+    job.item_count = data.size() * 64;
+    job.max_hits = max_hits;
+    job.lo = query->min_value;
+    job.hi = query->max_value;
+    if (!std::isnan(query->target)) {
+        job.lo = std::max(job.lo, query->target - query->target_tol);
+        job.hi = std::min(job.hi, query->target + query->target_tol);
+    }
+    job.next_item.store(0);
+    job.tested.store(0);
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = (unsigned)std::min<size_t>(threads, std::max<size_t>(job.item_count, 1));
+
+    // The calling thread is one of the workers
+    std::vector<std::vector<hit_t>> results(threads);
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++) {
+        try {
+            pool.emplace_back(worker_main, &job, &results[t]);
+        } catch (const std::system_error &) {
+            break;  // Fewer workers, same result
+        }
+    }
+    worker_main(&job, &results[0]);
+    for (std::thread &t : pool) {
+        t.join();
+    }
+
+    std::vector<hit_t> merged;
+    for (const std::vector<hit_t> &r : results) {
+        merged.insert(merged.end(), r.begin(), r.end());
+    }
+    prune(merged, max_hits);
+    for (size_t i = 0; i < merged.size(); i++) {
+        hits[i] = merged[i].hit;
+    }
+    if (tested) {
+        *tested = job.tested.load();
+    }
+    return (int)merged.size();
+}
+
+static bool query_valid(const can_fs_query_t *q)
+{
+    if (!q->scale_count || !q->offset_count || !q->scales || !q->offsets ||
+        q->min_len < 1 || q->max_len > CAN_FS_MAX_LEN || q->min_len > q->max_len ||
+        !(q->layouts & CAN_FS_LAYOUT_ALL) || std::isnan(q->min_value) ||
+        std::isnan(q->max_value) || q->min_value > q->max_value ||
+        !(q->min_fraction >= 0.0 && q->min_fraction <= 1.0) || !(q->max_step >= 0.0) ||
+        (unsigned)q->trend > CAN_FS_TREND_EITHER || !(q->min_trend >= 0.0) ||
+        (!std::isnan(q->target) && !(q->target_tol > 0.0))) {
+        return false;
+    }
+    for (size_t i = 0; i < q->scale_count; i++) {
+        if (!(q->scales[i] != 0.0) || !std::isfinite(q->scales[i])) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < q->offset_count; i++) {
+        if (!std::isfinite(q->offsets[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+extern "C" int can_fs_search(const can_fs_frames_t *frames, const uint32_t *ids,
+                             size_t id_count, const can_fs_query_t *query, unsigned threads,
+                             can_fs_hit_t *hits, size_t max_hits, uint64_t *tested)
+{
+    if (!frames || !query || (id_count && !ids) || (max_hits && !hits) ||
+        max_hits > INT32_MAX || frames->count > UINT32_MAX ||
+        (frames->count && (!frames->can_id || !frames->dlc || !frames->data)) ||
+        !query_valid(query)) {
+        return CAN_FS_ERR_ARG;
+    }
+
+    try {
+        return run(frames, ids, id_count, query, threads, hits, max_hits, tested);
+    } catch (const std::bad_alloc &) {
+        return CAN_FS_ERR_NO_MEM;
+    }
+}
@@ -0,0 +1,124 @@
+/*
+ * CAN Field Hypothesis Search
+ *
+ * Native back end for field_search.py. Tests every candidate bit field of
+ * every requested ID against a set of constraints on the physical value
+ *
+ *   value = raw * scale + offset
+ *
+ * where a hypothesis is (ID, start bit, length, byte order, signedness,
+ * scale, offset). Constraints are a physical range (and/or a target value
+ * with tolerance, which narrows it), a largest step between consecutive
+ * frames and a monotonic trend. Hypotheses meeting them are scored and
+ * returned best first.
+ *
+ * Bit numbering is DBC style: bit b is bit (b % 8) of byte (b / 8). A
+ * little-endian field starts at its LSB; a big-endian (Motorola) field
+ * starts at its MSB and continues into the next byte's bit 7.
+ *
+ * Frames must be in time order (steps and trends follow frame order).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_FS_MAX_LEN 32
+
+// Byte orders / signedness to try (can_fs_query_t.layouts)
+#define CAN_FS_LAYOUT_LE_UNSIGNED 0x01
+#define CAN_FS_LAYOUT_LE_SIGNED   0x02
+#define CAN_FS_LAYOUT_BE_UNSIGNED 0x04
+#define CAN_FS_LAYOUT_BE_SIGNED   0x08
+#define CAN_FS_LAYOUT_ALL         0x0F
+
+typedef enum {
+    CAN_FS_OK = 0,
+    CAN_FS_ERR_ARG = -1,
+    CAN_FS_ERR_NO_MEM = -2
+} can_fs_err_t;
+
+typedef enum {
+    CAN_FS_TREND_ANY = 0,           // No trend constraint
+    CAN_FS_TREND_RISING = 1,
+    CAN_FS_TREND_FALLING = 2,
+    CAN_FS_TREND_EITHER = 3         // Monotonic, either direction
+} can_fs_trend_t;
+
+typedef struct {
+    const uint32_t *can_id;
+    const uint8_t *dlc;
+    const uint8_t *data;            // 8 bytes per frame, unused bytes zero
+    size_t count;
+} can_fs_frames_t;
+
+typedef struct {
+    const double *scales;           // Non-zero scales to try
+    size_t scale_count;
+    const double *offsets;          // Offsets to try with every scale
+    size_t offset_count;
+    double min_value;               // Physical range (-inf/+inf = unbounded)
+    double max_value;
+    double target;                  // Known value (NaN = none)
+    double target_tol;              // Values must be within target +- tol
+    double max_step;                // Largest change between frames (0 = any)
+    can_fs_trend_t trend;
+    double min_trend;               // Kendall tau a trend needs (0..1)
+    double min_fraction;            // Share of frames/steps that must comply
+    uint32_t min_frames;            // IDs with fewer frames are skipped
+    uint8_t min_len;                // Field lengths, 1..CAN_FS_MAX_LEN
+    uint8_t max_len;
+    uint8_t layouts;                // CAN_FS_LAYOUT_* bits
+} can_fs_query_t;
+
+typedef struct {
+    uint32_t can_id;
+    uint8_t start_bit;
+    uint8_t length;
+    uint8_t big_endian;
+    uint8_t is_signed;
+    double scale;
+    double offset;
+    double score;                   // 0..1, higher is better
+    double fraction;                // Share of frames within the range
+    double step_fraction;           // Share of steps within max_step (1 if unset)
+    double trend;                   // Kendall tau of the values, -1..1
+    double min;                     // Physical min / mean / max over all frames
+    double mean;
+    double max;
+    uint32_t frames;
+    uint32_t changes;               // Frames whose raw value differs from the previous
+} can_fs_hit_t;
+
+/**
+ * @brief Search all field hypotheses of the given IDs
+ *
+ * Fields whose raw value sequence duplicates a shorter field of the same
+ * ID (e.g. extra always-zero high bits) are reported once. Fields that
+ * never change still match, but score at half weight: with the right
+ * scale any constant byte fits a target. With a step limit, fields that
+ * move a large part of their range per frame (noise, toggling bits)
+ * score lower than slow drifts.
+ *
+ * @param frames Frames in time order
+ * @param ids Candidate CAN IDs
+ * @param id_count Number of candidate IDs
+ * @param query Constraints
+ * @param threads Worker threads (0 = one per core)
+ * @param hits Best hits, highest score first
+ * @param max_hits Capacity of hits
+ * @param tested Out: hypotheses tested (may be NULL)
+ * @return Number of hits written, or a negative can_fs_err_t
+ */
+int can_fs_search(const can_fs_frames_t *frames, const uint32_t *ids, size_t id_count,
+                  const can_fs_query_t *query, unsigned threads, can_fs_hit_t *hits,
+                  size_t max_hits, uint64_t *tested);
+
+#ifdef __cplusplus
+}
+#endif
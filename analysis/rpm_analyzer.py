@@ -1,19 +1,23 @@
 #!/usr/bin/env python3
 """
 RPM Analyzer - Analyze CAN logs for engine RPM candidates
+
+Payload bytes come from the log's signal store (signal_store.py).
 """
-import pandas as pd
 import numpy as np
 import sys
 
+from signal_store import build, byte_fields
+
 def analyze_rpm_candidate(csv_file, can_id):
     """Analyze a specific CAN ID as an RPM candidate"""
     print(f"\n{'='*80}")
     print(f"Analyzing CAN ID 0x{can_id.upper()} for RPM patterns")
     print(f"{'='*80}")
     
-    df = pd.read_csv(csv_file)
-    df_filtered = df[df['can_id'].str.lower() == can_id.lower()].copy()
+    frame_id = int(can_id, 16)
+    store = build(csv_file, byte_fields(frame_id))
+    df_filtered = store.frame(frame_id, dropna=False)
     
     if len(df_filtered) == 0:
         print(f"No messages found for CAN ID 0x{can_id.upper()}")
@@ -23,10 +27,9 @@ def analyze_rpm_candidate(csv_file, can_id):
     print(f"Duration: {(df_filtered['timestamp_us'].max() - df_filtered['timestamp_us'].min()) / 1e6:.2f} seconds")
     print(f"Message rate: {len(df_filtered) / ((df_filtered['timestamp_us'].max() - df_filtered['timestamp_us'].min()) / 1e6):.1f} Hz")
     
-    # Extract byte columns
-    byte_cols = [f'b{i}' for i in range(8)]
-    for col in byte_cols:
-        df_filtered[f'{col}_int'] = df_filtered[col].apply(lambda x: int(x, 16) if isinstance(x, str) else x)
+    # Byte columns as integers (NaN past the DLC)
+    for i in range(8):
+        df_filtered[f'b{i}_int'] = df_filtered[f'b{i}']
     
     print(f"\n{'='*80}")
     print("Statistics for each byte (as integers):")
@@ -76,11 +79,7 @@ def analyze_rpm_candidate(csv_file, can_id):
         timestamp_s = row['timestamp_us'] / 1e6
         hex_bytes = []
         for i in range(8):
-            byte_val = row[f'b{i}']
-            if isinstance(byte_val, str):
-                hex_bytes.append(f"{int(byte_val, 16):02X}")
-            else:
-                hex_bytes.append(f"{int(byte_val):02X}")
+            hex_bytes.append(f"{int(row[f'b{i}']):02X}")
         hex_data = ' '.join(hex_bytes)
         print(f"t={timestamp_s:.1f}s: {hex_data}")
     
@@ -183,7 +182,7 @@ def analyze_rpm_candidate(csv_file, can_id):
 
 if __name__ == "__main__":
     if len(sys.argv) < 3:
-        print("Usage: python3 rpm_analyzer.py <csv_file> <can_id>")
+        print("Usage: python3 rpm_analyzer.py <log_file> <can_id>")
         print("\nExample:")
         print("  python3 rpm_analyzer.py logs/CAN_0003.CSV 2C1")
         sys.exit(1)
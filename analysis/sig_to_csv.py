@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+"""
+Read decoded-signal logs (.sig) written next to the CAN binary logs.
+
+The file holds per-signal chunks, so reading a few signals only decodes
+their chunks and skips the rest by length. Use read_signals() from other
+analysis scripts, or run this file to list signals or convert to CSV.
+"""
+
+import argparse
+import datetime as dt
+import heapq
+import math
+import os
+import struct
+import sys
+
+HEADER_FMT = "<8sHHQQHHI28s"
+HEADER_SIZE = 64
+DESC_FMT = "<24s12sf8s"
+DESC_SIZE = 48
+CHUNK_FMT = "<HHHHHHqi"
+CHUNK_HEADER_SIZE = 24
+CHUNK_MAGIC = 0x4B43
+MAGIC_PREFIX = b"CANSIG\x00"
+VERSION = 1
+HEADER_FLAG_TIMEBASE = 0x01
+
+CSV_HEADER = "datetime,timestamp_us,signal,value\n"
+
+
+def parse_header(data):
+    if len(data) < HEADER_SIZE:
+        raise ValueError("File too small for header")
+
+    (magic, version, header_size, log_start_unix_us, log_start_mono_us,
+     signal_count, desc_size, flags, _) = struct.unpack(HEADER_FMT, data[:HEADER_SIZE])
+
+    if not magic.startswith(MAGIC_PREFIX):
+        raise ValueError(f"Bad magic: {magic!r}")
+    if version != VERSION:
+        raise ValueError(f"Unsupported version: {version}")
+    if header_size != HEADER_SIZE or desc_size != DESC_SIZE:
+        raise ValueError(f"Unexpected header/descriptor size: {header_size}/{desc_size}")
+
+    end = HEADER_SIZE + signal_count * DESC_SIZE
+    if len(data) < end:
+        raise ValueError("File too small for signal descriptors")
+
+    signals = []
+    for i in range(signal_count):
+        offset = HEADER_SIZE + i * DESC_SIZE
+        name, unit, scale, _ = struct.unpack(DESC_FMT, data[offset:offset + DESC_SIZE])
+        signals.append({
+            "name": name.rstrip(b"\x00").decode("ascii", "replace"),
+            "unit": unit.rstrip(b"\x00").decode("ascii", "replace"),
+            "scale": scale,
+        })
+
+    return {
+        "log_start_unix_us": log_start_unix_us,
+        "log_start_monotonic_us": log_start_mono_us,
+        "flags": flags,
+        "signals": signals,
+        "data_offset": end,
+    }
+
+
+def _read_varints(data, start, end, count):
+    values = []
+    pos = start
+    for _ in range(count):
+        value = 0
+        shift = 0
+        while True:
+            if pos >= end:
+                raise ValueError("Truncated varint column")
+            b = data[pos]
+            pos += 1
+            value |= (b & 0x7F) << shift
+            if not b & 0x80:
+                break
+            shift += 7
+        values.append(value)
+    if pos != end:
+        raise ValueError("Varint column length mismatch")
+    return values
+
+
+def iter_chunks(data, offset):
+    """Yield (signal_id, count, first_ts, first_value, ts_start, value_start, end)."""
+    while offset + CHUNK_HEADER_SIZE <= len(data):
+        magic, signal_id, count, ts_bytes, value_bytes, _, first_ts, first_value = \
+            struct.unpack(CHUNK_FMT, data[offset:offset + CHUNK_HEADER_SIZE])
+        if magic != CHUNK_MAGIC or count == 0:
+            raise ValueError(f"Bad chunk header at offset {offset}")
+        ts_start = offset + CHUNK_HEADER_SIZE
+        value_start = ts_start + ts_bytes
+        end = value_start + value_bytes
+        if end > len(data):
+            # Last chunk cut short by power loss
+            return
+        yield signal_id, count, first_ts, first_value, ts_start, value_start, end
+        offset = end
+
+
+def read_signals(path, names=None):
+    """Return (header, {name: (timestamps_us, values)}) for the selected signals.
+
+    Timestamps are monotonic microseconds on the same clock as the CANBIN
+    records; values are in physical units.
+    """
+    with open(path, "rb") as src:
+        data = src.read()
+
+    header = parse_header(data)
+    signals = header["signals"]
+    wanted = set(names) if names else None
+    if wanted:
+        unknown = wanted - {s["name"] for s in signals}
+        if unknown:
+            raise ValueError(f"Unknown signals: {', '.join(sorted(unknown))}")
+
+    out = {s["name"]: ([], []) for s in signals if not wanted or s["name"] in wanted}
+
+    for signal_id, count, first_ts, first_value, ts_start, value_start, end in \
+            iter_chunks(data, header["data_offset"]):
+        if signal_id >= len(signals):
+            raise ValueError(f"Chunk for unknown signal id {signal_id}")
+        signal = signals[signal_id]
+        if signal["name"] not in out:
+            continue
+
+        ts_deltas = _read_varints(data, ts_start, value_start, count - 1)
+        value_deltas = _read_varints(data, value_start, end, count - 1)
+
+        timestamps, values = out[signal["name"]]
+        scale = signal["scale"]
+        ts = first_ts
+        raw = first_value
+        timestamps.append(ts)
+        values.append(raw * scale)
+        for ts_delta, zz in zip(ts_deltas, value_deltas):
+            ts += ts_delta
+            raw += (zz >> 1) ^ -(zz & 1)
+            timestamps.append(ts)
+            values.append(raw * scale)
+
+    return header, out
+
+
+def format_datetime(header, timestamp_us):
+    start_unix_us = header["log_start_unix_us"]
+    if start_unix_us == 0:
+        return ""
+    unix_us = start_unix_us + (timestamp_us - header["log_start_monotonic_us"])
+    stamp = dt.datetime.fromtimestamp(unix_us // 1_000_000).strftime("%Y-%m-%d %H:%M:%S")
+    return f"{stamp}.{(unix_us % 1_000_000) // 1000:03d}"
+
+
+def list_signals(path):
+    header, series = read_signals(path)
+    print(f"{'signal':<20} {'unit':<8} {'scale':>8} {'samples':>8}")
+    for signal in header["signals"]:
+        timestamps, _ = series[signal["name"]]
+        print(f"{signal['name']:<20} {signal['unit']:<8} {signal['scale']:>8g} {len(timestamps):>8}")
+
+
+def _rows(name, timestamps, values):
+    for ts, value in zip(timestamps, values):
+        yield ts, name, value
+
+
+def convert_file(input_path, output_path, names=None):
+    header, series = read_signals(input_path, names)
+    decimals = {
+        s["name"]: max(0, math.ceil(-math.log10(s["scale"]) - 1e-6))
+        for s in header["signals"]
+    }
+
+    # Chunks are per signal; merge them back into one time-ordered stream
+    streams = [_rows(name, *series[name]) for name in series]
+
+    rows = 0
+    with open(output_path, "w", encoding="utf-8") as dst:
+        dst.write(CSV_HEADER)
+        for ts, name, value in heapq.merge(*streams, key=lambda row: row[0]):
+            dst.write(f"{format_datetime(header, ts)},{ts},{name},{value:.{decimals[name]}f}\n")
+            rows += 1
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Read decoded-signal logs (.sig)")
+    parser.add_argument("input", help="Path to .sig log file")
+    parser.add_argument("output", nargs="?", help="Output CSV path")
+    parser.add_argument("--signals", help="Comma-separated signal names to export")
+    parser.add_argument("--list", action="store_true", help="List signals and sample counts")
+    args = parser.parse_args()
+
+    input_path = args.input
+    if not os.path.isfile(input_path):
+        print(f"Input file not found: {input_path}", file=sys.stderr)
+        return 1
+
+    names = [n.strip() for n in args.signals.split(",")] if args.signals else None
+
+    try:
+        if args.list:
+            list_signals(input_path)
+            return 0
+
+        if args.output:
+            output_path = args.output
+        else:
+            base, _ = os.path.splitext(input_path)
+            output_path = base + "_signals.csv"
+
+        rows = convert_file(input_path, output_path, names)
+    except ValueError as exc:
+        print(f"Invalid signal log file: {exc}", file=sys.stderr)
+        return 1
+
+    print(f"Wrote {rows} samples to {output_path}")
+    return 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
@@ -0,0 +1,390 @@
+#!/usr/bin/env python3
+"""
+Per-signal decode cache for CAN logs.
+
+Decoding a signal means gathering its ID's frames and extracting a bit
+field from each; every analyzer run used to redo that from the raw log.
+This module does it once per (log, signal definition) and keeps the result
+next to the log as plain numpy arrays:
+
+    drive.bin.signals/
+        index.json               log size/mtime, definition hash per signal
+        0AA.t.npy                timestamp_us of the ID's frames (int64)
+        0AA.WHEEL_FR.npy         value per frame (float64, NaN where the
+                                 frame does not carry the signal)
+        0AA.WHEEL_FR.chunks.npy  min and max of every CHUNK frames
+
+Builds are incremental: a signal is decoded only when it is missing from
+the store or its definition changed, and the store is rebuilt only when the
+log itself changes. A run whose signals are all stored reads index.json and
+memory-maps the arrays it asks for, without opening the log.
+
+Usage:
+    python3 signal_store.py <log>... [--dbc FILE] [--bytes IDS] [--list]
+
+    Logs may be CANBIN, CSV or text captures (see canbin.py), or
+    directories of CANBIN logs.
+
+From Python:
+    store = signal_store.build("drive.bin", signal_store.load_dbc(["car.dbc"]))
+    t, rpm = store.read(0x1D0, "RPM")
+    df = store.frame(0x0AA)     # timestamp_us + every stored signal of 0x0AA
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import re
+import shutil
+import sys
+import time
+from collections import namedtuple
+from pathlib import Path
+
+import numpy as np
+
+import canbin
+
+VERSION = 1
+CHUNK = 4096
+
+# DBC convention as in canbin.field(); mux is (start, length, big_endian, value)
+# of the multiplexer field the frame must carry for this signal to be present
+Signal = namedtuple("Signal", "can_id name start length big_endian signed scale offset mux",
+                    defaults=(False, False, 1.0, 0.0, None))
+Message = namedtuple("Message", "can_id name signals")
+
+DBC_MESSAGE = re.compile(r"^BO_\s+(\d+)\s+(\w+)\s*:")
+DBC_SIGNAL = re.compile(r"^SG_\s+(\w+)\s*(M|m\d+M?)?\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*"
+                        r"\(\s*([^,\s]+)\s*,\s*([^)\s]+)\s*\)")
+DBC_FLOAT = re.compile(r"^SIG_VALTYPE_\s+(\d+)\s+(\w+)\s*:\s*[12]")
+
+
+def load_dbc(paths):
+    """Messages of one or more DBC files; the first definition of an ID wins."""
+    messages = {}
+    for path in paths:
+        found = []
+        floats = set()
+        current = None
+        for line in Path(path).read_text(errors="ignore").splitlines():
+            line = line.strip()
+            match = DBC_MESSAGE.match(line)
+            if match:
+                frame_id = int(match.group(1))
+                current = None
+                if match.group(2) != "VECTOR__INDEPENDENT_SIG_MSG":
+                    current = (frame_id & 0x1FFFFFFF, match.group(2), [])
+                    found.append(current)
+                continue
+            match = DBC_SIGNAL.match(line)
+            if match and current:
+                current[2].append(match.groups())
+                continue
+            match = DBC_FLOAT.match(line)
+            if match:
+                floats.add((int(match.group(1)) & 0x1FFFFFFF, match.group(2)))
+
+        for can_id, name, rows in found:
+            if can_id in messages:
+                continue
+            signals = []
+            mux = None
+            for sig_name, role, start, length, order, sign, scale, offset in rows:
+                if role == "M":
+                    mux = (int(start), int(length), order == "0")
+            for sig_name, role, start, length, order, sign, scale, offset in rows:
+                if (can_id, sig_name) in floats:
+                    print(f"{path}: skipping float signal {name}.{sig_name}", file=sys.stderr)
+                    continue
+                selector = None
+                if role and role.startswith("m") and mux:
+                    selector = mux + (int(role[1:].rstrip("M")),)
+                signals.append(Signal(can_id, sig_name, int(start), int(length), order == "0",
+                                      sign == "-", float(scale), float(offset), selector))
+            messages[can_id] = Message(can_id, name, signals)
+    return messages
+
+
+def byte_fields(can_id):
+    """The eight payload bytes of an ID as signals b0..b7."""
+    return [Signal(can_id, f"b{i}", i * 8, 8) for i in range(8)]
+
+
+def decode(frames, signal):
+    """Physical value of a signal for every frame; NaN where it is absent."""
+    valid = frames["dlc"] >= canbin.field_bytes(signal.start, signal.length, signal.big_endian)
+    if signal.mux:
+        start, length, big_endian, value = signal.mux
+        valid &= frames["dlc"] >= canbin.field_bytes(start, length, big_endian)
+        valid &= canbin.field(frames["data"], start, length, big_endian) == value
+    raw = canbin.field(frames["data"], signal.start, signal.length, signal.big_endian,
+                       signal.signed)
+    values = raw.astype(np.float64) * signal.scale + signal.offset
+    values[~valid] = np.nan
+    return values
+
+
+def chunk_summary(values):
+    """(n_chunks, 2) array of NaN-ignoring min and max per CHUNK values."""
+    if not len(values):
+        return np.zeros((0, 2))
+    starts = np.arange(0, len(values), CHUNK)
+    return np.column_stack([np.fmin.reduceat(values, starts), np.fmax.reduceat(values, starts)])
+
+
+def store_path(log_path):
+    log_path = Path(log_path)
+    return log_path.with_name(log_path.name + ".signals")
+
+
+def _digest(signal):
+    text = json.dumps([VERSION] + list(signal[2:]))
+    return hashlib.sha1(text.encode()).hexdigest()[:16]
+
+
+def _fingerprint(log_path):
+    st = os.stat(log_path)
+    return [st.st_size, st.st_mtime_ns]
+
+
+def _key(can_id):
+    return f"{can_id:03X}"
+
+
+def _save(path, array):
+    tmp = path.with_name(path.name + ".tmp")
+    with open(tmp, "wb") as f:
+        np.save(f, array)
+    os.replace(tmp, path)
+
+
+def _read_index(directory):
+    try:
+        with open(directory / "index.json") as f:
+            return json.load(f)
+    except (OSError, ValueError):
+        return None
+
+
+def _write_index(directory, index):
+    tmp = directory / "index.json.tmp"
+    with open(tmp, "w") as f:
+        json.dump(index, f, indent=1)
+    os.replace(tmp, directory / "index.json")
+
+
+class SignalStore:
+    """Read side of a log's signal store."""
+
+    def __init__(self, directory, index):
+        self.directory = Path(directory)
+        self.index = index
+
+    @property
+    def frames(self):
+        """CAN frames in the log (None if no signal was ever decoded)."""
+        return self.index.get("frames")
+
+    def ids(self):
+        return sorted(int(key, 16) for key in self.index["ids"])
+
+    def names(self, can_id):
+        entry = self.index["ids"].get(_key(can_id))
+        return list(entry["signals"]) if entry else []
+
+    def count(self, can_id):
+        """Frames of an ID in the log (0 if the ID is not stored)."""
+        entry = self.index["ids"].get(_key(can_id))
+        return entry["count"] if entry else 0
+
+    def _load(self, name):
+        return np.load(self.directory / f"{name}.npy", mmap_mode="r")
+
+    def timestamps(self, can_id):
+        if _key(can_id) not in self.index["ids"]:
+            return np.zeros(0, dtype=np.int64)
+        return self._load(f"{_key(can_id)}.t")
+
+    def values(self, can_id, name):
+        if name not in self.names(can_id):
+            raise KeyError(f"0x{_key(can_id)} {name} is not in {self.directory}")
+        return self._load(f"{_key(can_id)}.{name}")
+
+    def _window(self, t, t0, t1):
+        i0 = 0 if t0 is None else int(np.searchsorted(t, t0, side="left"))
+        i1 = len(t) if t1 is None else int(np.searchsorted(t, t1, side="right"))
+        return i0, max(i0, i1)
+
+    def read(self, can_id, name, t0=None, t1=None, dropna=True):
+        """(timestamp_us, value) of a signal, optionally within [t0, t1]."""
+        t = self.timestamps(can_id)
+        v = self.values(can_id, name)
+        i0, i1 = self._window(t, t0, t1)
+        t, v = t[i0:i1], v[i0:i1]
+        if dropna:
+            keep = ~np.isnan(v)
+            if not keep.all():
+                return t[keep], v[keep]
+        return t, v
+
+    def chunks(self, can_id, name):
+        """(t_first, t_last, min, max) per chunk, e.g. to plot a min/max envelope."""
+        t = self.timestamps(can_id)
+        summary = self._load(f"{_key(can_id)}.{name}.chunks")
+        starts = np.arange(0, len(t), CHUNK)
+        ends = np.minimum(starts + CHUNK, len(t)) - 1
+        return t[starts], t[ends], summary[:, 0], summary[:, 1]
+
+    def minmax(self, can_id, name, t0=None, t1=None):
+        """NaN-ignoring (min, max) of a signal; whole chunks come from the summary."""
+        t = self.timestamps(can_id)
+        v = self.values(can_id, name)
+        i0, i1 = self._window(t, t0, t1)
+        c0, c1 = -(-i0 // CHUNK), i1 // CHUNK
+        if c0 < c1:
+            summary = self._load(f"{_key(can_id)}.{name}.chunks")[c0:c1]
+            lo = np.concatenate([v[i0:c0 * CHUNK], summary[:, 0], v[c1 * CHUNK:i1]])
+            hi = np.concatenate([v[i0:c0 * CHUNK], summary[:, 1], v[c1 * CHUNK:i1]])
+        else:
+            lo = hi = v[i0:i1]
+        if not len(lo):
+            return np.nan, np.nan
+        return float(np.fmin.reduce(lo)), float(np.fmax.reduce(hi))
+
+    def frame(self, can_id, names=None, dropna=True):
+        """DataFrame of timestamp_us plus the given (default: all) signals of an ID.
+
+        With dropna, frames missing any of the signals are left out.
+        """
+        import pandas as pd
+
+        names = self.names(can_id) if names is None else list(names)
+        columns = {"timestamp_us": np.asarray(self.timestamps(can_id))}
+        for name in names:
+            columns[name] = np.asarray(self.values(can_id, name))
+        df = pd.DataFrame(columns)
+        if dropna and names:
+            df = df.dropna(subset=names).reset_index(drop=True)
+        return df
+
+
+def open_store(log_path):
+    """Existing store of a log, or None if there is none or the log changed."""
+    directory = store_path(log_path)
+    index = _read_index(directory)
+    if (index is None or index.get("version") != VERSION
+            or index.get("log") != _fingerprint(log_path)):
+        return None
+    return SignalStore(directory, index)
+
+
+def build(log_path, signals, verbose=False):
+    """Store of a log holding at least the given signals, decoding only what is missing."""
+    log_path = Path(log_path)
+    directory = store_path(log_path)
+    store = open_store(log_path)
+    if store is None:
+        if directory.exists():
+            shutil.rmtree(directory)
+        index = {"version": VERSION, "log": _fingerprint(log_path), "chunk": CHUNK,
+                 "frames": None, "ids": {}}
+        store = SignalStore(directory, index)
+    index = store.index
+
+    stale = {}
+    for signal in signals:
+        entry = index["ids"].get(_key(signal.can_id))
+        stored = entry["signals"].get(signal.name) if entry else None
+        if stored != _digest(signal) and signal.name not in stale.get(signal.can_id, {}):
+            stale.setdefault(signal.can_id, {})[signal.name] = signal
+    if not stale:
+        return store
+
+    start = time.time()
+    directory.mkdir(parents=True, exist_ok=True)
+    log = canbin.open_log(log_path)
+    index["frames"] = len(log)
+    for can_id, by_name in stale.items():
+        key = _key(can_id)
+        frames = log.frames_of(can_id)
+        frames = frames[np.argsort(frames["timestamp_us"], kind="stable")]
+        entry = index["ids"].get(key)
+        if entry is None:
+            _save(directory / f"{key}.t.npy", frames["timestamp_us"].astype(np.int64))
+            entry = index["ids"][key] = {"count": len(frames), "signals": {}}
+        for name, signal in by_name.items():
+            values = decode(frames, signal)
+            _save(directory / f"{key}.{name}.npy", values)
+            _save(directory / f"{key}.{name}.chunks.npy", chunk_summary(values))
+            entry["signals"][name] = _digest(signal)
+    _write_index(directory, index)
+
+    if verbose:
+        count = sum(len(by_name) for by_name in stale.values())
+        print(f"{log_path}: decoded {count} signals in {time.time() - start:.2f}s -> {directory}")
+    return store
+
+
+def find_logs(paths):
+    logs = []
+    for p in paths:
+        p = Path(p)
+        if not p.is_dir():
+            logs.append(p)
+            continue
+        for f in sorted(p.rglob("*")):
+            # Skip canbin.py's parse caches (drive.csv.bin next to drive.csv)
+            if f.suffix.lower() == ".bin" and not f.with_suffix("").exists():
+                logs.append(f)
+    return logs
+
+
+def _parse_ids(text):
+    return [int(item, 16) for item in text.split(",") if item.strip()]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build per-signal decode stores next to CAN logs.")
+    parser.add_argument("logs", nargs="+", help="Log files, or directories of .bin logs")
+    parser.add_argument("--dbc", action="append", default=[], help="DBC file (repeatable)")
+    parser.add_argument("--bytes", type=_parse_ids, default=[],
+                        help="Comma-separated IDs (hex) to store byte by byte (b0..b7)")
+    parser.add_argument("--list", action="store_true", help="Show each store's signals")
+    args = parser.parse_args()
+
+    signals = []
+    for message in load_dbc(args.dbc).values():
+        signals += message.signals
+    for can_id in args.bytes:
+        signals += byte_fields(can_id)
+
+    logs = find_logs(args.logs)
+    if not logs:
+        print("No logs found.")
+        return 1
+
+    for log_path in logs:
+        start = time.time()
+        try:
+            store = build(log_path, signals) if signals else open_store(log_path)
+        except (OSError, ValueError) as exc:
+            print(f"Skipping {log_path}: {exc}", file=sys.stderr)
+            continue
+        if store is None:
+            continue
+        stored = sum(len(store.names(can_id)) for can_id in store.ids())
+        print(f"{log_path}: {stored} signals stored, {time.time() - start:.2f}s")
+        if not args.list:
+            continue
+        for can_id in store.ids():
+            for name in store.names(can_id):
+                lo, hi = store.minmax(can_id, name)
+                present = int(np.count_nonzero(~np.isnan(store.values(can_id, name))))
+                print(f"  0x{can_id:03X} {name:<24} {present:>9} samples  [{lo:g}, {hi:g}]")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -6,59 +6,56 @@ Quick analysis of CAN IDs to find potentially interesting broadcasts.
 """
 
 import sys
-import pandas as pd
 from pathlib import Path
 
+import numpy as np
+
+import canbin
+
 
 def main():
     if len(sys.argv) < 2:
-        print("Usage: python simple_analyzer.py <log_file.csv>")
+        print("Usage: python simple_analyzer.py <log_file>  (CSV, .bin or text)")
         return
 
     log_file = Path(sys.argv[1])
     print(f"Loading {log_file}...")
 
-    df = pd.read_csv(log_file, dtype={
-        'timestamp_us': 'int64',
-        'can_id': 'str',
-        'dlc': 'int',
-        'b0': 'str', 'b1': 'str', 'b2': 'str', 'b3': 'str',
-        'b4': 'str', 'b5': 'str', 'b6': 'str', 'b7': 'str'
-    })
+    log = canbin.open_log(log_file)
 
-    print(f"Loaded {len(df)} messages\n")
+    print(f"Loaded {len(log)} messages\n")
 
     # Get message frequency
-    msg_counts = df['can_id'].value_counts()
-    duration_sec = (df['timestamp_us'].max() - df['timestamp_us'].min()) / 1_000_000
+    ids, counts = log.ids()
+    distinct = log.distinct_payloads()
+    first_seen = [log.index_of(can_id)[0] for can_id in ids]
+    by_count = np.lexsort((first_seen, -counts))
+    duration_sec = log.duration_s()
 
-    print(f"Total unique CAN IDs: {len(msg_counts)}")
+    print(f"Total unique CAN IDs: {len(ids)}")
     print(f"Duration: {duration_sec:.1f} seconds\n")
 
     print("=== High Frequency Messages (> 10 Hz) ===\n")
     print(f"{'CAN ID':<8} {'Count':>10} {'Hz':>8} {'Sample Data':>30}")
     print("-" * 58)
 
-    for can_id, count in msg_counts.head(20).items():
-        hz = count / duration_sec
+    for i in by_count[:20]:
+        hz = counts[i] / duration_sec
         if hz < 10:
             continue
 
-        msgs = df[df['can_id'] == can_id].head(1)
-        data = ' '.join([msgs.iloc[0][f'b{i}'] for i in range(8)])
-        print(f"{can_id:<8} {count:>10,} {hz:>8.1f} {data}")
+        can_id = f"{ids[i]:03X}"
+        data = ' '.join(canbin.HEX[log.data[first_seen[i]]])
+        print(f"{can_id:<8} {counts[i]:>10,} {hz:>8.1f} {data}")
 
     print("\n=== Messages with High Variation (unique data > 100) ===\n")
     print(f"{'CAN ID':<8} {'Count':>10} {'Unique':>8} {'Change Rate':>12}")
 
-    for can_id in msg_counts.index:
-        msgs = df[df['can_id'] == can_id]
-        byte_cols = [f'b{i}' for i in range(8)]
-        unique_combos = msgs[byte_cols].drop_duplicates()
-
-        if len(unique_combos) > 100:
-            change_rate = len(unique_combos) / len(msgs)
-            print(f"{can_id:<8} {len(msgs):>10,} {len(unique_combos):>8} {change_rate*100:>11.1f}%")
+    for i in by_count:
+        if distinct[i] > 100:
+            can_id = f"{ids[i]:03X}"
+            change_rate = distinct[i] / counts[i]
+            print(f"{can_id:<8} {counts[i]:>10,} {distinct[i]:>8} {change_rate*100:>11.1f}%")
 
 
 if __name__ == '__main__':
@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+"""
+Convert trace dumps from the device into Chrome trace JSON.
+
+Input is either a .trc file from the SD card or a serial capture holding
+a console dump (TRACE: hex lines between TRACE-BEGIN and TRACE-END; the
+last complete dump is used). Open the output in https://ui.perfetto.dev
+or chrome://tracing.
+
+Event timestamps are CPU cycle counts of the recording core. They are
+converted to esp_timer microseconds using the nearest later clock
+reference (periodic TRACE_EV_CLOCK events and the dump-time reference),
+so a gap of more than ~8 s without a reference on a core cannot be
+resolved; the firmware records one every telemetry interval.
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+MAGIC = b"CANTRACE"
+VERSION = 1
+FILE_HEADER_FMT = "<8sHHB3sI"
+FILE_HEADER_SIZE = 20
+CORE_HEADER_FMT = "<QIIII"
+CORE_HEADER_SIZE = 24
+EVENT_FMT = "<IHHII"
+EVENT_SIZE = 16
+
+PHASE_SHIFT = 14
+KIND_MASK = 0x3FFF
+PHASE_INSTANT = 0
+PHASE_BEGIN = 1
+PHASE_END = 2
+
+# Mirrors trace_event_kind_t in components/trace/include/trace_format.h:
+# kind -> (name, arg0 label, arg1 label)
+EVENT_KINDS = {
+    1: ("clock", "us_lo", "us_hi"),
+    2: ("can_rx", "id", "dlc"),
+    3: ("decode", "id", None),
+    4: ("log_enqueue", "id", "depth"),
+    5: ("log_drop", "id", None),
+    6: ("flush", "bytes", None),
+    7: ("sd_write", "bytes", None),
+    8: ("sd_sync", None, None),
+    9: ("lvgl_render", None, None),
+    10: ("lvgl_flush", "pixels", "rows"),
+    11: ("page_update", "page", None),
+    12: ("obd_response", "id", "data"),
+    13: ("obd_request", "id", "data"),
+    14: ("fuel_level", "raw", "gal_x100"),
+}
+KIND_CLOCK = 1
+HEX_ARGS = {"id", "data"}
+
+CONSOLE_LINE = re.compile(r"TRACE:([0-9a-fA-F]+)")
+
+
+def _signed32(value):
+    value &= 0xFFFFFFFF
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def load_dump(path):
+    """Return the raw dump bytes from a .trc file or a serial capture."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data.startswith(MAGIC):
+        return data
+
+    dump = None
+    current = None
+    for line in data.decode("ascii", "replace").splitlines():
+        if "TRACE-BEGIN" in line:
+            current = bytearray()
+        elif "TRACE-END" in line:
+            if current is not None:
+                dump = bytes(current)
+            current = None
+        elif current is not None:
+            match = CONSOLE_LINE.search(line)
+            if match:
+                current.extend(bytes.fromhex(match.group(1)))
+    if dump is None:
+        raise ValueError("No trace dump found (expected CANTRACE file or TRACE-BEGIN/END lines)")
+    return dump
+
+
+def parse_dump(data):
+    """Parse a dump into cpu_freq_hz and per-core event lists with times in us."""
+    if len(data) < FILE_HEADER_SIZE:
+        raise ValueError("Dump too small for header")
+
+    magic, version, header_size, core_count, _, cpu_freq_hz = struct.unpack(
+        FILE_HEADER_FMT, data[:FILE_HEADER_SIZE])
+    if magic != MAGIC:
+        raise ValueError(f"Bad magic: {magic!r}")
+    if version != VERSION or header_size != FILE_HEADER_SIZE:
+        raise ValueError(f"Unsupported version/header size: {version}/{header_size}")
+    if cpu_freq_hz == 0:
+        raise ValueError("CPU frequency missing from header")
+
+    cycles_per_us = cpu_freq_hz / 1e6
+    offset = FILE_HEADER_SIZE
+    cores = []
+    for core in range(core_count):
+        if offset + CORE_HEADER_SIZE > len(data):
+            raise ValueError(f"Truncated header for core {core}")
+        ref_us, ref_cycles, count, total, _ = struct.unpack(
+            CORE_HEADER_FMT, data[offset:offset + CORE_HEADER_SIZE])
+        offset += CORE_HEADER_SIZE
+
+        end = offset + count * EVENT_SIZE
+        if end > len(data):
+            raise ValueError(f"Truncated events for core {core}")
+        raw = [struct.unpack(EVENT_FMT, data[pos:pos + EVENT_SIZE])
+               for pos in range(offset, end, EVENT_SIZE)]
+        offset = end
+
+        # Walk newest to oldest, re-anchoring at every clock reference
+        events = []
+        anchor_cycles, anchor_us = ref_cycles, float(ref_us)
+        for cycles, event_id, _, arg0, arg1 in reversed(raw):
+            kind = event_id & KIND_MASK
+            phase = event_id >> PHASE_SHIFT
+            if kind == KIND_CLOCK:
+                anchor_cycles, anchor_us = cycles, float(arg0 | (arg1 << 32))
+                continue
+            ts = anchor_us + _signed32(cycles - anchor_cycles) / cycles_per_us
+            events.append((ts, kind, phase, arg0, arg1))
+        events.reverse()
+
+        cores.append({"events": events, "total": total, "held": count})
+
+    return cpu_freq_hz, cores
+
+
+def _args(kind, phase, arg0, arg1):
+    _, label0, label1 = EVENT_KINDS.get(kind, (None, "arg0", "arg1"))
+    args = {}
+    for label, value in ((label0, arg0), (label1, arg1)):
+        if label:
+            args[label] = f"0x{value:X}" if label in HEX_ARGS else value
+    if kind == 7 and phase == PHASE_END:
+        args = {"written": _signed32(arg0)}
+    return args
+
+
+def to_chrome(cores):
+    """Build Chrome trace events: instants on a per-core track, spans per kind."""
+    out = []
+    tracks = {}
+    for core, info in enumerate(cores):
+        for ts, kind, phase, arg0, arg1 in info["events"]:
+            name = EVENT_KINDS.get(kind, (f"event_{kind}",))[0]
+            # One track per span kind so tasks preempting each other on a
+            # core cannot break begin/end nesting
+            tid = core * 100 + (kind if phase != PHASE_INSTANT else 0)
+            tracks[tid] = f"core{core}" + (f" {name}" if phase != PHASE_INSTANT else "")
+            event = {"name": name, "ts": round(ts, 3), "pid": 1, "tid": tid,
+                     "args": _args(kind, phase, arg0, arg1)}
+            if phase == PHASE_BEGIN:
+                event["ph"] = "B"
+            elif phase == PHASE_END:
+                event["ph"] = "E"
+            else:
+                event["ph"] = "i"
+                event["s"] = "t"
+            out.append(event)
+
+    for tid, name in sorted(tracks.items()):
+        out.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid,
+                    "args": {"name": name}})
+    out.append({"name": "process_name", "ph": "M", "pid": 1, "args": {"name": "esp32s3"}})
+    return {"traceEvents": out, "displayTimeUnit": "ns"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert device trace dumps to Chrome trace JSON")
+    parser.add_argument("input", help=".trc file or serial capture with a console dump")
+    parser.add_argument("output", nargs="?", help="Output JSON path (default: input with .json)")
+    args = parser.parse_args()
+
+    input_path = args.input
+    if not os.path.exists(input_path):
+        print(f"Input file not found: {input_path}", file=sys.stderr)
+        return 1
+
+    output_path = args.output or os.path.splitext(input_path)[0] + ".json"
+
+    try:
+        cpu_freq_hz, cores = parse_dump(load_dump(input_path))
+    except ValueError as exc:
+        print(f"Invalid trace dump: {exc}", file=sys.stderr)
+        return 1
+
+    with open(output_path, "w") as f:
+        json.dump(to_chrome(cores), f)
+
+    for core, info in enumerate(cores):
+        lost = info["total"] - info["held"]
+        print(f"core{core}: {len(info['events'])} events"
+              + (f" ({lost} older events overwritten)" if lost > 0 else ""))
+    print(f"CPU {cpu_freq_hz / 1e6:.0f} MHz, wrote {output_path}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
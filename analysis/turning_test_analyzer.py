@@ -3,7 +3,8 @@
 Turning Test Analyzer
 
 Finds candidate CAN IDs/bytes correlated with left-right wheel speed differences
-to identify steering angle or yaw-related signals.
+to identify steering angle or yaw-related signals. Wheel speeds and candidate
+bytes come from the log's signal store (signal_store.py).
 """
 
 import argparse
@@ -12,6 +13,9 @@ from pathlib import Path
 import numpy as np
 import pandas as pd
 
+from signal_store import build, byte_fields
+from wheel_speed_analyzer import WHEEL_SPEED_SIGNALS
+
 
 DEFAULT_CANDIDATE_IDS = ["0B4", "2C1", "1D0", "1C4", "024", "025"]
 
@@ -20,7 +24,7 @@ def parse_args():
     parser = argparse.ArgumentParser(
         description="Analyze turning behavior using wheel speed differences (CAN 0x0AA)."
     )
-    parser.add_argument("log_file", help="Path to CAN log CSV")
+    parser.add_argument("log_file", help="Path to CAN log (CANBIN, CSV or text)")
     parser.add_argument(
         "--candidates",
         default=",".join(DEFAULT_CANDIDATE_IDS),
@@ -66,36 +70,30 @@ def normalize_ids(raw_ids):
     return ids
 
 
-def hex_to_uint(series):
-    return series.fillna("00").apply(lambda x: int(x, 16) if isinstance(x, str) else int(x)).astype("int64")
-
-
-def be_pair(a, b):
-    return (np.left_shift(a, 8) | b).astype("int64")
+def load_log(log_path, candidate_ids):
+    signals = list(WHEEL_SPEED_SIGNALS)
+    for can_id in candidate_ids:
+        signals += byte_fields(int(can_id, 16))
+    return build(log_path, signals)
 
 
-def load_log(log_path, candidate_ids):
-    cols = ["timestamp_us", "can_id"] + [f"b{i}" for i in range(8)]
-    df = pd.read_csv(log_path, usecols=cols, dtype=str)
-    df["timestamp_us"] = df["timestamp_us"].astype("int64")
-    df["can_id"] = df["can_id"].str.upper().str.replace("0X", "", regex=False)
-    for col in [f"b{i}" for i in range(8)]:
-        df[col] = df[col].fillna("00").str.upper()
-    return df[df["can_id"].isin(["0AA"] + candidate_ids)].copy()
+def load_bytes(store, can_id):
+    """timestamp_us and b0..b7 of an ID; bytes past the DLC read as 0."""
+    msgs = store.frame(int(can_id, 16), [f"b{i}" for i in range(8)], dropna=False)
+    for i in range(8):
+        msgs[f"b{i}"] = msgs[f"b{i}"].fillna(0).astype("int64")
+    return msgs
 
 
-def build_wheel_df(df):
-    wheel = df[df["can_id"] == "0AA"].copy()
+def build_wheel_df(store):
+    wheel = store.frame(0x0AA, [signal.name for signal in WHEEL_SPEED_SIGNALS])
     if wheel.empty:
         return None
 
-    for i in range(8):
-        wheel[f"b{i}"] = hex_to_uint(wheel[f"b{i}"])
-
-    fr = be_pair(wheel["b0"].to_numpy(), wheel["b1"].to_numpy())
-    fl = be_pair(wheel["b2"].to_numpy(), wheel["b3"].to_numpy())
-    rr = be_pair(wheel["b4"].to_numpy(), wheel["b5"].to_numpy())
-    rl = be_pair(wheel["b6"].to_numpy(), wheel["b7"].to_numpy())
+    fr = wheel["raw_fr"].to_numpy().astype("int64")
+    fl = wheel["raw_fl"].to_numpy().astype("int64")
+    rr = wheel["raw_rr"].to_numpy().astype("int64")
+    rl = wheel["raw_rl"].to_numpy().astype("int64")
 
     fr_kph = (fr - 6750) / 100.0
     fl_kph = (fl - 6750) / 100.0
@@ -199,7 +197,7 @@ def print_top_deltas(feature_table, turning_mask, straight_mask, top_n):
 
 
 def analyze_candidates(
-    df,
+    store,
     wheel_df,
     candidate_ids,
     min_speed,
@@ -211,15 +209,11 @@ def analyze_candidates(
     tolerance_us = tolerance_ms * 1000
 
     for can_id in candidate_ids:
-        msgs = df[df["can_id"] == can_id].copy()
+        msgs = load_bytes(store, can_id)
         if msgs.empty:
             print(f"\n-- {can_id}: no data")
             continue
 
-        for i in range(8):
-            msgs[f"b{i}"] = hex_to_uint(msgs[f"b{i}"])
-
-        msgs = msgs.sort_values("timestamp_us")
         aligned = pd.merge_asof(
             msgs,
             wheel_df,
@@ -260,12 +254,12 @@ def main():
     candidate_ids = normalize_ids(args.candidates)
 
     print(f"Loading {log_file}...")
-    df = load_log(log_file, candidate_ids)
-    if df.empty:
+    store = load_log(log_file, candidate_ids)
+    if not any(store.count(int(can_id, 16)) for can_id in ["0AA"] + candidate_ids):
         print("No matching CAN IDs found in log.")
         return
 
-    wheel_df = build_wheel_df(df)
+    wheel_df = build_wheel_df(store)
     if wheel_df is None:
         print("No wheel speed data (0x0AA) found; cannot analyze turning.")
         return
@@ -276,7 +270,7 @@ def main():
 
     print("\n=== Candidate Turning Correlations ===")
     analyze_candidates(
-        df,
+        store,
         wheel_df,
         candidate_ids,
         args.min_speed,
@@ -3,13 +3,24 @@
 Wheel Speed Analysis
 
 Validates wheel speed broadcast messages (0x0AA) and compares with diagnostic data.
+Wheel speeds come from the log's signal store (signal_store.py), so only the
+first run on a log decodes it.
 """
 
 import sys
-import pandas as pd
 import numpy as np
 from pathlib import Path
 
+from signal_store import Signal, build
+
+# 0x0AA: four 16-bit big-endian raw wheel speeds, in FR, FL, RR, RL order
+WHEEL_SPEED_SIGNALS = [
+    Signal(0x0AA, 'raw_fr', 7, 16, big_endian=True),
+    Signal(0x0AA, 'raw_fl', 23, 16, big_endian=True),
+    Signal(0x0AA, 'raw_rr', 39, 16, big_endian=True),
+    Signal(0x0AA, 'raw_rl', 55, 16, big_endian=True),
+]
+
 
 class WheelSpeedAnalyzer:
     """Analyzes wheel speed data from CAN logs."""
@@ -17,21 +28,15 @@ class WheelSpeedAnalyzer:
     def __init__(self, log_file):
         """Initialize analyzer with a log file path."""
         self.log_file = Path(log_file)
-        self.df = None
+        self.store = None
         self.wheel_speed_msgs = None
 
     def load_log(self):
-        """Load CSV log file into pandas DataFrame."""
+        """Open the log's signal store, decoding the wheel speeds on first use."""
         print(f"Loading {self.log_file}...")
-        self.df = pd.read_csv(self.log_file, dtype={
-            'timestamp_us': 'int64',
-            'can_id': 'str',
-            'dlc': 'int',
-            'b0': 'str', 'b1': 'str', 'b2': 'str', 'b3': 'str',
-            'b4': 'str', 'b5': 'str', 'b6': 'str', 'b7': 'str'
-        })
-        print(f"Loaded {len(self.df)} messages")
-        return self.df
+        self.store = build(self.log_file, WHEEL_SPEED_SIGNALS)
+        print(f"Loaded {self.store.frames} messages")
+        return self.store
 
     def parse_wheel_speed_broadcast(self):
         """
@@ -42,21 +47,18 @@ class WheelSpeedAnalyzer:
         km/h = (raw_value - 6750) / 100.0
         Wheel order: FR, FL, RR, RL
         """
-        if self.df is None:
+        if self.store is None:
             self.load_log()
 
-        msgs = self.df[self.df['can_id'] == '0AA'].copy()
+        raw_cols = [signal.name for signal in WHEEL_SPEED_SIGNALS]
+        msgs = self.store.frame(0x0AA, raw_cols)
         if len(msgs) == 0:
             print("No wheel speed broadcast messages found (CAN ID 0x0AA)")
             return None
 
         print(f"Found {len(msgs)} wheel speed broadcast messages")
 
-        # Parse 16-bit big-endian wheel speed values
-        msgs['raw_fr'] = msgs.apply(lambda row: int(row['b0'], 16) * 256 + int(row['b1'], 16), axis=1)
-        msgs['raw_fl'] = msgs.apply(lambda row: int(row['b2'], 16) * 256 + int(row['b3'], 16), axis=1)
-        msgs['raw_rr'] = msgs.apply(lambda row: int(row['b4'], 16) * 256 + int(row['b5'], 16), axis=1)
-        msgs['raw_rl'] = msgs.apply(lambda row: int(row['b6'], 16) * 256 + int(row['b7'], 16), axis=1)
+        msgs[raw_cols] = msgs[raw_cols].astype('int64')
 
         # Convert to km/h (offset 6750, scale 0.01)
         offset = 6750
@@ -72,6 +74,8 @@ class WheelSpeedAnalyzer:
         # Calculate wheel speed differences (for turning detection)
         msgs['lr_diff'] = msgs['wheel_fl_kph'] - msgs['wheel_fr_kph']
         msgs['lr_diff_rear'] = msgs['wheel_rl_kph'] - msgs['wheel_rr_kph']
+        # Default segment threshold, so --export works without --segments
+        msgs['is_moving'] = msgs['avg_wheel_kph'] > 5
 
         self.wheel_speed_msgs = msgs
         return msgs
@@ -247,7 +251,7 @@ class WheelSpeedAnalyzer:
 def main():
     """Main entry point for command-line usage."""
     if len(sys.argv) < 2:
-        print("Usage: python wheel_speed_analyzer.py <log_file.csv> [options]")
+        print("Usage: python wheel_speed_analyzer.py <log_file> [options]")
         print("\nOptions:")
         print("  --stats           Show wheel speed statistics")
         print("  --segments        Identify driving segments")
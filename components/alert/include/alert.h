@@ -0,0 +1,94 @@
+/*
+ * Alerts
+ *
+ * Runs an alert_engine_t over the firmware's rule table in the CAN RX
+ * task. Decode handlers call alert_eval() with each new value; when a
+ * rule changes state the outputs it names are driven right there:
+ *
+ *   ALERT_OUT_GPIO     CONFIG_ALERT_GPIO follows "any GPIO rule raised"
+ *   ALERT_OUT_OVERLAY  The change callback runs (e.g. to wake the UI)
+ *   ALERT_OUT_LOG      A CAN_BIN_META_EVENT record is queued to the log
+ *
+ * alert_eval() must only be called from one task (the RX task); the
+ * accessors may be called from any task.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "alert_engine.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Called from alert_eval() when an overlay rule is raised or cleared
+ *
+ * Runs in the RX task; keep it short.
+ *
+ * @param active_mask Active rules after the change
+ * @param ctx Context given to alert_init()
+ */
+typedef void (*alert_change_cb_t)(uint32_t active_mask, void *ctx);
+
+/**
+ * @brief Set up the engine and the alert GPIO
+ *
+ * @param rules Rule table (kept by pointer)
+ * @param count Number of rules (<= ALERT_MAX_RULES)
+ * @param on_change Overlay change callback (may be NULL)
+ * @param ctx Passed to on_change
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on a bad table
+ */
+esp_err_t alert_init(const alert_rule_t *rules, size_t count,
+                     alert_change_cb_t on_change, void *ctx);
+
+/**
+ * @brief Feed a decoded value to a rule and drive its outputs on a change
+ *
+ * @param rule Rule index
+ * @param value Decoded value
+ * @param rx_us RX time of the frame the value came from
+ */
+void alert_eval(size_t rule, float value, int64_t rx_us);
+
+/**
+ * @brief Rules currently raised
+ *
+ * @return Bit per active rule
+ */
+uint32_t alert_get_active_mask(void);
+
+/**
+ * @brief Highest-severity raised rule with the given outputs
+ *
+ * @param outputs ALERT_OUT_* bits the rule must have (0 = any)
+ * @return Rule index, or -1 if none
+ */
+int alert_top(uint8_t outputs);
+
+/**
+ * @brief Rule definition
+ *
+ * @param rule Rule index
+ * @return Rule, or NULL if out of range
+ */
+const alert_rule_t *alert_get_rule(size_t rule);
+
+/**
+ * @brief Copy a rule's state (last value, raise count, ...)
+ *
+ * @param rule Rule index
+ * @param out Filled with the state
+ * @return true on success, false if out of range
+ */
+bool alert_get_state(size_t rule, alert_state_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Alert Engine
+ *
+ * Threshold alerts evaluated inline with decoding. Each rule compares
+ * one value against a threshold; the condition must hold for the
+ * debounce time before the alert is raised, and the value must come back
+ * past the threshold by the hysteresis margin (for the same debounce
+ * time) before it clears. An update touches only its own rule, so the
+ * cost per sample is constant regardless of the number of rules.
+ *
+ * Debounce is measured between samples: an alert raises on the first
+ * sample at least debounce_us after the condition began.
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ALERT_MAX_RULES 32
+
+typedef enum {
+    ALERT_ABOVE = 0,    // value > threshold
+    ALERT_BELOW,        // value < threshold
+    ALERT_ABS_ABOVE     // |value| > threshold
+} alert_compare_t;
+
+// Outputs a raised alert drives (interpreted by the caller)
+#define ALERT_OUT_GPIO     (1u << 0)
+#define ALERT_OUT_OVERLAY  (1u << 1)
+#define ALERT_OUT_LOG      (1u << 2)
+
+typedef struct {
+    const char *name;       // Short text for the overlay
+    alert_compare_t compare;
+    float threshold;
+    float hysteresis;       // Clear margin back past the threshold (>= 0)
+    uint32_t debounce_us;   // Hold time before raising and before clearing
+    uint8_t severity;       // Higher wins on a shared display
+    uint8_t outputs;        // ALERT_OUT_* bits
+} alert_rule_t;
+
+typedef struct {
+    bool active;
+    bool pending;           // Condition flipped, waiting for debounce
+    int64_t pending_since_us;
+    float last_value;
+    uint32_t raise_count;
+} alert_state_t;
+
+typedef enum {
+    ALERT_EVENT_NONE = 0,
+    ALERT_EVENT_RAISED,
+    ALERT_EVENT_CLEARED
+} alert_event_t;
+
+typedef struct {
+    const alert_rule_t *rules;
+    alert_state_t state[ALERT_MAX_RULES];
+    size_t count;
+    uint32_t active_mask;   // Bit per active rule
+} alert_engine_t;
+
+/**
+ * @brief Set up an engine over a rule table
+ *
+ * @param engine Engine to initialize
+ * @param rules Rule table (kept by pointer)
+ * @param count Number of rules (<= ALERT_MAX_RULES)
+ * @return true on success, false on bad arguments
+ */
+bool alert_engine_init(alert_engine_t *engine, const alert_rule_t *rules, size_t count);
+
+/**
+ * @brief Feed one sample to a rule
+ *
+ * @param engine Engine
+ * @param rule Rule index
+ * @param value Sample value
+ * @param now_us Sample time
+ * @return ALERT_EVENT_RAISED or ALERT_EVENT_CLEARED when the state
+ *         changes, ALERT_EVENT_NONE otherwise
+ */
+alert_event_t alert_engine_update(alert_engine_t *engine, size_t rule, float value,
+                                  int64_t now_us);
+
+/**
+ * @brief Highest-severity active rule among those with given outputs
+ *
+ * @param engine Engine
+ * @param active_mask Active rules to consider (e.g. a copy of active_mask)
+ * @param outputs ALERT_OUT_* bits the rule must have (0 = any)
+ * @return Rule index, or -1 if none
+ */
+int alert_engine_top(const alert_engine_t *engine, uint32_t active_mask, uint8_t outputs);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,169 @@
+/*
+ * Alerts Implementation
+ */
+
+#include <string.h>
+
+#include <driver/gpio.h>
+#include <esp_log.h>
+
+#include "alert.h"
+#include "can_bin_format.h"
+#include "can_logger.h"
+
+static const char *TAG = "alert";
+
+// Module state
+static struct {
+    alert_engine_t engine;
+    alert_change_cb_t on_change;
+    void *ctx;
+    uint32_t gpio_rules;     // Rules with ALERT_OUT_GPIO
+    uint32_t overlay_rules;  // Rules with ALERT_OUT_OVERLAY
+    uint32_t active_mask;    // Published copy of engine.active_mask
+    bool gpio_on;
+} s_alert = {
+    .on_change = NULL,
+    .ctx = NULL,
+    .gpio_rules = 0,
+    .overlay_rules = 0,
+    .active_mask = 0,
+    .gpio_on = false
+};
+
+static void gpio_drive(bool on)
+{
+#if CONFIG_ALERT_GPIO >= 0
+#if CONFIG_ALERT_GPIO_ACTIVE_LOW
+    gpio_set_level(CONFIG_ALERT_GPIO, on ? 0 : 1);
+#else
+    gpio_set_level(CONFIG_ALERT_GPIO, on ? 1 : 0);
+#endif
+#else
+    (void)on;
+#endif
+}
+
+static void gpio_init(void)
+{
+#if CONFIG_ALERT_GPIO >= 0
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << CONFIG_ALERT_GPIO,
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+
+    esp_err_t err = gpio_config(&io_conf);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Alert GPIO %d setup failed: %s",
+                 CONFIG_ALERT_GPIO, esp_err_to_name(err));
+        return;
+    }
+    gpio_drive(false);
+    ESP_LOGI(TAG, "Alert output on GPIO %d", CONFIG_ALERT_GPIO);
+#endif
+}
+
+esp_err_t alert_init(const alert_rule_t *rules, size_t count,
+                     alert_change_cb_t on_change, void *ctx)
+{
+    if (!alert_engine_init(&s_alert.engine, rules, count))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_alert.gpio_rules = 0;
+    s_alert.overlay_rules = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (rules[i].outputs & ALERT_OUT_GPIO)
+        {
+            s_alert.gpio_rules |= 1u << i;
+        }
+        if (rules[i].outputs & ALERT_OUT_OVERLAY)
+        {
+            s_alert.overlay_rules |= 1u << i;
+        }
+    }
+
+    s_alert.on_change = on_change;
+    s_alert.ctx = ctx;
+    s_alert.gpio_on = false;
+    __atomic_store_n(&s_alert.active_mask, 0, __ATOMIC_RELEASE);
+
+    gpio_init();
+    ESP_LOGI(TAG, "%u alert rules", (unsigned)count);
+    return ESP_OK;
+}
+
+void alert_eval(size_t rule, float value, int64_t rx_us)
+{
+    alert_event_t event = alert_engine_update(&s_alert.engine, rule, value, rx_us);
+    if (event == ALERT_EVENT_NONE)
+    {
+        return;
+    }
+
+    uint32_t active = s_alert.engine.active_mask;
+    uint32_t bit = 1u << rule;
+    __atomic_store_n(&s_alert.active_mask, active, __ATOMIC_RELEASE);
+
+    // GPIO first: it is the lowest-latency output
+    bool gpio_on = (active & s_alert.gpio_rules) != 0;
+    if (gpio_on != s_alert.gpio_on)
+    {
+        s_alert.gpio_on = gpio_on;
+        gpio_drive(gpio_on);
+    }
+
+    if ((bit & s_alert.overlay_rules) && s_alert.on_change)
+    {
+        s_alert.on_change(active, s_alert.ctx);
+    }
+
+    const alert_rule_t *r = &s_alert.engine.rules[rule];
+    if (r->outputs & ALERT_OUT_LOG)
+    {
+        can_bin_event_v1_t ev = {
+            .source = (uint16_t)rule,
+            .kind = event == ALERT_EVENT_RAISED ? CAN_BIN_EVENT_ALERT_RAISED
+                                                : CAN_BIN_EVENT_ALERT_CLEARED,
+            .severity = r->severity,
+            .value = value
+        };
+        // Not logging (or ring full) just means no record
+        (void)can_logger_log_meta(rx_us, CAN_BIN_META_EVENT, &ev, sizeof(ev));
+    }
+}
+
+uint32_t alert_get_active_mask(void)
+{
+    return __atomic_load_n(&s_alert.active_mask, __ATOMIC_ACQUIRE);
+}
+
+int alert_top(uint8_t outputs)
+{
+    return alert_engine_top(&s_alert.engine, alert_get_active_mask(), outputs);
+}
+
+const alert_rule_t *alert_get_rule(size_t rule)
+{
+    if (rule >= s_alert.engine.count)
+    {
+        return NULL;
+    }
+    return &s_alert.engine.rules[rule];
+}
+
+bool alert_get_state(size_t rule, alert_state_t *out)
+{
+    if (rule >= s_alert.engine.count || !out)
+    {
+        return false;
+    }
+    memcpy(out, &s_alert.engine.state[rule], sizeof(*out));
+    return true;
+}
@@ -0,0 +1,95 @@
+/*
+ * Alert Engine - Implementation
+ */
+
+#include "alert_engine.h"
+
+#include <math.h>
+#include <string.h>
+
+bool alert_engine_init(alert_engine_t *engine, const alert_rule_t *rules, size_t count)
+{
+    if (!engine || (!rules && count > 0) || count > ALERT_MAX_RULES) {
+        return false;
+    }
+
+    memset(engine, 0, sizeof(*engine));
+    engine->rules = rules;
+    engine->count = count;
+    return true;
+}
+
+// Condition for raising (active == false) or for staying raised
+static bool condition_holds(const alert_rule_t *r, float value, bool active)
+{
+    float margin = active ? r->hysteresis : 0.0f;
+    switch (r->compare) {
+        case ALERT_ABOVE:
+            return value > r->threshold - margin;
+        case ALERT_BELOW:
+            return value < r->threshold + margin;
+        case ALERT_ABS_ABOVE:
+            return fabsf(value) > r->threshold - margin;
+        default:
+            return false;
+    }
+}
+
+alert_event_t alert_engine_update(alert_engine_t *engine, size_t rule, float value,
+                                  int64_t now_us)
+{
+    if (!engine || rule >= engine->count) {
+        return ALERT_EVENT_NONE;
+    }
+
+    const alert_rule_t *r = &engine->rules[rule];
+    alert_state_t *s = &engine->state[rule];
+    s->last_value = value;
+
+    // "flip" is true while the sample argues for the other state
+    bool flip = condition_holds(r, value, s->active) != s->active;
+    if (!flip) {
+        s->pending = false;
+        return ALERT_EVENT_NONE;
+    }
+
+    if (!s->pending) {
+        s->pending = true;
+        s->pending_since_us = now_us;
+    }
+    if (now_us - s->pending_since_us < (int64_t)r->debounce_us) {
+        return ALERT_EVENT_NONE;
+    }
+
+    s->pending = false;
+    s->active = !s->active;
+    if (s->active) {
+        s->raise_count++;
+        engine->active_mask |= 1u << rule;
+        return ALERT_EVENT_RAISED;
+    }
+    engine->active_mask &= ~(1u << rule);
+    return ALERT_EVENT_CLEARED;
+}
+
+int alert_engine_top(const alert_engine_t *engine, uint32_t active_mask, uint8_t outputs)
+{
+    if (!engine) {
+        return -1;
+    }
+
+    int best = -1;
+    for (size_t i = 0; i < engine->count; i++) {
+        if (!(active_mask & (1u << i))) {
+            continue;
+        }
+        const alert_rule_t *r = &engine->rules[i];
+        if (outputs != 0 && (r->outputs & outputs) != outputs) {
+            continue;
+        }
+        if (best < 0 || r->severity > engine->rules[best].severity) {
+            best = (int)i;
+        }
+    }
+    return best;
+}
@@ -0,0 +1,97 @@
+/*
+ * CANBIN File Format
+ *
+ * On-disk layout of the binary CAN log (see docs/BINARY_LOGGING.md).
+ * No hardware dependencies - shared by the logger and host-side tests.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_BIN_MAGIC "CANBIN\0"
+#define CAN_BIN_VERSION 1
+#define CAN_BIN_HEADER_SIZE 64
+#define CAN_BIN_RECORD_SIZE 24
+
+// Header flags
+#define CAN_BIN_HEADER_FLAG_TIMEBASE 0x01  // log_start_unix_us is RTC-disciplined (sub-second)
+
+// Record flags
+#define CAN_BIN_RECORD_FLAG_META 0x01  // can_id holds a meta type, not a CAN ID
+
+// Meta record types (stored in can_id when CAN_BIN_RECORD_FLAG_META is set)
+#define CAN_BIN_META_TRAILER 0x01
+#define CAN_BIN_META_SYNC    0x02  // data = int64 unix_us at timestamp_us,
+                                   // reserved = uncertainty in us (saturating)
+#define CAN_BIN_META_EVENT   0x03  // data = can_bin_event_v1_t
+
+// Trailer stage bits (data[7] of a trailer record)
+#define CAN_BIN_TRAILER_STAGE_PENDING  0x01  // Partially filled write buffer written
+#define CAN_BIN_TRAILER_STAGE_COMMIT   0x02  // Pending data synced before drain
+#define CAN_BIN_TRAILER_STAGE_DRAIN    0x04  // Ring buffer fully drained
+
+typedef struct __attribute__((packed)) {
+    char magic[8];
+    uint16_t version;
+    uint16_t header_size;
+    uint64_t log_start_unix_us;
+    uint64_t log_start_monotonic_us;
+    uint32_t record_size;
+    uint32_t flags;
+    uint8_t reserved[28];
+} can_bin_header_v1_t;
+
+typedef struct __attribute__((packed)) {
+    uint64_t timestamp_us;
+    uint32_t can_id;
+    uint8_t dlc;
+    uint8_t flags;
+    uint8_t data[8];
+    uint16_t reserved;
+} can_bin_record_v1_t;
+
+// Trailer payload (data[] of a CAN_BIN_META_TRAILER record, little-endian)
+typedef struct __attribute__((packed)) {
+    uint32_t records_logged;     // CAN records written to this file (meta records excluded)
+    uint16_t records_abandoned;  // Records left in the ring when the budget ran out (saturating)
+    uint8_t reason;              // can_logger_stop_reason_t
+    uint8_t stages;              // CAN_BIN_TRAILER_STAGE_* bits
+} can_bin_trailer_v1_t;
+
+// Event kinds (can_bin_event_v1_t.kind)
+#define CAN_BIN_EVENT_ALERT_RAISED   0x01
+#define CAN_BIN_EVENT_ALERT_CLEARED  0x02
+#define CAN_BIN_EVENT_BUS_STATE      0x03  // source = new, severity = previous bus state
+
+// Event payload (data[] of a CAN_BIN_META_EVENT record, little-endian)
+typedef struct __attribute__((packed)) {
+    uint16_t source;    // Alert rule index, or bus state for CAN_BIN_EVENT_BUS_STATE
+    uint8_t kind;       // CAN_BIN_EVENT_*
+    uint8_t severity;
+    float value;        // Value that triggered the event (larger error counter for bus state)
+} can_bin_event_v1_t;
+
+#ifdef __cplusplus
+static_assert(sizeof(can_bin_header_v1_t) == CAN_BIN_HEADER_SIZE, "Binary header size mismatch");
+static_assert(sizeof(can_bin_record_v1_t) == CAN_BIN_RECORD_SIZE, "Binary record size mismatch");
+static_assert(sizeof(can_bin_trailer_v1_t) == 8, "Trailer payload size mismatch");
+static_assert(sizeof(can_bin_event_v1_t) == 8, "Event payload size mismatch");
+#else
+_Static_assert(sizeof(can_bin_header_v1_t) == CAN_BIN_HEADER_SIZE,
+               "Binary header size mismatch");
+_Static_assert(sizeof(can_bin_record_v1_t) == CAN_BIN_RECORD_SIZE,
+               "Binary record size mismatch");
+_Static_assert(sizeof(can_bin_trailer_v1_t) == 8,
+               "Trailer payload size mismatch");
+_Static_assert(sizeof(can_bin_event_v1_t) == 8,
+               "Event payload size mismatch");
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,84 @@
+/*
+ * Latency Histogram
+ *
+ * Fixed log2 buckets for timing SD writes and other slow operations
+ * without storing samples. Bucket 0 holds everything below 128 us,
+ * bucket i holds [64 << i, 128 << i) us, and the last bucket is open
+ * ended (>= ~2.1 s). Percentiles are reported as the upper edge of the
+ * bucket they fall in, so they are accurate to a factor of two.
+ *
+ * Each histogram must have a single writer; readers copy it and may see
+ * a sample counted in one field but not yet in another.
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_LATENCY_HIST_BUCKETS 16
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t buckets[CAN_LATENCY_HIST_BUCKETS];
+} can_latency_hist_t;
+
+/**
+ * @brief Clear all samples
+ *
+ * @param hist Histogram to reset
+ */
+void can_latency_hist_reset(can_latency_hist_t *hist);
+
+/**
+ * @brief Add one sample
+ *
+ * @param hist Histogram
+ * @param latency_us Measured latency (negative values count as 0)
+ */
+void can_latency_hist_record(can_latency_hist_t *hist, int64_t latency_us);
+
+/**
+ * @brief Bucket index of a latency
+ *
+ * @param latency_us Latency in microseconds
+ * @return Bucket index (0 .. CAN_LATENCY_HIST_BUCKETS - 1)
+ */
+int can_latency_hist_bucket(uint32_t latency_us);
+
+/**
+ * @brief Exclusive upper edge of a bucket
+ *
+ * @param bucket Bucket index
+ * @return Upper edge in microseconds, UINT32_MAX for the last bucket
+ */
+uint32_t can_latency_hist_bucket_upper_us(int bucket);
+
+/**
+ * @brief Estimate a percentile
+ *
+ * @param hist Histogram
+ * @param percent Percentile (0-100)
+ * @return Upper edge of the bucket holding the percentile, capped at the
+ *         largest sample; 0 if the histogram is empty
+ */
+uint32_t can_latency_hist_percentile(const can_latency_hist_t *hist, uint32_t percent);
+
+/**
+ * @brief Add the samples of one histogram to another
+ *
+ * @param dst Histogram to add to
+ * @param src Histogram to add
+ */
+void can_latency_hist_merge(can_latency_hist_t *dst, const can_latency_hist_t *src);
+
+#ifdef __cplusplus
+}
+#endif
@@ -12,6 +12,9 @@
 #include <stdint.h>
 
 #include "esp_err.h"
+#include "can_logger_policy.h"
+#include "can_latency_hist.h"
+#include "mem_plan.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -27,11 +30,20 @@ typedef enum {
 // Statistics structure
 typedef struct {
     can_logger_state_t state;
-    uint32_t messages_logged;
-    uint32_t messages_dropped;
-    uint32_t buffer_overruns;
-    uint32_t write_errors;
-    uint32_t bytes_written;
+    uint64_t messages_logged;
+    uint64_t messages_dropped;
+    uint32_t messages_suppressed;  // Skipped by per-ID policies (not an error)
+    uint32_t policy_suppressed[CAN_LOG_POLICY_KIND_COUNT];
+    uint64_t buffer_overruns;
+    uint64_t write_errors;
+    uint64_t bytes_written;
+    uint32_t ring_capacity;            // Frames the ring buffer holds
+    uint32_t ring_depth;               // Frames queued now
+    uint32_t ring_high_water;          // Most frames queued since logging started
+    uint32_t stop_frames_drained;      // Records written after the last stop request
+    uint32_t stop_duration_ms;         // Duration of the last completed stop
+    can_latency_hist_t write_latency;  // Write buffer flushes to the card
+    can_latency_hist_t sync_latency;   // Log file syncs
     char current_file[64];
 } can_logger_stats_t;
 
@@ -42,10 +54,23 @@ typedef struct {
     uint8_t data[8];
 } can_logger_message_t;
 
+/**
+ * @brief Add the logger's buffers to the boot memory plan
+ *
+ * Covers the ring, its control block, the write buffer and the signal
+ * sink. Call before mem_plan_init() with the size later passed to
+ * can_logger_init().
+ *
+ * @param ring_buffer_bytes Size of the ring buffer in bytes
+ * @param budget Budget to add to
+ */
+void can_logger_plan_memory(size_t ring_buffer_bytes, mem_plan_budget_t *budget);
+
 /**
  * @brief Initialize the CAN logger
  *
- * Must be called after sd_card_init().
+ * Must be called after sd_card_init() and mem_plan_init(). Buffers are
+ * taken from the memory plan; a later init must use the same ring size.
  *
  * @param ring_buffer_bytes Size of the ring buffer in bytes
  * @return ESP_OK on success, error code otherwise
@@ -66,19 +91,52 @@ esp_err_t can_logger_deinit(void);
  *
  * Creates a new log file and starts the writer task.
  *
- * @return ESP_OK on success, error code otherwise
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the writer of the
+ *         previous file has not finished, error code otherwise
  */
 esp_err_t can_logger_start(void);
 
 /**
  * @brief Stop logging
  *
- * Flushes remaining buffer contents and closes the file.
+ * Closes CAN intake, then waits for the writer task to drain every frame
+ * already queued, sync and close the file. The wait is proportional to
+ * the queued data and bounded by a timeout; the number of drained frames
+ * and the stop duration are reported in the statistics.
  *
- * @return ESP_OK on success, error code otherwise
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if the writer is still
+ *         draining (the logger is then in CAN_LOGGER_ERROR and the next
+ *         start fails until the writer has finished)
  */
 esp_err_t can_logger_stop(void);
 
+/**
+ * @brief Trigger the power-fail emergency flush
+ *
+ * Closes CAN intake immediately and makes the writer task run the
+ * bounded-time emergency sequence: write the partially filled buffer,
+ * drain the ring within the hold-up budget, append a trailer record and
+ * f_sync. The file is closed afterwards and the logger returns to
+ * CAN_LOGGER_STOPPED.
+ *
+ * Safe to call from any task. The power-fail sense GPIO
+ * (CONFIG_CAN_LOGGER_POWERFAIL_GPIO) triggers the same path from its ISR.
+ */
+void can_logger_power_fail(void);
+
+/**
+ * @brief Wait for the writer task to close the log file
+ *
+ * Blocks until the writer has finished its stop or power-fail sequence and
+ * closed the file, or the timeout passes. can_logger_is_running() turns
+ * false before the close, so use this when the file must be complete (a
+ * shutdown handler ahead of esp_restart(), for example).
+ *
+ * @param timeout_ms Longest time to wait
+ * @return ESP_OK if no writer is left, ESP_ERR_TIMEOUT otherwise
+ */
+esp_err_t can_logger_wait_closed(uint32_t timeout_ms);
+
 /**
  * @brief Check if logging is active
  *
@@ -99,9 +157,55 @@ bool can_logger_is_running(void);
  */
 esp_err_t can_logger_log_message(int64_t timestamp_us, const can_logger_message_t *msg);
 
+/**
+ * @brief Log a meta record (see can_bin_format.h)
+ *
+ * Queued in order with CAN frames and not subject to ID policies.
+ * Callable from the same contexts as can_logger_log_message().
+ *
+ * @param timestamp_us Timestamp in microseconds
+ * @param meta_type CAN_BIN_META_* type
+ * @param payload Payload bytes
+ * @param len Payload length (<= 8)
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE when not logging,
+ *         ESP_ERR_NO_MEM if the buffer is full
+ */
+esp_err_t can_logger_log_meta(int64_t timestamp_us, uint32_t meta_type,
+                              const void *payload, uint8_t len);
+
+/**
+ * @brief Set the logging policy of one CAN ID
+ *
+ * Frames are checked against the ID's policy before they are queued, so
+ * suppressed frames cost neither ring space nor SD bandwidth. IDs without
+ * a policy, and extended IDs, are always logged. Policies persist across
+ * log files; each new file starts with a full frame of every ID.
+ *
+ * @param id Standard 11-bit CAN ID
+ * @param policy Policy to apply
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE while logging,
+ *         ESP_ERR_INVALID_ARG for an extended ID, ESP_ERR_NO_MEM if all
+ *         CAN_LOG_POLICY_MAX_RULES rule slots are in use
+ */
+esp_err_t can_logger_set_id_policy(uint32_t id, const can_log_policy_t *policy);
+
+/**
+ * @brief Get the per-ID counters of a policy
+ *
+ * @param id CAN ID
+ * @param logged Frames of this ID logged in the current file
+ * @param suppressed Frames of this ID suppressed in the current file
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the ID is always logged
+ */
+esp_err_t can_logger_get_id_policy_stats(uint32_t id, uint32_t *logged, uint32_t *suppressed);
+
 /**
  * @brief Get logging statistics
  *
+ * Counters are per-core 32-bit atomics folded into 64-bit totals under a
+ * short reader-side critical section, so the snapshot is not taken at a
+ * single instant; the RX path only does native 32-bit atomic adds.
+ *
  * @param stats Pointer to statistics structure to fill
  * @return ESP_OK on success, error code otherwise
  */
@@ -109,6 +213,10 @@ esp_err_t can_logger_get_stats(can_logger_stats_t *stats);
 
 /**
  * @brief Reset statistics counters
+ *
+ * Also clears the latency histograms, rebases the ring depth on the items
+ * actually queued and restarts the high-water mark from it. Called when
+ * logging starts; a reset while running may miss in-flight updates.
  */
 void can_logger_reset_stats(void);
 
@@ -0,0 +1,121 @@
+/*
+ * CAN Logger Per-ID Policy Table
+ *
+ * Decides, before a frame is queued, whether it is written to the raw log.
+ * High-rate broadcast IDs repeat mostly unchanged payloads, so logging
+ * them only when they change (with a periodic keyframe) or at a reduced
+ * rate cuts SD write volume several times over.
+ *
+ * Lookup is O(1): every 11-bit ID has a byte in a direct-indexed table
+ * that is either 0 (always log) or the index of a rule slot holding the
+ * policy and its state. Extended (29-bit) IDs are always logged.
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_LOG_POLICY_TABLE_SIZE 2048  // Standard 11-bit IDs
+#define CAN_LOG_POLICY_MAX_RULES 64     // IDs with a policy other than ALWAYS
+
+typedef enum {
+    CAN_LOG_POLICY_ALWAYS = 0,   // Log every frame
+    CAN_LOG_POLICY_EVERY_N,      // Log the first of every N frames
+    CAN_LOG_POLICY_ON_CHANGE,    // Log when DLC or payload differs from the last logged frame
+    CAN_LOG_POLICY_RATE_LIMIT,   // Log changed frames at most every min_interval_us
+    CAN_LOG_POLICY_KIND_COUNT
+} can_log_policy_kind_t;
+
+typedef struct {
+    can_log_policy_kind_t kind;
+    uint16_t every_n;          // EVERY_N: divisor (0 or 1 logs every frame)
+    uint32_t min_interval_us;  // RATE_LIMIT: minimum spacing of logged frames
+    uint32_t keyframe_us;      // ON_CHANGE, RATE_LIMIT: log an unchanged frame after
+                               // this long without one (0 = never)
+} can_log_policy_t;
+
+// Policy and state of one ID
+typedef struct {
+    can_log_policy_t policy;
+    uint32_t logged;
+    uint32_t suppressed;
+    uint16_t countdown;
+    bool has_last;
+    uint8_t last_dlc;
+    uint8_t last_data[8];
+    int64_t last_logged_us;
+} can_log_policy_slot_t;
+
+typedef struct {
+    uint8_t index[CAN_LOG_POLICY_TABLE_SIZE];  // 0 = ALWAYS, otherwise slot + 1
+    uint16_t slot_count;
+    can_log_policy_slot_t slots[CAN_LOG_POLICY_MAX_RULES];
+    uint32_t suppressed[CAN_LOG_POLICY_KIND_COUNT];  // Totals per policy kind
+} can_log_policy_table_t;
+
+/**
+ * @brief Clear the table (every ID logs always)
+ *
+ * @param table Table to initialize
+ */
+void can_log_policy_init(can_log_policy_table_t *table);
+
+/**
+ * @brief Set the policy of one ID
+ *
+ * Replaces any previous policy of the ID and clears its state.
+ *
+ * @param table Policy table
+ * @param id Standard CAN ID (< CAN_LOG_POLICY_TABLE_SIZE)
+ * @param policy Policy to apply
+ * @return false if the ID is out of range or all rule slots are in use
+ */
+bool can_log_policy_set(can_log_policy_table_t *table, uint32_t id,
+                        const can_log_policy_t *policy);
+
+/**
+ * @brief Look up the policy of one ID
+ *
+ * @param table Policy table
+ * @param id CAN ID
+ * @return Rule slot, or NULL if the ID is always logged
+ */
+const can_log_policy_slot_t *can_log_policy_get(const can_log_policy_table_t *table,
+                                                uint32_t id);
+
+/**
+ * @brief Decide whether a frame is logged
+ *
+ * Updates the ID's state and the suppression counters.
+ *
+ * @param table Policy table
+ * @param id CAN ID
+ * @param dlc Data length code
+ * @param data Payload (8 bytes)
+ * @param timestamp_us Frame receive time
+ * @return true if the frame should be logged
+ */
+bool can_log_policy_check(can_log_policy_table_t *table, uint32_t id, uint8_t dlc,
+                          const uint8_t *data, int64_t timestamp_us);
+
+/**
+ * @brief Forget per-ID state and counters, keeping the policies
+ *
+ * Called when a new log file starts so each file begins with a full
+ * frame of every ID.
+ *
+ * @param table Policy table
+ */
+void can_log_policy_reset_state(can_log_policy_table_t *table);
+
+#ifdef __cplusplus
+}
+#endif
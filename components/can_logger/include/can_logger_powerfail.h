@@ -0,0 +1,109 @@
+/*
+ * CAN Logger Power-Fail Sequencer
+ *
+ * Bounded-time emergency flush run when supply loss is detected. Writes
+ * the partially filled write buffer, drains as much of the ring buffer as
+ * the hold-up window allows, then appends a trailer record and syncs.
+ *
+ * All I/O goes through callbacks, so the sequence has no hardware
+ * dependencies and can be exercised on the host against an emulated SD
+ * backend.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_bin_format.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Why the log file was closed (stored in the trailer)
+typedef enum {
+    CAN_LOGGER_STOP_NORMAL = 0,
+    CAN_LOGGER_STOP_POWER_FAIL_GPIO,
+    CAN_LOGGER_STOP_POWER_FAIL_REQUEST
+} can_logger_stop_reason_t;
+
+// I/O callbacks used by the sequencer
+typedef struct {
+    void *ctx;
+    int64_t (*now_us)(void *ctx);
+    // Returns bytes written, or -1 on error
+    int (*write)(void *ctx, const void *data, size_t len);
+    // Commits written data to media (f_sync); returns true on success
+    bool (*sync)(void *ctx);
+    // Pops the next queued record; returns false when the queue is empty
+    bool (*next_record)(void *ctx, can_bin_record_v1_t *out);
+    // Optional: records still queued, used to report abandoned records
+    size_t (*backlog)(void *ctx);
+} can_logger_pf_io_t;
+
+// Time budget, all relative to the moment supply loss was detected
+typedef struct {
+    uint32_t holdup_us;        // Total hold-up window
+    uint32_t sync_reserve_us;  // Worst-case duration of one sync
+    uint32_t record_cost_us;   // Worst-case cost of writing one drained batch
+} can_logger_pf_budget_t;
+
+// Outcome of one emergency sequence
+typedef struct {
+    uint8_t stages;              // CAN_BIN_TRAILER_STAGE_* bits reached
+    bool trailer_written;
+    bool synced;
+    bool deadline_missed;        // Final sync finished after the hold-up window
+    uint32_t records_drained;    // CAN frames only; drained meta records are not counted
+    uint32_t records_abandoned;
+    int64_t elapsed_us;
+} can_logger_pf_result_t;
+
+/**
+ * @brief Run the emergency flush sequence
+ *
+ * Stages:
+ *   1. Write the pending (partially filled) write buffer
+ *   2. Sync, so the pending data survives even if the drain is cut short
+ *      (skipped if less than two sync reserves remain)
+ *   3. Drain queued records in batches until the queue is empty or the
+ *      drain deadline (hold-up minus two sync reserves and one batch) is
+ *      reached
+ *   4. Append the trailer record and sync again
+ *
+ * Stages 1 and 4 are always attempted, even past the deadline, since
+ * there is nothing better to do with the remaining energy.
+ *
+ * @param io I/O callbacks
+ * @param budget Time budget
+ * @param detect_us Timestamp (io->now_us clock) when supply loss was detected
+ * @param pending Partially filled write buffer (may be NULL)
+ * @param pending_len Bytes in pending
+ * @param records_logged CAN frames already in the file or pending buffer
+ * @param reason Stop reason stored in the trailer
+ * @param result Filled with the outcome
+ */
+void can_logger_pf_run(const can_logger_pf_io_t *io,
+                       const can_logger_pf_budget_t *budget,
+                       int64_t detect_us,
+                       const void *pending, size_t pending_len,
+                       uint32_t records_logged,
+                       can_logger_stop_reason_t reason,
+                       can_logger_pf_result_t *result);
+
+/**
+ * @brief Build a trailer meta record
+ *
+ * @param timestamp_us Monotonic timestamp of the trailer
+ * @param trailer Trailer payload
+ * @param out Record to fill
+ */
+void can_logger_pf_build_trailer(uint64_t timestamp_us,
+                                 const can_bin_trailer_v1_t *trailer,
+                                 can_bin_record_v1_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,142 @@
+/*
+ * CAN Logger Decoded-Signal Sink
+ *
+ * Second log sink next to the raw CANBIN file. Decoded values are pushed
+ * per signal, filtered by each signal's rate policy, and written to a
+ * CANSIG file (same name as the raw log, .sig extension) as delta-encoded
+ * per-signal chunks.
+ *
+ * The sink has its own ring buffer, write buffer and a writer task below
+ * the raw writer's priority, so a burst of decoded samples can never take
+ * ring space or SD bandwidth from raw frames. Samples that do not fit are
+ * dropped and counted.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "mem_plan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_LOGGER_MAX_SIGNALS 48
+
+// One logged signal
+typedef struct {
+    const char *name;          // Short name stored in the file (max 23 chars)
+    const char *unit;          // Unit stored in the file (max 11 chars)
+    float scale;               // Stored resolution (e.g., 0.1 for tenths)
+    uint32_t min_interval_ms;  // Never log more often than this
+    uint32_t max_interval_ms;  // Log unchanged values at least this often (0 = only on change)
+    float deadband;            // Smaller changes than this count as unchanged
+} can_logger_signal_def_t;
+
+// Signal sink statistics
+typedef struct {
+    bool active;
+    uint32_t samples_logged;
+    uint32_t samples_suppressed;  // Rejected by the rate policy
+    uint32_t samples_dropped;     // Sink ring buffer full
+    uint32_t chunks_written;
+    uint32_t write_errors;
+    uint32_t bytes_written;
+    char current_file[64];
+} can_logger_signal_stats_t;
+
+/**
+ * @brief Register the signals logged by the signal sink
+ *
+ * Must be called once, before can_logger_start(). Signal IDs are the
+ * indices into defs. The definitions are copied.
+ *
+ * @param defs Signal definitions
+ * @param count Number of signals (max CAN_LOGGER_MAX_SIGNALS)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t can_logger_signals_register(const can_logger_signal_def_t *defs, size_t count);
+
+/**
+ * @brief Log one decoded sample
+ *
+ * Applies the signal's rate policy and queues the sample without
+ * blocking. Call from a single task.
+ *
+ * @param signal_id Index of the signal in the registered table
+ * @param timestamp_us Monotonic time of the sample (esp_timer)
+ * @param value Physical value
+ * @return ESP_OK if queued or suppressed by the rate policy,
+ *         ESP_ERR_NO_MEM if the sink buffer is full,
+ *         ESP_ERR_INVALID_STATE if the sink is not running
+ */
+esp_err_t can_logger_signal_log(uint16_t signal_id, int64_t timestamp_us, float value);
+
+/**
+ * @brief Get signal sink statistics
+ *
+ * @param stats Pointer to statistics structure to fill
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t can_logger_signals_get_stats(can_logger_signal_stats_t *stats);
+
+/**
+ * @brief Add the sink's buffers to the boot memory plan
+ *
+ * Called by can_logger_plan_memory(); sized for CAN_LOGGER_MAX_SIGNALS.
+ *
+ * @param budget Budget to add to
+ */
+void can_logger_signals_plan_memory(mem_plan_budget_t *budget);
+
+/**
+ * @brief Open the signal file and start the sink writer
+ *
+ * Called by can_logger_start() once the raw file exists. Does nothing if
+ * no signals are registered.
+ *
+ * @param raw_path Path of the raw log file the signal file accompanies
+ * @param log_start_unix_us Wall-clock start time from the raw header
+ * @param log_start_monotonic_us Monotonic start time from the raw header
+ * @param header_flags CANBIN header flags (the timebase flag is carried over)
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t can_logger_signals_start(const char *raw_path, uint64_t log_start_unix_us,
+                                   uint64_t log_start_monotonic_us, uint32_t header_flags);
+
+/**
+ * @brief Flush all partial chunks, close the signal file and stop the writer
+ *
+ * Called by can_logger_stop(). On timeout the writer keeps the file and
+ * its task handle; a later stop or start collects it once it finishes.
+ *
+ * @return ESP_OK when the writer finished, ESP_ERR_TIMEOUT otherwise
+ */
+esp_err_t can_logger_signals_stop(void);
+
+/**
+ * @brief Stop accepting samples and abandon the signal file
+ *
+ * Called from the power-fail trigger (ISR safe) so the raw sink has the
+ * SD card to itself during the hold-up window. Samples already synced
+ * stay on the card; the file is closed after
+ * can_logger_signals_card_released().
+ */
+void can_logger_signals_close_intake(void);
+
+/**
+ * @brief Tell the signal writer the raw log file is closed
+ *
+ * After a power-fail intake close the signal writer holds its file open
+ * rather than competing for the card; this lets it close the file.
+ * Called by the raw writer whenever it closes its file.
+ */
+void can_logger_signals_card_released(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,144 @@
+/*
+ * CANSIG Chunk Codec and Rate Policy
+ *
+ * Builds the per-signal chunks of the decoded-signal log one sample at a
+ * time, decodes them again, and decides which samples are worth keeping.
+ * Values are stored as integers in units of the signal's scale, so a
+ * slowly changing signal costs one or two bytes per sample.
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_sig_format.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Capacity of each varint column in one chunk
+#define CAN_SIG_CHUNK_COLUMN_BYTES 512
+
+// Largest chunk can_sig_chunk_emit() can produce
+#define CAN_SIG_CHUNK_MAX_BYTES (CAN_SIG_CHUNK_HEADER_SIZE + 2 * CAN_SIG_CHUNK_COLUMN_BYTES)
+
+// Chunk under construction for one signal
+typedef struct {
+    uint16_t signal_id;
+    uint16_t count;
+    int64_t first_ts_us;
+    int64_t last_ts_us;
+    int32_t first_value;
+    int32_t last_value;
+    uint16_t ts_len;
+    uint16_t value_len;
+    uint8_t ts_column[CAN_SIG_CHUNK_COLUMN_BYTES];
+    uint8_t value_column[CAN_SIG_CHUNK_COLUMN_BYTES];
+} can_sig_chunk_t;
+
+// Rate policy for one signal
+typedef struct {
+    uint32_t min_interval_us;  // Samples closer than this to the last kept one are dropped
+    uint32_t max_interval_us;  // Unchanged values are still kept this often (0 = only on change)
+    int32_t deadband;          // Changes of at most this many scale units count as unchanged
+} can_sig_rate_t;
+
+// Last kept sample of one signal
+typedef struct {
+    bool has_last;
+    int64_t last_ts_us;
+    int32_t last_value;
+} can_sig_rate_state_t;
+
+// Called once per decoded sample
+typedef void (*can_sig_sample_cb_t)(void *ctx, uint16_t signal_id,
+                                    int64_t timestamp_us, int32_t value);
+
+/**
+ * @brief Start an empty chunk
+ *
+ * @param chunk Chunk to reset
+ * @param signal_id Signal the chunk belongs to
+ */
+void can_sig_chunk_reset(can_sig_chunk_t *chunk, uint16_t signal_id);
+
+/**
+ * @brief Append one sample
+ *
+ * Timestamps must not go backwards; an earlier timestamp is stored as a
+ * zero delta. Appending to an empty chunk always succeeds.
+ *
+ * @param chunk Chunk to append to
+ * @param timestamp_us Monotonic sample time
+ * @param value Value in scale units
+ * @return false if the chunk is full; emit it and append again
+ */
+bool can_sig_chunk_append(can_sig_chunk_t *chunk, int64_t timestamp_us, int32_t value);
+
+/**
+ * @brief Encoded size of the chunk, including its header
+ *
+ * @param chunk Chunk to measure
+ * @return Size in bytes, or 0 if the chunk is empty
+ */
+size_t can_sig_chunk_size(const can_sig_chunk_t *chunk);
+
+/**
+ * @brief Serialize the chunk and start a new one for the same signal
+ *
+ * @param chunk Chunk to emit
+ * @param out Output buffer
+ * @param out_size Size of out
+ * @return Bytes written, or 0 if the chunk is empty or out is too small
+ *         (the chunk is left unchanged in that case)
+ */
+size_t can_sig_chunk_emit(can_sig_chunk_t *chunk, uint8_t *out, size_t out_size);
+
+/**
+ * @brief Decode one chunk
+ *
+ * @param data Chunk bytes, starting at the chunk header
+ * @param len Bytes available
+ * @param cb Called for every sample in order (may be NULL to just validate)
+ * @param ctx Passed to cb
+ * @return Bytes consumed, or 0 if the chunk is truncated or malformed
+ */
+size_t can_sig_chunk_decode(const uint8_t *data, size_t len,
+                            can_sig_sample_cb_t cb, void *ctx);
+
+/**
+ * @brief Convert a physical value to scale units
+ *
+ * Rounds to nearest and saturates to the int32 range. NaN maps to 0.
+ *
+ * @param value Physical value
+ * @param scale Size of one unit (must be > 0)
+ * @return Value in scale units
+ */
+int32_t can_sig_quantize(float value, float scale);
+
+/**
+ * @brief Decide whether a sample should be logged
+ *
+ * The first sample is always kept. Later samples are kept once
+ * min_interval_us has passed and the value moved by more than the
+ * deadband from the last kept value, or max_interval_us has passed.
+ * The state is updated when the sample is kept.
+ *
+ * @param rate Policy for the signal
+ * @param state Per-signal state
+ * @param timestamp_us Sample time
+ * @param value Value in scale units
+ * @return true if the sample should be logged
+ */
+bool can_sig_rate_accept(const can_sig_rate_t *rate, can_sig_rate_state_t *state,
+                         int64_t timestamp_us, int32_t value);
+
+#ifdef __cplusplus
+}
+#endif
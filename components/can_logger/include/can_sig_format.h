@@ -0,0 +1,80 @@
+/*
+ * CANSIG File Format
+ *
+ * On-disk layout of the decoded-signal log (see docs/BINARY_LOGGING.md).
+ * A fixed header and one descriptor per signal are followed by chunks.
+ * Each chunk holds consecutive samples of a single signal as two
+ * delta-encoded varint columns (timestamps, then values), so a reader can
+ * skip every signal it does not need by chunk header alone.
+ *
+ * No hardware dependencies - shared by the logger and host-side tests.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_SIG_MAGIC "CANSIG\0"
+#define CAN_SIG_VERSION 1
+#define CAN_SIG_HEADER_SIZE 64
+#define CAN_SIG_DESC_SIZE 48
+#define CAN_SIG_CHUNK_HEADER_SIZE 24
+#define CAN_SIG_CHUNK_MAGIC 0x4B43  // "CK" little-endian
+
+// Header flags (same meaning as the CANBIN header flags)
+#define CAN_SIG_HEADER_FLAG_TIMEBASE 0x01  // log_start_unix_us is RTC-disciplined (sub-second)
+
+typedef struct __attribute__((packed)) {
+    char magic[8];
+    uint16_t version;
+    uint16_t header_size;              // Fixed header only; descriptors follow
+    uint64_t log_start_unix_us;
+    uint64_t log_start_monotonic_us;
+    uint16_t signal_count;
+    uint16_t desc_size;
+    uint32_t flags;
+    uint8_t reserved[28];
+} can_sig_header_v1_t;
+
+// One per signal, in signal_id order
+typedef struct __attribute__((packed)) {
+    char name[24];     // NUL-padded
+    char unit[12];     // NUL-padded
+    float scale;       // Physical value = stored integer * scale
+    uint8_t reserved[8];
+} can_sig_desc_v1_t;
+
+// Followed by ts_bytes of uvarint timestamp deltas (count - 1 entries),
+// then value_bytes of zigzag-varint value deltas (count - 1 entries)
+typedef struct __attribute__((packed)) {
+    uint16_t magic;
+    uint16_t signal_id;
+    uint16_t count;
+    uint16_t ts_bytes;
+    uint16_t value_bytes;
+    uint16_t reserved;
+    int64_t first_timestamp_us;  // Monotonic, same clock as CANBIN records
+    int32_t first_value;
+} can_sig_chunk_header_v1_t;
+
+#ifdef __cplusplus
+static_assert(sizeof(can_sig_header_v1_t) == CAN_SIG_HEADER_SIZE, "Signal header size mismatch");
+static_assert(sizeof(can_sig_desc_v1_t) == CAN_SIG_DESC_SIZE, "Signal descriptor size mismatch");
+static_assert(sizeof(can_sig_chunk_header_v1_t) == CAN_SIG_CHUNK_HEADER_SIZE,
+              "Chunk header size mismatch");
+#else
+_Static_assert(sizeof(can_sig_header_v1_t) == CAN_SIG_HEADER_SIZE,
+               "Signal header size mismatch");
+_Static_assert(sizeof(can_sig_desc_v1_t) == CAN_SIG_DESC_SIZE,
+               "Signal descriptor size mismatch");
+_Static_assert(sizeof(can_sig_chunk_header_v1_t) == CAN_SIG_CHUNK_HEADER_SIZE,
+               "Chunk header size mismatch");
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Latency Histogram - Implementation
+ */
+
+#include "can_latency_hist.h"
+
+#include <string.h>
+
+#define FIRST_BUCKET_SHIFT 7  // Bucket 0 ends at 128 us
+
+void can_latency_hist_reset(can_latency_hist_t *hist)
+{
+    if (!hist) {
+        return;
+    }
+
+    memset(hist, 0, sizeof(*hist));
+}
+
+int can_latency_hist_bucket(uint32_t latency_us)
+{
+    int bucket = 0;
+    uint32_t edge = 1u << FIRST_BUCKET_SHIFT;
+    while (bucket < CAN_LATENCY_HIST_BUCKETS - 1 && latency_us >= edge) {
+        bucket++;
+        edge <<= 1;
+    }
+    return bucket;
+}
+
+uint32_t can_latency_hist_bucket_upper_us(int bucket)
+{
+    if (bucket < 0) {
+        return 0;
+    }
+    if (bucket >= CAN_LATENCY_HIST_BUCKETS - 1) {
+        return UINT32_MAX;
+    }
+    return 1u << (FIRST_BUCKET_SHIFT + bucket);
+}
+
+void can_latency_hist_record(can_latency_hist_t *hist, int64_t latency_us)
+{
+    if (!hist) {
+        return;
+    }
+
+    uint32_t us;
+    if (latency_us <= 0) {
+        us = 0;
+    } else if (latency_us > UINT32_MAX) {
+        us = UINT32_MAX;
+    } else {
+        us = (uint32_t)latency_us;
+    }
+
+    hist->buckets[can_latency_hist_bucket(us)]++;
+    hist->total_us += us;
+    if (us > hist->max_us) {
+        hist->max_us = us;
+    }
+    hist->count++;
+}
+
+uint32_t can_latency_hist_percentile(const can_latency_hist_t *hist, uint32_t percent)
+{
+    if (!hist || hist->count == 0) {
+        return 0;
+    }
+    if (percent > 100) {
+        percent = 100;
+    }
+
+    // Rank of the sample at the percentile, rounded up (1-based)
+    uint64_t rank = ((uint64_t)hist->count * percent + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < CAN_LATENCY_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = can_latency_hist_bucket_upper_us(i);
+            return upper < hist->max_us ? upper : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
+
+void can_latency_hist_merge(can_latency_hist_t *dst, const can_latency_hist_t *src)
+{
+    if (!dst || !src) {
+        return;
+    }
+
+    for (int i = 0; i < CAN_LATENCY_HIST_BUCKETS; i++) {
+        dst->buckets[i] += src->buckets[i];
+    }
+    dst->count += src->count;
+    dst->total_us += src->total_us;
+    if (src->max_us > dst->max_us) {
+        dst->max_us = src->max_us;
+    }
+}
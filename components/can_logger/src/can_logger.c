@@ -6,21 +6,30 @@
  * on SD card operations.
  */
 
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
-#include <time.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/ringbuf.h>
 #include <freertos/semphr.h>
 #include <freertos/task.h>
-#include <esp_heap_caps.h>
+#include <driver/gpio.h>
+#include <esp_attr.h>
 #include <esp_log.h>
 #include <esp_timer.h>
 
 #include "can_logger.h"
+#include "can_bin_format.h"
+#include "can_logger_powerfail.h"
+#include "can_logger_signals.h"
+#include "can_logger_policy.h"
+#include "can_latency_hist.h"
+#include "mem_plan.h"
 #include "sd_card.h"
 #include "rtc_pcf85063a.h"
+#include "timebase.h"
+#include "trace.h"
 
 static const char *TAG = "can_logger";
 
@@ -28,110 +37,175 @@ static const char *TAG = "can_logger";
 typedef struct {
     int64_t timestamp_us;
     can_logger_message_t msg;
+    uint8_t flags;  // CAN_BIN_RECORD_FLAG_*
 } ring_buffer_item_t;
 
-#define CAN_BIN_MAGIC "CANBIN\0"
-#define CAN_BIN_VERSION 1
-#define CAN_BIN_HEADER_SIZE 64
-#define CAN_BIN_RECORD_SIZE 24
-
-typedef struct __attribute__((packed)) {
-    char magic[8];
-    uint16_t version;
-    uint16_t header_size;
-    uint64_t log_start_unix_us;
-    uint64_t log_start_monotonic_us;
-    uint32_t record_size;
-    uint32_t flags;
-    uint8_t reserved[28];
-} can_bin_header_v1_t;
-
-typedef struct __attribute__((packed)) {
-    uint64_t timestamp_us;
-    uint32_t can_id;
-    uint8_t dlc;
-    uint8_t flags;
-    uint8_t data[8];
-    uint16_t reserved;
-} can_bin_record_v1_t;
-
-_Static_assert(sizeof(can_bin_header_v1_t) == CAN_BIN_HEADER_SIZE,
-               "Binary header size mismatch");
-_Static_assert(sizeof(can_bin_record_v1_t) == CAN_BIN_RECORD_SIZE,
-               "Binary record size mismatch");
-
 // Write buffer size (bytes) - tuned for binary records
 #define WRITE_BUFFER_SIZE 65536
 #define WRITER_TASK_STACK_SIZE 4096
 #define WRITER_TASK_PRIORITY 5  // Higher priority for keeping up with CAN traffic
 #define FLUSH_INTERVAL_MS 1000
+#define SYNC_RECORD_INTERVAL_MS 10000
+#define WRITER_STOP_TIMEOUT_MS 5000  // Drain of a full 4 MB ring plus the final sync
+
+// Power-fail emergency flush budget
+#define POWERFAIL_HOLDUP_US (CONFIG_CAN_LOGGER_POWERFAIL_HOLDUP_MS * 1000)
+#define POWERFAIL_SYNC_RESERVE_US (CONFIG_CAN_LOGGER_POWERFAIL_SYNC_RESERVE_MS * 1000)
+#define POWERFAIL_BATCH_COST_US (CONFIG_CAN_LOGGER_POWERFAIL_BATCH_COST_MS * 1000)
 
 // Module state
 static struct {
     bool initialized;
     can_logger_state_t state;
     RingbufHandle_t ring_buffer;
-    bool ring_buffer_caps_allocated;
+    // Arena blocks, kept across deinit and reused by the next init
+    uint8_t *ring_storage;
+    size_t ring_storage_size;
+    StaticRingbuffer_t *ring_struct;
     TaskHandle_t writer_task;
-    SemaphoreHandle_t stats_mutex;
+    SemaphoreHandle_t writer_done;   // Given by the writer after it closed the file
+    StaticSemaphore_t writer_done_buffer;
+    volatile bool stop_requested;
+    uint32_t stop_frames_drained;    // Records the writer consumed after stop_requested
+    uint32_t stop_duration_ms;
     void *log_file;
     char current_file[64];
-    can_logger_stats_t stats;
+    // Ring occupancy in records: queued_in is advanced atomically by every
+    // producer (RX task, supervisor, alerts via can_logger_log_meta),
+    // queued_out by the ring's consumer only (the writer task, or
+    // can_logger_start discarding leftovers before the writer exists)
+    uint32_t ring_capacity;
+    uint32_t queued_in;
+    uint32_t queued_out;
+    uint32_t ring_high_water;
+    // Written by the writer task only
+    can_latency_hist_t write_latency;
+    can_latency_hist_t sync_latency;
     uint64_t log_start_unix_us;
     uint64_t log_start_monotonic_us;
+    uint32_t header_flags;
+    int64_t last_sync_record_time;
     char *write_buffer;
     size_t write_buffer_size;
     size_t write_buffer_pos;
     int64_t last_flush_time;
+    // Power-fail handling (written from ISR context)
+    volatile bool intake_closed;
+    volatile bool power_fail_pending;
+    volatile int64_t power_fail_detect_us;
+    volatile can_logger_stop_reason_t power_fail_reason;
+    bool power_fail_gpio_installed;
 } s_logger = {
     .initialized = false,
     .state = CAN_LOGGER_STOPPED,
     .ring_buffer = NULL,
-    .ring_buffer_caps_allocated = false,
+    .ring_storage = NULL,
+    .ring_storage_size = 0,
+    .ring_struct = NULL,
     .writer_task = NULL,
-    .stats_mutex = NULL,
+    .writer_done = NULL,
+    .stop_requested = false,
     .log_file = NULL,
+    .header_flags = 0,
+    .last_sync_record_time = 0,
     .write_buffer = NULL,
     .write_buffer_size = 0,
     .write_buffer_pos = 0,
-    .last_flush_time = 0
+    .last_flush_time = 0,
+    .intake_closed = false,
+    .power_fail_pending = false,
+    .power_fail_detect_us = 0,
+    .power_fail_reason = CAN_LOGGER_STOP_NORMAL,
+    .power_fail_gpio_installed = false
 };
 
-static bool rtc_datetime_to_unix_us(const pcf_datetime_t *time, uint64_t *unix_us_out)
+static portMUX_TYPE s_power_fail_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Per-ID policies; checked by the RX task, changed only while stopped
+static can_log_policy_table_t s_policy;
+
+// Statistics counters. Each core increments its own row of 32-bit counters
+// with relaxed atomics, which are native (S32C1I) on Xtensa; 64-bit atomics
+// would go through libatomic's global lock. stat_fold() adds each row's
+// progress since the last fold into 64-bit totals; the writer folds on every
+// flush, far more often than any counter can wrap.
+typedef enum {
+    STAT_MESSAGES_LOGGED = 0,
+    STAT_MESSAGES_DROPPED,
+    STAT_BUFFER_OVERRUNS,
+    STAT_WRITE_ERRORS,
+    STAT_BYTES_WRITTEN,
+    STAT_COUNT
+} logger_stat_t;
+
+static uint32_t s_stats[portNUM_PROCESSORS][STAT_COUNT];
+// Fold state, touched by readers and the writer under s_stat_lock only
+static uint32_t s_stat_folded[portNUM_PROCESSORS][STAT_COUNT];
+static uint64_t s_stat_total[STAT_COUNT];
+static portMUX_TYPE s_stat_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static inline void stat_add(logger_stat_t stat, uint32_t delta)
 {
-    if (!time || !unix_us_out)
+    __atomic_fetch_add(&s_stats[xPortGetCoreID()][stat], delta, __ATOMIC_RELAXED);
+}
+
+static void stat_fold(void)
+{
+    portENTER_CRITICAL(&s_stat_lock);
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
     {
-        return false;
+        for (int stat = 0; stat < STAT_COUNT; stat++)
+        {
+            uint32_t now = __atomic_load_n(&s_stats[core][stat], __ATOMIC_RELAXED);
+            s_stat_total[stat] += (uint32_t)(now - s_stat_folded[core][stat]);
+            s_stat_folded[core][stat] = now;
+        }
     }
+    portEXIT_CRITICAL(&s_stat_lock);
+}
 
-    struct tm tm_time = {
-        .tm_year = time->year - 1900,
-        .tm_mon = time->month - 1,
-        .tm_mday = time->day,
-        .tm_hour = time->hour,
-        .tm_min = time->min,
-        .tm_sec = time->sec,
-        .tm_isdst = -1
-    };
+static uint64_t stat_read(logger_stat_t stat)
+{
+    stat_fold();
+    portENTER_CRITICAL(&s_stat_lock);
+    uint64_t total = s_stat_total[stat];
+    portEXIT_CRITICAL(&s_stat_lock);
+    return total;
+}
+
+static void return_ring_item(void *item)
+{
+    vRingbufferReturnItem(s_logger.ring_buffer, item);
+    __atomic_store_n(&s_logger.queued_out, s_logger.queued_out + 1, __ATOMIC_RELAXED);
+}
 
-    time_t epoch = mktime(&tm_time);
-    if (epoch < 0)
+static void update_high_water(uint32_t depth)
+{
+    uint32_t high = __atomic_load_n(&s_logger.ring_high_water, __ATOMIC_RELAXED);
+    while (depth > high &&
+           !__atomic_compare_exchange_n(&s_logger.ring_high_water, &high, depth, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
     {
-        return false;
     }
+}
 
-    *unix_us_out = ((uint64_t)epoch) * 1000000ULL;
-    return true;
+static int write_timed(const void *data, size_t len)
+{
+    TRACE_SD_WRITE_BEGIN(len);
+    int64_t start_us = esp_timer_get_time();
+    int written = sd_card_write(s_logger.log_file, data, len);
+    can_latency_hist_record(&s_logger.write_latency, esp_timer_get_time() - start_us);
+    TRACE_SD_WRITE_END(written);
+    return written;
 }
 
-static void update_stat_atomic(uint32_t *stat, int32_t delta)
+static void sync_timed(void)
 {
-    if (s_logger.stats_mutex)
-    {
-        xSemaphoreTake(s_logger.stats_mutex, portMAX_DELAY);
-        *stat += delta;
-        xSemaphoreGive(s_logger.stats_mutex);
-    }
+    TRACE_SD_SYNC_BEGIN();
+    int64_t start_us = esp_timer_get_time();
+    sd_card_flush(s_logger.log_file);
+    can_latency_hist_record(&s_logger.sync_latency, esp_timer_get_time() - start_us);
+    TRACE_SD_SYNC_END();
 }
 
 static esp_err_t flush_write_buffer(void)
@@ -141,20 +215,20 @@ static esp_err_t flush_write_buffer(void)
         return ESP_OK;
     }
 
-    int written = sd_card_write(s_logger.log_file, s_logger.write_buffer,
-                                 s_logger.write_buffer_pos);
+    TRACE_FLUSH_BEGIN(s_logger.write_buffer_pos);
+    int written = write_timed(s_logger.write_buffer, s_logger.write_buffer_pos);
+    TRACE_FLUSH_END(s_logger.write_buffer_pos);
 
     if (written < 0 || (size_t)written != s_logger.write_buffer_pos)
     {
-        update_stat_atomic(&s_logger.stats.write_errors, 1);
+        stat_add(STAT_WRITE_ERRORS, 1);
         ESP_LOGE(TAG, "Write error: expected %zu, wrote %d",
                  s_logger.write_buffer_pos, written);
         return ESP_FAIL;
     }
 
-    xSemaphoreTake(s_logger.stats_mutex, portMAX_DELAY);
-    s_logger.stats.bytes_written += written;
-    xSemaphoreGive(s_logger.stats_mutex);
+    stat_add(STAT_BYTES_WRITTEN, (uint32_t)written);
+    stat_fold();
 
     s_logger.write_buffer_pos = 0;
     s_logger.last_flush_time = esp_timer_get_time() / 1000;
@@ -180,15 +254,13 @@ static esp_err_t buffer_write(const void *data, size_t len)
                 return err;
             }
         }
-        int written = sd_card_write(s_logger.log_file, data, len);
+        int written = write_timed(data, len);
         if (written < 0 || (size_t)written != len)
         {
-            update_stat_atomic(&s_logger.stats.write_errors, 1);
+            stat_add(STAT_WRITE_ERRORS, 1);
             return ESP_FAIL;
         }
-        xSemaphoreTake(s_logger.stats_mutex, portMAX_DELAY);
-        s_logger.stats.bytes_written += written;
-        xSemaphoreGive(s_logger.stats_mutex);
+        stat_add(STAT_BYTES_WRITTEN, (uint32_t)written);
         return ESP_OK;
     }
 
@@ -218,14 +290,14 @@ static esp_err_t write_bin_header(void)
     header.log_start_unix_us = s_logger.log_start_unix_us;
     header.log_start_monotonic_us = s_logger.log_start_monotonic_us;
     header.record_size = CAN_BIN_RECORD_SIZE;
-    header.flags = 0;
+    header.flags = s_logger.header_flags;
 
     esp_err_t err = buffer_write(&header, sizeof(header));
     if (err != ESP_OK)
     {
         ESP_LOGE(TAG, "Failed to write header: %s (buffer_pos=%zu, buffer_size=%zu)",
                  esp_err_to_name(err), s_logger.write_buffer_pos, s_logger.write_buffer_size);
-        update_stat_atomic(&s_logger.stats.write_errors, 1);
+        stat_add(STAT_WRITE_ERRORS, 1);
         return err;
     }
 
@@ -238,53 +310,197 @@ static esp_err_t write_bin_record(const ring_buffer_item_t *item)
     record.timestamp_us = (uint64_t)item->timestamp_us;
     record.can_id = item->msg.identifier;
     record.dlc = item->msg.data_length_code;
-    record.flags = 0;
+    record.flags = item->flags;
     memcpy(record.data, item->msg.data, sizeof(record.data));
     record.reserved = 0;
 
     esp_err_t err = buffer_write(&record, sizeof(record));
-    if (err == ESP_OK)
+    if (err == ESP_OK && !(item->flags & CAN_BIN_RECORD_FLAG_META))
     {
-        update_stat_atomic(&s_logger.stats.messages_logged, 1);
+        stat_add(STAT_MESSAGES_LOGGED, 1);
     }
-    else
+    else if (err != ESP_OK)
     {
         ESP_LOGE(TAG, "Failed to write record: %s (can_id=0x%03lx)",
                  esp_err_to_name(err), (unsigned long)record.can_id);
-        update_stat_atomic(&s_logger.stats.write_errors, 1);
+        stat_add(STAT_WRITE_ERRORS, 1);
     }
 
     return err;
 }
 
+static void write_sync_record(void)
+{
+    int64_t now_us = esp_timer_get_time();
+    s_logger.last_sync_record_time = now_us / 1000;
+
+    timebase_status_t tb;
+    if (timebase_get_status(&tb) != ESP_OK || !tb.synced)
+    {
+        return;
+    }
+
+    can_bin_record_v1_t record = {0};
+    record.timestamp_us = (uint64_t)tb.mono_us;
+    record.can_id = CAN_BIN_META_SYNC;
+    record.dlc = sizeof(tb.unix_us);
+    record.flags = CAN_BIN_RECORD_FLAG_META;
+    memcpy(record.data, &tb.unix_us, sizeof(tb.unix_us));
+    record.reserved = tb.uncertainty_us > UINT16_MAX ? UINT16_MAX : (uint16_t)tb.uncertainty_us;
+
+    if (buffer_write(&record, sizeof(record)) != ESP_OK)
+    {
+        stat_add(STAT_WRITE_ERRORS, 1);
+    }
+}
+
+static int64_t pf_now_us(void *ctx)
+{
+    (void)ctx;
+    return esp_timer_get_time();
+}
+
+static int pf_write(void *ctx, const void *data, size_t len)
+{
+    (void)ctx;
+    return sd_card_write(s_logger.log_file, data, len);
+}
+
+static bool pf_sync(void *ctx)
+{
+    (void)ctx;
+    return sd_card_sync(s_logger.log_file) == ESP_OK;
+}
+
+static bool pf_next_record(void *ctx, can_bin_record_v1_t *out)
+{
+    (void)ctx;
+    size_t item_size = 0;
+    ring_buffer_item_t *item = xRingbufferReceive(s_logger.ring_buffer, &item_size, 0);
+    if (!item)
+    {
+        return false;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->timestamp_us = (uint64_t)item->timestamp_us;
+    out->can_id = item->msg.identifier;
+    out->dlc = item->msg.data_length_code;
+    out->flags = item->flags;
+    memcpy(out->data, item->msg.data, sizeof(out->data));
+    return_ring_item(item);
+    return true;
+}
+
+static size_t pf_backlog(void *ctx)
+{
+    (void)ctx;
+    UBaseType_t waiting = 0;
+    vRingbufferGetInfo(s_logger.ring_buffer, NULL, NULL, NULL, NULL, &waiting);
+    return (size_t)waiting;
+}
+
+static void run_power_fail_sequence(void)
+{
+    const can_logger_pf_io_t io = {
+        .ctx = NULL,
+        .now_us = pf_now_us,
+        .write = pf_write,
+        .sync = pf_sync,
+        .next_record = pf_next_record,
+        .backlog = pf_backlog
+    };
+    const can_logger_pf_budget_t budget = {
+        .holdup_us = POWERFAIL_HOLDUP_US,
+        .sync_reserve_us = POWERFAIL_SYNC_RESERVE_US,
+        .record_cost_us = POWERFAIL_BATCH_COST_US
+    };
+
+    can_logger_pf_result_t result;
+    can_logger_pf_run(&io, &budget, s_logger.power_fail_detect_us,
+                      s_logger.write_buffer, s_logger.write_buffer_pos,
+                      (uint32_t)stat_read(STAT_MESSAGES_LOGGED),
+                      s_logger.power_fail_reason, &result);
+    s_logger.write_buffer_pos = 0;
+
+    stat_add(STAT_MESSAGES_LOGGED, result.records_drained);
+    stat_add(STAT_MESSAGES_DROPPED, result.records_abandoned);
+    if (!result.synced)
+    {
+        stat_add(STAT_WRITE_ERRORS, 1);
+    }
+
+    // Logging after the sync is safe; the data is already on the card
+    ESP_LOGW(TAG, "Power-fail flush: stages=0x%02x drained=%lu abandoned=%lu "
+             "synced=%d elapsed=%lldus%s",
+             result.stages, (unsigned long)result.records_drained,
+             (unsigned long)result.records_abandoned, result.synced,
+             (long long)result.elapsed_us,
+             result.deadline_missed ? " (DEADLINE MISSED)" : "");
+}
+
+// Every record consumed once a stop is requested counts toward the stop
+// drain, whether the main loop or the final drain wrote it
+static void write_ring_item(ring_buffer_item_t *item)
+{
+    write_bin_record(item);
+    return_ring_item(item);
+    if (s_logger.stop_requested)
+    {
+        s_logger.stop_frames_drained++;
+    }
+}
+
+static void drain_ring(void)
+{
+    size_t item_size = 0;
+    ring_buffer_item_t *item;
+    while (!s_logger.power_fail_pending &&
+           (item = xRingbufferReceive(s_logger.ring_buffer, &item_size, 0)) != NULL)
+    {
+        write_ring_item(item);
+    }
+}
+
+static void writer_finish(void)
+{
+    sd_card_close_log_file(s_logger.log_file);
+    s_logger.log_file = NULL;
+    can_logger_signals_card_released();
+    ESP_LOGI(TAG, "Writer task stopped");
+    xSemaphoreGive(s_logger.writer_done);
+    vTaskDelete(NULL);
+}
+
 static void writer_task(void *arg)
 {
+    (void)arg;
     ESP_LOGI(TAG, "Writer task started");
 
     if (write_bin_header() != ESP_OK)
     {
         ESP_LOGE(TAG, "Failed to write binary header, aborting logger");
+        s_logger.intake_closed = true;
         s_logger.state = CAN_LOGGER_ERROR;
         flush_write_buffer();
-        sd_card_flush(s_logger.log_file);
-        ESP_LOGI(TAG, "Writer task stopped");
-        vTaskDelete(NULL);
+        writer_finish();
         return;
     }
 
+    write_sync_record();
     flush_write_buffer();
 
-    while (s_logger.state == CAN_LOGGER_RUNNING)
+    while (!s_logger.stop_requested && !s_logger.power_fail_pending)
     {
         size_t item_size = 0;
         int messages_processed = 0;
 
         // Batch process: drain all available messages without waiting
         ring_buffer_item_t *item;
-        while ((item = xRingbufferReceive(s_logger.ring_buffer, &item_size, 0)) != NULL)
+        while (!s_logger.power_fail_pending &&
+               (item = xRingbufferReceive(s_logger.ring_buffer, &item_size, 0)) != NULL)
         {
-            write_bin_record(item);
-            vRingbufferReturnItem(s_logger.ring_buffer, item);
+            write_ring_item(item);
             messages_processed++;
 
             // Flush write buffer when nearly full (record size = 24 bytes)
@@ -300,35 +516,148 @@ static void writer_task(void *arg)
             item = xRingbufferReceive(s_logger.ring_buffer, &item_size, pdMS_TO_TICKS(20));
             if (item)
             {
-                write_bin_record(item);
-                vRingbufferReturnItem(s_logger.ring_buffer, item);
+                write_ring_item(item);
             }
         }
 
-        // Periodic flush to ensure data reaches SD card
+        // Periodic wall-clock sync points so readers can follow drift
         int64_t now_ms = esp_timer_get_time() / 1000;
+        if (now_ms - s_logger.last_sync_record_time > SYNC_RECORD_INTERVAL_MS)
+        {
+            write_sync_record();
+        }
+
+        // Periodic flush to ensure data reaches SD card
         if (now_ms - s_logger.last_flush_time > FLUSH_INTERVAL_MS)
         {
             flush_write_buffer();
-            sd_card_flush(s_logger.log_file);
+            sync_timed();
         }
     }
 
-    // Drain remaining items
-    size_t item_size = 0;
-    ring_buffer_item_t *item;
-    while ((item = xRingbufferReceive(s_logger.ring_buffer, &item_size, 0)) != NULL)
+    // Intake is closed on both paths, so the ring only shrinks from here.
+    // A power failure during a normal drain switches to the budgeted sequence.
+    if (!s_logger.power_fail_pending)
     {
-        write_bin_record(item);
-        vRingbufferReturnItem(s_logger.ring_buffer, item);
+        drain_ring();
     }
 
-    // Final flush
-    flush_write_buffer();
-    sd_card_flush(s_logger.log_file);
+    if (s_logger.power_fail_pending)
+    {
+        run_power_fail_sequence();
+        s_logger.power_fail_pending = false;
+        s_logger.state = CAN_LOGGER_STOPPED;
+    }
+    else
+    {
+        flush_write_buffer();
+        sync_timed();
+    }
 
-    ESP_LOGI(TAG, "Writer task stopped");
-    vTaskDelete(NULL);
+    writer_finish();
+}
+
+static void IRAM_ATTR power_fail_trigger(can_logger_stop_reason_t reason)
+{
+    portENTER_CRITICAL_SAFE(&s_power_fail_lock);
+    if (s_logger.state == CAN_LOGGER_RUNNING && !s_logger.power_fail_pending)
+    {
+        // Close intake first so the ring stops growing while we flush
+        s_logger.intake_closed = true;
+        can_logger_signals_close_intake();
+        s_logger.power_fail_detect_us = esp_timer_get_time();
+        s_logger.power_fail_reason = reason;
+        s_logger.power_fail_pending = true;
+    }
+    portEXIT_CRITICAL_SAFE(&s_power_fail_lock);
+}
+
+static void IRAM_ATTR power_fail_gpio_isr(void *arg)
+{
+    (void)arg;
+    power_fail_trigger(CAN_LOGGER_STOP_POWER_FAIL_GPIO);
+}
+
+static void power_fail_gpio_init(void)
+{
+#if CONFIG_CAN_LOGGER_POWERFAIL_GPIO >= 0
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << CONFIG_CAN_LOGGER_POWERFAIL_GPIO,
+        .mode = GPIO_MODE_INPUT,
+#if CONFIG_CAN_LOGGER_POWERFAIL_ACTIVE_LOW
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_NEGEDGE,
+#else
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,
+        .intr_type = GPIO_INTR_POSEDGE,
+#endif
+    };
+
+    esp_err_t err = gpio_config(&io_conf);
+    if (err == ESP_OK)
+    {
+        err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+        if (err == ESP_ERR_INVALID_STATE)
+        {
+            err = ESP_OK;  // Already installed by another component
+        }
+    }
+    if (err == ESP_OK)
+    {
+        err = gpio_isr_handler_add(CONFIG_CAN_LOGGER_POWERFAIL_GPIO, power_fail_gpio_isr, NULL);
+    }
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Power-fail GPIO %d setup failed: %s",
+                 CONFIG_CAN_LOGGER_POWERFAIL_GPIO, esp_err_to_name(err));
+        return;
+    }
+
+    s_logger.power_fail_gpio_installed = true;
+    ESP_LOGI(TAG, "Power-fail sense on GPIO %d (hold-up %d ms)",
+             CONFIG_CAN_LOGGER_POWERFAIL_GPIO, CONFIG_CAN_LOGGER_POWERFAIL_HOLDUP_MS);
+#endif
+}
+
+static void power_fail_gpio_deinit(void)
+{
+#if CONFIG_CAN_LOGGER_POWERFAIL_GPIO >= 0
+    if (s_logger.power_fail_gpio_installed)
+    {
+        gpio_isr_handler_remove(CONFIG_CAN_LOGGER_POWERFAIL_GPIO);
+        s_logger.power_fail_gpio_installed = false;
+    }
+#endif
+}
+
+// Collect a finished writer: after a normal stop, a power-fail flush, a
+// header error, or a stop that timed out while the writer kept draining
+static bool writer_reap(TickType_t wait)
+{
+    if (!s_logger.writer_task)
+    {
+        return true;
+    }
+
+    if (xSemaphoreTake(s_logger.writer_done, wait) != pdTRUE)
+    {
+        return false;
+    }
+
+    s_logger.writer_task = NULL;
+    return true;
+}
+
+void can_logger_plan_memory(size_t ring_buffer_bytes, mem_plan_budget_t *budget)
+{
+    size_t buffer_bytes = (ring_buffer_bytes + 3) & ~((size_t)3);
+    mem_plan_budget_add(budget, MEM_REGION_PSRAM, buffer_bytes, 4);
+    mem_plan_budget_add(budget, MEM_REGION_INTERNAL, sizeof(StaticRingbuffer_t), 4);
+    mem_plan_budget_add(budget, MEM_REGION_PSRAM, WRITE_BUFFER_SIZE, 4);
+    can_logger_signals_plan_memory(budget);
 }
 
 esp_err_t can_logger_init(size_t ring_buffer_bytes)
@@ -345,68 +674,62 @@ esp_err_t can_logger_init(size_t ring_buffer_bytes)
         return ESP_ERR_INVALID_STATE;
     }
 
-    // Create stats mutex
-    s_logger.stats_mutex = xSemaphoreCreateMutex();
-    if (!s_logger.stats_mutex)
-    {
-        ESP_LOGE(TAG, "Failed to create stats mutex");
-        return ESP_ERR_NO_MEM;
-    }
-
     if (ring_buffer_bytes == 0)
     {
         ESP_LOGE(TAG, "Ring buffer size must be > 0");
-        vSemaphoreDelete(s_logger.stats_mutex);
-        s_logger.stats_mutex = NULL;
         return ESP_ERR_INVALID_ARG;
     }
 
+    // Buffers come from the boot-time plan (see can_logger_plan_memory)
     size_t buffer_bytes = (ring_buffer_bytes + 3) & ~((size_t)3);
-    s_logger.ring_buffer = xRingbufferCreateWithCaps(
-        buffer_bytes,
-        RINGBUF_TYPE_NOSPLIT,
-        MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT
-    );
-    if (s_logger.ring_buffer)
+    if (s_logger.ring_storage && s_logger.ring_storage_size != buffer_bytes)
     {
-        s_logger.ring_buffer_caps_allocated = true;
+        ESP_LOGE(TAG, "Ring buffer is fixed at %zu bytes", s_logger.ring_storage_size);
+        return ESP_ERR_INVALID_SIZE;
     }
-    else
+    if (!s_logger.ring_storage)
     {
-        s_logger.ring_buffer = xRingbufferCreate(buffer_bytes, RINGBUF_TYPE_NOSPLIT);
-        s_logger.ring_buffer_caps_allocated = false;
+        s_logger.ring_storage = mem_plan_alloc(MEM_REGION_PSRAM, buffer_bytes, 4,
+                                               "can_logger ring");
+        s_logger.ring_storage_size = s_logger.ring_storage ? buffer_bytes : 0;
     }
-
-    if (!s_logger.ring_buffer)
+    if (!s_logger.ring_struct)
     {
-        ESP_LOGE(TAG, "Failed to create ring buffer (%zu bytes)", buffer_bytes);
-        vSemaphoreDelete(s_logger.stats_mutex);
-        s_logger.stats_mutex = NULL;
+        s_logger.ring_struct = mem_plan_alloc(MEM_REGION_INTERNAL, sizeof(StaticRingbuffer_t), 4,
+                                              "can_logger ring ctl");
+    }
+    if (!s_logger.write_buffer)
+    {
+        s_logger.write_buffer = mem_plan_alloc(MEM_REGION_PSRAM, WRITE_BUFFER_SIZE, 4,
+                                               "can_logger write buffer");
+        s_logger.write_buffer_size = s_logger.write_buffer ? WRITE_BUFFER_SIZE : 0;
+    }
+    if (!s_logger.ring_storage || !s_logger.ring_struct || !s_logger.write_buffer)
+    {
+        ESP_LOGE(TAG, "Logger buffers missing from the memory plan");
         return ESP_ERR_NO_MEM;
     }
 
-    s_logger.write_buffer_size = WRITE_BUFFER_SIZE;
-    s_logger.write_buffer = heap_caps_malloc(s_logger.write_buffer_size,
-                                             MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (!s_logger.write_buffer) {
-        s_logger.write_buffer = heap_caps_malloc(s_logger.write_buffer_size, MALLOC_CAP_8BIT);
-    }
-    if (!s_logger.write_buffer) {
-        ESP_LOGE(TAG, "Failed to allocate write buffer");
-        vRingbufferDelete(s_logger.ring_buffer);
-        s_logger.ring_buffer = NULL;
-        vSemaphoreDelete(s_logger.stats_mutex);
-        s_logger.stats_mutex = NULL;
+    s_logger.ring_buffer = xRingbufferCreateStatic(buffer_bytes, RINGBUF_TYPE_NOSPLIT,
+                                                   s_logger.ring_storage, s_logger.ring_struct);
+    s_logger.writer_done = xSemaphoreCreateBinaryStatic(&s_logger.writer_done_buffer);
+    if (!s_logger.ring_buffer || !s_logger.writer_done)
+    {
+        ESP_LOGE(TAG, "Failed to create ring buffer (%zu bytes)", buffer_bytes);
         return ESP_ERR_NO_MEM;
     }
 
-    memset(&s_logger.stats, 0, sizeof(s_logger.stats));
+    can_logger_reset_stats();
+    can_log_policy_init(&s_policy);
     s_logger.initialized = true;
     s_logger.state = CAN_LOGGER_STOPPED;
 
+    power_fail_gpio_init();
+
     size_t item_bytes = sizeof(ring_buffer_item_t);
     size_t item_stride = ((item_bytes + 3) & ~((size_t)3)) + 8;
     size_t approx_items = item_stride ? (buffer_bytes / item_stride) : 0;
+    s_logger.ring_capacity = (uint32_t)approx_items;
     ESP_LOGI(TAG, "Initialized ring buffer: %zu bytes (~%zu msgs)",
              buffer_bytes, approx_items);
     return ESP_OK;
@@ -425,33 +748,26 @@ esp_err_t can_logger_deinit(void)
         can_logger_stop();
     }
 
-    if (s_logger.ring_buffer)
+    // The ring and buffers stay allocated while a writer is still draining
+    if (!writer_reap(0))
     {
-        if (s_logger.ring_buffer_caps_allocated)
-        {
-            vRingbufferDeleteWithCaps(s_logger.ring_buffer);
-        }
-        else
-        {
-            vRingbufferDelete(s_logger.ring_buffer);
-        }
-        s_logger.ring_buffer = NULL;
-        s_logger.ring_buffer_caps_allocated = false;
+        ESP_LOGE(TAG, "Writer task still running, cannot deinitialize");
+        return ESP_ERR_INVALID_STATE;
     }
 
-    if (s_logger.write_buffer)
-    {
-        heap_caps_free(s_logger.write_buffer);
-        s_logger.write_buffer = NULL;
-        s_logger.write_buffer_size = 0;
-    }
+    power_fail_gpio_deinit();
 
-    if (s_logger.stats_mutex)
+    // Static ring and semaphore: deleting only releases the handles, the
+    // arena blocks stay for the next init
+    if (s_logger.ring_buffer)
     {
-        vSemaphoreDelete(s_logger.stats_mutex);
-        s_logger.stats_mutex = NULL;
+        vRingbufferDelete(s_logger.ring_buffer);
+        s_logger.ring_buffer = NULL;
     }
 
+    vSemaphoreDelete(s_logger.writer_done);
+    s_logger.writer_done = NULL;
+
     s_logger.initialized = false;
     ESP_LOGI(TAG, "Deinitialized");
     return ESP_OK;
@@ -471,6 +787,12 @@ esp_err_t can_logger_start(void)
         return ESP_OK;
     }
 
+    if (!writer_reap(0))
+    {
+        ESP_LOGE(TAG, "Previous writer task still draining");
+        return ESP_ERR_INVALID_STATE;
+    }
+
     // Create new log file with RTC timestamp in name
     s_logger.log_file = sd_card_create_log_file_with_timestamp("CAN", "bin",
                                                                 s_logger.current_file,
@@ -482,23 +804,42 @@ esp_err_t can_logger_start(void)
         return ESP_FAIL;
     }
 
+    // Frames that raced the previous stop's intake close belong to no file
+    size_t stale_size = 0;
+    void *stale;
+    while ((stale = xRingbufferReceive(s_logger.ring_buffer, &stale_size, 0)) != NULL)
+    {
+        return_ring_item(stale);
+    }
+
     // Reset counters for new session
     can_logger_reset_stats();
-    strncpy(s_logger.stats.current_file, s_logger.current_file,
-            sizeof(s_logger.stats.current_file) - 1);
+    can_log_policy_reset_state(&s_policy);
 
     s_logger.write_buffer_pos = 0;
     s_logger.last_flush_time = esp_timer_get_time() / 1000;
+    s_logger.power_fail_pending = false;
+    s_logger.intake_closed = false;
+    s_logger.stop_requested = false;
+    s_logger.stop_frames_drained = 0;
 
     s_logger.log_start_unix_us = 0;
+    s_logger.header_flags = 0;
     s_logger.log_start_monotonic_us = (uint64_t)esp_timer_get_time();
+    int64_t unix_us = 0;
     pcf_datetime_t rtc_now;
-    if (pcf_rtc_is_time_valid() && pcf_rtc_get_time(&rtc_now) == ESP_OK)
+    if (timebase_mono_to_unix_us((int64_t)s_logger.log_start_monotonic_us, &unix_us))
+    {
+        s_logger.log_start_unix_us = (uint64_t)unix_us;
+        s_logger.header_flags |= CAN_BIN_HEADER_FLAG_TIMEBASE;
+    }
+    else if (pcf_rtc_is_time_valid() && pcf_rtc_get_time(&rtc_now) == ESP_OK)
     {
-        uint64_t unix_us = 0;
-        if (rtc_datetime_to_unix_us(&rtc_now, &unix_us))
+        // Timebase not locked yet: fall back to whole RTC seconds
+        int64_t unix_sec = 0;
+        if (pcf_rtc_datetime_to_unix(&rtc_now, &unix_sec))
         {
-            s_logger.log_start_unix_us = unix_us;
+            s_logger.log_start_unix_us = (uint64_t)unix_sec * 1000000ULL;
             s_logger.log_start_monotonic_us = (uint64_t)esp_timer_get_time();
         }
     }
@@ -512,55 +853,107 @@ esp_err_t can_logger_start(void)
     if (result != pdTRUE)
     {
         ESP_LOGE(TAG, "Failed to create writer task");
+        s_logger.writer_task = NULL;
         sd_card_close_log_file(s_logger.log_file);
         s_logger.log_file = NULL;
         s_logger.state = CAN_LOGGER_ERROR;
         return ESP_FAIL;
     }
 
+    // The signal sink is optional; raw logging runs without it
+    esp_err_t sig_err = can_logger_signals_start(s_logger.current_file,
+                                                 s_logger.log_start_unix_us,
+                                                 s_logger.log_start_monotonic_us,
+                                                 s_logger.header_flags);
+    if (sig_err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Signal sink not started: %s", esp_err_to_name(sig_err));
+    }
+
     ESP_LOGI(TAG, "Logging started: %s", s_logger.current_file);
     return ESP_OK;
 }
 
 esp_err_t can_logger_stop(void)
 {
-    if (s_logger.state != CAN_LOGGER_RUNNING)
+    if (s_logger.state != CAN_LOGGER_RUNNING || s_logger.stop_requested)
     {
         return ESP_OK;
     }
 
-    s_logger.state = CAN_LOGGER_STOPPED;
+    int64_t start_us = esp_timer_get_time();
 
-    // Wait for writer task to finish (it checks state)
-    if (s_logger.writer_task)
+    // Close intake first so the drain is bounded by what is already queued
+    s_logger.intake_closed = true;
+    s_logger.stop_requested = true;
+
+    if (can_logger_signals_stop() != ESP_OK)
     {
-        // Give task time to drain and exit
-        vTaskDelay(pdMS_TO_TICKS(500));
-        s_logger.writer_task = NULL;
+        ESP_LOGW(TAG, "Signal sink still closing; raw log stop continues");
     }
 
-    // Close file
-    if (s_logger.log_file)
+    // The writer drains the ring, syncs and closes the file, then signals
+    if (!writer_reap(pdMS_TO_TICKS(WRITER_STOP_TIMEOUT_MS)))
     {
-        sd_card_close_log_file(s_logger.log_file);
-        s_logger.log_file = NULL;
+        // Leave the file to the writer; the next start or deinit reaps it
+        ESP_LOGE(TAG, "Writer did not finish within %d ms", WRITER_STOP_TIMEOUT_MS);
+        s_logger.state = CAN_LOGGER_ERROR;
+        return ESP_ERR_TIMEOUT;
     }
 
-    ESP_LOGI(TAG, "Logging stopped. Messages: %lu, Bytes: %lu",
-             (unsigned long)s_logger.stats.messages_logged,
-             (unsigned long)s_logger.stats.bytes_written);
+    s_logger.stop_duration_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+    s_logger.state = CAN_LOGGER_STOPPED;
+
+    ESP_LOGI(TAG, "Logging stopped in %lu ms (drained %lu). Messages: %llu, Bytes: %llu",
+             (unsigned long)s_logger.stop_duration_ms,
+             (unsigned long)s_logger.stop_frames_drained,
+             (unsigned long long)stat_read(STAT_MESSAGES_LOGGED),
+             (unsigned long long)stat_read(STAT_BYTES_WRITTEN));
 
     return ESP_OK;
 }
 
+void can_logger_power_fail(void)
+{
+    power_fail_trigger(CAN_LOGGER_STOP_POWER_FAIL_REQUEST);
+}
+
+esp_err_t can_logger_wait_closed(uint32_t timeout_ms)
+{
+    return writer_reap(pdMS_TO_TICKS(timeout_ms)) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
 bool can_logger_is_running(void)
 {
     return s_logger.state == CAN_LOGGER_RUNNING;
 }
 
+// Queue one item for the writer (RX task, supervisor or alert context)
+static esp_err_t enqueue_item(const ring_buffer_item_t *item)
+{
+    BaseType_t result = xRingbufferSend(s_logger.ring_buffer, item,
+                                         sizeof(*item), 0);
+
+    if (result != pdTRUE)
+    {
+        stat_add(STAT_MESSAGES_DROPPED, 1);
+        stat_add(STAT_BUFFER_OVERRUNS, 1);
+        TRACE_LOG_DROP(item->msg.identifier);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t queued_in = __atomic_add_fetch(&s_logger.queued_in, 1, __ATOMIC_RELAXED);
+    uint32_t depth = queued_in - __atomic_load_n(&s_logger.queued_out, __ATOMIC_RELAXED);
+    TRACE_LOG_ENQUEUE(item->msg.identifier, depth);
+    update_high_water(depth);
+
+    return ESP_OK;
+}
+
 esp_err_t can_logger_log_message(int64_t timestamp_us, const can_logger_message_t *msg)
 {
-    if (!s_logger.initialized || s_logger.state != CAN_LOGGER_RUNNING)
+    if (!s_logger.initialized || s_logger.state != CAN_LOGGER_RUNNING ||
+        s_logger.intake_closed)
     {
         return ESP_ERR_INVALID_STATE;
     }
@@ -570,22 +963,50 @@ esp_err_t can_logger_log_message(int64_t timestamp_us, const can_logger_message_
         return ESP_ERR_INVALID_ARG;
     }
 
+    if (!can_log_policy_check(&s_policy, msg->identifier, msg->data_length_code,
+                              msg->data, timestamp_us))
+    {
+        return ESP_OK;
+    }
+
     ring_buffer_item_t item = {
         .timestamp_us = timestamp_us,
-        .msg = *msg
+        .msg = *msg,
+        .flags = 0
     };
 
-    BaseType_t result = xRingbufferSend(s_logger.ring_buffer, &item,
-                                         sizeof(item), 0);
+    return enqueue_item(&item);
+}
 
-    if (result != pdTRUE)
+esp_err_t can_logger_log_meta(int64_t timestamp_us, uint32_t meta_type,
+                              const void *payload, uint8_t len)
+{
+    if (!s_logger.initialized || s_logger.state != CAN_LOGGER_RUNNING ||
+        s_logger.intake_closed)
     {
-        update_stat_atomic(&s_logger.stats.messages_dropped, 1);
-        update_stat_atomic(&s_logger.stats.buffer_overruns, 1);
-        return ESP_ERR_NO_MEM;
+        return ESP_ERR_INVALID_STATE;
     }
 
-    return ESP_OK;
+    if (len > sizeof(((can_logger_message_t *)0)->data) || (len > 0 && !payload))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ring_buffer_item_t item = {
+        .timestamp_us = timestamp_us,
+        .msg = {
+            .identifier = meta_type,
+            .data_length_code = len,
+            .data = {0}
+        },
+        .flags = CAN_BIN_RECORD_FLAG_META
+    };
+    if (len > 0)
+    {
+        memcpy(item.msg.data, payload, len);
+    }
+
+    return enqueue_item(&item);
 }
 
 esp_err_t can_logger_get_stats(can_logger_stats_t *stats)
@@ -595,26 +1016,111 @@ esp_err_t can_logger_get_stats(can_logger_stats_t *stats)
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (!s_logger.initialized || !s_logger.stats_mutex)
+    if (!s_logger.initialized)
     {
         return ESP_ERR_INVALID_STATE;
     }
 
-    xSemaphoreTake(s_logger.stats_mutex, portMAX_DELAY);
-    memcpy(stats, &s_logger.stats, sizeof(*stats));
+    memset(stats, 0, sizeof(*stats));
     stats->state = s_logger.state;
-    xSemaphoreGive(s_logger.stats_mutex);
+    stats->messages_logged = stat_read(STAT_MESSAGES_LOGGED);
+    stats->messages_dropped = stat_read(STAT_MESSAGES_DROPPED);
+    stats->buffer_overruns = stat_read(STAT_BUFFER_OVERRUNS);
+    stats->write_errors = stat_read(STAT_WRITE_ERRORS);
+    stats->bytes_written = stat_read(STAT_BYTES_WRITTEN);
+
+    uint32_t queued_out = __atomic_load_n(&s_logger.queued_out, __ATOMIC_RELAXED);
+    uint32_t queued_in = __atomic_load_n(&s_logger.queued_in, __ATOMIC_RELAXED);
+    int32_t depth = (int32_t)(queued_in - queued_out);
+    stats->ring_capacity = s_logger.ring_capacity;
+    stats->ring_depth = depth > 0 ? (uint32_t)depth : 0;
+    stats->ring_high_water = __atomic_load_n(&s_logger.ring_high_water, __ATOMIC_RELAXED);
+    stats->stop_frames_drained = s_logger.stop_frames_drained;
+    stats->stop_duration_ms = s_logger.stop_duration_ms;
+    stats->write_latency = s_logger.write_latency;
+    stats->sync_latency = s_logger.sync_latency;
+    strncpy(stats->current_file, s_logger.current_file, sizeof(stats->current_file) - 1);
+
+    // Policy counters are written only by the RX task
+    stats->messages_suppressed = 0;
+    for (int kind = 0; kind < CAN_LOG_POLICY_KIND_COUNT; kind++)
+    {
+        stats->policy_suppressed[kind] = s_policy.suppressed[kind];
+        stats->messages_suppressed += s_policy.suppressed[kind];
+    }
 
     return ESP_OK;
 }
 
+esp_err_t can_logger_set_id_policy(uint32_t id, const can_log_policy_t *policy)
+{
+    if (!policy)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_logger.initialized || s_logger.state == CAN_LOGGER_RUNNING)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (id >= CAN_LOG_POLICY_TABLE_SIZE || policy->kind >= CAN_LOG_POLICY_KIND_COUNT)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!can_log_policy_set(&s_policy, id, policy))
+    {
+        ESP_LOGW(TAG, "No free policy slot for ID 0x%03lx", (unsigned long)id);
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t can_logger_get_id_policy_stats(uint32_t id, uint32_t *logged, uint32_t *suppressed)
+{
+    const can_log_policy_slot_t *slot = can_log_policy_get(&s_policy, id);
+    if (!slot)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    if (logged)
+    {
+        *logged = slot->logged;
+    }
+    if (suppressed)
+    {
+        *suppressed = slot->suppressed;
+    }
+    return ESP_OK;
+}
+
 void can_logger_reset_stats(void)
 {
-    xSemaphoreTake(s_logger.stats_mutex, portMAX_DELAY);
-    s_logger.stats.messages_logged = 0;
-    s_logger.stats.messages_dropped = 0;
-    s_logger.stats.buffer_overruns = 0;
-    s_logger.stats.write_errors = 0;
-    s_logger.stats.bytes_written = 0;
-    xSemaphoreGive(s_logger.stats_mutex);
+    // Producers keep counting; totals restart from the current values
+    stat_fold();
+    portENTER_CRITICAL(&s_stat_lock);
+    memset(s_stat_total, 0, sizeof(s_stat_total));
+    portEXIT_CRITICAL(&s_stat_lock);
+
+    // Rebase the in-counter on what the ring actually holds, so a depth
+    // skewed by an earlier discard does not outlive the reset. Producers
+    // add to queued_in atomically, so the correction is applied the same way.
+    uint32_t depth = 0;
+    if (s_logger.ring_buffer)
+    {
+        UBaseType_t waiting = 0;
+        vRingbufferGetInfo(s_logger.ring_buffer, NULL, NULL, NULL, NULL, &waiting);
+        uint32_t queued_out = __atomic_load_n(&s_logger.queued_out, __ATOMIC_RELAXED);
+        uint32_t queued_in = __atomic_load_n(&s_logger.queued_in, __ATOMIC_RELAXED);
+        uint32_t excess = (queued_in - queued_out) - (uint32_t)waiting;
+        __atomic_fetch_sub(&s_logger.queued_in, excess, __ATOMIC_RELAXED);
+        depth = (uint32_t)waiting;
+    }
+
+    __atomic_store_n(&s_logger.ring_high_water, depth, __ATOMIC_RELAXED);
+    can_latency_hist_reset(&s_logger.write_latency);
+    can_latency_hist_reset(&s_logger.sync_latency);
 }
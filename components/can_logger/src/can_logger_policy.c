@@ -0,0 +1,140 @@
+/*
+ * CAN Logger Per-ID Policy Table - Implementation
+ */
+
+#include "can_logger_policy.h"
+
+#include <string.h>
+
+static void reset_slot_state(can_log_policy_slot_t *slot)
+{
+    slot->logged = 0;
+    slot->suppressed = 0;
+    slot->countdown = 0;
+    slot->has_last = false;
+    slot->last_dlc = 0;
+    memset(slot->last_data, 0, sizeof(slot->last_data));
+    slot->last_logged_us = 0;
+}
+
+void can_log_policy_init(can_log_policy_table_t *table)
+{
+    if (!table) {
+        return;
+    }
+
+    memset(table, 0, sizeof(*table));
+}
+
+bool can_log_policy_set(can_log_policy_table_t *table, uint32_t id,
+                        const can_log_policy_t *policy)
+{
+    if (!table || !policy || id >= CAN_LOG_POLICY_TABLE_SIZE ||
+        policy->kind >= CAN_LOG_POLICY_KIND_COUNT) {
+        return false;
+    }
+
+    uint8_t index = table->index[id];
+    if (index == 0) {
+        if (policy->kind == CAN_LOG_POLICY_ALWAYS) {
+            return true;
+        }
+        if (table->slot_count >= CAN_LOG_POLICY_MAX_RULES) {
+            return false;
+        }
+        index = (uint8_t)(++table->slot_count);
+        table->index[id] = index;
+    }
+
+    can_log_policy_slot_t *slot = &table->slots[index - 1];
+    slot->policy = *policy;
+    reset_slot_state(slot);
+    return true;
+}
+
+const can_log_policy_slot_t *can_log_policy_get(const can_log_policy_table_t *table,
+                                                uint32_t id)
+{
+    if (!table || id >= CAN_LOG_POLICY_TABLE_SIZE || table->index[id] == 0) {
+        return NULL;
+    }
+    return &table->slots[table->index[id] - 1];
+}
+
+static bool check_change(can_log_policy_slot_t *slot, uint8_t dlc,
+                         const uint8_t *data, int64_t timestamp_us)
+{
+    if (!slot->has_last) {
+        return true;
+    }
+
+    int64_t elapsed = timestamp_us - slot->last_logged_us;
+    if (slot->policy.kind == CAN_LOG_POLICY_RATE_LIMIT &&
+        elapsed < (int64_t)slot->policy.min_interval_us) {
+        return false;
+    }
+
+    size_t len = dlc < sizeof(slot->last_data) ? dlc : sizeof(slot->last_data);
+    bool changed = dlc != slot->last_dlc || memcmp(data, slot->last_data, len) != 0;
+    bool keyframe = slot->policy.keyframe_us > 0 &&
+                    elapsed >= (int64_t)slot->policy.keyframe_us;
+    return changed || keyframe;
+}
+
+bool can_log_policy_check(can_log_policy_table_t *table, uint32_t id, uint8_t dlc,
+                          const uint8_t *data, int64_t timestamp_us)
+{
+    if (!table || !data || id >= CAN_LOG_POLICY_TABLE_SIZE) {
+        return true;
+    }
+
+    uint8_t index = table->index[id];
+    if (index == 0) {
+        return true;
+    }
+
+    can_log_policy_slot_t *slot = &table->slots[index - 1];
+    bool log = true;
+
+    switch (slot->policy.kind) {
+        case CAN_LOG_POLICY_EVERY_N:
+            if (slot->policy.every_n > 1) {
+                log = (slot->countdown == 0);
+                slot->countdown = log ? (uint16_t)(slot->policy.every_n - 1)
+                                      : (uint16_t)(slot->countdown - 1);
+            }
+            break;
+        case CAN_LOG_POLICY_ON_CHANGE:
+        case CAN_LOG_POLICY_RATE_LIMIT:
+            log = check_change(slot, dlc, data, timestamp_us);
+            if (log) {
+                slot->has_last = true;
+                slot->last_dlc = dlc;
+                memcpy(slot->last_data, data, sizeof(slot->last_data));
+                slot->last_logged_us = timestamp_us;
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (log) {
+        slot->logged++;
+    } else {
+        slot->suppressed++;
+        table->suppressed[slot->policy.kind]++;
+    }
+    return log;
+}
+
+void can_log_policy_reset_state(can_log_policy_table_t *table)
+{
+    if (!table) {
+        return;
+    }
+
+    for (uint16_t i = 0; i < table->slot_count; i++) {
+        reset_slot_state(&table->slots[i]);
+    }
+    memset(table->suppressed, 0, sizeof(table->suppressed));
+}
@@ -0,0 +1,154 @@
+/*
+ * CAN Logger Power-Fail Sequencer - Implementation
+ */
+
+#include "can_logger_powerfail.h"
+
+#include <string.h>
+
+// Records written per drain batch (one write call per batch)
+#define PF_DRAIN_BATCH_RECORDS 32
+
+static bool pf_time_left(const can_logger_pf_io_t *io, int64_t deadline_us)
+{
+    return io->now_us(io->ctx) < deadline_us;
+}
+
+// CAN frames in a batch; meta records (sync, event) are not messages
+static uint32_t pf_frame_count(const can_bin_record_v1_t *batch, size_t count)
+{
+    uint32_t frames = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!(batch[i].flags & CAN_BIN_RECORD_FLAG_META)) {
+            frames++;
+        }
+    }
+    return frames;
+}
+
+static bool pf_write_all(const can_logger_pf_io_t *io, const void *data, size_t len)
+{
+    if (len == 0) {
+        return true;
+    }
+
+    int written = io->write(io->ctx, data, len);
+    return written >= 0 && (size_t)written == len;
+}
+
+void can_logger_pf_build_trailer(uint64_t timestamp_us,
+                                 const can_bin_trailer_v1_t *trailer,
+                                 can_bin_record_v1_t *out)
+{
+    if (!trailer || !out) {
+        return;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->timestamp_us = timestamp_us;
+    out->can_id = CAN_BIN_META_TRAILER;
+    out->dlc = sizeof(*trailer);
+    out->flags = CAN_BIN_RECORD_FLAG_META;
+    memcpy(out->data, trailer, sizeof(*trailer));
+}
+
+void can_logger_pf_run(const can_logger_pf_io_t *io,
+                       const can_logger_pf_budget_t *budget,
+                       int64_t detect_us,
+                       const void *pending, size_t pending_len,
+                       uint32_t records_logged,
+                       can_logger_stop_reason_t reason,
+                       can_logger_pf_result_t *result)
+{
+    if (!result) {
+        return;
+    }
+
+    memset(result, 0, sizeof(*result));
+
+    if (!io || !budget || !io->now_us || !io->write || !io->sync) {
+        return;
+    }
+
+    int64_t deadline_us = detect_us + budget->holdup_us;
+    // Two syncs remain after the pending write: the commit and the final one
+    int64_t commit_deadline_us = deadline_us - 2 * (int64_t)budget->sync_reserve_us;
+    int64_t drain_deadline_us = commit_deadline_us - budget->record_cost_us;
+    bool io_ok = true;
+
+    // Stage 1: partially filled write buffer. Always written - it is older
+    // than anything queued and a trailer after a gap would be misleading.
+    if (pending && pending_len > 0) {
+        io_ok = pf_write_all(io, pending, pending_len);
+    }
+    if (io_ok) {
+        result->stages |= CAN_BIN_TRAILER_STAGE_PENDING;
+    }
+
+    // Stage 2: commit what we have before spending time on the drain
+    if (io_ok && pf_time_left(io, commit_deadline_us)) {
+        io_ok = io->sync(io->ctx);
+        if (io_ok) {
+            result->stages |= CAN_BIN_TRAILER_STAGE_COMMIT;
+        }
+    }
+
+    // Stage 3: drain queued records in batches
+    if (io_ok && io->next_record) {
+        can_bin_record_v1_t batch[PF_DRAIN_BATCH_RECORDS];
+        bool queue_empty = false;
+
+        while (io_ok && pf_time_left(io, drain_deadline_us)) {
+            size_t count = 0;
+            while (count < PF_DRAIN_BATCH_RECORDS && io->next_record(io->ctx, &batch[count])) {
+                count++;
+            }
+            if (count == 0) {
+                queue_empty = true;
+                break;
+            }
+
+            io_ok = pf_write_all(io, batch, count * sizeof(batch[0]));
+            if (io_ok) {
+                result->records_drained += pf_frame_count(batch, count);
+            } else {
+                result->records_abandoned += pf_frame_count(batch, count);
+            }
+
+            if (count < PF_DRAIN_BATCH_RECORDS) {
+                queue_empty = true;
+                break;
+            }
+        }
+
+        if (queue_empty && io_ok) {
+            result->stages |= CAN_BIN_TRAILER_STAGE_DRAIN;
+        } else if (io->backlog) {
+            result->records_abandoned += (uint32_t)io->backlog(io->ctx);
+        }
+    } else if (!io->next_record) {
+        result->stages |= CAN_BIN_TRAILER_STAGE_DRAIN;
+    }
+
+    // Stage 4: trailer and final sync, attempted regardless of the deadline
+    if (io_ok) {
+        can_bin_trailer_v1_t trailer = {
+            .records_logged = records_logged + result->records_drained,
+            .records_abandoned = result->records_abandoned > UINT16_MAX
+                ? UINT16_MAX : (uint16_t)result->records_abandoned,
+            .reason = (uint8_t)reason,
+            .stages = result->stages
+        };
+        can_bin_record_v1_t record;
+        can_logger_pf_build_trailer((uint64_t)io->now_us(io->ctx), &trailer, &record);
+
+        result->trailer_written = pf_write_all(io, &record, sizeof(record));
+        if (result->trailer_written) {
+            result->synced = io->sync(io->ctx);
+        }
+    }
+
+    int64_t end_us = io->now_us(io->ctx);
+    result->elapsed_us = end_us - detect_us;
+    result->deadline_missed = end_us > deadline_us;
+}
@@ -0,0 +1,520 @@
+/*
+ * CAN Logger Decoded-Signal Sink Implementation
+ *
+ * Producers run the rate policy and push accepted samples into a small
+ * ring of their own. A low-priority writer appends them to per-signal
+ * chunks and writes a chunk out when it fills or ages, so a steady signal
+ * costs a couple of bytes per sample on the card.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/ringbuf.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "can_logger_signals.h"
+#include "can_bin_format.h"
+#include "can_sig_codec.h"
+#include "sd_card.h"
+
+static const char *TAG = "can_logger_sig";
+
+// Ring buffer item: one accepted sample
+typedef struct {
+    int64_t timestamp_us;
+    int32_t value;
+    uint16_t signal_id;
+} sig_item_t;
+
+#define SIG_WRITE_BUFFER_SIZE 16384
+#define SIG_WRITER_TASK_STACK_SIZE 3072
+#define SIG_WRITER_TASK_PRIORITY 3  // Below the raw writer (5)
+#define SIG_CHUNK_MAX_AGE_MS 5000   // Partial chunks are written at least this often
+#define SIG_SYNC_INTERVAL_MS 10000  // f_sync so the file survives power loss
+#define SIG_STOP_TIMEOUT_MS 2000
+#define SIG_RING_BYTES ((CONFIG_CAN_LOGGER_SIGNAL_RING_BYTES + 3) & ~3)  // Static rings need 4-byte multiples
+
+// Module state
+static struct {
+    bool registered;
+    volatile bool active;
+    volatile bool intake_closed;
+    volatile bool stop_requested;
+    size_t signal_count;
+    can_logger_signal_def_t defs[CAN_LOGGER_MAX_SIGNALS];
+    can_sig_rate_t rates[CAN_LOGGER_MAX_SIGNALS];
+    can_sig_rate_state_t rate_states[CAN_LOGGER_MAX_SIGNALS];
+    can_sig_chunk_t *chunks;
+    RingbufHandle_t ring_buffer;
+    uint8_t *ring_storage;
+    StaticRingbuffer_t *ring_struct;
+    TaskHandle_t writer_task;
+    SemaphoreHandle_t writer_done;
+    StaticSemaphore_t writer_done_buffer;
+    SemaphoreHandle_t card_released;    // Given once the raw writer closed its file
+    StaticSemaphore_t card_released_buffer;
+    void *file;
+    uint64_t log_start_unix_us;
+    uint64_t log_start_monotonic_us;
+    uint32_t header_flags;
+    uint8_t *write_buffer;
+    size_t write_buffer_pos;
+    can_logger_signal_stats_t stats;
+} s_sig = {
+    .registered = false,
+    .active = false,
+    .intake_closed = false,
+    .stop_requested = false,
+    .signal_count = 0,
+    .chunks = NULL,
+    .ring_buffer = NULL,
+    .ring_storage = NULL,
+    .ring_struct = NULL,
+    .writer_task = NULL,
+    .writer_done = NULL,
+    .card_released = NULL,
+    .file = NULL,
+    .write_buffer = NULL,
+    .write_buffer_pos = 0
+};
+
+static esp_err_t flush_write_buffer(void)
+{
+    if (s_sig.write_buffer_pos == 0 || !s_sig.file)
+    {
+        return ESP_OK;
+    }
+
+    int written = sd_card_write(s_sig.file, s_sig.write_buffer, s_sig.write_buffer_pos);
+    size_t expected = s_sig.write_buffer_pos;
+    s_sig.write_buffer_pos = 0;
+
+    if (written < 0 || (size_t)written != expected)
+    {
+        s_sig.stats.write_errors++;
+        ESP_LOGE(TAG, "Write error: expected %zu, wrote %d", expected, written);
+        return ESP_FAIL;
+    }
+
+    s_sig.stats.bytes_written += written;
+    return ESP_OK;
+}
+
+static esp_err_t buffer_write(const void *data, size_t len)
+{
+    if (s_sig.write_buffer_pos + len > SIG_WRITE_BUFFER_SIZE)
+    {
+        esp_err_t err = flush_write_buffer();
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+    }
+
+    memcpy(s_sig.write_buffer + s_sig.write_buffer_pos, data, len);
+    s_sig.write_buffer_pos += len;
+    return ESP_OK;
+}
+
+static esp_err_t write_sig_header(void)
+{
+    can_sig_header_v1_t header = {0};
+    memcpy(header.magic, CAN_SIG_MAGIC, sizeof(header.magic));
+    header.version = CAN_SIG_VERSION;
+    header.header_size = CAN_SIG_HEADER_SIZE;
+    header.log_start_unix_us = s_sig.log_start_unix_us;
+    header.log_start_monotonic_us = s_sig.log_start_monotonic_us;
+    header.signal_count = (uint16_t)s_sig.signal_count;
+    header.desc_size = CAN_SIG_DESC_SIZE;
+    header.flags = (s_sig.header_flags & CAN_BIN_HEADER_FLAG_TIMEBASE) ?
+                   CAN_SIG_HEADER_FLAG_TIMEBASE : 0;
+
+    esp_err_t err = buffer_write(&header, sizeof(header));
+    for (size_t i = 0; i < s_sig.signal_count && err == ESP_OK; i++)
+    {
+        can_sig_desc_v1_t desc = {0};
+        strncpy(desc.name, s_sig.defs[i].name, sizeof(desc.name) - 1);
+        if (s_sig.defs[i].unit)
+        {
+            strncpy(desc.unit, s_sig.defs[i].unit, sizeof(desc.unit) - 1);
+        }
+        desc.scale = s_sig.defs[i].scale;
+        err = buffer_write(&desc, sizeof(desc));
+    }
+
+    return err;
+}
+
+static void emit_chunk(can_sig_chunk_t *chunk)
+{
+    if (can_sig_chunk_size(chunk) == 0)
+    {
+        return;
+    }
+
+    if (s_sig.write_buffer_pos + CAN_SIG_CHUNK_MAX_BYTES > SIG_WRITE_BUFFER_SIZE)
+    {
+        flush_write_buffer();
+    }
+
+    size_t written = can_sig_chunk_emit(chunk, s_sig.write_buffer + s_sig.write_buffer_pos,
+                                        SIG_WRITE_BUFFER_SIZE - s_sig.write_buffer_pos);
+    s_sig.write_buffer_pos += written;
+    s_sig.stats.chunks_written++;
+}
+
+static void emit_all_chunks(void)
+{
+    for (size_t i = 0; i < s_sig.signal_count; i++)
+    {
+        emit_chunk(&s_sig.chunks[i]);
+    }
+}
+
+static void append_sample(const sig_item_t *item)
+{
+    if (item->signal_id >= s_sig.signal_count)
+    {
+        return;
+    }
+
+    can_sig_chunk_t *chunk = &s_sig.chunks[item->signal_id];
+    if (!can_sig_chunk_append(chunk, item->timestamp_us, item->value))
+    {
+        emit_chunk(chunk);
+        can_sig_chunk_append(chunk, item->timestamp_us, item->value);
+    }
+    s_sig.stats.samples_logged++;
+}
+
+static void drain_ring(void)
+{
+    size_t item_size = 0;
+    sig_item_t *item;
+    while ((item = xRingbufferReceive(s_sig.ring_buffer, &item_size, 0)) != NULL)
+    {
+        append_sample(item);
+        vRingbufferReturnItem(s_sig.ring_buffer, item);
+    }
+}
+
+static void signal_writer_task(void *arg)
+{
+    (void)arg;
+
+    if (write_sig_header() != ESP_OK || flush_write_buffer() != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to write signal header, signal sink disabled");
+        s_sig.active = false;
+    }
+
+    int64_t last_chunk_flush_ms = esp_timer_get_time() / 1000;
+    int64_t last_sync_ms = last_chunk_flush_ms;
+
+    while (s_sig.active && !s_sig.stop_requested && !s_sig.intake_closed)
+    {
+        size_t item_size = 0;
+        sig_item_t *item = xRingbufferReceive(s_sig.ring_buffer, &item_size,
+                                              pdMS_TO_TICKS(100));
+        if (item)
+        {
+            append_sample(item);
+            vRingbufferReturnItem(s_sig.ring_buffer, item);
+            drain_ring();
+        }
+
+        // Partial chunks are written on age so a crash loses little
+        int64_t now_ms = esp_timer_get_time() / 1000;
+        if (now_ms - last_chunk_flush_ms >= SIG_CHUNK_MAX_AGE_MS)
+        {
+            emit_all_chunks();
+            flush_write_buffer();
+            last_chunk_flush_ms = now_ms;
+        }
+
+        if (now_ms - last_sync_ms >= SIG_SYNC_INTERVAL_MS)
+        {
+            if (sd_card_sync(s_sig.file) != ESP_OK)
+            {
+                s_sig.stats.write_errors++;
+            }
+            last_sync_ms = now_ms;
+        }
+    }
+
+    // On power fail the raw sink owns the card; keep only what is synced
+    // and leave even the close (directory update) until the raw file is shut
+    if (!s_sig.intake_closed)
+    {
+        drain_ring();
+        emit_all_chunks();
+        flush_write_buffer();
+    }
+    else
+    {
+        s_sig.write_buffer_pos = 0;
+        xSemaphoreTake(s_sig.card_released, portMAX_DELAY);
+    }
+
+    sd_card_close_log_file(s_sig.file);
+    s_sig.file = NULL;
+    s_sig.active = false;
+
+    ESP_LOGI(TAG, "Signal writer stopped. Samples: %lu, Bytes: %lu",
+             (unsigned long)s_sig.stats.samples_logged,
+             (unsigned long)s_sig.stats.bytes_written);
+
+    xSemaphoreGive(s_sig.writer_done);
+    vTaskDelete(NULL);
+}
+
+void can_logger_signals_plan_memory(mem_plan_budget_t *budget)
+{
+    mem_plan_budget_add(budget, MEM_REGION_PSRAM,
+                        CAN_LOGGER_MAX_SIGNALS * sizeof(can_sig_chunk_t), 4);
+    mem_plan_budget_add(budget, MEM_REGION_PSRAM, SIG_WRITE_BUFFER_SIZE, 4);
+    mem_plan_budget_add(budget, MEM_REGION_PSRAM, SIG_RING_BYTES, 4);
+    mem_plan_budget_add(budget, MEM_REGION_INTERNAL, sizeof(StaticRingbuffer_t), 4);
+}
+
+esp_err_t can_logger_signals_register(const can_logger_signal_def_t *defs, size_t count)
+{
+    if (!defs || count == 0 || count > CAN_LOGGER_MAX_SIGNALS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_sig.registered)
+    {
+        ESP_LOGW(TAG, "Signals already registered");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!defs[i].name || !(defs[i].scale > 0.0f))
+        {
+            ESP_LOGE(TAG, "Signal %u needs a name and a positive scale", (unsigned)i);
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    // Sized for CAN_LOGGER_MAX_SIGNALS by can_logger_signals_plan_memory();
+    // arena blocks cannot be returned, so a failed register leaves them
+    // for a retry
+    if (!s_sig.chunks)
+    {
+        s_sig.chunks = mem_plan_alloc(MEM_REGION_PSRAM,
+                                      CAN_LOGGER_MAX_SIGNALS * sizeof(can_sig_chunk_t), 4,
+                                      "signal chunks");
+    }
+    if (!s_sig.write_buffer)
+    {
+        s_sig.write_buffer = mem_plan_alloc(MEM_REGION_PSRAM, SIG_WRITE_BUFFER_SIZE, 4,
+                                            "signal write buffer");
+    }
+    if (!s_sig.ring_storage)
+    {
+        s_sig.ring_storage = mem_plan_alloc(MEM_REGION_PSRAM, SIG_RING_BYTES, 4,
+                                            "signal ring");
+    }
+    if (!s_sig.ring_struct)
+    {
+        s_sig.ring_struct = mem_plan_alloc(MEM_REGION_INTERNAL, sizeof(StaticRingbuffer_t), 4,
+                                           "signal ring ctl");
+    }
+    if (!s_sig.chunks || !s_sig.write_buffer || !s_sig.ring_storage || !s_sig.ring_struct)
+    {
+        ESP_LOGE(TAG, "Signal sink buffers missing from the memory plan");
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_sig.writer_done = xSemaphoreCreateBinaryStatic(&s_sig.writer_done_buffer);
+    s_sig.card_released = xSemaphoreCreateBinaryStatic(&s_sig.card_released_buffer);
+    s_sig.ring_buffer = xRingbufferCreateStatic(SIG_RING_BYTES, RINGBUF_TYPE_NOSPLIT,
+                                                s_sig.ring_storage, s_sig.ring_struct);
+    if (!s_sig.writer_done || !s_sig.card_released || !s_sig.ring_buffer)
+    {
+        ESP_LOGE(TAG, "Failed to create signal sink ring");
+        return ESP_ERR_NO_MEM;
+    }
+
+    memcpy(s_sig.defs, defs, count * sizeof(*defs));
+    for (size_t i = 0; i < count; i++)
+    {
+        s_sig.rates[i].min_interval_us = defs[i].min_interval_ms * 1000;
+        s_sig.rates[i].max_interval_us = defs[i].max_interval_ms * 1000;
+        s_sig.rates[i].deadband = can_sig_quantize(defs[i].deadband, defs[i].scale);
+    }
+    s_sig.signal_count = count;
+    s_sig.registered = true;
+
+    ESP_LOGI(TAG, "Registered %u signals (%d byte sink ring)",
+             (unsigned)count, SIG_RING_BYTES);
+    return ESP_OK;
+}
+
+// Collect a finished writer; a stop that timed out leaves it to be reaped here
+static bool writer_reap(TickType_t wait)
+{
+    if (!s_sig.writer_task)
+    {
+        return true;
+    }
+
+    if (xSemaphoreTake(s_sig.writer_done, wait) != pdTRUE)
+    {
+        return false;
+    }
+
+    s_sig.writer_task = NULL;
+    return true;
+}
+
+esp_err_t can_logger_signals_start(const char *raw_path, uint64_t log_start_unix_us,
+                                   uint64_t log_start_monotonic_us, uint32_t header_flags)
+{
+    if (!s_sig.registered)
+    {
+        return ESP_OK;
+    }
+
+    if (s_sig.active || !writer_reap(0))
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Leftovers from an abandoned session
+    size_t item_size = 0;
+    void *item;
+    while ((item = xRingbufferReceive(s_sig.ring_buffer, &item_size, 0)) != NULL)
+    {
+        vRingbufferReturnItem(s_sig.ring_buffer, item);
+    }
+
+    memset(&s_sig.stats, 0, sizeof(s_sig.stats));
+    s_sig.file = sd_card_create_companion_file(raw_path, "sig", s_sig.stats.current_file,
+                                               sizeof(s_sig.stats.current_file));
+    if (!s_sig.file)
+    {
+        return ESP_FAIL;
+    }
+
+    for (size_t i = 0; i < s_sig.signal_count; i++)
+    {
+        can_sig_chunk_reset(&s_sig.chunks[i], (uint16_t)i);
+        memset(&s_sig.rate_states[i], 0, sizeof(s_sig.rate_states[i]));
+    }
+
+    s_sig.log_start_unix_us = log_start_unix_us;
+    s_sig.log_start_monotonic_us = log_start_monotonic_us;
+    s_sig.header_flags = header_flags;
+    s_sig.write_buffer_pos = 0;
+    s_sig.stop_requested = false;
+    s_sig.intake_closed = false;
+    xSemaphoreTake(s_sig.card_released, 0);  // Left over from a normal stop
+    s_sig.active = true;
+
+    BaseType_t result = xTaskCreate(signal_writer_task, "can_sig_wr",
+                                    SIG_WRITER_TASK_STACK_SIZE, NULL,
+                                    SIG_WRITER_TASK_PRIORITY, &s_sig.writer_task);
+    if (result != pdTRUE)
+    {
+        ESP_LOGE(TAG, "Failed to create signal writer task");
+        s_sig.active = false;
+        sd_card_close_log_file(s_sig.file);
+        s_sig.file = NULL;
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Signal logging started: %s", s_sig.stats.current_file);
+    return ESP_OK;
+}
+
+esp_err_t can_logger_signals_stop(void)
+{
+    if (!s_sig.writer_task)
+    {
+        return ESP_OK;
+    }
+
+    s_sig.stop_requested = true;
+    if (!writer_reap(pdMS_TO_TICKS(SIG_STOP_TIMEOUT_MS)))
+    {
+        // The writer still owns the file; the next stop or start reaps it
+        ESP_LOGW(TAG, "Signal writer did not finish within %d ms", SIG_STOP_TIMEOUT_MS);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+void IRAM_ATTR can_logger_signals_close_intake(void)
+{
+    s_sig.intake_closed = true;
+}
+
+void can_logger_signals_card_released(void)
+{
+    if (s_sig.card_released)
+    {
+        xSemaphoreGive(s_sig.card_released);
+    }
+}
+
+esp_err_t can_logger_signal_log(uint16_t signal_id, int64_t timestamp_us, float value)
+{
+    if (!s_sig.active || s_sig.intake_closed || s_sig.stop_requested)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (signal_id >= s_sig.signal_count)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sig_item_t item = {
+        .timestamp_us = timestamp_us,
+        .value = can_sig_quantize(value, s_sig.defs[signal_id].scale),
+        .signal_id = signal_id
+    };
+
+    if (!can_sig_rate_accept(&s_sig.rates[signal_id], &s_sig.rate_states[signal_id],
+                             item.timestamp_us, item.value))
+    {
+        s_sig.stats.samples_suppressed++;
+        return ESP_OK;
+    }
+
+    if (xRingbufferSend(s_sig.ring_buffer, &item, sizeof(item), 0) != pdTRUE)
+    {
+        s_sig.stats.samples_dropped++;
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t can_logger_signals_get_stats(can_logger_signal_stats_t *stats)
+{
+    if (!stats)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_sig.registered)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Each counter has a single writer; a torn snapshot is at most one sample off
+    memcpy(stats, &s_sig.stats, sizeof(*stats));
+    stats->active = s_sig.active;
+    return ESP_OK;
+}
@@ -0,0 +1,242 @@
+/*
+ * CANSIG Chunk Codec and Rate Policy - Implementation
+ */
+
+#include "can_sig_codec.h"
+
+#include <string.h>
+
+// Longest varint for a 64-bit value
+#define VARINT_MAX_BYTES 10
+
+static size_t put_uvarint(uint8_t *p, uint64_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static bool get_uvarint(const uint8_t *p, size_t len, size_t *pos, uint64_t *out)
+{
+    uint64_t v = 0;
+    for (unsigned shift = 0; shift < 64 && *pos < len; shift += 7) {
+        uint8_t b = p[(*pos)++];
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *out = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint64_t zigzag_encode(int64_t v)
+{
+    return v >= 0 ? (uint64_t)v << 1 : (((uint64_t)(-(v + 1))) << 1) | 1u;
+}
+
+static int64_t zigzag_decode(uint64_t v)
+{
+    return (v & 1u) ? -(int64_t)(v >> 1) - 1 : (int64_t)(v >> 1);
+}
+
+void can_sig_chunk_reset(can_sig_chunk_t *chunk, uint16_t signal_id)
+{
+    if (!chunk) {
+        return;
+    }
+
+    chunk->signal_id = signal_id;
+    chunk->count = 0;
+    chunk->first_ts_us = 0;
+    chunk->last_ts_us = 0;
+    chunk->first_value = 0;
+    chunk->last_value = 0;
+    chunk->ts_len = 0;
+    chunk->value_len = 0;
+}
+
+bool can_sig_chunk_append(can_sig_chunk_t *chunk, int64_t timestamp_us, int32_t value)
+{
+    if (!chunk) {
+        return false;
+    }
+
+    if (chunk->count == 0) {
+        chunk->first_ts_us = timestamp_us;
+        chunk->last_ts_us = timestamp_us;
+        chunk->first_value = value;
+        chunk->last_value = value;
+        chunk->count = 1;
+        return true;
+    }
+
+    if (chunk->count == UINT16_MAX) {
+        return false;
+    }
+
+    uint64_t ts_delta = timestamp_us > chunk->last_ts_us ?
+                        (uint64_t)(timestamp_us - chunk->last_ts_us) : 0;
+    uint64_t value_delta = zigzag_encode((int64_t)value - chunk->last_value);
+
+    uint8_t ts_buf[VARINT_MAX_BYTES];
+    uint8_t value_buf[VARINT_MAX_BYTES];
+    size_t ts_n = put_uvarint(ts_buf, ts_delta);
+    size_t value_n = put_uvarint(value_buf, value_delta);
+    if (chunk->ts_len + ts_n > CAN_SIG_CHUNK_COLUMN_BYTES ||
+        chunk->value_len + value_n > CAN_SIG_CHUNK_COLUMN_BYTES) {
+        return false;
+    }
+
+    memcpy(chunk->ts_column + chunk->ts_len, ts_buf, ts_n);
+    memcpy(chunk->value_column + chunk->value_len, value_buf, value_n);
+    chunk->ts_len += (uint16_t)ts_n;
+    chunk->value_len += (uint16_t)value_n;
+    chunk->count++;
+    if (timestamp_us > chunk->last_ts_us) {
+        chunk->last_ts_us = timestamp_us;
+    }
+    chunk->last_value = value;
+    return true;
+}
+
+size_t can_sig_chunk_size(const can_sig_chunk_t *chunk)
+{
+    if (!chunk || chunk->count == 0) {
+        return 0;
+    }
+    return CAN_SIG_CHUNK_HEADER_SIZE + chunk->ts_len + chunk->value_len;
+}
+
+size_t can_sig_chunk_emit(can_sig_chunk_t *chunk, uint8_t *out, size_t out_size)
+{
+    size_t size = can_sig_chunk_size(chunk);
+    if (size == 0 || !out || out_size < size) {
+        return 0;
+    }
+
+    can_sig_chunk_header_v1_t header = {
+        .magic = CAN_SIG_CHUNK_MAGIC,
+        .signal_id = chunk->signal_id,
+        .count = chunk->count,
+        .ts_bytes = chunk->ts_len,
+        .value_bytes = chunk->value_len,
+        .reserved = 0,
+        .first_timestamp_us = chunk->first_ts_us,
+        .first_value = chunk->first_value
+    };
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), chunk->ts_column, chunk->ts_len);
+    memcpy(out + sizeof(header) + chunk->ts_len, chunk->value_column, chunk->value_len);
+
+    can_sig_chunk_reset(chunk, chunk->signal_id);
+    return size;
+}
+
+size_t can_sig_chunk_decode(const uint8_t *data, size_t len,
+                            can_sig_sample_cb_t cb, void *ctx)
+{
+    if (!data || len < CAN_SIG_CHUNK_HEADER_SIZE) {
+        return 0;
+    }
+
+    can_sig_chunk_header_v1_t header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != CAN_SIG_CHUNK_MAGIC || header.count == 0) {
+        return 0;
+    }
+
+    size_t total = CAN_SIG_CHUNK_HEADER_SIZE + (size_t)header.ts_bytes + header.value_bytes;
+    if (total > len) {
+        return 0;
+    }
+
+    const uint8_t *ts_col = data + CAN_SIG_CHUNK_HEADER_SIZE;
+    const uint8_t *value_col = ts_col + header.ts_bytes;
+    size_t ts_pos = 0;
+    size_t value_pos = 0;
+    int64_t ts = header.first_timestamp_us;
+    int64_t value = header.first_value;
+
+    if (cb) {
+        cb(ctx, header.signal_id, ts, (int32_t)value);
+    }
+
+    for (uint16_t i = 1; i < header.count; i++) {
+        uint64_t ts_delta = 0;
+        uint64_t value_delta = 0;
+        if (!get_uvarint(ts_col, header.ts_bytes, &ts_pos, &ts_delta) ||
+            !get_uvarint(value_col, header.value_bytes, &value_pos, &value_delta)) {
+            return 0;
+        }
+
+        ts += (int64_t)ts_delta;
+        value += zigzag_decode(value_delta);
+        if (value < INT32_MIN || value > INT32_MAX) {
+            return 0;
+        }
+
+        if (cb) {
+            cb(ctx, header.signal_id, ts, (int32_t)value);
+        }
+    }
+
+    // Both columns must be consumed exactly
+    if (ts_pos != header.ts_bytes || value_pos != header.value_bytes) {
+        return 0;
+    }
+
+    return total;
+}
+
+int32_t can_sig_quantize(float value, float scale)
+{
+    if (!(scale > 0.0f) || value != value) {
+        return 0;
+    }
+
+    double units = (double)value / (double)scale;
+    if (units >= (double)INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (units <= (double)INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)(units >= 0.0 ? units + 0.5 : units - 0.5);
+}
+
+bool can_sig_rate_accept(const can_sig_rate_t *rate, can_sig_rate_state_t *state,
+                         int64_t timestamp_us, int32_t value)
+{
+    if (!rate || !state) {
+        return false;
+    }
+
+    if (state->has_last) {
+        int64_t elapsed = timestamp_us - state->last_ts_us;
+        if (elapsed < (int64_t)rate->min_interval_us) {
+            return false;
+        }
+
+        int64_t change = (int64_t)value - state->last_value;
+        if (change < 0) {
+            change = -change;
+        }
+
+        bool changed = change > rate->deadband;
+        bool heartbeat = rate->max_interval_us > 0 &&
+                         elapsed >= (int64_t)rate->max_interval_us;
+        if (!changed && !heartbeat) {
+            return false;
+        }
+    }
+
+    state->has_last = true;
+    state->last_ts_us = timestamp_us;
+    state->last_value = value;
+    return true;
+}
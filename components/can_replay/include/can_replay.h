@@ -0,0 +1,82 @@
+/*
+ * CAN Log Replay
+ *
+ * Transmits a CANBIN log back onto the bus at its recorded timing, for
+ * bench testing the dashboard and other nodes without the car. A reader
+ * task streams the file from the SD card into two record buffers (one
+ * being read while the other is replayed); an esp_timer one-shot fires
+ * at each frame's due time (can_replay_core.h) and queues the frame with
+ * twai_transmit(). Frames due within a short slack of each other are sent
+ * from the same callback.
+ *
+ * Lateness (send time - due time) is measured when the frame enters the
+ * TWAI TX queue, so bus arbitration and queueing behind earlier frames
+ * are not included.
+ *
+ * The CANBIN record does not keep the IDE bit: IDs above 0x7FF are sent
+ * as extended frames, the rest as standard frames.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "mem_plan.h"
+#include "can_replay_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Add the read-ahead buffers to the boot memory plan
+ *
+ * @param budget Budget to add to
+ */
+void can_replay_plan_memory(mem_plan_budget_t *budget);
+
+/**
+ * @brief Create the reader task and replay timer
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the buffers or task are missing
+ */
+esp_err_t can_replay_init(void);
+
+/**
+ * @brief Start replaying a file
+ *
+ * The first buffer is read before returning; the first frame goes out
+ * shortly after.
+ *
+ * @param path Absolute path of a CANBIN log
+ * @param opts Replay options
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if a replay is running
+ *         or init has not run, ESP_ERR_NOT_FOUND if the file cannot be
+ *         opened, ESP_ERR_INVALID_VERSION for a bad header
+ */
+esp_err_t can_replay_start(const char *path, const can_replay_options_t *opts);
+
+/**
+ * @brief Stop the running replay (no-op if none)
+ */
+void can_replay_stop(void);
+
+/**
+ * @brief Whether a replay is running
+ *
+ * @return true between can_replay_start() and the end of the last pass
+ */
+bool can_replay_is_running(void);
+
+/**
+ * @brief Copy the statistics of the current or last replay
+ *
+ * @param out Filled with the counters
+ */
+void can_replay_get_stats(can_replay_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,135 @@
+/*
+ * CAN Replay Core
+ *
+ * Timeline and filtering for replaying a CANBIN log onto a bus. Records
+ * are fed in file order; each accepted frame gets a due time on the
+ * local clock:
+ *
+ *   due = pass_start + (timestamp - first_timestamp) * 1000 / speed_permille
+ *
+ * where first_timestamp is the first accepted frame of the pass. Meta
+ * records and filtered IDs are skipped. At the end of the file a looping
+ * replay rewinds and starts the next pass loop_gap_us after the last
+ * frame. The caller transmits each frame at its due time and reports
+ * back, which feeds the lateness histogram (send time - due time).
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_bin_format.h"
+#include "can_latency_hist.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_REPLAY_MAX_FILTER_IDS 16
+#define CAN_REPLAY_SPEED_REALTIME 1000
+
+typedef struct {
+    uint32_t speed_permille;    // Playback rate, 1000 = as recorded, 2000 = twice as fast
+    bool loop;                  // Rewind at the end of the file
+    uint32_t loop_gap_us;       // Pause between passes
+    uint32_t filter_ids[CAN_REPLAY_MAX_FILTER_IDS];
+    size_t filter_count;        // 0 = replay every ID
+    bool filter_exclude;        // true: skip listed IDs, false: replay only listed IDs
+    bool self_rx;               // Device only: also deliver frames to our own RX path
+} can_replay_options_t;
+
+typedef struct {
+    uint32_t frames_sent;
+    uint32_t frames_filtered;   // Skipped by the ID filter
+    uint32_t meta_skipped;      // Meta records in the file
+    uint32_t tx_errors;         // Transmit failed (frame dropped)
+    uint32_t underruns;         // Device only: read-ahead not ready in time
+    uint32_t passes;            // Completed passes over the file
+    int32_t max_early_us;       // Largest negative lateness (should stay 0)
+    can_latency_hist_t lateness;
+} can_replay_stats_t;
+
+typedef struct {
+    can_replay_options_t opts;
+    int64_t pass_start_us;      // Local time of the pass's first frame
+    int64_t first_ts_us;        // Recorded time of that frame (-1 = none yet)
+    int64_t last_due_us;
+    can_replay_stats_t stats;
+} can_replay_core_t;
+
+/**
+ * @brief Check a CANBIN header
+ *
+ * @param data File start
+ * @param len Bytes available
+ * @return true for a CANBIN v1 header with the expected record size
+ */
+bool can_replay_core_check_header(const uint8_t *data, size_t len);
+
+/**
+ * @brief Parse an ID filter list
+ *
+ * Hex IDs separated by commas or spaces ("0x1C4, 0B4"). A leading '!'
+ * turns the list into an exclusion list.
+ *
+ * @param text List text (NULL or empty = no filter)
+ * @param opts Options whose filter fields are set
+ * @return true on success, false on a malformed list or too many IDs
+ */
+bool can_replay_core_parse_filter(const char *text, can_replay_options_t *opts);
+
+/**
+ * @brief Start a replay
+ *
+ * @param r Replay state
+ * @param opts Options (copied; speed 0 is treated as real time)
+ * @param start_us Local time at which the first frame is due
+ */
+void can_replay_core_init(can_replay_core_t *r, const can_replay_options_t *opts,
+                          int64_t start_us);
+
+/**
+ * @brief Whether a frame ID passes the filter
+ *
+ * @param r Replay state
+ * @param id CAN ID
+ * @return true if the frame is replayed
+ */
+bool can_replay_core_accept(const can_replay_core_t *r, uint32_t id);
+
+/**
+ * @brief Schedule the next record of the file
+ *
+ * @param r Replay state
+ * @param rec Record
+ * @param due_us Filled with the local due time for accepted frames
+ * @return true if the record is a frame to transmit, false if skipped
+ */
+bool can_replay_core_schedule(can_replay_core_t *r, const can_bin_record_v1_t *rec,
+                              int64_t *due_us);
+
+/**
+ * @brief Report a transmitted (or failed) frame
+ *
+ * @param r Replay state
+ * @param due_us Due time from can_replay_core_schedule()
+ * @param sent_us Local time of the transmit call
+ * @param ok Transmit succeeded
+ */
+void can_replay_core_sent(can_replay_core_t *r, int64_t due_us, int64_t sent_us, bool ok);
+
+/**
+ * @brief End a pass; the next frame starts a new one
+ *
+ * @param r Replay state
+ * @return true if another pass follows (looping), false if the replay is done
+ */
+bool can_replay_core_end_pass(can_replay_core_t *r);
+
+#ifdef __cplusplus
+}
+#endif
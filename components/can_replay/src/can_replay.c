@@ -0,0 +1,351 @@
+/*
+ * CAN Log Replay Implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <driver/twai.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "can_replay.h"
+
+static const char *TAG = "can_replay";
+
+#define REPLAY_SLOTS 2
+#define REPLAY_SLOT_RECORDS CONFIG_CAN_REPLAY_BUFFER_RECORDS
+#define REPLAY_SLOT_BYTES (REPLAY_SLOT_RECORDS * sizeof(can_bin_record_v1_t))
+#define REPLAY_START_DELAY_US 10000     // First frame after start
+#define REPLAY_SLACK_US 100             // Send frames due this soon without re-arming
+#define REPLAY_MAX_BURST 16             // Frames per timer callback
+#define REPLAY_RETRY_US 1000            // Re-check after an underrun
+#define REPLAY_QUEUE_FULL_RETRY_US 200  // Re-try after a full TX queue
+#define REPLAY_TASK_STACK 3072
+#define REPLAY_TASK_PRIORITY 3
+
+// Reader task notification bits
+#define REPLAY_NOTIFY_FILL  (1u << 0)
+#define REPLAY_NOTIFY_CLOSE (1u << 1)
+
+typedef enum {
+    SLOT_EMPTY = 0,     // Owned by the reader
+    SLOT_FULL           // Owned by the timer callback
+} slot_state_t;
+
+typedef struct {
+    can_bin_record_v1_t *records;
+    uint32_t count;
+    bool end_of_pass;   // Last records of the file
+    uint8_t state;      // slot_state_t, handed over with acquire/release
+} replay_slot_t;
+
+// Module state
+static struct {
+    replay_slot_t slots[REPLAY_SLOTS];
+    TaskHandle_t task;
+    esp_timer_handle_t timer;
+    FILE *file;                 // Reader task (and start) only
+    bool reader_done;           // Reader: no more passes to read
+    bool running;
+    // Timer callback only
+    can_replay_core_t core;
+    uint32_t slot;
+    uint32_t pos;
+    bool have_due;
+    int64_t due_us;
+} s_replay = {
+    .task = NULL,
+    .timer = NULL,
+    .file = NULL,
+    .running = false
+};
+
+static void fill_slot(replay_slot_t *slot)
+{
+    slot->count = 0;
+    slot->end_of_pass = true;
+    if (!s_replay.file || s_replay.reader_done)
+    {
+        return;
+    }
+
+    size_t n = fread(slot->records, sizeof(can_bin_record_v1_t), REPLAY_SLOT_RECORDS,
+                     s_replay.file);
+    slot->count = (uint32_t)n;
+    slot->end_of_pass = n < REPLAY_SLOT_RECORDS;
+    if (!slot->end_of_pass)
+    {
+        return;
+    }
+
+    if (s_replay.core.opts.loop &&
+        fseek(s_replay.file, CAN_BIN_HEADER_SIZE, SEEK_SET) == 0)
+    {
+        return;
+    }
+    s_replay.reader_done = true;
+}
+
+static void close_file(void)
+{
+    if (s_replay.file)
+    {
+        fclose(s_replay.file);
+        s_replay.file = NULL;
+    }
+}
+
+static void reader_task(void *arg)
+{
+    (void)arg;
+
+    while (1)
+    {
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, portMAX_DELAY);
+
+        if (bits & REPLAY_NOTIFY_CLOSE)
+        {
+            close_file();
+            continue;
+        }
+
+        // Refill in replay order so the timer never skips ahead
+        for (uint32_t i = 0; i < REPLAY_SLOTS; i++)
+        {
+            replay_slot_t *slot = &s_replay.slots[(s_replay.slot + i) % REPLAY_SLOTS];
+            if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) != SLOT_EMPTY)
+            {
+                continue;
+            }
+            fill_slot(slot);
+            __atomic_store_n(&slot->state, SLOT_FULL, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+static void finish(void)
+{
+    __atomic_store_n(&s_replay.running, false, __ATOMIC_RELEASE);
+    xTaskNotify(s_replay.task, REPLAY_NOTIFY_CLOSE, eSetBits);
+    ESP_LOGI(TAG, "Replay done: %u frames, %u errors, %u underruns",
+             (unsigned)s_replay.core.stats.frames_sent,
+             (unsigned)s_replay.core.stats.tx_errors,
+             (unsigned)s_replay.core.stats.underruns);
+}
+
+static esp_err_t transmit(const can_bin_record_v1_t *rec)
+{
+    twai_message_t msg = {0};
+    msg.identifier = rec->can_id;
+    msg.extd = rec->can_id > 0x7FF;
+    msg.self = s_replay.core.opts.self_rx;
+    msg.data_length_code = rec->dlc > 8 ? 8 : rec->dlc;
+    memcpy(msg.data, rec->data, msg.data_length_code);
+    return twai_transmit(&msg, 0);
+}
+
+static void replay_timer_cb(void *arg)
+{
+    (void)arg;
+
+    if (!__atomic_load_n(&s_replay.running, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    int burst = 0;
+
+    while (1)
+    {
+        replay_slot_t *slot = &s_replay.slots[s_replay.slot];
+        if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) != SLOT_FULL)
+        {
+            s_replay.core.stats.underruns++;
+            esp_timer_start_once(s_replay.timer, REPLAY_RETRY_US);
+            return;
+        }
+
+        if (s_replay.pos >= slot->count)
+        {
+            bool end_of_pass = slot->end_of_pass;
+            __atomic_store_n(&slot->state, SLOT_EMPTY, __ATOMIC_RELEASE);
+            s_replay.slot = (s_replay.slot + 1) % REPLAY_SLOTS;
+            s_replay.pos = 0;
+            xTaskNotify(s_replay.task, REPLAY_NOTIFY_FILL, eSetBits);
+
+            if (end_of_pass && !can_replay_core_end_pass(&s_replay.core))
+            {
+                finish();
+                return;
+            }
+            continue;
+        }
+
+        const can_bin_record_v1_t *rec = &slot->records[s_replay.pos];
+        if (!s_replay.have_due)
+        {
+            if (!can_replay_core_schedule(&s_replay.core, rec, &s_replay.due_us))
+            {
+                s_replay.pos++;
+                continue;
+            }
+            s_replay.have_due = true;
+        }
+
+        if (s_replay.due_us > now_us + REPLAY_SLACK_US || burst >= REPLAY_MAX_BURST)
+        {
+            int64_t wait_us = s_replay.due_us - now_us;
+            esp_timer_start_once(s_replay.timer, wait_us > 0 ? (uint64_t)wait_us : 0);
+            return;
+        }
+
+        esp_err_t err = transmit(rec);
+        if (err == ESP_ERR_TIMEOUT)
+        {
+            // TX queue full: keep the frame and try again shortly
+            esp_timer_start_once(s_replay.timer, REPLAY_QUEUE_FULL_RETRY_US);
+            return;
+        }
+
+        now_us = esp_timer_get_time();
+        can_replay_core_sent(&s_replay.core, s_replay.due_us, now_us, err == ESP_OK);
+        s_replay.have_due = false;
+        s_replay.pos++;
+        burst++;
+    }
+}
+
+void can_replay_plan_memory(mem_plan_budget_t *budget)
+{
+    mem_plan_budget_add(budget, MEM_REGION_PSRAM, REPLAY_SLOTS * REPLAY_SLOT_BYTES, 4);
+}
+
+esp_err_t can_replay_init(void)
+{
+    if (s_replay.task)
+    {
+        return ESP_OK;
+    }
+
+    uint8_t *storage = mem_plan_alloc(MEM_REGION_PSRAM, REPLAY_SLOTS * REPLAY_SLOT_BYTES, 4,
+                                      "replay buffers");
+    if (!storage)
+    {
+        ESP_LOGE(TAG, "Read-ahead buffers missing from the memory plan");
+        return ESP_ERR_NO_MEM;
+    }
+    for (uint32_t i = 0; i < REPLAY_SLOTS; i++)
+    {
+        s_replay.slots[i].records = (can_bin_record_v1_t *)(storage + i * REPLAY_SLOT_BYTES);
+    }
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = replay_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "can_replay",
+    };
+    esp_err_t err = esp_timer_create(&timer_args, &s_replay.timer);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    if (xTaskCreate(reader_task, "can_replay", REPLAY_TASK_STACK, NULL, REPLAY_TASK_PRIORITY,
+                    &s_replay.task) != pdPASS)
+    {
+        esp_timer_delete(s_replay.timer);
+        s_replay.timer = NULL;
+        ESP_LOGE(TAG, "Failed to create reader task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t can_replay_start(const char *path, const can_replay_options_t *opts)
+{
+    if (!s_replay.task || !path || can_replay_is_running())
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // A previous replay's file is closed by the reader task; wait for it
+    while (s_replay.file)
+    {
+        vTaskDelay(1);
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        ESP_LOGW(TAG, "Cannot open %s", path);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    uint8_t header[CAN_BIN_HEADER_SIZE];
+    if (fread(header, 1, sizeof(header), f) != sizeof(header) ||
+        !can_replay_core_check_header(header, sizeof(header)))
+    {
+        fclose(f);
+        ESP_LOGW(TAG, "%s is not a CANBIN v1 file", path);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    int64_t start_us = esp_timer_get_time() + REPLAY_START_DELAY_US;
+    can_replay_core_init(&s_replay.core, opts, start_us);
+    s_replay.file = f;
+    s_replay.reader_done = false;
+    s_replay.slot = 0;
+    s_replay.pos = 0;
+    s_replay.have_due = false;
+
+    // First buffer now; the reader fills the second while it plays
+    fill_slot(&s_replay.slots[0]);
+    s_replay.slots[0].state = SLOT_FULL;
+    for (uint32_t i = 1; i < REPLAY_SLOTS; i++)
+    {
+        s_replay.slots[i].state = SLOT_EMPTY;
+    }
+
+    __atomic_store_n(&s_replay.running, true, __ATOMIC_RELEASE);
+    xTaskNotify(s_replay.task, REPLAY_NOTIFY_FILL, eSetBits);
+    esp_timer_start_once(s_replay.timer, REPLAY_START_DELAY_US);
+
+    ESP_LOGI(TAG, "Replaying %s at %u%%%s, %u ID filter(s)", path,
+             (unsigned)(s_replay.core.opts.speed_permille / 10),
+             s_replay.core.opts.loop ? ", looping" : "",
+             (unsigned)s_replay.core.opts.filter_count);
+    return ESP_OK;
+}
+
+void can_replay_stop(void)
+{
+    if (!__atomic_exchange_n(&s_replay.running, false, __ATOMIC_ACQ_REL))
+    {
+        return;
+    }
+
+    // A callback already in flight sees running == false and returns
+    esp_timer_stop(s_replay.timer);
+    xTaskNotify(s_replay.task, REPLAY_NOTIFY_CLOSE, eSetBits);
+    ESP_LOGI(TAG, "Replay stopped");
+}
+
+bool can_replay_is_running(void)
+{
+    return __atomic_load_n(&s_replay.running, __ATOMIC_ACQUIRE);
+}
+
+void can_replay_get_stats(can_replay_stats_t *out)
+{
+    if (!out)
+    {
+        return;
+    }
+
+    // Single writer (the timer callback); a copy may be slightly torn
+    memcpy(out, &s_replay.core.stats, sizeof(*out));
+}
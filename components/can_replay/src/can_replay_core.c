@@ -0,0 +1,152 @@
+/*
+ * CAN Replay Core - Implementation
+ */
+
+#include "can_replay_core.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+bool can_replay_core_check_header(const uint8_t *data, size_t len)
+{
+    if (!data || len < CAN_BIN_HEADER_SIZE) {
+        return false;
+    }
+
+    can_bin_header_v1_t header;
+    memcpy(&header, data, sizeof(header));
+    return memcmp(header.magic, CAN_BIN_MAGIC, sizeof(header.magic)) == 0 &&
+           header.version == CAN_BIN_VERSION &&
+           header.header_size == CAN_BIN_HEADER_SIZE &&
+           header.record_size == CAN_BIN_RECORD_SIZE;
+}
+
+bool can_replay_core_parse_filter(const char *text, can_replay_options_t *opts)
+{
+    if (!opts) {
+        return false;
+    }
+
+    opts->filter_count = 0;
+    opts->filter_exclude = false;
+    if (!text) {
+        return true;
+    }
+
+    const char *p = text;
+    while (*p == ' ') {
+        p++;
+    }
+    if (*p == '!') {
+        opts->filter_exclude = true;
+        p++;
+    }
+
+    while (*p) {
+        if (*p == ',' || *p == ' ') {
+            p++;
+            continue;
+        }
+
+        char *end = NULL;
+        unsigned long id = strtoul(p, &end, 16);
+        if (end == p || id > 0x1FFFFFFFul || (*end && *end != ',' && *end != ' ')) {
+            return false;
+        }
+        if (opts->filter_count >= CAN_REPLAY_MAX_FILTER_IDS) {
+            return false;
+        }
+        opts->filter_ids[opts->filter_count++] = (uint32_t)id;
+        p = end;
+    }
+    return true;
+}
+
+void can_replay_core_init(can_replay_core_t *r, const can_replay_options_t *opts,
+                          int64_t start_us)
+{
+    memset(r, 0, sizeof(*r));
+    if (opts) {
+        r->opts = *opts;
+    }
+    if (r->opts.speed_permille == 0) {
+        r->opts.speed_permille = CAN_REPLAY_SPEED_REALTIME;
+    }
+    r->pass_start_us = start_us;
+    r->first_ts_us = -1;
+    r->last_due_us = start_us;
+}
+
+bool can_replay_core_accept(const can_replay_core_t *r, uint32_t id)
+{
+    if (r->opts.filter_count == 0) {
+        return true;
+    }
+
+    bool listed = false;
+    for (size_t i = 0; i < r->opts.filter_count; i++) {
+        if (r->opts.filter_ids[i] == id) {
+            listed = true;
+            break;
+        }
+    }
+    return listed != r->opts.filter_exclude;
+}
+
+bool can_replay_core_schedule(can_replay_core_t *r, const can_bin_record_v1_t *rec,
+                              int64_t *due_us)
+{
+    if (rec->flags & CAN_BIN_RECORD_FLAG_META) {
+        r->stats.meta_skipped++;
+        return false;
+    }
+    if (!can_replay_core_accept(r, rec->can_id)) {
+        r->stats.frames_filtered++;
+        return false;
+    }
+
+    int64_t ts = (int64_t)rec->timestamp_us;
+    if (r->first_ts_us < 0) {
+        r->first_ts_us = ts;
+    }
+
+    int64_t offset = ts - r->first_ts_us;
+    int64_t due = r->pass_start_us +
+                  (offset > 0 ? offset * CAN_REPLAY_SPEED_REALTIME / r->opts.speed_permille : 0);
+
+    // Never reorder: a timestamp that steps back is sent right after its predecessor
+    if (due < r->last_due_us) {
+        due = r->last_due_us;
+    }
+    r->last_due_us = due;
+    *due_us = due;
+    return true;
+}
+
+void can_replay_core_sent(can_replay_core_t *r, int64_t due_us, int64_t sent_us, bool ok)
+{
+    if (!ok) {
+        r->stats.tx_errors++;
+        return;
+    }
+
+    r->stats.frames_sent++;
+    int64_t late = sent_us - due_us;
+    if (late < 0 && -late > r->stats.max_early_us) {
+        r->stats.max_early_us = (int32_t)(-late > INT32_MAX ? INT32_MAX : -late);
+    }
+    can_latency_hist_record(&r->stats.lateness, late);
+}
+
+bool can_replay_core_end_pass(can_replay_core_t *r)
+{
+    r->stats.passes++;
+    if (!r->opts.loop) {
+        return false;
+    }
+
+    r->pass_start_us = r->last_due_us + r->opts.loop_gap_us;
+    r->last_due_us = r->pass_start_us;
+    r->first_ts_us = -1;
+    return true;
+}
@@ -0,0 +1,80 @@
+/*
+ * CAN Live Stream
+ *
+ * Sends every received frame over a UART or USB-CDC link while the car is
+ * running, beside the SD logger. The RX task encodes each frame into a
+ * COBS packet (can_stream_codec.h) and queues it on a dedicated TX ring;
+ * a low-priority task drains the ring in batches to the link. When the
+ * link cannot keep up, frames are dropped at the ring and counted, never
+ * blocking reception. A status packet with the drop counters goes out
+ * once a second.
+ *
+ * analysis/can_stream_rx.py decodes the stream on the host and republishes
+ * it as SLCAN on a pty for SavvyCAN and other tools.
+ *
+ * Disabled unless a transport is chosen in menuconfig ("CAN Live Stream").
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "mem_plan.h"
+#include "can_stream_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t frames_offered;   // Frames passed to can_stream_push()
+    uint32_t frames_dropped;   // Not queued (ring full)
+    uint32_t link_errors;      // Failed or short transport writes
+    uint32_t bytes_sent;
+    uint32_t ring_high_water;  // Most bytes queued at once
+} can_stream_stats_t;
+
+/**
+ * @brief Add the TX ring to the boot memory plan
+ *
+ * @param budget Budget to add to
+ */
+void can_stream_plan_memory(mem_plan_budget_t *budget);
+
+/**
+ * @brief Set up the link and start the TX task
+ *
+ * @return ESP_OK on success (or when no transport is configured),
+ *         an error from the driver or ESP_ERR_NO_MEM otherwise
+ */
+esp_err_t can_stream_init(void);
+
+/**
+ * @brief Whether frames are being streamed
+ *
+ * @return true once can_stream_init() has started the link
+ */
+bool can_stream_is_enabled(void);
+
+/**
+ * @brief Queue a received frame (CAN RX task only, never blocks)
+ *
+ * @param timestamp_us RX time
+ * @param id CAN ID with CAN_STREAM_ID_* flags
+ * @param dlc Data length
+ * @param data Payload
+ */
+void can_stream_push(int64_t timestamp_us, uint32_t id, uint8_t dlc, const uint8_t *data);
+
+/**
+ * @brief Copy the stream counters
+ *
+ * @param out Filled with the counters
+ */
+void can_stream_get_stats(can_stream_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
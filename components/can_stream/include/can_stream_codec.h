@@ -0,0 +1,128 @@
+/*
+ * CAN Stream Codec
+ *
+ * Wire format of the live frame stream. Each packet is
+ *
+ *   uint8  type        CAN_STREAM_PKT_*
+ *   ...    body        (see below, little-endian)
+ *   uint16 crc         CRC-16/CCITT-FALSE over type and body
+ *
+ * COBS-encoded and terminated by a 0x00 byte, so a receiver that starts
+ * mid-stream or loses bytes resynchronises at the next delimiter.
+ *
+ * Frame body:  uint16 seq, uint32 timestamp_us (low 32 bits of
+ *              esp_timer), uint32 id (| CAN_STREAM_ID_EXTENDED /
+ *              CAN_STREAM_ID_RTR), uint8 dlc, dlc data bytes
+ * Status body: uint16 seq (next frame seq), uint32 frames_dropped,
+ *              uint32 link_errors
+ *
+ * The sequence number counts every frame offered to the stream, sent or
+ * not, so a gap on the host is exactly the number of frames lost.
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_STREAM_PKT_FRAME   0x01
+#define CAN_STREAM_PKT_STATUS  0x02
+
+#define CAN_STREAM_ID_EXTENDED (1u << 31)
+#define CAN_STREAM_ID_RTR      (1u << 30)
+#define CAN_STREAM_ID_MASK     0x1FFFFFFFu
+
+// Largest unencoded packet (frame with 8 data bytes)
+#define CAN_STREAM_MAX_RAW     (1 + 2 + 4 + 4 + 1 + 8 + 2)
+// Largest packet on the wire: COBS adds one byte per 254, plus the delimiter
+#define CAN_STREAM_MAX_WIRE    (CAN_STREAM_MAX_RAW + 1 + 1)
+
+typedef struct {
+    uint8_t type;
+    uint16_t seq;
+    // CAN_STREAM_PKT_FRAME
+    uint32_t timestamp_us;
+    uint32_t id;            // Including CAN_STREAM_ID_* flags
+    uint8_t dlc;
+    uint8_t data[8];
+    // CAN_STREAM_PKT_STATUS
+    uint32_t frames_dropped;
+    uint32_t link_errors;
+} can_stream_packet_t;
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+ *
+ * @param data Bytes
+ * @param len Number of bytes
+ * @return CRC
+ */
+uint16_t can_stream_crc16(const uint8_t *data, size_t len);
+
+/**
+ * @brief COBS-encode a buffer (no delimiter is appended)
+ *
+ * @param in Input bytes
+ * @param len Input length
+ * @param out Output, at least len + len / 254 + 1 bytes
+ * @return Encoded length
+ */
+size_t can_stream_cobs_encode(const uint8_t *in, size_t len, uint8_t *out);
+
+/**
+ * @brief Decode one COBS block (without its delimiter)
+ *
+ * @param in Encoded bytes
+ * @param len Encoded length
+ * @param out Output, at least len bytes
+ * @param out_len Filled with the decoded length
+ * @return true on success, false if the block is malformed
+ */
+bool can_stream_cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t *out_len);
+
+/**
+ * @brief Encode a frame packet ready to send, delimiter included
+ *
+ * @param seq Sequence number
+ * @param timestamp_us RX time
+ * @param id CAN ID with CAN_STREAM_ID_* flags
+ * @param dlc Data length (clamped to 8)
+ * @param data Payload (dlc bytes)
+ * @param out Output, at least CAN_STREAM_MAX_WIRE bytes
+ * @return Bytes written
+ */
+size_t can_stream_encode_frame(uint16_t seq, uint32_t timestamp_us, uint32_t id, uint8_t dlc,
+                               const uint8_t *data, uint8_t *out);
+
+/**
+ * @brief Encode a status packet ready to send, delimiter included
+ *
+ * @param seq Sequence number the next frame will carry
+ * @param frames_dropped Frames not sent since start
+ * @param link_errors Failed or short transport writes since start
+ * @param out Output, at least CAN_STREAM_MAX_WIRE bytes
+ * @return Bytes written
+ */
+size_t can_stream_encode_status(uint16_t seq, uint32_t frames_dropped, uint32_t link_errors,
+                                uint8_t *out);
+
+/**
+ * @brief Decode one packet (COBS block without its delimiter)
+ *
+ * @param in Encoded bytes
+ * @param len Encoded length
+ * @param out Filled with the packet
+ * @return true on success, false on a malformed packet or CRC mismatch
+ */
+bool can_stream_decode(const uint8_t *in, size_t len, can_stream_packet_t *out);
+
+#ifdef __cplusplus
+}
+#endif
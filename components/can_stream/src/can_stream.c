@@ -0,0 +1,266 @@
+/*
+ * CAN Live Stream Implementation
+ */
+
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/ringbuf.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#if CONFIG_CAN_STREAM_TRANSPORT_UART
+#include <driver/uart.h>
+#elif CONFIG_CAN_STREAM_TRANSPORT_USB_SERIAL_JTAG
+#include <driver/usb_serial_jtag.h>
+#endif
+
+#include "can_stream.h"
+
+static const char *TAG = "can_stream";
+
+#if CONFIG_CAN_STREAM_TRANSPORT_UART || CONFIG_CAN_STREAM_TRANSPORT_USB_SERIAL_JTAG
+#define CAN_STREAM_ENABLED 1
+#define STREAM_RING_BYTES ((CONFIG_CAN_STREAM_RING_BYTES + 3) & ~3)
+#else
+#define CAN_STREAM_ENABLED 0
+#endif
+
+#define STREAM_BATCH_BYTES 1024            // One transport write
+#define STREAM_LINK_TX_BUFFER 4096         // Driver-side TX buffer
+#define STREAM_STATUS_INTERVAL_US 1000000
+#define STREAM_TASK_STACK 3072
+
+// Module state
+static struct {
+    RingbufHandle_t ring;
+    uint8_t *ring_storage;
+    StaticRingbuffer_t *ring_struct;
+    TaskHandle_t task;
+    uint16_t seq;                       // RX task only
+    can_stream_stats_t stats;           // Each counter has a single writer
+    uint8_t batch[STREAM_BATCH_BYTES];  // TX task only
+} s_stream = {
+    .ring = NULL,
+    .ring_storage = NULL,
+    .ring_struct = NULL,
+    .task = NULL,
+    .seq = 0
+};
+
+#if CAN_STREAM_ENABLED
+
+static esp_err_t link_init(void)
+{
+#if CONFIG_CAN_STREAM_TRANSPORT_UART
+    if (CONFIG_CAN_STREAM_UART_TX_GPIO < 0)
+    {
+        ESP_LOGE(TAG, "No UART TX GPIO configured");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uart_config_t uart_config = {
+        .baud_rate = CONFIG_CAN_STREAM_UART_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+
+    // The RX buffer only has to exceed the hardware FIFO; nothing is read
+    esp_err_t err = uart_driver_install(CONFIG_CAN_STREAM_UART_NUM, 256,
+                                        STREAM_LINK_TX_BUFFER, 0, NULL, 0);
+    if (err == ESP_OK)
+    {
+        err = uart_param_config(CONFIG_CAN_STREAM_UART_NUM, &uart_config);
+    }
+    if (err == ESP_OK)
+    {
+        err = uart_set_pin(CONFIG_CAN_STREAM_UART_NUM, CONFIG_CAN_STREAM_UART_TX_GPIO,
+                           UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    }
+    return err;
+#else
+    usb_serial_jtag_driver_config_t usb_config = {
+        .tx_buffer_size = STREAM_LINK_TX_BUFFER,
+        .rx_buffer_size = 256,
+    };
+    return usb_serial_jtag_driver_install(&usb_config);
+#endif
+}
+
+// Returns false on a failed or short write
+static bool link_write(const uint8_t *data, size_t len)
+{
+#if CONFIG_CAN_STREAM_TRANSPORT_UART
+    int written = uart_write_bytes(CONFIG_CAN_STREAM_UART_NUM, data, len);
+#else
+    // Without a host reading, writes time out instead of blocking the task
+    int written = usb_serial_jtag_write_bytes(data, len, pdMS_TO_TICKS(20));
+#endif
+    if (written > 0)
+    {
+        __atomic_fetch_add(&s_stream.stats.bytes_sent, (uint32_t)written, __ATOMIC_RELAXED);
+    }
+    return written == (int)len;
+}
+
+static void stream_task(void *arg)
+{
+    RingbufHandle_t ring = (RingbufHandle_t)arg;
+    int64_t last_status_us = 0;
+
+    while (1)
+    {
+        size_t len = 0;
+        size_t item_size = 0;
+        uint8_t *item = xRingbufferReceive(ring, &item_size, pdMS_TO_TICKS(100));
+
+        if (item)
+        {
+            uint32_t used = STREAM_RING_BYTES - (uint32_t)xRingbufferGetCurFreeSize(ring);
+            if (used > s_stream.stats.ring_high_water)
+            {
+                s_stream.stats.ring_high_water = used;
+            }
+        }
+
+        // Batch whole packets so the link sees few, large writes
+        while (item)
+        {
+            memcpy(s_stream.batch + len, item, item_size);
+            len += item_size;
+            vRingbufferReturnItem(ring, item);
+            if (len + CAN_STREAM_MAX_WIRE > sizeof(s_stream.batch))
+            {
+                break;
+            }
+            item = xRingbufferReceive(ring, &item_size, 0);
+        }
+
+        int64_t now_us = esp_timer_get_time();
+        if (now_us - last_status_us >= STREAM_STATUS_INTERVAL_US &&
+            len + CAN_STREAM_MAX_WIRE <= sizeof(s_stream.batch))
+        {
+            uint16_t next_seq = (uint16_t)__atomic_load_n(&s_stream.stats.frames_offered,
+                                                          __ATOMIC_RELAXED);
+            len += can_stream_encode_status(
+                next_seq,
+                __atomic_load_n(&s_stream.stats.frames_dropped, __ATOMIC_RELAXED),
+                __atomic_load_n(&s_stream.stats.link_errors, __ATOMIC_RELAXED),
+                s_stream.batch + len);
+            last_status_us = now_us;
+        }
+
+        if (len > 0 && !link_write(s_stream.batch, len))
+        {
+            __atomic_fetch_add(&s_stream.stats.link_errors, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+#endif // CAN_STREAM_ENABLED
+
+void can_stream_plan_memory(mem_plan_budget_t *budget)
+{
+#if CAN_STREAM_ENABLED
+    mem_plan_budget_add(budget, MEM_REGION_PSRAM, STREAM_RING_BYTES, 4);
+    mem_plan_budget_add(budget, MEM_REGION_INTERNAL, sizeof(StaticRingbuffer_t), 4);
+#else
+    (void)budget;
+#endif
+}
+
+esp_err_t can_stream_init(void)
+{
+#if CAN_STREAM_ENABLED
+    if (s_stream.task)
+    {
+        return ESP_OK;
+    }
+
+    s_stream.ring_storage = mem_plan_alloc(MEM_REGION_PSRAM, STREAM_RING_BYTES, 4,
+                                           "stream ring");
+    s_stream.ring_struct = mem_plan_alloc(MEM_REGION_INTERNAL, sizeof(StaticRingbuffer_t), 4,
+                                          "stream ring ctl");
+    if (!s_stream.ring_storage || !s_stream.ring_struct)
+    {
+        ESP_LOGE(TAG, "TX ring missing from the memory plan");
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t err = link_init();
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Link setup failed: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    RingbufHandle_t ring = xRingbufferCreateStatic(STREAM_RING_BYTES, RINGBUF_TYPE_NOSPLIT,
+                                                   s_stream.ring_storage, s_stream.ring_struct);
+    if (!ring)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Publish the ring last: can_stream_push() checks it without a lock
+    if (xTaskCreate(stream_task, "can_stream", STREAM_TASK_STACK, ring,
+                    CONFIG_CAN_STREAM_TASK_PRIORITY, &s_stream.task) != pdPASS)
+    {
+        vRingbufferDelete(ring);
+        ESP_LOGE(TAG, "Failed to create stream task");
+        return ESP_ERR_NO_MEM;
+    }
+    __atomic_store_n(&s_stream.ring, ring, __ATOMIC_RELEASE);
+
+#if CONFIG_CAN_STREAM_TRANSPORT_UART
+    ESP_LOGI(TAG, "Streaming on UART%d (TX GPIO %d, %d baud)", CONFIG_CAN_STREAM_UART_NUM,
+             CONFIG_CAN_STREAM_UART_TX_GPIO, CONFIG_CAN_STREAM_UART_BAUD);
+#else
+    ESP_LOGI(TAG, "Streaming on USB Serial/JTAG");
+#endif
+    return ESP_OK;
+#else
+    return ESP_OK;
+#endif
+}
+
+bool can_stream_is_enabled(void)
+{
+    return __atomic_load_n(&s_stream.ring, __ATOMIC_ACQUIRE) != NULL;
+}
+
+void can_stream_push(int64_t timestamp_us, uint32_t id, uint8_t dlc, const uint8_t *data)
+{
+    RingbufHandle_t ring = __atomic_load_n(&s_stream.ring, __ATOMIC_ACQUIRE);
+    if (!ring)
+    {
+        return;
+    }
+
+    uint8_t wire[CAN_STREAM_MAX_WIRE];
+    size_t len = can_stream_encode_frame(s_stream.seq++, (uint32_t)timestamp_us, id, dlc,
+                                         data, wire);
+    __atomic_fetch_add(&s_stream.stats.frames_offered, 1, __ATOMIC_RELAXED);
+
+    if (xRingbufferSend(ring, wire, len, 0) != pdTRUE)
+    {
+        __atomic_fetch_add(&s_stream.stats.frames_dropped, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void can_stream_get_stats(can_stream_stats_t *out)
+{
+    if (!out)
+    {
+        return;
+    }
+
+    out->frames_offered = __atomic_load_n(&s_stream.stats.frames_offered, __ATOMIC_RELAXED);
+    out->frames_dropped = __atomic_load_n(&s_stream.stats.frames_dropped, __ATOMIC_RELAXED);
+    out->link_errors = __atomic_load_n(&s_stream.stats.link_errors, __ATOMIC_RELAXED);
+    out->bytes_sent = __atomic_load_n(&s_stream.stats.bytes_sent, __ATOMIC_RELAXED);
+    out->ring_high_water = __atomic_load_n(&s_stream.stats.ring_high_water, __ATOMIC_RELAXED);
+}
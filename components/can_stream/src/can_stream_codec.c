@@ -0,0 +1,170 @@
+/*
+ * CAN Stream Codec - Implementation
+ */
+
+#include "can_stream_codec.h"
+
+#include <string.h>
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+           ((uint32_t)p[3] << 24);
+}
+
+uint16_t can_stream_crc16(const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t can_stream_cobs_encode(const uint8_t *in, size_t len, uint8_t *out)
+{
+    size_t code_pos = 0;
+    size_t out_pos = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] != 0) {
+            out[out_pos++] = in[i];
+            code++;
+        }
+        if (in[i] == 0 || code == 0xFF) {
+            out[code_pos] = code;
+            code_pos = out_pos++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+    return out_pos;
+}
+
+bool can_stream_cobs_decode(const uint8_t *in, size_t len, uint8_t *out, size_t *out_len)
+{
+    size_t out_pos = 0;
+    size_t i = 0;
+
+    while (i < len) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len) {
+            return false;
+        }
+        for (uint8_t j = 1; j < code; j++) {
+            if (in[i] == 0) {
+                return false;
+            }
+            out[out_pos++] = in[i++];
+        }
+        // A full block (0xFF) carries no implied zero; neither does the last
+        if (code != 0xFF && i < len) {
+            out[out_pos++] = 0;
+        }
+    }
+
+    *out_len = out_pos;
+    return true;
+}
+
+// Append the CRC, COBS-encode and terminate
+static size_t finish_packet(uint8_t *raw, size_t len, uint8_t *out)
+{
+    put_le16(raw + len, can_stream_crc16(raw, len));
+    size_t n = can_stream_cobs_encode(raw, len + 2, out);
+    out[n++] = 0;
+    return n;
+}
+
+size_t can_stream_encode_frame(uint16_t seq, uint32_t timestamp_us, uint32_t id, uint8_t dlc,
+                               const uint8_t *data, uint8_t *out)
+{
+    uint8_t raw[CAN_STREAM_MAX_RAW];
+    if (dlc > 8) {
+        dlc = 8;
+    }
+
+    raw[0] = CAN_STREAM_PKT_FRAME;
+    put_le16(raw + 1, seq);
+    put_le32(raw + 3, timestamp_us);
+    put_le32(raw + 7, id);
+    raw[11] = dlc;
+    if (dlc > 0) {
+        memcpy(raw + 12, data, dlc);
+    }
+    return finish_packet(raw, 12 + (size_t)dlc, out);
+}
+
+size_t can_stream_encode_status(uint16_t seq, uint32_t frames_dropped, uint32_t link_errors,
+                                uint8_t *out)
+{
+    uint8_t raw[CAN_STREAM_MAX_RAW];
+
+    raw[0] = CAN_STREAM_PKT_STATUS;
+    put_le16(raw + 1, seq);
+    put_le32(raw + 3, frames_dropped);
+    put_le32(raw + 7, link_errors);
+    return finish_packet(raw, 11, out);
+}
+
+bool can_stream_decode(const uint8_t *in, size_t len, can_stream_packet_t *out)
+{
+    uint8_t raw[CAN_STREAM_MAX_WIRE];
+    size_t raw_len = 0;
+
+    if (!in || !out || len > sizeof(raw) || !can_stream_cobs_decode(in, len, raw, &raw_len)) {
+        return false;
+    }
+    if (raw_len < 3 + 2 || get_le16(raw + raw_len - 2) != can_stream_crc16(raw, raw_len - 2)) {
+        return false;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->type = raw[0];
+    out->seq = get_le16(raw + 1);
+    size_t body_len = raw_len - 2;
+
+    switch (out->type) {
+        case CAN_STREAM_PKT_FRAME:
+            if (body_len < 12 || raw[11] > 8 || body_len != 12 + (size_t)raw[11]) {
+                return false;
+            }
+            out->timestamp_us = get_le32(raw + 3);
+            out->id = get_le32(raw + 7);
+            out->dlc = raw[11];
+            memcpy(out->data, raw + 12, out->dlc);
+            return true;
+        case CAN_STREAM_PKT_STATUS:
+            if (body_len != 11) {
+                return false;
+            }
+            out->frames_dropped = get_le32(raw + 3);
+            out->link_errors = get_le32(raw + 7);
+            return true;
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * CAN Supervisor
+ *
+ * Watches the TWAI controller through driver alerts and keeps it on the
+ * bus. A task blocks in twai_read_alerts(); on every alert (and at least
+ * once a second) it reads the controller status, feeds it to a
+ * can_supervisor_core_t and carries out what the core asks for:
+ * twai_initiate_recovery() once the bus-off backoff has elapsed, then
+ * twai_start() when the driver reports the bus recovered. A bus glitch
+ * costs the recovery time plus the backoff instead of the rest of the
+ * drive.
+ *
+ * Every state change is logged to the console, queued to the CANBIN log
+ * as a CAN_BIN_EVENT_BUS_STATE event and reported through the change
+ * callback. can_supervisor_poll_scale() tells the OBD poller how far to
+ * back off while the error counters are high.
+ *
+ * The driver must be installed with CAN_SUPERVISOR_ALERTS enabled.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "driver/twai.h"
+#include "can_supervisor_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Alerts to enable in twai_general_config_t.alerts_enabled
+#define CAN_SUPERVISOR_ALERTS (TWAI_ALERT_ABOVE_ERR_WARN | TWAI_ALERT_BELOW_ERR_WARN | \
+                               TWAI_ALERT_ERR_ACTIVE | TWAI_ALERT_ERR_PASS |              \
+                               TWAI_ALERT_BUS_OFF | TWAI_ALERT_RECOVERY_IN_PROGRESS |     \
+                               TWAI_ALERT_BUS_RECOVERED | TWAI_ALERT_RX_QUEUE_FULL)
+
+/**
+ * @brief Called from the supervisor task after a state change
+ *
+ * @param prev Previous state
+ * @param state New state
+ * @param ctx Context given to can_supervisor_init()
+ */
+typedef void (*can_supervisor_change_cb_t)(can_supervisor_state_t prev,
+                                           can_supervisor_state_t state, void *ctx);
+
+/**
+ * @brief Start supervising the installed TWAI driver
+ *
+ * @param on_change State change callback (may be NULL)
+ * @param ctx Passed to on_change
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the task cannot be created
+ */
+esp_err_t can_supervisor_init(can_supervisor_change_cb_t on_change, void *ctx);
+
+/**
+ * @brief Hold off recovery while the user has paused CAN
+ *
+ * A bus-off recovery that falls due while paused is started on the next
+ * supervisor pass after resuming (the driver cannot start a bus-off
+ * controller, so resuming alone does not bring it back).
+ *
+ * @param paused true while the controller is stopped on purpose
+ */
+void can_supervisor_set_paused(bool paused);
+
+/**
+ * @brief Current supervised state
+ *
+ * @return State (CAN_SUPERVISOR_STOPPED before init)
+ */
+can_supervisor_state_t can_supervisor_get_state(void);
+
+/**
+ * @brief OBD poll interval multiplier (see can_supervisor_core_poll_scale())
+ *
+ * @return 1, 2 or 4, or 0 to hold requests (1 before init)
+ */
+uint32_t can_supervisor_poll_scale(void);
+
+/**
+ * @brief Copy the supervisor counters
+ *
+ * @param out Filled with the counters
+ */
+void can_supervisor_get_stats(can_supervisor_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
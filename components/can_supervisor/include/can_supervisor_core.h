@@ -0,0 +1,159 @@
+/*
+ * CAN Supervisor Core
+ *
+ * Error-state tracking and bus-off recovery policy for the CAN controller.
+ * The caller feeds a snapshot of the controller (driver state and error
+ * counters) whenever an alert arrives or a deadline passes; the core
+ * classifies it, counts transitions and says when to act:
+ *
+ *   BUS_OFF --(backoff elapsed)--> RECOVER --(recovered, stopped)--> START
+ *
+ * The backoff doubles for each bus-off that follows the previous recovery
+ * within the stable window, so a bus that keeps failing is not hammered,
+ * while a one-off glitch is back within the base delay.
+ *
+ * It also derives how hard the OBD poller may drive the bus: full rate
+ * while error-active, slower as the error counters climb, and not at all
+ * while the controller is offline.
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAN_SUPERVISOR_WARN_LIMIT 96        // Error-warning threshold (TEC/REC)
+#define CAN_SUPERVISOR_PASSIVE_LIMIT 128    // Error-passive threshold (TEC/REC)
+
+// Controller state as reported by the driver
+typedef enum {
+    CAN_SUPERVISOR_CTRL_STOPPED = 0,
+    CAN_SUPERVISOR_CTRL_RUNNING,
+    CAN_SUPERVISOR_CTRL_BUS_OFF,
+    CAN_SUPERVISOR_CTRL_RECOVERING
+} can_supervisor_ctrl_t;
+
+// Supervised bus state
+typedef enum {
+    CAN_SUPERVISOR_STOPPED = 0,
+    CAN_SUPERVISOR_ERROR_ACTIVE,
+    CAN_SUPERVISOR_ERROR_WARNING,
+    CAN_SUPERVISOR_ERROR_PASSIVE,
+    CAN_SUPERVISOR_BUS_OFF,
+    CAN_SUPERVISOR_RECOVERING,
+    CAN_SUPERVISOR_STATE_COUNT
+} can_supervisor_state_t;
+
+typedef enum {
+    CAN_SUPERVISOR_ACTION_NONE = 0,
+    CAN_SUPERVISOR_ACTION_RECOVER,  // Start bus-off recovery now
+    CAN_SUPERVISOR_ACTION_START     // Recovery done: restart the controller
+} can_supervisor_action_t;
+
+typedef struct {
+    uint32_t backoff_min_us;    // Delay before the first recovery attempt
+    uint32_t backoff_max_us;    // Cap for the doubled delay
+    uint32_t stable_us;         // Running this long resets the backoff
+} can_supervisor_config_t;
+
+typedef struct {
+    can_supervisor_ctrl_t ctrl;
+    uint32_t tec;               // Transmit error counter
+    uint32_t rec;               // Receive error counter
+    uint32_t rx_queue_full;     // RX queue overflows since the last update
+} can_supervisor_status_t;
+
+typedef struct {
+    uint32_t transitions;
+    uint32_t bus_off_count;
+    uint32_t recoveries;        // Controller restarted after bus-off
+    uint32_t rx_queue_full;
+    uint32_t last_offline_us;   // Bus-off to restart, last recovery
+    uint32_t max_offline_us;
+    uint32_t max_tec;
+    uint32_t max_rec;
+} can_supervisor_stats_t;
+
+typedef struct {
+    can_supervisor_config_t config;
+    can_supervisor_state_t state;
+    uint32_t tec;
+    uint32_t rec;
+    uint32_t backoff_us;        // Delay used for the current or last bus-off
+    bool recovery_pending;      // Bus-off seen, controller not restarted yet
+    bool recovery_started;      // RECOVER issued for the current bus-off
+    bool paused;                // Controller held down by the user; no actions
+    int64_t offline_since_us;
+    int64_t recover_at_us;
+    int64_t running_since_us;   // Last restart after a bus-off
+    can_supervisor_stats_t stats;
+} can_supervisor_core_t;
+
+/**
+ * @brief Reset the supervisor
+ *
+ * @param core Supervisor state
+ * @param config Backoff settings (copied)
+ */
+void can_supervisor_core_init(can_supervisor_core_t *core, const can_supervisor_config_t *config);
+
+/**
+ * @brief Feed a controller snapshot
+ *
+ * @param core Supervisor state
+ * @param status Controller state and error counters
+ * @param now_us Current time
+ * @return Action the caller should take now
+ */
+can_supervisor_action_t can_supervisor_core_update(can_supervisor_core_t *core,
+                                                   const can_supervisor_status_t *status,
+                                                   int64_t now_us);
+
+/**
+ * @brief Hold or release the controller on the user's behalf
+ *
+ * While paused, updates keep tracking state but return no action, so a
+ * recovery that falls due is not consumed; the first update after
+ * resuming issues it.
+ *
+ * @param core Supervisor state
+ * @param paused true to withhold actions
+ */
+void can_supervisor_core_set_paused(can_supervisor_core_t *core, bool paused);
+
+/**
+ * @brief Time until the next update is needed to act on a deadline
+ *
+ * @param core Supervisor state
+ * @param now_us Current time
+ * @return Microseconds until a pending recovery is due, or -1 if none
+ *         (or paused)
+ */
+int64_t can_supervisor_core_next_deadline_us(const can_supervisor_core_t *core, int64_t now_us);
+
+/**
+ * @brief OBD poll interval multiplier for the current state
+ *
+ * @param core Supervisor state
+ * @return 1 at full rate, 2 at error-warning, 4 at error-passive,
+ *         0 while requests must be held (offline or stopped)
+ */
+uint32_t can_supervisor_core_poll_scale(const can_supervisor_core_t *core);
+
+/**
+ * @brief Short name of a state ("active", "bus_off", ...)
+ *
+ * @param state State
+ * @return Static string
+ */
+const char *can_supervisor_state_name(can_supervisor_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
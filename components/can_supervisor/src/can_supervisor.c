@@ -0,0 +1,213 @@
+/*
+ * CAN Supervisor Implementation
+ */
+
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "can_bin_format.h"
+#include "can_logger.h"
+#include "can_supervisor.h"
+
+static const char *TAG = "can_supervisor";
+
+#define SUPERVISOR_IDLE_POLL_MS 1000    // Status refresh without alerts
+#define SUPERVISOR_STOPPED_POLL_MS 100  // Starting the controller raises no alert
+#define SUPERVISOR_TASK_STACK 3072
+#define SUPERVISOR_TASK_PRIORITY 6      // Above the CAN tasks it unblocks
+
+// Module state
+static struct {
+    can_supervisor_core_t core;         // Supervisor task only, under lock for copies
+    portMUX_TYPE lock;
+    TaskHandle_t task;
+    can_supervisor_change_cb_t on_change;
+    void *ctx;
+    uint8_t state;                      // Published can_supervisor_state_t
+    uint8_t poll_scale;
+} s_sup = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+    .task = NULL,
+    .on_change = NULL,
+    .ctx = NULL,
+    .state = CAN_SUPERVISOR_STOPPED,
+    .poll_scale = 0
+};
+
+static can_supervisor_ctrl_t ctrl_from_twai(twai_state_t state)
+{
+    switch (state)
+    {
+        case TWAI_STATE_RUNNING:
+            return CAN_SUPERVISOR_CTRL_RUNNING;
+        case TWAI_STATE_BUS_OFF:
+            return CAN_SUPERVISOR_CTRL_BUS_OFF;
+        case TWAI_STATE_RECOVERING:
+            return CAN_SUPERVISOR_CTRL_RECOVERING;
+        default:
+            return CAN_SUPERVISOR_CTRL_STOPPED;
+    }
+}
+
+static void report_change(can_supervisor_state_t prev, can_supervisor_state_t state,
+                          uint32_t tec, uint32_t rec, int64_t now_us)
+{
+    if (state == CAN_SUPERVISOR_BUS_OFF || state == CAN_SUPERVISOR_ERROR_PASSIVE)
+    {
+        ESP_LOGW(TAG, "%s -> %s (tec=%u rec=%u, backoff %u ms)",
+                 can_supervisor_state_name(prev), can_supervisor_state_name(state),
+                 (unsigned)tec, (unsigned)rec, (unsigned)(s_sup.core.backoff_us / 1000));
+    }
+    else
+    {
+        ESP_LOGI(TAG, "%s -> %s (tec=%u rec=%u)", can_supervisor_state_name(prev),
+                 can_supervisor_state_name(state), (unsigned)tec, (unsigned)rec);
+    }
+
+    can_bin_event_v1_t ev = {
+        .source = (uint16_t)state,
+        .kind = CAN_BIN_EVENT_BUS_STATE,
+        .severity = (uint8_t)prev,
+        .value = (float)(tec > rec ? tec : rec)
+    };
+    // Not logging (or ring full) just means no record
+    (void)can_logger_log_meta(now_us, CAN_BIN_META_EVENT, &ev, sizeof(ev));
+
+    if (s_sup.on_change)
+    {
+        s_sup.on_change(prev, state, s_sup.ctx);
+    }
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    while (1)
+    {
+        int64_t deadline_us = can_supervisor_core_next_deadline_us(&s_sup.core,
+                                                                   esp_timer_get_time());
+        TickType_t wait = pdMS_TO_TICKS(s_sup.core.state == CAN_SUPERVISOR_STOPPED
+                                            ? SUPERVISOR_STOPPED_POLL_MS
+                                            : SUPERVISOR_IDLE_POLL_MS);
+        if (deadline_us >= 0)
+        {
+            wait = pdMS_TO_TICKS(deadline_us / 1000) + 1;
+        }
+
+        uint32_t alerts = 0;
+        (void)twai_read_alerts(&alerts, wait);
+
+        twai_status_info_t info = {0};
+        if (twai_get_status_info(&info) != ESP_OK)
+        {
+            continue;
+        }
+
+        can_supervisor_status_t status = {
+            .ctrl = ctrl_from_twai(info.state),
+            .tec = info.tx_error_counter,
+            .rec = info.rx_error_counter,
+            .rx_queue_full = (alerts & TWAI_ALERT_RX_QUEUE_FULL) ? 1 : 0
+        };
+
+        int64_t now_us = esp_timer_get_time();
+        can_supervisor_state_t prev = s_sup.core.state;
+
+        portENTER_CRITICAL(&s_sup.lock);
+        can_supervisor_action_t action = can_supervisor_core_update(&s_sup.core, &status, now_us);
+        portEXIT_CRITICAL(&s_sup.lock);
+
+        can_supervisor_state_t state = s_sup.core.state;
+        __atomic_store_n(&s_sup.state, (uint8_t)state, __ATOMIC_RELEASE);
+        __atomic_store_n(&s_sup.poll_scale, (uint8_t)can_supervisor_core_poll_scale(&s_sup.core),
+                         __ATOMIC_RELEASE);
+
+        if (state != prev)
+        {
+            report_change(prev, state, status.tec, status.rec, now_us);
+        }
+
+        // A paused controller stays down: the core withholds actions, and
+        // a recovery that fell due meanwhile is issued after resuming
+        if (action == CAN_SUPERVISOR_ACTION_RECOVER)
+        {
+            esp_err_t err = twai_initiate_recovery();
+            if (err != ESP_OK)
+            {
+                ESP_LOGW(TAG, "Bus-off recovery failed to start: %s", esp_err_to_name(err));
+            }
+        }
+        else if (action == CAN_SUPERVISOR_ACTION_START)
+        {
+            esp_err_t err = twai_start();
+            if (err != ESP_OK)
+            {
+                ESP_LOGW(TAG, "Restart after recovery failed: %s", esp_err_to_name(err));
+            }
+        }
+    }
+}
+
+esp_err_t can_supervisor_init(can_supervisor_change_cb_t on_change, void *ctx)
+{
+    if (s_sup.task)
+    {
+        return ESP_OK;
+    }
+
+    const can_supervisor_config_t config = {
+        .backoff_min_us = CONFIG_CAN_SUPERVISOR_BACKOFF_MIN_MS * 1000u,
+        .backoff_max_us = CONFIG_CAN_SUPERVISOR_BACKOFF_MAX_MS * 1000u,
+        .stable_us = CONFIG_CAN_SUPERVISOR_STABLE_MS * 1000u,
+    };
+    can_supervisor_core_init(&s_sup.core, &config);
+    s_sup.on_change = on_change;
+    s_sup.ctx = ctx;
+
+    if (xTaskCreate(supervisor_task, "can_sup", SUPERVISOR_TASK_STACK, NULL,
+                    SUPERVISOR_TASK_PRIORITY, &s_sup.task) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create supervisor task");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void can_supervisor_set_paused(bool paused)
+{
+    portENTER_CRITICAL(&s_sup.lock);
+    can_supervisor_core_set_paused(&s_sup.core, paused);
+    portEXIT_CRITICAL(&s_sup.lock);
+}
+
+can_supervisor_state_t can_supervisor_get_state(void)
+{
+    return (can_supervisor_state_t)__atomic_load_n(&s_sup.state, __ATOMIC_ACQUIRE);
+}
+
+uint32_t can_supervisor_poll_scale(void)
+{
+    // Without a supervisor, poll as before
+    if (!s_sup.task)
+    {
+        return 1;
+    }
+    return __atomic_load_n(&s_sup.poll_scale, __ATOMIC_ACQUIRE);
+}
+
+void can_supervisor_get_stats(can_supervisor_stats_t *out)
+{
+    if (!out)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_sup.lock);
+    memcpy(out, &s_sup.core.stats, sizeof(*out));
+    portEXIT_CRITICAL(&s_sup.lock);
+}
@@ -0,0 +1,161 @@
+/*
+ * CAN Supervisor Core - Implementation
+ */
+
+#include "can_supervisor_core.h"
+
+#include <string.h>
+
+void can_supervisor_core_init(can_supervisor_core_t *core, const can_supervisor_config_t *config)
+{
+    memset(core, 0, sizeof(*core));
+    if (config) {
+        core->config = *config;
+    }
+    if (core->config.backoff_max_us < core->config.backoff_min_us) {
+        core->config.backoff_max_us = core->config.backoff_min_us;
+    }
+    core->state = CAN_SUPERVISOR_STOPPED;
+}
+
+static can_supervisor_state_t classify(const can_supervisor_status_t *status)
+{
+    switch (status->ctrl) {
+        case CAN_SUPERVISOR_CTRL_BUS_OFF:
+            return CAN_SUPERVISOR_BUS_OFF;
+        case CAN_SUPERVISOR_CTRL_RECOVERING:
+            return CAN_SUPERVISOR_RECOVERING;
+        case CAN_SUPERVISOR_CTRL_RUNNING:
+            break;
+        default:
+            return CAN_SUPERVISOR_STOPPED;
+    }
+
+    uint32_t worst = status->tec > status->rec ? status->tec : status->rec;
+    if (worst >= CAN_SUPERVISOR_PASSIVE_LIMIT) {
+        return CAN_SUPERVISOR_ERROR_PASSIVE;
+    }
+    if (worst >= CAN_SUPERVISOR_WARN_LIMIT) {
+        return CAN_SUPERVISOR_ERROR_WARNING;
+    }
+    return CAN_SUPERVISOR_ERROR_ACTIVE;
+}
+
+static void enter_bus_off(can_supervisor_core_t *core, int64_t now_us)
+{
+    core->stats.bus_off_count++;
+
+    // Back-to-back failures double the wait; a stable spell resets it
+    bool repeat = core->running_since_us != 0 &&
+                  now_us - core->running_since_us < (int64_t)core->config.stable_us;
+    if (!repeat || core->backoff_us == 0) {
+        core->backoff_us = core->config.backoff_min_us;
+    } else if (core->backoff_us < core->config.backoff_max_us / 2) {
+        core->backoff_us *= 2;
+    } else {
+        core->backoff_us = core->config.backoff_max_us;
+    }
+
+    if (!core->recovery_pending) {
+        core->offline_since_us = now_us;
+    }
+    core->recovery_pending = true;
+    core->recovery_started = false;
+    core->recover_at_us = now_us + core->backoff_us;
+}
+
+static void restarted(can_supervisor_core_t *core, int64_t now_us)
+{
+    int64_t offline = now_us - core->offline_since_us;
+    uint32_t offline_us = offline > (int64_t)UINT32_MAX ? UINT32_MAX : (uint32_t)offline;
+
+    core->stats.recoveries++;
+    core->stats.last_offline_us = offline_us;
+    if (offline_us > core->stats.max_offline_us) {
+        core->stats.max_offline_us = offline_us;
+    }
+    core->recovery_pending = false;
+    core->recovery_started = false;
+    core->running_since_us = now_us;
+}
+
+can_supervisor_action_t can_supervisor_core_update(can_supervisor_core_t *core,
+                                                   const can_supervisor_status_t *status,
+                                                   int64_t now_us)
+{
+    core->tec = status->tec;
+    core->rec = status->rec;
+    core->stats.rx_queue_full += status->rx_queue_full;
+    if (status->tec > core->stats.max_tec) {
+        core->stats.max_tec = status->tec;
+    }
+    if (status->rec > core->stats.max_rec) {
+        core->stats.max_rec = status->rec;
+    }
+
+    can_supervisor_state_t next = classify(status);
+    if (next != core->state) {
+        core->stats.transitions++;
+        if (next == CAN_SUPERVISOR_BUS_OFF) {
+            enter_bus_off(core, now_us);
+        } else if (core->recovery_pending && next != CAN_SUPERVISOR_RECOVERING &&
+                   next != CAN_SUPERVISOR_STOPPED) {
+            restarted(core, now_us);
+        }
+        core->state = next;
+    }
+
+    if (core->paused) {
+        return CAN_SUPERVISOR_ACTION_NONE;
+    }
+
+    switch (core->state) {
+        case CAN_SUPERVISOR_BUS_OFF:
+            if (!core->recovery_started && now_us >= core->recover_at_us) {
+                core->recovery_started = true;
+                return CAN_SUPERVISOR_ACTION_RECOVER;
+            }
+            return CAN_SUPERVISOR_ACTION_NONE;
+        case CAN_SUPERVISOR_STOPPED:
+            // The driver stops the controller once recovery completes
+            return core->recovery_pending ? CAN_SUPERVISOR_ACTION_START
+                                          : CAN_SUPERVISOR_ACTION_NONE;
+        default:
+            return CAN_SUPERVISOR_ACTION_NONE;
+    }
+}
+
+void can_supervisor_core_set_paused(can_supervisor_core_t *core, bool paused)
+{
+    core->paused = paused;
+}
+
+int64_t can_supervisor_core_next_deadline_us(const can_supervisor_core_t *core, int64_t now_us)
+{
+    if (core->paused || core->state != CAN_SUPERVISOR_BUS_OFF || core->recovery_started) {
+        return -1;
+    }
+    return core->recover_at_us > now_us ? core->recover_at_us - now_us : 0;
+}
+
+uint32_t can_supervisor_core_poll_scale(const can_supervisor_core_t *core)
+{
+    switch (core->state) {
+        case CAN_SUPERVISOR_ERROR_ACTIVE:
+            return 1;
+        case CAN_SUPERVISOR_ERROR_WARNING:
+            return 2;
+        case CAN_SUPERVISOR_ERROR_PASSIVE:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+const char *can_supervisor_state_name(can_supervisor_state_t state)
+{
+    static const char *const k_names[CAN_SUPERVISOR_STATE_COUNT] = {
+        "stopped", "active", "warning", "passive", "bus_off", "recovering"
+    };
+    return (unsigned)state < CAN_SUPERVISOR_STATE_COUNT ? k_names[state] : "unknown";
+}
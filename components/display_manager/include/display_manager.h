@@ -9,9 +9,8 @@
 #include <stdbool.h>
 
 #include "lvgl.h"
-
-// Forward declaration
-typedef struct dm_page dm_page_t;
+#include "display_manager/page.h"
+#include "mem_plan.h"
 
 // Display orientation options
 typedef enum {
@@ -71,9 +70,23 @@ typedef struct {
 // Display manager handle
 typedef struct display_manager* display_manager_handle_t;
 
+// Called from the LVGL task after each area has been written to the panel
+typedef void (*display_flush_hook_t)(const lv_area_t *area);
+
+/**
+ * @brief Add the LVGL draw buffers to the boot memory plan
+ *
+ * @param config Display configuration that will be passed to init
+ * @param budget Budget to add to
+ */
+void display_manager_plan_memory(const display_config_t *config, mem_plan_budget_t *budget);
+
 /**
  * @brief Initialize the display manager
  *
+ * Draw buffers are taken from the DMA arena, so mem_plan_init() must have
+ * run with a budget from display_manager_plan_memory().
+ *
  * @param config Display configuration
  * @return display_manager_handle_t Handle to the display manager
  */
@@ -119,12 +132,63 @@ lv_display_t *display_manager_get_display(display_manager_handle_t dm_handle);
 int display_manager_get_page_count(display_manager_handle_t dm_handle);
 
 /**
- * @brief Update all pages (call this periodically)
+ * @brief Set a hook called after every flushed area
+ *
+ * @param dm_handle Handle to the display manager
+ * @param hook Hook to call, or NULL to remove
+ */
+void display_manager_set_flush_hook(display_manager_handle_t dm_handle, display_flush_hook_t hook);
+
+/**
+ * @brief Install a page drawn on the top layer, above every page
+ *
+ * The overlay is created and shown immediately and stays visible. It
+ * updates on the next LVGL pass after any of its update_mask bits change
+ * (min_refresh_ms and priority are ignored), and at least every
+ * max_refresh_ms. Its update_mask should not share bits with the pages'.
+ * Call once, after display_manager_init() and before display_manager_start().
+ * The display manager owns the page afterwards.
+ *
+ * @param dm_handle Handle to the display manager
+ * @param overlay Overlay page
+ */
+void display_manager_set_overlay(display_manager_handle_t dm_handle, dm_page_t *overlay);
+
+/**
+ * @brief Update the visible page now
+ *
+ * The LVGL task calls this on its own according to each page's refresh
+ * policy; call it only from the LVGL task.
  *
  * @param dm_handle Handle to the display manager
  */
 void display_manager_update(display_manager_handle_t dm_handle);
 
+/**
+ * @brief Signal that data behind some pages changed
+ *
+ * Safe from any task. Wakes the LVGL task if the visible page's or the
+ * overlay's update_mask has any of the bits; further changes are coalesced until
+ * that page has updated, and updates never come faster than the page's
+ * min_refresh_ms.
+ *
+ * @param dm_handle Handle to the display manager
+ * @param mask Changed data bits (application defined)
+ */
+void display_manager_notify_changed(display_manager_handle_t dm_handle, uint32_t mask);
+
+/**
+ * @brief Copy a page's update statistics
+ *
+ * @param dm_handle Handle to the display manager
+ * @param page_index Page index
+ * @param out Filled with the statistics
+ * @param name_out Filled with the page name (may be NULL)
+ * @return true on success, false if the index is out of range
+ */
+bool display_manager_get_page_stats(display_manager_handle_t dm_handle, int page_index,
+                                    dm_page_stats_t *out, const char **name_out);
+
 /**
  * @brief Start the LVGL task
  *
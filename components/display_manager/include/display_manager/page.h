@@ -13,6 +13,22 @@ extern "C" {
 // Forward declaration
 typedef struct display_manager display_manager_t;
 
+// Update priority when the LVGL task is short of time
+typedef enum {
+    DM_PAGE_PRIORITY_LOW = 0,     // Deferred once a pass uses half the frame budget
+    DM_PAGE_PRIORITY_NORMAL,      // Deferred once a pass uses the whole frame budget
+    DM_PAGE_PRIORITY_HIGH         // Never deferred
+} dm_page_priority_t;
+
+// Update statistics, written by the LVGL task
+typedef struct {
+    uint32_t updates;             // on_update calls
+    uint32_t overruns;            // Calls that took longer than update_budget_us
+    uint32_t deferred;            // Due updates pushed to a later pass
+    uint32_t max_update_us;
+    uint64_t total_update_us;
+} dm_page_stats_t;
+
 // Page structure
 typedef struct dm_page {
     const char *name;
@@ -25,12 +41,26 @@ typedef struct dm_page {
     void (*on_hide)(struct dm_page *page);
     void (*on_update)(struct dm_page *page);
     
+    // Refresh policy (see display_manager_notify_changed)
+    uint32_t update_mask;      // Data bits that trigger on_update while visible
+    uint32_t min_refresh_ms;   // Shortest gap between change-driven updates
+    uint32_t max_refresh_ms;   // Longest gap; updates even without changes
+    dm_page_priority_t priority;
+    uint32_t update_budget_us; // Expected on_update cost; overruns back off
+
     // Internal data
     lv_obj_t *container;
     bool is_created;
     bool is_visible;
+    int64_t last_update_us;
+    uint32_t backoff_us;       // Extra gap after an overrun
+    dm_page_stats_t stats;
 } dm_page_t;
 
+// Pages that do not set a policy poll at this rate
+#define DM_PAGE_DEFAULT_REFRESH_MS 100
+#define DM_PAGE_DEFAULT_BUDGET_US 5000
+
 /**
  * @brief Create a new page
  *
@@ -39,7 +69,7 @@ typedef struct dm_page {
  * @param on_destroy Callback when page is destroyed
  * @param on_show Callback when page is shown
  * @param on_hide Callback when page is hidden
- * @param on_update Callback for periodic updates
+ * @param on_update Callback for updates (see the refresh policy fields)
  * @return dm_page_t* Pointer to the new page
  */
 dm_page_t *page_create(const char *name,
@@ -1,5 +1,5 @@
-#include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -8,7 +8,6 @@
 #include <driver/gpio.h>
 #include <driver/i2c.h>
 #include <esp_err.h>
-#include <esp_heap_caps.h>
 #include <esp_lcd_panel_io.h>
 #include <esp_lcd_panel_ops.h>
 #include <esp_lcd_panel_rgb.h>
@@ -20,6 +19,8 @@
 #include "display_manager.h"
 #include "display_manager/page.h"
 #include "lvgl.h"
+#include "mem_plan.h"
+#include "trace.h"
 
 static const char *TAG = "display_manager";
 
@@ -33,6 +34,8 @@ static const uint8_t k_touch_reset_release = 0x2E;
 static const int k_i2c_timeout_ms = 1000;
 static const int k_touch_reset_hold_ms = 100;
 static const int k_touch_reset_release_ms = 200;
+static const int k_default_draw_buf_lines = 40;
+static const uint32_t k_frame_budget_us = 16000;  // One LVGL pass, including page updates
 
 // Internal structure for display manager
 struct display_manager {
@@ -41,7 +44,6 @@ struct display_manager {
     esp_lcd_panel_io_handle_t touch_io_handle;
     esp_lcd_touch_handle_t touch_handle;
     lv_display_t *display;
-    lv_timer_t *ui_timer;
     lv_indev_t *touch_indev;
     TaskHandle_t lvgl_task_handle;
     void *draw_buf1;
@@ -52,22 +54,38 @@ struct display_manager {
     dm_page_t **pages;
     int page_count;
     int current_page_index;
-};
+    int pending_page_index;  // Set by other tasks, applied by the LVGL task (-1 = none)
+    dm_page_t *overlay;      // Drawn on the top layer above every page (NULL = none)
+
+    // Change-driven refresh
+    uint32_t changed_mask;          // Bits set by notify_changed, cleared on update
+    uint32_t visible_update_mask;   // update_mask of the visible page and the overlay
+    bool force_update;              // Update on the next pass (page just shown)
+    uint32_t last_lvgl_us;          // Duration of the last lv_timer_handler() call
 
-typedef struct {
-    struct display_manager *dm;
-    int page_index;
-} display_manager_page_request_t;
+    display_flush_hook_t flush_hook;
+};
 
 // Forward declarations
 static void display_manager_lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
 static void display_manager_touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data);
 static void display_manager_increase_lvgl_tick(void *arg);
 static void display_manager_lvgl_port_task(void *arg);
-static void display_manager_ui_timer_cb(lv_timer_t *t);
+static uint32_t display_manager_service_updates(struct display_manager *dm);
+static uint32_t display_manager_service_overlay(struct display_manager *dm);
+static void display_manager_run_update(struct display_manager *dm, dm_page_t *page, int trace_id);
 static void display_manager_apply_orientation(struct display_manager *dm);
 static void display_manager_switch_to_page_internal(struct display_manager *dm, int page_index);
-static void display_manager_switch_to_page_async_cb(void *user_data);
+static size_t display_manager_draw_buf_size(const display_config_t *config);
+
+static size_t display_manager_draw_buf_size(const display_config_t *config)
+{
+    int effective_h_res = config->orientation == DISPLAY_ORIENTATION_PORTRAIT ?
+                          config->v_res : config->h_res;
+    int draw_buf_lines = config->draw_buf_lines > 0 ? config->draw_buf_lines :
+                         k_default_draw_buf_lines;
+    return (size_t)effective_h_res * draw_buf_lines * sizeof(lv_color_t);
+}
 
 static void display_manager_delay_ms(uint32_t delay_ms)
 {
@@ -222,6 +240,17 @@ static esp_err_t display_manager_touch_init(struct display_manager *dm)
     return ESP_OK;
 }
 
+void display_manager_plan_memory(const display_config_t *config, mem_plan_budget_t *budget)
+{
+    if (!config) {
+        return;
+    }
+
+    size_t draw_buffer_sz = display_manager_draw_buf_size(config);
+    mem_plan_budget_add(budget, MEM_REGION_DMA, draw_buffer_sz, 4);
+    mem_plan_budget_add(budget, MEM_REGION_DMA, draw_buffer_sz, 4);
+}
+
 display_manager_handle_t display_manager_init(const display_config_t *config)
 {
     if (!config) {
@@ -271,6 +300,17 @@ display_manager_handle_t display_manager_init(const display_config_t *config)
     }
 
     dm->current_page_index = -1;
+    dm->pending_page_index = -1;
+
+    // Both draw buffers come from the DMA arena planned at boot
+    size_t draw_buffer_sz = display_manager_draw_buf_size(&dm->config);
+    dm->draw_buf1 = mem_plan_alloc(MEM_REGION_DMA, draw_buffer_sz, 4, "lvgl draw buf 1");
+    dm->draw_buf2 = mem_plan_alloc(MEM_REGION_DMA, draw_buffer_sz, 4, "lvgl draw buf 2");
+    if (!dm->draw_buf1 || !dm->draw_buf2) {
+        ESP_LOGE(TAG, "Draw buffers missing from the memory plan");
+        free(dm);
+        return NULL;
+    }
 
     esp_err_t err = display_manager_i2c_init(dm);
     if (err != ESP_OK) {
@@ -340,13 +380,6 @@ display_manager_handle_t display_manager_init(const display_config_t *config)
 
     dm->display = lv_display_create(effective_h_res, effective_v_res);
 
-    int draw_buf_lines = dm->config.draw_buf_lines > 0 ? dm->config.draw_buf_lines : 40;
-    size_t draw_buffer_sz = (size_t)effective_h_res * draw_buf_lines * sizeof(lv_color_t);
-    dm->draw_buf1 = heap_caps_malloc(draw_buffer_sz, MALLOC_CAP_DMA);
-    assert(dm->draw_buf1);
-    dm->draw_buf2 = heap_caps_malloc(draw_buffer_sz, MALLOC_CAP_DMA);
-    assert(dm->draw_buf2);
-
     lv_display_set_buffers(dm->display, dm->draw_buf1, dm->draw_buf2, draw_buffer_sz,
                            LV_DISPLAY_RENDER_MODE_PARTIAL);
     lv_display_set_user_data(dm->display, dm);
@@ -370,8 +403,6 @@ display_manager_handle_t display_manager_init(const display_config_t *config)
     ESP_ERROR_CHECK(esp_timer_create(&lvgl_tick_timer_args, &lvgl_tick_timer));
     ESP_ERROR_CHECK(esp_timer_start_periodic(lvgl_tick_timer, dm->config.tick_period_ms * 1000));
 
-    dm->ui_timer = lv_timer_create(display_manager_ui_timer_cb, 100, dm);
-
     // Note: LVGL task is NOT started here. Call display_manager_start() after
     // adding all pages to avoid race conditions between page creation and
     // LVGL's timer handler.
@@ -395,6 +426,13 @@ void display_manager_deinit(display_manager_handle_t dm_handle)
     }
     free(dm_handle->pages);
 
+    if (dm_handle->overlay) {
+        if (dm_handle->overlay->on_destroy) {
+            dm_handle->overlay->on_destroy(dm_handle->overlay);
+        }
+        free(dm_handle->overlay);
+    }
+
     if (dm_handle->lvgl_task_handle) {
         vTaskDelete(dm_handle->lvgl_task_handle);
     }
@@ -415,13 +453,7 @@ void display_manager_deinit(display_manager_handle_t dm_handle)
         esp_lcd_panel_del(dm_handle->panel_handle);
     }
 
-    if (dm_handle->draw_buf1) {
-        heap_caps_free(dm_handle->draw_buf1);
-    }
-
-    if (dm_handle->draw_buf2) {
-        heap_caps_free(dm_handle->draw_buf2);
-    }
+    // Draw buffers belong to the memory plan and are not freed
 
     if (dm_handle->i2c_port >= 0) {
         i2c_driver_delete(dm_handle->i2c_port);
@@ -481,18 +513,13 @@ static void display_manager_switch_to_page_internal(struct display_manager *dm_h
         dm_handle->pages[page_index]->on_show(dm_handle->pages[page_index]);
     }
     dm_handle->pages[page_index]->is_visible = true;
-}
-
-static void display_manager_switch_to_page_async_cb(void *user_data)
-{
-    display_manager_page_request_t *req = user_data;
 
-    if (!req) {
-        return;
+    uint32_t visible_mask = dm_handle->pages[page_index]->update_mask;
+    if (dm_handle->overlay) {
+        visible_mask |= dm_handle->overlay->update_mask;
     }
-
-    display_manager_switch_to_page_internal(req->dm, req->page_index);
-    free(req);
+    __atomic_store_n(&dm_handle->visible_update_mask, visible_mask, __ATOMIC_RELEASE);
+    dm_handle->force_update = true;
 }
 
 void display_manager_switch_to_page(display_manager_handle_t dm_handle, int page_index)
@@ -511,18 +538,10 @@ void display_manager_switch_to_page(display_manager_handle_t dm_handle, int page
         return;
     }
 
-    display_manager_page_request_t *req = malloc(sizeof(*req));
-    if (!req) {
-        ESP_LOGE(TAG, "Failed to allocate page switch request");
-        return;
-    }
-
-    req->dm = dm_handle;
-    req->page_index = page_index;
-
-    if (lv_async_call(display_manager_switch_to_page_async_cb, req) != LV_RESULT_OK) {
-        ESP_LOGE(TAG, "Failed to schedule page switch");
-        free(req);
+    // Latest request wins; the LVGL task picks it up on its next wake
+    __atomic_store_n(&dm_handle->pending_page_index, page_index, __ATOMIC_RELEASE);
+    if (dm_handle->lvgl_task_handle) {
+        xTaskNotifyGive(dm_handle->lvgl_task_handle);
     }
 }
 
@@ -536,6 +555,41 @@ int display_manager_get_page_count(display_manager_handle_t dm_handle)
     return dm_handle ? dm_handle->page_count : 0;
 }
 
+void display_manager_set_overlay(display_manager_handle_t dm_handle, dm_page_t *overlay)
+{
+    if (!dm_handle || !overlay || !dm_handle->display) {
+        return;
+    }
+
+    if (dm_handle->lvgl_task_handle || dm_handle->overlay) {
+        ESP_LOGW(TAG, "Overlay must be set once, before display_manager_start()");
+        return;
+    }
+
+    dm_handle->overlay = overlay;
+    if (overlay->on_create) {
+        overlay->on_create(overlay, lv_display_get_layer_top(dm_handle->display));
+    }
+    overlay->is_created = true;
+    if (overlay->on_show) {
+        overlay->on_show(overlay);
+    }
+    overlay->is_visible = true;
+
+    uint32_t visible = __atomic_load_n(&dm_handle->visible_update_mask, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&dm_handle->visible_update_mask, visible | overlay->update_mask,
+                     __ATOMIC_RELEASE);
+}
+
+void display_manager_set_flush_hook(display_manager_handle_t dm_handle, display_flush_hook_t hook)
+{
+    if (!dm_handle) {
+        return;
+    }
+
+    dm_handle->flush_hook = hook;
+}
+
 void display_manager_update(display_manager_handle_t dm_handle)
 {
     if (!dm_handle) {
@@ -543,13 +597,129 @@ void display_manager_update(display_manager_handle_t dm_handle)
     }
 
     if (dm_handle->current_page_index >= 0 &&
-        dm_handle->current_page_index < dm_handle->page_count &&
-        dm_handle->pages[dm_handle->current_page_index]->on_update) {
-        dm_handle->pages[dm_handle->current_page_index]->on_update(
-            dm_handle->pages[dm_handle->current_page_index]);
+        dm_handle->current_page_index < dm_handle->page_count) {
+        dm_handle->force_update = false;
+        display_manager_run_update(dm_handle, dm_handle->pages[dm_handle->current_page_index],
+                                   dm_handle->current_page_index);
     }
 }
 
+static void display_manager_run_update(struct display_manager *dm, dm_page_t *page, int trace_id)
+{
+    // Clear before on_update so a change during the update wakes us again
+    __atomic_fetch_and(&dm->changed_mask, ~page->update_mask, __ATOMIC_ACQ_REL);
+    page->last_update_us = esp_timer_get_time();
+
+    if (page->on_update) {
+        TRACE_PAGE_UPDATE_BEGIN(trace_id);
+        page->on_update(page);
+        TRACE_PAGE_UPDATE_END(trace_id);
+    }
+
+    uint32_t took_us = (uint32_t)(esp_timer_get_time() - page->last_update_us);
+    page->stats.updates++;
+    page->stats.total_update_us += took_us;
+    if (took_us > page->stats.max_update_us) {
+        page->stats.max_update_us = took_us;
+    }
+
+    // A page that overran waits that much longer before its next
+    // change-driven update, so it cannot keep input handling waiting
+    page->backoff_us = 0;
+    if (page->update_budget_us > 0 && took_us > page->update_budget_us) {
+        page->stats.overruns++;
+        page->backoff_us = took_us - page->update_budget_us;
+        if (page->backoff_us > page->max_refresh_ms * 1000) {
+            page->backoff_us = page->max_refresh_ms * 1000;
+        }
+    }
+}
+
+void display_manager_notify_changed(display_manager_handle_t dm_handle, uint32_t mask)
+{
+    if (!dm_handle || mask == 0) {
+        return;
+    }
+
+    uint32_t before = __atomic_fetch_or(&dm_handle->changed_mask, mask, __ATOMIC_ACQ_REL);
+    uint32_t visible = __atomic_load_n(&dm_handle->visible_update_mask, __ATOMIC_ACQUIRE);
+
+    // Only the first change since the visible page last updated needs a wake
+    if ((mask & visible) != 0 && (before & visible) == 0 && dm_handle->lvgl_task_handle) {
+        xTaskNotifyGive(dm_handle->lvgl_task_handle);
+    }
+}
+
+// Run the visible page's update if it is due; returns ms until it next could be
+static uint32_t display_manager_service_updates(struct display_manager *dm)
+{
+    if (dm->current_page_index < 0 || dm->current_page_index >= dm->page_count) {
+        return UINT32_MAX;
+    }
+
+    dm_page_t *page = dm->pages[dm->current_page_index];
+    uint32_t changed = __atomic_load_n(&dm->changed_mask, __ATOMIC_ACQUIRE) & page->update_mask;
+    int64_t since_ms = (esp_timer_get_time() - page->last_update_us) / 1000;
+    int64_t min_gap_ms = page->min_refresh_ms + page->backoff_us / 1000;
+
+    bool overdue = (int64_t)page->max_refresh_ms <= since_ms;
+    bool due = dm->force_update || overdue || (changed != 0 && min_gap_ms <= since_ms);
+    if (!due) {
+        int64_t target_ms = changed != 0 ? min_gap_ms : page->max_refresh_ms;
+        if (target_ms > page->max_refresh_ms) {
+            target_ms = page->max_refresh_ms;
+        }
+        return (uint32_t)(target_ms - since_ms);
+    }
+
+    // After a long LVGL pass let input and rendering catch up first, unless
+    // the page is high priority or has waited twice its maximum period
+    uint32_t defer_above_us = page->priority == DM_PAGE_PRIORITY_LOW ?
+                              k_frame_budget_us / 2 : k_frame_budget_us;
+    if (page->priority != DM_PAGE_PRIORITY_HIGH && !dm->force_update &&
+        since_ms < 2 * (int64_t)page->max_refresh_ms && dm->last_lvgl_us > defer_above_us) {
+        page->stats.deferred++;
+        return 1;
+    }
+
+    display_manager_update(dm);
+    return page->max_refresh_ms;
+}
+
+// Run the overlay's update on any change to its bits; it is never deferred
+// or rate limited, so an alert shows on the next LVGL pass
+static uint32_t display_manager_service_overlay(struct display_manager *dm)
+{
+    dm_page_t *overlay = dm->overlay;
+    if (!overlay) {
+        return UINT32_MAX;
+    }
+
+    uint32_t changed = __atomic_load_n(&dm->changed_mask, __ATOMIC_ACQUIRE) & overlay->update_mask;
+    int64_t since_ms = (esp_timer_get_time() - overlay->last_update_us) / 1000;
+    if (changed == 0 && since_ms < (int64_t)overlay->max_refresh_ms) {
+        return (uint32_t)(overlay->max_refresh_ms - since_ms);
+    }
+
+    display_manager_run_update(dm, overlay, dm->page_count);
+    return overlay->max_refresh_ms;
+}
+
+bool display_manager_get_page_stats(display_manager_handle_t dm_handle, int page_index,
+                                    dm_page_stats_t *out, const char **name_out)
+{
+    if (!dm_handle || !out || page_index < 0 || page_index >= dm_handle->page_count) {
+        return false;
+    }
+
+    // Single writer (LVGL task); a concurrent copy may be one update behind
+    memcpy(out, &dm_handle->pages[page_index]->stats, sizeof(*out));
+    if (name_out) {
+        *name_out = dm_handle->pages[page_index]->name;
+    }
+    return true;
+}
+
 static void display_manager_lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
 {
     struct display_manager *dm = lv_display_get_user_data(disp);
@@ -563,8 +733,12 @@ static void display_manager_lvgl_flush_cb(lv_display_t *disp, const lv_area_t *a
     int offsety1 = area->y1 + dm->config.y_offset;
     int offsety2 = area->y2 + dm->config.y_offset;
 
+    TRACE_LVGL_FLUSH((area->x2 - area->x1 + 1) * (area->y2 - area->y1 + 1), area->y1, area->y2);
     esp_lcd_panel_draw_bitmap(dm->panel_handle, offsetx1, offsety1, offsetx2 + 1, offsety2 + 1,
                               px_map);
+    if (dm->flush_hook) {
+        dm->flush_hook(area);
+    }
     lv_display_flush_ready(disp);
 }
 
@@ -614,32 +788,42 @@ static void display_manager_increase_lvgl_tick(void *arg)
 
 static void display_manager_lvgl_port_task(void *arg)
 {
-    (void)arg;
+    struct display_manager *dm = (struct display_manager *)arg;
     uint32_t task_delay_ms = 500;
 
     ESP_LOGI(TAG, "Starting LVGL task");
 
     while (1) {
+        int pending = __atomic_exchange_n(&dm->pending_page_index, -1, __ATOMIC_ACQUIRE);
+        if (pending >= 0) {
+            display_manager_switch_to_page_internal(dm, pending);
+        }
+
+        uint32_t update_delay_ms = display_manager_service_updates(dm);
+        uint32_t overlay_delay_ms = display_manager_service_overlay(dm);
+        if (overlay_delay_ms < update_delay_ms) {
+            update_delay_ms = overlay_delay_ms;
+        }
+
+        int64_t lvgl_start_us = esp_timer_get_time();
+        TRACE_LVGL_RENDER_BEGIN();
         task_delay_ms = lv_timer_handler();
+        TRACE_LVGL_RENDER_END();
+        dm->last_lvgl_us = (uint32_t)(esp_timer_get_time() - lvgl_start_us);
 
+        if (update_delay_ms < task_delay_ms) {
+            task_delay_ms = update_delay_ms;
+        }
         if (task_delay_ms > 500) {
             task_delay_ms = 500;
         } else if (task_delay_ms < 1) {
             task_delay_ms = 1;
         }
-        vTaskDelay(pdMS_TO_TICKS(task_delay_ms));
+        // Page switches and data changes on the visible page cut the wait short
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(task_delay_ms));
     }
 }
 
-static void display_manager_ui_timer_cb(lv_timer_t *t)
-{
-    struct display_manager *dm = (struct display_manager *)lv_timer_get_user_data(t);
-    if (!dm) {
-        return;
-    }
-    display_manager_update(dm);
-}
-
 static void display_manager_apply_orientation(struct display_manager *dm)
 {
     if (!dm || !dm->panel_handle) {
@@ -18,6 +18,10 @@ dm_page_t *page_create(const char *name,
     page->on_show = on_show;
     page->on_hide = on_hide;
     page->on_update = on_update;
+    page->min_refresh_ms = DM_PAGE_DEFAULT_REFRESH_MS;
+    page->max_refresh_ms = DM_PAGE_DEFAULT_REFRESH_MS;
+    page->priority = DM_PAGE_PRIORITY_NORMAL;
+    page->update_budget_us = DM_PAGE_DEFAULT_BUDGET_US;
     
     return page;
 }
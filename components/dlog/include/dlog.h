@@ -0,0 +1,106 @@
+/*
+ * Deferred Logging
+ *
+ * Drop-in for ESP_LOGx on busy paths. A DLOGx call copies the format
+ * string pointer, the tag pointer and the raw arguments into a ring
+ * buffer; a low-priority task formats and prints them later in the usual
+ * ESP_LOG layout. The caller never runs vsnprintf or waits on the UART.
+ *
+ * Rules for call sites:
+ * - Format strings and tags must be literals (they are kept by pointer).
+ * - %s arguments must outlive the record: literals, esp_err_to_name()
+ *   and similar static tables. Use ESP_LOGx for strings in buffers.
+ * - At most DLOG_MAX_ARGS arguments per call.
+ *
+ * Records that do not fit in the ring are dropped and counted; the
+ * formatter reports the count. Before dlog_init() calls format inline.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <esp_log.h>
+
+#include "esp_err.h"
+#include "dlog_format.h"
+#include "mem_plan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Add the record ring to the boot memory plan
+ *
+ * @param budget Budget to add to
+ */
+void dlog_plan_memory(mem_plan_budget_t *budget);
+
+/**
+ * @brief Take the ring from the memory plan and start the formatter task
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the ring is not planned
+ *         or the task cannot be created
+ */
+esp_err_t dlog_init(void);
+
+/**
+ * @brief Queue one record
+ *
+ * C++ callers use the DLOGx macros; C callers pack the slots with the
+ * dlog_arg_* helpers. Safe from tasks and ISRs.
+ *
+ * @param level Log level
+ * @param tag Tag literal
+ * @param fmt Format literal
+ * @param args Argument slots (see dlog_arg_*)
+ * @param argc Number of slots (<= DLOG_MAX_ARGS)
+ */
+void dlog_write(esp_log_level_t level, const char *tag, const char *fmt,
+                const uint64_t *args, size_t argc);
+
+/**
+ * @brief Records dropped because the ring was full
+ *
+ * @return Total since boot
+ */
+uint32_t dlog_get_dropped(void);
+
+#ifdef __cplusplus
+}
+
+#include <type_traits>
+
+static inline uint64_t dlog_arg(double v) { return dlog_arg_double(v); }
+static inline uint64_t dlog_arg(float v) { return dlog_arg_double(v); }
+static inline uint64_t dlog_arg(const char *s) { return dlog_arg_ptr(s); }
+static inline uint64_t dlog_arg(char *s) { return dlog_arg_ptr(s); }
+static inline uint64_t dlog_arg(const void *p) { return dlog_arg_ptr(p); }
+static inline uint64_t dlog_arg(void *p) { return dlog_arg_ptr(p); }
+
+template <typename T>
+static inline uint64_t dlog_arg(T v)
+{
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                  "DLOG arguments must be integers, floating point or pointers");
+    if (std::is_signed<T>::value) {
+        return dlog_arg_int((long long)v);
+    }
+    return dlog_arg_uint((unsigned long long)v);
+}
+
+template <typename... Args>
+static inline void dlog_emit(esp_log_level_t level, const char *tag, const char *fmt, Args... args)
+{
+    static_assert(sizeof...(Args) <= DLOG_MAX_ARGS, "Too many DLOG arguments");
+    const uint64_t packed[] = {0, dlog_arg(args)...};
+    dlog_write(level, tag, fmt, packed + 1, sizeof...(Args));
+}
+
+#define DLOGE(tag, fmt, ...) dlog_emit(ESP_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#define DLOGW(tag, fmt, ...) dlog_emit(ESP_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define DLOGI(tag, fmt, ...) dlog_emit(ESP_LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define DLOGD(tag, fmt, ...) dlog_emit(ESP_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+#endif
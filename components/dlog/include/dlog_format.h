@@ -0,0 +1,67 @@
+/*
+ * Deferred Log Formatting
+ *
+ * Log calls store their printf arguments as raw 64-bit slots; the
+ * formatter walks the format string later and reinterprets each slot by
+ * its conversion (integers sign-extended, floating point as double bits,
+ * %s and %p as pointers). Length modifiers are applied when formatting,
+ * so "%u" of a slot holding a sign-extended int prints like printf would.
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DLOG_MAX_ARGS 16
+
+static inline uint64_t dlog_arg_int(long long v)
+{
+    return (uint64_t)v;
+}
+
+static inline uint64_t dlog_arg_uint(unsigned long long v)
+{
+    return (uint64_t)v;
+}
+
+static inline uint64_t dlog_arg_double(double v)
+{
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+// Strings are stored by pointer and must outlive the record (literals,
+// esp_err_to_name(), other static tables)
+static inline uint64_t dlog_arg_ptr(const void *p)
+{
+    return (uint64_t)(uintptr_t)p;
+}
+
+/**
+ * @brief Format a deferred record like snprintf
+ *
+ * Arguments missing for a conversion print as "<?>"; unknown conversions
+ * are copied through unchanged. Output is always NUL-terminated.
+ *
+ * @param out Output buffer
+ * @param out_size Size of out (> 0)
+ * @param fmt printf-style format string
+ * @param args Argument slots, in order
+ * @param argc Number of slots
+ * @return Characters written, excluding the terminator
+ */
+size_t dlog_format(char *out, size_t out_size, const char *fmt,
+                   const uint64_t *args, size_t argc);
+
+#ifdef __cplusplus
+}
+#endif
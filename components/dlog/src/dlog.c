@@ -0,0 +1,193 @@
+/*
+ * Deferred Logging Implementation
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/ringbuf.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "dlog.h"
+
+static const char *TAG = "dlog";
+
+#define DLOG_RING_BYTES ((CONFIG_DLOG_RING_BYTES + 3) & ~3)
+#define DLOG_LINE_MAX 256
+#define DLOG_TASK_STACK 4096
+
+typedef struct {
+    int64_t timestamp_us;
+    const char *tag;
+    const char *fmt;
+    uint8_t level;
+    uint8_t argc;
+    uint64_t args[DLOG_MAX_ARGS];  // Only argc slots are queued
+} dlog_record_t;
+
+#define DLOG_RECORD_HEADER_SIZE offsetof(dlog_record_t, args)
+
+// Module state
+static struct {
+    RingbufHandle_t ring;
+    uint8_t *ring_storage;
+    StaticRingbuffer_t *ring_struct;
+    TaskHandle_t task;
+    uint32_t dropped;
+    char line[DLOG_LINE_MAX];  // Formatter task only
+} s_dlog = {
+    .ring = NULL,
+    .ring_storage = NULL,
+    .ring_struct = NULL,
+    .task = NULL,
+    .dropped = 0
+};
+
+static void print_record(const dlog_record_t *rec, char *line, size_t line_size)
+{
+    esp_log_level_t level = (esp_log_level_t)rec->level;
+    if (level > esp_log_level_get(rec->tag))
+    {
+        return;
+    }
+
+    dlog_format(line, line_size, rec->fmt, rec->args, rec->argc);
+    uint32_t ms = (uint32_t)(rec->timestamp_us / 1000);
+
+    switch (level)
+    {
+        case ESP_LOG_ERROR:
+            esp_log_write(level, rec->tag, LOG_FORMAT(E, "%s"), ms, rec->tag, line);
+            break;
+        case ESP_LOG_WARN:
+            esp_log_write(level, rec->tag, LOG_FORMAT(W, "%s"), ms, rec->tag, line);
+            break;
+        case ESP_LOG_INFO:
+            esp_log_write(level, rec->tag, LOG_FORMAT(I, "%s"), ms, rec->tag, line);
+            break;
+        default:
+            esp_log_write(level, rec->tag, LOG_FORMAT(D, "%s"), ms, rec->tag, line);
+            break;
+    }
+}
+
+static void dlog_task(void *arg)
+{
+    (void)arg;
+    uint32_t reported_dropped = 0;
+
+    while (1)
+    {
+        size_t item_size = 0;
+        dlog_record_t *rec = xRingbufferReceive(s_dlog.ring, &item_size, portMAX_DELAY);
+        if (rec)
+        {
+            print_record(rec, s_dlog.line, sizeof(s_dlog.line));
+            vRingbufferReturnItem(s_dlog.ring, rec);
+        }
+
+        uint32_t dropped = __atomic_load_n(&s_dlog.dropped, __ATOMIC_RELAXED);
+        if (dropped != reported_dropped)
+        {
+            ESP_LOGW(TAG, "%" PRIu32 " records dropped (ring full)", dropped - reported_dropped);
+            reported_dropped = dropped;
+        }
+    }
+}
+
+void dlog_plan_memory(mem_plan_budget_t *budget)
+{
+    mem_plan_budget_add(budget, MEM_REGION_INTERNAL, DLOG_RING_BYTES, 4);
+    mem_plan_budget_add(budget, MEM_REGION_INTERNAL, sizeof(StaticRingbuffer_t), 4);
+}
+
+esp_err_t dlog_init(void)
+{
+    if (s_dlog.task)
+    {
+        return ESP_OK;
+    }
+
+    s_dlog.ring_storage = mem_plan_alloc(MEM_REGION_INTERNAL, DLOG_RING_BYTES, 4, "dlog ring");
+    s_dlog.ring_struct = mem_plan_alloc(MEM_REGION_INTERNAL, sizeof(StaticRingbuffer_t), 4,
+                                        "dlog ring ctl");
+    if (!s_dlog.ring_storage || !s_dlog.ring_struct)
+    {
+        ESP_LOGE(TAG, "Record ring missing from the memory plan");
+        return ESP_ERR_NO_MEM;
+    }
+
+    RingbufHandle_t ring = xRingbufferCreateStatic(DLOG_RING_BYTES, RINGBUF_TYPE_NOSPLIT,
+                                                   s_dlog.ring_storage, s_dlog.ring_struct);
+    if (!ring)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    s_dlog.ring = ring;
+
+    if (xTaskCreate(dlog_task, "dlog", DLOG_TASK_STACK, NULL,
+                    CONFIG_DLOG_TASK_PRIORITY, &s_dlog.task) != pdPASS)
+    {
+        s_dlog.ring = NULL;
+        vRingbufferDelete(ring);
+        ESP_LOGE(TAG, "Failed to create formatter task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Deferred logging on (%d byte ring)", DLOG_RING_BYTES);
+    return ESP_OK;
+}
+
+void dlog_write(esp_log_level_t level, const char *tag, const char *fmt,
+                const uint64_t *args, size_t argc)
+{
+    if (argc > DLOG_MAX_ARGS)
+    {
+        argc = DLOG_MAX_ARGS;
+    }
+
+    dlog_record_t rec;
+    rec.timestamp_us = esp_timer_get_time();
+    rec.tag = tag;
+    rec.fmt = fmt;
+    rec.level = (uint8_t)level;
+    rec.argc = (uint8_t)argc;
+    if (argc > 0)
+    {
+        memcpy(rec.args, args, argc * sizeof(uint64_t));
+    }
+
+    if (!s_dlog.ring)
+    {
+        // Early boot: format on the caller's stack
+        char line[DLOG_LINE_MAX];
+        print_record(&rec, line, sizeof(line));
+        return;
+    }
+
+    size_t size = DLOG_RECORD_HEADER_SIZE + argc * sizeof(uint64_t);
+    BaseType_t sent;
+    if (xPortInIsrContext())
+    {
+        BaseType_t woken = pdFALSE;
+        sent = xRingbufferSendFromISR(s_dlog.ring, &rec, size, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    else
+    {
+        sent = xRingbufferSend(s_dlog.ring, &rec, size, 0);
+    }
+
+    if (sent != pdTRUE)
+    {
+        __atomic_fetch_add(&s_dlog.dropped, 1, __ATOMIC_RELAXED);
+    }
+}
+
+uint32_t dlog_get_dropped(void)
+{
+    return __atomic_load_n(&s_dlog.dropped, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,249 @@
+/*
+ * Deferred Log Formatting - Implementation
+ */
+
+#include "dlog_format.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define SPEC_MAX 32
+
+typedef enum {
+    LEN_NONE,
+    LEN_HH,
+    LEN_H,
+    LEN_L,
+    LEN_LL,
+    LEN_Z,
+} length_t;
+
+typedef struct {
+    char *out;
+    size_t size;
+    size_t pos;
+} out_t;
+
+static void put_str(out_t *o, const char *s, size_t n)
+{
+    for (size_t i = 0; i < n && o->pos + 1 < o->size; i++) {
+        o->out[o->pos++] = s[i];
+    }
+    o->out[o->pos] = '\0';
+}
+
+static void put_spec(out_t *o, const char *spec, ...)
+{
+    if (o->pos + 1 >= o->size) {
+        return;
+    }
+
+    va_list ap;
+    va_start(ap, spec);
+    int n = vsnprintf(o->out + o->pos, o->size - o->pos, spec, ap);
+    va_end(ap);
+
+    if (n > 0) {
+        size_t room = o->size - o->pos - 1;
+        o->pos += (size_t)n < room ? (size_t)n : room;
+    }
+}
+
+static bool next_arg(const uint64_t *args, size_t argc, size_t *next, uint64_t *value)
+{
+    if (*next >= argc) {
+        return false;
+    }
+    *value = args[(*next)++];
+    return true;
+}
+
+// Append a '*' value (or copy the digits) into the spec being built
+static bool copy_number(const char **p, char *spec, size_t *n,
+                        const uint64_t *args, size_t argc, size_t *next, bool precision)
+{
+    if (**p == '*') {
+        uint64_t value;
+        if (!next_arg(args, argc, next, &value)) {
+            return false;
+        }
+        int v = (int)(int64_t)value;
+        (*p)++;
+        if (precision && v < 0) {
+            // Negative precision means none; drop the '.'
+            (*n)--;
+            return true;
+        }
+        *n += (size_t)snprintf(spec + *n, SPEC_MAX - *n, "%d", v);
+        return true;
+    }
+
+    while (**p >= '0' && **p <= '9' && *n < SPEC_MAX - 8) {
+        spec[(*n)++] = *(*p)++;
+    }
+    return true;
+}
+
+static length_t parse_length(const char **p)
+{
+    switch (**p) {
+        case 'h':
+            (*p)++;
+            if (**p == 'h') {
+                (*p)++;
+                return LEN_HH;
+            }
+            return LEN_H;
+        case 'l':
+            (*p)++;
+            if (**p == 'l') {
+                (*p)++;
+                return LEN_LL;
+            }
+            return LEN_L;
+        case 'j':
+        case 'L':
+        case 'q':
+            (*p)++;
+            return LEN_LL;
+        case 'z':
+        case 't':
+            (*p)++;
+            return LEN_Z;
+        default:
+            return LEN_NONE;
+    }
+}
+
+static long long as_signed(uint64_t value, length_t len)
+{
+    switch (len) {
+        case LEN_HH: return (signed char)value;
+        case LEN_H: return (short)value;
+        case LEN_L: return (long)value;
+        case LEN_LL: return (long long)value;
+        case LEN_Z: return (long long)(intptr_t)value;
+        default: return (int)value;
+    }
+}
+
+static unsigned long long as_unsigned(uint64_t value, length_t len)
+{
+    switch (len) {
+        case LEN_HH: return (unsigned char)value;
+        case LEN_H: return (unsigned short)value;
+        case LEN_L: return (unsigned long)value;
+        case LEN_LL: return (unsigned long long)value;
+        case LEN_Z: return (size_t)value;
+        default: return (unsigned int)value;
+    }
+}
+
+size_t dlog_format(char *out, size_t out_size, const char *fmt,
+                   const uint64_t *args, size_t argc)
+{
+    if (!out || out_size == 0) {
+        return 0;
+    }
+
+    out_t o = {.out = out, .size = out_size, .pos = 0};
+    out[0] = '\0';
+    if (!fmt) {
+        return 0;
+    }
+
+    size_t next = 0;
+    const char *p = fmt;
+    while (*p) {
+        if (*p != '%') {
+            const char *start = p;
+            while (*p && *p != '%') {
+                p++;
+            }
+            put_str(&o, start, (size_t)(p - start));
+            continue;
+        }
+
+        if (p[1] == '%') {
+            put_str(&o, "%", 1);
+            p += 2;
+            continue;
+        }
+
+        const char *spec_start = p++;
+        char spec[SPEC_MAX];
+        size_t n = 0;
+        spec[n++] = '%';
+
+        while (*p && strchr("-+ #0", *p) && n < SPEC_MAX - 8) {
+            spec[n++] = *p++;
+        }
+        bool ok = copy_number(&p, spec, &n, args, argc, &next, false);
+        if (ok && *p == '.') {
+            spec[n++] = *p++;
+            ok = copy_number(&p, spec, &n, args, argc, &next, true);
+        }
+        length_t len = parse_length(&p);
+        char conv = *p;
+        if (conv) {
+            p++;
+        }
+
+        uint64_t value = 0;
+        if (strchr("diuxXocsfFeEgGaAp", conv) == NULL || conv == '\0') {
+            put_str(&o, spec_start, (size_t)(p - spec_start));
+            continue;
+        }
+        if (!ok || !next_arg(args, argc, &next, &value)) {
+            put_str(&o, "<?>", 3);
+            continue;
+        }
+
+        switch (conv) {
+            case 'd':
+            case 'i':
+                memcpy(spec + n, "ll", 2);
+                spec[n + 2] = conv;
+                spec[n + 3] = '\0';
+                put_spec(&o, spec, as_signed(value, len));
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                memcpy(spec + n, "ll", 2);
+                spec[n + 2] = conv;
+                spec[n + 3] = '\0';
+                put_spec(&o, spec, as_unsigned(value, len));
+                break;
+            case 'c':
+                spec[n] = conv;
+                spec[n + 1] = '\0';
+                put_spec(&o, spec, (int)(unsigned char)value);
+                break;
+            case 's': {
+                const char *s = (const char *)(uintptr_t)value;
+                spec[n] = conv;
+                spec[n + 1] = '\0';
+                put_spec(&o, spec, s ? s : "(null)");
+                break;
+            }
+            case 'p':
+                spec[n] = conv;
+                spec[n + 1] = '\0';
+                put_spec(&o, spec, (void *)(uintptr_t)value);
+                break;
+            default: {
+                double d;
+                memcpy(&d, &value, sizeof(d));
+                spec[n] = conv;
+                spec[n + 1] = '\0';
+                put_spec(&o, spec, d);
+                break;
+            }
+        }
+    }
+
+    return o.pos;
+}
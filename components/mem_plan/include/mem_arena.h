@@ -0,0 +1,91 @@
+/*
+ * Memory Arena
+ *
+ * Bump allocator over one block reserved at boot. Allocations are never
+ * freed individually; the arena is sealed once boot is done so any later
+ * request fails loudly instead of fragmenting the heap. Every allocation
+ * is recorded with a tag for the placement report.
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MEM_ARENA_MAX_ENTRIES 16  // Allocations recorded per arena
+
+typedef struct {
+    const char *tag;
+    size_t offset;  // From the arena base
+    size_t size;
+} mem_arena_entry_t;
+
+typedef struct {
+    const char *name;
+    uint8_t *base;
+    size_t size;
+    size_t used;             // Including alignment padding
+    bool sealed;
+    uint16_t entry_count;
+    uint16_t failed;         // Requests refused (full, sealed or too many entries)
+    size_t failed_bytes;
+    mem_arena_entry_t entries[MEM_ARENA_MAX_ENTRIES];
+} mem_arena_t;
+
+/**
+ * @brief Set up an arena over a block of memory
+ *
+ * @param arena Arena to initialize
+ * @param name Name for the report (not copied)
+ * @param base Start of the block (may be NULL with size 0)
+ * @param size Block size in bytes
+ */
+void mem_arena_init(mem_arena_t *arena, const char *name, void *base, size_t size);
+
+/**
+ * @brief Carve a zeroed block from the arena
+ *
+ * @param arena Arena
+ * @param size Bytes needed (> 0)
+ * @param align Alignment of the returned address (power of two, 0 = 4)
+ * @param tag Owner name for the report (not copied)
+ * @return Block, or NULL if the arena is sealed, full or out of entries
+ */
+void *mem_arena_alloc(mem_arena_t *arena, size_t size, size_t align, const char *tag);
+
+/**
+ * @brief Refuse all further allocations
+ *
+ * @param arena Arena
+ */
+void mem_arena_seal(mem_arena_t *arena);
+
+/**
+ * @brief Bytes still available (ignoring alignment)
+ *
+ * @param arena Arena
+ * @return Unused bytes
+ */
+size_t mem_arena_free_bytes(const mem_arena_t *arena);
+
+/**
+ * @brief Worst-case arena space used by one allocation
+ *
+ * Sum this over planned allocations to size an arena.
+ *
+ * @param size Bytes needed
+ * @param align Alignment (power of two, 0 = 4)
+ * @return size plus the most padding the alignment can add
+ */
+size_t mem_arena_footprint(size_t size, size_t align);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,92 @@
+/*
+ * Boot-Time Memory Planner
+ *
+ * Long-lived buffers (logger rings, write buffers, LVGL draw buffers) are
+ * carved from three arenas reserved once at boot, one per memory type.
+ * Components add their needs to a budget before anything is initialized,
+ * the planner reserves exactly that much, and the arenas are sealed when
+ * boot is done. Placement is explicit: there is no fallback from one
+ * region to another, and the report shows what went where.
+ *
+ * Arena memory is never returned; deinitialized components keep their
+ * blocks and reuse them on the next init. Allocation is not thread-safe
+ * and is meant for the boot task only.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include "esp_err.h"
+#include "mem_arena.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    MEM_REGION_DMA = 0,   // Internal, DMA-capable (LCD draw buffers)
+    MEM_REGION_INTERNAL,  // Internal, fast (control structures)
+    MEM_REGION_PSRAM,     // External (large rings and write buffers)
+    MEM_REGION_COUNT
+} mem_region_t;
+
+typedef struct {
+    size_t bytes[MEM_REGION_COUNT];
+} mem_plan_budget_t;
+
+/**
+ * @brief Add one planned allocation to a budget
+ *
+ * @param budget Budget to add to
+ * @param region Region the block will be allocated from
+ * @param size Block size in bytes
+ * @param align Alignment that will be requested (0 = 4)
+ */
+void mem_plan_budget_add(mem_plan_budget_t *budget, mem_region_t region,
+                         size_t size, size_t align);
+
+/**
+ * @brief Reserve the arenas
+ *
+ * Must be called once, before any component allocates from the plan.
+ *
+ * @param budget Bytes per region
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if a region cannot be
+ *         reserved (the other regions are still usable)
+ */
+esp_err_t mem_plan_init(const mem_plan_budget_t *budget);
+
+/**
+ * @brief Allocate a zeroed block from a region
+ *
+ * @param region Region to allocate from
+ * @param size Block size in bytes
+ * @param align Alignment (power of two, 0 = 4)
+ * @param tag Owner name for the report (string literal)
+ * @return Block, or NULL if the region is sealed, unplanned or exhausted
+ */
+void *mem_plan_alloc(mem_region_t region, size_t size, size_t align, const char *tag);
+
+/**
+ * @brief Seal all arenas; later allocations fail
+ */
+void mem_plan_seal(void);
+
+/**
+ * @brief Log every arena, its allocations and the remaining heap
+ */
+void mem_plan_log_report(void);
+
+/**
+ * @brief Get a copy of one arena for display
+ *
+ * @param region Region
+ * @param out Arena copy
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG for a bad region
+ */
+esp_err_t mem_plan_get_arena(mem_region_t region, mem_arena_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Memory Arena - Implementation
+ */
+
+#include "mem_arena.h"
+
+#include <string.h>
+
+#define DEFAULT_ALIGN 4
+
+static size_t effective_align(size_t align)
+{
+    if (align == 0 || (align & (align - 1)) != 0) {
+        return DEFAULT_ALIGN;
+    }
+    return align;
+}
+
+void mem_arena_init(mem_arena_t *arena, const char *name, void *base, size_t size)
+{
+    if (!arena) {
+        return;
+    }
+
+    memset(arena, 0, sizeof(*arena));
+    arena->name = name;
+    arena->base = base;
+    arena->size = base ? size : 0;
+}
+
+void *mem_arena_alloc(mem_arena_t *arena, size_t size, size_t align, const char *tag)
+{
+    if (!arena) {
+        return NULL;
+    }
+
+    align = effective_align(align);
+    uintptr_t start = (uintptr_t)arena->base + arena->used;
+    uintptr_t aligned = (start + align - 1) & ~((uintptr_t)align - 1);
+    size_t padding = (size_t)(aligned - start);
+
+    if (arena->sealed || size == 0 || arena->entry_count >= MEM_ARENA_MAX_ENTRIES ||
+        !arena->base || padding > arena->size - arena->used ||
+        size > arena->size - arena->used - padding) {
+        arena->failed++;
+        arena->failed_bytes += size;
+        return NULL;
+    }
+
+    mem_arena_entry_t *entry = &arena->entries[arena->entry_count++];
+    entry->tag = tag;
+    entry->offset = arena->used + padding;
+    entry->size = size;
+
+    arena->used += padding + size;
+
+    void *block = (void *)aligned;
+    memset(block, 0, size);
+    return block;
+}
+
+void mem_arena_seal(mem_arena_t *arena)
+{
+    if (arena) {
+        arena->sealed = true;
+    }
+}
+
+size_t mem_arena_free_bytes(const mem_arena_t *arena)
+{
+    return arena ? arena->size - arena->used : 0;
+}
+
+size_t mem_arena_footprint(size_t size, size_t align)
+{
+    return size + effective_align(align) - 1;
+}
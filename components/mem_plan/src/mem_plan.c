@@ -0,0 +1,150 @@
+/*
+ * Boot-Time Memory Planner Implementation
+ */
+
+#include <string.h>
+
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+
+#include "mem_plan.h"
+
+static const char *TAG = "mem_plan";
+
+static const struct {
+    const char *name;
+    uint32_t caps;
+} k_regions[MEM_REGION_COUNT] = {
+    [MEM_REGION_DMA] = {"dma", MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT},
+    [MEM_REGION_INTERNAL] = {"internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT},
+    [MEM_REGION_PSRAM] = {"psram", MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT},
+};
+
+// Module state
+static struct {
+    bool initialized;
+    mem_arena_t arenas[MEM_REGION_COUNT];
+} s_plan = {
+    .initialized = false
+};
+
+void mem_plan_budget_add(mem_plan_budget_t *budget, mem_region_t region,
+                         size_t size, size_t align)
+{
+    if (!budget || region >= MEM_REGION_COUNT || size == 0)
+    {
+        return;
+    }
+
+    budget->bytes[region] += mem_arena_footprint(size, align);
+}
+
+esp_err_t mem_plan_init(const mem_plan_budget_t *budget)
+{
+    if (!budget)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_plan.initialized)
+    {
+        ESP_LOGW(TAG, "Already initialized");
+        return ESP_OK;
+    }
+
+    esp_err_t result = ESP_OK;
+    for (int region = 0; region < MEM_REGION_COUNT; region++)
+    {
+        size_t bytes = budget->bytes[region];
+        void *base = NULL;
+        if (bytes > 0)
+        {
+            // Reserve the largest blocks first thing, before the heap fragments
+            base = heap_caps_malloc(bytes, k_regions[region].caps);
+            if (!base)
+            {
+                ESP_LOGE(TAG, "Cannot reserve %zu bytes of %s memory (largest block %zu)",
+                         bytes, k_regions[region].name,
+                         heap_caps_get_largest_free_block(k_regions[region].caps));
+                result = ESP_ERR_NO_MEM;
+            }
+        }
+        mem_arena_init(&s_plan.arenas[region], k_regions[region].name, base, bytes);
+    }
+
+    s_plan.initialized = true;
+    return result;
+}
+
+void *mem_plan_alloc(mem_region_t region, size_t size, size_t align, const char *tag)
+{
+    if (region >= MEM_REGION_COUNT)
+    {
+        return NULL;
+    }
+
+    if (!s_plan.initialized)
+    {
+        ESP_LOGE(TAG, "%s: allocation before mem_plan_init", tag ? tag : "?");
+        return NULL;
+    }
+
+    mem_arena_t *arena = &s_plan.arenas[region];
+    void *block = mem_arena_alloc(arena, size, align, tag);
+    if (!block)
+    {
+        ESP_LOGE(TAG, "%s: %zu bytes from %s arena refused (%s, %zu free)",
+                 tag ? tag : "?", size, arena->name,
+                 arena->sealed ? "sealed" : "not in plan", mem_arena_free_bytes(arena));
+    }
+    return block;
+}
+
+void mem_plan_seal(void)
+{
+    for (int region = 0; region < MEM_REGION_COUNT; region++)
+    {
+        mem_arena_seal(&s_plan.arenas[region]);
+    }
+}
+
+void mem_plan_log_report(void)
+{
+    for (int region = 0; region < MEM_REGION_COUNT; region++)
+    {
+        mem_arena_t arena;
+        mem_plan_get_arena((mem_region_t)region, &arena);
+
+        ESP_LOGI(TAG, "%-8s arena %7zu bytes, used %7zu, free %6zu%s",
+                 arena.name, arena.size, arena.used, mem_arena_free_bytes(&arena),
+                 arena.sealed ? " (sealed)" : "");
+        for (uint16_t i = 0; i < arena.entry_count; i++)
+        {
+            const mem_arena_entry_t *entry = &arena.entries[i];
+            ESP_LOGI(TAG, "  +%-7zu %7zu  %s", entry->offset, entry->size,
+                     entry->tag ? entry->tag : "?");
+        }
+        if (arena.failed > 0)
+        {
+            ESP_LOGW(TAG, "  %u requests refused (%zu bytes)",
+                     arena.failed, arena.failed_bytes);
+        }
+    }
+
+    ESP_LOGI(TAG, "Heap after plan: internal free %zu (largest %zu), psram free %zu (largest %zu)",
+             heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+             heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL),
+             heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+             heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM));
+}
+
+esp_err_t mem_plan_get_arena(mem_region_t region, mem_arena_t *out)
+{
+    if (region >= MEM_REGION_COUNT || !out)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memcpy(out, &s_plan.arenas[region], sizeof(*out));
+    return ESP_OK;
+}
@@ -0,0 +1,70 @@
+/*
+ * OBD Discovery
+ *
+ * Builds the OBD poll list from what the car actually answers. At CAN
+ * start the poll list is whatever was found last time (or every
+ * candidate on a first boot), so the display fills in immediately;
+ * discovery (obd_discovery_core.h) then runs one request per poll cycle
+ * beside the normal polling. Once the VIN is known, a result cached in
+ * NVS for that VIN (and the same candidate table) ends discovery early;
+ * otherwise the probed result replaces the poll list and is cached.
+ *
+ * The CAN TX task calls obd_discovery_step() each cycle and polls only
+ * the candidates in obd_discovery_poll_mask(); the RX task passes OBD
+ * replies to obd_discovery_rx(). NVS must be initialized by the app.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "obd_discovery_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Load the last poll list and arm discovery
+ *
+ * @param candidates Candidate poll list (kept by pointer)
+ * @param count Number of candidates (<= OBD_DISCOVERY_MAX_CANDIDATES)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG on a bad list,
+ *         ESP_ERR_NO_MEM if the RX queue cannot be created
+ */
+esp_err_t obd_discovery_init(const obd_request_t *candidates, size_t count);
+
+/**
+ * @brief Pass a received frame to discovery (CAN RX task, never blocks)
+ *
+ * @param id CAN ID
+ * @param data 8 data bytes
+ * @param rx_us RX time
+ */
+void obd_discovery_rx(uint32_t id, const uint8_t *data, int64_t rx_us);
+
+/**
+ * @brief Advance discovery by at most one transmitted frame (CAN TX task)
+ */
+void obd_discovery_step(void);
+
+/**
+ * @brief Candidates to poll
+ *
+ * @return Bit per candidate index
+ */
+uint32_t obd_discovery_poll_mask(void);
+
+/**
+ * @brief Whether discovery has finished
+ *
+ * @return true once the poll list is final for this drive
+ */
+bool obd_discovery_is_done(void);
+
+#ifdef __cplusplus
+}
+#endif
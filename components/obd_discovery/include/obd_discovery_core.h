@@ -0,0 +1,172 @@
+/*
+ * OBD Discovery Core
+ *
+ * Works out which entries of a candidate poll list the car answers. The
+ * sequence, one request in flight at a time:
+ *
+ *   1. VIN     Mode 0x09 PID 0x02 to the first candidate's ECU, reassembled
+ *              from ISO-TP (first frame, flow control, consecutive frames)
+ *   2. PIDS    Mode 0x01 supported-PID bitmaps (0x00, 0x20, ...) from every
+ *              ECU with a mode 0x01 candidate, while the bitmap advertises
+ *              the next range
+ *   3. PROBE   Each remaining candidate (e.g. Toyota mode 0x21) is sent once;
+ *              a positive reply marks it supported, a negative reply or two
+ *              timeouts do not
+ *
+ * After the VIN step the caller may look the VIN up in a cache and finish
+ * with obd_discovery_core_use_cached() instead. Physical addressing only:
+ * replies are expected on the request ID + 8. A candidate with a non-zero
+ * ext_addr uses ISO-TP extended addressing: its requests (and flow
+ * control) start with that address byte, and the first byte of each reply
+ * (the tester's address) is skipped.
+ *
+ * The core is driven by the caller: obd_discovery_core_next() hands out
+ * the next frame to send (handling timeouts against the given clock) and
+ * obd_discovery_core_rx() takes the replies.
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OBD_DISCOVERY_MAX_CANDIDATES 32
+#define OBD_DISCOVERY_MAX_ECUS 4
+#define OBD_DISCOVERY_VIN_LEN 17
+#define OBD_DISCOVERY_TIMEOUT_US 100000     // Reply deadline per request
+#define OBD_DISCOVERY_ISOTP_TIMEOUT_US 1000000  // Between consecutive frames
+#define OBD_DISCOVERY_RESPONSE_OFFSET 8
+
+// One entry of the poll list
+typedef struct {
+    uint16_t header;
+    uint8_t service;
+    uint8_t pid;
+    uint8_t ext_addr;           // ISO-TP extended address, 0 for normal addressing
+} obd_request_t;
+
+typedef enum {
+    OBD_DISCOVERY_VIN = 0,
+    OBD_DISCOVERY_PIDS,
+    OBD_DISCOVERY_PROBE,
+    OBD_DISCOVERY_DONE
+} obd_discovery_phase_t;
+
+// A frame to transmit (8 data bytes, padded)
+typedef struct {
+    uint16_t id;
+    uint8_t data[8];
+} obd_discovery_tx_t;
+
+typedef struct {
+    uint16_t header;
+    uint8_t ext_addr;
+    uint32_t supported[8];      // Mode 0x01 PIDs 0x00-0xFF, bit n = PID n
+    bool answered;              // Sent at least one bitmap
+} obd_discovery_ecu_t;
+
+typedef struct {
+    const obd_request_t *candidates;
+    size_t count;
+    obd_discovery_phase_t phase;
+
+    // Request in flight
+    bool waiting;
+    int64_t deadline_us;
+    uint16_t wait_id;           // Expected reply ID
+    uint8_t wait_ext_addr;      // Extended address of the request, 0 if none
+    uint8_t wait_service;       // Expected positive service (request + 0x40)
+    uint8_t wait_pid;
+    uint8_t retries;
+
+    // Progress within the phase
+    size_t ecu;                 // PIDS: ECU index
+    uint16_t range;             // PIDS: next bitmap PID (0x00, 0x20, ...)
+    size_t probe;               // PROBE: candidate index
+
+    // VIN reassembly
+    uint8_t isotp[32];
+    size_t isotp_len;
+    size_t isotp_expected;
+    uint8_t isotp_sn;
+    bool send_fc;
+    char vin[OBD_DISCOVERY_VIN_LEN + 1];
+
+    obd_discovery_ecu_t ecus[OBD_DISCOVERY_MAX_ECUS];
+    size_t ecu_count;
+    uint32_t probed_mask;       // Candidates answered in PROBE
+    uint32_t supported_mask;    // Result, bit per candidate (valid once DONE)
+    uint32_t requests;
+    uint32_t timeouts;
+} obd_discovery_core_t;
+
+/**
+ * @brief Start discovery over a candidate list
+ *
+ * @param d Discovery state
+ * @param candidates Candidate poll list (kept by pointer)
+ * @param count Number of candidates (<= OBD_DISCOVERY_MAX_CANDIDATES)
+ * @return true on success, false on bad arguments
+ */
+bool obd_discovery_core_init(obd_discovery_core_t *d, const obd_request_t *candidates,
+                             size_t count);
+
+/**
+ * @brief Next frame to transmit
+ *
+ * Call regularly; expired requests are retried or given up here.
+ *
+ * @param d Discovery state
+ * @param now_us Current time
+ * @param tx Filled with the frame to send
+ * @return true if tx holds a frame, false while waiting or when done
+ */
+bool obd_discovery_core_next(obd_discovery_core_t *d, int64_t now_us, obd_discovery_tx_t *tx);
+
+/**
+ * @brief Feed a received frame
+ *
+ * @param d Discovery state
+ * @param id CAN ID
+ * @param data 8 data bytes
+ * @param now_us Receive time
+ */
+void obd_discovery_core_rx(obd_discovery_core_t *d, uint32_t id, const uint8_t *data,
+                           int64_t now_us);
+
+/**
+ * @brief Finish with a cached result instead of probing
+ *
+ * @param d Discovery state
+ * @param supported_mask Bit per candidate
+ */
+void obd_discovery_core_use_cached(obd_discovery_core_t *d, uint32_t supported_mask);
+
+/**
+ * @brief Stable hash of a candidate list, to invalidate cached results
+ *
+ * @param candidates Candidate list
+ * @param count Number of candidates
+ * @return FNV-1a hash of the request fields
+ */
+uint32_t obd_discovery_core_table_hash(const obd_request_t *candidates, size_t count);
+
+/**
+ * @brief Whether a mode 0x01 PID is set in a supported-PID bitmap
+ *
+ * @param ecu ECU entry
+ * @param pid PID
+ * @return true if supported
+ */
+bool obd_discovery_core_pid_supported(const obd_discovery_ecu_t *ecu, uint8_t pid);
+
+#ifdef __cplusplus
+}
+#endif
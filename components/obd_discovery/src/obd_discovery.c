@@ -0,0 +1,279 @@
+/*
+ * OBD Discovery Implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <driver/twai.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <nvs.h>
+
+#include "obd_discovery.h"
+
+static const char *TAG = "obd_discovery";
+
+#define DISCOVERY_RX_QUEUE_LEN 8
+#define DISCOVERY_TX_TIMEOUT_MS 10
+#define DISCOVERY_CACHE_VERSION 1
+#define DISCOVERY_ID_MIN 0x700              // Diagnostic reply range
+#define DISCOVERY_ID_MAX 0x7FF
+
+static const char *k_cache_namespace = "obd_disc";
+static const char *k_last_key = "last";
+
+// NVS blob, one per VIN plus a copy of the latest under k_last_key
+typedef struct {
+    uint32_t version;
+    uint32_t table_hash;
+    char vin[OBD_DISCOVERY_VIN_LEN + 1];
+    uint32_t supported_mask;
+} cache_entry_t;
+
+typedef struct {
+    uint32_t id;
+    uint8_t data[8];
+    int64_t rx_us;
+} rx_item_t;
+
+// Module state
+static struct {
+    obd_discovery_core_t core;          // TX task only
+    QueueHandle_t rx_queue;
+    uint32_t table_hash;
+    uint32_t all_mask;
+    uint32_t poll_mask;                 // Read from the TX task, set by step()
+    bool active;                        // RX task feeds the queue while set
+    bool cache_checked;
+    bool from_cache;
+} s_disc = {
+    .rx_queue = NULL,
+    .poll_mask = 0,
+    .active = false
+};
+
+// NVS keys are limited to 15 characters; a VIN is 17
+static void vin_key(const char *vin, char *key, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (const char *p = vin; *p; p++)
+    {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    snprintf(key, len, "v%08lx", (unsigned long)hash);
+}
+
+static bool cache_load(const char *key, const char *vin, uint32_t *mask_out)
+{
+    nvs_handle_t handle = 0;
+    if (nvs_open(k_cache_namespace, NVS_READONLY, &handle) != ESP_OK)
+    {
+        return false;
+    }
+
+    cache_entry_t entry = {0};
+    size_t size = sizeof(entry);
+    esp_err_t err = nvs_get_blob(handle, key, &entry, &size);
+    nvs_close(handle);
+
+    if (err != ESP_OK || size != sizeof(entry) || entry.version != DISCOVERY_CACHE_VERSION ||
+        entry.table_hash != s_disc.table_hash || entry.supported_mask == 0)
+    {
+        return false;
+    }
+    if (vin && strncmp(entry.vin, vin, sizeof(entry.vin)) != 0)
+    {
+        return false;
+    }
+    *mask_out = entry.supported_mask & s_disc.all_mask;
+    return true;
+}
+
+static void cache_store(const char *vin, uint32_t mask)
+{
+    nvs_handle_t handle = 0;
+    esp_err_t err = nvs_open(k_cache_namespace, NVS_READWRITE, &handle);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Cache open failed: %s", esp_err_to_name(err));
+        return;
+    }
+
+    cache_entry_t entry = {
+        .version = DISCOVERY_CACHE_VERSION,
+        .table_hash = s_disc.table_hash,
+        .supported_mask = mask
+    };
+    strncpy(entry.vin, vin, sizeof(entry.vin) - 1);
+
+    if (vin[0] != '\0')
+    {
+        char key[16];
+        vin_key(vin, key, sizeof(key));
+        err = nvs_set_blob(handle, key, &entry, sizeof(entry));
+    }
+    if (err == ESP_OK)
+    {
+        err = nvs_set_blob(handle, k_last_key, &entry, sizeof(entry));
+    }
+    if (err == ESP_OK)
+    {
+        err = nvs_commit(handle);
+    }
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Cache write failed: %s", esp_err_to_name(err));
+    }
+    nvs_close(handle);
+}
+
+static void finish(void)
+{
+    const obd_discovery_core_t *d = &s_disc.core;
+    __atomic_store_n(&s_disc.active, false, __ATOMIC_RELEASE);
+
+    if (d->supported_mask == 0)
+    {
+        // Ignition off or a silent bus: keep what we have and try next start
+        ESP_LOGW(TAG, "No ECU answered (%u requests); keeping the current poll list",
+                 (unsigned)d->requests);
+        return;
+    }
+
+    __atomic_store_n(&s_disc.poll_mask, d->supported_mask, __ATOMIC_RELEASE);
+    ESP_LOGI(TAG, "VIN %s: polling %d of %u requests (%s)", d->vin[0] ? d->vin : "unknown",
+             __builtin_popcount(d->supported_mask), (unsigned)d->count,
+             s_disc.from_cache ? "cached" : "discovered");
+
+    if (s_disc.from_cache)
+    {
+        // Only a different car than last time needs a write
+        uint32_t last_mask = 0;
+        if (!cache_load(k_last_key, d->vin, &last_mask) || last_mask != d->supported_mask)
+        {
+            cache_store(d->vin, d->supported_mask);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < d->count; i++)
+    {
+        if (!(d->supported_mask & (1u << i)))
+        {
+            ESP_LOGI(TAG, "Dropped 0x%03X %02X %02X: no reply", d->candidates[i].header,
+                     d->candidates[i].service, d->candidates[i].pid);
+        }
+    }
+    cache_store(d->vin, d->supported_mask);
+}
+
+esp_err_t obd_discovery_init(const obd_request_t *candidates, size_t count)
+{
+    if (!obd_discovery_core_init(&s_disc.core, candidates, count) || count == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_disc.rx_queue)
+    {
+        s_disc.rx_queue = xQueueCreate(DISCOVERY_RX_QUEUE_LEN, sizeof(rx_item_t));
+        if (!s_disc.rx_queue)
+        {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    s_disc.table_hash = obd_discovery_core_table_hash(candidates, count);
+    s_disc.all_mask = count >= 32 ? UINT32_MAX : (1u << count) - 1;
+    s_disc.cache_checked = false;
+    s_disc.from_cache = false;
+
+    uint32_t mask = 0;
+    if (cache_load(k_last_key, NULL, &mask))
+    {
+        ESP_LOGI(TAG, "Starting with the last poll list (%d of %u requests)",
+                 __builtin_popcount(mask), (unsigned)count);
+    }
+    else
+    {
+        mask = s_disc.all_mask;
+    }
+    __atomic_store_n(&s_disc.poll_mask, mask, __ATOMIC_RELEASE);
+    __atomic_store_n(&s_disc.active, true, __ATOMIC_RELEASE);
+    return ESP_OK;
+}
+
+void obd_discovery_rx(uint32_t id, const uint8_t *data, int64_t rx_us)
+{
+    // Broadcast traffic would crowd the replies out of the queue
+    if (id < DISCOVERY_ID_MIN || id > DISCOVERY_ID_MAX ||
+        !__atomic_load_n(&s_disc.active, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    rx_item_t item = {.id = id, .rx_us = rx_us};
+    memcpy(item.data, data, sizeof(item.data));
+    (void)xQueueSend(s_disc.rx_queue, &item, 0);
+}
+
+void obd_discovery_step(void)
+{
+    if (!__atomic_load_n(&s_disc.active, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    obd_discovery_core_t *d = &s_disc.core;
+    rx_item_t item;
+    while (xQueueReceive(s_disc.rx_queue, &item, 0) == pdTRUE)
+    {
+        obd_discovery_core_rx(d, item.id, item.data, item.rx_us);
+    }
+
+    if (!s_disc.cache_checked && d->phase != OBD_DISCOVERY_VIN)
+    {
+        s_disc.cache_checked = true;
+        uint32_t mask = 0;
+        char key[16];
+        vin_key(d->vin, key, sizeof(key));
+        if (d->vin[0] != '\0' && cache_load(key, d->vin, &mask))
+        {
+            s_disc.from_cache = true;
+            obd_discovery_core_use_cached(d, mask);
+        }
+    }
+
+    obd_discovery_tx_t tx;
+    if (obd_discovery_core_next(d, esp_timer_get_time(), &tx))
+    {
+        twai_message_t msg = {0};
+        msg.identifier = tx.id;
+        msg.data_length_code = 8;
+        memcpy(msg.data, tx.data, sizeof(msg.data));
+        esp_err_t err = twai_transmit(&msg, pdMS_TO_TICKS(DISCOVERY_TX_TIMEOUT_MS));
+        if (err != ESP_OK)
+        {
+            // Counts as unanswered once the deadline passes
+            ESP_LOGD(TAG, "Request to 0x%03X failed: %s", tx.id, esp_err_to_name(err));
+        }
+    }
+
+    if (d->phase == OBD_DISCOVERY_DONE)
+    {
+        finish();
+    }
+}
+
+uint32_t obd_discovery_poll_mask(void)
+{
+    return __atomic_load_n(&s_disc.poll_mask, __ATOMIC_ACQUIRE);
+}
+
+bool obd_discovery_is_done(void)
+{
+    return s_disc.rx_queue && !__atomic_load_n(&s_disc.active, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,350 @@
+/*
+ * OBD Discovery Core - Implementation
+ */
+
+#include "obd_discovery_core.h"
+
+#include <string.h>
+
+#define SID_CURRENT_DATA 0x01
+#define SID_VEHICLE_INFO 0x09
+#define PID_VIN 0x02
+#define SID_POSITIVE_OFFSET 0x40
+#define SID_NEGATIVE 0x7F
+#define NRC_RESPONSE_PENDING 0x78
+
+#define ISOTP_SINGLE 0x0
+#define ISOTP_FIRST 0x1
+#define ISOTP_CONSECUTIVE 0x2
+#define ISOTP_FLOW_CONTROL 0x30  // Clear to send, no block limit, no separation time
+
+bool obd_discovery_core_init(obd_discovery_core_t *d, const obd_request_t *candidates,
+                             size_t count)
+{
+    if (!d || (!candidates && count > 0) || count > OBD_DISCOVERY_MAX_CANDIDATES) {
+        return false;
+    }
+
+    memset(d, 0, sizeof(*d));
+    d->candidates = candidates;
+    d->count = count;
+    d->phase = count > 0 ? OBD_DISCOVERY_VIN : OBD_DISCOVERY_DONE;
+
+    // One bitmap query set per ECU with mode 0x01 candidates
+    for (size_t i = 0; i < count; i++) {
+        if (candidates[i].service != SID_CURRENT_DATA) {
+            continue;
+        }
+        bool known = false;
+        for (size_t e = 0; e < d->ecu_count; e++) {
+            known |= d->ecus[e].header == candidates[i].header &&
+                     d->ecus[e].ext_addr == candidates[i].ext_addr;
+        }
+        if (!known && d->ecu_count < OBD_DISCOVERY_MAX_ECUS) {
+            d->ecus[d->ecu_count].header = candidates[i].header;
+            d->ecus[d->ecu_count].ext_addr = candidates[i].ext_addr;
+            d->ecu_count++;
+        }
+    }
+    return true;
+}
+
+bool obd_discovery_core_pid_supported(const obd_discovery_ecu_t *ecu, uint8_t pid)
+{
+    return (ecu->supported[pid / 32] >> (pid % 32)) & 1u;
+}
+
+static const obd_discovery_ecu_t *find_ecu(const obd_discovery_core_t *d, uint16_t header,
+                                           uint8_t ext_addr)
+{
+    for (size_t e = 0; e < d->ecu_count; e++) {
+        if (d->ecus[e].header == header && d->ecus[e].ext_addr == ext_addr) {
+            return &d->ecus[e];
+        }
+    }
+    return NULL;
+}
+
+static void finish(obd_discovery_core_t *d)
+{
+    uint32_t mask = d->probed_mask;
+    for (size_t i = 0; i < d->count; i++) {
+        const obd_request_t *c = &d->candidates[i];
+        if (c->service != SID_CURRENT_DATA) {
+            continue;
+        }
+        const obd_discovery_ecu_t *ecu = find_ecu(d, c->header, c->ext_addr);
+        if (ecu && ecu->answered && obd_discovery_core_pid_supported(ecu, c->pid)) {
+            mask |= 1u << i;
+        }
+    }
+    d->supported_mask = mask;
+    d->phase = OBD_DISCOVERY_DONE;
+    d->waiting = false;
+}
+
+// Move past the current request, whatever its outcome
+static void advance(obd_discovery_core_t *d)
+{
+    d->waiting = false;
+    d->retries = 0;
+    switch (d->phase) {
+        case OBD_DISCOVERY_VIN:
+            d->phase = OBD_DISCOVERY_PIDS;
+            d->ecu = 0;
+            d->range = 0;
+            break;
+        case OBD_DISCOVERY_PIDS:
+            d->ecu++;
+            d->range = 0;
+            break;
+        case OBD_DISCOVERY_PROBE:
+            d->probe++;
+            break;
+        default:
+            break;
+    }
+}
+
+static void request(obd_discovery_core_t *d, obd_discovery_tx_t *tx, uint16_t header,
+                    uint8_t ext_addr, uint8_t service, uint8_t pid, int64_t now_us)
+{
+    // Extended addressing shifts the ISO-TP frame one byte to the right
+    memset(tx, 0, sizeof(*tx));
+    uint8_t *frame = ext_addr ? &tx->data[1] : tx->data;
+    tx->id = header;
+    tx->data[0] = ext_addr;
+    frame[0] = 0x02;
+    frame[1] = service;
+    frame[2] = pid;
+
+    d->wait_ext_addr = ext_addr;
+    d->waiting = true;
+    d->deadline_us = now_us + OBD_DISCOVERY_TIMEOUT_US;
+    d->wait_id = (uint16_t)(header + OBD_DISCOVERY_RESPONSE_OFFSET);
+    d->wait_service = (uint8_t)(service + SID_POSITIVE_OFFSET);
+    d->wait_pid = pid;
+    d->requests++;
+}
+
+// Issue the next request of the current phase, moving through phases as they run out
+static bool issue(obd_discovery_core_t *d, int64_t now_us, obd_discovery_tx_t *tx)
+{
+    while (1) {
+        switch (d->phase) {
+            case OBD_DISCOVERY_VIN:
+                d->isotp_len = 0;
+                d->isotp_expected = 0;
+                request(d, tx, d->candidates[0].header, d->candidates[0].ext_addr,
+                        SID_VEHICLE_INFO, PID_VIN, now_us);
+                return true;
+
+            case OBD_DISCOVERY_PIDS:
+                while (d->ecu < d->ecu_count) {
+                    const obd_discovery_ecu_t *e = &d->ecus[d->ecu];
+                    // Each bitmap advertises the next one in its last bit
+                    bool more = d->range <= 0xE0 &&
+                                obd_discovery_core_pid_supported(e, (uint8_t)d->range);
+                    if (d->range == 0 || more) {
+                        request(d, tx, e->header, e->ext_addr, SID_CURRENT_DATA,
+                                (uint8_t)d->range, now_us);
+                        return true;
+                    }
+                    d->ecu++;
+                    d->range = 0;
+                }
+                d->phase = OBD_DISCOVERY_PROBE;
+                d->probe = 0;
+                break;
+
+            case OBD_DISCOVERY_PROBE:
+                while (d->probe < d->count) {
+                    const obd_request_t *c = &d->candidates[d->probe];
+                    if (c->service != SID_CURRENT_DATA) {
+                        request(d, tx, c->header, c->ext_addr, c->service, c->pid, now_us);
+                        return true;
+                    }
+                    d->probe++;
+                }
+                finish(d);
+                return false;
+
+            default:
+                return false;
+        }
+    }
+}
+
+bool obd_discovery_core_next(obd_discovery_core_t *d, int64_t now_us, obd_discovery_tx_t *tx)
+{
+    if (d->phase == OBD_DISCOVERY_DONE) {
+        return false;
+    }
+
+    if (d->send_fc) {
+        d->send_fc = false;
+        memset(tx, 0, sizeof(*tx));
+        tx->id = (uint16_t)(d->wait_id - OBD_DISCOVERY_RESPONSE_OFFSET);
+        tx->data[0] = d->wait_ext_addr;
+        tx->data[d->wait_ext_addr ? 1 : 0] = ISOTP_FLOW_CONTROL;
+        return true;
+    }
+
+    if (d->waiting) {
+        if (now_us < d->deadline_us) {
+            return false;
+        }
+        d->timeouts++;
+        d->waiting = false;
+        // One retry, then the request counts as unanswered
+        if (d->retries == 0) {
+            d->retries = 1;
+        } else {
+            advance(d);
+        }
+    }
+
+    return issue(d, now_us, tx);
+}
+
+// data is the ISO-TP frame with any extended address byte removed, so it
+// holds one byte less payload under extended addressing
+static void vin_rx(obd_discovery_core_t *d, const uint8_t *data, int64_t now_us)
+{
+    size_t frame_len = d->wait_ext_addr ? 7 : 8;
+    uint8_t pci = data[0] >> 4;
+
+    if (pci == ISOTP_FIRST) {
+        size_t len = ((size_t)(data[0] & 0x0F) << 8) | data[1];
+        if (data[2] != d->wait_service || data[3] != PID_VIN || len > sizeof(d->isotp) ||
+            len < OBD_DISCOVERY_VIN_LEN + 2) {
+            advance(d);
+            return;
+        }
+        memcpy(d->isotp, &data[2], frame_len - 2);
+        d->isotp_len = frame_len - 2;
+        d->isotp_expected = len;
+        d->isotp_sn = 1;
+        d->send_fc = true;
+        d->deadline_us = now_us + OBD_DISCOVERY_ISOTP_TIMEOUT_US;
+        return;
+    }
+
+    if (pci != ISOTP_CONSECUTIVE || d->isotp_expected == 0) {
+        return;
+    }
+    if ((data[0] & 0x0F) != d->isotp_sn) {
+        advance(d);
+        return;
+    }
+
+    size_t n = d->isotp_expected - d->isotp_len;
+    if (n > frame_len - 1) {
+        n = frame_len - 1;
+    }
+    memcpy(d->isotp + d->isotp_len, &data[1], n);
+    d->isotp_len += n;
+    d->isotp_sn = (d->isotp_sn + 1) & 0x0F;
+    d->deadline_us = now_us + OBD_DISCOVERY_ISOTP_TIMEOUT_US;
+    if (d->isotp_len < d->isotp_expected) {
+        return;
+    }
+
+    // 49 02 [item count] VIN: the VIN is the last 17 bytes
+    const uint8_t *vin = d->isotp + d->isotp_expected - OBD_DISCOVERY_VIN_LEN;
+    bool printable = true;
+    for (size_t i = 0; i < OBD_DISCOVERY_VIN_LEN; i++) {
+        printable &= vin[i] >= 0x20 && vin[i] < 0x7F;
+    }
+    if (printable) {
+        memcpy(d->vin, vin, OBD_DISCOVERY_VIN_LEN);
+        d->vin[OBD_DISCOVERY_VIN_LEN] = '\0';
+    }
+    advance(d);
+}
+
+void obd_discovery_core_rx(obd_discovery_core_t *d, uint32_t id, const uint8_t *data,
+                           int64_t now_us)
+{
+    if (!d->waiting || id != d->wait_id) {
+        return;
+    }
+
+    uint8_t shifted[8] = {0};
+    if (d->wait_ext_addr) {
+        memcpy(shifted, &data[1], 7);
+        data = shifted;
+    }
+
+    // Negative response (single frame): 03 7F <service> <code>
+    if ((data[0] >> 4) == ISOTP_SINGLE && data[1] == SID_NEGATIVE &&
+        data[2] == (uint8_t)(d->wait_service - SID_POSITIVE_OFFSET)) {
+        if (data[3] == NRC_RESPONSE_PENDING) {
+            d->deadline_us = now_us + OBD_DISCOVERY_TIMEOUT_US;
+        } else {
+            advance(d);
+        }
+        return;
+    }
+
+    switch (d->phase) {
+        case OBD_DISCOVERY_VIN:
+            vin_rx(d, data, now_us);
+            break;
+
+        case OBD_DISCOVERY_PIDS: {
+            if ((data[0] & 0x0F) < 6 || data[1] != d->wait_service || data[2] != d->wait_pid) {
+                return;
+            }
+            obd_discovery_ecu_t *e = &d->ecus[d->ecu];
+            uint32_t bits = ((uint32_t)data[3] << 24) | ((uint32_t)data[4] << 16) |
+                            ((uint32_t)data[5] << 8) | data[6];
+            // Bit 31 of the reply is PID range + 1
+            for (int j = 0; j < 32; j++) {
+                unsigned pid = d->range + 1u + (unsigned)j;
+                if (pid <= 0xFF && (bits >> (31 - j)) & 1u) {
+                    e->supported[pid / 32] |= 1u << (pid % 32);
+                }
+            }
+            e->answered = true;
+            d->range += 0x20;
+            d->waiting = false;
+            d->retries = 0;
+            break;
+        }
+
+        case OBD_DISCOVERY_PROBE:
+            if (data[1] != d->wait_service || data[2] != d->wait_pid) {
+                return;
+            }
+            d->probed_mask |= 1u << d->probe;
+            advance(d);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void obd_discovery_core_use_cached(obd_discovery_core_t *d, uint32_t supported_mask)
+{
+    d->supported_mask = supported_mask;
+    d->phase = OBD_DISCOVERY_DONE;
+    d->waiting = false;
+    d->send_fc = false;
+}
+
+uint32_t obd_discovery_core_table_hash(const obd_request_t *candidates, size_t count)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t fields[5] = {
+            (uint8_t)(candidates[i].header >> 8), (uint8_t)candidates[i].header,
+            candidates[i].service, candidates[i].pid, candidates[i].ext_addr
+        };
+        for (size_t b = 0; b < sizeof(fields); b++) {
+            hash = (hash ^ fields[b]) * 16777619u;
+        }
+    }
+    return hash;
+}
@@ -6,6 +6,11 @@
  *
  * Note: I2C must be initialized before calling pcf_rtc_init().
  * The display_manager component handles I2C initialization.
+ *
+ * Reads are served from a cached (RTC time, esp_timer) pair that is
+ * extrapolated locally; a low-priority task re-reads the chip once a
+ * minute, so callers never wait on the shared I2C bus. Rollover captures
+ * re-anchor the cache with sub-second phase.
  */
 
 #pragma once
@@ -30,6 +35,14 @@ typedef struct {
     uint8_t sec;        // 0-59
 } pcf_datetime_t;
 
+// Seconds rollover captured against esp_timer
+typedef struct {
+    int64_t edge_us;            // esp_timer time of the rollover (window midpoint)
+    uint32_t uncertainty_us;    // Half-width of the capture window
+    int64_t unix_sec;           // Unix second that began at the rollover
+    pcf_datetime_t time;        // RTC time just after the rollover
+} pcf_rtc_edge_t;
+
 /**
  * @brief Initialize the RTC
  *
@@ -59,7 +72,7 @@ bool pcf_rtc_is_initialized(void);
  *
  * Returns true if the time has been set to a reasonable value
  * (year >= 2024). This can be used to detect if the RTC has
- * never been set or lost power.
+ * never been set or lost power. Served from the time cache.
  *
  * @return true if time appears valid, false otherwise
  */
@@ -68,8 +81,11 @@ bool pcf_rtc_is_time_valid(void);
 /**
  * @brief Get the current time from the RTC
  *
+ * Extrapolated from the time cache; never touches I2C.
+ *
  * @param time Pointer to structure to fill with current time
- * @return ESP_OK on success, error code otherwise
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the RTC is not
+ *         initialized or the chip has not been read successfully yet
  */
 esp_err_t pcf_rtc_get_time(pcf_datetime_t *time);
 
@@ -81,6 +97,55 @@ esp_err_t pcf_rtc_get_time(pcf_datetime_t *time);
  */
 esp_err_t pcf_rtc_set_time(const pcf_datetime_t *time);
 
+/**
+ * @brief Capture the next seconds rollover
+ *
+ * Polls the seconds register until it increments and brackets the
+ * rollover between the two surrounding reads, giving sub-millisecond
+ * phase from a chip that only reports whole seconds. The mutex is taken
+ * per read, so other RTC users are not blocked for the whole window.
+ *
+ * @param timeout_ms Give up if no rollover is seen within this time
+ *                   (at least 1000 to be sure of catching one)
+ * @param edge Filled with the captured rollover
+ * @return ESP_OK on success, ESP_ERR_TIMEOUT if no rollover was seen,
+ *         ESP_ERR_INVALID_STATE if the RTC time is not valid
+ */
+esp_err_t pcf_rtc_capture_second_edge(uint32_t timeout_ms, pcf_rtc_edge_t *edge);
+
+/**
+ * @brief Complete a rollover timestamped externally (CLKOUT interrupt)
+ *
+ * Reads the time that began at the rollover and re-anchors the time
+ * cache on it. Call promptly, well within a second of the edge.
+ *
+ * @param edge_us esp_timer time of the rollover
+ * @param uncertainty_us Timestamp uncertainty
+ * @param edge Filled with the completed rollover
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if the RTC time is not valid
+ */
+esp_err_t pcf_rtc_stamp_edge(int64_t edge_us, uint32_t uncertainty_us, pcf_rtc_edge_t *edge);
+
+/**
+ * @brief Route a 1 Hz square wave to the CLKOUT pin
+ *
+ * The 1 Hz output is derived from the same divider chain as the seconds
+ * counter, so an interrupt on it timestamps rollovers without polling.
+ *
+ * @param enable true for 1 Hz, false to restore the 32.768 kHz default
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t pcf_rtc_set_clkout_1hz(bool enable);
+
+/**
+ * @brief Convert an RTC datetime to Unix seconds
+ *
+ * @param time Datetime to convert
+ * @param unix_sec Filled with seconds since the epoch
+ * @return true on success, false if the datetime cannot be represented
+ */
+bool pcf_rtc_datetime_to_unix(const pcf_datetime_t *time, int64_t *unix_sec);
+
 /**
  * @brief Sync system time from RTC
  *
@@ -12,8 +12,10 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include <freertos/task.h>
 #include <driver/i2c.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 
 #include "rtc_pcf85063a.h"
 
@@ -45,6 +47,19 @@ static const char *TAG = "rtc";
 // Control register 1 bits
 #define RTC_CTRL_1_CAP_SEL  0x01    // 12.5pF load capacitance
 
+// Control register 2 CLKOUT frequency field (COF[2:0])
+#define RTC_CTRL_2_COF_MASK     0x07
+#define RTC_CTRL_2_COF_32768HZ  0x00
+#define RTC_CTRL_2_COF_1HZ      0x06
+
+// Readers only extrapolate the cached time with esp_timer; a background
+// task re-checks it against the chip at this interval (sooner while the
+// cache is empty). Rollover captures (timebase) re-anchor it in between.
+#define CACHE_REFRESH_MS    60000
+#define CACHE_RETRY_MS      1000
+#define REFRESH_TASK_STACK  3072
+#define REFRESH_TASK_PRIO   1
+
 // Day of week names
 static const char *k_day_names[] = {
     "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
@@ -55,12 +70,31 @@ static struct {
     bool initialized;
     int i2c_port;
     SemaphoreHandle_t mutex;
+    TaskHandle_t refresh_task;
 } s_rtc = {
     .initialized = false,
     .i2c_port = -1,
-    .mutex = NULL
+    .mutex = NULL,
+    .refresh_task = NULL
 };
 
+// Time cache: RTC time at an esp_timer anchor (guarded by s_cache_lock)
+static struct {
+    bool valid;
+    bool phase_locked;      // Anchor is a captured seconds rollover
+    int64_t unix_sec;       // RTC time at anchor_us
+    int64_t anchor_us;
+    int64_t checked_us;     // Last time the chip was read (diagnostic)
+} s_cache = {
+    .valid = false,
+    .phase_locked = false,
+    .unix_sec = 0,
+    .anchor_us = 0,
+    .checked_us = 0
+};
+
+static portMUX_TYPE s_cache_lock = portMUX_INITIALIZER_UNLOCKED;
+
 // BCD conversion helpers
 static uint8_t dec_to_bcd(uint8_t val)
 {
@@ -99,6 +133,87 @@ static bool rtc_datetime_to_epoch(const pcf_datetime_t *time, time_t *epoch_out)
     return true;
 }
 
+static bool rtc_epoch_to_datetime(int64_t epoch, pcf_datetime_t *time_out)
+{
+    time_t t = (time_t)epoch;
+    struct tm tm_time;
+    if (!localtime_r(&t, &tm_time))
+    {
+        return false;
+    }
+
+    time_out->year = (uint16_t)(tm_time.tm_year + 1900);
+    time_out->month = (uint8_t)(tm_time.tm_mon + 1);
+    time_out->day = (uint8_t)tm_time.tm_mday;
+    time_out->dotw = (uint8_t)tm_time.tm_wday;
+    time_out->hour = (uint8_t)tm_time.tm_hour;
+    time_out->min = (uint8_t)tm_time.tm_min;
+    time_out->sec = (uint8_t)tm_time.tm_sec;
+    return true;
+}
+
+static void cache_store(int64_t unix_sec, int64_t anchor_us, bool phase_locked)
+{
+    portENTER_CRITICAL(&s_cache_lock);
+    s_cache.unix_sec = unix_sec;
+    s_cache.anchor_us = anchor_us;
+    s_cache.checked_us = anchor_us;
+    s_cache.phase_locked = phase_locked;
+    s_cache.valid = true;
+    portEXIT_CRITICAL(&s_cache_lock);
+}
+
+// Record a plain (unaligned) read. A rollover-aligned anchor that still
+// agrees with the chip is kept, since it carries the sub-second phase.
+static void cache_update_from_read(int64_t unix_sec, int64_t read_us)
+{
+    portENTER_CRITICAL(&s_cache_lock);
+    int64_t expected = s_cache.unix_sec + (read_us - s_cache.anchor_us) / 1000000LL;
+    int64_t diff = unix_sec - expected;
+    if (s_cache.valid && s_cache.phase_locked && diff >= -1 && diff <= 1)
+    {
+        s_cache.checked_us = read_us;
+    }
+    else
+    {
+        s_cache.unix_sec = unix_sec;
+        s_cache.anchor_us = read_us;
+        s_cache.checked_us = read_us;
+        s_cache.phase_locked = false;
+        s_cache.valid = true;
+    }
+    portEXIT_CRITICAL(&s_cache_lock);
+}
+
+static bool cache_lookup(int64_t now_us, int64_t *unix_sec)
+{
+    bool hit = false;
+    portENTER_CRITICAL(&s_cache_lock);
+    if (s_cache.valid && now_us >= s_cache.anchor_us)
+    {
+        *unix_sec = s_cache.unix_sec + (now_us - s_cache.anchor_us) / 1000000LL;
+        hit = true;
+    }
+    portEXIT_CRITICAL(&s_cache_lock);
+    return hit;
+}
+
+static void cache_clear(void)
+{
+    portENTER_CRITICAL(&s_cache_lock);
+    s_cache.valid = false;
+    s_cache.phase_locked = false;
+    portEXIT_CRITICAL(&s_cache_lock);
+}
+
+static bool cache_is_valid(void)
+{
+    portENTER_CRITICAL(&s_cache_lock);
+    bool valid = s_cache.valid;
+    portEXIT_CRITICAL(&s_cache_lock);
+    return valid;
+}
+
 static esp_err_t rtc_set_system_time(const pcf_datetime_t *time)
 {
     time_t epoch = 0;
@@ -143,6 +258,65 @@ static esp_err_t pcf_read_bytes(uint8_t reg, uint8_t *data, size_t len)
                                          pdMS_TO_TICKS(I2C_TIMEOUT_MS));
 }
 
+// Reads the time registers over I2C, bypassing the cache
+static esp_err_t pcf_read_time(pcf_datetime_t *time)
+{
+    xSemaphoreTake(s_rtc.mutex, portMAX_DELAY);
+
+    uint8_t buf[7] = {0};
+    esp_err_t err = pcf_read_bytes(RTC_SECOND_ADDR, buf, 7);
+
+    xSemaphoreGive(s_rtc.mutex);
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to read time: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // Convert BCD to decimal with appropriate masks
+    time->sec = bcd_to_dec(buf[0] & 0x7F);
+    time->min = bcd_to_dec(buf[1] & 0x7F);
+    time->hour = bcd_to_dec(buf[2] & 0x3F);  // 24-hour format
+    time->day = bcd_to_dec(buf[3] & 0x3F);
+    time->dotw = bcd_to_dec(buf[4] & 0x07);
+    time->month = bcd_to_dec(buf[5] & 0x1F);
+    time->year = bcd_to_dec(buf[6]) + YEAR_OFFSET;
+
+    return ESP_OK;
+}
+
+// Re-reads the chip and folds the result into the cache (refresh task and
+// init only; readers never come here)
+static esp_err_t cache_refresh(void)
+{
+    pcf_datetime_t time;
+    esp_err_t err = pcf_read_time(&time);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    int64_t unix_sec = 0;
+    if (!pcf_rtc_datetime_to_unix(&time, &unix_sec))
+    {
+        return ESP_FAIL;
+    }
+
+    cache_update_from_read(unix_sec, esp_timer_get_time());
+    return ESP_OK;
+}
+
+static void refresh_task(void *arg)
+{
+    (void)arg;
+    while (true)
+    {
+        vTaskDelay(pdMS_TO_TICKS(cache_is_valid() ? CACHE_REFRESH_MS : CACHE_RETRY_MS));
+        cache_refresh();
+    }
+}
+
 esp_err_t pcf_rtc_init(int i2c_port)
 {
     if (s_rtc.initialized)
@@ -171,6 +345,20 @@ esp_err_t pcf_rtc_init(int i2c_port)
         return err;
     }
 
+    // Seed the cache before readers can see the RTC as initialized; if this
+    // read fails the refresh task keeps retrying
+    cache_refresh();
+
+    if (xTaskCreate(refresh_task, "rtc_refresh", REFRESH_TASK_STACK, NULL,
+                    REFRESH_TASK_PRIO, &s_rtc.refresh_task) != pdPASS)
+    {
+        ESP_LOGE(TAG, "Failed to create refresh task");
+        cache_clear();
+        vSemaphoreDelete(s_rtc.mutex);
+        s_rtc.mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
     s_rtc.initialized = true;
     ESP_LOGI(TAG, "RTC initialized (PCF85063A at 0x%02X)", PCF85063A_ADDRESS);
 
@@ -198,13 +386,22 @@ esp_err_t pcf_rtc_deinit(void)
         return ESP_OK;
     }
 
-    if (s_rtc.mutex)
+    s_rtc.initialized = false;
+
+    // Holding the mutex means the refresh task is not mid-transfer; it is
+    // either sleeping or blocked on the mutex, and safe to delete
+    xSemaphoreTake(s_rtc.mutex, portMAX_DELAY);
+    if (s_rtc.refresh_task)
     {
-        vSemaphoreDelete(s_rtc.mutex);
-        s_rtc.mutex = NULL;
+        vTaskDelete(s_rtc.refresh_task);
+        s_rtc.refresh_task = NULL;
     }
+    xSemaphoreGive(s_rtc.mutex);
 
-    s_rtc.initialized = false;
+    vSemaphoreDelete(s_rtc.mutex);
+    s_rtc.mutex = NULL;
+
+    cache_clear();
     s_rtc.i2c_port = -1;
 
     ESP_LOGI(TAG, "RTC deinitialized");
@@ -244,27 +441,18 @@ esp_err_t pcf_rtc_get_time(pcf_datetime_t *time)
         return ESP_ERR_INVALID_STATE;
     }
 
-    xSemaphoreTake(s_rtc.mutex, portMAX_DELAY);
-
-    uint8_t buf[7] = {0};
-    esp_err_t err = pcf_read_bytes(RTC_SECOND_ADDR, buf, 7);
-
-    xSemaphoreGive(s_rtc.mutex);
-
-    if (err != ESP_OK)
+    // Never touches I2C: an empty cache means the chip has not answered
+    // yet, and the refresh task is retrying
+    int64_t unix_sec = 0;
+    if (!cache_lookup(esp_timer_get_time(), &unix_sec))
     {
-        ESP_LOGE(TAG, "Failed to read time: %s", esp_err_to_name(err));
-        return err;
+        return ESP_ERR_INVALID_STATE;
     }
 
-    // Convert BCD to decimal with appropriate masks
-    time->sec = bcd_to_dec(buf[0] & 0x7F);
-    time->min = bcd_to_dec(buf[1] & 0x7F);
-    time->hour = bcd_to_dec(buf[2] & 0x3F);  // 24-hour format
-    time->day = bcd_to_dec(buf[3] & 0x3F);
-    time->dotw = bcd_to_dec(buf[4] & 0x07);
-    time->month = bcd_to_dec(buf[5] & 0x1F);
-    time->year = bcd_to_dec(buf[6]) + YEAR_OFFSET;
+    if (!rtc_epoch_to_datetime(unix_sec, time))
+    {
+        return ESP_FAIL;
+    }
 
     return ESP_OK;
 }
@@ -324,6 +512,18 @@ esp_err_t pcf_rtc_set_time(const pcf_datetime_t *time)
         return err;
     }
 
+    // Writing the time registers restarts the second, so this is close
+    // to aligned, but leave the phase to the next rollover capture
+    int64_t unix_sec = 0;
+    if (pcf_rtc_datetime_to_unix(time, &unix_sec))
+    {
+        cache_store(unix_sec, esp_timer_get_time(), false);
+    }
+    else
+    {
+        cache_clear();
+    }
+
     char display_buf[24];
     pcf_rtc_format_display(display_buf, sizeof(display_buf), time);
     ESP_LOGI(TAG, "RTC time set to: %s", display_buf);
@@ -337,6 +537,153 @@ esp_err_t pcf_rtc_set_time(const pcf_datetime_t *time)
     return ESP_OK;
 }
 
+// Fills in the time of a captured rollover and re-anchors the cache on it.
+// The next rollover is ~1 s away, so a prompt read sees the new second.
+static esp_err_t rtc_complete_edge(pcf_rtc_edge_t *edge)
+{
+    esp_err_t err = pcf_read_time(&edge->time);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    if (edge->time.year < MIN_VALID_YEAR)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (!pcf_rtc_datetime_to_unix(&edge->time, &edge->unix_sec))
+    {
+        return ESP_FAIL;
+    }
+
+    cache_store(edge->unix_sec, edge->edge_us, true);
+    return ESP_OK;
+}
+
+static esp_err_t pcf_read_seconds(uint8_t *sec, int64_t *sample_us)
+{
+    xSemaphoreTake(s_rtc.mutex, portMAX_DELAY);
+    int64_t start_us = esp_timer_get_time();
+    uint8_t raw = 0;
+    esp_err_t err = pcf_read_bytes(RTC_SECOND_ADDR, &raw, 1);
+    int64_t end_us = esp_timer_get_time();
+    xSemaphoreGive(s_rtc.mutex);
+
+    if (err == ESP_OK)
+    {
+        *sec = bcd_to_dec(raw & 0x7F);
+        *sample_us = start_us + (end_us - start_us) / 2;
+    }
+    return err;
+}
+
+esp_err_t pcf_rtc_capture_second_edge(uint32_t timeout_ms, pcf_rtc_edge_t *edge)
+{
+    if (!edge)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_rtc.initialized)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t prev_sec = 0;
+    int64_t prev_us = 0;
+    esp_err_t err = pcf_read_seconds(&prev_sec, &prev_us);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    int64_t deadline_us = prev_us + (int64_t)timeout_ms * 1000;
+    while (true)
+    {
+        uint8_t sec = 0;
+        int64_t sample_us = 0;
+        err = pcf_read_seconds(&sec, &sample_us);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+
+        if (sec != prev_sec)
+        {
+            // Rollover happened between the two samples
+            edge->edge_us = prev_us + (sample_us - prev_us) / 2;
+            edge->uncertainty_us = (uint32_t)((sample_us - prev_us) / 2);
+            break;
+        }
+
+        if (sample_us > deadline_us)
+        {
+            return ESP_ERR_TIMEOUT;
+        }
+
+        prev_us = sample_us;
+    }
+
+    return rtc_complete_edge(edge);
+}
+
+esp_err_t pcf_rtc_stamp_edge(int64_t edge_us, uint32_t uncertainty_us, pcf_rtc_edge_t *edge)
+{
+    if (!edge)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_rtc.initialized)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    edge->edge_us = edge_us;
+    edge->uncertainty_us = uncertainty_us;
+    return rtc_complete_edge(edge);
+}
+
+esp_err_t pcf_rtc_set_clkout_1hz(bool enable)
+{
+    if (!s_rtc.initialized)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_rtc.mutex, portMAX_DELAY);
+
+    uint8_t ctrl2 = 0;
+    esp_err_t err = pcf_read_bytes(RTC_CTRL_2_ADDR, &ctrl2, 1);
+    if (err == ESP_OK)
+    {
+        ctrl2 &= (uint8_t)~RTC_CTRL_2_COF_MASK;
+        ctrl2 |= enable ? RTC_CTRL_2_COF_1HZ : RTC_CTRL_2_COF_32768HZ;
+        err = pcf_write_byte(RTC_CTRL_2_ADDR, ctrl2);
+    }
+
+    xSemaphoreGive(s_rtc.mutex);
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to configure CLKOUT: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+bool pcf_rtc_datetime_to_unix(const pcf_datetime_t *time, int64_t *unix_sec)
+{
+    time_t epoch = 0;
+    if (!unix_sec || !rtc_datetime_to_epoch(time, &epoch))
+    {
+        return false;
+    }
+
+    *unix_sec = (int64_t)epoch;
+    return true;
+}
+
 esp_err_t pcf_rtc_sync_system_time(void)
 {
     if (!s_rtc.initialized)
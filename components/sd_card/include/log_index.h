@@ -0,0 +1,112 @@
+/*
+ * Log File Index and Naming
+ *
+ * Log files are numbered from a per-card sequence counter persisted in a
+ * small index file, and placed in date directories (/sdcard/YYYY/MM/), so
+ * creating a log never needs a directory scan. This module holds the
+ * on-card index record and the file/directory naming rules, including
+ * parsing of legacy root-directory names for the one-time migration.
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_INDEX_FILE_NAME "LOGIDX.BIN"
+#define LOG_INDEX_RECORD_SIZE 16
+#define LOG_INDEX_UNDATED_DIR "undated"
+
+// Minimum digits of the sequence number in new file names
+#define LOG_INDEX_SEQ_DIGITS 6
+
+// Calendar time encoded in a file name
+typedef struct {
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t min;
+    uint8_t sec;
+} log_name_time_t;
+
+// Fields recovered from a log file name
+typedef struct {
+    char prefix[16];
+    char extension[8];
+    bool has_time;
+    log_name_time_t time;
+    bool has_seq;
+    uint32_t seq;
+} log_name_info_t;
+
+/**
+ * @brief Parse a log file name
+ *
+ * Accepts current and legacy names:
+ *   PREFIX_SSSSSS.EXT                   - undated (legacy: PREFIX_NNNN.EXT)
+ *   PREFIX_YYYYMMDD_HHMMSS_SSSSSS.EXT   - dated with sequence number
+ *   PREFIX_YYYYMMDD_HHMMSS.EXT          - legacy dated
+ *   PREFIX_YYYYMMDD_HHMMSS_NN.EXT       - legacy dated, same-second suffix
+ *
+ * @param name File name without directory
+ * @param out Filled with the parsed fields
+ * @return true if the name matches one of the patterns
+ */
+bool log_index_parse_name(const char *name, log_name_info_t *out);
+
+/**
+ * @brief Format a log file name
+ *
+ * @param buf Output buffer
+ * @param buf_size Size of buf
+ * @param prefix File name prefix (e.g., "CAN")
+ * @param extension File extension (e.g., "bin")
+ * @param seq Sequence number
+ * @param time Start time, or NULL for an undated name
+ * @return Number of characters written, or -1 on error or truncation
+ */
+int log_index_format_name(char *buf, size_t buf_size, const char *prefix,
+                          const char *extension, uint32_t seq,
+                          const log_name_time_t *time);
+
+/**
+ * @brief Format the directory a log file belongs in
+ *
+ * @param buf Output buffer
+ * @param buf_size Size of buf
+ * @param root Mount point (e.g., "/sdcard")
+ * @param time Start time (ROOT/YYYY/MM), or NULL for ROOT/undated
+ * @return Number of characters written, or -1 on error or truncation
+ */
+int log_index_format_dir(char *buf, size_t buf_size, const char *root,
+                         const log_name_time_t *time);
+
+/**
+ * @brief Encode the index record
+ *
+ * @param next_seq Sequence number the next log file will use
+ * @param out Output record (LOG_INDEX_RECORD_SIZE bytes)
+ */
+void log_index_encode(uint32_t next_seq, uint8_t *out);
+
+/**
+ * @brief Decode and verify the index record
+ *
+ * @param data Record bytes read from the card
+ * @param len Number of bytes read
+ * @param next_seq Filled with the stored sequence number
+ * @return false if the record is short, corrupt or from another version
+ */
+bool log_index_decode(const uint8_t *data, size_t len, uint32_t *next_seq);
+
+#ifdef __cplusplus
+}
+#endif
@@ -43,6 +43,11 @@ typedef struct {
  * This function initializes the SPI bus and mounts the SD card filesystem.
  * I2C must already be initialized (by display_manager).
  *
+ * Also loads the log index (rebuilt from a directory scan on a card
+ * without one) and starts a low-priority task that moves legacy log files
+ * from the root directory into date directories, so boot does not wait on
+ * the move however many old files the card holds.
+ *
  * @param i2c_port The I2C port number to use for CH422G control
  * @return ESP_OK on success, error code otherwise
  */
@@ -82,7 +87,9 @@ const char *sd_card_get_mount_point(void);
 /**
  * @brief Create a new file for logging
  *
- * Creates a new file with auto-incrementing name (LOG_0001.CSV, etc.)
+ * Creates an undated file numbered from the card's sequence counter
+ * (/sdcard/undated/LOG_000001.CSV, etc.). The counter is persisted in
+ * LOGIDX.BIN, so no directory scan is needed.
  *
  * @param prefix File name prefix (e.g., "LOG")
  * @param extension File extension (e.g., "CSV")
@@ -96,8 +103,9 @@ void *sd_card_create_log_file(const char *prefix, const char *extension,
 /**
  * @brief Create a new file for logging with RTC timestamp
  *
- * Creates a new file with RTC timestamp in the name (LOG_20251225_143052.CSV)
- * Falls back to auto-incrementing name if RTC time is not valid.
+ * Creates a file in a per-month directory with the RTC timestamp and
+ * sequence number in its name (/sdcard/2025/12/LOG_20251225_143052_000042.CSV).
+ * Falls back to an undated name if RTC time is not valid.
  *
  * @param prefix File name prefix (e.g., "LOG")
  * @param extension File extension (e.g., "CSV")
@@ -108,6 +116,22 @@ void *sd_card_create_log_file(const char *prefix, const char *extension,
 void *sd_card_create_log_file_with_timestamp(const char *prefix, const char *extension,
                                               char *out_path, size_t out_path_size);
 
+/**
+ * @brief Create a file alongside an existing log file
+ *
+ * Uses the log file's directory and name with a different extension
+ * (/sdcard/2025/12/CAN_20251225_143052_000042.sig), so related files
+ * from one session sort together and share a sequence number.
+ *
+ * @param log_path Full path of the existing log file
+ * @param extension Extension of the new file (e.g., "sig")
+ * @param out_path Buffer to receive the full path (must be at least 64 bytes)
+ * @param out_path_size Size of out_path buffer
+ * @return FILE pointer on success, NULL on failure
+ */
+void *sd_card_create_companion_file(const char *log_path, const char *extension,
+                                    char *out_path, size_t out_path_size);
+
 /**
  * @brief Close a log file
  *
@@ -134,6 +158,18 @@ int sd_card_write(void *file, const void *data, size_t len);
  */
 esp_err_t sd_card_flush(void *file);
 
+/**
+ * @brief Flush and commit a log file to the card
+ *
+ * Unlike sd_card_flush(), this also runs f_sync so the FAT directory
+ * entry (file size) is updated. Data written before a successful sync
+ * survives a sudden power loss.
+ *
+ * @param file FILE pointer
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t sd_card_sync(void *file);
+
 #ifdef __cplusplus
 }
 #endif
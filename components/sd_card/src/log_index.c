@@ -0,0 +1,233 @@
+/*
+ * Log File Index and Naming - Implementation
+ */
+
+#include "log_index.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define INDEX_MAGIC "LIDX"
+#define INDEX_VERSION 1
+
+// Up to 4 '_'-separated numeric fields between prefix and extension
+#define MAX_FIELDS 4
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void log_index_encode(uint32_t next_seq, uint8_t *out)
+{
+    if (!out) {
+        return;
+    }
+
+    memset(out, 0, LOG_INDEX_RECORD_SIZE);
+    memcpy(out, INDEX_MAGIC, 4);
+    put_le16(out + 4, INDEX_VERSION);
+    put_le32(out + 8, next_seq);
+    put_le32(out + 12, crc32_update(0, out, 12));
+}
+
+bool log_index_decode(const uint8_t *data, size_t len, uint32_t *next_seq)
+{
+    if (!data || !next_seq || len < LOG_INDEX_RECORD_SIZE) {
+        return false;
+    }
+
+    if (memcmp(data, INDEX_MAGIC, 4) != 0 || get_le16(data + 4) != INDEX_VERSION) {
+        return false;
+    }
+
+    if (get_le32(data + 12) != crc32_update(0, data, 12)) {
+        return false;
+    }
+
+    *next_seq = get_le32(data + 8);
+    return *next_seq != 0;
+}
+
+// Parses exactly `digits` decimal digits; returns false on any non-digit
+static bool parse_fixed(const char *s, size_t digits, uint32_t *out)
+{
+    uint32_t v = 0;
+    for (size_t i = 0; i < digits; i++) {
+        if (s[i] < '0' || s[i] > '9') {
+            return false;
+        }
+        v = v * 10 + (uint32_t)(s[i] - '0');
+    }
+    *out = v;
+    return true;
+}
+
+static bool parse_date_time(const char *date, const char *clock, log_name_time_t *out)
+{
+    uint32_t y, mo, d, h, mi, s;
+    if (!parse_fixed(date, 4, &y) || !parse_fixed(date + 4, 2, &mo) ||
+        !parse_fixed(date + 6, 2, &d) || !parse_fixed(clock, 2, &h) ||
+        !parse_fixed(clock + 2, 2, &mi) || !parse_fixed(clock + 4, 2, &s)) {
+        return false;
+    }
+
+    if (mo < 1 || mo > 12 || d < 1 || d > 31 || h > 23 || mi > 59 || s > 59) {
+        return false;
+    }
+
+    out->year = (uint16_t)y;
+    out->month = (uint8_t)mo;
+    out->day = (uint8_t)d;
+    out->hour = (uint8_t)h;
+    out->min = (uint8_t)mi;
+    out->sec = (uint8_t)s;
+    return true;
+}
+
+bool log_index_parse_name(const char *name, log_name_info_t *out)
+{
+    if (!name || !out) {
+        return false;
+    }
+
+    memset(out, 0, sizeof(*out));
+
+    const char *underscore = strchr(name, '_');
+    const char *dot = strrchr(name, '.');
+    if (!underscore || !dot || dot < underscore) {
+        return false;
+    }
+
+    size_t prefix_len = (size_t)(underscore - name);
+    size_t ext_len = strlen(dot + 1);
+    if (prefix_len == 0 || prefix_len >= sizeof(out->prefix) ||
+        ext_len == 0 || ext_len >= sizeof(out->extension)) {
+        return false;
+    }
+
+    // Split the numeric fields between the prefix and the extension
+    const char *fields[MAX_FIELDS];
+    size_t lengths[MAX_FIELDS];
+    int count = 0;
+    const char *p = underscore + 1;
+    while (p <= dot) {
+        const char *end = p;
+        while (end < dot && *end != '_') {
+            end++;
+        }
+        if (count == MAX_FIELDS || end == p) {
+            return false;
+        }
+        fields[count] = p;
+        lengths[count] = (size_t)(end - p);
+        count++;
+        p = end + 1;
+    }
+
+    uint32_t seq = 0;
+    if (count == 1) {
+        if (lengths[0] > 9 || !parse_fixed(fields[0], lengths[0], &seq)) {
+            return false;
+        }
+        out->has_seq = true;
+        out->seq = seq;
+    } else if (count == 2 || count == 3) {
+        if (lengths[0] != 8 || lengths[1] != 6 ||
+            !parse_date_time(fields[0], fields[1], &out->time)) {
+            return false;
+        }
+        out->has_time = true;
+
+        if (count == 3) {
+            if (lengths[2] > 9 || !parse_fixed(fields[2], lengths[2], &seq)) {
+                return false;
+            }
+            // Short trailing fields are the legacy same-second suffix
+            if (lengths[2] >= LOG_INDEX_SEQ_DIGITS) {
+                out->has_seq = true;
+                out->seq = seq;
+            }
+        }
+    } else {
+        return false;
+    }
+
+    memcpy(out->prefix, name, prefix_len);
+    memcpy(out->extension, dot + 1, ext_len);
+    return true;
+}
+
+static int checked_length(int written, size_t buf_size)
+{
+    return (written < 0 || (size_t)written >= buf_size) ? -1 : written;
+}
+
+int log_index_format_name(char *buf, size_t buf_size, const char *prefix,
+                          const char *extension, uint32_t seq,
+                          const log_name_time_t *time)
+{
+    if (!buf || buf_size == 0 || !prefix || !extension) {
+        return -1;
+    }
+
+    int written;
+    if (time) {
+        written = snprintf(buf, buf_size, "%s_%04u%02u%02u_%02u%02u%02u_%0*lu.%s",
+                           prefix, time->year, time->month, time->day,
+                           time->hour, time->min, time->sec,
+                           LOG_INDEX_SEQ_DIGITS, (unsigned long)seq, extension);
+    } else {
+        written = snprintf(buf, buf_size, "%s_%0*lu.%s", prefix,
+                           LOG_INDEX_SEQ_DIGITS, (unsigned long)seq, extension);
+    }
+    return checked_length(written, buf_size);
+}
+
+int log_index_format_dir(char *buf, size_t buf_size, const char *root,
+                         const log_name_time_t *time)
+{
+    if (!buf || buf_size == 0 || !root) {
+        return -1;
+    }
+
+    int written;
+    if (time) {
+        written = snprintf(buf, buf_size, "%s/%04u/%02u", root, time->year, time->month);
+    } else {
+        written = snprintf(buf, buf_size, "%s/%s", root, LOG_INDEX_UNDATED_DIR);
+    }
+    return checked_length(written, buf_size);
+}
@@ -6,7 +6,9 @@
  * CS is controlled via CH422G at I2C addresses 0x24/0x38
  */
 
+#include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <dirent.h>
 #include <sys/stat.h>
@@ -14,14 +16,17 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include <freertos/task.h>
 #include <driver/i2c.h>
 #include <driver/sdspi_host.h>
 #include <driver/spi_common.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <esp_vfs_fat.h>
 #include <sdmmc_cmd.h>
 
 #include "sd_card.h"
+#include "log_index.h"
 #include "rtc_pcf85063a.h"
 
 static const char *TAG = "sd_card";
@@ -51,6 +56,15 @@ static const char *TAG = "sd_card";
 
 #define I2C_TIMEOUT_MS 1000
 
+// Log index file and migration
+#define LOG_INDEX_PATH MOUNT_POINT "/" LOG_INDEX_FILE_NAME
+#define LOG_PATH_MAX 64
+#define MIGRATE_BATCH_FILES 32      // Renames per hold of the card mutex
+#define MIGRATE_TASK_STACK 4096
+#define MIGRATE_TASK_PRIORITY 1     // Background work, below every logger task
+// Existing files skipped before giving up on a name (index behind the card)
+#define CREATE_MAX_ATTEMPTS 16
+
 // Module state
 static struct {
     bool initialized;
@@ -59,13 +73,26 @@ static struct {
     sdmmc_card_t *card;
     sdmmc_host_t host;
     SemaphoreHandle_t mutex;
+    bool index_loaded;
+    uint32_t next_seq;
+    char last_dir[LOG_PATH_MAX];  // Last log directory known to exist
+    TaskHandle_t migrate_task;
+    SemaphoreHandle_t migrate_done;
+    StaticSemaphore_t migrate_done_buffer;
+    volatile bool migrate_stop;
 } s_sd_state = {
     .initialized = false,
     .mounted = false,
     .i2c_port = -1,
     .card = NULL,
     .host = SDSPI_HOST_DEFAULT(),
-    .mutex = NULL
+    .mutex = NULL,
+    .index_loaded = false,
+    .next_seq = 1,
+    .last_dir = "",
+    .migrate_task = NULL,
+    .migrate_done = NULL,
+    .migrate_stop = false
 };
 
 static esp_err_t ch422g_write(uint8_t addr, uint8_t value)
@@ -90,6 +117,366 @@ static esp_err_t sd_card_enable_cs(void)
     return ch422g_write(CH422G_OUTPUT_ADDR, CH422G_SD_CS_ENABLE);
 }
 
+static esp_err_t log_index_save(void)
+{
+    uint8_t record[LOG_INDEX_RECORD_SIZE];
+    log_index_encode(s_sd_state.next_seq, record);
+
+    FILE *f = fopen(LOG_INDEX_PATH, "wb");
+    if (!f)
+    {
+        return ESP_FAIL;
+    }
+
+    size_t written = fwrite(record, 1, sizeof(record), f);
+    int synced = (fflush(f) == 0) ? fsync(fileno(f)) : -1;
+    fclose(f);
+
+    return (written == sizeof(record) && synced == 0) ? ESP_OK : ESP_FAIL;
+}
+
+static bool log_index_read(uint32_t *next_seq)
+{
+    FILE *f = fopen(LOG_INDEX_PATH, "rb");
+    if (!f)
+    {
+        return false;
+    }
+
+    uint8_t record[LOG_INDEX_RECORD_SIZE];
+    size_t len = fread(record, 1, sizeof(record), f);
+    fclose(f);
+
+    return log_index_decode(record, len, next_seq);
+}
+
+static esp_err_t ensure_dir(const char *path)
+{
+    if (mkdir(path, 0775) != 0 && errno != EEXIST)
+    {
+        ESP_LOGE(TAG, "Failed to create directory %s (errno %d)", path, errno);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+// Creates ROOT/YYYY/MM (or ROOT/undated); skips the mkdirs when unchanged
+static esp_err_t ensure_log_dir(const log_name_time_t *time, char *dir, size_t dir_size)
+{
+    if (log_index_format_dir(dir, dir_size, MOUNT_POINT, time) < 0)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    if (strcmp(dir, s_sd_state.last_dir) == 0)
+    {
+        return ESP_OK;
+    }
+
+    if (time)
+    {
+        char year_dir[LOG_PATH_MAX];
+        snprintf(year_dir, sizeof(year_dir), "%s/%04u", MOUNT_POINT, time->year);
+        esp_err_t err = ensure_dir(year_dir);
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+    }
+
+    esp_err_t err = ensure_dir(dir);
+    if (err == ESP_OK)
+    {
+        strncpy(s_sd_state.last_dir, dir, sizeof(s_sd_state.last_dir) - 1);
+        s_sd_state.last_dir[sizeof(s_sd_state.last_dir) - 1] = '\0';
+    }
+    return err;
+}
+
+static bool is_all_digits(const char *s, size_t len)
+{
+    if (strlen(s) != len)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        if (s[i] < '0' || s[i] > '9')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t scan_dir_max_seq(const char *path)
+{
+    uint32_t max_seq = 0;
+    DIR *dir = opendir(path);
+    if (!dir)
+    {
+        return 0;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        log_name_info_t info;
+        if (entry->d_type != DT_DIR && log_index_parse_name(entry->d_name, &info) &&
+            info.has_seq && info.seq > max_seq)
+        {
+            max_seq = info.seq;
+        }
+    }
+    closedir(dir);
+    return max_seq;
+}
+
+// Highest sequence number already used in ROOT/undated and ROOT/YYYY/MM
+static uint32_t scan_log_dirs_max_seq(void)
+{
+    char path[LOG_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", MOUNT_POINT, LOG_INDEX_UNDATED_DIR);
+    uint32_t max_seq = scan_dir_max_seq(path);
+
+    DIR *root = opendir(MOUNT_POINT);
+    if (!root)
+    {
+        return max_seq;
+    }
+
+    struct dirent *year;
+    while ((year = readdir(root)) != NULL)
+    {
+        if (year->d_type != DT_DIR || !is_all_digits(year->d_name, 4))
+        {
+            continue;
+        }
+
+        char year_path[LOG_PATH_MAX];
+        snprintf(year_path, sizeof(year_path), "%s/%s", MOUNT_POINT, year->d_name);
+        DIR *months = opendir(year_path);
+        if (!months)
+        {
+            continue;
+        }
+
+        struct dirent *month;
+        while ((month = readdir(months)) != NULL)
+        {
+            if (month->d_type != DT_DIR || !is_all_digits(month->d_name, 2))
+            {
+                continue;
+            }
+            snprintf(path, sizeof(path), "%s/%s", year_path, month->d_name);
+            uint32_t seq = scan_dir_max_seq(path);
+            if (seq > max_seq)
+            {
+                max_seq = seq;
+            }
+        }
+        closedir(months);
+    }
+    closedir(root);
+    return max_seq;
+}
+
+// Moves legacy log files out of the root directory into their date (or
+// undated) directory. Renaming while iterating a FAT directory can skip
+// entries, so names are collected in batches and the scan restarts until
+// nothing is left to move. Each batch holds the card mutex only briefly,
+// so log files can be created while a large card is being migrated.
+static uint32_t migrate_root_logs(size_t *moved)
+{
+    typedef char name_t[LOG_PATH_MAX];
+    name_t *batch = malloc(MIGRATE_BATCH_FILES * sizeof(name_t));
+    if (!batch)
+    {
+        ESP_LOGE(TAG, "No memory for log migration");
+        return 0;
+    }
+
+    size_t failed = 0;
+    while (!s_sd_state.migrate_stop)
+    {
+        xSemaphoreTake(s_sd_state.mutex, portMAX_DELAY);
+        DIR *dir = opendir(MOUNT_POINT);
+        if (!dir)
+        {
+            xSemaphoreGive(s_sd_state.mutex);
+            break;
+        }
+
+        size_t count = 0;
+        size_t seen = 0;
+        struct dirent *entry;
+        while (count < MIGRATE_BATCH_FILES && (entry = readdir(dir)) != NULL)
+        {
+            log_name_info_t info;
+            if (entry->d_type == DT_DIR || !log_index_parse_name(entry->d_name, &info))
+            {
+                continue;
+            }
+            // Files that failed to move stay at the front of the directory
+            if (seen++ < failed)
+            {
+                continue;
+            }
+            strncpy(batch[count], entry->d_name, LOG_PATH_MAX - 1);
+            batch[count][LOG_PATH_MAX - 1] = '\0';
+            count++;
+        }
+        closedir(dir);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            log_name_info_t info;
+            log_index_parse_name(batch[i], &info);
+
+            char dir_path[LOG_PATH_MAX];
+            char from[LOG_PATH_MAX + 16];
+            char to[2 * LOG_PATH_MAX];
+            snprintf(from, sizeof(from), "%s/%s", MOUNT_POINT, batch[i]);
+            if (ensure_log_dir(info.has_time ? &info.time : NULL, dir_path, sizeof(dir_path)) != ESP_OK)
+            {
+                failed++;
+                continue;
+            }
+            snprintf(to, sizeof(to), "%s/%s", dir_path, batch[i]);
+            if (rename(from, to) != 0)
+            {
+                ESP_LOGW(TAG, "Could not move %s (errno %d)", from, errno);
+                failed++;
+                continue;
+            }
+            (*moved)++;
+        }
+        xSemaphoreGive(s_sd_state.mutex);
+
+        if (count == 0)
+        {
+            break;
+        }
+        vTaskDelay(1);
+    }
+
+    free(batch);
+    return failed;
+}
+
+// Runs on every mount, so a migration cut short by a reboot resumes; on a
+// card with nothing left in the root it is a single directory scan
+static void migrate_task(void *arg)
+{
+    (void)arg;
+    int64_t start_us = esp_timer_get_time();
+    size_t moved = 0;
+    uint32_t failed = migrate_root_logs(&moved);
+
+    if (moved > 0 || failed > 0)
+    {
+        ESP_LOGI(TAG, "Legacy log migration: %u files moved in %lld ms, %lu left in root",
+                 (unsigned)moved, (long long)((esp_timer_get_time() - start_us) / 1000),
+                 (unsigned long)failed);
+    }
+
+    xSemaphoreGive(s_sd_state.migrate_done);
+    vTaskDelete(NULL);
+}
+
+// Loads the sequence counter, rebuilding it when the index is missing or
+// corrupt. Legacy root files count toward the sequence here but are moved
+// later by the migration task. Caller holds the mutex.
+static esp_err_t log_index_load(void)
+{
+    uint32_t next_seq = 0;
+    if (log_index_read(&next_seq))
+    {
+        s_sd_state.next_seq = next_seq;
+        s_sd_state.index_loaded = true;
+        ESP_LOGI(TAG, "Log index loaded (next sequence %lu)", (unsigned long)next_seq);
+        return ESP_OK;
+    }
+
+    ESP_LOGW(TAG, "Log index missing or corrupt, scanning card (one-time)");
+    int64_t start_us = esp_timer_get_time();
+
+    uint32_t max_seq = scan_log_dirs_max_seq();
+    uint32_t root_seq = scan_dir_max_seq(MOUNT_POINT);
+    if (root_seq > max_seq)
+    {
+        max_seq = root_seq;
+    }
+
+    s_sd_state.next_seq = max_seq + 1;
+    s_sd_state.index_loaded = true;
+    esp_err_t err = log_index_save();
+
+    ESP_LOGI(TAG, "Log index rebuilt in %lld ms: next sequence %lu",
+             (long long)((esp_timer_get_time() - start_us) / 1000),
+             (unsigned long)s_sd_state.next_seq);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Failed to write log index");
+    }
+    return err;
+}
+
+// Creates the next sequenced log file in its date (or undated) directory
+static FILE *create_sequenced_file(const char *prefix, const char *extension,
+                                   const log_name_time_t *time,
+                                   char *out_path, size_t out_path_size)
+{
+    xSemaphoreTake(s_sd_state.mutex, portMAX_DELAY);
+
+    if (!s_sd_state.index_loaded)
+    {
+        log_index_load();
+    }
+
+    char dir[LOG_PATH_MAX];
+    if (ensure_log_dir(time, dir, sizeof(dir)) != ESP_OK)
+    {
+        xSemaphoreGive(s_sd_state.mutex);
+        return NULL;
+    }
+
+    // The index is normally authoritative; the stat only guards against
+    // an index restored from an older copy of the card
+    bool found = false;
+    for (int attempt = 0; attempt < CREATE_MAX_ATTEMPTS && !found; attempt++)
+    {
+        char name[LOG_PATH_MAX];
+        uint32_t seq = s_sd_state.next_seq++;
+        if (log_index_format_name(name, sizeof(name), prefix, extension, seq, time) < 0 ||
+            snprintf(out_path, out_path_size, "%s/%s", dir, name) >= (int)out_path_size)
+        {
+            ESP_LOGE(TAG, "Log path too long for buffer (%u bytes)", (unsigned)out_path_size);
+            break;
+        }
+
+        struct stat st;
+        found = (stat(out_path, &st) != 0);
+    }
+
+    if (log_index_save() != ESP_OK)
+    {
+        ESP_LOGW(TAG, "Failed to persist log index");
+    }
+
+    FILE *f = found ? fopen(out_path, "w") : NULL;
+    if (!f)
+    {
+        ESP_LOGE(TAG, "Failed to create log file: %s", out_path);
+        xSemaphoreGive(s_sd_state.mutex);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "Created log file: %s", out_path);
+    xSemaphoreGive(s_sd_state.mutex);
+    return f;
+}
+
 esp_err_t sd_card_init(int i2c_port)
 {
     if (s_sd_state.initialized)
@@ -178,6 +565,24 @@ esp_err_t sd_card_init(int i2c_port)
     ESP_LOGI(TAG, "SD card mounted successfully");
     sdmmc_card_print_info(stdout, s_sd_state.card);
 
+    // Load (or rebuild) the log index now, so log start never scans
+    xSemaphoreTake(s_sd_state.mutex, portMAX_DELAY);
+    log_index_load();
+    xSemaphoreGive(s_sd_state.mutex);
+
+    // Moving legacy root files can take a while; keep it off the boot path
+    if (!s_sd_state.migrate_done)
+    {
+        s_sd_state.migrate_done = xSemaphoreCreateBinaryStatic(&s_sd_state.migrate_done_buffer);
+    }
+    s_sd_state.migrate_stop = false;
+    if (xTaskCreate(migrate_task, "sd_migrate", MIGRATE_TASK_STACK, NULL,
+                    MIGRATE_TASK_PRIORITY, &s_sd_state.migrate_task) != pdPASS)
+    {
+        s_sd_state.migrate_task = NULL;
+        ESP_LOGW(TAG, "Legacy log migration task not started");
+    }
+
     return ESP_OK;
 }
 
@@ -188,6 +593,14 @@ esp_err_t sd_card_deinit(void)
         return ESP_OK;
     }
 
+    // The migration stops after its current batch
+    if (s_sd_state.migrate_task)
+    {
+        s_sd_state.migrate_stop = true;
+        xSemaphoreTake(s_sd_state.migrate_done, portMAX_DELAY);
+        s_sd_state.migrate_task = NULL;
+    }
+
     if (s_sd_state.mounted)
     {
         esp_vfs_fat_sdcard_unmount(MOUNT_POINT, s_sd_state.card);
@@ -204,6 +617,8 @@ esp_err_t sd_card_deinit(void)
 
     s_sd_state.initialized = false;
     s_sd_state.card = NULL;
+    s_sd_state.index_loaded = false;
+    s_sd_state.last_dir[0] = '\0';
 
     ESP_LOGI(TAG, "SD card deinitialized");
     return ESP_OK;
@@ -274,51 +689,7 @@ void *sd_card_create_log_file(const char *prefix, const char *extension,
         return NULL;
     }
 
-    xSemaphoreTake(s_sd_state.mutex, portMAX_DELAY);
-
-    // Find the next available file number
-    int next_num = 1;
-    DIR *dir = opendir(MOUNT_POINT);
-    if (dir)
-    {
-        struct dirent *entry;
-        while ((entry = readdir(dir)) != NULL)
-        {
-            // Check if filename matches pattern PREFIX_NNNN.EXT
-            int num = 0;
-            char test_prefix[32];
-            char test_ext[16];
-
-            if (sscanf(entry->d_name, "%31[^_]_%d.%15s", test_prefix, &num, test_ext) == 3)
-            {
-                if (strcasecmp(test_prefix, prefix) == 0 &&
-                    strcasecmp(test_ext, extension) == 0)
-                {
-                    if (num >= next_num)
-                    {
-                        next_num = num + 1;
-                    }
-                }
-            }
-        }
-        closedir(dir);
-    }
-
-    // Create the file path
-    snprintf(out_path, out_path_size, "%s/%s_%04d.%s",
-             MOUNT_POINT, prefix, next_num, extension);
-
-    FILE *f = fopen(out_path, "w");
-    if (!f)
-    {
-        ESP_LOGE(TAG, "Failed to create log file: %s", out_path);
-        xSemaphoreGive(s_sd_state.mutex);
-        return NULL;
-    }
-
-    ESP_LOGI(TAG, "Created log file: %s", out_path);
-    xSemaphoreGive(s_sd_state.mutex);
-    return f;
+    return create_sequenced_file(prefix, extension, NULL, out_path, out_path_size);
 }
 
 void *sd_card_create_log_file_with_timestamp(const char *prefix, const char *extension,
@@ -333,48 +704,53 @@ void *sd_card_create_log_file_with_timestamp(const char *prefix, const char *ext
     pcf_datetime_t time;
     if (!pcf_rtc_is_time_valid() || pcf_rtc_get_time(&time) != ESP_OK)
     {
-        // Fall back to auto-incrementing names
-        ESP_LOGW(TAG, "RTC time not valid, using incrementing filename");
+        // Fall back to undated names
+        ESP_LOGW(TAG, "RTC time not valid, using undated filename");
         return sd_card_create_log_file(prefix, extension, out_path, out_path_size);
     }
 
-    xSemaphoreTake(s_sd_state.mutex, portMAX_DELAY);
+    log_name_time_t name_time = {
+        .year = time.year,
+        .month = time.month,
+        .day = time.day,
+        .hour = time.hour,
+        .min = time.min,
+        .sec = time.sec
+    };
 
-    // Format timestamp: YYYYMMDD_HHMMSS
-    char timestamp[20];
-    pcf_rtc_format_filename(timestamp, sizeof(timestamp), &time);
+    return create_sequenced_file(prefix, extension, &name_time, out_path, out_path_size);
+}
 
-    // Create the file path with timestamp
-    snprintf(out_path, out_path_size, "%s/%s_%s.%s",
-             MOUNT_POINT, prefix, timestamp, extension);
+void *sd_card_create_companion_file(const char *log_path, const char *extension,
+                                    char *out_path, size_t out_path_size)
+{
+    if (!s_sd_state.mounted || !log_path || !extension || !out_path)
+    {
+        return NULL;
+    }
 
-    // Check if file already exists (unlikely but possible if creating
-    // multiple files in the same second)
-    struct stat st;
-    if (stat(out_path, &st) == 0)
+    const char *slash = strrchr(log_path, '/');
+    const char *dot = strrchr(log_path, '.');
+    size_t stem_len = (dot && (!slash || dot > slash)) ? (size_t)(dot - log_path)
+                                                       : strlen(log_path);
+    if (snprintf(out_path, out_path_size, "%.*s.%s", (int)stem_len, log_path,
+                 extension) >= (int)out_path_size)
     {
-        // File exists, append a counter
-        for (int i = 1; i <= 99; i++)
-        {
-            snprintf(out_path, out_path_size, "%s/%s_%s_%02d.%s",
-                     MOUNT_POINT, prefix, timestamp, i, extension);
-            if (stat(out_path, &st) != 0)
-            {
-                break;
-            }
-        }
+        ESP_LOGE(TAG, "Companion path too long for buffer (%u bytes)", (unsigned)out_path_size);
+        return NULL;
     }
 
+    xSemaphoreTake(s_sd_state.mutex, portMAX_DELAY);
     FILE *f = fopen(out_path, "w");
+    xSemaphoreGive(s_sd_state.mutex);
+
     if (!f)
     {
-        ESP_LOGE(TAG, "Failed to create log file: %s", out_path);
-        xSemaphoreGive(s_sd_state.mutex);
+        ESP_LOGE(TAG, "Failed to create companion file: %s", out_path);
         return NULL;
     }
 
-    ESP_LOGI(TAG, "Created log file: %s", out_path);
-    xSemaphoreGive(s_sd_state.mutex);
+    ESP_LOGI(TAG, "Created companion file: %s", out_path);
     return f;
 }
 
@@ -412,3 +788,20 @@ esp_err_t sd_card_flush(void *file)
     int result = fflush((FILE *)file);
     return (result == 0) ? ESP_OK : ESP_FAIL;
 }
+
+esp_err_t sd_card_sync(void *file)
+{
+    if (!file)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (fflush((FILE *)file) != 0)
+    {
+        return ESP_FAIL;
+    }
+
+    // fsync maps to f_sync on the FAT VFS
+    int result = fsync(fileno((FILE *)file));
+    return (result == 0) ? ESP_OK : ESP_FAIL;
+}
@@ -0,0 +1,81 @@
+/*
+ * Timebase Component
+ *
+ * High-resolution wall clock for log timestamps. A background task
+ * captures PCF85063A seconds rollovers (by polling the seconds register,
+ * or from the 1 Hz CLKOUT pin when it is wired to a GPIO) and disciplines
+ * esp_timer against them, so monotonic timestamps can be converted to
+ * Unix time with sub-millisecond phase and continuous drift correction.
+ *
+ * Note: pcf_rtc_init() must be called before timebase_init().
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Snapshot of the disciplined mapping
+typedef struct {
+    bool synced;                // At least one rollover has been captured
+    int64_t mono_us;            // esp_timer time of this snapshot
+    int64_t unix_us;            // Wall-clock time at mono_us
+    int32_t drift_ppb;          // esp_timer rate error vs RTC; positive = fast
+    uint32_t uncertainty_us;    // Estimated conversion error
+    int32_t last_residual_us;   // Prediction error at the last rollover
+    uint32_t edges;             // Rollovers captured
+    uint32_t steps;             // Wall-clock steps (RTC set)
+    uint32_t generation;        // Increments on every mapping update
+} timebase_status_t;
+
+/**
+ * @brief Start the timebase discipline task
+ *
+ * Returns immediately; the first rollover is captured in the background
+ * (up to ~1 s, longer if the RTC time is not set yet).
+ *
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t timebase_init(void);
+
+/**
+ * @brief Check if the mapping is established
+ *
+ * @return true once the first rollover has been captured
+ */
+bool timebase_is_synced(void);
+
+/**
+ * @brief Convert an esp_timer timestamp to Unix microseconds
+ *
+ * @param mono_us esp_timer_get_time() value
+ * @param unix_us Filled with the wall-clock time
+ * @return true on success, false if not synced
+ */
+bool timebase_mono_to_unix_us(int64_t mono_us, int64_t *unix_us);
+
+/**
+ * @brief Get the current wall-clock time in Unix microseconds
+ *
+ * @param unix_us Filled with the wall-clock time
+ * @return true on success, false if not synced
+ */
+bool timebase_now_unix_us(int64_t *unix_us);
+
+/**
+ * @brief Snapshot the mapping at the current esp_timer time
+ *
+ * @param status Filled with the current mapping and statistics
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t timebase_get_status(timebase_status_t *status);
+
+#ifdef __cplusplus
+}
+#endif
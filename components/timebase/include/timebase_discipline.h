@@ -0,0 +1,85 @@
+/*
+ * Timebase Drift Discipline
+ *
+ * Maps the free-running monotonic clock (esp_timer) onto wall-clock time
+ * using RTC second-rollover edges. Each edge is a (monotonic, unix second)
+ * pair; a second-order loop tracks the phase and the rate error of the
+ * monotonic clock relative to the RTC crystal, so conversions stay
+ * sub-millisecond between edges and over long drives.
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Residual beyond which an edge is treated as a time step (RTC was set)
+#define TIMEBASE_STEP_THRESHOLD_US 250000
+
+// Rate error clamp, well outside any working crystal
+#define TIMEBASE_MAX_DRIFT_PPB 500000
+
+// Result of feeding one edge to the discipline
+typedef enum {
+    TIMEBASE_EDGE_LOCKED = 0,  // First edge, mapping established
+    TIMEBASE_EDGE_TRACKED,     // Phase and rate updated
+    TIMEBASE_EDGE_STEPPED,     // Wall clock jumped, phase re-anchored
+    TIMEBASE_EDGE_REJECTED     // Edge ignored (out of order or bad input)
+} timebase_edge_result_t;
+
+typedef struct {
+    bool locked;
+    int64_t anchor_mono_us;    // Monotonic time of the anchor
+    int64_t anchor_unix_us;    // Wall-clock time at the anchor
+    int32_t drift_ppb;         // Monotonic rate error; positive = runs fast
+    uint32_t uncertainty_us;   // Smoothed conversion error estimate
+    int32_t last_residual_us;  // Observed minus predicted at the last edge
+    uint32_t edges;            // Edges accepted since init
+    uint32_t steps;            // Phase steps since init
+} timebase_disc_t;
+
+/**
+ * @brief Reset the discipline to the unlocked state
+ */
+void timebase_disc_init(timebase_disc_t *disc);
+
+/**
+ * @brief Feed one RTC second-rollover edge
+ *
+ * @param disc Discipline state
+ * @param edge_mono_us Monotonic time of the rollover
+ * @param unix_sec Unix second that began at the rollover
+ * @param edge_uncertainty_us Half-width of the capture window
+ * @return What the edge did to the mapping
+ */
+timebase_edge_result_t timebase_disc_edge(timebase_disc_t *disc,
+                                          int64_t edge_mono_us,
+                                          int64_t unix_sec,
+                                          uint32_t edge_uncertainty_us);
+
+/**
+ * @brief Convert a monotonic timestamp to wall-clock microseconds
+ *
+ * @return false if the discipline is not locked
+ */
+bool timebase_disc_to_unix(const timebase_disc_t *disc, int64_t mono_us, int64_t *unix_us);
+
+/**
+ * @brief Predict the monotonic time of the first whole second after mono_us
+ *
+ * Used to wake just before the next rollover instead of polling for a
+ * full second.
+ *
+ * @return false if the discipline is not locked
+ */
+bool timebase_disc_next_edge(const timebase_disc_t *disc, int64_t mono_us, int64_t *edge_mono_us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,311 @@
+/*
+ * Timebase Component Implementation
+ *
+ * A low-priority task captures one RTC seconds rollover per sync interval
+ * and feeds it to the drift discipline. Once locked, the polled capture
+ * wakes just before the predicted rollover, so the I2C bus is only busy
+ * for a few tens of milliseconds per interval.
+ */
+
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <driver/gpio.h>
+#include <esp_attr.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "timebase.h"
+#include "timebase_discipline.h"
+#include "rtc_pcf85063a.h"
+
+static const char *TAG = "timebase";
+
+#define TIMEBASE_TASK_STACK_SIZE 3072
+#define TIMEBASE_TASK_PRIORITY 2
+
+// Full search covers one rollover even if the phase is unknown
+#define FULL_CAPTURE_TIMEOUT_MS 1100
+// Wake this long before a predicted rollover and poll through it
+#define CAPTURE_GUARD_US 20000
+#define PREDICTED_CAPTURE_TIMEOUT_MS 60
+#define RTC_RETRY_DELAY_MS 5000
+
+// Interrupt latency bound for CLKOUT timestamps
+#define CLKOUT_UNCERTAINTY_US 10
+
+// Module state
+static struct {
+    bool initialized;
+    TaskHandle_t task;
+    timebase_disc_t disc;
+    uint32_t generation;
+    bool clkout_installed;
+    volatile int64_t clkout_edge_us;
+} s_tb = {
+    .initialized = false,
+    .task = NULL,
+    .generation = 0,
+    .clkout_installed = false,
+    .clkout_edge_us = 0
+};
+
+static portMUX_TYPE s_tb_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void snapshot_disc(timebase_disc_t *out, uint32_t *generation)
+{
+    portENTER_CRITICAL(&s_tb_lock);
+    *out = s_tb.disc;
+    if (generation)
+    {
+        *generation = s_tb.generation;
+    }
+    portEXIT_CRITICAL(&s_tb_lock);
+}
+
+#if CONFIG_TIMEBASE_CLKOUT_GPIO >= 0
+static void IRAM_ATTR clkout_isr(void *arg)
+{
+    (void)arg;
+    s_tb.clkout_edge_us = esp_timer_get_time();
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_tb.task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+#endif
+
+static void clkout_init(void)
+{
+#if CONFIG_TIMEBASE_CLKOUT_GPIO >= 0
+    gpio_config_t io_conf = {
+        .pin_bit_mask = 1ULL << CONFIG_TIMEBASE_CLKOUT_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,  // CLKOUT is open-drain
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+#if CONFIG_TIMEBASE_CLKOUT_FALLING_EDGE
+        .intr_type = GPIO_INTR_NEGEDGE,
+#else
+        .intr_type = GPIO_INTR_POSEDGE,
+#endif
+    };
+
+    esp_err_t err = pcf_rtc_set_clkout_1hz(true);
+    if (err == ESP_OK)
+    {
+        err = gpio_config(&io_conf);
+    }
+    if (err == ESP_OK)
+    {
+        err = gpio_install_isr_service(ESP_INTR_FLAG_IRAM);
+        if (err == ESP_ERR_INVALID_STATE)
+        {
+            err = ESP_OK;  // Already installed by another component
+        }
+    }
+    if (err == ESP_OK)
+    {
+        err = gpio_isr_handler_add(CONFIG_TIMEBASE_CLKOUT_GPIO, clkout_isr, NULL);
+    }
+
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "CLKOUT GPIO %d setup failed: %s (falling back to polling)",
+                 CONFIG_TIMEBASE_CLKOUT_GPIO, esp_err_to_name(err));
+        return;
+    }
+
+    // Only interrupt while a capture is in progress
+    gpio_intr_disable(CONFIG_TIMEBASE_CLKOUT_GPIO);
+    s_tb.clkout_installed = true;
+    ESP_LOGI(TAG, "Capturing RTC rollovers on CLKOUT GPIO %d", CONFIG_TIMEBASE_CLKOUT_GPIO);
+#endif
+}
+
+static esp_err_t capture_clkout(pcf_rtc_edge_t *edge)
+{
+#if CONFIG_TIMEBASE_CLKOUT_GPIO >= 0
+    ulTaskNotifyTake(pdTRUE, 0);
+    gpio_intr_enable(CONFIG_TIMEBASE_CLKOUT_GPIO);
+    uint32_t notified = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FULL_CAPTURE_TIMEOUT_MS));
+    gpio_intr_disable(CONFIG_TIMEBASE_CLKOUT_GPIO);
+
+    if (!notified)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    return pcf_rtc_stamp_edge(s_tb.clkout_edge_us, CLKOUT_UNCERTAINTY_US, edge);
+#else
+    (void)edge;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+static esp_err_t capture_polled(pcf_rtc_edge_t *edge)
+{
+    timebase_disc_t disc;
+    snapshot_disc(&disc, NULL);
+
+    int64_t now_us = esp_timer_get_time();
+    int64_t predicted_us = 0;
+    if (timebase_disc_next_edge(&disc, now_us + CAPTURE_GUARD_US, &predicted_us))
+    {
+        int64_t wait_us = predicted_us - CAPTURE_GUARD_US - now_us;
+        if (wait_us > 0)
+        {
+            vTaskDelay(pdMS_TO_TICKS(wait_us / 1000));
+        }
+
+        esp_err_t err = pcf_rtc_capture_second_edge(PREDICTED_CAPTURE_TIMEOUT_MS, edge);
+        if (err != ESP_ERR_TIMEOUT)
+        {
+            return err;
+        }
+        // Phase moved (RTC was set); search a full second
+    }
+
+    return pcf_rtc_capture_second_edge(FULL_CAPTURE_TIMEOUT_MS, edge);
+}
+
+static void apply_edge(const pcf_rtc_edge_t *edge)
+{
+    portENTER_CRITICAL(&s_tb_lock);
+    timebase_edge_result_t result = timebase_disc_edge(&s_tb.disc, edge->edge_us,
+                                                       edge->unix_sec, edge->uncertainty_us);
+    if (result != TIMEBASE_EDGE_REJECTED)
+    {
+        s_tb.generation++;
+    }
+    timebase_disc_t disc = s_tb.disc;
+    portEXIT_CRITICAL(&s_tb_lock);
+
+    switch (result)
+    {
+        case TIMEBASE_EDGE_LOCKED:
+            ESP_LOGI(TAG, "Locked to RTC (capture window +/-%lu us)",
+                     (unsigned long)edge->uncertainty_us);
+            break;
+        case TIMEBASE_EDGE_STEPPED:
+            ESP_LOGW(TAG, "Wall clock stepped, re-anchored to RTC");
+            break;
+        case TIMEBASE_EDGE_TRACKED:
+            ESP_LOGD(TAG, "Residual %ld us, drift %ld ppb, uncertainty %lu us",
+                     (long)disc.last_residual_us, (long)disc.drift_ppb,
+                     (unsigned long)disc.uncertainty_us);
+            break;
+        default:
+            ESP_LOGW(TAG, "Rollover rejected (edge at %lld us)", (long long)edge->edge_us);
+            break;
+    }
+}
+
+static void timebase_task(void *arg)
+{
+    (void)arg;
+
+    clkout_init();
+
+    while (true)
+    {
+        if (!pcf_rtc_is_time_valid())
+        {
+            vTaskDelay(pdMS_TO_TICKS(RTC_RETRY_DELAY_MS));
+            continue;
+        }
+
+        pcf_rtc_edge_t edge;
+        esp_err_t err = s_tb.clkout_installed ? capture_clkout(&edge) : capture_polled(&edge);
+        if (err != ESP_OK)
+        {
+            ESP_LOGW(TAG, "RTC rollover capture failed: %s", esp_err_to_name(err));
+            vTaskDelay(pdMS_TO_TICKS(RTC_RETRY_DELAY_MS));
+            continue;
+        }
+
+        apply_edge(&edge);
+
+        // The next capture waits up to another second for its rollover
+        vTaskDelay(pdMS_TO_TICKS((CONFIG_TIMEBASE_SYNC_INTERVAL_S - 1) * 1000));
+    }
+}
+
+esp_err_t timebase_init(void)
+{
+    if (s_tb.initialized)
+    {
+        ESP_LOGW(TAG, "Already initialized");
+        return ESP_OK;
+    }
+
+    if (!pcf_rtc_is_initialized())
+    {
+        ESP_LOGE(TAG, "RTC not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    timebase_disc_init(&s_tb.disc);
+    s_tb.generation = 0;
+
+    BaseType_t result = xTaskCreate(timebase_task, "timebase",
+                                    TIMEBASE_TASK_STACK_SIZE, NULL,
+                                    TIMEBASE_TASK_PRIORITY, &s_tb.task);
+    if (result != pdTRUE)
+    {
+        ESP_LOGE(TAG, "Failed to create timebase task");
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_tb.initialized = true;
+    ESP_LOGI(TAG, "Timebase started (sync every %d s)", CONFIG_TIMEBASE_SYNC_INTERVAL_S);
+    return ESP_OK;
+}
+
+bool timebase_is_synced(void)
+{
+    timebase_disc_t disc;
+    snapshot_disc(&disc, NULL);
+    return disc.locked;
+}
+
+bool timebase_mono_to_unix_us(int64_t mono_us, int64_t *unix_us)
+{
+    timebase_disc_t disc;
+    snapshot_disc(&disc, NULL);
+    return timebase_disc_to_unix(&disc, mono_us, unix_us);
+}
+
+bool timebase_now_unix_us(int64_t *unix_us)
+{
+    return timebase_mono_to_unix_us(esp_timer_get_time(), unix_us);
+}
+
+esp_err_t timebase_get_status(timebase_status_t *status)
+{
+    if (!status)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_tb.initialized)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    timebase_disc_t disc;
+    uint32_t generation = 0;
+    snapshot_disc(&disc, &generation);
+
+    memset(status, 0, sizeof(*status));
+    status->mono_us = esp_timer_get_time();
+    status->synced = timebase_disc_to_unix(&disc, status->mono_us, &status->unix_us);
+    status->drift_ppb = disc.drift_ppb;
+    status->uncertainty_us = disc.uncertainty_us;
+    status->last_residual_us = disc.last_residual_us;
+    status->edges = disc.edges;
+    status->steps = disc.steps;
+    status->generation = generation;
+
+    return ESP_OK;
+}
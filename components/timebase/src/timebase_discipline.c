@@ -0,0 +1,130 @@
+/*
+ * Timebase Drift Discipline - Implementation
+ */
+
+#include "timebase_discipline.h"
+
+#include <string.h>
+
+#define US_PER_SEC 1000000LL
+#define PPB 1000000000LL
+
+// Alpha-beta loop gains (as divisors): phase follows half of each
+// residual, the rate takes a quarter of the implied frequency error.
+// Damped enough to reject edge jitter without ringing on a drift change.
+#define PHASE_GAIN_DIV 2
+#define RATE_GAIN_DIV 4
+
+// Uncertainty tracks |residual| with a 1/8 exponential average
+#define UNCERTAINTY_DIV 8
+
+static int64_t abs64(int64_t v)
+{
+    return v < 0 ? -v : v;
+}
+
+static int64_t scale_ppb(int64_t delta_us, int32_t ppb)
+{
+    return (delta_us * (int64_t)ppb) / PPB;
+}
+
+void timebase_disc_init(timebase_disc_t *disc)
+{
+    if (disc) {
+        memset(disc, 0, sizeof(*disc));
+    }
+}
+
+bool timebase_disc_to_unix(const timebase_disc_t *disc, int64_t mono_us, int64_t *unix_us)
+{
+    if (!disc || !unix_us || !disc->locked) {
+        return false;
+    }
+
+    int64_t delta = mono_us - disc->anchor_mono_us;
+    *unix_us = disc->anchor_unix_us + delta - scale_ppb(delta, disc->drift_ppb);
+    return true;
+}
+
+bool timebase_disc_next_edge(const timebase_disc_t *disc, int64_t mono_us, int64_t *edge_mono_us)
+{
+    int64_t unix_us = 0;
+    if (!edge_mono_us || !timebase_disc_to_unix(disc, mono_us, &unix_us)) {
+        return false;
+    }
+
+    int64_t next_sec_us = (unix_us / US_PER_SEC + 1) * US_PER_SEC;
+    int64_t delta = next_sec_us - disc->anchor_unix_us;
+    *edge_mono_us = disc->anchor_mono_us + delta + scale_ppb(delta, disc->drift_ppb);
+    return true;
+}
+
+static void disc_anchor(timebase_disc_t *disc, int64_t edge_mono_us, int64_t unix_sec,
+                        uint32_t edge_uncertainty_us)
+{
+    disc->anchor_mono_us = edge_mono_us;
+    disc->anchor_unix_us = unix_sec * US_PER_SEC;
+    disc->uncertainty_us = edge_uncertainty_us;
+    disc->last_residual_us = 0;
+    disc->locked = true;
+}
+
+timebase_edge_result_t timebase_disc_edge(timebase_disc_t *disc,
+                                          int64_t edge_mono_us,
+                                          int64_t unix_sec,
+                                          uint32_t edge_uncertainty_us)
+{
+    if (!disc || unix_sec < 0) {
+        return TIMEBASE_EDGE_REJECTED;
+    }
+
+    if (!disc->locked) {
+        disc_anchor(disc, edge_mono_us, unix_sec, edge_uncertainty_us);
+        disc->edges++;
+        return TIMEBASE_EDGE_LOCKED;
+    }
+
+    if (edge_mono_us <= disc->anchor_mono_us) {
+        return TIMEBASE_EDGE_REJECTED;
+    }
+
+    int64_t predicted_us = 0;
+    timebase_disc_to_unix(disc, edge_mono_us, &predicted_us);
+    int64_t observed_us = unix_sec * US_PER_SEC;
+    int64_t residual = observed_us - predicted_us;
+
+    if (abs64(residual) > TIMEBASE_STEP_THRESHOLD_US) {
+        // The crystal did not change, only the time on it - keep the rate
+        disc_anchor(disc, edge_mono_us, unix_sec, edge_uncertainty_us);
+        disc->edges++;
+        disc->steps++;
+        return TIMEBASE_EDGE_STEPPED;
+    }
+
+    // Rate: a positive residual means less monotonic time elapsed than we
+    // assumed per wall second, i.e. the monotonic clock runs slower
+    int64_t interval_us = observed_us - disc->anchor_unix_us;
+    if (interval_us > 0) {
+        int64_t rate_error_ppb = (residual * PPB) / interval_us;
+        int64_t drift = (int64_t)disc->drift_ppb - rate_error_ppb / RATE_GAIN_DIV;
+        if (drift > TIMEBASE_MAX_DRIFT_PPB) {
+            drift = TIMEBASE_MAX_DRIFT_PPB;
+        } else if (drift < -TIMEBASE_MAX_DRIFT_PPB) {
+            drift = -TIMEBASE_MAX_DRIFT_PPB;
+        }
+        disc->drift_ppb = (int32_t)drift;
+    }
+
+    // Phase: re-anchor at this edge, taking part of the residual
+    disc->anchor_mono_us = edge_mono_us;
+    disc->anchor_unix_us = predicted_us + residual / PHASE_GAIN_DIV;
+
+    int64_t error_us = abs64(residual) + edge_uncertainty_us;
+    int64_t smoothed = (int64_t)disc->uncertainty_us +
+                       ((error_us - (int64_t)disc->uncertainty_us) / UNCERTAINTY_DIV);
+    disc->uncertainty_us = (uint32_t)(smoothed < 0 ? 0 : smoothed);
+    disc->last_residual_us = (int32_t)residual;
+    disc->edges++;
+
+    return TIMEBASE_EDGE_TRACKED;
+}
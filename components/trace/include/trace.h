@@ -0,0 +1,152 @@
+/*
+ * Trace Recorder
+ *
+ * Binary event trace for timing work. Each core records into its own
+ * ring in internal RAM: a cycle-counter timestamp, an event ID and two
+ * arguments, with no formatting and no locks. The rings are dumped on
+ * demand to the SD card or the console and converted on the host with
+ * analysis/trace_to_chrome.py (see docs/TRACING.md).
+ *
+ * With CONFIG_TRACE_ENABLED off, every TRACE_* macro compiles to nothing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <esp_cpu.h>
+
+#include "esp_err.h"
+#include "mem_plan.h"
+#include "trace_format.h"
+#include "trace_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    TRACE_DUMP_SD = 0,  // TRACE_<date>_<time>_<seq>.trc on the card, console if none
+    TRACE_DUMP_CONSOLE  // Hex lines between TRACE-BEGIN / TRACE-END markers
+} trace_dump_target_t;
+
+// Read by the inline recorder; use the functions below to change them
+extern trace_ring_t trace_core_rings[portNUM_PROCESSORS];
+extern volatile bool trace_recording;
+
+/**
+ * @brief Record one event on the calling core
+ *
+ * Safe from tasks and ISRs. Costs a cycle-counter read, one atomic
+ * increment and four stores.
+ *
+ * @param id TRACE_ID(kind, phase)
+ * @param arg0 First argument
+ * @param arg1 Second argument
+ */
+static inline void trace_record(uint16_t id, uint32_t arg0, uint32_t arg1)
+{
+    if (!trace_recording)
+    {
+        return;
+    }
+    trace_ring_record(&trace_core_rings[esp_cpu_get_core_id()],
+                      esp_cpu_get_cycle_count(), id, arg0, arg1);
+}
+
+#if CONFIG_TRACE_ENABLED
+#define TRACE_INSTANT(kind, a0, a1) trace_record(TRACE_ID(kind, TRACE_PHASE_INSTANT), (uint32_t)(a0), (uint32_t)(a1))
+#define TRACE_BEGIN(kind, a0, a1) trace_record(TRACE_ID(kind, TRACE_PHASE_BEGIN), (uint32_t)(a0), (uint32_t)(a1))
+#define TRACE_END(kind, a0, a1) trace_record(TRACE_ID(kind, TRACE_PHASE_END), (uint32_t)(a0), (uint32_t)(a1))
+#else
+#define TRACE_INSTANT(kind, a0, a1) do { } while (0)
+#define TRACE_BEGIN(kind, a0, a1) do { } while (0)
+#define TRACE_END(kind, a0, a1) do { } while (0)
+#endif
+
+// Pipeline events
+#define TRACE_CAN_RX(id, dlc) TRACE_INSTANT(TRACE_EV_CAN_RX, id, dlc)
+#define TRACE_DECODE_BEGIN(id) TRACE_BEGIN(TRACE_EV_DECODE, id, 0)
+#define TRACE_DECODE_END(id) TRACE_END(TRACE_EV_DECODE, id, 0)
+#define TRACE_LOG_ENQUEUE(id, depth) TRACE_INSTANT(TRACE_EV_LOG_ENQUEUE, id, depth)
+#define TRACE_LOG_DROP(id) TRACE_INSTANT(TRACE_EV_LOG_DROP, id, 0)
+#define TRACE_FLUSH_BEGIN(bytes) TRACE_BEGIN(TRACE_EV_FLUSH, bytes, 0)
+#define TRACE_FLUSH_END(bytes) TRACE_END(TRACE_EV_FLUSH, bytes, 0)
+#define TRACE_SD_WRITE_BEGIN(bytes) TRACE_BEGIN(TRACE_EV_SD_WRITE, bytes, 0)
+#define TRACE_SD_WRITE_END(written) TRACE_END(TRACE_EV_SD_WRITE, written, 0)
+#define TRACE_SD_SYNC_BEGIN() TRACE_BEGIN(TRACE_EV_SD_SYNC, 0, 0)
+#define TRACE_SD_SYNC_END() TRACE_END(TRACE_EV_SD_SYNC, 0, 0)
+#define TRACE_LVGL_RENDER_BEGIN() TRACE_BEGIN(TRACE_EV_LVGL_RENDER, 0, 0)
+#define TRACE_LVGL_RENDER_END() TRACE_END(TRACE_EV_LVGL_RENDER, 0, 0)
+#define TRACE_LVGL_FLUSH(px, y1, y2) TRACE_INSTANT(TRACE_EV_LVGL_FLUSH, px, ((uint32_t)(y1) << 16) | ((y2) & 0xFFFF))
+#define TRACE_PAGE_UPDATE_BEGIN(page) TRACE_BEGIN(TRACE_EV_PAGE_UPDATE, page, 0)
+#define TRACE_PAGE_UPDATE_END(page) TRACE_END(TRACE_EV_PAGE_UPDATE, page, 0)
+
+// First four payload bytes as one big-endian argument
+#define TRACE_DATA4(d) (((uint32_t)(d)[0] << 24) | ((uint32_t)(d)[1] << 16) | \
+                        ((uint32_t)(d)[2] << 8) | (uint32_t)(d)[3])
+
+/**
+ * @brief Add the per-core rings to the boot memory plan
+ *
+ * @param budget Budget to add to
+ */
+void trace_plan_memory(mem_plan_budget_t *budget);
+
+/**
+ * @brief Take the rings from the memory plan and start recording
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM if the rings are not planned,
+ *         ESP_ERR_NOT_SUPPORTED with CONFIG_TRACE_ENABLED off
+ */
+esp_err_t trace_init(void);
+
+/**
+ * @brief Pause or resume recording on all cores
+ *
+ * @param enabled true to record
+ */
+void trace_set_enabled(bool enabled);
+
+/**
+ * @brief Record a clock reference (cycles to esp_timer) on every core
+ *
+ * Anchors cycle timestamps across counter wraps (about 17 s at 240 MHz);
+ * trace_service() calls it periodically.
+ */
+void trace_clock_sync(void);
+
+/**
+ * @brief Ask for a dump on the next trace_service() call
+ *
+ * Cheap and safe from any task, e.g. a UI event callback.
+ *
+ * @param target Where to dump
+ */
+void trace_request_dump(trace_dump_target_t target);
+
+/**
+ * @brief Periodic upkeep: clock references and requested dumps
+ *
+ * Call every few seconds from a low-priority task; a dump blocks the
+ * caller for the duration of the write.
+ */
+void trace_service(void);
+
+/**
+ * @brief Dump all rings now
+ *
+ * Recording is paused for the duration and the rings are cleared after a
+ * successful dump.
+ *
+ * @param target Where to dump
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not initialized,
+ *         ESP_FAIL if the file could not be written
+ */
+esp_err_t trace_dump(trace_dump_target_t target);
+
+#ifdef __cplusplus
+}
+#endif
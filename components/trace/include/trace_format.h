@@ -0,0 +1,81 @@
+/*
+ * Trace Event Format
+ *
+ * Binary trace events and the dump file layout (see docs/TRACING.md).
+ * No hardware dependencies - shared by the recorder and host-side tests.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACE_FILE_MAGIC "CANTRACE"
+#define TRACE_FILE_VERSION 1
+
+// Phase in the top two bits of an event ID, event kind in the rest
+#define TRACE_PHASE_SHIFT 14
+#define TRACE_KIND_MASK 0x3FFF
+
+typedef enum {
+    TRACE_PHASE_INSTANT = 0,
+    TRACE_PHASE_BEGIN = 1,
+    TRACE_PHASE_END = 2,
+} trace_phase_t;
+
+#define TRACE_ID(kind, phase) ((uint16_t)(((phase) << TRACE_PHASE_SHIFT) | ((kind) & TRACE_KIND_MASK)))
+#define TRACE_ID_KIND(id) ((id) & TRACE_KIND_MASK)
+#define TRACE_ID_PHASE(id) ((trace_phase_t)((id) >> TRACE_PHASE_SHIFT))
+
+// Event kinds (names and arguments are mirrored in analysis/trace_to_chrome.py)
+typedef enum {
+    TRACE_EV_CLOCK = 1,       // arg0/arg1 = esp_timer us low/high at this cycle count
+    TRACE_EV_CAN_RX,          // arg0 = CAN ID, arg1 = DLC
+    TRACE_EV_DECODE,          // arg0 = CAN ID
+    TRACE_EV_LOG_ENQUEUE,     // arg0 = CAN ID, arg1 = ring depth in frames
+    TRACE_EV_LOG_DROP,        // arg0 = CAN ID
+    TRACE_EV_FLUSH,           // arg0 = bytes
+    TRACE_EV_SD_WRITE,        // arg0 = bytes, end arg0 = bytes written (or -1)
+    TRACE_EV_SD_SYNC,
+    TRACE_EV_LVGL_RENDER,     // lv_timer_handler() pass
+    TRACE_EV_LVGL_FLUSH,      // arg0 = pixels, arg1 = y1 << 16 | y2
+    TRACE_EV_PAGE_UPDATE,     // arg0 = page index
+    TRACE_EV_OBD_RESPONSE,    // arg0 = CAN ID, arg1 = data[0..3] big-endian
+    TRACE_EV_OBD_REQUEST,     // arg0 = CAN ID, arg1 = data[0..3] big-endian
+    TRACE_EV_FUEL_LEVEL,      // arg0 = raw, arg1 = gallons * 100
+    TRACE_EV_KIND_COUNT
+} trace_event_kind_t;
+
+typedef struct {
+    uint32_t cycles;     // CPU cycle counter of the recording core
+    uint16_t id;         // TRACE_ID(kind, phase)
+    uint16_t reserved;
+    uint32_t arg0;
+    uint32_t arg1;
+} trace_event_t;
+
+// Dump file: header, then per core a core header followed by its events
+// (oldest first). All fields little-endian.
+typedef struct __attribute__((packed)) {
+    char magic[8];
+    uint16_t version;
+    uint16_t header_size;
+    uint8_t core_count;
+    uint8_t reserved[3];
+    uint32_t cpu_freq_hz;
+} trace_file_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint64_t ref_us;          // esp_timer time at ref_cycles
+    uint32_t ref_cycles;      // Cycle counter of this core at dump time
+    uint32_t event_count;     // Events that follow
+    uint32_t total_events;    // Events ever recorded (older ones were overwritten)
+    uint32_t reserved;
+} trace_core_header_t;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,98 @@
+/*
+ * Trace Ring
+ *
+ * Fixed-size ring of trace events that keeps the newest ones. Recording
+ * claims a slot with one atomic increment and never blocks, so tasks and
+ * ISRs on the same core can record concurrently. The recorder keeps one
+ * ring per core, which keeps the counter uncontended.
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "trace_format.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    trace_event_t *events;
+    uint32_t mask;  // Capacity - 1 (capacity is a power of two)
+    uint32_t head;  // Events ever recorded (wraps)
+} trace_ring_t;
+
+/**
+ * @brief Largest power of two not above a requested capacity
+ *
+ * @param requested Requested number of events
+ * @return Usable capacity (0 if requested is 0)
+ */
+uint32_t trace_ring_capacity_for(uint32_t requested);
+
+/**
+ * @brief Set up a ring over caller-provided storage
+ *
+ * @param ring Ring to initialize
+ * @param storage Event storage
+ * @param capacity Number of events in storage (rounded down to a power of two)
+ */
+void trace_ring_init(trace_ring_t *ring, trace_event_t *storage, uint32_t capacity);
+
+/**
+ * @brief Record one event, overwriting the oldest when full
+ *
+ * @param ring Ring (must have storage)
+ * @param cycles Timestamp in CPU cycles
+ * @param id TRACE_ID(kind, phase)
+ * @param arg0 First argument
+ * @param arg1 Second argument
+ */
+static inline void trace_ring_record(trace_ring_t *ring, uint32_t cycles, uint16_t id,
+                                     uint32_t arg0, uint32_t arg1)
+{
+    uint32_t slot = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED) & ring->mask;
+    trace_event_t *ev = &ring->events[slot];
+    ev->cycles = cycles;
+    ev->id = id;
+    ev->reserved = 0;
+    ev->arg0 = arg0;
+    ev->arg1 = arg1;
+}
+
+/**
+ * @brief Number of events currently held
+ *
+ * @param ring Ring
+ * @return Events available to trace_ring_read()
+ */
+uint32_t trace_ring_count(const trace_ring_t *ring);
+
+/**
+ * @brief Copy held events, oldest first
+ *
+ * Recording should be paused while reading, otherwise events can be
+ * overwritten under the reader.
+ *
+ * @param ring Ring
+ * @param offset Index from the oldest held event
+ * @param out Destination
+ * @param max Maximum events to copy
+ * @return Events copied
+ */
+uint32_t trace_ring_read(const trace_ring_t *ring, uint32_t offset,
+                         trace_event_t *out, uint32_t max);
+
+/**
+ * @brief Drop all held events
+ *
+ * @param ring Ring
+ */
+void trace_ring_clear(trace_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
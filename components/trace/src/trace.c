@@ -0,0 +1,272 @@
+/*
+ * Trace Recorder Implementation
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_rom_sys.h>
+#include <esp_timer.h>
+#if !CONFIG_FREERTOS_UNICORE
+#include <esp_ipc.h>
+#endif
+
+#include "trace.h"
+#include "sd_card.h"
+
+static const char *TAG = "trace";
+
+#define TRACE_DUMP_CHUNK_EVENTS 32   // Events copied per write
+#define TRACE_CONSOLE_LINE_BYTES 32  // Payload bytes per console line
+#define TRACE_NO_DUMP -1
+
+trace_ring_t trace_core_rings[portNUM_PROCESSORS];
+volatile bool trace_recording = false;
+
+typedef struct {
+    uint64_t us;
+    uint32_t cycles;
+} clock_ref_t;
+
+typedef struct {
+    void *file;  // NULL = console
+    bool ok;
+} dump_sink_t;
+
+// Module state
+static struct {
+    bool initialized;
+    int pending_dump;
+    clock_ref_t refs[portNUM_PROCESSORS];
+} s_trace = {
+    .initialized = false,
+    .pending_dump = TRACE_NO_DUMP
+};
+
+static void clock_sync_on_core(void *arg)
+{
+    (void)arg;
+    int64_t now_us = esp_timer_get_time();
+    trace_record(TRACE_ID(TRACE_EV_CLOCK, TRACE_PHASE_INSTANT),
+                 (uint32_t)now_us, (uint32_t)((uint64_t)now_us >> 32));
+}
+
+static void clock_ref_on_core(void *arg)
+{
+    clock_ref_t *ref = (clock_ref_t *)arg;
+    ref->cycles = esp_cpu_get_cycle_count();
+    ref->us = (uint64_t)esp_timer_get_time();
+}
+
+static void run_on_each_core(void (*fn)(void *), void *args, size_t arg_size)
+{
+#if CONFIG_FREERTOS_UNICORE
+    (void)arg_size;
+    fn(args);
+#else
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        esp_ipc_call_blocking(core, fn, args ? (uint8_t *)args + core * arg_size : NULL);
+    }
+#endif
+}
+
+static void sink_write(dump_sink_t *sink, const void *data, size_t len)
+{
+    if (!sink->ok)
+    {
+        return;
+    }
+
+    if (sink->file)
+    {
+        int written = sd_card_write(sink->file, data, len);
+        sink->ok = written >= 0 && (size_t)written == len;
+        return;
+    }
+
+    const uint8_t *bytes = (const uint8_t *)data;
+    while (len > 0)
+    {
+        size_t n = len < TRACE_CONSOLE_LINE_BYTES ? len : TRACE_CONSOLE_LINE_BYTES;
+        char line[8 + TRACE_CONSOLE_LINE_BYTES * 2 + 1];
+        int pos = snprintf(line, sizeof(line), "TRACE:");
+        for (size_t i = 0; i < n; i++)
+        {
+            pos += snprintf(line + pos, sizeof(line) - pos, "%02x", bytes[i]);
+        }
+        puts(line);
+        bytes += n;
+        len -= n;
+    }
+}
+
+void trace_plan_memory(mem_plan_budget_t *budget)
+{
+#if CONFIG_TRACE_ENABLED
+    uint32_t capacity = trace_ring_capacity_for(CONFIG_TRACE_EVENTS_PER_CORE);
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        mem_plan_budget_add(budget, MEM_REGION_INTERNAL, capacity * sizeof(trace_event_t), 16);
+    }
+#else
+    (void)budget;
+#endif
+}
+
+esp_err_t trace_init(void)
+{
+#if CONFIG_TRACE_ENABLED
+    if (s_trace.initialized)
+    {
+        return ESP_OK;
+    }
+
+    uint32_t capacity = trace_ring_capacity_for(CONFIG_TRACE_EVENTS_PER_CORE);
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        trace_event_t *storage = mem_plan_alloc(MEM_REGION_INTERNAL,
+                                                capacity * sizeof(trace_event_t), 16,
+                                                "trace ring");
+        if (!storage)
+        {
+            ESP_LOGE(TAG, "Trace rings missing from the memory plan");
+            return ESP_ERR_NO_MEM;
+        }
+        trace_ring_init(&trace_core_rings[core], storage, capacity);
+    }
+
+    s_trace.initialized = true;
+    trace_recording = true;
+    trace_clock_sync();
+
+    ESP_LOGI(TAG, "Recording %u events per core", (unsigned)capacity);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void trace_set_enabled(bool enabled)
+{
+    trace_recording = enabled && s_trace.initialized;
+}
+
+void trace_clock_sync(void)
+{
+    if (!trace_recording)
+    {
+        return;
+    }
+
+    run_on_each_core(clock_sync_on_core, NULL, 0);
+}
+
+void trace_request_dump(trace_dump_target_t target)
+{
+    __atomic_store_n(&s_trace.pending_dump, (int)target, __ATOMIC_RELAXED);
+}
+
+void trace_service(void)
+{
+    int target = __atomic_exchange_n(&s_trace.pending_dump, TRACE_NO_DUMP, __ATOMIC_RELAXED);
+    if (target != TRACE_NO_DUMP)
+    {
+        esp_err_t err = trace_dump((trace_dump_target_t)target);
+        if (err != ESP_OK)
+        {
+            ESP_LOGW(TAG, "Trace dump failed: %s", esp_err_to_name(err));
+        }
+    }
+
+    trace_clock_sync();
+}
+
+esp_err_t trace_dump(trace_dump_target_t target)
+{
+    if (!s_trace.initialized)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Pause, and give records already past the check time to land
+    bool was_recording = trace_recording;
+    trace_recording = false;
+    vTaskDelay(1);
+
+    char path[64] = {0};
+    dump_sink_t sink = {.file = NULL, .ok = true};
+    if (target == TRACE_DUMP_SD && sd_card_is_mounted())
+    {
+        sink.file = sd_card_create_log_file_with_timestamp("TRACE", "trc", path, sizeof(path));
+        if (!sink.file)
+        {
+            ESP_LOGW(TAG, "Cannot create trace file, dumping to console");
+        }
+    }
+
+    run_on_each_core(clock_ref_on_core, s_trace.refs, sizeof(s_trace.refs[0]));
+
+    trace_file_header_t header = {
+        .version = TRACE_FILE_VERSION,
+        .header_size = sizeof(trace_file_header_t),
+        .core_count = portNUM_PROCESSORS,
+        .cpu_freq_hz = esp_rom_get_cpu_ticks_per_us() * 1000000U
+    };
+    memcpy(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic));
+
+    if (!sink.file)
+    {
+        puts("TRACE-BEGIN");
+    }
+    sink_write(&sink, &header, sizeof(header));
+
+    uint32_t total_events = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++)
+    {
+        const trace_ring_t *ring = &trace_core_rings[core];
+        trace_core_header_t core_header = {
+            .ref_us = s_trace.refs[core].us,
+            .ref_cycles = s_trace.refs[core].cycles,
+            .event_count = trace_ring_count(ring),
+            .total_events = ring->head
+        };
+        sink_write(&sink, &core_header, sizeof(core_header));
+
+        trace_event_t chunk[TRACE_DUMP_CHUNK_EVENTS];
+        uint32_t offset = 0;
+        uint32_t n;
+        while ((n = trace_ring_read(ring, offset, chunk, TRACE_DUMP_CHUNK_EVENTS)) > 0)
+        {
+            sink_write(&sink, chunk, n * sizeof(trace_event_t));
+            offset += n;
+        }
+        total_events += core_header.event_count;
+    }
+
+    if (sink.file)
+    {
+        sd_card_close_log_file(sink.file);
+    }
+    else
+    {
+        puts("TRACE-END");
+    }
+
+    if (sink.ok)
+    {
+        for (int core = 0; core < portNUM_PROCESSORS; core++)
+        {
+            trace_ring_clear(&trace_core_rings[core]);
+        }
+        ESP_LOGI(TAG, "Dumped %u events to %s", (unsigned)total_events,
+                 sink.file ? path : "console");
+    }
+
+    trace_recording = was_recording;
+    trace_clock_sync();
+    return sink.ok ? ESP_OK : ESP_FAIL;
+}
@@ -0,0 +1,70 @@
+/*
+ * Trace Ring - Implementation
+ */
+
+#include "trace_ring.h"
+
+#include <stddef.h>
+
+uint32_t trace_ring_capacity_for(uint32_t requested)
+{
+    if (requested == 0) {
+        return 0;
+    }
+
+    uint32_t capacity = 1;
+    while (capacity <= requested / 2) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+void trace_ring_init(trace_ring_t *ring, trace_event_t *storage, uint32_t capacity)
+{
+    if (!ring) {
+        return;
+    }
+
+    capacity = storage ? trace_ring_capacity_for(capacity) : 0;
+    ring->events = storage;
+    ring->mask = capacity > 0 ? capacity - 1 : 0;
+    ring->head = 0;
+}
+
+uint32_t trace_ring_count(const trace_ring_t *ring)
+{
+    if (!ring || !ring->events) {
+        return 0;
+    }
+
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint32_t capacity = ring->mask + 1;
+    return head < capacity ? head : capacity;
+}
+
+uint32_t trace_ring_read(const trace_ring_t *ring, uint32_t offset,
+                         trace_event_t *out, uint32_t max)
+{
+    if (!ring || !out) {
+        return 0;
+    }
+
+    uint32_t count = trace_ring_count(ring);
+    if (offset >= count) {
+        return 0;
+    }
+
+    uint32_t n = count - offset < max ? count - offset : max;
+    uint32_t oldest = __atomic_load_n(&ring->head, __ATOMIC_RELAXED) - count;
+    for (uint32_t i = 0; i < n; i++) {
+        out[i] = ring->events[(oldest + offset + i) & ring->mask];
+    }
+    return n;
+}
+
+void trace_ring_clear(trace_ring_t *ring)
+{
+    if (ring) {
+        __atomic_store_n(&ring->head, 0, __ATOMIC_RELAXED);
+    }
+}
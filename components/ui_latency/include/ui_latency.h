@@ -0,0 +1,87 @@
+/*
+ * UI Latency
+ *
+ * RX-to-pixel latency per displayed signal. The RX path stamps each
+ * decoded value with its frame's arrival time in the metric store; pages
+ * pass that stamp on when they set the bound label, and the display
+ * flush callback completes the sample once the label is on the panel.
+ * See ui_latency_probe.h for the three stages measured. "Flushed" means
+ * copied into the RGB frame buffer; scan-out adds up to one refresh.
+ *
+ * ui_latency_label_updated() and ui_latency_flush_done() must be called
+ * from the LVGL task; stats may be read from any task.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "lvgl.h"
+#include "ui_latency_probe.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UI_LATENCY_MAX_SIGNALS 8
+
+/**
+ * @brief Set up one probe per signal
+ *
+ * @param names Signal names, indexed by signal (kept by pointer)
+ * @param count Number of signals (<= UI_LATENCY_MAX_SIGNALS)
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG otherwise
+ */
+esp_err_t ui_latency_init(const char *const *names, size_t count);
+
+/**
+ * @brief Note that a label bound to a signal was given new text
+ *
+ * Call right after lv_label_set_text(). Cheap when rx_us is not newer
+ * than the last sample.
+ *
+ * @param signal Signal index
+ * @param label Label that was updated
+ * @param rx_us RX time of the frame behind the value (0 = none)
+ */
+void ui_latency_label_updated(int signal, lv_obj_t *label, int64_t rx_us);
+
+/**
+ * @brief Report an area that has been written to the panel
+ *
+ * Matches display_flush_hook_t; register with display_manager_set_flush_hook().
+ *
+ * @param area Flushed area
+ */
+void ui_latency_flush_done(const lv_area_t *area);
+
+/**
+ * @brief Number of signals set up by ui_latency_init()
+ *
+ * @return Signal count
+ */
+size_t ui_latency_signal_count(void);
+
+/**
+ * @brief Name of a signal
+ *
+ * @param signal Signal index
+ * @return Name, or "?" if out of range
+ */
+const char *ui_latency_signal_name(int signal);
+
+/**
+ * @brief Copy a signal's probe and histograms
+ *
+ * @param signal Signal index
+ * @param out Filled with the probe state
+ * @return true on success, false if out of range
+ */
+bool ui_latency_get(int signal, ui_latency_probe_t *out);
+
+#ifdef __cplusplus
+}
+#endif
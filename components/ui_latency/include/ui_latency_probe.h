@@ -0,0 +1,94 @@
+/*
+ * UI Latency Probe
+ *
+ * Follows one displayed signal from CAN frame arrival to pixels. The UI
+ * marks the bound label when it sets new text, handing over the RX time
+ * of the frame the value came from and the label's screen area; the
+ * flush callback then reports each area it has written to the panel.
+ * Once a flushed area covers the label's last row the sample completes.
+ *
+ * Three histograms split the budget:
+ * - rx_to_invalidate: metric store and UI update period
+ * - invalidate_to_flush: LVGL render and panel flush
+ * - rx_to_flush: end to end
+ *
+ * A label marked again before its flush completes counts as superseded
+ * and restarts the sample with the newer frame.
+ *
+ * No hardware dependencies - can be compiled for ESP32 or host testing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "can_latency_hist.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Screen area, inclusive corners (same convention as lv_area_t)
+typedef struct {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+} ui_latency_area_t;
+
+typedef struct {
+    int64_t last_rx_us;          // Newest frame already sampled
+    int64_t pending_rx_us;       // Frame awaiting flush (0 = none)
+    int64_t pending_invalidate_us;
+    ui_latency_area_t area;      // Label area at invalidation
+    uint32_t superseded;         // Samples restarted before their flush
+    can_latency_hist_t rx_to_invalidate;
+    can_latency_hist_t invalidate_to_flush;
+    can_latency_hist_t rx_to_flush;
+} ui_latency_probe_t;
+
+/**
+ * @brief Clear a probe and its histograms
+ *
+ * @param probe Probe to reset
+ */
+void ui_latency_probe_reset(ui_latency_probe_t *probe);
+
+/**
+ * @brief Record that the bound label was invalidated with new text
+ *
+ * Ignored unless rx_us is newer than the last sampled frame, so a label
+ * redrawn without fresh data does not produce samples.
+ *
+ * @param probe Probe
+ * @param rx_us RX time of the frame behind the displayed value (0 = none)
+ * @param now_us Invalidation time
+ * @param area Label area on screen
+ * @return true if a sample was started
+ */
+bool ui_latency_probe_invalidated(ui_latency_probe_t *probe, int64_t rx_us, int64_t now_us,
+                                  const ui_latency_area_t *area);
+
+/**
+ * @brief Report an area that has finished flushing to the panel
+ *
+ * @param probe Probe
+ * @param flushed Area just written
+ * @param now_us Flush completion time
+ * @return true if the pending sample completed
+ */
+bool ui_latency_probe_flushed(ui_latency_probe_t *probe, const ui_latency_area_t *flushed,
+                              int64_t now_us);
+
+/**
+ * @brief Check whether a sample is waiting for its flush
+ *
+ * @param probe Probe
+ * @return true if pending
+ */
+bool ui_latency_probe_pending(const ui_latency_probe_t *probe);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,119 @@
+/*
+ * UI Latency Implementation
+ */
+
+#include <string.h>
+
+#include <esp_timer.h>
+
+#include "ui_latency.h"
+
+// Module state
+static struct {
+    const char *const *names;
+    size_t count;
+    ui_latency_probe_t probes[UI_LATENCY_MAX_SIGNALS];
+    size_t pending;  // Probes waiting for a flush
+} s_lat = {
+    .names = NULL,
+    .count = 0,
+    .pending = 0
+};
+
+esp_err_t ui_latency_init(const char *const *names, size_t count)
+{
+    if (!names || count == 0 || count > UI_LATENCY_MAX_SIGNALS)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    for (size_t i = 0; i < UI_LATENCY_MAX_SIGNALS; i++)
+    {
+        ui_latency_probe_reset(&s_lat.probes[i]);
+    }
+    s_lat.names = names;
+    s_lat.pending = 0;
+    s_lat.count = count;
+    return ESP_OK;
+}
+
+void ui_latency_label_updated(int signal, lv_obj_t *label, int64_t rx_us)
+{
+    if (signal < 0 || (size_t)signal >= s_lat.count || !label)
+    {
+        return;
+    }
+
+    ui_latency_probe_t *probe = &s_lat.probes[signal];
+    if (rx_us <= probe->last_rx_us)
+    {
+        return;
+    }
+
+    // Coordinates from the last layout; the new text is laid out on the
+    // next render, which only moves the label horizontally
+    lv_area_t coords;
+    lv_obj_get_coords(label, &coords);
+    ui_latency_area_t area = {
+        .x1 = coords.x1,
+        .y1 = coords.y1,
+        .x2 = coords.x2,
+        .y2 = coords.y2
+    };
+
+    bool was_pending = ui_latency_probe_pending(probe);
+    if (ui_latency_probe_invalidated(probe, rx_us, esp_timer_get_time(), &area) && !was_pending)
+    {
+        s_lat.pending++;
+    }
+}
+
+void ui_latency_flush_done(const lv_area_t *area)
+{
+    if (!area || s_lat.pending == 0)
+    {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    ui_latency_area_t flushed = {
+        .x1 = area->x1,
+        .y1 = area->y1,
+        .x2 = area->x2,
+        .y2 = area->y2
+    };
+
+    for (size_t i = 0; i < s_lat.count; i++)
+    {
+        if (ui_latency_probe_flushed(&s_lat.probes[i], &flushed, now_us))
+        {
+            s_lat.pending--;
+        }
+    }
+}
+
+size_t ui_latency_signal_count(void)
+{
+    return s_lat.count;
+}
+
+const char *ui_latency_signal_name(int signal)
+{
+    if (signal < 0 || (size_t)signal >= s_lat.count)
+    {
+        return "?";
+    }
+    return s_lat.names[signal];
+}
+
+bool ui_latency_get(int signal, ui_latency_probe_t *out)
+{
+    if (signal < 0 || (size_t)signal >= s_lat.count || !out)
+    {
+        return false;
+    }
+
+    // Single writer (LVGL task); a concurrent copy may be one sample behind
+    memcpy(out, &s_lat.probes[signal], sizeof(*out));
+    return true;
+}
@@ -0,0 +1,63 @@
+/*
+ * UI Latency Probe - Implementation
+ */
+
+#include "ui_latency_probe.h"
+
+#include <string.h>
+
+void ui_latency_probe_reset(ui_latency_probe_t *probe)
+{
+    if (!probe) {
+        return;
+    }
+
+    memset(probe, 0, sizeof(*probe));
+}
+
+bool ui_latency_probe_invalidated(ui_latency_probe_t *probe, int64_t rx_us, int64_t now_us,
+                                  const ui_latency_area_t *area)
+{
+    if (!probe || !area || rx_us <= 0 || rx_us <= probe->last_rx_us) {
+        return false;
+    }
+
+    if (probe->pending_rx_us != 0) {
+        probe->superseded++;
+    }
+
+    probe->last_rx_us = rx_us;
+    probe->pending_rx_us = rx_us;
+    probe->pending_invalidate_us = now_us;
+    probe->area = *area;
+    can_latency_hist_record(&probe->rx_to_invalidate, now_us - rx_us);
+    return true;
+}
+
+bool ui_latency_probe_flushed(ui_latency_probe_t *probe, const ui_latency_area_t *flushed,
+                              int64_t now_us)
+{
+    if (!probe || !flushed || probe->pending_rx_us == 0) {
+        return false;
+    }
+
+    const ui_latency_area_t *a = &probe->area;
+    bool overlaps = flushed->x1 <= a->x2 && flushed->x2 >= a->x1 &&
+                    flushed->y1 <= a->y2 && flushed->y2 >= a->y1;
+
+    // Partial rendering flushes top to bottom in strips; the label is on
+    // screen once the strip holding its last row is out
+    if (!overlaps || flushed->y2 < a->y2) {
+        return false;
+    }
+
+    can_latency_hist_record(&probe->invalidate_to_flush, now_us - probe->pending_invalidate_us);
+    can_latency_hist_record(&probe->rx_to_flush, now_us - probe->pending_rx_us);
+    probe->pending_rx_us = 0;
+    return true;
+}
+
+bool ui_latency_probe_pending(const ui_latency_probe_t *probe)
+{
+    return probe && probe->pending_rx_us != 0;
+}
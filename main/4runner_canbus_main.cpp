@@ -16,18 +16,32 @@
 #include <esp_err.h>
 #include <esp_heap_caps.h>
 #include <esp_log.h>
+#include <esp_system.h>
 #include <esp_timer.h>
+#include "alert.h"
 #include "display_manager.h"
 #include "display_manager/page.h"
 #include "lvgl.h"
 #include "sd_card.h"
 #include "can_logger.h"
+#include "can_logger_signals.h"
+#include "can_replay.h"
+#include "can_supervisor.h"
+#include "can_stream.h"
+#include "dlog.h"
+#include "mem_plan.h"
+#include "obd_discovery.h"
 #include "rtc_pcf85063a.h"
+#include "timebase.h"
+#include "trace.h"
+#include "ui_latency.h"
 
 #include "app_state.h"
 #include "page_utils.h"
 #include "settings_store.h"
+#include "signal_log.h"
 #include "can_signal.h"
+#include "alert_overlay.h"
 #include "diag_page.h"
 #include "fourrunner_page.h"
 #include "wheel_speed_page.h"
@@ -91,6 +105,15 @@ static void log_lvgl_mem(const char *context)
 #define OBD_POLL_INTERVAL_MS 150
 #define CAN_TELEMETRY_INTERVAL_MS 2000
 
+// Names for the RX-to-pixel probes, indexed by ui_signal_t
+static const char *const k_ui_signal_names[UI_SIG_COUNT] = {
+    "rpm",
+    "bcast_rpm",
+    "speed",
+    "bcast_speed",
+    "fuel",
+};
+
 // LCD Configuration
 static const int lcd_h_res = 800;
 static const int lcd_v_res = 480;
@@ -139,14 +162,7 @@ static const int lcd_touch_int_io_num = -1;
 // Signal extraction functions are provided by the can_signal component.
 // See components/can_signal/ for implementation and test/test_can_signal.c for tests.
 
-// OBD Request Definition
-typedef struct {
-    uint16_t header;
-    uint8_t service;
-    uint8_t pid;
-    uint8_t ext_addr;
-} obd_request_t;
-
+// OBD poll candidates; obd_discovery drops the ones this car does not answer
 static const obd_request_t k_request_sequence[] = {
     {OBD_REQUEST_ID, 0x01, 0x0C, 0},
     {OBD_REQUEST_ID, 0x01, 0x0D, 0},  // Vehicle speed
@@ -163,6 +179,9 @@ static const obd_request_t k_request_sequence[] = {
     {ABS_REQUEST_ID, 0x21, 0x47, 0},  // Orientation live data
 };
 
+#define OBD_REQUEST_COUNT (sizeof(k_request_sequence) / sizeof(k_request_sequence[0]))
+static_assert(OBD_REQUEST_COUNT <= OBD_DISCOVERY_MAX_CANDIDATES, "Too many OBD requests");
+
 // TWAI Configuration
 static const twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
 static const twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
@@ -175,7 +194,7 @@ static const twai_general_config_t g_config = {
     .bus_off_io = TWAI_IO_UNUSED,
     .tx_queue_len = 20,
     .rx_queue_len = 100,
-    .alerts_enabled = TWAI_ALERT_NONE,
+    .alerts_enabled = CAN_SUPERVISOR_ALERTS,
     .clkout_divider = 0,
     .intr_flags = 0,
     .general_flags = {
@@ -234,14 +253,135 @@ static uint32_t delta_u32(uint32_t current, uint32_t last)
     return current >= last ? (current - last) : 0;
 }
 
+static uint32_t delta_u64(uint64_t current, uint64_t last)
+{
+    return current >= last ? (uint32_t)(current - last) : 0;
+}
+
+#if CONFIG_APP_LOG_POLICIES
+// High-rate broadcasts that mostly repeat; everything else is logged in full.
+// Keyframes keep every ID visible at least once a second in each file.
+static const struct {
+    uint32_t id;
+    can_log_policy_t policy;
+} k_log_policies[] = {
+    {WHEEL_SPEED_BROADCAST_ID,    {CAN_LOG_POLICY_RATE_LIMIT, 0, 20000, 1000000}},
+    {KINEMATICS_BROADCAST_ID_024, {CAN_LOG_POLICY_RATE_LIMIT, 0, 20000, 1000000}},
+    {GEAR_BROADCAST_ID_025,       {CAN_LOG_POLICY_RATE_LIMIT, 0, 20000, 1000000}},
+    {VEHICLE_SPEED_BROADCAST_ID,  {CAN_LOG_POLICY_ON_CHANGE, 0, 0, 1000000}},
+    {RPM_BROADCAST_ID_1C4,        {CAN_LOG_POLICY_ON_CHANGE, 0, 0, 1000000}},
+};
+
+static void apply_log_policies(void)
+{
+    for (size_t i = 0; i < sizeof(k_log_policies) / sizeof(k_log_policies[0]); i++) {
+        esp_err_t err = can_logger_set_id_policy(k_log_policies[i].id, &k_log_policies[i].policy);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Log policy for 0x%03lx failed: %s",
+                     (unsigned long)k_log_policies[i].id, esp_err_to_name(err));
+        }
+    }
+}
+#endif
+
+// Hold-up budget for the flush plus time for the writer to close the file
+#define LOGGER_SHUTDOWN_WAIT_MS (CONFIG_CAN_LOGGER_POWERFAIL_HOLDUP_MS + 100)
+
+// esp_restart() runs shutdown handlers in the restarting task, so a software
+// restart gets the same trailer-terminated file as a supply loss
+static void logger_shutdown_handler(void)
+{
+    if (!can_logger_is_running()) {
+        return;
+    }
+    can_logger_power_fail();
+    // The state turns STOPPED before the file is closed; wait for the close
+    if (can_logger_wait_closed(LOGGER_SHUTDOWN_WAIT_MS) != ESP_OK) {
+        ESP_LOGW(TAG, "Log file not closed before restart");
+    }
+}
+
+// Bench replay of a log from the SD card (menuconfig "CAN Log Replay")
+static void start_boot_replay(void)
+{
+    if (CONFIG_CAN_REPLAY_BOOT_FILE[0] == '\0') {
+        return;
+    }
+
+    can_replay_options_t opts = {};
+    opts.speed_permille = CONFIG_CAN_REPLAY_SPEED_PERCENT * 10;
+    opts.loop_gap_us = 1000000;
+#if CONFIG_CAN_REPLAY_LOOP
+    opts.loop = true;
+#endif
+#if CONFIG_CAN_REPLAY_SELF_RX
+    opts.self_rx = true;
+#endif
+    if (!can_replay_core_parse_filter(CONFIG_CAN_REPLAY_FILTER_IDS, &opts)) {
+        ESP_LOGW(TAG, "Bad replay ID filter \"%s\", replaying all IDs",
+                 CONFIG_CAN_REPLAY_FILTER_IDS);
+        opts.filter_count = 0;
+    }
+
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s", sd_card_get_mount_point(), CONFIG_CAN_REPLAY_BOOT_FILE);
+    esp_err_t err = can_replay_start(path, &opts);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Boot replay not started: %s", esp_err_to_name(err));
+    }
+}
+
+// Alert rules, evaluated in the RX task as each value is decoded. Listed
+// in enum order; indices are the `source` of CAN_BIN_META_EVENT log records.
+enum {
+    ALERT_RULE_OVER_REV,        // OBD PID 0x0C
+    ALERT_RULE_OVER_REV_BCAST,  // Broadcast 0x1C4, the fast path for the shift light
+    ALERT_RULE_ATF_HOT,
+    ALERT_RULE_LOW_BATT,
+    ALERT_RULE_LAT_G,
+    ALERT_RULE_COUNT
+};
+
+static const alert_rule_t k_alert_rules[ALERT_RULE_COUNT] = {
+    {"SHIFT", ALERT_ABOVE, 5500.0f, 200.0f, 0, 3,
+     ALERT_OUT_GPIO | ALERT_OUT_OVERLAY | ALERT_OUT_LOG},
+    {"SHIFT", ALERT_ABOVE, 5500.0f, 200.0f, 0, 3,
+     ALERT_OUT_GPIO | ALERT_OUT_OVERLAY | ALERT_OUT_LOG},
+    {"ATF HOT", ALERT_ABOVE, 120.0f, 5.0f, 2000000, 2,
+     ALERT_OUT_OVERLAY | ALERT_OUT_LOG},
+    {"LOW BATT", ALERT_BELOW, 11.8f, 0.3f, 5000000, 1,
+     ALERT_OUT_OVERLAY | ALERT_OUT_LOG},
+    {"LAT G", ALERT_ABS_ABOVE, 0.6f, 0.05f, 200000, 1,
+     ALERT_OUT_OVERLAY | ALERT_OUT_LOG},
+};
+
+static void on_alert_change(uint32_t active_mask, void *ctx)
+{
+    (void)active_mask;
+    (void)ctx;
+    display_manager_notify_changed(app_state_get_display(), METRIC_ALERT);
+}
+
+static void on_can_state_change(can_supervisor_state_t prev, can_supervisor_state_t state,
+                                void *ctx)
+{
+    (void)ctx;
+    bool was_offline = prev == CAN_SUPERVISOR_BUS_OFF || prev == CAN_SUPERVISOR_RECOVERING;
+    bool offline = state == CAN_SUPERVISOR_BUS_OFF || state == CAN_SUPERVISOR_RECOVERING;
+    if (was_offline != offline) {
+        schedule_can_ui_update();
+    }
+}
+
 // CAN Response Handlers
-static void handle_standard_response(const twai_message_t *msg)
+static void handle_standard_response(const twai_message_t *msg, int64_t rx_us)
 {
     uint8_t length = msg->data[0];
     uint8_t pid = msg->data[2];
 
     metrics_lock();
     can_metrics_t *m = metrics_get_for_update();
+    uint32_t changed = 0;
 
     switch (pid) {
         case 0x0C: {
@@ -249,6 +389,10 @@ static void handle_standard_response(const twai_message_t *msg)
                 uint16_t raw = (uint16_t)(msg->data[3] << 8) | msg->data[4];
                 m->rpm = raw / 4.0f;
                 m->rpm_valid = true;
+                m->src_rx_us[METRIC_SRC_RPM] = rx_us;
+                m->rx_us[UI_SIG_RPM] = rx_us;
+                changed = METRIC_RPM;
+                alert_eval(ALERT_RULE_OVER_REV, m->rpm, rx_us);
             }
             break;
         }
@@ -257,6 +401,9 @@ static void handle_standard_response(const twai_message_t *msg)
             if (length >= 3) {
                 m->diag_vehicle_speed_kph = (float)msg->data[3];
                 m->diag_vehicle_speed_valid = true;
+                m->src_rx_us[METRIC_SRC_DIAG_VEHICLE_SPEED] = rx_us;
+                m->rx_us[UI_SIG_VEHICLE_SPEED] = rx_us;
+                changed = METRIC_SPEED;
             }
             break;
         }
@@ -265,6 +412,8 @@ static void handle_standard_response(const twai_message_t *msg)
             if (length >= 3) {
                 m->throttle_pct = (msg->data[3] * 100.0f) / 255.0f;
                 m->throttle_valid = true;
+                m->src_rx_us[METRIC_SRC_THROTTLE] = rx_us;
+                changed = METRIC_ENGINE;
             }
             break;
         }
@@ -273,6 +422,9 @@ static void handle_standard_response(const twai_message_t *msg)
                 uint16_t raw = (uint16_t)(msg->data[3] << 8) | msg->data[4];
                 m->vbatt_v = raw / 1000.0f;
                 m->vbatt_valid = true;
+                m->src_rx_us[METRIC_SRC_VBATT] = rx_us;
+                changed = METRIC_ENGINE;
+                alert_eval(ALERT_RULE_LOW_BATT, m->vbatt_v, rx_us);
             }
             break;
         }
@@ -280,6 +432,8 @@ static void handle_standard_response(const twai_message_t *msg)
             if (length >= 3) {
                 m->iat_c = (float)msg->data[3] - 40.0f;
                 m->iat_valid = true;
+                m->src_rx_us[METRIC_SRC_IAT] = rx_us;
+                changed = METRIC_ENGINE;
             }
             break;
         }
@@ -287,6 +441,8 @@ static void handle_standard_response(const twai_message_t *msg)
             if (length >= 3) {
                 m->baro_kpa = (float)msg->data[3];
                 m->baro_valid = true;
+                m->src_rx_us[METRIC_SRC_BARO] = rx_us;
+                changed = METRIC_ENGINE;
             }
             break;
         }
@@ -294,10 +450,10 @@ static void handle_standard_response(const twai_message_t *msg)
             break;
     }
 
-    metrics_unlock();
+    metrics_unlock_changed(changed);
 }
 
-static void handle_broadcast_wheel_speed(const twai_message_t *msg)
+static void handle_broadcast_wheel_speed(const twai_message_t *msg, int64_t rx_us)
 {
     if (msg->data_length_code < 8) {
         return;
@@ -317,11 +473,12 @@ static void handle_broadcast_wheel_speed(const twai_message_t *msg)
     m->bcast_wheel_rr_kph = ((int16_t)raw_rr - k_wheel_speed_offset) / 100.0f;
     m->bcast_wheel_rl_kph = ((int16_t)raw_rl - k_wheel_speed_offset) / 100.0f;
     m->bcast_wheel_speed_valid = true;
+    m->src_rx_us[METRIC_SRC_BCAST_WHEEL_SPEED] = rx_us;
 
-    metrics_unlock();
+    metrics_unlock_changed(METRIC_SPEED);
 }
 
-static void handle_broadcast_vehicle_speed(const twai_message_t *msg)
+static void handle_broadcast_vehicle_speed(const twai_message_t *msg, int64_t rx_us)
 {
     if (msg->data_length_code < 8) {
         return;
@@ -334,13 +491,15 @@ static void handle_broadcast_vehicle_speed(const twai_message_t *msg)
     uint16_t raw_speed = ((uint16_t)msg->data[5] << 8) | msg->data[6];
     m->bcast_vehicle_speed_kph = raw_speed / 100.0f;
     m->bcast_vehicle_speed_valid = true;
+    m->src_rx_us[METRIC_SRC_BCAST_VEHICLE_SPEED] = rx_us;
+    m->rx_us[UI_SIG_BCAST_VEHICLE_SPEED] = rx_us;
     memcpy(m->cand_0b4_raw, msg->data, sizeof(m->cand_0b4_raw));
     m->cand_0b4_valid = true;
 
-    metrics_unlock();
+    metrics_unlock_changed(METRIC_SPEED | METRIC_RAW);
 }
 
-static void handle_broadcast_rpm_1c4(const twai_message_t *msg)
+static void handle_broadcast_rpm_1c4(const twai_message_t *msg, int64_t rx_us)
 {
     if (msg->data_length_code < 2) {
         return;
@@ -354,8 +513,11 @@ static void handle_broadcast_rpm_1c4(const twai_message_t *msg)
     static const float k_rpm_scale = 25.0f / 32.0f;
     m->bcast_rpm_1c4 = raw_rpm * k_rpm_scale;
     m->bcast_rpm_1c4_valid = true;
+    m->src_rx_us[METRIC_SRC_BCAST_RPM_1C4] = rx_us;
+    m->rx_us[UI_SIG_BCAST_RPM] = rx_us;
+    alert_eval(ALERT_RULE_OVER_REV_BCAST, m->bcast_rpm_1c4, rx_us);
 
-    metrics_unlock();
+    metrics_unlock_changed(METRIC_RPM);
 }
 
 static void handle_broadcast_rpm_test(const twai_message_t *msg)
@@ -378,10 +540,10 @@ static void handle_broadcast_rpm_test(const twai_message_t *msg)
     memcpy(m->cand_2c1_raw, msg->data, sizeof(m->cand_2c1_raw));
     m->cand_2c1_valid = true;
 
-    metrics_unlock();
+    metrics_unlock_changed(METRIC_RPM | METRIC_RAW);
 }
 
-static void handle_broadcast_kinematics_024(const twai_message_t *msg)
+static void handle_broadcast_kinematics_024(const twai_message_t *msg, int64_t rx_us)
 {
     if (msg->data_length_code < 8) {
         return;
@@ -407,8 +569,10 @@ static void handle_broadcast_kinematics_024(const twai_message_t *msg)
     // Lateral G conversion: empirically derived scale and offset from OBD correlation
     m->bcast_lateral_g = (accel_y * -0.002121f) - 0.0126f;
     m->bcast_kinematics_valid = true;
+    m->src_rx_us[METRIC_SRC_BCAST_KINEMATICS] = rx_us;
+    alert_eval(ALERT_RULE_LAT_G, m->bcast_lateral_g, rx_us);
 
-    metrics_unlock();
+    metrics_unlock_changed(METRIC_ORIENTATION);
 }
 
 static void handle_broadcast_candidate_1d0(const twai_message_t *msg)
@@ -421,10 +585,10 @@ static void handle_broadcast_candidate_1d0(const twai_message_t *msg)
     can_metrics_t *m = metrics_get_for_update();
     memcpy(m->cand_1d0_raw, msg->data, sizeof(m->cand_1d0_raw));
     m->cand_1d0_valid = true;
-    metrics_unlock();
+    metrics_unlock_changed(METRIC_RAW);
 }
 
-static void handle_broadcast_candidate_025(const twai_message_t *msg)
+static void handle_broadcast_candidate_025(const twai_message_t *msg, int64_t rx_us)
 {
     if (msg->data_length_code < 8) {
         return;
@@ -437,18 +601,20 @@ static void handle_broadcast_candidate_025(const twai_message_t *msg)
     int32_t signed_angle = can_signal_sign_extend(raw_angle, STEER_ANGLE_LENGTH);
     m->bcast_steering_angle_deg = signed_angle * STEER_ANGLE_SCALE;
     m->bcast_steer_angle_valid = true;
+    m->src_rx_us[METRIC_SRC_BCAST_STEER_ANGLE] = rx_us;
     memcpy(m->cand_025_raw, msg->data, sizeof(m->cand_025_raw));
     m->cand_025_valid = true;
-    metrics_unlock();
+    metrics_unlock_changed(METRIC_ORIENTATION | METRIC_RAW);
 }
 
-static void handle_extended_response(const twai_message_t *msg)
+static void handle_extended_response(const twai_message_t *msg, int64_t rx_us)
 {
     uint8_t length = msg->data[0];
     uint8_t pid = msg->data[2];
 
     metrics_lock();
     can_metrics_t *m = metrics_get_for_update();
+    uint32_t changed = 0;
 
     switch (pid) {
         case 0x82: {
@@ -459,6 +625,9 @@ static void handle_extended_response(const twai_message_t *msg)
                 uint16_t raw_tqc = (uint16_t)(msg->data[5] << 8) | msg->data[6];
                 m->atf_tqc_c = (raw_tqc / 256.0f) - 40.0f;
                 m->atf_valid = true;
+                m->src_rx_us[METRIC_SRC_ATF] = rx_us;
+                changed = METRIC_DRIVETRAIN;
+                alert_eval(ALERT_RULE_ATF_HOT, m->atf_pan_c, rx_us);
             }
             break;
         }
@@ -467,6 +636,8 @@ static void handle_extended_response(const twai_message_t *msg)
                 m->gear = msg->data[3];
                 m->tqc_lockup = (msg->data[4] & 0x80) != 0;
                 m->gear_valid = true;
+                m->src_rx_us[METRIC_SRC_GEAR] = rx_us;
+                changed = METRIC_DRIVETRAIN;
             }
             break;
         }
@@ -476,6 +647,8 @@ static void handle_extended_response(const twai_message_t *msg)
                     | ((uint32_t)msg->data[4] << 8)
                     | (uint32_t)msg->data[5];
                 m->odo_valid = true;
+                m->src_rx_us[METRIC_SRC_ODO] = rx_us;
+                changed = METRIC_DRIVETRAIN;
             }
             break;
         }
@@ -484,7 +657,11 @@ static void handle_extended_response(const twai_message_t *msg)
                 uint8_t raw_fuel = msg->data[3];
                 m->fli_vol_gal = (raw_fuel * 500.0f) / 3785.0f;
                 m->fuel_valid = true;
-                ESP_LOGI(TAG, "Fuel level: raw=0x%02X (%.2f gal)", raw_fuel, m->fli_vol_gal);
+                m->src_rx_us[METRIC_SRC_FUEL] = rx_us;
+                m->rx_us[UI_SIG_FUEL] = rx_us;
+                changed = METRIC_DRIVETRAIN;
+                TRACE_INSTANT(TRACE_EV_FUEL_LEVEL, raw_fuel, (uint32_t)(m->fli_vol_gal * 100.0f));
+                DLOGI(TAG, "Fuel level: raw=0x%02X (%.2f gal)", raw_fuel, m->fli_vol_gal);
             }
             break;
         }
@@ -495,6 +672,7 @@ static void handle_extended_response(const twai_message_t *msg)
                 m->diag_wheel_rr_kph = (msg->data[5] * 256.0f) / 200.0f;
                 m->diag_wheel_rl_kph = (msg->data[6] * 256.0f) / 200.0f;
                 m->diag_wheel_speed_valid = true;
+                changed = METRIC_SPEED;
             }
             break;
         }
@@ -507,6 +685,7 @@ static void handle_extended_response(const twai_message_t *msg)
                 // Zero point of yaw rate: value - 128 (degrees/sec)
                 m->zp_yaw_rate = (float)msg->data[5] - 128.0f;
                 m->orientation_zp_valid = true;
+                changed = METRIC_ORIENTATION;
             }
             break;
         }
@@ -523,6 +702,8 @@ static void handle_extended_response(const twai_message_t *msg)
                 uint16_t raw_steer = ((uint16_t)msg->data[6] << 8) | msg->data[7];
                 m->steering_angle_deg = (raw_steer / 10.0f) - 3276.8f;
                 m->orientation_valid = true;
+                m->src_rx_us[METRIC_SRC_ORIENTATION] = rx_us;
+                changed = METRIC_ORIENTATION;
             }
             break;
         }
@@ -530,27 +711,27 @@ static void handle_extended_response(const twai_message_t *msg)
             break;
     }
 
-    metrics_unlock();
+    metrics_unlock_changed(changed);
 }
 
-static void process_obd_response(const twai_message_t *msg)
+static void process_obd_response(const twai_message_t *msg, int64_t rx_us)
 {
     if (!msg) {
         return;
     }
 
     if (msg->identifier == WHEEL_SPEED_BROADCAST_ID) {
-        handle_broadcast_wheel_speed(msg);
+        handle_broadcast_wheel_speed(msg, rx_us);
         return;
     }
 
     if (msg->identifier == VEHICLE_SPEED_BROADCAST_ID) {
-        handle_broadcast_vehicle_speed(msg);
+        handle_broadcast_vehicle_speed(msg, rx_us);
         return;
     }
 
     if (msg->identifier == RPM_BROADCAST_ID_1C4) {
-        handle_broadcast_rpm_1c4(msg);
+        handle_broadcast_rpm_1c4(msg, rx_us);
         return;
     }
 
@@ -560,7 +741,7 @@ static void process_obd_response(const twai_message_t *msg)
     }
 
     if (msg->identifier == KINEMATICS_BROADCAST_ID_024) {
-        handle_broadcast_kinematics_024(msg);
+        handle_broadcast_kinematics_024(msg, rx_us);
         return;
     }
 
@@ -570,7 +751,7 @@ static void process_obd_response(const twai_message_t *msg)
     }
 
     if (msg->identifier == GEAR_BROADCAST_ID_025) {
-        handle_broadcast_candidate_025(msg);
+        handle_broadcast_candidate_025(msg, rx_us);
         return;
     }
 
@@ -589,16 +770,17 @@ static void process_obd_response(const twai_message_t *msg)
 
     uint8_t service = msg->data[1];
 
+    TRACE_INSTANT(TRACE_EV_OBD_RESPONSE, msg->identifier, TRACE_DATA4(msg->data));
     if (msg->identifier == 0x7C8) {
-        ESP_LOGI(TAG, "Meter RX: %02X %02X %02X %02X %02X %02X %02X %02X",
-                 msg->data[0], msg->data[1], msg->data[2], msg->data[3],
-                 msg->data[4], msg->data[5], msg->data[6], msg->data[7]);
+        DLOGI(TAG, "Meter RX: %02X %02X %02X %02X %02X %02X %02X %02X",
+              msg->data[0], msg->data[1], msg->data[2], msg->data[3],
+              msg->data[4], msg->data[5], msg->data[6], msg->data[7]);
     }
 
     if (service == 0x41) {
-        handle_standard_response(msg);
+        handle_standard_response(msg, rx_us);
     } else if (service == 0x61) {
-        handle_extended_response(msg);
+        handle_extended_response(msg, rx_us);
     }
 }
 
@@ -618,18 +800,35 @@ static void can_rx_task(void *arg)
 
         esp_err_t err = twai_receive(&rx_msg, pdMS_TO_TICKS(100));
         if (err == ESP_OK) {
-            if (can_logger_is_running()) {
+            int64_t rx_time_us = esp_timer_get_time();
+            TRACE_CAN_RX(rx_msg.identifier, rx_msg.data_length_code);
+            can_stream_push(rx_time_us,
+                            rx_msg.identifier |
+                                (rx_msg.extd ? CAN_STREAM_ID_EXTENDED : 0) |
+                                (rx_msg.rtr ? CAN_STREAM_ID_RTR : 0),
+                            rx_msg.data_length_code, rx_msg.data);
+            bool logging = can_logger_is_running();
+            if (logging) {
                 can_logger_message_t log_msg = {
                     .identifier = rx_msg.identifier,
                     .data_length_code = rx_msg.data_length_code,
                     .data = {0}
                 };
                 memcpy(log_msg.data, rx_msg.data, 8);
-                can_logger_log_message(esp_timer_get_time(), &log_msg);
+                can_logger_log_message(rx_time_us, &log_msg);
             }
 
-            process_obd_response(&rx_msg);
+            obd_discovery_rx(rx_msg.identifier, rx_msg.data, rx_time_us);
+
+            TRACE_DECODE_BEGIN(rx_msg.identifier);
+            process_obd_response(&rx_msg, rx_time_us);
+            TRACE_DECODE_END(rx_msg.identifier);
             update_can_error_state(true, false);
+
+            // Decoded values go to the signal sink once the frame is processed
+            if (logging) {
+                signal_log_sample(rx_time_us);
+            }
         }
     }
 }
@@ -642,30 +841,46 @@ static void can_tx_task(void *arg)
     ESP_LOGI(TAG, "CAN TX task started");
 
     while (1) {
-        if (can_state_is_paused()) {
+        // A replay owns the bus; its frames would interleave with our requests.
+        // The supervisor holds requests while the controller is offline and
+        // stretches the interval while the error counters are high.
+        uint32_t poll_scale = can_supervisor_poll_scale();
+        if (can_state_is_paused() || can_replay_is_running() || poll_scale == 0) {
             vTaskDelay(pdMS_TO_TICKS(100));
             continue;
         }
 
+        // Discovery shares the cycle: at most one frame of its own per request
+        obd_discovery_step();
+        uint32_t poll_mask = obd_discovery_poll_mask();
+        if (poll_mask == 0) {
+            vTaskDelay(pdMS_TO_TICKS(OBD_POLL_INTERVAL_MS * poll_scale));
+            continue;
+        }
+        for (size_t i = 0; i < OBD_REQUEST_COUNT && !(poll_mask & (1u << request_index)); i++) {
+            request_index = (request_index + 1) % OBD_REQUEST_COUNT;
+        }
+
         const obd_request_t *req = &k_request_sequence[request_index];
         twai_message_t msg = build_obd_request(req->header, req->service, req->pid, req->ext_addr);
 
+        TRACE_INSTANT(TRACE_EV_OBD_REQUEST, msg.identifier, TRACE_DATA4(msg.data));
         if (req->header == METER_REQUEST_ID) {
-            ESP_LOGI(TAG, "TX to 0x%03X: %02X %02X %02X %02X %02X %02X %02X %02X",
-                     msg.identifier,
-                     msg.data[0], msg.data[1], msg.data[2], msg.data[3],
-                     msg.data[4], msg.data[5], msg.data[6], msg.data[7]);
+            DLOGI(TAG, "TX to 0x%03X: %02X %02X %02X %02X %02X %02X %02X %02X",
+                  msg.identifier,
+                  msg.data[0], msg.data[1], msg.data[2], msg.data[3],
+                  msg.data[4], msg.data[5], msg.data[6], msg.data[7]);
         }
 
         esp_err_t err = twai_transmit(&msg, pdMS_TO_TICKS(50));
         if (err != ESP_OK) {
-            ESP_LOGW(TAG, "OBD request 0x%03X 0x%02X 0x%02X (ext:0x%02X) failed: %s",
-                     req->header, req->service, req->pid, req->ext_addr, esp_err_to_name(err));
+            DLOGW(TAG, "OBD request 0x%03X 0x%02X 0x%02X (ext:0x%02X) failed: %s",
+                  req->header, req->service, req->pid, req->ext_addr, esp_err_to_name(err));
             update_can_error_state(false, true);
         }
 
-        request_index = (request_index + 1) % (sizeof(k_request_sequence) / sizeof(k_request_sequence[0]));
-        vTaskDelay(pdMS_TO_TICKS(OBD_POLL_INTERVAL_MS));
+        request_index = (request_index + 1) % OBD_REQUEST_COUNT;
+        vTaskDelay(pdMS_TO_TICKS(OBD_POLL_INTERVAL_MS * poll_scale));
     }
 }
 
@@ -679,13 +894,21 @@ static void can_telemetry_task(void *arg)
     uint32_t last_tx_failed = 0;
     uint32_t last_arb_lost = 0;
     uint32_t last_bus_error = 0;
-    uint32_t last_logged = 0;
-    uint32_t last_dropped = 0;
-    uint32_t last_buf_overrun = 0;
+    uint64_t last_logged = 0;
+    uint64_t last_dropped = 0;
+    uint64_t last_buf_overrun = 0;
+    uint32_t last_stream_offered = 0;
+    uint32_t last_stream_dropped = 0;
+    uint32_t last_replay_sent = 0;
+    uint32_t last_bus_off = 0;
+    uint32_t last_rxq_full = 0;
 
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(CAN_TELEMETRY_INTERVAL_MS));
 
+        // Trace clock references and requested dumps, also while CAN is paused
+        trace_service();
+
         int64_t now_ms = esp_timer_get_time() / 1000;
         float interval_s = (now_ms - last_ms) / 1000.0f;
         if (interval_s <= 0.0f) {
@@ -700,7 +923,7 @@ static void can_telemetry_task(void *arg)
         twai_status_info_t status = {};
         esp_err_t err = twai_get_status_info(&status);
         if (err != ESP_OK) {
-            ESP_LOGW(TAG, "Telemetry: failed to read TWAI status: %s", esp_err_to_name(err));
+            DLOGW(TAG, "Telemetry: failed to read TWAI status: %s", esp_err_to_name(err));
             continue;
         }
 
@@ -716,68 +939,171 @@ static void can_telemetry_task(void *arg)
         last_arb_lost = status.arb_lost_count;
         last_bus_error = status.bus_error_count;
 
+        DLOGI(TAG,
+              "CAN telem %.1fs state=%s rx_q=%u tx_q=%u "
+              "rx_miss=%u(+%u) rx_ovr=%u(+%u) tx_fail=%u(+%u) "
+              "arb_lost=%u(+%u) bus_err=%u(+%u)",
+              interval_s,
+              twai_state_to_str(status.state),
+              status.msgs_to_rx,
+              status.msgs_to_tx,
+              status.rx_missed_count,
+              rx_missed_delta,
+              status.rx_overrun_count,
+              rx_overrun_delta,
+              status.tx_failed_count,
+              tx_failed_delta,
+              status.arb_lost_count,
+              arb_lost_delta,
+              status.bus_error_count,
+              bus_error_delta);
+
         if (can_logger_is_running()) {
             can_logger_stats_t log_stats = {};
             if (can_logger_get_stats(&log_stats) == ESP_OK) {
-                uint32_t logged_delta = delta_u32(log_stats.messages_logged, last_logged);
-                uint32_t dropped_delta = delta_u32(log_stats.messages_dropped, last_dropped);
-                uint32_t buf_overrun_delta = delta_u32(log_stats.buffer_overruns, last_buf_overrun);
+                uint32_t logged_delta = delta_u64(log_stats.messages_logged, last_logged);
+                uint32_t dropped_delta = delta_u64(log_stats.messages_dropped, last_dropped);
+                uint32_t buf_overrun_delta = delta_u64(log_stats.buffer_overruns, last_buf_overrun);
                 uint32_t total_delta = logged_delta + dropped_delta;
                 float drop_pct = total_delta > 0 ? (dropped_delta * 100.0f) / total_delta : 0.0f;
                 float log_rate = logged_delta / interval_s;
 
-                ESP_LOGI(TAG,
-                         "CAN telem %.1fs state=%s rx_q=%u tx_q=%u "
-                         "rx_miss=%u(+%u) rx_ovr=%u(+%u) tx_fail=%u(+%u) "
-                         "arb_lost=%u(+%u) bus_err=%u(+%u) "
-                         "log=%u(+%u,%.1f/s) drop=%u(+%u,%.1f%%) buf_ovr=%u(+%u) wr_err=%u",
-                         interval_s,
-                         twai_state_to_str(status.state),
-                         status.msgs_to_rx,
-                         status.msgs_to_tx,
-                         status.rx_missed_count,
-                         rx_missed_delta,
-                         status.rx_overrun_count,
-                         rx_overrun_delta,
-                         status.tx_failed_count,
-                         tx_failed_delta,
-                         status.arb_lost_count,
-                         arb_lost_delta,
-                         status.bus_error_count,
-                         bus_error_delta,
-                         log_stats.messages_logged,
-                         logged_delta,
-                         log_rate,
-                         log_stats.messages_dropped,
-                         dropped_delta,
-                         drop_pct,
-                         log_stats.buffer_overruns,
-                         buf_overrun_delta,
-                         log_stats.write_errors);
+                DLOGI(TAG,
+                      "Log log=%llu(+%u,%.1f/s) drop=%llu(+%u,%.1f%%) supp=%u "
+                      "buf_ovr=%llu(+%u) wr_err=%llu",
+                      log_stats.messages_logged,
+                      logged_delta,
+                      log_rate,
+                      log_stats.messages_dropped,
+                      dropped_delta,
+                      drop_pct,
+                      log_stats.messages_suppressed,
+                      log_stats.buffer_overruns,
+                      buf_overrun_delta,
+                      log_stats.write_errors);
+
+                DLOGI(TAG,
+                      "Log ring %u/%u hwm=%u write p50/p99/max=%u/%u/%uus "
+                      "sync p50/p99/max=%u/%u/%uus",
+                      log_stats.ring_depth,
+                      log_stats.ring_capacity,
+                      log_stats.ring_high_water,
+                      can_latency_hist_percentile(&log_stats.write_latency, 50),
+                      can_latency_hist_percentile(&log_stats.write_latency, 99),
+                      log_stats.write_latency.max_us,
+                      can_latency_hist_percentile(&log_stats.sync_latency, 50),
+                      can_latency_hist_percentile(&log_stats.sync_latency, 99),
+                      log_stats.sync_latency.max_us);
 
                 last_logged = log_stats.messages_logged;
                 last_dropped = log_stats.messages_dropped;
                 last_buf_overrun = log_stats.buffer_overruns;
             }
-        } else {
-            ESP_LOGI(TAG,
-                     "CAN telem %.1fs state=%s rx_q=%u tx_q=%u "
-                     "rx_miss=%u(+%u) rx_ovr=%u(+%u) tx_fail=%u(+%u) "
-                     "arb_lost=%u(+%u) bus_err=%u(+%u)",
-                     interval_s,
-                     twai_state_to_str(status.state),
-                     status.msgs_to_rx,
-                     status.msgs_to_tx,
-                     status.rx_missed_count,
-                     rx_missed_delta,
-                     status.rx_overrun_count,
-                     rx_overrun_delta,
-                     status.tx_failed_count,
-                     tx_failed_delta,
-                     status.arb_lost_count,
-                     arb_lost_delta,
-                     status.bus_error_count,
-                     bus_error_delta);
+
+            can_logger_signal_stats_t sig_stats = {};
+            if (can_logger_signals_get_stats(&sig_stats) == ESP_OK && sig_stats.active) {
+                DLOGI(TAG,
+                      "Signal log samples=%u suppressed=%u drop=%u chunks=%u bytes=%u wr_err=%u",
+                      sig_stats.samples_logged,
+                      sig_stats.samples_suppressed,
+                      sig_stats.samples_dropped,
+                      sig_stats.chunks_written,
+                      sig_stats.bytes_written,
+                      sig_stats.write_errors);
+            }
+        }
+
+        can_supervisor_stats_t sup_stats;
+        can_supervisor_get_stats(&sup_stats);
+        DLOGI(TAG,
+              "CAN sup state=%s tec=%u rec=%u max_tec/rec=%u/%u trans=%u bus_off=%u(+%u) "
+              "recov=%u offline last/max=%u/%uus rxq_full=%u(+%u) poll_x%u",
+              can_supervisor_state_name(can_supervisor_get_state()),
+              status.tx_error_counter,
+              status.rx_error_counter,
+              sup_stats.max_tec,
+              sup_stats.max_rec,
+              sup_stats.transitions,
+              sup_stats.bus_off_count,
+              delta_u32(sup_stats.bus_off_count, last_bus_off),
+              sup_stats.recoveries,
+              sup_stats.last_offline_us,
+              sup_stats.max_offline_us,
+              sup_stats.rx_queue_full,
+              delta_u32(sup_stats.rx_queue_full, last_rxq_full),
+              can_supervisor_poll_scale());
+        last_bus_off = sup_stats.bus_off_count;
+        last_rxq_full = sup_stats.rx_queue_full;
+
+        if (can_stream_is_enabled()) {
+            can_stream_stats_t stream_stats;
+            can_stream_get_stats(&stream_stats);
+            DLOGI(TAG, "Stream frames=%u(+%u) drop=%u(+%u) link_err=%u bytes=%u ring_hwm=%u",
+                  stream_stats.frames_offered,
+                  delta_u32(stream_stats.frames_offered, last_stream_offered),
+                  stream_stats.frames_dropped,
+                  delta_u32(stream_stats.frames_dropped, last_stream_dropped),
+                  stream_stats.link_errors,
+                  stream_stats.bytes_sent,
+                  stream_stats.ring_high_water);
+            last_stream_offered = stream_stats.frames_offered;
+            last_stream_dropped = stream_stats.frames_dropped;
+        }
+
+        if (can_replay_is_running()) {
+            can_replay_stats_t replay_stats;
+            can_replay_get_stats(&replay_stats);
+            DLOGI(TAG,
+                  "Replay sent=%u(+%u) filt=%u tx_err=%u underrun=%u pass=%u "
+                  "late p50/p99/max=%u/%u/%uus early_max=%dus",
+                  replay_stats.frames_sent,
+                  delta_u32(replay_stats.frames_sent, last_replay_sent),
+                  replay_stats.frames_filtered,
+                  replay_stats.tx_errors,
+                  replay_stats.underruns,
+                  replay_stats.passes,
+                  can_latency_hist_percentile(&replay_stats.lateness, 50),
+                  can_latency_hist_percentile(&replay_stats.lateness, 99),
+                  replay_stats.lateness.max_us,
+                  replay_stats.max_early_us);
+            last_replay_sent = replay_stats.frames_sent;
+        }
+
+        for (int i = 0; i < UI_SIG_COUNT; i++) {
+            ui_latency_probe_t probe;
+            if (!ui_latency_get(i, &probe) || probe.rx_to_flush.count == 0) {
+                continue;
+            }
+            DLOGI(TAG,
+                  "UI lat %s n=%u rx>inv p50/p99=%u/%uus inv>flush p50/p99=%u/%uus "
+                  "total p50/p99/max=%u/%u/%uus supp=%u",
+                  ui_latency_signal_name(i),
+                  probe.rx_to_flush.count,
+                  can_latency_hist_percentile(&probe.rx_to_invalidate, 50),
+                  can_latency_hist_percentile(&probe.rx_to_invalidate, 99),
+                  can_latency_hist_percentile(&probe.invalidate_to_flush, 50),
+                  can_latency_hist_percentile(&probe.invalidate_to_flush, 99),
+                  can_latency_hist_percentile(&probe.rx_to_flush, 50),
+                  can_latency_hist_percentile(&probe.rx_to_flush, 99),
+                  probe.rx_to_flush.max_us,
+                  probe.superseded);
+        }
+
+        display_manager_handle_t display = app_state_get_display();
+        for (int i = 0; i < display_manager_get_page_count(display); i++) {
+            dm_page_stats_t page_stats;
+            const char *page_name = NULL;
+            if (!display_manager_get_page_stats(display, i, &page_stats, &page_name) ||
+                page_stats.updates == 0) {
+                continue;
+            }
+            DLOGI(TAG, "Page %s upd=%u ovr=%u def=%u avg/max=%u/%uus",
+                  page_name,
+                  page_stats.updates,
+                  page_stats.overruns,
+                  page_stats.deferred,
+                  (uint32_t)(page_stats.total_update_us / page_stats.updates),
+                  page_stats.max_update_us);
         }
     }
 }
@@ -803,6 +1129,12 @@ extern "C" void app_main(void)
     bool auto_start_can = false;
     settings_get_can_autostart(&auto_start_can);
     ESP_LOGI(TAG, "CAN auto-start on boot: %s", auto_start_can ? "enabled" : "disabled");
+
+    // NVS is up now (settings above); the cached poll list applies from the first request
+    esp_err_t disc_err = obd_discovery_init(k_request_sequence, OBD_REQUEST_COUNT);
+    if (disc_err != ESP_OK) {
+        ESP_LOGW(TAG, "OBD discovery unavailable: %s", esp_err_to_name(disc_err));
+    }
     if (auto_start_can) {
         twai_err = twai_start();
         if (twai_err != ESP_OK) {
@@ -852,6 +1184,43 @@ extern "C" void app_main(void)
     };
     memcpy(display_config.data_io_nums, lcd_data_io_nums, sizeof(lcd_data_io_nums));
 
+    // Reserve every long-lived buffer before the heap fragments. The logger
+    // share is reserved even if the SD card later fails to mount.
+    mem_plan_budget_t mem_budget = {};
+    display_manager_plan_memory(&display_config, &mem_budget);
+    can_logger_plan_memory(CAN_LOGGER_RING_BUFFER_BYTES, &mem_budget);
+    trace_plan_memory(&mem_budget);
+    dlog_plan_memory(&mem_budget);
+    can_stream_plan_memory(&mem_budget);
+    can_replay_plan_memory(&mem_budget);
+    esp_err_t plan_err = mem_plan_init(&mem_budget);
+    if (plan_err != ESP_OK) {
+        ESP_LOGW(TAG, "Memory plan incomplete: %s", esp_err_to_name(plan_err));
+    }
+
+    esp_err_t dlog_err = dlog_init();
+    if (dlog_err != ESP_OK) {
+        ESP_LOGW(TAG, "Deferred logging unavailable, formatting inline: %s",
+                 esp_err_to_name(dlog_err));
+    }
+
+    esp_err_t stream_err = can_stream_init();
+    if (stream_err != ESP_OK) {
+        ESP_LOGW(TAG, "Live stream unavailable: %s", esp_err_to_name(stream_err));
+    }
+
+    esp_err_t replay_err = can_replay_init();
+    if (replay_err != ESP_OK) {
+        ESP_LOGW(TAG, "Log replay unavailable: %s", esp_err_to_name(replay_err));
+    }
+
+#if CONFIG_TRACE_ENABLED
+    esp_err_t trace_err = trace_init();
+    if (trace_err != ESP_OK) {
+        ESP_LOGW(TAG, "Trace init failed: %s", esp_err_to_name(trace_err));
+    }
+#endif
+
     display_manager_handle_t display = display_manager_init(&display_config);
     if (!display) {
         ESP_LOGE(TAG, "Failed to initialize display manager");
@@ -859,6 +1228,22 @@ extern "C" void app_main(void)
     }
     app_state_set_display(display);
 
+    if (ui_latency_init(k_ui_signal_names, UI_SIG_COUNT) == ESP_OK) {
+        display_manager_set_flush_hook(display, ui_latency_flush_done);
+    }
+
+    esp_err_t alert_err = alert_init(k_alert_rules, ALERT_RULE_COUNT, on_alert_change, NULL);
+    if (alert_err != ESP_OK) {
+        ESP_LOGW(TAG, "Alert init failed: %s", esp_err_to_name(alert_err));
+    }
+
+    // After the display: state changes post UI updates through LVGL
+    esp_err_t sup_err = can_supervisor_init(on_can_state_change, NULL);
+    if (sup_err != ESP_OK) {
+        ESP_LOGW(TAG, "CAN supervisor unavailable, no bus-off recovery: %s",
+                 esp_err_to_name(sup_err));
+    }
+
     lv_display_t *lv_disp = display_manager_get_display(display);
     if (lv_disp) {
         lv_obj_t *screen = lv_display_get_screen_active(lv_disp);
@@ -878,6 +1263,11 @@ extern "C" void app_main(void)
         if (sync_err != ESP_OK && sync_err != ESP_ERR_INVALID_STATE) {
             ESP_LOGW(TAG, "RTC system time sync failed: %s", esp_err_to_name(sync_err));
         }
+
+        esp_err_t tb_err = timebase_init();
+        if (tb_err != ESP_OK) {
+            ESP_LOGW(TAG, "Timebase init failed: %s", esp_err_to_name(tb_err));
+        }
     }
 
     // Initialize SD card
@@ -892,6 +1282,15 @@ extern "C" void app_main(void)
             ESP_LOGW(TAG, "CAN logger init failed: %s", esp_err_to_name(log_err));
         } else {
             ESP_LOGI(TAG, "CAN logger initialized");
+            esp_err_t sh_err = esp_register_shutdown_handler(logger_shutdown_handler);
+            if (sh_err != ESP_OK) {
+                ESP_LOGW(TAG, "Logger shutdown handler not registered: %s",
+                         esp_err_to_name(sh_err));
+            }
+#if CONFIG_APP_LOG_POLICIES
+            apply_log_policies();
+#endif
+            signal_log_init();
         }
     }
 
@@ -983,6 +1382,15 @@ extern "C" void app_main(void)
     ESP_LOGI(TAG, "All pages created, count=%d", page_count);
     app_state_set_page_count(page_count);
 
+    dm_page_t *alert_page = alert_overlay_create();
+    if (alert_page) {
+        display_manager_set_overlay(display, alert_page);
+    }
+
+    // Boot allocations are done; anything after this must not need the arenas
+    mem_plan_seal();
+    mem_plan_log_report();
+
     // Start the LVGL task AFTER all pages are created to avoid race condition
     // between page creation and LVGL's timer handler doing layout updates
     if (!display_manager_start(display)) {
@@ -1000,4 +1408,8 @@ extern "C" void app_main(void)
     xTaskCreatePinnedToCore(can_tx_task, "CAN_TX", 4096, NULL, 4, NULL, tskNO_AFFINITY);
     xTaskCreatePinnedToCore(can_telemetry_task, "CAN_TLM", 4096, NULL, 2, NULL, tskNO_AFFINITY);
     ESP_LOGI(TAG, "CAN tasks started");
+
+    if (sd_err == ESP_OK && replay_err == ESP_OK) {
+        start_boot_replay();
+    }
 }
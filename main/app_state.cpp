@@ -11,6 +11,7 @@
 #include <esp_timer.h>
 
 #include "lvgl.h"
+#include "can_supervisor.h"
 
 static const char *TAG = "APP_STATE";
 
@@ -99,6 +100,12 @@ void metrics_unlock(void)
     }
 }
 
+void metrics_unlock_changed(uint32_t changed)
+{
+    metrics_unlock();
+    display_manager_notify_changed(s_display, changed);
+}
+
 bool can_state_is_paused(void)
 {
     bool paused = false;
@@ -128,9 +135,12 @@ static void can_ui_update_cb(void *arg)
     can_state_t snapshot = {};
     can_state_get_snapshot(&snapshot);
 
+    can_supervisor_state_t bus_state = can_supervisor_get_state();
     const char *indicator = "";
     if (snapshot.paused) {
         indicator = "CAN PAUSED";
+    } else if (bus_state == CAN_SUPERVISOR_BUS_OFF || bus_state == CAN_SUPERVISOR_RECOVERING) {
+        indicator = "CAN BUS OFF";
     } else if (snapshot.error_active) {
         indicator = "CAN ERROR";
     }
@@ -219,7 +229,9 @@ void set_can_paused(bool paused)
         return;
     }
 
+    // Tell the supervisor first so it does not restart a stopping controller
     if (paused) {
+        can_supervisor_set_paused(true);
         esp_err_t err = twai_stop();
         if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
             ESP_LOGE(TAG, "Failed to stop TWAI: %s", esp_err_to_name(err));
@@ -229,6 +241,7 @@ void set_can_paused(bool paused)
         if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {
             ESP_LOGE(TAG, "Failed to start TWAI: %s", esp_err_to_name(err));
         }
+        can_supervisor_set_paused(false);
     }
 
     if (xSemaphoreTake(s_can_state_mutex, pdMS_TO_TICKS(20)) == pdTRUE) {
@@ -248,6 +261,8 @@ void app_state_set_can_paused_internal(bool paused)
         return;
     }
 
+    can_supervisor_set_paused(paused);
+
     if (xSemaphoreTake(s_can_state_mutex, pdMS_TO_TICKS(20)) == pdTRUE) {
         s_can_state.paused = paused;
         s_can_state.error_active = false;
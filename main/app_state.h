@@ -19,6 +19,46 @@
 extern "C" {
 #endif
 
+// Metric groups, used as display_manager change bits and page update masks
+#define METRIC_RPM          (1u << 0)  // OBD and broadcast RPM
+#define METRIC_ENGINE       (1u << 1)  // Battery, intake air, baro, throttle
+#define METRIC_SPEED        (1u << 2)  // Vehicle and wheel speeds
+#define METRIC_DRIVETRAIN   (1u << 3)  // ATF, gear, lockup, fuel, odometer
+#define METRIC_ORIENTATION  (1u << 4)  // Diagnostic and broadcast kinematics
+#define METRIC_RAW          (1u << 5)  // Candidate raw bytes
+#define METRIC_ALERT        (1u << 6)  // Raised/cleared overlay alerts
+
+// Displayed signals followed from CAN frame to pixel (see ui_latency)
+typedef enum {
+    UI_SIG_RPM = 0,
+    UI_SIG_BCAST_RPM,
+    UI_SIG_VEHICLE_SPEED,
+    UI_SIG_BCAST_VEHICLE_SPEED,
+    UI_SIG_FUEL,
+    UI_SIG_COUNT
+} ui_signal_t;
+
+// Metric sources the signal log samples, one per validity flag
+typedef enum {
+    METRIC_SRC_RPM = 0,
+    METRIC_SRC_BCAST_RPM_1C4,
+    METRIC_SRC_THROTTLE,
+    METRIC_SRC_VBATT,
+    METRIC_SRC_IAT,
+    METRIC_SRC_BARO,
+    METRIC_SRC_ATF,
+    METRIC_SRC_FUEL,
+    METRIC_SRC_ODO,
+    METRIC_SRC_GEAR,
+    METRIC_SRC_DIAG_VEHICLE_SPEED,
+    METRIC_SRC_BCAST_VEHICLE_SPEED,
+    METRIC_SRC_BCAST_WHEEL_SPEED,
+    METRIC_SRC_ORIENTATION,
+    METRIC_SRC_BCAST_KINEMATICS,
+    METRIC_SRC_BCAST_STEER_ANGLE,
+    METRIC_SRC_COUNT
+} metric_source_t;
+
 // CAN bus metrics collected from OBD-II and Toyota-specific PIDs
 typedef struct {
     float rpm;
@@ -94,6 +134,10 @@ typedef struct {
     bool bcast_wheel_speed_valid;
     bool diag_vehicle_speed_valid;
     bool bcast_vehicle_speed_valid;
+    // RX time (esp_timer us) of the frame behind each probed signal
+    int64_t rx_us[UI_SIG_COUNT];
+    // RX time of the frame that last wrote each source (0 = never)
+    int64_t src_rx_us[METRIC_SRC_COUNT];
 } can_metrics_t;
 
 // CAN bus state (paused, error, etc.)
@@ -132,6 +176,15 @@ void metrics_lock(void);
  */
 void metrics_unlock(void);
 
+/**
+ * @brief Release the metrics mutex and signal the UI
+ *
+ * Wakes the display if the visible page shows any of the changed groups.
+ *
+ * @param changed METRIC_* groups written while the mutex was held
+ */
+void metrics_unlock_changed(uint32_t changed);
+
 /**
  * @brief Check if CAN is currently paused
  * @return true if paused
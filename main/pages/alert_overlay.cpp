@@ -0,0 +1,114 @@
+/*
+ * Alert Overlay Implementation
+ */
+
+#include "alert_overlay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <esp_log.h>
+
+#include "lvgl.h"
+
+#include "alert.h"
+#include "app_state.h"
+#include "page_utils.h"
+
+static const char *TAG = "alert_overlay";
+
+typedef struct {
+    lv_obj_t *banner;
+    lv_obj_t *text;
+    int shown_rule;  // Rule in the banner (-1 = hidden)
+} alert_overlay_data_t;
+
+static void alert_overlay_on_create(dm_page_t *page, lv_obj_t *parent)
+{
+    alert_overlay_data_t *data = (alert_overlay_data_t *)calloc(1, sizeof(alert_overlay_data_t));
+    if (!data) {
+        ESP_LOGE(TAG, "on_create: calloc failed");
+        return;
+    }
+
+    data->shown_rule = -1;
+    page->user_data = data;
+
+    // Banner across the top; touches pass through to the page below
+    data->banner = lv_obj_create(parent);
+    lv_obj_set_size(data->banner, LV_PCT(100), 64);
+    lv_obj_align(data->banner, LV_ALIGN_TOP_MID, 0, 0);
+    lv_obj_set_style_bg_color(data->banner, k_warning_color, 0);
+    lv_obj_set_style_bg_opa(data->banner, LV_OPA_COVER, 0);
+    lv_obj_set_style_border_width(data->banner, 0, 0);
+    lv_obj_set_style_radius(data->banner, 0, 0);
+    lv_obj_clear_flag(data->banner, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_clear_flag(data->banner, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_flag(data->banner, LV_OBJ_FLAG_HIDDEN);
+
+    data->text = lv_label_create(data->banner);
+    lv_label_set_text(data->text, "");
+    lv_obj_set_style_text_font(data->text, k_title_font, 0);
+    lv_obj_set_style_text_color(data->text, k_text_color, 0);
+    lv_obj_center(data->text);
+
+    page->container = data->banner;
+    page->is_created = true;
+}
+
+static void alert_overlay_on_destroy(dm_page_t *page)
+{
+    if (page->user_data) {
+        free(page->user_data);
+    }
+}
+
+static void alert_overlay_on_update(dm_page_t *page)
+{
+    alert_overlay_data_t *data = (alert_overlay_data_t *)page->user_data;
+    if (!data) {
+        return;
+    }
+
+    int rule = alert_top(ALERT_OUT_OVERLAY);
+    if (rule < 0) {
+        if (data->shown_rule >= 0) {
+            lv_obj_add_flag(data->banner, LV_OBJ_FLAG_HIDDEN);
+            data->shown_rule = -1;
+        }
+        return;
+    }
+
+    alert_state_t state = {};
+    alert_get_state((size_t)rule, &state);
+
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%s  %.1f", alert_get_rule((size_t)rule)->name,
+             (double)state.last_value);
+    lv_label_set_text(data->text, buf);
+
+    if (data->shown_rule < 0) {
+        lv_obj_clear_flag(data->banner, LV_OBJ_FLAG_HIDDEN);
+    }
+    data->shown_rule = rule;
+}
+
+dm_page_t *alert_overlay_create(void)
+{
+    dm_page_t *page = page_create(
+        "Alerts",
+        alert_overlay_on_create,
+        alert_overlay_on_destroy,
+        NULL,
+        NULL,
+        alert_overlay_on_update
+    );
+    if (page) {
+        // Redraw on the next pass after a raise or clear; refresh the
+        // shown value every 250 ms while an alert is up
+        page->update_mask = METRIC_ALERT;
+        page->max_refresh_ms = 250;
+        page->priority = DM_PAGE_PRIORITY_HIGH;
+    }
+    return page;
+}
@@ -0,0 +1,21 @@
+/*
+ * Alert Overlay - Banner for raised alerts, shown above every page
+ */
+
+#pragma once
+
+#include "display_manager/page.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create the alert overlay (install with display_manager_set_overlay)
+ * @return Page object or NULL on failure
+ */
+dm_page_t *alert_overlay_create(void);
+
+#ifdef __cplusplus
+}
+#endif
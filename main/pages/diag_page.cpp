@@ -14,6 +14,7 @@
 #include "app_state.h"
 #include "page_utils.h"
 #include "settings_store.h"
+#include "ui_latency.h"
 
 static const char *TAG = "DIAG_PAGE";
 
@@ -197,6 +198,7 @@ static void diag_page_on_update(dm_page_t *page)
         snprintf(buf, sizeof(buf), "--");
     }
     lv_label_set_text(data->rpm_value, buf);
+    ui_latency_label_updated(UI_SIG_RPM, data->rpm_value, snap.rx_us[UI_SIG_RPM]);
 
     if (snap.throttle_valid) {
         snprintf(buf, sizeof(buf), "%.1f", snap.throttle_pct);
@@ -233,7 +235,7 @@ static void diag_page_on_update(dm_page_t *page)
 
 dm_page_t *diag_page_create(void)
 {
-    return page_create(
+    dm_page_t *page = page_create(
         "Diagnostics",
         diag_page_on_create,
         diag_page_on_destroy,
@@ -241,4 +243,12 @@ dm_page_t *diag_page_create(void)
         diag_page_on_hide,
         diag_page_on_update
     );
+    if (page) {
+        // Redraw on new data, at most every 50 ms; at least every 1000 ms
+        page->update_mask = METRIC_RPM | METRIC_ENGINE | METRIC_RAW;
+        page->min_refresh_ms = 50;
+        page->max_refresh_ms = 1000;
+        page->priority = DM_PAGE_PRIORITY_NORMAL;
+    }
+    return page;
 }
@@ -11,6 +11,7 @@
 
 #include "app_state.h"
 #include "page_utils.h"
+#include "ui_latency.h"
 
 typedef struct {
     int page_index;
@@ -161,6 +162,7 @@ static void fourrunner_page_on_update(dm_page_t *page)
         snprintf(buf, sizeof(buf), "--");
     }
     lv_label_set_text(data->fuel_value, buf);
+    ui_latency_label_updated(UI_SIG_FUEL, data->fuel_value, snap.rx_us[UI_SIG_FUEL]);
 
     if (snap.odo_valid) {
         snprintf(buf, sizeof(buf), "%lu", (unsigned long)snap.odo_km);
@@ -174,7 +176,7 @@ static void fourrunner_page_on_update(dm_page_t *page)
 
 dm_page_t *fourrunner_page_create(void)
 {
-    return page_create(
+    dm_page_t *page = page_create(
         "4Runner",
         fourrunner_page_on_create,
         fourrunner_page_on_destroy,
@@ -182,4 +184,12 @@ dm_page_t *fourrunner_page_create(void)
         fourrunner_page_on_hide,
         fourrunner_page_on_update
     );
+    if (page) {
+        // Slow-moving values: redraw on new data at most twice a second
+        page->update_mask = METRIC_DRIVETRAIN | METRIC_RAW;
+        page->min_refresh_ms = 500;
+        page->max_refresh_ms = 1000;
+        page->priority = DM_PAGE_PRIORITY_LOW;
+    }
+    return page;
 }
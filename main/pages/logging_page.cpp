@@ -17,6 +17,7 @@
 #include "page_utils.h"
 #include "sd_card.h"
 #include "can_logger.h"
+#include "trace.h"
 
 typedef struct {
     int page_index;
@@ -36,8 +37,8 @@ typedef struct {
     lv_obj_t *start_stop_label;
     lv_obj_t *page_counter;
     int64_t last_stats_ms;
-    uint32_t last_logged;
-    uint32_t last_dropped;
+    uint64_t last_logged;
+    uint64_t last_dropped;
     uint32_t last_rx_missed;
     uint32_t last_rx_overrun;
 } logging_page_data_t;
@@ -49,6 +50,11 @@ static uint32_t delta_u32(uint32_t current, uint32_t last)
     return current >= last ? (current - last) : 0;
 }
 
+static uint32_t delta_u64(uint64_t current, uint64_t last)
+{
+    return current >= last ? (uint32_t)(current - last) : 0;
+}
+
 static void logging_toggle_event_cb(lv_event_t *e)
 {
     lv_obj_t *target = static_cast<lv_obj_t *>(lv_event_get_target(e));
@@ -63,6 +69,13 @@ static void logging_toggle_event_cb(lv_event_t *e)
     }
 }
 
+// Long press dumps the trace rings next to the logs (done by the telemetry task)
+static void logging_trace_dump_event_cb(lv_event_t *e)
+{
+    (void)e;
+    trace_request_dump(TRACE_DUMP_SD);
+}
+
 static void logging_page_on_create(dm_page_t *page, lv_obj_t *parent)
 {
     logging_page_data_t *data = (logging_page_data_t *)calloc(1, sizeof(logging_page_data_t));
@@ -189,7 +202,8 @@ static void logging_page_on_create(dm_page_t *page, lv_obj_t *parent)
     lv_obj_set_style_border_width(data->start_stop_btn, 1, 0);
     lv_obj_set_style_border_color(data->start_stop_btn, k_card_border, 0);
     lv_obj_set_style_shadow_width(data->start_stop_btn, 0, 0);
-    lv_obj_add_event_cb(data->start_stop_btn, logging_toggle_event_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_event_cb(data->start_stop_btn, logging_toggle_event_cb, LV_EVENT_SHORT_CLICKED, NULL);
+    lv_obj_add_event_cb(data->start_stop_btn, logging_trace_dump_event_cb, LV_EVENT_LONG_PRESSED, NULL);
 
     data->start_stop_label = lv_label_create(data->start_stop_btn);
     lv_label_set_text(data->start_stop_label, "Start Logging");
@@ -342,13 +356,16 @@ static void logging_page_on_update(dm_page_t *page)
 
     // Statistics
     if (logger_ready) {
-        snprintf(buf, sizeof(buf), "%lu", (unsigned long)stats.messages_logged);
+        snprintf(buf, sizeof(buf), "%llu", (unsigned long long)stats.messages_logged);
         lv_label_set_text(data->msgs_logged_value, buf);
 
-        snprintf(buf, sizeof(buf), "%lu", (unsigned long)stats.messages_dropped);
+        snprintf(buf, sizeof(buf), "%llu", (unsigned long long)stats.messages_dropped);
         lv_label_set_text(data->msgs_dropped_value, buf);
 
-        if (stats.bytes_written >= 1024 * 1024) {
+        if (stats.bytes_written >= 1024ULL * 1024 * 1024) {
+            snprintf(buf, sizeof(buf), "%.2f GB",
+                     (double)stats.bytes_written / (1024.0 * 1024 * 1024));
+        } else if (stats.bytes_written >= 1024 * 1024) {
             snprintf(buf, sizeof(buf), "%.1f MB",
                      (float)stats.bytes_written / (1024 * 1024));
         } else if (stats.bytes_written >= 1024) {
@@ -359,7 +376,7 @@ static void logging_page_on_update(dm_page_t *page)
         }
         lv_label_set_text(data->bytes_written_value, buf);
 
-        snprintf(buf, sizeof(buf), "%lu", (unsigned long)stats.write_errors);
+        snprintf(buf, sizeof(buf), "%llu", (unsigned long long)stats.write_errors);
         lv_label_set_text(data->write_errors_value, buf);
     } else {
         lv_label_set_text(data->msgs_logged_value, "--");
@@ -383,8 +400,8 @@ static void logging_page_on_update(dm_page_t *page)
     bool have_status = (twai_get_status_info(&status) == ESP_OK);
 
     if (logger_ready && interval_s > 0.0f) {
-        uint32_t logged_delta = delta_u32(stats.messages_logged, data->last_logged);
-        uint32_t dropped_delta = delta_u32(stats.messages_dropped, data->last_dropped);
+        uint32_t logged_delta = delta_u64(stats.messages_logged, data->last_logged);
+        uint32_t dropped_delta = delta_u64(stats.messages_dropped, data->last_dropped);
         uint32_t total_delta = logged_delta + dropped_delta;
         float drop_pct = total_delta > 0 ? (dropped_delta * 100.0f) / total_delta : 0.0f;
         float log_rate = logged_delta / interval_s;
@@ -434,7 +451,7 @@ static void logging_page_on_update(dm_page_t *page)
 
 dm_page_t *logging_page_create(void)
 {
-    return page_create(
+    dm_page_t *page = page_create(
         "Logging",
         logging_page_on_create,
         logging_page_on_destroy,
@@ -442,4 +459,11 @@ dm_page_t *logging_page_create(void)
         logging_page_on_hide,
         logging_page_on_update
     );
+    if (page) {
+        // Status and counters only: poll twice a second
+        page->min_refresh_ms = 500;
+        page->max_refresh_ms = 500;
+        page->priority = DM_PAGE_PRIORITY_LOW;
+    }
+    return page;
 }
@@ -166,7 +166,7 @@ static void orientation_page_on_update(dm_page_t *page)
 
 dm_page_t *orientation_page_create(void)
 {
-    return page_create(
+    dm_page_t *page = page_create(
         "Orientation",
         orientation_page_on_create,
         orientation_page_on_destroy,
@@ -174,4 +174,12 @@ dm_page_t *orientation_page_create(void)
         orientation_page_on_hide,
         orientation_page_on_update
     );
+    if (page) {
+        // Redraw on new data, at most every 33 ms; at least every 1000 ms
+        page->update_mask = METRIC_ORIENTATION;
+        page->min_refresh_ms = 33;
+        page->max_refresh_ms = 1000;
+        page->priority = DM_PAGE_PRIORITY_HIGH;
+    }
+    return page;
 }
@@ -13,6 +13,7 @@
 
 #include "app_state.h"
 #include "page_utils.h"
+#include "ui_latency.h"
 
 static const char *TAG = "rpm_page";
 
@@ -128,6 +129,7 @@ static void rpm_page_on_update(dm_page_t *page)
         snprintf(buf, sizeof(buf), "--");
     }
     lv_label_set_text(data->diag_rpm_value, buf);
+    ui_latency_label_updated(UI_SIG_RPM, data->diag_rpm_value, snap.rx_us[UI_SIG_RPM]);
 
     if (snap.bcast_rpm_1c4_valid) {
         snprintf(buf, sizeof(buf), "%.0f", snap.bcast_rpm_1c4);
@@ -135,13 +137,14 @@ static void rpm_page_on_update(dm_page_t *page)
         snprintf(buf, sizeof(buf), "--");
     }
     lv_label_set_text(data->bcast_rpm_value, buf);
+    ui_latency_label_updated(UI_SIG_BCAST_RPM, data->bcast_rpm_value, snap.rx_us[UI_SIG_BCAST_RPM]);
 
     update_page_counter(data->page_counter, data->page_index);
 }
 
 dm_page_t *rpm_page_create(void)
 {
-    return page_create(
+    dm_page_t *page = page_create(
         "RPM",
         rpm_page_on_create,
         rpm_page_on_destroy,
@@ -149,4 +152,12 @@ dm_page_t *rpm_page_create(void)
         rpm_page_on_hide,
         rpm_page_on_update
     );
+    if (page) {
+        // Redraw on new data, at most every 33 ms; at least every 1000 ms
+        page->update_mask = METRIC_RPM;
+        page->min_refresh_ms = 33;
+        page->max_refresh_ms = 1000;
+        page->priority = DM_PAGE_PRIORITY_HIGH;
+    }
+    return page;
 }
@@ -467,7 +467,7 @@ static void rtc_page_on_update(dm_page_t *page)
 
 dm_page_t *rtc_page_create(void)
 {
-    return page_create(
+    dm_page_t *page = page_create(
         "RTC Settings",
         rtc_page_on_create,
         rtc_page_on_destroy,
@@ -475,4 +475,11 @@ dm_page_t *rtc_page_create(void)
         rtc_page_on_hide,
         rtc_page_on_update
     );
+    if (page) {
+        // Clock display: poll four times a second
+        page->min_refresh_ms = 250;
+        page->max_refresh_ms = 250;
+        page->priority = DM_PAGE_PRIORITY_LOW;
+    }
+    return page;
 }
@@ -11,6 +11,7 @@
 
 #include "app_state.h"
 #include "page_utils.h"
+#include "ui_latency.h"
 
 typedef struct {
     int page_index;
@@ -199,6 +200,8 @@ static void wheel_speed_page_on_update(dm_page_t *page)
         snprintf(buf, sizeof(buf), "--");
     }
     lv_label_set_text(data->diag_vehicle_speed_value, buf);
+    ui_latency_label_updated(UI_SIG_VEHICLE_SPEED, data->diag_vehicle_speed_value,
+                             snap.rx_us[UI_SIG_VEHICLE_SPEED]);
 
     // Vehicle speed (broadcast from 0x0B4)
     if (snap.bcast_vehicle_speed_valid) {
@@ -207,13 +210,15 @@ static void wheel_speed_page_on_update(dm_page_t *page)
         snprintf(buf, sizeof(buf), "--");
     }
     lv_label_set_text(data->bcast_vehicle_speed_value, buf);
+    ui_latency_label_updated(UI_SIG_BCAST_VEHICLE_SPEED, data->bcast_vehicle_speed_value,
+                             snap.rx_us[UI_SIG_BCAST_VEHICLE_SPEED]);
 
     update_page_counter(data->page_counter, data->page_index);
 }
 
 dm_page_t *wheel_speed_page_create(void)
 {
-    return page_create(
+    dm_page_t *page = page_create(
         "Wheel Speed",
         wheel_speed_page_on_create,
         wheel_speed_page_on_destroy,
@@ -221,4 +226,12 @@ dm_page_t *wheel_speed_page_create(void)
         wheel_speed_page_on_hide,
         wheel_speed_page_on_update
     );
+    if (page) {
+        // Redraw on new data, at most every 50 ms; at least every 1000 ms
+        page->update_mask = METRIC_SPEED;
+        page->min_refresh_ms = 50;
+        page->max_refresh_ms = 1000;
+        page->priority = DM_PAGE_PRIORITY_NORMAL;
+    }
+    return page;
 }
@@ -0,0 +1,132 @@
+/*
+ * Signal Log Implementation
+ *
+ * Maps can_metrics_t fields to signal sink IDs. The rate policy of each
+ * signal lives here next to its field, so fast dynamics (wheel speeds,
+ * yaw) are kept at the sampling rate while slow ones (temperatures,
+ * fuel) only cost a sample when they actually move.
+ *
+ * Samples carry the RX time of the frame that last wrote the field, and a
+ * field is only sampled again once a newer frame has written it, so a
+ * polled PID that stops answering goes quiet in the log instead of being
+ * repeated as fresh data.
+ */
+
+#include <stddef.h>
+
+#include <esp_log.h>
+
+#include "signal_log.h"
+#include "app_state.h"
+#include "can_logger_signals.h"
+
+static const char *TAG = "SIGNAL_LOG";
+
+// Metrics are sampled at most this often (the rate policies thin it further)
+#define SIGNAL_SAMPLE_INTERVAL_US 10000
+
+typedef enum {
+    FIELD_FLOAT,
+    FIELD_INT,
+    FIELD_U32
+} field_type_t;
+
+typedef struct {
+    can_logger_signal_def_t def;
+    field_type_t type;
+    size_t value_offset;
+    size_t valid_offset;
+    metric_source_t source;
+} signal_source_t;
+
+#define FIELD(kind, field, valid, source) \
+    kind, offsetof(can_metrics_t, field), offsetof(can_metrics_t, valid), source
+
+// {name, unit, scale, min_interval_ms, max_interval_ms, deadband}
+static const signal_source_t k_signals[] = {
+    {{"rpm", "rpm", 1.0f, 50, 5000, 10.0f}, FIELD(FIELD_FLOAT, rpm, rpm_valid, METRIC_SRC_RPM)},
+    {{"rpm_1c4", "rpm", 1.0f, 20, 5000, 5.0f}, FIELD(FIELD_FLOAT, bcast_rpm_1c4, bcast_rpm_1c4_valid, METRIC_SRC_BCAST_RPM_1C4)},
+    {{"throttle", "%", 0.1f, 50, 5000, 0.5f}, FIELD(FIELD_FLOAT, throttle_pct, throttle_valid, METRIC_SRC_THROTTLE)},
+    {{"vbatt", "V", 0.01f, 1000, 30000, 0.05f}, FIELD(FIELD_FLOAT, vbatt_v, vbatt_valid, METRIC_SRC_VBATT)},
+    {{"iat", "degC", 0.1f, 1000, 60000, 0.5f}, FIELD(FIELD_FLOAT, iat_c, iat_valid, METRIC_SRC_IAT)},
+    {{"baro", "kPa", 0.1f, 1000, 60000, 0.5f}, FIELD(FIELD_FLOAT, baro_kpa, baro_valid, METRIC_SRC_BARO)},
+    {{"atf_pan", "degC", 0.1f, 1000, 60000, 0.5f}, FIELD(FIELD_FLOAT, atf_pan_c, atf_valid, METRIC_SRC_ATF)},
+    {{"atf_tqc", "degC", 0.1f, 1000, 60000, 0.5f}, FIELD(FIELD_FLOAT, atf_tqc_c, atf_valid, METRIC_SRC_ATF)},
+    {{"fuel", "gal", 0.01f, 5000, 60000, 0.05f}, FIELD(FIELD_FLOAT, fli_vol_gal, fuel_valid, METRIC_SRC_FUEL)},
+    {{"odo", "km", 1.0f, 10000, 60000, 0.0f}, FIELD(FIELD_U32, odo_km, odo_valid, METRIC_SRC_ODO)},
+    {{"gear", "", 1.0f, 0, 60000, 0.0f}, FIELD(FIELD_INT, gear, gear_valid, METRIC_SRC_GEAR)},
+    {{"speed_diag", "km/h", 0.01f, 50, 5000, 0.1f}, FIELD(FIELD_FLOAT, diag_vehicle_speed_kph, diag_vehicle_speed_valid, METRIC_SRC_DIAG_VEHICLE_SPEED)},
+    {{"speed_bcast", "km/h", 0.01f, 20, 5000, 0.1f}, FIELD(FIELD_FLOAT, bcast_vehicle_speed_kph, bcast_vehicle_speed_valid, METRIC_SRC_BCAST_VEHICLE_SPEED)},
+    {{"wheel_fl", "km/h", 0.01f, 20, 5000, 0.05f}, FIELD(FIELD_FLOAT, bcast_wheel_fl_kph, bcast_wheel_speed_valid, METRIC_SRC_BCAST_WHEEL_SPEED)},
+    {{"wheel_fr", "km/h", 0.01f, 20, 5000, 0.05f}, FIELD(FIELD_FLOAT, bcast_wheel_fr_kph, bcast_wheel_speed_valid, METRIC_SRC_BCAST_WHEEL_SPEED)},
+    {{"wheel_rl", "km/h", 0.01f, 20, 5000, 0.05f}, FIELD(FIELD_FLOAT, bcast_wheel_rl_kph, bcast_wheel_speed_valid, METRIC_SRC_BCAST_WHEEL_SPEED)},
+    {{"wheel_rr", "km/h", 0.01f, 20, 5000, 0.05f}, FIELD(FIELD_FLOAT, bcast_wheel_rr_kph, bcast_wheel_speed_valid, METRIC_SRC_BCAST_WHEEL_SPEED)},
+    {{"lateral_g", "g", 0.001f, 50, 5000, 0.005f}, FIELD(FIELD_FLOAT, lateral_g, orientation_valid, METRIC_SRC_ORIENTATION)},
+    {{"longitudinal_g", "g", 0.001f, 50, 5000, 0.005f}, FIELD(FIELD_FLOAT, longitudinal_g, orientation_valid, METRIC_SRC_ORIENTATION)},
+    {{"yaw_rate", "deg/s", 0.1f, 50, 5000, 0.2f}, FIELD(FIELD_FLOAT, yaw_rate_deg_sec, orientation_valid, METRIC_SRC_ORIENTATION)},
+    {{"steering", "deg", 0.1f, 50, 5000, 0.5f}, FIELD(FIELD_FLOAT, steering_angle_deg, orientation_valid, METRIC_SRC_ORIENTATION)},
+    {{"bcast_lateral_g", "g", 0.001f, 20, 5000, 0.005f}, FIELD(FIELD_FLOAT, bcast_lateral_g, bcast_kinematics_valid, METRIC_SRC_BCAST_KINEMATICS)},
+    {{"bcast_yaw_rate", "deg/s", 0.1f, 20, 5000, 0.2f}, FIELD(FIELD_FLOAT, bcast_yaw_rate_deg_sec, bcast_kinematics_valid, METRIC_SRC_BCAST_KINEMATICS)},
+    {{"bcast_steer_torque", "", 1.0f, 20, 5000, 2.0f}, FIELD(FIELD_FLOAT, bcast_steering_torque, bcast_kinematics_valid, METRIC_SRC_BCAST_KINEMATICS)},
+    {{"bcast_steering", "deg", 0.1f, 20, 5000, 0.5f}, FIELD(FIELD_FLOAT, bcast_steering_angle_deg, bcast_steer_angle_valid, METRIC_SRC_BCAST_STEER_ANGLE)},
+};
+
+#define SIGNAL_COUNT (sizeof(k_signals) / sizeof(k_signals[0]))
+
+static bool s_registered = false;
+static int64_t s_last_sample_us = 0;
+static int64_t s_last_rx_us[SIGNAL_COUNT];  // RX time behind each signal's last sample
+
+static float read_field(const can_metrics_t *m, const signal_source_t *src)
+{
+    const char *base = (const char *)m;
+    switch (src->type) {
+        case FIELD_INT:
+            return (float)*(const int *)(base + src->value_offset);
+        case FIELD_U32:
+            return (float)*(const uint32_t *)(base + src->value_offset);
+        default:
+            return *(const float *)(base + src->value_offset);
+    }
+}
+
+bool signal_log_init(void)
+{
+    static_assert(SIGNAL_COUNT <= CAN_LOGGER_MAX_SIGNALS, "Too many logged signals");
+
+    can_logger_signal_def_t defs[SIGNAL_COUNT];
+    for (size_t i = 0; i < SIGNAL_COUNT; i++) {
+        defs[i] = k_signals[i].def;
+    }
+
+    esp_err_t err = can_logger_signals_register(defs, SIGNAL_COUNT);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Signal sink registration failed: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    s_registered = true;
+    return true;
+}
+
+void signal_log_sample(int64_t now_us)
+{
+    if (!s_registered || now_us - s_last_sample_us < SIGNAL_SAMPLE_INTERVAL_US) {
+        return;
+    }
+    s_last_sample_us = now_us;
+
+    can_metrics_t metrics;
+    metrics_get_snapshot(&metrics);
+
+    const char *base = (const char *)&metrics;
+    for (size_t i = 0; i < SIGNAL_COUNT; i++) {
+        const signal_source_t *src = &k_signals[i];
+        int64_t rx_us = metrics.src_rx_us[src->source];
+        if (!*(const bool *)(base + src->valid_offset) || rx_us <= s_last_rx_us[i]) {
+            continue;
+        }
+        s_last_rx_us[i] = rx_us;
+        can_logger_signal_log((uint16_t)i, rx_us, read_field(&metrics, src));
+    }
+}
@@ -0,0 +1,31 @@
+/*
+ * Signal Log - Feeds decoded can_metrics_t values to the logger's signal sink
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Register the logged signals with the CAN logger.
+ * Call after can_logger_init() and before logging starts.
+ * @return true on success.
+ */
+bool signal_log_init(void);
+
+/**
+ * @brief Sample the current metrics into the signal sink.
+ * Called from the CAN RX task after each frame is decoded; samples at
+ * most once per sampling interval and returns immediately otherwise.
+ * @param now_us Current esp_timer time.
+ */
+void signal_log_sample(int64_t now_us);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,22 +4,11 @@ TPMS Calibration Tool
 Helps determine the correct decoding formula based on known tire pressure
 """
 
-import re
 import sys
 from pathlib import Path
 
-
-def parse_can_message(line):
-    """Parse a CAN message line"""
-    pattern = r'ID:\s*0x([0-9A-Fa-f]+)\s+DLC:\s*(\d+)\s+Data:\s*([0-9A-Fa-f\s]+)'
-    match = re.search(pattern, line)
-    if match:
-        can_id = int(match.group(1), 16)
-        dlc = int(match.group(2))
-        data_str = match.group(3).strip()
-        data_bytes = [int(b, 16) for b in data_str.split()[:8]]
-        return {'id': can_id, 'dlc': dlc, 'data': data_bytes[:dlc]}
-    return None
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "analysis"))
+import canbin  # noqa: E402
 
 
 def main():
@@ -32,14 +21,9 @@ def main():
     log_file = Path(sys.argv[1])
 
     # Collect all 0x4A7 messages
-    messages = []
-    with open(log_file, 'r', encoding='utf-8', errors='ignore') as f:
-        for line in f:
-            msg = parse_can_message(line)
-            if msg and msg['id'] == 0x4A7:
-                messages.append(msg)
-
-    if not messages:
+    messages = canbin.open_log(log_file).frames_of(0x4A7)
+
+    if not len(messages):
         print("No 0x4A7 messages found!")
         sys.exit(1)
 
@@ -66,7 +50,7 @@ def main():
 
     # Use median message to avoid outliers
     mid_msg = messages[len(messages) // 2]
-    data = mid_msg['data']
+    data = mid_msg['data'][:mid_msg['dlc']].tolist()
 
     print(f"\nTypical message: {' '.join(f'{b:02X}' for b in data)}")
     print(f"Decimal values:  {' '.join(f'{b:3d}' for b in data)}")
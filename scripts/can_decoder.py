@@ -4,10 +4,13 @@ Toyota 4Runner CAN Bus Decoder & Verification Tool
 Use this to test the formulas against your captured data
 """
 
-import re
-from collections import defaultdict
+import sys
 from dataclasses import dataclass
-from typing import List, Tuple
+from pathlib import Path
+from typing import List
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "analysis"))
+import canbin  # noqa: E402
 
 @dataclass
 class TirePressure:
@@ -75,24 +78,10 @@ def decode_steering_angle(data: List[int]) -> float:
     raw_angle = (data[0] << 8) | data[1]
     return (raw_angle - 32768) * 0.1
 
-def parse_can_log(filename: str) -> dict:
-    """Parse CAN log file and extract messages by ID"""
-    messages = defaultdict(list)
-    
-    can_pattern = re.compile(r'RX ID:0x([0-9A-F]+) DLC:(\d+) Data:([0-9A-F ]+)')
-    
-    with open(filename, 'r') as f:
-        for line in f:
-            match = can_pattern.search(line)
-            if match:
-                can_id = match.group(1)
-                dlc = int(match.group(2))
-                data_str = match.group(3).strip()
-                data = [int(b, 16) for b in data_str.split()]
-                
-                messages[can_id].append(data)
-    
-    return messages
+def id_messages(log, can_id: int) -> List[List[int]]:
+    """Data bytes of every message of one CAN ID"""
+    frames = log.frames_of(can_id)
+    return [data[:dlc] for data, dlc in zip(frames['data'].tolist(), frames['dlc'].tolist())]
 
 def analyze_tire_pressure(messages: List[List[int]]):
     """Test all three tire pressure formulas"""
@@ -164,15 +153,14 @@ def analyze_speed(messages: List[List[int]]):
         speed_kph = decode_vehicle_speed(data)
         if not unique_speeds or abs(speed_kph - unique_speeds[-1]) > 0.1:
             unique_speeds.append(speed_kph)
-            if len(unique_speeds) <= 5:
-                speed_mph = speed_kph * 0.621371
-                print(f"Raw data: {' '.join(f'{b:02X}' for b in data)}")
-                print(f"  Speed: {speed_kph:.1f} km/h ({speed_mph:.1f} MPH)")
-                print()
+            speed_mph = speed_kph * 0.621371
+            print(f"Raw data: {' '.join(f'{b:02X}' for b in data)}")
+            print(f"  Speed: {speed_kph:.1f} km/h ({speed_mph:.1f} MPH)")
+            print()
+            if len(unique_speeds) == 5:
+                break
 
 def main():
-    import sys
-    
     if len(sys.argv) < 2:
         print("Usage: python3 can_decoder.py <can_log_file>")
         print("\nExample: python3 can_decoder.py can_capture_20251212_164502.log")
@@ -181,26 +169,27 @@ def main():
     log_file = sys.argv[1]
     print(f"Analyzing CAN log: {log_file}\n")
     
-    messages = parse_can_log(log_file)
+    log = canbin.open_log(log_file)
+    ids, counts = log.ids()
     
-    print(f"Found {len(messages)} unique CAN IDs")
-    print(f"Total messages: {sum(len(msgs) for msgs in messages.values())}\n")
+    print(f"Found {len(ids)} unique CAN IDs")
+    print(f"Total messages: {len(log)}\n")
     
     # Analyze tire pressure
-    if '0AA' in messages:
-        analyze_tire_pressure(messages['0AA'])
+    if 0x0AA in ids:
+        analyze_tire_pressure(id_messages(log, 0x0AA)[:3])
     else:
         print("⚠️  No tire pressure data (0x0AA) found in log\n")
     
     # Analyze tire temperature
-    if '4A7' in messages:
-        analyze_tire_temp(messages['4A7'])
+    if 0x4A7 in ids:
+        analyze_tire_temp(id_messages(log, 0x4A7)[:3])
     else:
         print("⚠️  No tire temperature data (0x4A7) found in log\n")
     
     # Analyze vehicle speed
-    if '024' in messages:
-        analyze_speed(messages['024'])
+    if 0x024 in ids:
+        analyze_speed(id_messages(log, 0x024))
     else:
         print("⚠️  No vehicle speed data (0x024) found in log\n")
     
@@ -222,8 +211,7 @@ def main():
     
     print(f"\n{'CAN ID':<10} {'Messages':<12} {'Description'}")
     print("-" * 60)
-    for can_id in sorted(messages.keys()):
-        count = len(messages[can_id])
+    for can_id, count in zip((f"{can_id:03X}" for can_id in ids), counts):
         desc = interesting_ids.get(can_id, 'Unknown')
         marker = "⭐" if can_id in interesting_ids else "  "
         print(f"{marker} 0x{can_id:<8} {count:<12} {desc}")
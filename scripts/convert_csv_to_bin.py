@@ -1,56 +1,29 @@
 #!/usr/bin/env python3
 """
-Convert CAN CSV logs to fixed-size binary records for faster analysis.
+Convert CAN CSV (or text capture) logs to CANBIN for faster analysis.
 
-Binary record layout (little-endian):
-  uint64  timestamp_us
-  uint16  can_id
-  uint8   dlc
-  uint8   data[8]
+Writes the logger's own CANBIN v1 format (64-byte header, 24-byte records
+matching can_bin_record_v1_t; see docs/BINARY_LOGGING.md), so the result
+works with every .bin tool. Parsing is done by analysis/canbin.py, which
+also caches this conversion by itself (log.csv -> log.csv.bin) whenever a
+script opens a CSV.
 
-Total size per record: 19 bytes. No file header is included.
+Older versions wrote headerless 19-byte records (<QHB8B); canbin.py still
+reads those.
 """
 
-import csv
-import struct
 import sys
 from pathlib import Path
 
-
-RECORD_STRUCT = struct.Struct("<QHB8B")
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "analysis"))
+import canbin  # noqa: E402
 
 
 def convert(csv_path: Path, bin_path: Path):
-    written = 0
-    with csv_path.open() as f_in, bin_path.open("wb") as f_out:
-        reader = csv.DictReader(f_in)
-        for row in reader:
-            try:
-                timestamp = int(row.get("timestamp_us", 0))
-                can_id = int(str(row.get("can_id", "0")), 16)
-                dlc = int(row.get("dlc", 0))
-            except Exception:
-                continue
-
-            data_bytes = []
-            for i in range(8):
-                val = str(row.get(f"byte{i}", "")).strip()
-                if val == "":
-                    data_bytes.append(0)
-                    continue
-                try:
-                    data_bytes.append(int(val, 16))
-                except ValueError:
-                    try:
-                        data_bytes.append(int(val))
-                    except ValueError:
-                        data_bytes.append(0)
-
-            record = RECORD_STRUCT.pack(timestamp, can_id, dlc, *data_bytes[:8])
-            f_out.write(record)
-            written += 1
+    log = canbin.open_log(csv_path, cache=False)
+    canbin.write_bin(bin_path, log.records)
 
-    print(f"Converted {written} records to {bin_path}")
+    print(f"Converted {len(log)} records to {bin_path}")
 
 
 def main():
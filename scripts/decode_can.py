@@ -4,13 +4,14 @@ CAN Data Decoder
 Decodes and analyzes specific CAN IDs from Toyota 4Runner
 """
 
-import re
 import sys
-import csv
-import struct
-from collections import defaultdict, Counter
 from pathlib import Path
 
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "analysis"))
+import canbin  # noqa: E402
+
 
 class CANDecoder:
     # Known CAN IDs and their descriptions for Toyota 4Runner
@@ -53,66 +54,7 @@ class CANDecoder:
 
     def __init__(self, log_file):
         self.log_file = Path(log_file)
-        self.messages_by_id = defaultdict(list)
-
-    def parse_can_message(self, line):
-        """Parse a CAN message line from the log"""
-        pattern = r'ID:\s*0x([0-9A-Fa-f]+)\s+DLC:\s*(\d+)\s+Data:\s*([0-9A-Fa-f\s]+)'
-
-        match = re.search(pattern, line)
-        if match:
-            can_id = int(match.group(1), 16)
-            dlc = int(match.group(2))
-            data_str = match.group(3).strip()
-            data_bytes = [int(b, 16) for b in data_str.split()[:8]]
-
-            return {
-                'id': can_id,
-                'dlc': dlc,
-                'data': data_bytes[:dlc]
-            }
-        return None
-
-    def parse_csv_row(self, row):
-        try:
-            can_id = int(str(row.get('can_id', '')).strip(), 16)
-            dlc = int(row.get('dlc', 0))
-        except Exception:
-            return None
-
-        data_bytes = []
-        for i in range(8):
-            val = row.get(f'byte{i}', '').strip()
-            if val == '':
-                data_bytes.append(0)
-                continue
-            try:
-                data_bytes.append(int(val, 16))
-            except ValueError:
-                try:
-                    data_bytes.append(int(val))
-                except ValueError:
-                    data_bytes.append(0)
-
-        return {
-            'id': can_id,
-            'dlc': dlc,
-            'data': data_bytes[:dlc]
-        }
-
-    def parse_bin_records(self):
-        record_struct = struct.Struct('<QHB8B')
-        with open(self.log_file, 'rb') as f:
-            while True:
-                chunk = f.read(record_struct.size)
-                if len(chunk) < record_struct.size:
-                    break
-                _, can_id, dlc, *data_bytes = record_struct.unpack(chunk)
-                yield {
-                    'id': can_id,
-                    'dlc': dlc,
-                    'data': data_bytes[:dlc]
-                }
+        self.log = None
 
     def decode_wheel_speed(self, data):
         """Decode wheel speed from 0x0AA (tentative)"""
@@ -202,29 +144,7 @@ class CANDecoder:
             print(f"❌ Error: File not found: {self.log_file}")
             return False
 
-        if self.log_file.suffix.lower() == '.bin':
-            for msg in self.parse_bin_records():
-                self.messages_by_id[msg['id']].append(msg)
-        else:
-            with open(self.log_file, 'r', encoding='utf-8', errors='ignore') as f:
-                first_line = f.readline()
-                f.seek(0)
-
-                if first_line.lower().startswith('timestamp_us'):
-                    reader = csv.DictReader(f)
-                    for row in reader:
-                        msg = self.parse_csv_row(row)
-                        if msg:
-                            self.messages_by_id[msg['id']].append(msg)
-                else:
-                    for line in f:
-                        if 'ID:' not in line:
-                            continue
-
-                        msg = self.parse_can_message(line)
-                        if msg:
-                            self.messages_by_id[msg['id']].append(msg)
-
+        self.log = canbin.open_log(self.log_file)
         return True
 
     def print_summary(self):
@@ -234,14 +154,12 @@ class CANDecoder:
         print(f"{'CAN ID':<10} {'Count':<10} {'Description':<30} {'DLC'}")
         print("-" * 60)
 
-        for can_id in sorted(self.messages_by_id.keys()):
-            messages = self.messages_by_id[can_id]
-            count = len(messages)
+        ids, counts = self.log.ids()
+        for can_id, count in zip(ids.tolist(), counts.tolist()):
             description = self.KNOWN_IDS.get(can_id, "Unknown")
 
             # Get most common DLC
-            dlc_counter = Counter(msg['dlc'] for msg in messages)
-            common_dlc = dlc_counter.most_common(1)[0][0]
+            common_dlc = int(np.bincount(self.log.dlc[self.log.index_of(can_id)]).argmax())
 
             print(f"0x{can_id:03X}     {count:<10,} {description:<30} {common_dlc}")
 
@@ -249,67 +167,56 @@ class CANDecoder:
 
     def print_detailed_analysis(self, can_id):
         """Print detailed analysis for a specific CAN ID"""
-        if can_id not in self.messages_by_id:
+        frames = self.log.frames_of(can_id)
+        if not len(frames):
             print(f"❌ CAN ID 0x{can_id:03X} not found in log")
             return
 
-        messages = self.messages_by_id[can_id]
         description = self.KNOWN_IDS.get(can_id, "Unknown")
 
         print(f"\n📊 DETAILED ANALYSIS: 0x{can_id:03X} - {description}")
         print("=" * 60)
-        print(f"Total messages: {len(messages):,}")
+        print(f"Total messages: {len(frames):,}")
 
         # Analyze data patterns
-        unique_patterns = {}
-        for msg in messages:
-            data_tuple = tuple(msg['data'])
-            if data_tuple not in unique_patterns:
-                unique_patterns[data_tuple] = 0
-            unique_patterns[data_tuple] += 1
-
-        print(f"Unique patterns: {len(unique_patterns)}")
+        data, dlc, counts, _ = canbin.patterns(frames)
+        print(f"Unique patterns: {len(counts)}")
 
         # Show most common patterns
         print(f"\n🔝 Most Common Patterns (top 10):")
-        sorted_patterns = sorted(unique_patterns.items(), key=lambda x: x[1], reverse=True)
-
-        for i, (pattern, count) in enumerate(sorted_patterns[:10], 1):
+        for i in range(min(10, len(counts))):
+            pattern = data[i, :dlc[i]].tolist()
             data_str = ' '.join(f"{b:02X}" for b in pattern)
-            pct = (count / len(messages)) * 100
-            print(f"  {i:2d}. {data_str:<24} (count: {count:5,}, {pct:5.2f}%)")
+            pct = (counts[i] / len(frames)) * 100
+            print(f"  {i + 1:2d}. {data_str:<24} (count: {counts[i]:5,}, {pct:5.2f}%)")
 
             # Try to decode if decoder available
-            decoded = self.decode_message(can_id, list(pattern))
+            decoded = self.decode_message(can_id, pattern)
             if decoded:
                 print(f"      Decoded: {decoded}")
 
         # Show byte variation analysis
         print(f"\n📈 Byte Variation Analysis:")
-        if len(messages) > 0:
-            max_dlc = max(msg['dlc'] for msg in messages)
-
-            for byte_idx in range(max_dlc):
-                byte_values = []
-                for msg in messages:
-                    if byte_idx < len(msg['data']):
-                        byte_values.append(msg['data'][byte_idx])
+        for byte_idx in range(int(frames['dlc'].max())):
+            byte_values = frames['data'][frames['dlc'] > byte_idx, byte_idx]
 
-                if byte_values:
-                    unique_vals = len(set(byte_values))
-                    min_val = min(byte_values)
-                    max_val = max(byte_values)
-                    avg_val = sum(byte_values) / len(byte_values)
+            if len(byte_values):
+                unique_vals = len(np.unique(byte_values))
+                min_val = int(byte_values.min())
+                max_val = int(byte_values.max())
+                avg_val = byte_values.mean()
 
-                    print(f"  Byte {byte_idx}: min=0x{min_val:02X} max=0x{max_val:02X} "
-                          f"avg=0x{int(avg_val):02X} unique={unique_vals}")
+                print(f"  Byte {byte_idx}: min=0x{min_val:02X} max=0x{max_val:02X} "
+                      f"avg=0x{int(avg_val):02X} unique={unique_vals}")
 
         # Show temporal variation
-        if len(messages) >= 3:
+        if len(frames) >= 3:
+            first, middle, last = canbin.hex_bytes(frames['data'][[0, len(frames) // 2, -1]],
+                                                   frames['dlc'][[0, len(frames) // 2, -1]])
             print(f"\n⏱️  Temporal Variation:")
-            print(f"  First:  {' '.join(f'{b:02X}' for b in messages[0]['data'])}")
-            print(f"  Middle: {' '.join(f'{b:02X}' for b in messages[len(messages)//2]['data'])}")
-            print(f"  Last:   {' '.join(f'{b:02X}' for b in messages[-1]['data'])}")
+            print(f"  First:  {first}")
+            print(f"  Middle: {middle}")
+            print(f"  Last:   {last}")
 
         print("=" * 60)
 
@@ -321,15 +228,21 @@ class CANDecoder:
         with open(output_file, 'w') as f:
             f.write("CAN_ID,Message_Index,Data_Hex,Decoded\n")
 
-            for can_id in sorted(self.messages_by_id.keys()):
-                messages = self.messages_by_id[can_id]
-
-                for idx, msg in enumerate(messages):
-                    data_str = ' '.join(f"{b:02X}" for b in msg['data'])
-                    decoded = self.decode_message(can_id, msg['data'])
-                    decoded_str = str(decoded) if decoded else ""
-
-                    f.write(f"0x{can_id:03X},{idx},{data_str},{decoded_str}\n")
+            ids, _ = self.log.ids()
+            for can_id in ids.tolist():
+                frames = self.log.frames_of(can_id)
+                data, dlc, _, inverse = canbin.patterns(frames)
+
+                # Decode each distinct payload once
+                decoded = []
+                for pattern, length in zip(data.tolist(), dlc.tolist()):
+                    pattern = pattern[:length]
+                    result = self.decode_message(can_id, pattern)
+                    decoded.append((' '.join(f"{b:02X}" for b in pattern),
+                                    str(result) if result else ""))
+
+                f.write("".join(f"0x{can_id:03X},{idx},{decoded[p][0]},{decoded[p][1]}\n"
+                                for idx, p in enumerate(inverse.tolist())))
 
         print(f"\n💾 Decoded data exported to: {output_file}")
 
@@ -4,19 +4,20 @@ Enhanced CAN Decoder with OBDb Integration
 Decodes CAN messages using Toyota 4Runner OBDb database
 """
 
-import re
 import sys
 import json
-import csv
-import struct
-from collections import defaultdict, Counter
 from pathlib import Path
 
+import numpy as np
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "analysis"))
+import canbin  # noqa: E402
+
 
 class OBDbDecoder:
     def __init__(self, log_file, obdb_path=None):
         self.log_file = Path(log_file)
-        self.messages_by_id = defaultdict(list)
+        self.log = None
         self.obdb_data = None
         self.obdb_path = Path(obdb_path) if obdb_path else Path.home() / "Code/OBDb-Toyota-4Runner/signalsets/v3/default.json"
 
@@ -193,105 +194,32 @@ class OBDbDecoder:
                     "source": defn.get('source', 'obdb'),
                 }
 
-    def parse_can_message(self, line):
-        """Parse a CAN message line from the log"""
-        pattern = r'ID:\s*0x([0-9A-Fa-f]+)\s+DLC:\s*(\d+)\s+Data:\s*([0-9A-Fa-f\s]+)'
-
-        match = re.search(pattern, line)
-        if match:
-            can_id = int(match.group(1), 16)
-            dlc = int(match.group(2))
-            data_str = match.group(3).strip()
-            data_bytes = [int(b, 16) for b in data_str.split()[:8]]
-
-            return {
-                'id': can_id,
-                'dlc': dlc,
-                'data': data_bytes[:dlc]
-            }
-        return None
-
-    def parse_csv_row(self, row):
-        """Parse a CAN message row from CSV format"""
-        try:
-            can_id = int(str(row.get('can_id', '')).strip(), 16)
-            dlc = int(row.get('dlc', 0))
-        except Exception:
-            return None
-
-        data_bytes = []
-        for i in range(8):
-            val = row.get(f'byte{i}', '').strip()
-            if val == '':
-                data_bytes.append(0)
-                continue
-            try:
-                data_bytes.append(int(val, 16))
-            except ValueError:
-                try:
-                    data_bytes.append(int(val))
-                except ValueError:
-                    data_bytes.append(0)
-
-        return {
-            'id': can_id,
-            'dlc': dlc,
-            'data': data_bytes[:dlc]
-        }
-
-    def parse_bin_records(self):
-        """Parse binary log with fixed-size records"""
-        record_struct = struct.Struct('<QHB8B')
-        with open(self.log_file, 'rb') as f:
-            while True:
-                chunk = f.read(record_struct.size)
-                if len(chunk) < record_struct.size:
-                    break
-                timestamp_us, can_id, dlc, *data_bytes = record_struct.unpack(chunk)
-                yield {
-                    'id': can_id,
-                    'dlc': dlc,
-                    'data': data_bytes[:dlc]
-                }
-
-    def extract_bits(self, data_bytes, bix, length, signed=False):
-        """Extract bits from data bytes
+    def extract_bits(self, frames, bix, length, signed=False):
+        """Extract a bit field from every frame
 
         Args:
-            data_bytes: List of bytes
+            frames: canbin frame records
             bix: Bit index (0-based, from MSB of first byte)
             length: Number of bits to extract
             signed: Whether to interpret as signed integer
-        """
-        # Convert bytes to bit string
-        bit_string = ''.join(f'{b:08b}' for b in data_bytes)
-
-        # Extract the bits
-        if bix + length > len(bit_string):
-            return None
-
-        value_bits = bit_string[bix:bix + length]
-        value = int(value_bits, 2)
 
-        # Handle signed values
-        if signed and value >= (1 << (length - 1)):
-            value -= (1 << length)
-
-        return value
+        Returns (raw values, mask of the frames whose DLC covers the field).
+        """
+        if length < 1 or bix < 0 or bix + length > 64:
+            return np.zeros(len(frames), dtype=np.int64), np.zeros(len(frames), dtype=bool)
 
-    def decode_signal(self, data_bytes, signal_def):
-        """Decode a signal from data bytes using signal definition"""
-        bix = signal_def.get('bix', 0)
-        length = signal_def.get('len', 8)
-        signed = signal_def.get('sign', False)
+        # MSB-first bit index -> DBC big-endian start bit
+        start = (bix // 8) * 8 + 7 - bix % 8
+        raw = canbin.field(frames['data'], start, length, big_endian=True, signed=signed)
+        return raw, frames['dlc'].astype(np.int64) * 8 >= bix + length
 
-        # Extract raw value
-        raw = self.extract_bits(data_bytes, bix, length, signed)
-        if raw is None:
-            return None
+    def decode_signal(self, frames, signal_def):
+        """Decode a signal from every frame using signal definition"""
+        raw, valid = self.extract_bits(frames, signal_def.get('bix', 0), signal_def.get('len', 8),
+                                       signal_def.get('sign', False))
 
         # Apply transformations
-        value = float(raw)
+        value = raw.astype(np.float64)
 
         add = signal_def.get('add')
         mul = signal_def.get('mul')
@@ -309,28 +237,22 @@ class OBDbDecoder:
         return {
             'raw': raw,
             'value': value,
+            'valid': valid,
             'unit': signal_def.get('unit', 'unknown'),
             'name': signal_def.get('name', 'Unknown')
         }
 
-    def decode_message(self, can_id, data_bytes):
-        """Decode a CAN message"""
+    def decode_frames(self, can_id, frames):
+        """Decode the frames of one CAN ID: a column per signal, or None"""
         if can_id not in self.signal_definitions:
             return None
 
         can_def = self.signal_definitions[can_id]
-        decoded = {
+        return {
             'name': can_def['name'],
-            'signals': []
+            'signals': [self.decode_signal(frames, signal_def) for signal_def in can_def['signals']]
         }
 
-        for signal_def in can_def['signals']:
-            result = self.decode_signal(data_bytes, signal_def)
-            if result:
-                decoded['signals'].append(result)
-
-        return decoded
-
     def analyze(self):
         """Analyze the log file"""
         print(f"Decoding CAN messages from: {self.log_file}")
@@ -340,29 +262,7 @@ class OBDbDecoder:
             print(f"❌ Error: File not found: {self.log_file}")
             return False
 
-        if self.log_file.suffix.lower() == '.bin':
-            for msg in self.parse_bin_records():
-                self.messages_by_id[msg['id']].append(msg)
-        else:
-            with open(self.log_file, 'r', encoding='utf-8', errors='ignore') as f:
-                first_line = f.readline()
-                f.seek(0)
-
-                if first_line.lower().startswith('timestamp_us'):
-                    reader = csv.DictReader(f)
-                    for row in reader:
-                        msg = self.parse_csv_row(row)
-                        if msg:
-                            self.messages_by_id[msg['id']].append(msg)
-                else:
-                    for line in f:
-                        if 'ID:' not in line:
-                            continue
-
-                        msg = self.parse_can_message(line)
-                        if msg:
-                            self.messages_by_id[msg['id']].append(msg)
-
+        self.log = canbin.open_log(self.log_file)
         return True
 
     def print_decoded_summary(self):
@@ -373,10 +273,8 @@ class OBDbDecoder:
         decoded_count = 0
         unknown_count = 0
 
-        for can_id in sorted(self.messages_by_id.keys()):
-            messages = self.messages_by_id[can_id]
-            count = len(messages)
-
+        ids, counts = self.log.ids()
+        for can_id, count in zip(ids.tolist(), counts.tolist()):
             if can_id in self.signal_definitions:
                 can_def = self.signal_definitions[can_id]
                 name = can_def['name']
@@ -393,11 +291,11 @@ class OBDbDecoder:
 
     def print_detailed_decode(self, can_id):
         """Print detailed decode for a specific CAN ID"""
-        if can_id not in self.messages_by_id:
+        messages = self.log.frames_of(can_id)
+        if not len(messages):
             print(f"❌ CAN ID 0x{can_id:03X} not found in log")
             return
 
-        messages = self.messages_by_id[can_id]
 
         print(f"\n📡 DETAILED DECODE: 0x{can_id:03X}")
         print("=" * 60)
@@ -406,8 +304,8 @@ class OBDbDecoder:
         if can_id not in self.signal_definitions:
             print(f"⚠️  No decoder available for this ID")
             print(f"\nFirst 5 messages (raw):")
-            for i, msg in enumerate(messages[:5], 1):
-                data_str = ' '.join(f"{b:02X}" for b in msg['data'])
+            for i, data_str in enumerate(canbin.hex_bytes(messages['data'][:5],
+                                                          messages['dlc'][:5]), 1):
                 print(f"  {i}. {data_str}")
             return
 
@@ -418,34 +316,27 @@ class OBDbDecoder:
 
         # Decode first few messages
         print(f"\n📝 Sample Decoded Messages (first 5):")
-        for i, msg in enumerate(messages[:5], 1):
-            decoded = self.decode_message(can_id, msg['data'])
-            data_str = ' '.join(f"{b:02X}" for b in msg['data'])
-            print(f"\n  Message {i}: {data_str}")
+        decoded = self.decode_frames(can_id, messages[:5])
+        data_strs = canbin.hex_bytes(messages['data'][:5], messages['dlc'][:5])
+        for i, data_str in enumerate(data_strs):
+            print(f"\n  Message {i + 1}: {data_str}")
 
-            if decoded:
-                for signal in decoded['signals']:
-                    print(f"    {signal['name']:<25}: {signal['value']:>10.2f} {signal['unit']:<10} (raw: 0x{signal['raw']:04X})")
+            for signal in decoded['signals']:
+                if signal['valid'][i]:
+                    print(f"    {signal['name']:<25}: {signal['value'][i]:>10.2f} {signal['unit']:<10} (raw: 0x{signal['raw'][i]:04X})")
 
         # Show variation in decoded values
         if len(messages) > 1:
             print(f"\n📈 Value Ranges:")
 
-            # Collect all decoded values
-            signal_values = defaultdict(list)
-            for msg in messages:
-                decoded = self.decode_message(can_id, msg['data'])
-                if decoded:
-                    for signal in decoded['signals']:
-                        signal_values[signal['name']].append(signal['value'])
-
             # Show ranges
-            for signal_name, values in signal_values.items():
-                if values:
-                    min_val = min(values)
-                    max_val = max(values)
-                    avg_val = sum(values) / len(values)
-                    print(f"  {signal_name:<25}: min={min_val:>8.2f}  max={max_val:>8.2f}  avg={avg_val:>8.2f}")
+            for signal in self.decode_frames(can_id, messages)['signals']:
+                values = signal['value'][signal['valid']]
+                if len(values):
+                    min_val = values.min()
+                    max_val = values.max()
+                    avg_val = values.mean()
+                    print(f"  {signal['name']:<25}: min={min_val:>8.2f}  max={max_val:>8.2f}  avg={avg_val:>8.2f}")
 
         print("=" * 60)
 
@@ -457,20 +348,29 @@ class OBDbDecoder:
         with open(output_file, 'w') as f:
             f.write("CAN_ID,Message_Name,Message_Index,Signal_Name,Value,Unit,Raw_Hex\n")
 
-            for can_id in sorted(self.messages_by_id.keys()):
-                messages = self.messages_by_id[can_id]
+            ids, _ = self.log.ids()
+            for can_id in ids.tolist():
+                messages = self.log.frames_of(can_id)
                 message_name = self.signal_definitions.get(can_id, {}).get('name', 'Unknown')
-
-                for idx, msg in enumerate(messages):
-                    decoded = self.decode_message(can_id, msg['data'])
-                    data_str = ' '.join(f"{b:02X}" for b in msg['data'])
-
-                    if decoded:
-                        for signal in decoded['signals']:
-                            f.write(f"0x{can_id:03X},{message_name},{idx},"
-                                  f"{signal['name']},{signal['value']:.2f},{signal['unit']},{data_str}\n")
-                    else:
-                        f.write(f"0x{can_id:03X},{message_name},{idx},raw,0,unknown,{data_str}\n")
+                decoded = self.decode_frames(can_id, messages)
+                data_strs = canbin.hex_bytes(messages['data'], messages['dlc'])
+
+                if decoded is None:
+                    f.write("".join(f"0x{can_id:03X},{message_name},{idx},raw,0,unknown,{data_str}\n"
+                                    for idx, data_str in enumerate(data_strs)))
+                    continue
+
+                # One row per message and signal, in message order
+                rows = []
+                for column, signal in enumerate(decoded['signals']):
+                    idx = np.flatnonzero(signal['valid'])
+                    values = [f"{v:.2f}" for v in signal['value'][idx].tolist()]
+                    rows += zip(idx.tolist(), [column] * len(idx), [signal['name']] * len(idx),
+                                values, [signal['unit']] * len(idx))
+                rows.sort(key=lambda row: row[:2])
+                f.write("".join(f"0x{can_id:03X},{message_name},{idx},{name},{value},{unit},"
+                                f"{data_strs[idx]}\n"
+                                for idx, _, name, value, unit in rows))
 
         print(f"\n💾 Decoded data exported to: {output_file}")
 
@@ -2,34 +2,21 @@
 """
 Find Rear TPMS Data
 Searches all CAN IDs for messages with byte values similar to front tire encoding
+
+Usage: find_rear_tpms.py [log_file]  (default: logs/can_capture_20251212_164502.log)
 """
 
-import re
+import sys
 from pathlib import Path
-from collections import defaultdict
-
 
-def parse_can_message(line):
-    pattern = r'ID:\s*0x([0-9A-Fa-f]+)\s+DLC:\s*(\d+)\s+Data:\s*([0-9A-Fa-f\s]+)'
-    match = re.search(pattern, line)
-    if match:
-        can_id = int(match.group(1), 16)
-        dlc = int(match.group(2))
-        data_str = match.group(3).strip()
-        data_bytes = [int(b, 16) for b in data_str.split()[:8]]
-        return {'id': can_id, 'dlc': dlc, 'data': data_bytes[:dlc]}
-    return None
+import numpy as np
 
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "analysis"))
+import canbin  # noqa: E402
 
-log_file = Path("logs/can_capture_20251212_164502.log")
-messages_by_id = defaultdict(list)
 
-# Collect all messages
-with open(log_file, 'r', encoding='utf-8', errors='ignore') as f:
-    for line in f:
-        msg = parse_can_message(line)
-        if msg:
-            messages_by_id[msg['id']].append(msg)
+log_file = Path(sys.argv[1] if len(sys.argv) > 1 else "logs/can_capture_20251212_164502.log")
+log = canbin.open_log(log_file)
 
 print("=" * 80)
 print("SEARCHING FOR REAR TPMS DATA")
@@ -40,55 +27,43 @@ print("Looking for CAN IDs with similar byte patterns...\n")
 # Look for IDs with bytes in the range 150-180 (close to front tire values)
 target_range = range(150, 181)
 
-candidates = []
-
-for can_id, messages in sorted(messages_by_id.items()):
-    # Check if any messages have bytes in our target range
-    for msg in messages:
-        for byte_idx, byte_val in enumerate(msg['data']):
-            if byte_val in target_range:
-                candidates.append({
-                    'id': can_id,
-                    'byte_idx': byte_idx,
-                    'value': byte_val,
-                    'msg': msg
-                })
-                break  # Only need one match per ID
-        else:
-            continue
-        break
+# Bytes within the DLC and in the target range, per frame
+in_dlc = np.arange(8) < log.dlc[:, None]
+in_range = in_dlc & (log.data >= target_range.start) & (log.data < target_range.stop)
+
+ids, _ = log.ids()
+candidates = [can_id for can_id in ids.tolist() if in_range[log.index_of(can_id)].any()]
 
 print(f"Found {len(candidates)} CAN IDs with bytes in range 150-180:\n")
 
-for cand in candidates:
-    can_id = cand['id']
-    messages = messages_by_id[can_id]
+for can_id in candidates:
+    messages = log.frames_of(can_id)
 
     print(f"\n0x{can_id:03X} ({len(messages)} messages):")
 
     # Show byte statistics for this ID
-    if messages:
-        msg_len = len(messages[0]['data'])
-        for byte_idx in range(msg_len):
-            values = [m['data'][byte_idx] for m in messages if byte_idx < len(m['data'])]
-            if values:
-                min_val = min(values)
-                max_val = max(values)
-                avg_val = sum(values) / len(values)
-
-                # Highlight bytes in our target range
-                if min_val in target_range or max_val in target_range or avg_val in target_range:
-                    print(f"  Byte {byte_idx}: min={min_val:3d} max={max_val:3d} avg={avg_val:6.1f} ⭐")
-                else:
-                    print(f"  Byte {byte_idx}: min={min_val:3d} max={max_val:3d} avg={avg_val:6.1f}")
+    msg_len = int(messages['dlc'][0])
+    for byte_idx in range(msg_len):
+        values = messages['data'][messages['dlc'] > byte_idx, byte_idx].astype(int)
+        if len(values):
+            min_val = int(values.min())
+            max_val = int(values.max())
+            avg_val = float(values.mean())
+
+            # Highlight bytes in our target range
+            if min_val in target_range or max_val in target_range or avg_val in target_range:
+                print(f"  Byte {byte_idx}: min={min_val:3d} max={max_val:3d} avg={avg_val:6.1f} ⭐")
+            else:
+                print(f"  Byte {byte_idx}: min={min_val:3d} max={max_val:3d} avg={avg_val:6.1f}")
 
     # Show a sample message
     sample = messages[len(messages)//2]
-    print(f"  Sample: {' '.join(f'{b:02X}' for b in sample['data'])}")
+    sample_data = sample['data'][:sample['dlc']].tolist()
+    print(f"  Sample: {' '.join(f'{b:02X}' for b in sample_data)}")
 
     # Try decoding with the front tire formula (x * 0.23 PSI)
     print(f"  Decoded (using x * 0.23 PSI):")
-    for byte_idx, byte_val in enumerate(sample['data']):
+    for byte_idx, byte_val in enumerate(sample_data):
         psi = byte_val * 0.23
         if 30 < psi < 45:  # Reasonable tire pressure range
             print(f"    Byte {byte_idx}: {byte_val} → {psi:.1f} PSI ✓")
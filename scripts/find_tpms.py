@@ -4,13 +4,12 @@ TPMS Finder and Decoder
 Searches for TPMS (Tire Pressure Monitoring System) messages in CAN logs
 """
 
-import re
 import sys
-import csv
-import struct
-from collections import defaultdict
 from pathlib import Path
 
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "analysis"))
+import canbin  # noqa: E402
+
 
 class TPMSFinder:
     # Common TPMS CAN IDs for Toyota vehicles
@@ -24,67 +23,7 @@ class TPMSFinder:
 
     def __init__(self, log_file):
         self.log_file = Path(log_file)
-        self.tpms_messages = defaultdict(list)
-        self.all_messages_by_id = defaultdict(list)
-
-    def parse_can_message(self, line):
-        """Parse a CAN message line from the log"""
-        pattern = r'ID:\s*0x([0-9A-Fa-f]+)\s+DLC:\s*(\d+)\s+Data:\s*([0-9A-Fa-f\s]+)'
-
-        match = re.search(pattern, line)
-        if match:
-            can_id = int(match.group(1), 16)
-            dlc = int(match.group(2))
-            data_str = match.group(3).strip()
-            data_bytes = [int(b, 16) for b in data_str.split()[:8]]
-
-            return {
-                'id': can_id,
-                'dlc': dlc,
-                'data': data_bytes[:dlc]
-            }
-        return None
-
-    def parse_csv_row(self, row):
-        try:
-            can_id = int(str(row.get('can_id', '')).strip(), 16)
-            dlc = int(row.get('dlc', 0))
-        except Exception:
-            return None
-
-        data_bytes = []
-        for i in range(8):
-            val = row.get(f'byte{i}', '').strip()
-            if val == '':
-                data_bytes.append(0)
-                continue
-            try:
-                data_bytes.append(int(val, 16))
-            except ValueError:
-                try:
-                    data_bytes.append(int(val))
-                except ValueError:
-                    data_bytes.append(0)
-
-        return {
-            'id': can_id,
-            'dlc': dlc,
-            'data': data_bytes[:dlc]
-        }
-
-    def parse_bin_records(self):
-        record_struct = struct.Struct('<QHB8B')
-        with open(self.log_file, 'rb') as f:
-            while True:
-                chunk = f.read(record_struct.size)
-                if len(chunk) < record_struct.size:
-                    break
-                _, can_id, dlc, *data_bytes = record_struct.unpack(chunk)
-                yield {
-                    'id': can_id,
-                    'dlc': dlc,
-                    'data': data_bytes[:dlc]
-                }
+        self.log = None
 
     def decode_tpms_0x4a7(self, data):
         """
@@ -131,40 +70,7 @@ class TPMSFinder:
             print(f"❌ Error: File not found: {self.log_file}")
             return False
 
-        if self.log_file.suffix.lower() == '.bin':
-            for msg in self.parse_bin_records():
-                self.all_messages_by_id[msg['id']].append(msg)
-                if msg['id'] in self.KNOWN_TPMS_IDS:
-                    self.tpms_messages[msg['id']].append(msg)
-        else:
-            with open(self.log_file, 'r', encoding='utf-8', errors='ignore') as f:
-                first_line = f.readline()
-                f.seek(0)
-
-                if first_line.lower().startswith('timestamp_us'):
-                    reader = csv.DictReader(f)
-                    for row in reader:
-                        msg = self.parse_csv_row(row)
-                        if not msg:
-                            continue
-
-                        self.all_messages_by_id[msg['id']].append(msg)
-                        if msg['id'] in self.KNOWN_TPMS_IDS:
-                            self.tpms_messages[msg['id']].append(msg)
-                else:
-                    for line in f:
-                        if 'ID:' not in line:
-                            continue
-
-                        msg = self.parse_can_message(line)
-                        if not msg:
-                            continue
-
-                        self.all_messages_by_id[msg['id']].append(msg)
-
-                        if msg['id'] in self.KNOWN_TPMS_IDS:
-                            self.tpms_messages[msg['id']].append(msg)
-
+        self.log = canbin.open_log(self.log_file)
         return True
 
     def print_report(self):
@@ -176,7 +82,7 @@ class TPMSFinder:
         print("\n📡 Known TPMS IDs:")
         found_tpms = False
         for can_id, description in sorted(self.KNOWN_TPMS_IDS.items()):
-            count = len(self.tpms_messages.get(can_id, []))
+            count = len(self.log.index_of(can_id))
             if count > 0:
                 print(f"  ✅ 0x{can_id:03X} ({description}): {count} messages")
                 found_tpms = True
@@ -188,46 +94,39 @@ class TPMSFinder:
             print("\n💡 Potential TPMS IDs (searching for patterns):")
 
             # Look for IDs in the typical TPMS range (0x4A0-0x4AF, 0x750-0x760)
-            potential_ids = []
-            for can_id, messages in self.all_messages_by_id.items():
-                if (0x4A0 <= can_id <= 0x4AF) or (0x750 <= can_id <= 0x760):
-                    potential_ids.append((can_id, len(messages)))
+            ids, counts = self.log.ids()
+            potential = ((ids >= 0x4A0) & (ids <= 0x4AF)) | ((ids >= 0x750) & (ids <= 0x760))
 
-            if potential_ids:
-                for can_id, count in sorted(potential_ids):
+            if potential.any():
+                for can_id, count in zip(ids[potential].tolist(), counts[potential].tolist()):
                     print(f"  🔍 0x{can_id:03X}: {count} messages")
                     # Show sample
-                    sample = self.all_messages_by_id[can_id][0]
-                    data_str = ' '.join(f"{b:02X}" for b in sample['data'])
+                    sample = self.log.frames[self.log.index_of(can_id)[0]]
+                    data_str = canbin.hex_bytes(sample['data'], [sample['dlc']])[0]
                     print(f"      Sample: {data_str}")
             else:
                 print("  No messages found in typical TPMS ID ranges")
 
         # Decode known TPMS messages
-        if 0x4A7 in self.tpms_messages:
+        messages = self.log.frames_of(0x4A7)
+        if len(messages):
             print(f"\n📊 Decoding 0x4A7 TPMS Messages:")
             print("-" * 60)
 
-            messages = self.tpms_messages[0x4A7]
             print(f"Total messages: {len(messages)}")
 
             # Show unique data patterns
-            unique_patterns = {}
-            for msg in messages:
-                data_tuple = tuple(msg['data'])
-                if data_tuple not in unique_patterns:
-                    unique_patterns[data_tuple] = 0
-                unique_patterns[data_tuple] += 1
-
-            print(f"Unique patterns: {len(unique_patterns)}")
+            data, dlc, counts, _ = canbin.patterns(messages)
+
+            print(f"Unique patterns: {len(counts)}")
             print(f"\nMost common patterns (top 5):")
 
-            sorted_patterns = sorted(unique_patterns.items(), key=lambda x: x[1], reverse=True)
-            for i, (pattern, count) in enumerate(sorted_patterns[:5], 1):
+            for i in range(min(5, len(counts))):
+                pattern = data[i, :dlc[i]].tolist()
                 data_str = ' '.join(f"{b:02X}" for b in pattern)
-                decoded = self.decode_tpms_0x4a7(list(pattern))
+                decoded = self.decode_tpms_0x4a7(pattern)
 
-                print(f"\n  Pattern {i}: {data_str} (count: {count})")
+                print(f"\n  Pattern {i + 1}: {data_str} (count: {counts[i]})")
                 if decoded:
                     print(f"    8-bit interpretation:  FL={decoded['8bit_values']['FL']:3d} "
                           f"FR={decoded['8bit_values']['FR']:3d} "
@@ -240,15 +139,18 @@ class TPMSFinder:
 
             # Show data change over time
             if len(messages) > 1:
+                first, last = canbin.hex_bytes(messages['data'][[0, -1]], messages['dlc'][[0, -1]])
                 print(f"\n  Data variation analysis:")
-                print(f"    First message: {' '.join(f'{b:02X}' for b in messages[0]['data'])}")
-                print(f"    Last message:  {' '.join(f'{b:02X}' for b in messages[-1]['data'])}")
+                print(f"    First message: {first}")
+                print(f"    Last message:  {last}")
 
         print("\n" + "=" * 60)
 
     def export_tpms_messages(self, output_file=None):
         """Export TPMS messages to a file"""
-        if not self.tpms_messages:
+        tpms_ids = [can_id for can_id in sorted(self.KNOWN_TPMS_IDS)
+                    if len(self.log.index_of(can_id))]
+        if not tpms_ids:
             print("No TPMS messages to export")
             return
 
@@ -259,14 +161,14 @@ class TPMSFinder:
             f.write("TPMS Messages Export\n")
             f.write("=" * 60 + "\n\n")
 
-            for can_id, messages in sorted(self.tpms_messages.items()):
+            for can_id in tpms_ids:
+                messages = self.log.frames_of(can_id)
                 f.write(f"CAN ID: 0x{can_id:03X} - {self.KNOWN_TPMS_IDS.get(can_id, 'Unknown')}\n")
                 f.write(f"Total messages: {len(messages)}\n")
                 f.write("-" * 60 + "\n")
 
-                for i, msg in enumerate(messages, 1):
-                    data_str = ' '.join(f"{b:02X}" for b in msg['data'])
-                    f.write(f"{i:5d}: {data_str}\n")
+                data_str = canbin.hex_bytes(messages['data'], messages['dlc'])
+                f.write("".join(f"{i:5d}: {text}\n" for i, text in enumerate(data_str, 1)))
 
                 f.write("\n")
 
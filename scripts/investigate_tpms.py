@@ -8,23 +8,13 @@ Expected values:
 - Ambient temp: ~55°F (13°C)
 """
 
-import re
 import sys
-from collections import defaultdict
 from pathlib import Path
 
+import numpy as np
 
-def parse_can_message(line):
-    """Parse a CAN message line"""
-    pattern = r'ID:\s*0x([0-9A-Fa-f]+)\s+DLC:\s*(\d+)\s+Data:\s*([0-9A-Fa-f\s]+)'
-    match = re.search(pattern, line)
-    if match:
-        can_id = int(match.group(1), 16)
-        dlc = int(match.group(2))
-        data_str = match.group(3).strip()
-        data_bytes = [int(b, 16) for b in data_str.split()[:8]]
-        return {'id': can_id, 'dlc': dlc, 'data': data_bytes[:dlc]}
-    return None
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "analysis"))
+import canbin  # noqa: E402
 
 
 def try_decoding_schemes(data_bytes):
@@ -130,28 +120,18 @@ def main():
     print("\n" + "=" * 80)
 
     # Collect all 0x4A7 messages
-    messages_4a7 = []
-    with open(log_file, 'r', encoding='utf-8', errors='ignore') as f:
-        for line in f:
-            msg = parse_can_message(line)
-            if msg and msg['id'] == 0x4A7:
-                messages_4a7.append(msg)
+    messages_4a7 = canbin.open_log(log_file).frames_of(0x4A7)
 
     print(f"\nFound {len(messages_4a7)} messages on ID 0x4A7")
 
-    if not messages_4a7:
+    if not len(messages_4a7):
         print("No 0x4A7 messages found!")
         sys.exit(1)
 
     # Analyze unique patterns
-    unique_patterns = {}
-    for msg in messages_4a7:
-        pattern = tuple(msg['data'])
-        if pattern not in unique_patterns:
-            unique_patterns[pattern] = 0
-        unique_patterns[pattern] += 1
+    data, dlc, counts, _ = canbin.patterns(messages_4a7)
 
-    print(f"Unique patterns: {len(unique_patterns)}")
+    print(f"Unique patterns: {len(counts)}")
 
     # Show byte statistics
     print("\n" + "=" * 80)
@@ -159,25 +139,24 @@ def main():
     print("=" * 80)
 
     for byte_idx in range(8):
-        values = [msg['data'][byte_idx] for msg in messages_4a7 if byte_idx < len(msg['data'])]
-        if values:
+        values = messages_4a7['data'][messages_4a7['dlc'] > byte_idx, byte_idx].astype(int)
+        if len(values):
             print(f"\nByte {byte_idx}:")
-            print(f"  Min: {min(values):3d} (0x{min(values):02X})  " +
-                  f"Max: {max(values):3d} (0x{max(values):02X})  " +
-                  f"Avg: {sum(values)/len(values):6.1f}  " +
-                  f"Unique: {len(set(values))}")
+            print(f"  Min: {values.min():3d} (0x{values.min():02X})  " +
+                  f"Max: {values.max():3d} (0x{values.max():02X})  " +
+                  f"Avg: {values.mean():6.1f}  " +
+                  f"Unique: {len(np.unique(values))}")
 
             # If values are stable (low variation), might be temperature
             # If values have high variation, might be pressure
-            variation = max(values) - min(values)
+            variation = values.max() - values.min()
             if variation < 20:
                 print(f"  → Low variation ({variation}) - possibly temperature or constant")
             else:
                 print(f"  → High variation ({variation}) - possibly pressure or dynamic value")
 
     # Analyze most common pattern in detail
-    most_common = sorted(unique_patterns.items(), key=lambda x: x[1], reverse=True)[0]
-    pattern, count = most_common
+    pattern, count = data[0, :dlc[0]].tolist(), counts[0]
 
     print("\n" + "=" * 80)
     print(f"MOST COMMON PATTERN (appears {count} times):")
@@ -190,7 +169,7 @@ def main():
     print("TRYING DIFFERENT BYTE LAYOUTS")
     print("=" * 80)
 
-    schemes = try_decoding_schemes(list(pattern))
+    schemes = try_decoding_schemes(pattern)
     for scheme_name, layout in schemes.items():
         print(f"\n{scheme_name}:")
         for key, val in layout.items():
@@ -230,12 +209,14 @@ def main():
     print("=" * 80)
 
     print("\nFirst 5 messages:")
-    for i, msg in enumerate(messages_4a7[:5], 1):
-        print(f"  {i}. {' '.join(f'{b:02X}' for b in msg['data'])}")
+    for i, data_str in enumerate(canbin.hex_bytes(messages_4a7['data'][:5],
+                                                  messages_4a7['dlc'][:5]), 1):
+        print(f"  {i}. {data_str}")
 
     print("\nLast 5 messages:")
-    for i, msg in enumerate(messages_4a7[-5:], 1):
-        print(f"  {i}. {' '.join(f'{b:02X}' for b in msg['data'])}")
+    for i, data_str in enumerate(canbin.hex_bytes(messages_4a7['data'][-5:],
+                                                  messages_4a7['dlc'][-5:]), 1):
+        print(f"  {i}. {data_str}")
 
     print("\n" + "=" * 80)
 
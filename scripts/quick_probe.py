@@ -7,78 +7,52 @@ Currently checks:
 - RPM candidates: 0x1D0 (bytes0-1, 1-2)
 - TPMS candidates: 0x4A7 byte2/3 averages vs RPM idle/high
 
-Binary format matches convert_csv_to_bin.py (<QHB8B).
+Reads any log canbin.py understands (CANBIN, legacy .bin, CSV, text).
 """
 
-import csv
-import struct
 import sys
-from collections import Counter
 from pathlib import Path
 
+import numpy as np
 
-RECORD_STRUCT = struct.Struct('<QHB8B')
-
-
-def iter_msgs(path: Path):
-    if path.suffix.lower() == '.bin':
-        with path.open('rb') as f:
-            while True:
-                chunk = f.read(RECORD_STRUCT.size)
-                if len(chunk) < RECORD_STRUCT.size:
-                    break
-                ts, can_id, dlc, *data = RECORD_STRUCT.unpack(chunk)
-                yield {'id': can_id, 'dlc': dlc, 'data': data[:dlc]}
-    else:
-        with path.open() as f:
-            first = f.readline()
-            f.seek(0)
-            if first.lower().startswith('timestamp_us'):
-                r = csv.DictReader(f)
-                for row in r:
-                    try:
-                        can_id = int(row['can_id'], 16)
-                        dlc = int(row['dlc'])
-                        data = [int(row[f'byte{i}'], 16) for i in range(8)]
-                    except Exception:
-                        continue
-                    yield {'id': can_id, 'dlc': dlc, 'data': data[:dlc]}
-            else:
-                # text log not needed for this probe
-                return
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "analysis"))
+import canbin  # noqa: E402
+
+
+def id_data(log, can_id):
+    """(frame positions, data with the bytes past the DLC zeroed) of one ID"""
+    index = log.index_of(can_id)
+    frames = log.frames[index]
+    data = frames['data'] * (np.arange(8) < frames['dlc'][:, None])
+    return index, data
 
 
 def summarize(path: Path):
-    speed_024_01 = []
-    speed_024_45 = []
-    speed_237_01 = []
-    rpm_1d0_01 = []
-    rpm_1d0_12 = []
-    tpms_4a7_low = []
-    tpms_4a7_high = []
-    rpm_last = None
-
-    for msg in iter_msgs(path):
-        cid = msg['id']
-        data = msg['data'] + [0] * (8 - len(msg['data']))
-
-        if cid == 0x1D0:
-            rpm_1d0_01.append((data[0] << 8) | data[1])
-            rpm_1d0_12.append((data[1] << 8) | data[2])
-            rpm_last = (data[1] << 8) | data[2]
-        elif cid == 0x024:
-            speed_024_01.append((data[0] << 8) | data[1])
-            speed_024_45.append((data[4] << 8) | data[5])
-        elif cid == 0x237:
-            speed_237_01.append((data[0] << 8) | data[1])
-        elif cid == 0x4A7 and rpm_last is not None:
-            target = tpms_4a7_high if rpm_last > 900 else tpms_4a7_low
-            target.append((data[2], data[3]))
+    log = canbin.open_log(path)
+
+    rpm_index, rpm = id_data(log, 0x1D0)
+    _, speed_024 = id_data(log, 0x024)
+    _, speed_237 = id_data(log, 0x237)
+    tpms_index, tpms = id_data(log, 0x4A7)
+
+    speed_024_01 = canbin.field(speed_024, 7, 16, big_endian=True)
+    speed_024_45 = canbin.field(speed_024, 39, 16, big_endian=True)
+    speed_237_01 = canbin.field(speed_237, 7, 16, big_endian=True)
+    rpm_1d0_01 = canbin.field(rpm, 7, 16, big_endian=True)
+    rpm_1d0_12 = canbin.field(rpm, 15, 16, big_endian=True)
+
+    # RPM of the latest 0x1D0 before each 0x4A7 frame
+    latest = np.searchsorted(rpm_index, tpms_index) - 1
+    tpms = tpms[latest >= 0]
+    high = rpm_1d0_12[latest[latest >= 0]] > 900
+    tpms_4a7_low = tpms[~high]
+    tpms_4a7_high = tpms[high]
 
     def stats(vals):
-        if not vals:
+        if not len(vals):
             return None
-        return min(vals), max(vals), sum(vals) / len(vals), len(set(vals))
+        return (int(vals.min()), int(vals.max()), int(vals.sum()) / len(vals),
+                len(np.unique(vals)))
 
     print("0x024 bytes0-1", stats(speed_024_01))
     print("0x024 bytes4-5", stats(speed_024_45))
@@ -87,10 +61,10 @@ def summarize(path: Path):
     print("0x1D0 bytes1-2", stats(rpm_1d0_12))
 
     tpms_sets = [
-        ("4A7 byte2 low", [x[0] for x in tpms_4a7_low]),
-        ("4A7 byte2 high", [x[0] for x in tpms_4a7_high]),
-        ("4A7 byte3 low", [x[1] for x in tpms_4a7_low]),
-        ("4A7 byte3 high", [x[1] for x in tpms_4a7_high]),
+        ("4A7 byte2 low", tpms_4a7_low[:, 2]),
+        ("4A7 byte2 high", tpms_4a7_high[:, 2]),
+        ("4A7 byte3 low", tpms_4a7_low[:, 3]),
+        ("4A7 byte3 high", tpms_4a7_high[:, 3]),
     ]
 
     for label, arr in tpms_sets:
@@ -99,7 +73,7 @@ def summarize(path: Path):
 
 def main():
     if len(sys.argv) < 2:
-        print("Usage: quick_probe.py <log.csv|log.bin>")
+        print("Usage: quick_probe.py <log.bin|log.csv|log.txt>")
         sys.exit(1)
     path = Path(sys.argv[1])
     summarize(path)
@@ -17,6 +17,23 @@ make
 echo ""
 echo "=== Running unit tests ==="
 ./test_can_signal
+./test_can_logger_powerfail
+./test_timebase_discipline
+./test_log_index
+./test_can_sig_codec
+./test_can_logger_policy
+./test_can_latency_hist
+./test_mem_arena
+./test_trace_ring
+./test_dlog_format
+./test_ui_latency_probe
+./test_alert_engine
+./test_can_stream_codec
+./test_can_replay_core
+./test_can_supervisor_core
+./test_obd_discovery_core
+./test_can_correlate
+./test_field_search
 
 echo ""
 echo "=== All tests passed ==="
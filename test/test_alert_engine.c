@@ -0,0 +1,131 @@
+/*
+ * Unit tests for the threshold alert engine
+ */
+
+#include "unity/unity.h"
+#include "alert_engine.h"
+
+enum {
+    RULE_OVER_REV,
+    RULE_LOW_BATT,
+    RULE_LAT_G,
+    RULE_COUNT
+};
+
+static const alert_rule_t k_rules[RULE_COUNT] = {
+    [RULE_OVER_REV] = {"OVER-REV", ALERT_ABOVE, 5500.0f, 200.0f, 0, 3,
+                       ALERT_OUT_GPIO | ALERT_OUT_OVERLAY},
+    [RULE_LOW_BATT] = {"LOW BATT", ALERT_BELOW, 11.8f, 0.3f, 5000000, 1, ALERT_OUT_OVERLAY},
+    [RULE_LAT_G] = {"LAT G", ALERT_ABS_ABOVE, 0.6f, 0.05f, 200000, 2, ALERT_OUT_OVERLAY},
+};
+
+static alert_engine_t s_engine;
+
+void setUp(void) {
+    TEST_ASSERT_TRUE(alert_engine_init(&s_engine, k_rules, RULE_COUNT));
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: Zero debounce raises on the first sample over the threshold and
+ * clears only once below threshold minus hysteresis
+ */
+void test_immediate_with_hysteresis(void) {
+    TEST_ASSERT_EQUAL(ALERT_EVENT_NONE, alert_engine_update(&s_engine, RULE_OVER_REV, 5400.0f, 0));
+    TEST_ASSERT_EQUAL(ALERT_EVENT_RAISED,
+                      alert_engine_update(&s_engine, RULE_OVER_REV, 5600.0f, 1000));
+    TEST_ASSERT_EQUAL_HEX32(1u << RULE_OVER_REV, s_engine.active_mask);
+
+    // Inside the hysteresis band: stays raised
+    TEST_ASSERT_EQUAL(ALERT_EVENT_NONE,
+                      alert_engine_update(&s_engine, RULE_OVER_REV, 5400.0f, 2000));
+    TEST_ASSERT_EQUAL(ALERT_EVENT_CLEARED,
+                      alert_engine_update(&s_engine, RULE_OVER_REV, 5250.0f, 3000));
+    TEST_ASSERT_EQUAL_HEX32(0, s_engine.active_mask);
+    TEST_ASSERT_EQUAL_UINT32(1, s_engine.state[RULE_OVER_REV].raise_count);
+}
+
+/*
+ * Test: The condition must hold for the debounce time; a break restarts it
+ */
+void test_debounce(void) {
+    const int64_t s = 1000000;
+    TEST_ASSERT_EQUAL(ALERT_EVENT_NONE, alert_engine_update(&s_engine, RULE_LOW_BATT, 11.5f, 0));
+    TEST_ASSERT_EQUAL(ALERT_EVENT_NONE,
+                      alert_engine_update(&s_engine, RULE_LOW_BATT, 11.5f, 4 * s));
+    // Cranking dip recovers: timer restarts
+    TEST_ASSERT_EQUAL(ALERT_EVENT_NONE,
+                      alert_engine_update(&s_engine, RULE_LOW_BATT, 12.4f, 4 * s + 1));
+    TEST_ASSERT_EQUAL(ALERT_EVENT_NONE,
+                      alert_engine_update(&s_engine, RULE_LOW_BATT, 11.5f, 5 * s));
+    TEST_ASSERT_EQUAL(ALERT_EVENT_NONE,
+                      alert_engine_update(&s_engine, RULE_LOW_BATT, 11.5f, 9 * s));
+    TEST_ASSERT_EQUAL(ALERT_EVENT_RAISED,
+                      alert_engine_update(&s_engine, RULE_LOW_BATT, 11.5f, 10 * s));
+
+    // Clearing is debounced too
+    TEST_ASSERT_EQUAL(ALERT_EVENT_NONE,
+                      alert_engine_update(&s_engine, RULE_LOW_BATT, 12.5f, 11 * s));
+    TEST_ASSERT_EQUAL(ALERT_EVENT_CLEARED,
+                      alert_engine_update(&s_engine, RULE_LOW_BATT, 12.5f, 16 * s));
+}
+
+/*
+ * Test: Absolute comparison fires for both signs
+ */
+void test_abs_above(void) {
+    TEST_ASSERT_EQUAL(ALERT_EVENT_NONE, alert_engine_update(&s_engine, RULE_LAT_G, -0.7f, 0));
+    TEST_ASSERT_EQUAL(ALERT_EVENT_RAISED,
+                      alert_engine_update(&s_engine, RULE_LAT_G, -0.65f, 200000));
+    TEST_ASSERT_EQUAL(ALERT_EVENT_NONE,
+                      alert_engine_update(&s_engine, RULE_LAT_G, 0.58f, 300000));
+    TEST_ASSERT_EQUAL(ALERT_EVENT_NONE,
+                      alert_engine_update(&s_engine, RULE_LAT_G, 0.5f, 400000));
+    TEST_ASSERT_EQUAL(ALERT_EVENT_CLEARED,
+                      alert_engine_update(&s_engine, RULE_LAT_G, 0.5f, 600000));
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, s_engine.state[RULE_LAT_G].last_value);
+}
+
+/*
+ * Test: The top alert is the highest-severity active rule with the outputs
+ */
+void test_top(void) {
+    TEST_ASSERT_EQUAL_INT(-1, alert_engine_top(&s_engine, s_engine.active_mask, 0));
+
+    alert_engine_update(&s_engine, RULE_LAT_G, 1.0f, 0);
+    alert_engine_update(&s_engine, RULE_LAT_G, 1.0f, 300000);
+    alert_engine_update(&s_engine, RULE_OVER_REV, 6000.0f, 300000);
+
+    TEST_ASSERT_EQUAL_INT(RULE_OVER_REV, alert_engine_top(&s_engine, s_engine.active_mask, 0));
+    TEST_ASSERT_EQUAL_INT(RULE_LAT_G,
+                          alert_engine_top(&s_engine, 1u << RULE_LAT_G, ALERT_OUT_OVERLAY));
+    TEST_ASSERT_EQUAL_INT(RULE_OVER_REV,
+                          alert_engine_top(&s_engine, s_engine.active_mask, ALERT_OUT_GPIO));
+}
+
+/*
+ * Test: Bad arguments are rejected
+ */
+void test_bad_args(void) {
+    alert_engine_t engine;
+    TEST_ASSERT_FALSE(alert_engine_init(NULL, k_rules, RULE_COUNT));
+    TEST_ASSERT_FALSE(alert_engine_init(&engine, NULL, 1));
+    TEST_ASSERT_FALSE(alert_engine_init(&engine, k_rules, ALERT_MAX_RULES + 1));
+    TEST_ASSERT_EQUAL(ALERT_EVENT_NONE, alert_engine_update(&s_engine, RULE_COUNT, 1.0f, 0));
+    TEST_ASSERT_EQUAL(ALERT_EVENT_NONE, alert_engine_update(NULL, 0, 1.0f, 0));
+    TEST_ASSERT_EQUAL_INT(-1, alert_engine_top(NULL, 1, 0));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_immediate_with_hysteresis);
+    RUN_TEST(test_debounce);
+    RUN_TEST(test_abs_above);
+    RUN_TEST(test_top);
+    RUN_TEST(test_bad_args);
+
+    return UNITY_END();
+}
@@ -0,0 +1,144 @@
+/*
+ * Unit tests for the native correlation engine (analysis/native)
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "unity/unity.h"
+#include "can_correlate.h"
+
+#define WINDOW_US 100000
+#define MAX_FRAMES 256
+
+static int64_t s_ts[MAX_FRAMES];
+static uint32_t s_id[MAX_FRAMES];
+static uint8_t s_data[MAX_FRAMES][8];
+static size_t s_count;
+
+static int64_t s_sig_window[64];
+static double s_sig_value[64];
+static size_t s_sig_offsets[2];
+
+static double s_corr[2 * CAN_CORR_FEATURES];
+static uint32_t s_windows[2];
+
+static void add(int64_t ts, uint32_t id, uint8_t b0, uint8_t b1)
+{
+    s_ts[s_count] = ts;
+    s_id[s_count] = id;
+    memset(s_data[s_count], 0, 8);
+    s_data[s_count][0] = b0;
+    s_data[s_count][1] = b1;
+    s_count++;
+}
+
+static int run(const uint32_t *ids, size_t id_count, uint32_t min_windows)
+{
+    const can_corr_frames_t frames = {s_ts, s_id, &s_data[0][0], s_count};
+    const can_corr_signals_t signals = {s_sig_window, s_sig_value, s_sig_offsets, 1};
+    return can_corr_run(&frames, ids, id_count, &signals, WINDOW_US, min_windows, 2, s_corr,
+                        s_windows);
+}
+
+static int feature(const char *name)
+{
+    for (unsigned i = 0; i < CAN_CORR_FEATURES; i++) {
+        if (strcmp(can_corr_feature_name(i), name) == 0) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void setUp(void) {
+    s_count = 0;
+    s_sig_offsets[0] = 0;
+    s_sig_offsets[1] = 0;
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: A field tracking the signal correlates at +1 on the aligned
+ * windows; constant fields have no result
+ */
+void test_linear_field(void) {
+    const uint32_t ids[] = {0x1C4};
+    for (int w = 0; w < 30; w++) {
+        // Two frames per window; their mean is 2w + 1
+        add((int64_t)w * WINDOW_US + 10, 0x1C4, (uint8_t)(2 * w), 7);
+        add((int64_t)w * WINDOW_US + 50000, 0x1C4, (uint8_t)(2 * w + 2), 7);
+        add((int64_t)w * WINDOW_US + 60000, 0x0AA, 0xFF, (uint8_t)w);
+        if (w % 2 == 0) {
+            s_sig_window[s_sig_offsets[1]] = w;
+            s_sig_value[s_sig_offsets[1]] = 100.0 + 4.0 * w;
+            s_sig_offsets[1]++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT(CAN_CORR_OK, run(ids, 1, 10));
+    TEST_ASSERT_EQUAL_UINT32(15, s_windows[0]);
+    TEST_ASSERT_TRUE(fabs(s_corr[feature("b0_u8")] - 1.0) < 1e-12);
+    TEST_ASSERT_TRUE(fabs(s_corr[feature("b01_u16_be")] - 1.0) < 1e-12);
+    TEST_ASSERT_TRUE(isnan(s_corr[feature("b1_u8")]));
+    TEST_ASSERT_TRUE(isnan(s_corr[feature("b7_s8")]));
+
+    // Too few aligned windows: nothing reported
+    TEST_ASSERT_EQUAL_INT(CAN_CORR_OK, run(ids, 1, 16));
+    TEST_ASSERT_TRUE(isnan(s_corr[feature("b0_u8")]));
+}
+
+/*
+ * Test: Signed features wrap like the pandas conversion, and IDs are
+ * kept apart
+ */
+void test_signed_and_ids(void) {
+    const uint32_t ids[] = {0x024, 0x0AA};
+    for (int w = 0; w < 20; w++) {
+        // b0 steps through 0x7E, 0x7F, 0x80, ...: s8 jumps, u8 does not
+        add((int64_t)w * WINDOW_US, 0x024, (uint8_t)(0x70 + w), 0);
+        add((int64_t)w * WINDOW_US + 1, 0x0AA, (uint8_t)(40 - w), 0);
+        s_sig_window[w] = w;
+        s_sig_value[w] = w;
+    }
+    s_sig_offsets[1] = 20;
+
+    TEST_ASSERT_EQUAL_INT(CAN_CORR_OK, run(ids, 2, 5));
+    TEST_ASSERT_EQUAL_UINT32(20, s_windows[0]);
+    TEST_ASSERT_EQUAL_UINT32(20, s_windows[1]);
+    TEST_ASSERT_TRUE(fabs(s_corr[feature("b0_u8")] - 1.0) < 1e-12);
+    TEST_ASSERT_TRUE(s_corr[feature("b0_s8")] < 0.5);
+    TEST_ASSERT_TRUE(fabs(s_corr[CAN_CORR_FEATURES + feature("b0_u8")] + 1.0) < 1e-12);
+}
+
+/*
+ * Test: Unsorted frames, duplicate IDs and bad windows are rejected
+ */
+void test_errors(void) {
+    const uint32_t ids[] = {0x1C4, 0x1C4};
+    add(200, 0x1C4, 1, 0);
+    add(100, 0x1C4, 2, 0);
+    TEST_ASSERT_EQUAL_INT(CAN_CORR_ERR_UNSORTED, run(ids, 1, 1));
+    TEST_ASSERT_EQUAL_INT(CAN_CORR_ERR_ARG, run(ids, 2, 1));
+
+    s_count = 0;
+    s_sig_window[0] = 3;
+    s_sig_window[1] = 3;
+    s_sig_offsets[1] = 2;
+    TEST_ASSERT_EQUAL_INT(CAN_CORR_ERR_ARG, run(ids, 1, 1));
+
+    TEST_ASSERT_NULL(can_corr_feature_name(CAN_CORR_FEATURES));
+    TEST_ASSERT_EQUAL_STRING("b67_s16_le", can_corr_feature_name(CAN_CORR_FEATURES - 1));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_linear_field);
+    RUN_TEST(test_signed_and_ids);
+    RUN_TEST(test_errors);
+
+    return UNITY_END();
+}
@@ -0,0 +1,103 @@
+/*
+ * Unit tests for the log2 latency histogram
+ */
+
+#include "unity/unity.h"
+#include "can_latency_hist.h"
+
+static can_latency_hist_t s_hist;
+
+void setUp(void) {
+    can_latency_hist_reset(&s_hist);
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: Bucket edges are powers of two starting at 128 us
+ */
+void test_bucket_edges(void) {
+    TEST_ASSERT_EQUAL_INT(0, can_latency_hist_bucket(0));
+    TEST_ASSERT_EQUAL_INT(0, can_latency_hist_bucket(127));
+    TEST_ASSERT_EQUAL_INT(1, can_latency_hist_bucket(128));
+    TEST_ASSERT_EQUAL_INT(1, can_latency_hist_bucket(255));
+    TEST_ASSERT_EQUAL_INT(2, can_latency_hist_bucket(256));
+    TEST_ASSERT_EQUAL_INT(7, can_latency_hist_bucket(10000));
+    TEST_ASSERT_EQUAL_INT(CAN_LATENCY_HIST_BUCKETS - 1, can_latency_hist_bucket(UINT32_MAX));
+
+    TEST_ASSERT_EQUAL_UINT32(128, can_latency_hist_bucket_upper_us(0));
+    TEST_ASSERT_EQUAL_UINT32(16384, can_latency_hist_bucket_upper_us(7));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX,
+                             can_latency_hist_bucket_upper_us(CAN_LATENCY_HIST_BUCKETS - 1));
+
+    // Every value is below its bucket's upper edge
+    for (int i = 0; i < CAN_LATENCY_HIST_BUCKETS - 1; i++) {
+        uint32_t upper = can_latency_hist_bucket_upper_us(i);
+        TEST_ASSERT_EQUAL_INT(i, can_latency_hist_bucket(upper - 1));
+        TEST_ASSERT_EQUAL_INT(i + 1, can_latency_hist_bucket(upper));
+    }
+}
+
+/*
+ * Test: Count, total and max track samples; negatives clamp to 0
+ */
+void test_record_totals(void) {
+    can_latency_hist_record(&s_hist, 100);
+    can_latency_hist_record(&s_hist, 3000);
+    can_latency_hist_record(&s_hist, -5);
+
+    TEST_ASSERT_EQUAL_UINT32(3, s_hist.count);
+    TEST_ASSERT_EQUAL_UINT32(3000, s_hist.max_us);
+    TEST_ASSERT_EQUAL_UINT64(3100, s_hist.total_us);
+    TEST_ASSERT_EQUAL_UINT32(2, s_hist.buckets[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, s_hist.buckets[can_latency_hist_bucket(3000)]);
+}
+
+/*
+ * Test: Percentiles land on bucket edges and never exceed the max
+ */
+void test_percentiles(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, can_latency_hist_percentile(&s_hist, 50));
+
+    // 98 fast writes, 2 slow syncs
+    for (int i = 0; i < 98; i++) {
+        can_latency_hist_record(&s_hist, 300);
+    }
+    can_latency_hist_record(&s_hist, 40000);
+    can_latency_hist_record(&s_hist, 45000);
+
+    TEST_ASSERT_EQUAL_UINT32(512, can_latency_hist_percentile(&s_hist, 50));
+    TEST_ASSERT_EQUAL_UINT32(512, can_latency_hist_percentile(&s_hist, 98));
+    TEST_ASSERT_EQUAL_UINT32(45000, can_latency_hist_percentile(&s_hist, 99));
+    TEST_ASSERT_EQUAL_UINT32(45000, can_latency_hist_percentile(&s_hist, 100));
+}
+
+/*
+ * Test: Merging adds buckets and keeps the larger max
+ */
+void test_merge(void) {
+    can_latency_hist_t other;
+    can_latency_hist_reset(&other);
+
+    can_latency_hist_record(&s_hist, 200);
+    can_latency_hist_record(&other, 200);
+    can_latency_hist_record(&other, 9000);
+
+    can_latency_hist_merge(&s_hist, &other);
+    TEST_ASSERT_EQUAL_UINT32(3, s_hist.count);
+    TEST_ASSERT_EQUAL_UINT32(9000, s_hist.max_us);
+    TEST_ASSERT_EQUAL_UINT64(9400, s_hist.total_us);
+    TEST_ASSERT_EQUAL_UINT32(2, s_hist.buckets[can_latency_hist_bucket(200)]);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_bucket_edges);
+    RUN_TEST(test_record_totals);
+    RUN_TEST(test_percentiles);
+    RUN_TEST(test_merge);
+
+    return UNITY_END();
+}
@@ -0,0 +1,168 @@
+/*
+ * Unit tests for the CAN logger per-ID policy table
+ */
+
+#include "unity/unity.h"
+#include "can_logger_policy.h"
+#include <string.h>
+
+static can_log_policy_table_t s_table;
+static const uint8_t k_payload_a[8] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+static const uint8_t k_payload_b[8] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x89};
+
+void setUp(void) {
+    can_log_policy_init(&s_table);
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: IDs without a policy, and extended IDs, are always logged
+ */
+void test_default_always(void) {
+    for (int i = 0; i < 10; i++) {
+        TEST_ASSERT_TRUE(can_log_policy_check(&s_table, 0x0AA, 8, k_payload_a, i * 10000));
+    }
+    TEST_ASSERT_TRUE(can_log_policy_check(&s_table, 0x18DAF110, 8, k_payload_a, 0));
+    TEST_ASSERT_NULL(can_log_policy_get(&s_table, 0x0AA));
+
+    const can_log_policy_t policy = {.kind = CAN_LOG_POLICY_ON_CHANGE};
+    TEST_ASSERT_FALSE(can_log_policy_set(&s_table, 0x800, &policy));
+    TEST_ASSERT_FALSE(can_log_policy_set(&s_table, 0x18DAF110, &policy));
+}
+
+/*
+ * Test: Every Nth frame, starting with the first
+ */
+void test_every_n(void) {
+    const can_log_policy_t policy = {.kind = CAN_LOG_POLICY_EVERY_N, .every_n = 4};
+    TEST_ASSERT_TRUE(can_log_policy_set(&s_table, 0x024, &policy));
+
+    int logged = 0;
+    for (int i = 0; i < 20; i++) {
+        bool log = can_log_policy_check(&s_table, 0x024, 8, k_payload_a, i);
+        TEST_ASSERT_EQUAL(i % 4 == 0, log);
+        logged += log;
+    }
+    TEST_ASSERT_EQUAL_INT(5, logged);
+
+    const can_log_policy_slot_t *slot = can_log_policy_get(&s_table, 0x024);
+    TEST_ASSERT_NOT_NULL(slot);
+    TEST_ASSERT_EQUAL_UINT32(5, slot->logged);
+    TEST_ASSERT_EQUAL_UINT32(15, slot->suppressed);
+    TEST_ASSERT_EQUAL_UINT32(15, s_table.suppressed[CAN_LOG_POLICY_EVERY_N]);
+}
+
+/*
+ * Test: Change-only logging with a keyframe
+ */
+void test_on_change_keyframe(void) {
+    const can_log_policy_t policy = {
+        .kind = CAN_LOG_POLICY_ON_CHANGE,
+        .keyframe_us = 1000000
+    };
+    TEST_ASSERT_TRUE(can_log_policy_set(&s_table, 0x0B4, &policy));
+
+    TEST_ASSERT_TRUE(can_log_policy_check(&s_table, 0x0B4, 8, k_payload_a, 0));       // First
+    TEST_ASSERT_FALSE(can_log_policy_check(&s_table, 0x0B4, 8, k_payload_a, 10000));  // Same
+    TEST_ASSERT_TRUE(can_log_policy_check(&s_table, 0x0B4, 8, k_payload_b, 20000));   // Changed
+    TEST_ASSERT_FALSE(can_log_policy_check(&s_table, 0x0B4, 8, k_payload_b, 1010000));
+    TEST_ASSERT_TRUE(can_log_policy_check(&s_table, 0x0B4, 8, k_payload_b, 1020000)); // Keyframe
+    TEST_ASSERT_TRUE(can_log_policy_check(&s_table, 0x0B4, 7, k_payload_b, 1030000)); // DLC changed
+
+    TEST_ASSERT_EQUAL_UINT32(2, s_table.suppressed[CAN_LOG_POLICY_ON_CHANGE]);
+}
+
+/*
+ * Test: Bytes past the DLC do not count as a change
+ */
+void test_on_change_ignores_padding(void) {
+    const can_log_policy_t policy = {.kind = CAN_LOG_POLICY_ON_CHANGE};
+    can_log_policy_set(&s_table, 0x123, &policy);
+
+    TEST_ASSERT_TRUE(can_log_policy_check(&s_table, 0x123, 4, k_payload_a, 0));
+    TEST_ASSERT_FALSE(can_log_policy_check(&s_table, 0x123, 4, k_payload_b, 100));
+    TEST_ASSERT_FALSE(can_log_policy_check(&s_table, 0x123, 4, k_payload_a, 60000000));  // No keyframe
+}
+
+/*
+ * Test: Rate limit caps changed frames and still sends keyframes
+ */
+void test_rate_limit(void) {
+    const can_log_policy_t policy = {
+        .kind = CAN_LOG_POLICY_RATE_LIMIT,
+        .min_interval_us = 50000,
+        .keyframe_us = 500000
+    };
+    can_log_policy_set(&s_table, 0x0AA, &policy);
+
+    // Payload changes on every frame at 100 Hz: 1 in 5 is kept
+    int logged = 0;
+    for (int i = 0; i < 100; i++) {
+        uint8_t payload[8] = {0};
+        payload[0] = (uint8_t)i;
+        logged += can_log_policy_check(&s_table, 0x0AA, 8, payload, i * 10000LL);
+    }
+    TEST_ASSERT_EQUAL_INT(20, logged);
+
+    // Unchanged payload: only keyframes
+    can_log_policy_reset_state(&s_table);
+    logged = 0;
+    for (int i = 0; i < 100; i++) {
+        logged += can_log_policy_check(&s_table, 0x0AA, 8, k_payload_a, i * 10000LL);
+    }
+    TEST_ASSERT_EQUAL_INT(2, logged);  // t=0 and t=500 ms
+    TEST_ASSERT_EQUAL_UINT32(98, s_table.suppressed[CAN_LOG_POLICY_RATE_LIMIT]);
+}
+
+/*
+ * Test: Replacing a policy reuses the slot; resetting state keeps policies
+ */
+void test_replace_and_reset(void) {
+    const can_log_policy_t change = {.kind = CAN_LOG_POLICY_ON_CHANGE};
+    const can_log_policy_t every = {.kind = CAN_LOG_POLICY_EVERY_N, .every_n = 2};
+
+    can_log_policy_set(&s_table, 0x025, &change);
+    can_log_policy_check(&s_table, 0x025, 8, k_payload_a, 0);
+    can_log_policy_check(&s_table, 0x025, 8, k_payload_a, 1);
+    can_log_policy_set(&s_table, 0x025, &every);
+    TEST_ASSERT_EQUAL_UINT16(1, s_table.slot_count);
+    TEST_ASSERT_EQUAL_UINT32(0, can_log_policy_get(&s_table, 0x025)->suppressed);
+
+    can_log_policy_set(&s_table, 0x025, &change);
+    can_log_policy_check(&s_table, 0x025, 8, k_payload_a, 0);
+    can_log_policy_reset_state(&s_table);
+    TEST_ASSERT_TRUE(can_log_policy_check(&s_table, 0x025, 8, k_payload_a, 10));  // New file
+    TEST_ASSERT_EQUAL(CAN_LOG_POLICY_ON_CHANGE, can_log_policy_get(&s_table, 0x025)->policy.kind);
+}
+
+/*
+ * Test: Rule slots run out cleanly
+ */
+void test_slots_full(void) {
+    const can_log_policy_t policy = {.kind = CAN_LOG_POLICY_ON_CHANGE};
+    for (uint32_t id = 0; id < CAN_LOG_POLICY_MAX_RULES; id++) {
+        TEST_ASSERT_TRUE(can_log_policy_set(&s_table, id, &policy));
+    }
+    TEST_ASSERT_FALSE(can_log_policy_set(&s_table, 0x700, &policy));
+    TEST_ASSERT_TRUE(can_log_policy_set(&s_table, 0, &policy));  // Existing ID still updatable
+
+    // ALWAYS needs no slot
+    const can_log_policy_t always = {.kind = CAN_LOG_POLICY_ALWAYS};
+    TEST_ASSERT_TRUE(can_log_policy_set(&s_table, 0x700, &always));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_default_always);
+    RUN_TEST(test_every_n);
+    RUN_TEST(test_on_change_keyframe);
+    RUN_TEST(test_on_change_ignores_padding);
+    RUN_TEST(test_rate_limit);
+    RUN_TEST(test_replace_and_reset);
+    RUN_TEST(test_slots_full);
+
+    return UNITY_END();
+}
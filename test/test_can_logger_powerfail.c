@@ -0,0 +1,380 @@
+/*
+ * Unit tests for the CAN logger power-fail sequencer
+ *
+ * The sequencer runs against an emulated SD backend that models FAT
+ * semantics: written data sits in a volatile cache until a sync commits
+ * it to media. "Power" can be cut after any I/O operation; everything
+ * after the cut fails and uncommitted data is lost.
+ *
+ * Time is simulated: every operation advances the clock by a fixed cost,
+ * so budget behaviour is deterministic.
+ */
+
+#include "unity/unity.h"
+#include "can_logger_powerfail.h"
+#include <string.h>
+
+#define EMU_MEDIA_SIZE 8192
+#define EMU_NO_CUT -1
+
+typedef struct {
+    uint8_t media[EMU_MEDIA_SIZE];   // Durable bytes
+    size_t media_len;
+    uint8_t cache[EMU_MEDIA_SIZE];   // Written but not yet synced
+    size_t cache_len;
+    int64_t now_us;
+    int ops;                         // I/O operations performed
+    int cut_after_ops;               // Power is lost after this many ops
+    bool powered;
+    int64_t write_cost_us;
+    int64_t sync_cost_us;
+    // Intake queue
+    can_bin_record_v1_t queue[64];
+    size_t queue_len;
+    size_t queue_pos;
+} emu_sd_t;
+
+static emu_sd_t s_emu;
+
+static void emu_reset(int cut_after_ops)
+{
+    memset(&s_emu, 0, sizeof(s_emu));
+    s_emu.cut_after_ops = cut_after_ops;
+    s_emu.powered = true;
+    s_emu.write_cost_us = 1000;
+    s_emu.sync_cost_us = 5000;
+}
+
+static bool emu_op(void)
+{
+    if (!s_emu.powered) {
+        return false;
+    }
+    if (s_emu.cut_after_ops != EMU_NO_CUT && s_emu.ops >= s_emu.cut_after_ops) {
+        s_emu.powered = false;
+        s_emu.cache_len = 0;
+        return false;
+    }
+    s_emu.ops++;
+    return true;
+}
+
+static int64_t emu_now_us(void *ctx)
+{
+    (void)ctx;
+    return s_emu.now_us;
+}
+
+static int emu_write(void *ctx, const void *data, size_t len)
+{
+    (void)ctx;
+    if (!emu_op() || s_emu.media_len + s_emu.cache_len + len > EMU_MEDIA_SIZE) {
+        return -1;
+    }
+    memcpy(s_emu.cache + s_emu.cache_len, data, len);
+    s_emu.cache_len += len;
+    s_emu.now_us += s_emu.write_cost_us;
+    return (int)len;
+}
+
+static bool emu_sync(void *ctx)
+{
+    (void)ctx;
+    if (!emu_op()) {
+        return false;
+    }
+    memcpy(s_emu.media + s_emu.media_len, s_emu.cache, s_emu.cache_len);
+    s_emu.media_len += s_emu.cache_len;
+    s_emu.cache_len = 0;
+    s_emu.now_us += s_emu.sync_cost_us;
+    return true;
+}
+
+static bool emu_next_record(void *ctx, can_bin_record_v1_t *out)
+{
+    (void)ctx;
+    if (s_emu.queue_pos >= s_emu.queue_len) {
+        return false;
+    }
+    *out = s_emu.queue[s_emu.queue_pos++];
+    return true;
+}
+
+static size_t emu_backlog(void *ctx)
+{
+    (void)ctx;
+    return s_emu.queue_len - s_emu.queue_pos;
+}
+
+static const can_logger_pf_io_t k_emu_io = {
+    .ctx = NULL,
+    .now_us = emu_now_us,
+    .write = emu_write,
+    .sync = emu_sync,
+    .next_record = emu_next_record,
+    .backlog = emu_backlog
+};
+
+static can_bin_record_v1_t make_record(uint32_t seq)
+{
+    can_bin_record_v1_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.timestamp_us = 1000000ULL + seq * 1000ULL;
+    rec.can_id = 0x100 + (seq % 0x80);
+    rec.dlc = 8;
+    memcpy(rec.data, &seq, sizeof(seq));
+    return rec;
+}
+
+// Pending buffer of 4 records, queue of n records, file already holds 10
+#define PRE_RECORDS 10
+#define PENDING_RECORDS 4
+
+static can_bin_record_v1_t s_pending[PENDING_RECORDS];
+
+static void setup_log(size_t queued)
+{
+    for (uint32_t i = 0; i < PRE_RECORDS; i++) {
+        can_bin_record_v1_t rec = make_record(i);
+        memcpy(s_emu.media + s_emu.media_len, &rec, sizeof(rec));
+        s_emu.media_len += sizeof(rec);
+    }
+    for (uint32_t i = 0; i < PENDING_RECORDS; i++) {
+        s_pending[i] = make_record(PRE_RECORDS + i);
+    }
+    for (uint32_t i = 0; i < queued; i++) {
+        s_emu.queue[i] = make_record(PRE_RECORDS + PENDING_RECORDS + i);
+    }
+    s_emu.queue_len = queued;
+}
+
+static const can_bin_record_v1_t *media_record(size_t index)
+{
+    return (const can_bin_record_v1_t *)(s_emu.media + index * sizeof(can_bin_record_v1_t));
+}
+
+// Media must hold whole records, in sequence, optionally ending with a trailer
+static size_t assert_media_consistent(bool *has_trailer)
+{
+    TEST_ASSERT_EQUAL_UINT32(0, s_emu.media_len % sizeof(can_bin_record_v1_t));
+    size_t count = s_emu.media_len / sizeof(can_bin_record_v1_t);
+    *has_trailer = false;
+
+    for (size_t i = 0; i < count; i++) {
+        const can_bin_record_v1_t *rec = media_record(i);
+        if (rec->flags & CAN_BIN_RECORD_FLAG_META) {
+            TEST_ASSERT_EQUAL_UINT32(CAN_BIN_META_TRAILER, rec->can_id);
+            TEST_ASSERT_EQUAL_UINT32(count - 1, i);  // Trailer is always last
+            *has_trailer = true;
+        } else {
+            uint32_t seq = 0;
+            memcpy(&seq, rec->data, sizeof(seq));
+            TEST_ASSERT_EQUAL_UINT32(i, seq);
+        }
+    }
+
+    return *has_trailer ? count - 1 : count;
+}
+
+static can_logger_pf_budget_t roomy_budget(void)
+{
+    can_logger_pf_budget_t budget = {
+        .holdup_us = 200000,
+        .sync_reserve_us = 5000,
+        .record_cost_us = 1000
+    };
+    return budget;
+}
+
+void setUp(void) {
+    emu_reset(EMU_NO_CUT);
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: With ample hold-up time everything reaches the media
+ */
+void test_full_sequence_completes(void) {
+    setup_log(40);
+    can_logger_pf_budget_t budget = roomy_budget();
+    can_logger_pf_result_t result;
+
+    can_logger_pf_run(&k_emu_io, &budget, 0, s_pending, sizeof(s_pending),
+                      PRE_RECORDS + PENDING_RECORDS, CAN_LOGGER_STOP_POWER_FAIL_GPIO, &result);
+
+    TEST_ASSERT_TRUE(result.synced);
+    TEST_ASSERT_TRUE(result.trailer_written);
+    TEST_ASSERT_FALSE(result.deadline_missed);
+    TEST_ASSERT_EQUAL_UINT32(40, result.records_drained);
+    TEST_ASSERT_EQUAL_UINT32(0, result.records_abandoned);
+    TEST_ASSERT_EQUAL_HEX8(CAN_BIN_TRAILER_STAGE_PENDING | CAN_BIN_TRAILER_STAGE_COMMIT |
+                           CAN_BIN_TRAILER_STAGE_DRAIN, result.stages);
+
+    bool has_trailer = false;
+    size_t records = assert_media_consistent(&has_trailer);
+    TEST_ASSERT_TRUE(has_trailer);
+    TEST_ASSERT_EQUAL_UINT32(PRE_RECORDS + PENDING_RECORDS + 40, records);
+
+    can_bin_trailer_v1_t trailer;
+    memcpy(&trailer, media_record(records)->data, sizeof(trailer));
+    TEST_ASSERT_EQUAL_UINT32(PRE_RECORDS + PENDING_RECORDS + 40, trailer.records_logged);
+    TEST_ASSERT_EQUAL_UINT16(0, trailer.records_abandoned);
+    TEST_ASSERT_EQUAL_UINT8(CAN_LOGGER_STOP_POWER_FAIL_GPIO, trailer.reason);
+}
+
+/*
+ * Test: Meta records drained from the queue are written but not counted
+ * as logged messages
+ */
+void test_drain_counts_frames_only(void) {
+    setup_log(12);
+    s_emu.queue[3].flags = CAN_BIN_RECORD_FLAG_META;
+    s_emu.queue[3].can_id = CAN_BIN_META_SYNC;
+    s_emu.queue[7].flags = CAN_BIN_RECORD_FLAG_META;
+    s_emu.queue[7].can_id = CAN_BIN_META_EVENT;
+    can_logger_pf_budget_t budget = roomy_budget();
+    can_logger_pf_result_t result;
+
+    can_logger_pf_run(&k_emu_io, &budget, 0, s_pending, sizeof(s_pending),
+                      PRE_RECORDS + PENDING_RECORDS, CAN_LOGGER_STOP_POWER_FAIL_REQUEST, &result);
+
+    TEST_ASSERT_TRUE(result.synced);
+    TEST_ASSERT_EQUAL_UINT32(10, result.records_drained);
+    TEST_ASSERT_EQUAL_UINT32(PRE_RECORDS + PENDING_RECORDS + 12 + 1,
+                             s_emu.media_len / sizeof(can_bin_record_v1_t));
+
+    can_bin_trailer_v1_t trailer;
+    memcpy(&trailer, media_record(PRE_RECORDS + PENDING_RECORDS + 12)->data, sizeof(trailer));
+    TEST_ASSERT_EQUAL_UINT32(PRE_RECORDS + PENDING_RECORDS + 10, trailer.records_logged);
+}
+
+/*
+ * Test: Cutting power after every possible operation never corrupts the
+ * media, and whatever was committed before the cut survives.
+ */
+void test_power_cut_at_every_point(void) {
+    // Uncut run: count operations
+    setup_log(40);
+    can_logger_pf_budget_t budget = roomy_budget();
+    can_logger_pf_result_t result;
+    can_logger_pf_run(&k_emu_io, &budget, 0, s_pending, sizeof(s_pending),
+                      PRE_RECORDS + PENDING_RECORDS, CAN_LOGGER_STOP_POWER_FAIL_GPIO, &result);
+    int total_ops = s_emu.ops;
+    TEST_ASSERT_TRUE(total_ops > 3);
+
+    for (int cut = 0; cut <= total_ops; cut++) {
+        emu_reset(cut);
+        setup_log(40);
+        can_logger_pf_run(&k_emu_io, &budget, 0, s_pending, sizeof(s_pending),
+                          PRE_RECORDS + PENDING_RECORDS, CAN_LOGGER_STOP_POWER_FAIL_GPIO,
+                          &result);
+
+        bool has_trailer = false;
+        size_t records = assert_media_consistent(&has_trailer);
+
+        // Cut before the commit sync: only the pre-existing data
+        // After the commit sync: at least the pending buffer
+        if (cut >= 2) {
+            TEST_ASSERT_TRUE(records >= PRE_RECORDS + PENDING_RECORDS);
+        } else {
+            TEST_ASSERT_EQUAL_UINT32(PRE_RECORDS, records);
+        }
+        TEST_ASSERT_EQUAL(cut == total_ops, has_trailer);
+        TEST_ASSERT_EQUAL(cut == total_ops, result.synced);
+    }
+}
+
+/*
+ * Test: A slow card truncates the drain but the trailer and final sync
+ * still land inside the hold-up window.
+ */
+void test_slow_card_truncates_drain(void) {
+    setup_log(64);
+    s_emu.write_cost_us = 6000;  // Per write call (batch)
+    can_logger_pf_budget_t budget = {
+        .holdup_us = 30000,
+        .sync_reserve_us = 5000,
+        .record_cost_us = 4000
+    };
+    can_logger_pf_result_t result;
+
+    can_logger_pf_run(&k_emu_io, &budget, 0, s_pending, sizeof(s_pending),
+                      PRE_RECORDS + PENDING_RECORDS, CAN_LOGGER_STOP_POWER_FAIL_GPIO, &result);
+
+    TEST_ASSERT_TRUE(result.synced);
+    TEST_ASSERT_FALSE(result.deadline_missed);
+    TEST_ASSERT_TRUE(result.records_drained < 64);
+    TEST_ASSERT_EQUAL_UINT32(64, result.records_drained + result.records_abandoned);
+    TEST_ASSERT_EQUAL_HEX8(0, result.stages & CAN_BIN_TRAILER_STAGE_DRAIN);
+
+    bool has_trailer = false;
+    size_t records = assert_media_consistent(&has_trailer);
+    TEST_ASSERT_TRUE(has_trailer);
+
+    can_bin_trailer_v1_t trailer;
+    memcpy(&trailer, media_record(records)->data, sizeof(trailer));
+    TEST_ASSERT_EQUAL_UINT16(result.records_abandoned, trailer.records_abandoned);
+}
+
+/*
+ * Test: Detection arriving after the window has already closed still
+ * writes the pending buffer and trailer, skipping the commit and drain.
+ */
+void test_expired_budget_still_writes_trailer(void) {
+    setup_log(10);
+    s_emu.now_us = 500000;
+    can_logger_pf_budget_t budget = roomy_budget();
+    can_logger_pf_result_t result;
+
+    can_logger_pf_run(&k_emu_io, &budget, 0, s_pending, sizeof(s_pending),
+                      PRE_RECORDS + PENDING_RECORDS, CAN_LOGGER_STOP_POWER_FAIL_REQUEST, &result);
+
+    TEST_ASSERT_TRUE(result.synced);
+    TEST_ASSERT_TRUE(result.deadline_missed);
+    TEST_ASSERT_EQUAL_HEX8(CAN_BIN_TRAILER_STAGE_PENDING, result.stages);
+    TEST_ASSERT_EQUAL_UINT32(0, result.records_drained);
+    TEST_ASSERT_EQUAL_UINT32(10, result.records_abandoned);
+
+    bool has_trailer = false;
+    size_t records = assert_media_consistent(&has_trailer);
+    TEST_ASSERT_TRUE(has_trailer);
+    TEST_ASSERT_EQUAL_UINT32(PRE_RECORDS + PENDING_RECORDS, records);
+}
+
+/*
+ * Test: Trailer record encoding
+ */
+void test_build_trailer(void) {
+    can_bin_trailer_v1_t trailer = {
+        .records_logged = 0x01020304,
+        .records_abandoned = 7,
+        .reason = CAN_LOGGER_STOP_POWER_FAIL_GPIO,
+        .stages = CAN_BIN_TRAILER_STAGE_PENDING
+    };
+    can_bin_record_v1_t rec;
+    can_logger_pf_build_trailer(123456, &trailer, &rec);
+
+    TEST_ASSERT_EQUAL_UINT32(123456, (uint32_t)rec.timestamp_us);
+    TEST_ASSERT_EQUAL_UINT32(CAN_BIN_META_TRAILER, rec.can_id);
+    TEST_ASSERT_EQUAL_UINT8(CAN_BIN_RECORD_FLAG_META, rec.flags);
+    TEST_ASSERT_EQUAL_UINT8(8, rec.dlc);
+    TEST_ASSERT_EQUAL_HEX8(0x04, rec.data[0]);  // Little-endian count
+    TEST_ASSERT_EQUAL_HEX8(0x01, rec.data[3]);
+    TEST_ASSERT_EQUAL_UINT8(7, rec.data[4]);
+    TEST_ASSERT_EQUAL_UINT8(CAN_LOGGER_STOP_POWER_FAIL_GPIO, rec.data[6]);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_full_sequence_completes);
+    RUN_TEST(test_drain_counts_frames_only);
+    RUN_TEST(test_power_cut_at_every_point);
+    RUN_TEST(test_slow_card_truncates_drain);
+    RUN_TEST(test_expired_budget_still_writes_trailer);
+    RUN_TEST(test_build_trailer);
+
+    return UNITY_END();
+}
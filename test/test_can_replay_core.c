@@ -0,0 +1,196 @@
+/*
+ * Unit tests for the CAN replay timeline
+ *
+ * A virtual clock and transport stand in for esp_timer and the TWAI
+ * driver: the loop below is the device's timer callback reduced to
+ * "advance the clock to the due time, send, report".
+ */
+
+#include "unity/unity.h"
+#include "can_replay_core.h"
+
+#include <string.h>
+
+#define MAX_SENT 64
+
+static can_replay_core_t s_replay;
+static int64_t s_clock_us;
+
+static struct {
+    uint32_t id[MAX_SENT];
+    int64_t at_us[MAX_SENT];
+    size_t count;
+} s_bus;
+
+static can_bin_record_v1_t frame(uint64_t ts, uint32_t id)
+{
+    can_bin_record_v1_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.timestamp_us = ts;
+    rec.can_id = id;
+    rec.dlc = 8;
+    return rec;
+}
+
+// Replay a file's worth of records; jitter_us is added to every send
+static void play(const can_bin_record_v1_t *recs, size_t count, int64_t jitter_us)
+{
+    for (size_t i = 0; i < count; i++) {
+        int64_t due;
+        if (!can_replay_core_schedule(&s_replay, &recs[i], &due)) {
+            continue;
+        }
+        if (s_clock_us < due) {
+            s_clock_us = due;
+        }
+        s_clock_us += jitter_us;
+        if (s_bus.count < MAX_SENT) {
+            s_bus.id[s_bus.count] = recs[i].can_id;
+            s_bus.at_us[s_bus.count] = s_clock_us;
+            s_bus.count++;
+        }
+        can_replay_core_sent(&s_replay, due, s_clock_us, true);
+    }
+}
+
+static const can_bin_record_v1_t *k_log(size_t *count)
+{
+    static can_bin_record_v1_t recs[5];
+    recs[0] = frame(5000000, 0x1C4);
+    recs[1] = frame(5010000, 0x024);
+    recs[2] = frame(5010000, 0x0B4);
+    recs[3] = frame(5000000, CAN_BIN_META_EVENT);
+    recs[3].flags = CAN_BIN_RECORD_FLAG_META;
+    recs[4] = frame(5030000, 0x1C4);
+    *count = 5;
+    return recs;
+}
+
+void setUp(void) {
+    memset(&s_bus, 0, sizeof(s_bus));
+    s_clock_us = 1000;
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: Frames go out at their recorded offsets from the start time
+ */
+void test_realtime_offsets(void) {
+    can_replay_core_init(&s_replay, NULL, 1000);
+
+    size_t count;
+    const can_bin_record_v1_t *recs = k_log(&count);
+    play(recs, count, 0);
+
+    TEST_ASSERT_EQUAL_UINT32(4, s_bus.count);
+    TEST_ASSERT_EQUAL_INT64(1000, s_bus.at_us[0]);
+    TEST_ASSERT_EQUAL_INT64(11000, s_bus.at_us[1]);
+    TEST_ASSERT_EQUAL_INT64(11000, s_bus.at_us[2]);
+    TEST_ASSERT_EQUAL_INT64(31000, s_bus.at_us[3]);
+    TEST_ASSERT_EQUAL_UINT32(1, s_replay.stats.meta_skipped);
+    TEST_ASSERT_EQUAL_UINT32(4, s_replay.stats.frames_sent);
+    TEST_ASSERT_EQUAL_UINT32(0, s_replay.stats.lateness.max_us);
+}
+
+/*
+ * Test: Speed scales the offsets; send jitter shows up as lateness
+ */
+void test_speed_and_lateness(void) {
+    can_replay_options_t opts = {.speed_permille = 2000};
+    can_replay_core_init(&s_replay, &opts, 1000);
+
+    size_t count;
+    const can_bin_record_v1_t *recs = k_log(&count);
+    play(recs, count, 250);
+
+    TEST_ASSERT_EQUAL_INT64(1250, s_bus.at_us[0]);
+    TEST_ASSERT_EQUAL_INT64(6250, s_bus.at_us[1]);
+    // Same due time as its predecessor, so it queues behind it
+    TEST_ASSERT_EQUAL_INT64(6500, s_bus.at_us[2]);
+    TEST_ASSERT_EQUAL_INT64(16250, s_bus.at_us[3]);
+    TEST_ASSERT_EQUAL_UINT32(500, s_replay.stats.lateness.max_us);
+    TEST_ASSERT_EQUAL_UINT32(4, s_replay.stats.lateness.count);
+}
+
+/*
+ * Test: Include and exclude filters
+ */
+void test_filter(void) {
+    can_replay_options_t opts = {0};
+    TEST_ASSERT_TRUE(can_replay_core_parse_filter("0x1C4, 024", &opts));
+    TEST_ASSERT_EQUAL_UINT32(2, opts.filter_count);
+    TEST_ASSERT_FALSE(opts.filter_exclude);
+    can_replay_core_init(&s_replay, &opts, 0);
+
+    size_t count;
+    const can_bin_record_v1_t *recs = k_log(&count);
+    play(recs, count, 0);
+    TEST_ASSERT_EQUAL_UINT32(3, s_bus.count);
+    TEST_ASSERT_EQUAL_UINT32(1, s_replay.stats.frames_filtered);
+
+    TEST_ASSERT_TRUE(can_replay_core_parse_filter("!1C4", &opts));
+    TEST_ASSERT_TRUE(opts.filter_exclude);
+    can_replay_core_init(&s_replay, &opts, 0);
+    TEST_ASSERT_FALSE(can_replay_core_accept(&s_replay, 0x1C4));
+    TEST_ASSERT_TRUE(can_replay_core_accept(&s_replay, 0x024));
+
+    TEST_ASSERT_FALSE(can_replay_core_parse_filter("1C4,xyz", &opts));
+    TEST_ASSERT_FALSE(can_replay_core_parse_filter("0x20000000", &opts));
+    TEST_ASSERT_TRUE(can_replay_core_parse_filter("", &opts));
+    TEST_ASSERT_EQUAL_UINT32(0, opts.filter_count);
+}
+
+/*
+ * Test: Looping restarts the timeline after the gap, not at the file's
+ * original timestamps
+ */
+void test_loop(void) {
+    can_replay_options_t opts = {.loop = true, .loop_gap_us = 100000};
+    can_replay_core_init(&s_replay, &opts, 1000);
+
+    size_t count;
+    const can_bin_record_v1_t *recs = k_log(&count);
+    play(recs, count, 0);
+    TEST_ASSERT_TRUE(can_replay_core_end_pass(&s_replay));
+    play(recs, count, 0);
+
+    TEST_ASSERT_EQUAL_UINT32(8, s_bus.count);
+    TEST_ASSERT_EQUAL_INT64(131000, s_bus.at_us[4]);
+    TEST_ASSERT_EQUAL_INT64(161000, s_bus.at_us[7]);
+    TEST_ASSERT_EQUAL_UINT32(1, s_replay.stats.passes);
+
+    can_replay_core_init(&s_replay, NULL, 0);
+    TEST_ASSERT_FALSE(can_replay_core_end_pass(&s_replay));
+}
+
+/*
+ * Test: Header validation
+ */
+void test_header(void) {
+    can_bin_header_v1_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CAN_BIN_MAGIC, sizeof(header.magic));
+    header.version = CAN_BIN_VERSION;
+    header.header_size = CAN_BIN_HEADER_SIZE;
+    header.record_size = CAN_BIN_RECORD_SIZE;
+
+    TEST_ASSERT_TRUE(can_replay_core_check_header((const uint8_t *)&header, sizeof(header)));
+    TEST_ASSERT_FALSE(can_replay_core_check_header((const uint8_t *)&header, sizeof(header) - 1));
+    header.record_size = 16;
+    TEST_ASSERT_FALSE(can_replay_core_check_header((const uint8_t *)&header, sizeof(header)));
+    TEST_ASSERT_FALSE(can_replay_core_check_header(NULL, 64));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_realtime_offsets);
+    RUN_TEST(test_speed_and_lateness);
+    RUN_TEST(test_filter);
+    RUN_TEST(test_loop);
+    RUN_TEST(test_header);
+
+    return UNITY_END();
+}
@@ -0,0 +1,246 @@
+/*
+ * Unit tests for the decoded-signal log chunk codec and rate policy
+ */
+
+#include "unity/unity.h"
+#include "can_sig_codec.h"
+#include <string.h>
+
+#define MAX_SAMPLES 4096
+
+typedef struct {
+    size_t count;
+    uint16_t signal_id;
+    int64_t ts[MAX_SAMPLES];
+    int32_t value[MAX_SAMPLES];
+} collected_t;
+
+static can_sig_chunk_t s_chunk;
+static collected_t s_out;
+static uint8_t s_buf[CAN_SIG_CHUNK_MAX_BYTES];
+
+static void collect(void *ctx, uint16_t signal_id, int64_t timestamp_us, int32_t value)
+{
+    collected_t *c = (collected_t *)ctx;
+    if (c->count < MAX_SAMPLES) {
+        c->signal_id = signal_id;
+        c->ts[c->count] = timestamp_us;
+        c->value[c->count] = value;
+        c->count++;
+    }
+}
+
+void setUp(void) {
+    can_sig_chunk_reset(&s_chunk, 7);
+    memset(&s_out, 0, sizeof(s_out));
+    memset(s_buf, 0, sizeof(s_buf));
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: Samples round-trip through a chunk
+ */
+void test_round_trip(void) {
+    const int64_t ts[] = {1000000, 1010000, 1020000, 1020000, 5000000};
+    const int32_t values[] = {800, 812, 790, 790, -15};
+
+    for (size_t i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(can_sig_chunk_append(&s_chunk, ts[i], values[i]));
+    }
+
+    size_t size = can_sig_chunk_size(&s_chunk);
+    TEST_ASSERT_EQUAL_size_t(size, can_sig_chunk_emit(&s_chunk, s_buf, sizeof(s_buf)));
+    TEST_ASSERT_EQUAL_size_t(size, can_sig_chunk_decode(s_buf, size, collect, &s_out));
+
+    TEST_ASSERT_EQUAL_UINT16(7, s_out.signal_id);
+    TEST_ASSERT_EQUAL_size_t(5, s_out.count);
+    for (size_t i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL_INT64(ts[i], s_out.ts[i]);
+        TEST_ASSERT_EQUAL_INT32(values[i], s_out.value[i]);
+    }
+
+    // Emitting starts a fresh chunk for the same signal
+    TEST_ASSERT_EQUAL_size_t(0, can_sig_chunk_size(&s_chunk));
+    TEST_ASSERT_EQUAL_UINT16(7, s_chunk.signal_id);
+}
+
+/*
+ * Test: Regular, slowly changing samples cost about two bytes each
+ */
+void test_compact_encoding(void) {
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_TRUE(can_sig_chunk_append(&s_chunk, 10000LL * i, 900 + (i % 3) - 1));
+    }
+
+    // 50 ms would need a 3-byte varint; 10 ms fits in 2, deltas of +-2 in 1
+    TEST_ASSERT_EQUAL_UINT16(99 * 2, s_chunk.ts_len);
+    TEST_ASSERT_EQUAL_UINT16(99, s_chunk.value_len);
+    TEST_ASSERT_EQUAL_size_t(CAN_SIG_CHUNK_HEADER_SIZE + 99 * 3, can_sig_chunk_size(&s_chunk));
+}
+
+/*
+ * Test: Extreme deltas survive the zigzag encoding
+ */
+void test_extreme_values(void) {
+    TEST_ASSERT_TRUE(can_sig_chunk_append(&s_chunk, 0, INT32_MIN));
+    TEST_ASSERT_TRUE(can_sig_chunk_append(&s_chunk, 1, INT32_MAX));
+    TEST_ASSERT_TRUE(can_sig_chunk_append(&s_chunk, 2, INT32_MIN));
+    TEST_ASSERT_TRUE(can_sig_chunk_append(&s_chunk, INT64_MAX / 2, 0));
+
+    size_t size = can_sig_chunk_emit(&s_chunk, s_buf, sizeof(s_buf));
+    TEST_ASSERT_EQUAL_size_t(size, can_sig_chunk_decode(s_buf, size, collect, &s_out));
+    TEST_ASSERT_EQUAL_size_t(4, s_out.count);
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, s_out.value[0]);
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, s_out.value[1]);
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, s_out.value[2]);
+    TEST_ASSERT_EQUAL_INT64(INT64_MAX / 2, s_out.ts[3]);
+}
+
+/*
+ * Test: A timestamp that goes backwards is stored as a zero delta
+ */
+void test_backwards_timestamp(void) {
+    can_sig_chunk_append(&s_chunk, 5000, 1);
+    can_sig_chunk_append(&s_chunk, 4000, 2);
+    can_sig_chunk_append(&s_chunk, 6000, 3);
+
+    size_t size = can_sig_chunk_emit(&s_chunk, s_buf, sizeof(s_buf));
+    can_sig_chunk_decode(s_buf, size, collect, &s_out);
+    TEST_ASSERT_EQUAL_INT64(5000, s_out.ts[1]);
+    TEST_ASSERT_EQUAL_INT64(6000, s_out.ts[2]);
+}
+
+/*
+ * Test: A full chunk refuses samples, and every accepted one decodes
+ */
+void test_chunk_full(void) {
+    size_t appended = 0;
+    while (can_sig_chunk_append(&s_chunk, 1000000LL * (int64_t)appended,
+                                (appended & 1) ? 100000 : -100000)) {
+        appended++;
+        TEST_ASSERT_TRUE(appended < MAX_SAMPLES);
+    }
+    TEST_ASSERT_TRUE(appended > 1);
+    TEST_ASSERT_TRUE(can_sig_chunk_size(&s_chunk) <= CAN_SIG_CHUNK_MAX_BYTES);
+
+    size_t size = can_sig_chunk_emit(&s_chunk, s_buf, sizeof(s_buf));
+    TEST_ASSERT_EQUAL_size_t(size, can_sig_chunk_decode(s_buf, size, collect, &s_out));
+    TEST_ASSERT_EQUAL_size_t(appended, s_out.count);
+
+    // An empty chunk always takes the next sample
+    TEST_ASSERT_TRUE(can_sig_chunk_append(&s_chunk, 0, 0));
+}
+
+/*
+ * Test: Emit leaves the chunk alone when the output is too small
+ */
+void test_emit_too_small(void) {
+    can_sig_chunk_append(&s_chunk, 0, 1);
+    can_sig_chunk_append(&s_chunk, 10, 2);
+    size_t size = can_sig_chunk_size(&s_chunk);
+
+    TEST_ASSERT_EQUAL_size_t(0, can_sig_chunk_emit(&s_chunk, s_buf, size - 1));
+    TEST_ASSERT_EQUAL_size_t(size, can_sig_chunk_size(&s_chunk));
+
+    can_sig_chunk_t empty;
+    can_sig_chunk_reset(&empty, 1);
+    TEST_ASSERT_EQUAL_size_t(0, can_sig_chunk_emit(&empty, s_buf, sizeof(s_buf)));
+}
+
+/*
+ * Test: Truncated and corrupt chunks are rejected
+ */
+void test_decode_rejects_bad_chunks(void) {
+    for (int i = 0; i < 10; i++) {
+        can_sig_chunk_append(&s_chunk, 1000LL * i, i * 300);
+    }
+    size_t size = can_sig_chunk_emit(&s_chunk, s_buf, sizeof(s_buf));
+
+    TEST_ASSERT_EQUAL_size_t(0, can_sig_chunk_decode(s_buf, size - 1, NULL, NULL));
+    TEST_ASSERT_EQUAL_size_t(0, can_sig_chunk_decode(s_buf, CAN_SIG_CHUNK_HEADER_SIZE - 1,
+                                                     NULL, NULL));
+
+    uint8_t copy[CAN_SIG_CHUNK_MAX_BYTES];
+    memcpy(copy, s_buf, size);
+    copy[0] ^= 0xFF;  // Magic
+    TEST_ASSERT_EQUAL_size_t(0, can_sig_chunk_decode(copy, size, NULL, NULL));
+
+    // A sample count that does not match the columns
+    memcpy(copy, s_buf, size);
+    copy[4] = 11;
+    TEST_ASSERT_EQUAL_size_t(0, can_sig_chunk_decode(copy, size, NULL, NULL));
+    copy[4] = 9;
+    TEST_ASSERT_EQUAL_size_t(0, can_sig_chunk_decode(copy, size, NULL, NULL));
+
+    // Several chunks back to back are walked by the returned length
+    memcpy(copy, s_buf, size);
+    can_sig_chunk_append(&s_chunk, 0, 1);
+    size_t second = can_sig_chunk_emit(&s_chunk, copy + size, sizeof(copy) - size);
+    TEST_ASSERT_EQUAL_size_t(size, can_sig_chunk_decode(copy, size + second, NULL, NULL));
+    TEST_ASSERT_EQUAL_size_t(second, can_sig_chunk_decode(copy + size, second, NULL, NULL));
+}
+
+/*
+ * Test: Quantization rounds and saturates
+ */
+void test_quantize(void) {
+    TEST_ASSERT_EQUAL_INT32(123, can_sig_quantize(12.34f, 0.1f));
+    TEST_ASSERT_EQUAL_INT32(-123, can_sig_quantize(-12.34f, 0.1f));
+    TEST_ASSERT_EQUAL_INT32(2, can_sig_quantize(1.5f, 1.0f));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, can_sig_quantize(1e30f, 1.0f));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, can_sig_quantize(-1e30f, 1.0f));
+    TEST_ASSERT_EQUAL_INT32(0, can_sig_quantize(5.0f, 0.0f));
+    TEST_ASSERT_EQUAL_INT32(0, can_sig_quantize(0.0f / 0.0f, 1.0f));
+}
+
+/*
+ * Test: Minimum interval, deadband and heartbeat
+ */
+void test_rate_policy(void) {
+    const can_sig_rate_t rate = {
+        .min_interval_us = 100000,
+        .max_interval_us = 1000000,
+        .deadband = 2
+    };
+    can_sig_rate_state_t state = {0};
+
+    TEST_ASSERT_TRUE(can_sig_rate_accept(&rate, &state, 0, 100));        // First sample
+    TEST_ASSERT_FALSE(can_sig_rate_accept(&rate, &state, 50000, 500));   // Too soon
+    TEST_ASSERT_TRUE(can_sig_rate_accept(&rate, &state, 100000, 500));   // Changed
+    TEST_ASSERT_FALSE(can_sig_rate_accept(&rate, &state, 300000, 502));  // Inside deadband
+    TEST_ASSERT_TRUE(can_sig_rate_accept(&rate, &state, 400000, 497));   // Drifted past it
+    TEST_ASSERT_FALSE(can_sig_rate_accept(&rate, &state, 1300000, 497)); // Unchanged
+    TEST_ASSERT_TRUE(can_sig_rate_accept(&rate, &state, 1400000, 497));  // Heartbeat
+    TEST_ASSERT_EQUAL_INT64(1400000, state.last_ts_us);
+}
+
+/*
+ * Test: Without a heartbeat unchanged values are never repeated
+ */
+void test_rate_on_change_only(void) {
+    const can_sig_rate_t rate = {0};
+    can_sig_rate_state_t state = {0};
+
+    TEST_ASSERT_TRUE(can_sig_rate_accept(&rate, &state, 0, 5));
+    TEST_ASSERT_FALSE(can_sig_rate_accept(&rate, &state, 60000000, 5));
+    TEST_ASSERT_TRUE(can_sig_rate_accept(&rate, &state, 60000001, 6));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_compact_encoding);
+    RUN_TEST(test_extreme_values);
+    RUN_TEST(test_backwards_timestamp);
+    RUN_TEST(test_chunk_full);
+    RUN_TEST(test_emit_too_small);
+    RUN_TEST(test_decode_rejects_bad_chunks);
+    RUN_TEST(test_quantize);
+    RUN_TEST(test_rate_policy);
+    RUN_TEST(test_rate_on_change_only);
+
+    return UNITY_END();
+}
@@ -0,0 +1,156 @@
+/*
+ * Unit tests for the live stream codec (COBS framing, CRC, packets)
+ */
+
+#include <string.h>
+
+#include "unity/unity.h"
+#include "can_stream_codec.h"
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: CRC-16/CCITT-FALSE check value
+ */
+void test_crc16_check_value(void) {
+    const uint8_t check[] = "123456789";
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, can_stream_crc16(check, 9));
+}
+
+/*
+ * Test: COBS reference vectors encode and decode back
+ */
+void test_cobs_vectors(void) {
+    const uint8_t in1[] = {0x00};
+    const uint8_t exp1[] = {0x01, 0x01};
+    const uint8_t in2[] = {0x11, 0x22, 0x00, 0x33};
+    const uint8_t exp2[] = {0x03, 0x11, 0x22, 0x02, 0x33};
+    const uint8_t in3[] = {0x11, 0x00, 0x00, 0x00};
+    const uint8_t exp3[] = {0x02, 0x11, 0x01, 0x01, 0x01};
+
+    uint8_t out[16];
+    uint8_t back[16];
+    size_t back_len = 0;
+
+    TEST_ASSERT_EQUAL_UINT32(sizeof(exp1), can_stream_cobs_encode(in1, sizeof(in1), out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(exp1, out, sizeof(exp1));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(exp2), can_stream_cobs_encode(in2, sizeof(in2), out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(exp2, out, sizeof(exp2));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(exp3), can_stream_cobs_encode(in3, sizeof(in3), out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(exp3, out, sizeof(exp3));
+
+    TEST_ASSERT_TRUE(can_stream_cobs_decode(exp3, sizeof(exp3), back, &back_len));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(in3), back_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(in3, back, sizeof(in3));
+
+    // Zero inside a block and a code running past the end are rejected
+    const uint8_t bad1[] = {0x03, 0x11, 0x00};
+    const uint8_t bad2[] = {0x05, 0x11, 0x22};
+    TEST_ASSERT_FALSE(can_stream_cobs_decode(bad1, sizeof(bad1), back, &back_len));
+    TEST_ASSERT_FALSE(can_stream_cobs_decode(bad2, sizeof(bad2), back, &back_len));
+}
+
+/*
+ * Test: A 254-byte run without zeros uses a full block
+ */
+void test_cobs_long_run(void) {
+    uint8_t in[300];
+    uint8_t out[310];
+    uint8_t back[310];
+    size_t back_len = 0;
+    for (size_t i = 0; i < sizeof(in); i++) {
+        in[i] = (uint8_t)(i % 255 + 1);
+    }
+
+    size_t n = can_stream_cobs_encode(in, sizeof(in), out);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(in) + 2, n);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, out[0]);
+    TEST_ASSERT_NULL(memchr(out, 0, n));
+    TEST_ASSERT_TRUE(can_stream_cobs_decode(out, n, back, &back_len));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(in), back_len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(in, back, sizeof(in));
+}
+
+/*
+ * Test: Frame packets round trip with flags and contain one delimiter
+ */
+void test_frame_round_trip(void) {
+    const uint8_t data[8] = {0x00, 0x01, 0x00, 0xFF, 0x00, 0x00, 0x10, 0x00};
+    uint8_t wire[CAN_STREAM_MAX_WIRE];
+
+    size_t n = can_stream_encode_frame(0xFFFF, 0x12345678,
+                                       0x18DAF110 | CAN_STREAM_ID_EXTENDED, 8, data, wire);
+    TEST_ASSERT_TRUE(n <= CAN_STREAM_MAX_WIRE);
+    TEST_ASSERT_EQUAL_HEX8(0x00, wire[n - 1]);
+    TEST_ASSERT_NULL(memchr(wire, 0, n - 1));
+
+    can_stream_packet_t pkt;
+    TEST_ASSERT_TRUE(can_stream_decode(wire, n - 1, &pkt));
+    TEST_ASSERT_EQUAL_UINT8(CAN_STREAM_PKT_FRAME, pkt.type);
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, pkt.seq);
+    TEST_ASSERT_EQUAL_HEX32(0x12345678, pkt.timestamp_us);
+    TEST_ASSERT_EQUAL_HEX32(0x18DAF110 | CAN_STREAM_ID_EXTENDED, pkt.id);
+    TEST_ASSERT_EQUAL_UINT8(8, pkt.dlc);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, pkt.data, 8);
+
+    // Zero-length frame
+    n = can_stream_encode_frame(1, 0, 0x7E8, 0, NULL, wire);
+    TEST_ASSERT_TRUE(can_stream_decode(wire, n - 1, &pkt));
+    TEST_ASSERT_EQUAL_UINT8(0, pkt.dlc);
+    TEST_ASSERT_EQUAL_HEX32(0x7E8, pkt.id);
+}
+
+/*
+ * Test: Status packets round trip
+ */
+void test_status_round_trip(void) {
+    uint8_t wire[CAN_STREAM_MAX_WIRE];
+    size_t n = can_stream_encode_status(42, 1000, 3, wire);
+
+    can_stream_packet_t pkt;
+    TEST_ASSERT_TRUE(can_stream_decode(wire, n - 1, &pkt));
+    TEST_ASSERT_EQUAL_UINT8(CAN_STREAM_PKT_STATUS, pkt.type);
+    TEST_ASSERT_EQUAL_UINT16(42, pkt.seq);
+    TEST_ASSERT_EQUAL_UINT32(1000, pkt.frames_dropped);
+    TEST_ASSERT_EQUAL_UINT32(3, pkt.link_errors);
+}
+
+/*
+ * Test: Corrupted or truncated packets are rejected
+ */
+void test_corruption_detected(void) {
+    const uint8_t data[4] = {1, 2, 3, 4};
+    uint8_t wire[CAN_STREAM_MAX_WIRE];
+    can_stream_packet_t pkt;
+
+    size_t n = can_stream_encode_frame(7, 1000, 0x1C4, 4, data, wire);
+    for (size_t i = 0; i < n - 1; i++) {
+        uint8_t saved = wire[i];
+        wire[i] ^= 0x40;
+        if (wire[i] != 0) {
+            TEST_ASSERT_FALSE(can_stream_decode(wire, n - 1, &pkt));
+        }
+        wire[i] = saved;
+    }
+
+    TEST_ASSERT_FALSE(can_stream_decode(wire, n - 3, &pkt));
+    TEST_ASSERT_FALSE(can_stream_decode(NULL, 4, &pkt));
+    TEST_ASSERT_TRUE(can_stream_decode(wire, n - 1, &pkt));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_crc16_check_value);
+    RUN_TEST(test_cobs_vectors);
+    RUN_TEST(test_cobs_long_run);
+    RUN_TEST(test_frame_round_trip);
+    RUN_TEST(test_status_round_trip);
+    RUN_TEST(test_corruption_detected);
+
+    return UNITY_END();
+}
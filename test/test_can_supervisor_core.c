@@ -0,0 +1,175 @@
+/*
+ * Unit tests for the CAN supervisor (error states and bus-off recovery)
+ */
+
+#include "unity/unity.h"
+#include "can_supervisor_core.h"
+
+static can_supervisor_core_t s_sup;
+static const can_supervisor_config_t k_config = {
+    .backoff_min_us = 10000,
+    .backoff_max_us = 50000,
+    .stable_us = 1000000,
+};
+
+static can_supervisor_action_t feed(can_supervisor_ctrl_t ctrl, uint32_t tec, uint32_t rec,
+                                    int64_t now_us)
+{
+    can_supervisor_status_t status = {ctrl, tec, rec, 0};
+    return can_supervisor_core_update(&s_sup, &status, now_us);
+}
+
+// Drive one bus-off through recovery; returns the backoff that was applied
+static int64_t bus_off_cycle(int64_t *now_us)
+{
+    int64_t start = *now_us;
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_NONE,
+                      feed(CAN_SUPERVISOR_CTRL_BUS_OFF, 255, 0, *now_us));
+    int64_t wait = can_supervisor_core_next_deadline_us(&s_sup, *now_us);
+    *now_us += wait;
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_RECOVER,
+                      feed(CAN_SUPERVISOR_CTRL_BUS_OFF, 255, 0, *now_us));
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_NONE,
+                      feed(CAN_SUPERVISOR_CTRL_RECOVERING, 128, 0, *now_us + 100));
+    *now_us += 3000;
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_START,
+                      feed(CAN_SUPERVISOR_CTRL_STOPPED, 0, 0, *now_us));
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_NONE,
+                      feed(CAN_SUPERVISOR_CTRL_RUNNING, 0, 0, *now_us + 50));
+    *now_us += 50;
+    return *now_us - start - 3050;
+}
+
+void setUp(void) {
+    can_supervisor_core_init(&s_sup, &k_config);
+    feed(CAN_SUPERVISOR_CTRL_RUNNING, 0, 0, 0);
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: Error counters map to active / warning / passive and poll scaling
+ */
+void test_error_levels(void) {
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ERROR_ACTIVE, s_sup.state);
+    TEST_ASSERT_EQUAL_UINT32(1, can_supervisor_core_poll_scale(&s_sup));
+
+    feed(CAN_SUPERVISOR_CTRL_RUNNING, 100, 8, 1000);
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ERROR_WARNING, s_sup.state);
+    TEST_ASSERT_EQUAL_UINT32(2, can_supervisor_core_poll_scale(&s_sup));
+
+    feed(CAN_SUPERVISOR_CTRL_RUNNING, 40, 130, 2000);
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ERROR_PASSIVE, s_sup.state);
+    TEST_ASSERT_EQUAL_UINT32(4, can_supervisor_core_poll_scale(&s_sup));
+
+    feed(CAN_SUPERVISOR_CTRL_RUNNING, 0, 0, 3000);
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ERROR_ACTIVE, s_sup.state);
+    TEST_ASSERT_EQUAL_UINT32(4, s_sup.stats.transitions);
+    TEST_ASSERT_EQUAL_UINT32(130, s_sup.stats.max_rec);
+    TEST_ASSERT_EQUAL_STRING("passive", can_supervisor_state_name(CAN_SUPERVISOR_ERROR_PASSIVE));
+}
+
+/*
+ * Test: Bus-off waits out the backoff, recovers, restarts and records the
+ * offline window; requests are held meanwhile
+ */
+void test_bus_off_recovery(void) {
+    int64_t now = 100000;
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_NONE,
+                      feed(CAN_SUPERVISOR_CTRL_BUS_OFF, 255, 0, now));
+    TEST_ASSERT_EQUAL_UINT32(0, can_supervisor_core_poll_scale(&s_sup));
+    TEST_ASSERT_EQUAL_INT64(10000, can_supervisor_core_next_deadline_us(&s_sup, now));
+
+    // Too early: nothing to do
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_NONE,
+                      feed(CAN_SUPERVISOR_CTRL_BUS_OFF, 255, 0, now + 9999));
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_RECOVER,
+                      feed(CAN_SUPERVISOR_CTRL_BUS_OFF, 255, 0, now + 10000));
+    // Issued once
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_NONE,
+                      feed(CAN_SUPERVISOR_CTRL_BUS_OFF, 255, 0, now + 10100));
+    TEST_ASSERT_EQUAL_INT64(-1, can_supervisor_core_next_deadline_us(&s_sup, now + 10100));
+
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_START,
+                      feed(CAN_SUPERVISOR_CTRL_STOPPED, 0, 0, now + 13000));
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_NONE,
+                      feed(CAN_SUPERVISOR_CTRL_RUNNING, 0, 0, now + 13200));
+
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ERROR_ACTIVE, s_sup.state);
+    TEST_ASSERT_EQUAL_UINT32(1, s_sup.stats.bus_off_count);
+    TEST_ASSERT_EQUAL_UINT32(1, s_sup.stats.recoveries);
+    TEST_ASSERT_EQUAL_UINT32(13200, s_sup.stats.last_offline_us);
+}
+
+/*
+ * Test: Repeated bus-off doubles the backoff up to the cap; a stable
+ * period resets it
+ */
+void test_backoff(void) {
+    int64_t now = 0;
+    TEST_ASSERT_EQUAL_INT64(10000, bus_off_cycle(&now));
+    now += 1000;
+    TEST_ASSERT_EQUAL_INT64(20000, bus_off_cycle(&now));
+    now += 1000;
+    TEST_ASSERT_EQUAL_INT64(40000, bus_off_cycle(&now));
+    now += 1000;
+    TEST_ASSERT_EQUAL_INT64(50000, bus_off_cycle(&now));
+    now += 1000;
+    TEST_ASSERT_EQUAL_INT64(50000, bus_off_cycle(&now));
+
+    now += 2000000;
+    TEST_ASSERT_EQUAL_INT64(10000, bus_off_cycle(&now));
+    TEST_ASSERT_EQUAL_UINT32(6, s_sup.stats.recoveries);
+}
+
+/*
+ * Test: A stop without a bus-off (user pause) never asks for a restart
+ */
+void test_paused_stop(void) {
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_NONE, feed(CAN_SUPERVISOR_CTRL_STOPPED, 0, 0, 1000));
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_STOPPED, s_sup.state);
+    TEST_ASSERT_EQUAL_UINT32(0, can_supervisor_core_poll_scale(&s_sup));
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_NONE, feed(CAN_SUPERVISOR_CTRL_RUNNING, 0, 0, 2000));
+    TEST_ASSERT_EQUAL_UINT32(0, s_sup.stats.recoveries);
+}
+
+/*
+ * Test: A recovery that falls due while paused is withheld, not consumed,
+ * and issued once the user resumes (the driver refuses to start bus-off)
+ */
+void test_pause_during_bus_off(void) {
+    int64_t now = 100000;
+    can_supervisor_core_set_paused(&s_sup, true);
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_NONE,
+                      feed(CAN_SUPERVISOR_CTRL_BUS_OFF, 255, 0, now));
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_BUS_OFF, s_sup.state);
+    TEST_ASSERT_EQUAL_INT64(-1, can_supervisor_core_next_deadline_us(&s_sup, now));
+
+    // Backoff elapses while paused
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_NONE,
+                      feed(CAN_SUPERVISOR_CTRL_BUS_OFF, 255, 0, now + 50000));
+    TEST_ASSERT_FALSE(s_sup.recovery_started);
+
+    can_supervisor_core_set_paused(&s_sup, false);
+    TEST_ASSERT_EQUAL_INT64(0, can_supervisor_core_next_deadline_us(&s_sup, now + 60000));
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_RECOVER,
+                      feed(CAN_SUPERVISOR_CTRL_BUS_OFF, 255, 0, now + 60000));
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_START,
+                      feed(CAN_SUPERVISOR_CTRL_STOPPED, 0, 0, now + 63000));
+    TEST_ASSERT_EQUAL(CAN_SUPERVISOR_ACTION_NONE,
+                      feed(CAN_SUPERVISOR_CTRL_RUNNING, 0, 0, now + 63200));
+    TEST_ASSERT_EQUAL_UINT32(1, s_sup.stats.recoveries);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_error_levels);
+    RUN_TEST(test_bus_off_recovery);
+    RUN_TEST(test_backoff);
+    RUN_TEST(test_paused_stop);
+    RUN_TEST(test_pause_during_bus_off);
+
+    return UNITY_END();
+}
@@ -0,0 +1,98 @@
+/*
+ * Unit tests for deferred log formatting
+ */
+
+#include "unity/unity.h"
+#include "dlog_format.h"
+#include <stdio.h>
+#include <string.h>
+
+static char s_out[128];
+
+void setUp(void) {
+    memset(s_out, 0x55, sizeof(s_out));
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: Integer conversions match printf, including length modifiers
+ */
+void test_integers(void) {
+    uint64_t args[] = {
+        dlog_arg_int(-42), dlog_arg_uint(0x7C8), dlog_arg_uint(0xFFFFFFFFu),
+        dlog_arg_int(-1), dlog_arg_uint(18446744073709551615ull), dlog_arg_int(300),
+    };
+    dlog_format(s_out, sizeof(s_out), "%d 0x%03X %u %u %llu %hhu", args, 6);
+
+    char expected[128];
+    snprintf(expected, sizeof(expected), "%d 0x%03X %u %u %llu %hhu",
+             -42, 0x7C8, 0xFFFFFFFFu, (unsigned)-1, 18446744073709551615ull,
+             (unsigned char)300);
+    TEST_ASSERT_EQUAL_STRING(expected, s_out);
+}
+
+/*
+ * Test: Floating point, strings, characters and literal percent signs
+ */
+void test_float_string_char(void) {
+    static const char *state = "running";
+    uint64_t args[] = {
+        dlog_arg_double(2.04), dlog_arg_ptr(state), dlog_arg_double(12.5f),
+        dlog_arg_int('I'), dlog_arg_ptr(NULL),
+    };
+    dlog_format(s_out, sizeof(s_out), "%.1fs state=%s drop=%.1f%% %c %s", args, 5);
+    TEST_ASSERT_EQUAL_STRING("2.0s state=running drop=12.5% I (null)", s_out);
+}
+
+/*
+ * Test: Flags, widths and '*' arguments are honoured
+ */
+void test_width_and_star(void) {
+    uint64_t args[] = {
+        dlog_arg_int(7), dlog_arg_int(5), dlog_arg_int(-3), dlog_arg_int(3),
+        dlog_arg_int(8), dlog_arg_int(3), dlog_arg_double(3.14159),
+    };
+    dlog_format(s_out, sizeof(s_out), "[%02X][%*d][%-*d][%.*f]", args, 7);
+    TEST_ASSERT_EQUAL_STRING("[07][   -3][8  ][3.142]", s_out);
+}
+
+/*
+ * Test: Missing arguments and unknown conversions do not read past args
+ */
+void test_missing_and_unknown(void) {
+    uint64_t args[] = {dlog_arg_int(1)};
+    dlog_format(s_out, sizeof(s_out), "%d %d %k end %", args, 1);
+    TEST_ASSERT_EQUAL_STRING("1 <?> %k end %", s_out);
+
+    dlog_format(s_out, sizeof(s_out), NULL, args, 1);
+    TEST_ASSERT_EQUAL_STRING("", s_out);
+}
+
+/*
+ * Test: Output is truncated and terminated at the buffer size
+ */
+void test_truncation(void) {
+    uint64_t args[] = {dlog_arg_uint(123456789), dlog_arg_ptr("tail")};
+    size_t n = dlog_format(s_out, 8, "abc %u %s", args, 2);
+    TEST_ASSERT_EQUAL_size_t(7, n);
+    TEST_ASSERT_EQUAL_STRING("abc 123", s_out);
+    TEST_ASSERT_EQUAL_UINT8(0x55, (uint8_t)s_out[8]);
+
+    n = dlog_format(s_out, 1, "abc", NULL, 0);
+    TEST_ASSERT_EQUAL_size_t(0, n);
+    TEST_ASSERT_EQUAL_STRING("", s_out);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_integers);
+    RUN_TEST(test_float_string_char);
+    RUN_TEST(test_width_and_star);
+    RUN_TEST(test_missing_and_unknown);
+    RUN_TEST(test_truncation);
+
+    return UNITY_END();
+}
@@ -0,0 +1,197 @@
+/*
+ * Unit tests for the native field hypothesis search (analysis/native)
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "unity/unity.h"
+#include "field_search.h"
+
+#define MAX_FRAMES 10000
+#define MAX_HITS 8
+
+static uint32_t s_id[MAX_FRAMES];
+static uint8_t s_dlc[MAX_FRAMES];
+static uint8_t s_data[MAX_FRAMES][8];
+static size_t s_count;
+static uint32_t s_rng;
+
+static double s_scales[4];
+static double s_offsets[2];
+static can_fs_query_t s_query;
+static can_fs_hit_t s_hits[MAX_HITS];
+
+static uint8_t noise(void)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return (uint8_t)(s_rng >> 16);
+}
+
+// Frame with noise in every byte
+static uint8_t *add(uint32_t id, uint8_t dlc)
+{
+    s_id[s_count] = id;
+    s_dlc[s_count] = dlc;
+    for (int i = 0; i < 8; i++) {
+        s_data[s_count][i] = noise();
+    }
+    return s_data[s_count++];
+}
+
+static int run(const uint32_t *ids, size_t id_count)
+{
+    const can_fs_frames_t frames = {s_id, s_dlc, &s_data[0][0], s_count};
+    return can_fs_search(&frames, ids, id_count, &s_query, 2, s_hits, MAX_HITS, NULL);
+}
+
+void setUp(void) {
+    s_count = 0;
+    s_rng = 1;
+    memset(&s_query, 0, sizeof(s_query));
+    s_scales[0] = 1.0;
+    s_offsets[0] = 0.0;
+    s_query.scales = s_scales;
+    s_query.scale_count = 1;
+    s_query.offsets = s_offsets;
+    s_query.offset_count = 1;
+    s_query.min_value = -INFINITY;
+    s_query.max_value = INFINITY;
+    s_query.target = NAN;
+    s_query.min_fraction = 0.98;
+    s_query.min_trend = 0.5;
+    s_query.min_len = 1;
+    s_query.max_len = 16;
+    s_query.layouts = CAN_FS_LAYOUT_ALL;
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: A slowly rising pressure byte is found by target and step limit,
+ * ahead of the same byte at a wrong scale
+ */
+void test_target_byte(void) {
+    const uint32_t ids[] = {0x498, 0x4A7};
+    for (int i = 0; i < 300; i++) {
+        uint8_t *d = add(0x498, 8);
+        d[4] = (uint8_t)(166 + i / 100);  // 38.2 .. 38.6 PSI
+        add(0x4A7, 8);
+    }
+    s_scales[0] = 0.25;
+    s_scales[1] = 0.23;
+    s_query.scale_count = 2;
+    s_query.target = 38.0;
+    s_query.target_tol = 2.0;
+    s_query.max_step = 0.5;
+
+    int n = run(ids, 2);
+    TEST_ASSERT_TRUE(n >= 1);
+    TEST_ASSERT_EQUAL_UINT32(0x498, s_hits[0].can_id);
+    TEST_ASSERT_EQUAL_UINT8(32, s_hits[0].start_bit);
+    TEST_ASSERT_EQUAL_UINT8(8, s_hits[0].length);
+    TEST_ASSERT_EQUAL_UINT8(0, s_hits[0].big_endian);
+    TEST_ASSERT_EQUAL_UINT8(0, s_hits[0].is_signed);
+    TEST_ASSERT_TRUE(s_hits[0].scale == 0.23);
+    TEST_ASSERT_TRUE(fabs(s_hits[0].fraction - 1.0) < 1e-12);
+    TEST_ASSERT_EQUAL_UINT32(2, s_hits[0].changes);
+    TEST_ASSERT_TRUE(fabs(s_hits[0].min - 166 * 0.23) < 1e-9);
+    TEST_ASSERT_TRUE(fabs(s_hits[0].max - 168 * 0.23) < 1e-9);
+    TEST_ASSERT_TRUE(s_hits[0].trend > 0.5);
+    for (int i = 1; i < n; i++) {
+        TEST_ASSERT_TRUE(s_hits[i].score <= s_hits[i - 1].score);
+    }
+}
+
+/*
+ * Test: A signed big-endian field spanning two bytes, found by range and
+ * falling trend
+ */
+void test_big_endian_signed(void) {
+    const uint32_t ids[] = {0x2C1};
+    for (int i = 0; i < 400; i++) {
+        uint8_t *d = add(0x2C1, 8);
+        // 12 bits from bit 7: byte 0, then the high nibble of byte 1
+        uint16_t raw = (uint16_t)(-100 - 4 * i) & 0x0FFF;
+        d[0] = (uint8_t)(raw >> 4);
+        d[1] = (uint8_t)((raw & 0x0F) << 4 | (d[1] & 0x0F));
+    }
+    s_query.min_value = -1800.0;
+    s_query.max_value = -99.0;  // Excludes the same field without its LSB
+    s_query.trend = CAN_FS_TREND_FALLING;
+    s_query.min_len = 4;
+
+    TEST_ASSERT_TRUE(run(ids, 1) >= 1);
+    TEST_ASSERT_EQUAL_UINT8(7, s_hits[0].start_bit);
+    TEST_ASSERT_EQUAL_UINT8(12, s_hits[0].length);
+    TEST_ASSERT_EQUAL_UINT8(1, s_hits[0].big_endian);
+    TEST_ASSERT_EQUAL_UINT8(1, s_hits[0].is_signed);
+    TEST_ASSERT_TRUE(fabs(s_hits[0].max + 100.0) < 1e-9);
+    TEST_ASSERT_TRUE(fabs(s_hits[0].min + 1696.0) < 1e-9);
+    TEST_ASSERT_TRUE(s_hits[0].trend < -0.9);
+}
+
+/*
+ * Test: On a log longer than the sample, a step limit alone finds a slow
+ * counter: its full width ranks above its high bits, and the wider
+ * fields with always-zero top bits are not repeated
+ */
+void test_sampled_step_only(void) {
+    const uint32_t ids[] = {0x3B3};
+    for (int i = 0; i < MAX_FRAMES; i++) {
+        uint8_t *d = add(0x3B3, 8);
+        d[1] = (uint8_t)i;
+        d[2] = (uint8_t)((i >> 8) | (d[2] & 0xC0));
+    }
+    s_query.max_step = 1.0;
+    s_query.min_len = 8;
+
+    TEST_ASSERT_TRUE(run(ids, 1) >= 1);
+    TEST_ASSERT_EQUAL_UINT8(8, s_hits[0].start_bit);
+    TEST_ASSERT_EQUAL_UINT8(14, s_hits[0].length);
+    TEST_ASSERT_EQUAL_UINT8(0, s_hits[0].big_endian);
+    TEST_ASSERT_EQUAL_UINT32(MAX_FRAMES, s_hits[0].frames);
+    TEST_ASSERT_TRUE(fabs(s_hits[0].step_fraction - 1.0) < 1e-12);
+    for (int i = 1; i < MAX_HITS; i++) {
+        TEST_ASSERT_FALSE(s_hits[i].start_bit == 8 && s_hits[i].length > 14 &&
+                          !s_hits[i].big_endian && !s_hits[i].is_signed);
+    }
+}
+
+/*
+ * Test: Bytes past the DLC are never decoded, and bad queries are rejected
+ */
+void test_dlc_and_errors(void) {
+    const uint32_t ids[] = {0x498, 0x498};
+    for (int i = 0; i < 50; i++) {
+        uint8_t *d = add(0x498, 2);
+        memset(d + 2, 0xA6, 6);
+    }
+    s_scales[0] = 0.23;
+    s_query.target = 38.0;
+    s_query.target_tol = 1.0;
+    s_query.min_len = 8;
+    TEST_ASSERT_EQUAL_INT(0, run(ids, 1));
+
+    TEST_ASSERT_EQUAL_INT(CAN_FS_ERR_ARG, run(ids, 2));
+    s_scales[0] = 0.0;
+    TEST_ASSERT_EQUAL_INT(CAN_FS_ERR_ARG, run(ids, 1));
+    s_scales[0] = 1.0;
+    s_query.max_len = CAN_FS_MAX_LEN + 1;
+    TEST_ASSERT_EQUAL_INT(CAN_FS_ERR_ARG, run(ids, 1));
+    s_query.max_len = 16;
+    s_query.target_tol = 0.0;
+    TEST_ASSERT_EQUAL_INT(CAN_FS_ERR_ARG, run(ids, 1));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_target_byte);
+    RUN_TEST(test_big_endian_signed);
+    RUN_TEST(test_sampled_step_only);
+    RUN_TEST(test_dlc_and_errors);
+
+    return UNITY_END();
+}
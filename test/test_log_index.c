@@ -0,0 +1,171 @@
+/*
+ * Unit tests for log file naming and the sequence index record
+ *
+ * Covers the names written by the firmware, the legacy root-directory
+ * names handled by the one-time migration, and index record corruption.
+ */
+
+#include "unity/unity.h"
+#include "log_index.h"
+#include <string.h>
+
+static const log_name_time_t k_time = {
+    .year = 2026, .month = 10, .day = 17, .hour = 14, .min = 30, .sec = 52
+};
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: New dated and undated names
+ */
+void test_format_name(void) {
+    char buf[64];
+    TEST_ASSERT_EQUAL_INT(30, log_index_format_name(buf, sizeof(buf), "CAN", "bin", 42, &k_time));
+    TEST_ASSERT_EQUAL_STRING("CAN_20261017_143052_000042.bin", buf);
+
+    TEST_ASSERT_TRUE(log_index_format_name(buf, sizeof(buf), "CAN", "bin", 7, NULL) > 0);
+    TEST_ASSERT_EQUAL_STRING("CAN_000007.bin", buf);
+
+    // Sequence numbers past the padding width grow the name
+    TEST_ASSERT_TRUE(log_index_format_name(buf, sizeof(buf), "CAN", "bin", 1234567, NULL) > 0);
+    TEST_ASSERT_EQUAL_STRING("CAN_1234567.bin", buf);
+}
+
+/*
+ * Test: Truncation is reported instead of producing a short name
+ */
+void test_format_truncation(void) {
+    char buf[16];
+    TEST_ASSERT_EQUAL_INT(-1, log_index_format_name(buf, sizeof(buf), "CAN", "bin", 1, &k_time));
+    TEST_ASSERT_EQUAL_INT(-1, log_index_format_dir(buf, 8, "/sdcard", &k_time));
+}
+
+/*
+ * Test: Date and undated directories
+ */
+void test_format_dir(void) {
+    char buf[64];
+    TEST_ASSERT_TRUE(log_index_format_dir(buf, sizeof(buf), "/sdcard", &k_time) > 0);
+    TEST_ASSERT_EQUAL_STRING("/sdcard/2026/10", buf);
+
+    TEST_ASSERT_TRUE(log_index_format_dir(buf, sizeof(buf), "/sdcard", NULL) > 0);
+    TEST_ASSERT_EQUAL_STRING("/sdcard/undated", buf);
+}
+
+/*
+ * Test: Names round-trip through the parser
+ */
+void test_parse_new_names(void) {
+    char buf[64];
+    log_name_info_t info;
+
+    log_index_format_name(buf, sizeof(buf), "CAN", "bin", 42, &k_time);
+    TEST_ASSERT_TRUE(log_index_parse_name(buf, &info));
+    TEST_ASSERT_EQUAL_STRING("CAN", info.prefix);
+    TEST_ASSERT_EQUAL_STRING("bin", info.extension);
+    TEST_ASSERT_TRUE(info.has_time);
+    TEST_ASSERT_TRUE(info.has_seq);
+    TEST_ASSERT_EQUAL_UINT32(42, info.seq);
+    TEST_ASSERT_EQUAL_UINT16(2026, info.time.year);
+    TEST_ASSERT_EQUAL_UINT8(10, info.time.month);
+    TEST_ASSERT_EQUAL_UINT8(52, info.time.sec);
+
+    log_index_format_name(buf, sizeof(buf), "LOG", "CSV", 9, NULL);
+    TEST_ASSERT_TRUE(log_index_parse_name(buf, &info));
+    TEST_ASSERT_FALSE(info.has_time);
+    TEST_ASSERT_TRUE(info.has_seq);
+    TEST_ASSERT_EQUAL_UINT32(9, info.seq);
+}
+
+/*
+ * Test: Legacy root-directory names
+ */
+void test_parse_legacy_names(void) {
+    log_name_info_t info;
+
+    // Auto-incrementing: number seeds the sequence
+    TEST_ASSERT_TRUE(log_index_parse_name("CAN_0123.bin", &info));
+    TEST_ASSERT_FALSE(info.has_time);
+    TEST_ASSERT_TRUE(info.has_seq);
+    TEST_ASSERT_EQUAL_UINT32(123, info.seq);
+
+    // Timestamped: dated, no sequence
+    TEST_ASSERT_TRUE(log_index_parse_name("CAN_20251225_143052.bin", &info));
+    TEST_ASSERT_TRUE(info.has_time);
+    TEST_ASSERT_FALSE(info.has_seq);
+    TEST_ASSERT_EQUAL_UINT16(2025, info.time.year);
+    TEST_ASSERT_EQUAL_UINT8(12, info.time.month);
+
+    // Same-second suffix is not a sequence number
+    TEST_ASSERT_TRUE(log_index_parse_name("CAN_20251225_143052_03.bin", &info));
+    TEST_ASSERT_TRUE(info.has_time);
+    TEST_ASSERT_FALSE(info.has_seq);
+}
+
+/*
+ * Test: Files that are not logs are ignored
+ */
+void test_parse_rejects_other_files(void) {
+    log_name_info_t info;
+    TEST_ASSERT_FALSE(log_index_parse_name("LOGIDX.BIN", &info));
+    TEST_ASSERT_FALSE(log_index_parse_name("notes.txt", &info));
+    TEST_ASSERT_FALSE(log_index_parse_name("CAN_abc.bin", &info));
+    TEST_ASSERT_FALSE(log_index_parse_name("CAN_.bin", &info));
+    TEST_ASSERT_FALSE(log_index_parse_name("CAN_0001", &info));
+    TEST_ASSERT_FALSE(log_index_parse_name("CAN_20251325_143052.bin", &info));  // Month 13
+    TEST_ASSERT_FALSE(log_index_parse_name("CAN_2025122_143052.bin", &info));   // Short date
+    TEST_ASSERT_FALSE(log_index_parse_name("_0001.bin", &info));
+}
+
+/*
+ * Test: Index record round trip
+ */
+void test_index_round_trip(void) {
+    uint8_t record[LOG_INDEX_RECORD_SIZE];
+    uint32_t next_seq = 0;
+
+    log_index_encode(0x00012345, record);
+    TEST_ASSERT_TRUE(log_index_decode(record, sizeof(record), &next_seq));
+    TEST_ASSERT_EQUAL_HEX32(0x00012345, next_seq);
+}
+
+/*
+ * Test: Any corruption forces a rebuild
+ */
+void test_index_rejects_corruption(void) {
+    uint8_t record[LOG_INDEX_RECORD_SIZE];
+    uint32_t next_seq = 0;
+
+    log_index_encode(100, record);
+    TEST_ASSERT_FALSE(log_index_decode(record, sizeof(record) - 1, &next_seq));  // Torn write
+
+    for (size_t i = 0; i < sizeof(record); i++) {
+        uint8_t copy[LOG_INDEX_RECORD_SIZE];
+        memcpy(copy, record, sizeof(copy));
+        copy[i] ^= 0x10;
+        TEST_ASSERT_FALSE(log_index_decode(copy, sizeof(copy), &next_seq));
+    }
+
+    // Zero is never a valid next sequence
+    log_index_encode(0, record);
+    TEST_ASSERT_FALSE(log_index_decode(record, sizeof(record), &next_seq));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_format_name);
+    RUN_TEST(test_format_truncation);
+    RUN_TEST(test_format_dir);
+    RUN_TEST(test_parse_new_names);
+    RUN_TEST(test_parse_legacy_names);
+    RUN_TEST(test_parse_rejects_other_files);
+    RUN_TEST(test_index_round_trip);
+    RUN_TEST(test_index_rejects_corruption);
+
+    return UNITY_END();
+}
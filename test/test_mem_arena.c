@@ -0,0 +1,117 @@
+/*
+ * Unit tests for the boot-time memory arena
+ */
+
+#include "unity/unity.h"
+#include "mem_arena.h"
+#include <string.h>
+
+static uint8_t s_block[2048] __attribute__((aligned(64)));
+static mem_arena_t s_arena;
+
+void setUp(void) {
+    memset(s_block, 0xA5, sizeof(s_block));
+    mem_arena_init(&s_arena, "test", s_block, sizeof(s_block));
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: Allocations are aligned, zeroed, recorded and do not overlap
+ */
+void test_alloc_aligned_and_zeroed(void) {
+    uint8_t *a = mem_arena_alloc(&s_arena, 10, 0, "a");
+    uint8_t *b = mem_arena_alloc(&s_arena, 100, 64, "b");
+    uint8_t *c = mem_arena_alloc(&s_arena, 3, 1, "c");
+
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)a % 4);
+    TEST_ASSERT_EQUAL_UINT32(0, (uintptr_t)b % 64);
+    TEST_ASSERT_TRUE(b >= a + 10);
+    TEST_ASSERT_TRUE(c >= b + 100);
+
+    for (int i = 0; i < 100; i++) {
+        TEST_ASSERT_EQUAL_UINT8(0, b[i]);
+    }
+
+    TEST_ASSERT_EQUAL_UINT16(3, s_arena.entry_count);
+    TEST_ASSERT_EQUAL_STRING("b", s_arena.entries[1].tag);
+    TEST_ASSERT_EQUAL_size_t(64, s_arena.entries[1].offset);
+    TEST_ASSERT_EQUAL_size_t(100, s_arena.entries[1].size);
+    TEST_ASSERT_EQUAL_size_t(167, s_arena.used);
+}
+
+/*
+ * Test: A budget built from footprints always fits its allocations
+ */
+void test_footprint_covers_padding(void) {
+    static const size_t sizes[] = {24, 1000, 7, 333};
+    static const size_t aligns[] = {64, 4, 16, 8};
+
+    size_t budget = 0;
+    for (int i = 0; i < 4; i++) {
+        budget += mem_arena_footprint(sizes[i], aligns[i]);
+    }
+    TEST_ASSERT_TRUE(budget <= sizeof(s_block));
+
+    // Start misaligned so every request needs padding
+    mem_arena_init(&s_arena, "test", s_block + 1, budget);
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_NOT_NULL(mem_arena_alloc(&s_arena, sizes[i], aligns[i], "x"));
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, s_arena.failed);
+}
+
+/*
+ * Test: Exhaustion fails without corrupting state
+ */
+void test_exhaustion(void) {
+    TEST_ASSERT_NOT_NULL(mem_arena_alloc(&s_arena, 2024, 4, "big"));
+    TEST_ASSERT_NULL(mem_arena_alloc(&s_arena, 100, 4, "too_big"));
+    TEST_ASSERT_NOT_NULL(mem_arena_alloc(&s_arena, 24, 4, "fits"));
+
+    TEST_ASSERT_EQUAL_UINT16(1, s_arena.failed);
+    TEST_ASSERT_EQUAL_size_t(100, s_arena.failed_bytes);
+    TEST_ASSERT_EQUAL_size_t(0, mem_arena_free_bytes(&s_arena));
+    TEST_ASSERT_EQUAL_UINT16(2, s_arena.entry_count);
+}
+
+/*
+ * Test: Sealed and empty arenas refuse every request
+ */
+void test_sealed_and_empty(void) {
+    mem_arena_seal(&s_arena);
+    TEST_ASSERT_NULL(mem_arena_alloc(&s_arena, 4, 4, "late"));
+    TEST_ASSERT_EQUAL_UINT16(1, s_arena.failed);
+
+    mem_arena_t empty;
+    mem_arena_init(&empty, "empty", NULL, 4096);
+    TEST_ASSERT_EQUAL_size_t(0, empty.size);
+    TEST_ASSERT_NULL(mem_arena_alloc(&empty, 4, 4, "none"));
+    TEST_ASSERT_NULL(mem_arena_alloc(&s_arena, 0, 4, "zero"));
+}
+
+/*
+ * Test: The entry table bounds the number of allocations
+ */
+void test_entry_limit(void) {
+    for (int i = 0; i < MEM_ARENA_MAX_ENTRIES; i++) {
+        TEST_ASSERT_NOT_NULL(mem_arena_alloc(&s_arena, 4, 4, "small"));
+    }
+    TEST_ASSERT_NULL(mem_arena_alloc(&s_arena, 4, 4, "one_more"));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_alloc_aligned_and_zeroed);
+    RUN_TEST(test_footprint_covers_padding);
+    RUN_TEST(test_exhaustion);
+    RUN_TEST(test_sealed_and_empty);
+    RUN_TEST(test_entry_limit);
+
+    return UNITY_END();
+}
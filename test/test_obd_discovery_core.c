@@ -0,0 +1,228 @@
+/*
+ * Unit tests for OBD supported-PID discovery
+ *
+ * A simulated engine ECU (0x7E0) answers the VIN over ISO-TP, mode 0x01
+ * bitmaps and some mode 0x21 PIDs; the meter (0x7C0) never answers.
+ */
+
+#include "unity/unity.h"
+#include "obd_discovery_core.h"
+
+#include <string.h>
+
+static const obd_request_t k_candidates[] = {
+    {0x7E0, 0x01, 0x0C, 0},  // 0: supported
+    {0x7E0, 0x01, 0x0D, 0},  // 1: supported
+    {0x7E0, 0x01, 0x33, 0},  // 2: not in the bitmap
+    {0x7E0, 0x01, 0x42, 0},  // 3: supported, in the 0x40 range
+    {0x7E0, 0x21, 0x82, 0},  // 4: positive reply
+    {0x7E0, 0x21, 0x85, 0},  // 5: negative reply
+    {0x7C0, 0x21, 0x29, 0},  // 6: no reply
+};
+#define CANDIDATE_COUNT (sizeof(k_candidates) / sizeof(k_candidates[0]))
+
+static const char k_vin[] = "JTEBU5JR0A5012345";
+
+static obd_discovery_core_t s_disc;
+
+static struct {
+    uint8_t frames[8][8];
+    size_t count;
+    bool vin_pending;       // Sent the first frame, waiting for flow control
+    bool send_vin;          // ECU supports mode 0x09
+    uint32_t bitmap_queries;
+} s_ecu;
+
+static void reply(const uint8_t *bytes)
+{
+    memcpy(s_ecu.frames[s_ecu.count++], bytes, 8);
+}
+
+static void ecu_handle(const obd_discovery_tx_t *tx)
+{
+    if (tx->id != 0x7E0) {
+        return;
+    }
+
+    if (tx->data[0] == 0x30 && s_ecu.vin_pending) {
+        uint8_t cf1[8] = {0x21};
+        uint8_t cf2[8] = {0x22};
+        memcpy(&cf1[1], &k_vin[3], 7);
+        memcpy(&cf2[1], &k_vin[10], 7);
+        reply(cf1);
+        reply(cf2);
+        s_ecu.vin_pending = false;
+        return;
+    }
+
+    uint8_t service = tx->data[1];
+    uint8_t pid = tx->data[2];
+    if (service == 0x09 && pid == 0x02 && s_ecu.send_vin) {
+        uint8_t ff[8] = {0x10, 20, 0x49, 0x02, 0x01};
+        memcpy(&ff[5], k_vin, 3);
+        reply(ff);
+        s_ecu.vin_pending = true;
+    } else if (service == 0x01 && pid == 0x00) {
+        // 0x0C, 0x0D, 0x11 and 0x20 (next range)
+        uint8_t r[8] = {0x06, 0x41, 0x00, 0x00, 0x18, 0x80, 0x01};
+        s_ecu.bitmap_queries++;
+        reply(r);
+    } else if (service == 0x01 && pid == 0x20) {
+        // 0x40 (next range)
+        uint8_t r[8] = {0x06, 0x41, 0x20, 0x00, 0x00, 0x00, 0x01};
+        s_ecu.bitmap_queries++;
+        reply(r);
+    } else if (service == 0x01 && pid == 0x40) {
+        // 0x42 only
+        uint8_t r[8] = {0x06, 0x41, 0x40, 0x40, 0x00, 0x00, 0x00};
+        s_ecu.bitmap_queries++;
+        reply(r);
+    } else if (service == 0x21 && pid == 0x82) {
+        uint8_t r[8] = {0x06, 0x61, 0x82, 0x12, 0x34, 0x56, 0x78};
+        reply(r);
+    } else if (service == 0x21) {
+        uint8_t r[8] = {0x03, 0x7F, 0x21, 0x31};
+        reply(r);
+    }
+}
+
+// Run until done; returns the simulated time taken
+static int64_t run(int64_t step_us)
+{
+    int64_t now = 0;
+    for (int i = 0; i < 1000 && s_disc.phase != OBD_DISCOVERY_DONE; i++) {
+        obd_discovery_tx_t tx;
+        while (obd_discovery_core_next(&s_disc, now, &tx)) {
+            ecu_handle(&tx);
+            for (size_t f = 0; f < s_ecu.count; f++) {
+                obd_discovery_core_rx(&s_disc, 0x7E8, s_ecu.frames[f], now + 1000);
+            }
+            s_ecu.count = 0;
+        }
+        now += step_us;
+    }
+    return now;
+}
+
+void setUp(void) {
+    memset(&s_ecu, 0, sizeof(s_ecu));
+    s_ecu.send_vin = true;
+    TEST_ASSERT_TRUE(obd_discovery_core_init(&s_disc, k_candidates, CANDIDATE_COUNT));
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: Full discovery reads the VIN, walks the bitmaps and probes mode 0x21
+ */
+void test_full_discovery(void) {
+    run(10000);
+
+    TEST_ASSERT_EQUAL(OBD_DISCOVERY_DONE, s_disc.phase);
+    TEST_ASSERT_EQUAL_STRING(k_vin, s_disc.vin);
+    TEST_ASSERT_EQUAL_UINT32(3, s_ecu.bitmap_queries);
+    TEST_ASSERT_EQUAL_HEX32((1u << 0) | (1u << 1) | (1u << 3) | (1u << 4), s_disc.supported_mask);
+    // The silent meter PID timed out twice
+    TEST_ASSERT_EQUAL_UINT32(2, s_disc.timeouts);
+}
+
+/*
+ * Test: No VIN support just leaves the VIN empty
+ */
+void test_no_vin(void) {
+    s_ecu.send_vin = false;
+    run(10000);
+
+    TEST_ASSERT_EQUAL(OBD_DISCOVERY_DONE, s_disc.phase);
+    TEST_ASSERT_EQUAL_STRING("", s_disc.vin);
+    TEST_ASSERT_EQUAL_HEX32(0x1B, s_disc.supported_mask);
+    TEST_ASSERT_EQUAL_UINT32(4, s_disc.timeouts);
+}
+
+/*
+ * Test: Nothing is sent before the deadline of the request in flight
+ */
+void test_waits_for_deadline(void) {
+    obd_discovery_tx_t tx;
+    TEST_ASSERT_TRUE(obd_discovery_core_next(&s_disc, 0, &tx));
+    TEST_ASSERT_EQUAL_HEX16(0x7E0, tx.id);
+    TEST_ASSERT_EQUAL_HEX8(0x09, tx.data[1]);
+    TEST_ASSERT_FALSE(obd_discovery_core_next(&s_disc, OBD_DISCOVERY_TIMEOUT_US - 1, &tx));
+
+    // Retry of the same request after the deadline
+    TEST_ASSERT_TRUE(obd_discovery_core_next(&s_disc, OBD_DISCOVERY_TIMEOUT_US, &tx));
+    TEST_ASSERT_EQUAL_HEX8(0x09, tx.data[1]);
+
+    // Replies from other ECUs are ignored
+    uint8_t other[8] = {0x06, 0x41, 0x00, 0xFF, 0xFF, 0xFF, 0xFF};
+    obd_discovery_core_rx(&s_disc, 0x7E9, other, OBD_DISCOVERY_TIMEOUT_US + 10);
+    TEST_ASSERT_TRUE(s_disc.waiting);
+}
+
+/*
+ * Test: A cached result short-circuits discovery; the table hash tracks edits
+ */
+void test_cache_and_hash(void) {
+    obd_discovery_core_use_cached(&s_disc, 0x5);
+    TEST_ASSERT_EQUAL(OBD_DISCOVERY_DONE, s_disc.phase);
+    TEST_ASSERT_EQUAL_HEX32(0x5, s_disc.supported_mask);
+
+    obd_discovery_tx_t tx;
+    TEST_ASSERT_FALSE(obd_discovery_core_next(&s_disc, 0, &tx));
+
+    obd_request_t edited[CANDIDATE_COUNT];
+    memcpy(edited, k_candidates, sizeof(edited));
+    uint32_t hash = obd_discovery_core_table_hash(k_candidates, CANDIDATE_COUNT);
+    TEST_ASSERT_EQUAL_HEX32(hash, obd_discovery_core_table_hash(edited, CANDIDATE_COUNT));
+    edited[4].pid = 0x83;
+    TEST_ASSERT_NOT_EQUAL(hash, obd_discovery_core_table_hash(edited, CANDIDATE_COUNT));
+
+    TEST_ASSERT_FALSE(obd_discovery_core_init(&s_disc, NULL, 1));
+    TEST_ASSERT_FALSE(obd_discovery_core_init(&s_disc, k_candidates,
+                                              OBD_DISCOVERY_MAX_CANDIDATES + 1));
+}
+
+/*
+ * Test: An extended-address candidate is sent with its address byte and
+ * its replies are read past the tester's address byte
+ */
+void test_extended_addressing(void) {
+    static const obd_request_t ext[] = {
+        {0x750, 0x21, 0x03, 0x40},
+    };
+    TEST_ASSERT_TRUE(obd_discovery_core_init(&s_disc, ext, 1));
+
+    obd_discovery_tx_t tx;
+    TEST_ASSERT_TRUE(obd_discovery_core_next(&s_disc, 0, &tx));
+    TEST_ASSERT_EQUAL_HEX16(0x750, tx.id);
+    const uint8_t vin_req[4] = {0x40, 0x02, 0x09, 0x02};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(vin_req, tx.data, 4);
+
+    // No mode 0x09 on this ECU
+    uint8_t nrc[8] = {0xF1, 0x03, 0x7F, 0x09, 0x11};
+    obd_discovery_core_rx(&s_disc, 0x758, nrc, 1000);
+    TEST_ASSERT_FALSE(s_disc.waiting);
+
+    TEST_ASSERT_TRUE(obd_discovery_core_next(&s_disc, 2000, &tx));
+    const uint8_t probe_req[4] = {0x40, 0x02, 0x21, 0x03};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(probe_req, tx.data, 4);
+
+    uint8_t pos[8] = {0xF1, 0x06, 0x61, 0x03, 0x10, 0x20, 0x30, 0x40};
+    obd_discovery_core_rx(&s_disc, 0x758, pos, 3000);
+    TEST_ASSERT_FALSE(obd_discovery_core_next(&s_disc, 4000, &tx));
+    TEST_ASSERT_EQUAL(OBD_DISCOVERY_DONE, s_disc.phase);
+    TEST_ASSERT_EQUAL_HEX32(0x1, s_disc.supported_mask);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_full_discovery);
+    RUN_TEST(test_no_vin);
+    RUN_TEST(test_waits_for_deadline);
+    RUN_TEST(test_cache_and_hash);
+    RUN_TEST(test_extended_addressing);
+
+    return UNITY_END();
+}
@@ -0,0 +1,197 @@
+/*
+ * Unit tests for the timebase drift discipline
+ *
+ * A simulated esp_timer runs at a configurable rate error against a
+ * perfect RTC. Rollover edges are fed with deterministic pseudo-random
+ * capture jitter, matching the polled I2C capture on the device.
+ */
+
+#include "unity/unity.h"
+#include "timebase_discipline.h"
+#include <stdlib.h>
+
+#define US_PER_SEC 1000000LL
+#define START_UNIX_SEC 1760000000LL
+#define SYNC_INTERVAL_S 16
+#define CAPTURE_JITTER_US 300
+
+typedef struct {
+    int64_t offset_us;     // esp_timer value at START_UNIX_SEC
+    int32_t drift_ppb;     // True rate error of esp_timer
+    uint32_t rng;
+} sim_clock_t;
+
+static sim_clock_t s_sim;
+static timebase_disc_t s_disc;
+
+static void sim_reset(int32_t drift_ppb) {
+    s_sim.offset_us = 12345678;
+    s_sim.drift_ppb = drift_ppb;
+    s_sim.rng = 0x12345u;
+    timebase_disc_init(&s_disc);
+}
+
+// esp_timer reading at a true wall-clock offset from START_UNIX_SEC
+static int64_t sim_mono(int64_t true_elapsed_us) {
+    return s_sim.offset_us + true_elapsed_us +
+           (true_elapsed_us * s_sim.drift_ppb) / 1000000000LL;
+}
+
+static int32_t sim_jitter(void) {
+    s_sim.rng = s_sim.rng * 1103515245u + 12345u;
+    return (int32_t)((s_sim.rng >> 8) % (2 * CAPTURE_JITTER_US + 1)) - CAPTURE_JITTER_US;
+}
+
+static timebase_edge_result_t sim_edge(int64_t elapsed_sec) {
+    int64_t mono = sim_mono(elapsed_sec * US_PER_SEC) + sim_jitter();
+    return timebase_disc_edge(&s_disc, mono, START_UNIX_SEC + elapsed_sec, CAPTURE_JITTER_US);
+}
+
+static int64_t conversion_error_us(int64_t true_elapsed_us) {
+    int64_t unix_us = 0;
+    TEST_ASSERT_TRUE(timebase_disc_to_unix(&s_disc, sim_mono(true_elapsed_us), &unix_us));
+    return llabs(unix_us - (START_UNIX_SEC * US_PER_SEC + true_elapsed_us));
+}
+
+static void run_edges(int count) {
+    for (int i = 1; i <= count; i++) {
+        TEST_ASSERT_EQUAL(TIMEBASE_EDGE_TRACKED, sim_edge((int64_t)i * SYNC_INTERVAL_S));
+    }
+}
+
+void setUp(void) {
+    sim_reset(0);
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: Nothing converts before the first edge
+ */
+void test_unlocked_conversion_fails(void) {
+    int64_t out = 0;
+    TEST_ASSERT_FALSE(timebase_disc_to_unix(&s_disc, 1000, &out));
+    TEST_ASSERT_FALSE(timebase_disc_next_edge(&s_disc, 1000, &out));
+}
+
+/*
+ * Test: First edge anchors the mapping on the whole second
+ */
+void test_first_edge_locks(void) {
+    TEST_ASSERT_EQUAL(TIMEBASE_EDGE_LOCKED,
+                      timebase_disc_edge(&s_disc, 5000000, START_UNIX_SEC, 200));
+    TEST_ASSERT_TRUE(s_disc.locked);
+
+    int64_t unix_us = 0;
+    TEST_ASSERT_TRUE(timebase_disc_to_unix(&s_disc, 5000000, &unix_us));
+    TEST_ASSERT_EQUAL_INT64(START_UNIX_SEC * US_PER_SEC, unix_us);
+
+    // 250 ms later is 250 ms into the second - sub-second resolution
+    TEST_ASSERT_TRUE(timebase_disc_to_unix(&s_disc, 5250000, &unix_us));
+    TEST_ASSERT_EQUAL_INT64(START_UNIX_SEC * US_PER_SEC + 250000, unix_us);
+}
+
+/*
+ * Test: A fast esp_timer is tracked to within a few ppm
+ */
+void test_tracks_fast_clock(void) {
+    sim_reset(40000);  // +40 ppm
+    TEST_ASSERT_EQUAL(TIMEBASE_EDGE_LOCKED, sim_edge(0));
+    run_edges(40);
+
+    TEST_ASSERT_INT32_WITHIN(5000, 40000, s_disc.drift_ppb);
+
+    // Mid-interval conversion stays well inside a millisecond
+    int64_t mid_us = (40LL * SYNC_INTERVAL_S + SYNC_INTERVAL_S / 2) * US_PER_SEC;
+    TEST_ASSERT_TRUE(conversion_error_us(mid_us) < 500);
+}
+
+/*
+ * Test: A slow esp_timer is tracked with the opposite sign
+ */
+void test_tracks_slow_clock(void) {
+    sim_reset(-25000);  // -25 ppm
+    TEST_ASSERT_EQUAL(TIMEBASE_EDGE_LOCKED, sim_edge(0));
+    run_edges(40);
+
+    TEST_ASSERT_INT32_WITHIN(5000, -25000, s_disc.drift_ppb);
+    TEST_ASSERT_TRUE(conversion_error_us(41LL * SYNC_INTERVAL_S * US_PER_SEC) < 500);
+}
+
+/*
+ * Test: Without the discipline, the same drift would be visible
+ */
+void test_undisciplined_error_is_large(void) {
+    sim_reset(40000);
+    TEST_ASSERT_EQUAL(TIMEBASE_EDGE_LOCKED, sim_edge(0));
+
+    // One hour on the initial anchor alone accumulates 144 ms
+    TEST_ASSERT_TRUE(conversion_error_us(3600LL * US_PER_SEC) > 100000);
+}
+
+/*
+ * Test: Setting the RTC steps the mapping but keeps the learned rate
+ */
+void test_step_keeps_rate(void) {
+    sim_reset(30000);
+    TEST_ASSERT_EQUAL(TIMEBASE_EDGE_LOCKED, sim_edge(0));
+    run_edges(30);
+    int32_t learned = s_disc.drift_ppb;
+
+    int64_t elapsed_sec = 31LL * SYNC_INTERVAL_S;
+    int64_t mono = sim_mono(elapsed_sec * US_PER_SEC);
+    TEST_ASSERT_EQUAL(TIMEBASE_EDGE_STEPPED,
+                      timebase_disc_edge(&s_disc, mono, START_UNIX_SEC + elapsed_sec + 3600, 300));
+    TEST_ASSERT_EQUAL_UINT32(1, s_disc.steps);
+    TEST_ASSERT_EQUAL_INT32(learned, s_disc.drift_ppb);
+
+    int64_t unix_us = 0;
+    TEST_ASSERT_TRUE(timebase_disc_to_unix(&s_disc, mono, &unix_us));
+    TEST_ASSERT_EQUAL_INT64((START_UNIX_SEC + elapsed_sec + 3600) * US_PER_SEC, unix_us);
+}
+
+/*
+ * Test: Out-of-order and invalid edges are rejected
+ */
+void test_rejects_bad_edges(void) {
+    TEST_ASSERT_EQUAL(TIMEBASE_EDGE_LOCKED,
+                      timebase_disc_edge(&s_disc, 5000000, START_UNIX_SEC, 200));
+    TEST_ASSERT_EQUAL(TIMEBASE_EDGE_REJECTED,
+                      timebase_disc_edge(&s_disc, 4000000, START_UNIX_SEC + 1, 200));
+    TEST_ASSERT_EQUAL(TIMEBASE_EDGE_REJECTED,
+                      timebase_disc_edge(&s_disc, 6000000, -1, 200));
+    TEST_ASSERT_EQUAL_UINT32(1, s_disc.edges);
+}
+
+/*
+ * Test: Next-edge prediction lands on the true rollover
+ */
+void test_next_edge_prediction(void) {
+    sim_reset(40000);
+    TEST_ASSERT_EQUAL(TIMEBASE_EDGE_LOCKED, sim_edge(0));
+    run_edges(20);
+
+    // Ask from 0.3 s into a second; expect the following whole second
+    int64_t elapsed_us = (20LL * SYNC_INTERVAL_S + 5) * US_PER_SEC + 300000;
+    int64_t predicted = 0;
+    TEST_ASSERT_TRUE(timebase_disc_next_edge(&s_disc, sim_mono(elapsed_us), &predicted));
+
+    int64_t actual = sim_mono((20LL * SYNC_INTERVAL_S + 6) * US_PER_SEC);
+    TEST_ASSERT_TRUE(llabs(predicted - actual) < 500);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_unlocked_conversion_fails);
+    RUN_TEST(test_first_edge_locks);
+    RUN_TEST(test_tracks_fast_clock);
+    RUN_TEST(test_tracks_slow_clock);
+    RUN_TEST(test_undisciplined_error_is_large);
+    RUN_TEST(test_step_keeps_rate);
+    RUN_TEST(test_rejects_bad_edges);
+    RUN_TEST(test_next_edge_prediction);
+
+    return UNITY_END();
+}
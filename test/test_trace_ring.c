@@ -0,0 +1,121 @@
+/*
+ * Unit tests for the trace event ring
+ */
+
+#include "unity/unity.h"
+#include "trace_ring.h"
+#include <string.h>
+
+static trace_event_t s_storage[16];
+static trace_ring_t s_ring;
+
+void setUp(void) {
+    memset(s_storage, 0, sizeof(s_storage));
+    trace_ring_init(&s_ring, s_storage, 8);
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: Capacity rounds down to a power of two
+ */
+void test_capacity_rounding(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, trace_ring_capacity_for(0));
+    TEST_ASSERT_EQUAL_UINT32(1, trace_ring_capacity_for(1));
+    TEST_ASSERT_EQUAL_UINT32(8, trace_ring_capacity_for(8));
+    TEST_ASSERT_EQUAL_UINT32(8, trace_ring_capacity_for(15));
+    TEST_ASSERT_EQUAL_UINT32(1024, trace_ring_capacity_for(1500));
+
+    trace_ring_init(&s_ring, s_storage, 12);
+    TEST_ASSERT_EQUAL_UINT32(7, s_ring.mask);
+
+    trace_ring_t empty;
+    trace_ring_init(&empty, NULL, 64);
+    TEST_ASSERT_EQUAL_UINT32(0, trace_ring_count(&empty));
+}
+
+/*
+ * Test: Events read back oldest first with all fields intact
+ */
+void test_record_and_read(void) {
+    trace_ring_record(&s_ring, 100, TRACE_ID(TRACE_EV_CAN_RX, TRACE_PHASE_INSTANT), 0x7C8, 8);
+    trace_ring_record(&s_ring, 250, TRACE_ID(TRACE_EV_DECODE, TRACE_PHASE_BEGIN), 0x7C8, 0);
+    trace_ring_record(&s_ring, 400, TRACE_ID(TRACE_EV_DECODE, TRACE_PHASE_END), 0x7C8, 0);
+
+    trace_event_t out[8];
+    TEST_ASSERT_EQUAL_UINT32(3, trace_ring_count(&s_ring));
+    TEST_ASSERT_EQUAL_UINT32(3, trace_ring_read(&s_ring, 0, out, 8));
+
+    TEST_ASSERT_EQUAL_UINT32(100, out[0].cycles);
+    TEST_ASSERT_EQUAL_UINT32(0x7C8, out[0].arg0);
+    TEST_ASSERT_EQUAL_UINT32(8, out[0].arg1);
+    TEST_ASSERT_EQUAL(TRACE_EV_DECODE, TRACE_ID_KIND(out[1].id));
+    TEST_ASSERT_EQUAL(TRACE_PHASE_BEGIN, TRACE_ID_PHASE(out[1].id));
+    TEST_ASSERT_EQUAL(TRACE_PHASE_END, TRACE_ID_PHASE(out[2].id));
+    TEST_ASSERT_EQUAL_UINT32(400, out[2].cycles);
+}
+
+/*
+ * Test: A full ring keeps the newest events, readable in chunks
+ */
+void test_wraparound_keeps_newest(void) {
+    for (uint32_t i = 0; i < 21; i++) {
+        trace_ring_record(&s_ring, i, TRACE_ID(TRACE_EV_CAN_RX, TRACE_PHASE_INSTANT), i, 0);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(8, trace_ring_count(&s_ring));
+    TEST_ASSERT_EQUAL_UINT32(21, s_ring.head);
+
+    trace_event_t out[3];
+    uint32_t offset = 0;
+    uint32_t expected = 13;
+    uint32_t n;
+    while ((n = trace_ring_read(&s_ring, offset, out, 3)) > 0) {
+        for (uint32_t i = 0; i < n; i++) {
+            TEST_ASSERT_EQUAL_UINT32(expected++, out[i].arg0);
+        }
+        offset += n;
+    }
+    TEST_ASSERT_EQUAL_UINT32(21, expected);
+
+    // Nothing outside the ring was touched
+    TEST_ASSERT_EQUAL_UINT32(0, s_storage[8].id);
+}
+
+/*
+ * Test: Clearing drops held events and restarts from the first slot
+ */
+void test_clear(void) {
+    trace_ring_record(&s_ring, 1, TRACE_ID(TRACE_EV_FLUSH, TRACE_PHASE_BEGIN), 512, 0);
+    trace_ring_clear(&s_ring);
+    TEST_ASSERT_EQUAL_UINT32(0, trace_ring_count(&s_ring));
+
+    trace_event_t out[1];
+    TEST_ASSERT_EQUAL_UINT32(0, trace_ring_read(&s_ring, 0, out, 1));
+
+    trace_ring_record(&s_ring, 2, TRACE_ID(TRACE_EV_FLUSH, TRACE_PHASE_END), 512, 0);
+    TEST_ASSERT_EQUAL_UINT32(1, trace_ring_read(&s_ring, 0, out, 1));
+    TEST_ASSERT_EQUAL_UINT32(2, out[0].cycles);
+}
+
+/*
+ * Test: Event layout matches the dump format
+ */
+void test_event_layout(void) {
+    TEST_ASSERT_EQUAL_size_t(16, sizeof(trace_event_t));
+    TEST_ASSERT_EQUAL_size_t(20, sizeof(trace_file_header_t));
+    TEST_ASSERT_EQUAL_size_t(24, sizeof(trace_core_header_t));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_capacity_rounding);
+    RUN_TEST(test_record_and_read);
+    RUN_TEST(test_wraparound_keeps_newest);
+    RUN_TEST(test_clear);
+    RUN_TEST(test_event_layout);
+
+    return UNITY_END();
+}
@@ -0,0 +1,113 @@
+/*
+ * Unit tests for the RX-to-pixel latency probe
+ */
+
+#include "unity/unity.h"
+#include "ui_latency_probe.h"
+
+static ui_latency_probe_t s_probe;
+static const ui_latency_area_t k_label = {.x1 = 100, .y1 = 50, .x2 = 199, .y2 = 89};
+
+void setUp(void) {
+    ui_latency_probe_reset(&s_probe);
+}
+
+void tearDown(void) {
+}
+
+/*
+ * Test: A full flush over the label completes the sample with all stages
+ */
+void test_sample_completes(void) {
+    TEST_ASSERT_TRUE(ui_latency_probe_invalidated(&s_probe, 1000, 41000, &k_label));
+    TEST_ASSERT_TRUE(ui_latency_probe_pending(&s_probe));
+
+    ui_latency_area_t full = {0, 0, 479, 799};
+    TEST_ASSERT_TRUE(ui_latency_probe_flushed(&s_probe, &full, 49000));
+    TEST_ASSERT_FALSE(ui_latency_probe_pending(&s_probe));
+
+    TEST_ASSERT_EQUAL_UINT32(1, s_probe.rx_to_invalidate.count);
+    TEST_ASSERT_EQUAL_UINT32(40000, s_probe.rx_to_invalidate.max_us);
+    TEST_ASSERT_EQUAL_UINT32(8000, s_probe.invalidate_to_flush.max_us);
+    TEST_ASSERT_EQUAL_UINT32(48000, s_probe.rx_to_flush.max_us);
+}
+
+/*
+ * Test: Strips that miss the label or end above its last row do not count
+ */
+void test_partial_strips(void) {
+    ui_latency_probe_invalidated(&s_probe, 1000, 2000, &k_label);
+
+    ui_latency_area_t above = {0, 0, 479, 39};
+    ui_latency_area_t top_half = {0, 40, 479, 79};
+    ui_latency_area_t beside = {300, 80, 479, 119};
+    ui_latency_area_t bottom = {0, 80, 479, 119};
+
+    TEST_ASSERT_FALSE(ui_latency_probe_flushed(&s_probe, &above, 3000));
+    TEST_ASSERT_FALSE(ui_latency_probe_flushed(&s_probe, &top_half, 3100));
+    TEST_ASSERT_FALSE(ui_latency_probe_flushed(&s_probe, &beside, 3200));
+    TEST_ASSERT_TRUE(ui_latency_probe_flushed(&s_probe, &bottom, 3300));
+    TEST_ASSERT_EQUAL_UINT32(1300, s_probe.invalidate_to_flush.max_us);
+
+    // Nothing pending: further flushes are ignored
+    TEST_ASSERT_FALSE(ui_latency_probe_flushed(&s_probe, &bottom, 3400));
+    TEST_ASSERT_EQUAL_UINT32(1, s_probe.rx_to_flush.count);
+}
+
+/*
+ * Test: Redraws without a newer frame do not start samples
+ */
+void test_stale_rx_ignored(void) {
+    TEST_ASSERT_FALSE(ui_latency_probe_invalidated(&s_probe, 0, 1000, &k_label));
+    TEST_ASSERT_TRUE(ui_latency_probe_invalidated(&s_probe, 5000, 6000, &k_label));
+
+    ui_latency_area_t full = {0, 0, 479, 799};
+    ui_latency_probe_flushed(&s_probe, &full, 7000);
+
+    TEST_ASSERT_FALSE(ui_latency_probe_invalidated(&s_probe, 5000, 106000, &k_label));
+    TEST_ASSERT_FALSE(ui_latency_probe_invalidated(&s_probe, 4000, 206000, &k_label));
+    TEST_ASSERT_FALSE(ui_latency_probe_pending(&s_probe));
+    TEST_ASSERT_EQUAL_UINT32(1, s_probe.rx_to_invalidate.count);
+}
+
+/*
+ * Test: A newer frame before the flush supersedes the pending sample
+ */
+void test_superseded(void) {
+    ui_latency_probe_invalidated(&s_probe, 1000, 2000, &k_label);
+
+    ui_latency_area_t moved = {100, 150, 199, 189};
+    TEST_ASSERT_TRUE(ui_latency_probe_invalidated(&s_probe, 90000, 100000, &moved));
+    TEST_ASSERT_EQUAL_UINT32(1, s_probe.superseded);
+
+    // The old area no longer completes the sample
+    TEST_ASSERT_FALSE(ui_latency_probe_flushed(&s_probe, &k_label, 101000));
+    TEST_ASSERT_TRUE(ui_latency_probe_flushed(&s_probe, &moved, 102000));
+    TEST_ASSERT_EQUAL_UINT32(12000, s_probe.rx_to_flush.max_us);
+    TEST_ASSERT_EQUAL_UINT32(1, s_probe.rx_to_flush.count);
+}
+
+/*
+ * Test: NULL arguments are rejected
+ */
+void test_null_args(void) {
+    ui_latency_area_t full = {0, 0, 479, 799};
+    TEST_ASSERT_FALSE(ui_latency_probe_invalidated(NULL, 1000, 2000, &k_label));
+    TEST_ASSERT_FALSE(ui_latency_probe_invalidated(&s_probe, 1000, 2000, NULL));
+    TEST_ASSERT_FALSE(ui_latency_probe_flushed(NULL, &full, 3000));
+    TEST_ASSERT_FALSE(ui_latency_probe_flushed(&s_probe, NULL, 3000));
+    TEST_ASSERT_FALSE(ui_latency_probe_pending(NULL));
+    ui_latency_probe_reset(NULL);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sample_completes);
+    RUN_TEST(test_partial_strips);
+    RUN_TEST(test_stale_rx_ignored);
+    RUN_TEST(test_superseded);
+    RUN_TEST(test_null_args);
+
+    return UNITY_END();
+}